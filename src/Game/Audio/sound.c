@@ -25,24 +25,38 @@
 #define STREAMING_BUFFER_SAMPLES 4096
 #define INITIAL_WORKING_BUFFER_SIZE 8192
 
+// samples that aren't stored as floats are decoded in blocks of this many frames as they're played
+#define DECODE_CACHE_FRAMES 512
+#define ADPCM_BLOCK_FRAMES DECODE_CACHE_FRAMES
+
 // TODO: Get a good way to be able to run the game without any audio processing.
 //  it can cause issues occasionally so it's nice to be able to turn it off quickly
+//  snd_InitOffline( ) gets part of the way there, the mixer runs but only when told to
 // TODO: Go through and see if all the audio stream locks are actually necessary or not.
 
-// TODO: Get pitch shifting working with stereo sounds.
 typedef struct {
 	int sample;
 	float volume;
 	float pitch;
-	float pos;
+	float pos; // in frames
 	float pan; // only counts if there is one channel
 	unsigned int group;
+
+	// frames of the sample that are currently decoded into the decode cache for this sound, unused for SS_FLOAT samples
+	int cacheStart;
+	int cacheFrames;
+
+	// decoder for SS_VORBIS samples, only ever closed on the main thread, so it can stay around after the sound is done
+	//  until the slot is reused or the sample is unloaded
+	stb_vorbis* vorbis;
 } Sound;
 
 typedef struct {
+	SampleStorage storage;
 	int numChannels;
-	float* data;
-	int numSamples;
+	void* data; // depends on storage: floats, Sint16s, ADPCM blocks, or the entire vorbis file
+	size_t dataSize; // in bytes
+	int numSamples; // in frames
 	bool loops;
 } Sample;
 
@@ -92,6 +106,7 @@ static float* sbWorkingBuffer = NULL;
 
 static Sample samples[MAX_SAMPLES];
 static Sound playingSounds[MAX_PLAYING_SOUNDS];
+static float voiceDecodeCache[MAX_PLAYING_SOUNDS][DECODE_CACHE_FRAMES * WORKING_CHANNELS];
 static IDSet playingIDSet; // we want to be able to change the currently playing sounds, this will help
 
 static StreamingSound streamingSounds[MAX_STREAMING_SOUNDS];
@@ -105,10 +120,244 @@ static float masterVolume = 1.0f;
 
 static float testTimePassed = 0.0f;
 
+// offline rendering, there is no audio device so the mixer is only run when snd_RenderOffline( ) is called
+static bool offlineMode = false;
+static SDL_IOStream* offlineWAVFile = NULL;
+static Uint32 offlineWAVDataSize = 0;
+
+static SoundMixStats mixStats;
+
 #define STREAM_READ_BUFFER_SIZE ( STREAMING_BUFFER_SAMPLES * WORKING_CHANNELS * sizeof( short ) )
 static short streamReadBuffer[STREAM_READ_BUFFER_SIZE];
 static float* sbStreamWorkingBuffer = NULL;
 
+// returns if there is anything that will consume what the mixer generates
+static bool isMixerActive( void )
+{
+	return ( mainAudioStream != NULL ) || offlineMode;
+}
+
+static void recordMixStats( Uint64 startCounter, int numFrames )
+{
+	float time = (float)( SDL_GetPerformanceCounter( ) - startCounter ) / (float)SDL_GetPerformanceFrequency( );
+
+	if( ( mixStats.numCallbacks == 0 ) || ( time < mixStats.minTime ) ) mixStats.minTime = time;
+	if( ( mixStats.numCallbacks == 0 ) || ( time > mixStats.maxTime ) ) mixStats.maxTime = time;
+	++mixStats.numCallbacks;
+	mixStats.totalFrames += numFrames;
+	mixStats.totalTime += time;
+}
+
+//***** IMA-ADPCM
+// each block stores, per channel, the predictor and step index before the first frame followed by ADPCM_BLOCK_FRAMES frames
+//  of 4-bit codes interleaved by channel
+static const int adpcmIndexTable[16] = {
+	-1, -1, -1, -1, 2, 4, 6, 8,
+	-1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static const int adpcmStepTable[89] = {
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+	19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+	50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+	337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+	876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+	2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+	5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+	15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+typedef struct {
+	Sint16 predictor;
+	Uint8 stepIndex;
+	Uint8 padding;
+} ADPCMChannelHeader;
+
+static size_t adpcmBlockSize( int numChannels )
+{
+	return ( sizeof( ADPCMChannelHeader ) * numChannels ) + ( ( ADPCM_BLOCK_FRAMES * numChannels ) / 2 );
+}
+
+// updates the state the same way for both encoding and decoding so they stay in sync
+static void adpcmStep( Uint8 code, int* predictor, int* stepIndex )
+{
+	int step = adpcmStepTable[*stepIndex];
+	int delta = step >> 3;
+	if( code & 4 ) delta += step;
+	if( code & 2 ) delta += ( step >> 1 );
+	if( code & 1 ) delta += ( step >> 2 );
+
+	(*predictor) += ( code & 8 ) ? -delta : delta;
+	if( (*predictor) > SDL_MAX_SINT16 ) (*predictor) = SDL_MAX_SINT16;
+	if( (*predictor) < SDL_MIN_SINT16 ) (*predictor) = SDL_MIN_SINT16;
+
+	(*stepIndex) += adpcmIndexTable[code];
+	if( (*stepIndex) < 0 ) (*stepIndex) = 0;
+	if( (*stepIndex) > 88 ) (*stepIndex) = 88;
+}
+
+static Uint8 adpcmEncodeSample( Sint16 sample, int* predictor, int* stepIndex )
+{
+	int step = adpcmStepTable[*stepIndex];
+	int diff = sample - (*predictor);
+	Uint8 code = 0;
+
+	if( diff < 0 ) {
+		code = 8;
+		diff = -diff;
+	}
+
+	if( diff >= step ) {
+		code |= 4;
+		diff -= step;
+	}
+	step >>= 1;
+	if( diff >= step ) {
+		code |= 2;
+		diff -= step;
+	}
+	step >>= 1;
+	if( diff >= step ) {
+		code |= 1;
+	}
+
+	adpcmStep( code, predictor, stepIndex );
+	return code;
+}
+
+// returns the encoded data, numFrames is the number of frames in pcmData
+static Uint8* adpcmEncode( const Sint16* pcmData, int numFrames, int numChannels, size_t* outSize )
+{
+	int numBlocks = ( numFrames + ADPCM_BLOCK_FRAMES - 1 ) / ADPCM_BLOCK_FRAMES;
+	size_t blockSize = adpcmBlockSize( numChannels );
+	(*outSize) = blockSize * numBlocks;
+
+	Uint8* encoded = mem_Allocate( *outSize );
+	if( encoded == NULL ) {
+		return NULL;
+	}
+	SDL_memset( encoded, 0, *outSize );
+
+	int predictor[2] = { 0, 0 };
+	int stepIndex[2] = { 0, 0 };
+	for( int b = 0; b < numBlocks; ++b ) {
+		Uint8* block = encoded + ( b * blockSize );
+		ADPCMChannelHeader* headers = (ADPCMChannelHeader*)block;
+		Uint8* codes = block + ( sizeof( ADPCMChannelHeader ) * numChannels );
+
+		for( int c = 0; c < numChannels; ++c ) {
+			headers[c].predictor = (Sint16)predictor[c];
+			headers[c].stepIndex = (Uint8)stepIndex[c];
+			headers[c].padding = 0;
+		}
+
+		int firstFrame = b * ADPCM_BLOCK_FRAMES;
+		for( int f = 0; ( f < ADPCM_BLOCK_FRAMES ) && ( ( firstFrame + f ) < numFrames ); ++f ) {
+			for( int c = 0; c < numChannels; ++c ) {
+				int codeIdx = ( f * numChannels ) + c;
+				Uint8 code = adpcmEncodeSample( pcmData[( ( firstFrame + f ) * numChannels ) + c], &predictor[c], &stepIndex[c] );
+				codes[codeIdx / 2] |= ( codeIdx & 1 ) ? ( code << 4 ) : code;
+			}
+		}
+	}
+
+	return encoded;
+}
+
+static void adpcmDecodeBlock( const Uint8* block, int numChannels, int numFrames, float* out )
+{
+	const ADPCMChannelHeader* headers = (const ADPCMChannelHeader*)block;
+	const Uint8* codes = block + ( sizeof( ADPCMChannelHeader ) * numChannels );
+
+	int predictor[2];
+	int stepIndex[2];
+	for( int c = 0; c < numChannels; ++c ) {
+		predictor[c] = headers[c].predictor;
+		stepIndex[c] = headers[c].stepIndex;
+	}
+
+	int numCodes = numFrames * numChannels;
+	for( int i = 0; i < numCodes; ++i ) {
+		int c = ( numChannels == 1 ) ? 0 : ( i & 1 );
+		Uint8 code = ( i & 1 ) ? ( codes[i / 2] >> 4 ) : ( codes[i / 2] & 0x0F );
+		adpcmStep( code, &predictor[c], &stepIndex[c] );
+		out[i] = (float)predictor[c] / 32768.0f;
+	}
+}
+
+//***** Decode on play
+// decodes the block of frames that contains frame into the sound's decode cache, returns if it was successful
+static bool decodeIntoCache( int voiceIdx, Sound* snd, Sample* sample, int frame )
+{
+	float* cache = voiceDecodeCache[voiceIdx];
+
+	switch( sample->storage ) {
+	case SS_PCM16: {
+		const Sint16* pcm = (const Sint16*)sample->data;
+		int count = SDL_min( DECODE_CACHE_FRAMES, sample->numSamples - frame );
+		int numValues = count * sample->numChannels;
+		pcm += frame * sample->numChannels;
+		for( int i = 0; i < numValues; ++i ) {
+			cache[i] = (float)pcm[i] / 32768.0f;
+		}
+		snd->cacheStart = frame;
+		snd->cacheFrames = count;
+		} return true;
+	case SS_ADPCM: {
+		int block = frame / ADPCM_BLOCK_FRAMES;
+		int firstFrame = block * ADPCM_BLOCK_FRAMES;
+		int count = SDL_min( ADPCM_BLOCK_FRAMES, sample->numSamples - firstFrame );
+		adpcmDecodeBlock( (const Uint8*)sample->data + ( block * adpcmBlockSize( sample->numChannels ) ), sample->numChannels, count, cache );
+		snd->cacheStart = firstFrame;
+		snd->cacheFrames = count;
+		} return true;
+	case SS_VORBIS: {
+		if( snd->vorbis == NULL ) return false;
+
+		// vorbis is only cheap when decoding sequentially, so only seek when we jump backwards or skip ahead a lot
+		int cacheEnd = snd->cacheStart + snd->cacheFrames;
+		int decodeStart = cacheEnd;
+		if( ( frame < cacheEnd ) || ( frame >= ( cacheEnd + DECODE_CACHE_FRAMES ) ) ) {
+			if( !stb_vorbis_seek( snd->vorbis, (unsigned int)frame ) ) return false;
+			decodeStart = frame;
+		}
+
+		do {
+			int count = stb_vorbis_get_samples_float_interleaved( snd->vorbis, sample->numChannels, cache, DECODE_CACHE_FRAMES * sample->numChannels );
+			if( count <= 0 ) return false;
+			snd->cacheStart = decodeStart;
+			snd->cacheFrames = count;
+			decodeStart += count;
+		} while( frame >= decodeStart );
+		} return true;
+	default:
+		ASSERT_ALWAYS( "Trying to decode a sample that doesn't need it." );
+		return false;
+	}
+}
+
+// makes sure frame is available and returns the frames in the range [outFirstFrame, outEndFrame) that can be read
+//  without decoding anything else, returns NULL if there was an issue
+static const float* acquireFrames( int voiceIdx, Sound* snd, Sample* sample, int frame, int* outFirstFrame, int* outEndFrame )
+{
+	if( sample->storage == SS_FLOAT ) {
+		(*outFirstFrame) = 0;
+		(*outEndFrame) = sample->numSamples;
+		return (const float*)sample->data;
+	}
+
+	if( ( frame < snd->cacheStart ) || ( frame >= ( snd->cacheStart + snd->cacheFrames ) ) ) {
+		if( !decodeIntoCache( voiceIdx, snd, sample, frame ) ) {
+			return NULL;
+		}
+	}
+
+	(*outFirstFrame) = snd->cacheStart;
+	(*outEndFrame) = snd->cacheStart + snd->cacheFrames;
+	return voiceDecodeCache[voiceIdx];
+}
+
 void mixerCallback_OLD( void* userdata, Uint8* streamData, int len )
 {
 	// unless we actually have any data it should be silence
@@ -146,29 +395,43 @@ void mixerCallback_OLD( void* userdata, Uint8* streamData, int len )
 		
 		bool soundDone = false;
 		float volume = snd->volume * sbSoundGroups[snd->group].volume * masterVolume;
-		for( int s = 0; ( s < numSamples ) && !soundDone; ++s ) {
+		float leftVolume = volume * inverseLerp( 1.0f, 0.0f, snd->pan );
+		float rightVolume = volume * inverseLerp( -1.0f, 0.0f, snd->pan );
+		int s = 0;
+		while( ( s < numSamples ) && !soundDone ) {
+			int firstFrame;
+			int endFrame;
+			const float* frames = acquireFrames( i, snd, sample, (int)snd->pos, &firstFrame, &endFrame );
+			if( frames == NULL ) {
+				soundDone = true;
+				break;
+			}
 
-			int streamIdx = ( s * WORKING_CHANNELS );
+			// mix until we need frames that aren't available
+			for( ; ( s < numSamples ) && !soundDone; ++s ) {
+				int frame = (int)snd->pos;
+				if( ( frame < firstFrame ) || ( frame >= endFrame ) ) break;
 
-			// we're assuming stereo output here
-			if( sample->numChannels == 1 ) {
-				float data = sample->data[(int)snd->pos] * volume;
-/* left */		sbWorkingBuffer[streamIdx] += data * inverseLerp( 1.0f, 0.0f, snd->pan );
-/* right */		sbWorkingBuffer[streamIdx+1] += data * inverseLerp( -1.0f, 0.0f, snd->pan );
-				snd->pos += snd->pitch; // TODO: do we want to take an average of the samples?
-			} else {
-				// if the sample is stereo then we ignore panning
-				//  NOTE: Pitch change doesn't work with stereo samples yet
-				sbWorkingBuffer[streamIdx] += sample->data[(int)snd->pos] * volume;
-				sbWorkingBuffer[streamIdx+1] += sample->data[(int)snd->pos+1] * volume;
-				snd->pos += 2.0f;
-			}
+				int streamIdx = ( s * WORKING_CHANNELS );
+				const float* data = frames + ( ( frame - firstFrame ) * sample->numChannels );
 
-			if( snd->pos >= sample->numSamples ) {
-				if( sample->loops ) {
-					snd->pos -= (float)sample->numSamples;
+				// we're assuming stereo output here
+				if( sample->numChannels == 1 ) {
+	/* left */		sbWorkingBuffer[streamIdx] += data[0] * leftVolume;
+	/* right */		sbWorkingBuffer[streamIdx+1] += data[0] * rightVolume;
 				} else {
-					soundDone = true;
+					// if the sample is stereo then we ignore panning
+					sbWorkingBuffer[streamIdx] += data[0] * volume;
+					sbWorkingBuffer[streamIdx+1] += data[1] * volume;
+				}
+				snd->pos += snd->pitch; // TODO: do we want to take an average of the samples?
+
+				if( snd->pos >= sample->numSamples ) {
+					if( sample->loops ) {
+						snd->pos -= (float)sample->numSamples;
+					} else {
+						soundDone = true;
+					}
 				}
 			}
 		}
@@ -254,65 +517,177 @@ void mixerCallback( void* userData, SDL_AudioStream* stream, int additionalAmoun
 	if( additionalAmount > 0 ) {
 		Uint8* data = SDL_stack_alloc( Uint8, additionalAmount );
 		if( data != NULL ) {
+			Uint64 startCounter = SDL_GetPerformanceCounter( );
 			mixerCallback_OLD( userData, data, additionalAmount );
+			recordMixStats( startCounter, additionalAmount / ( WORKING_CHANNELS * SDL_AUDIO_BYTESIZE( WORKING_FORMAT ) ) );
 			SDL_PutAudioStreamData( stream, data, additionalAmount );
 			SDL_stack_free( data );
 		}
 	}
 }
 
-int snd_LoadSample( const char* fileName, Uint8 desiredChannels, bool loops )
+// reads the entire file into memory, returns NULL if it fails
+static Uint8* loadEntireFile( const char* fileName, size_t* outSize )
 {
-	ASSERT( ( desiredChannels >= 1 ) && ( desiredChannels <= 2 ) );
+	SDL_IOStream* ioStream = SDL_IOFromFile( fileName, "rb" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open %s: %s", fileName, SDL_GetError( ) );
+		return NULL;
+	}
 
-	int newIdx = -1;
-	for( int i = 0; ( i < ARRAY_SIZE( samples ) ) && ( newIdx < 0 ); ++i ) {
-		if( samples[i].data == NULL ) {
-			newIdx = i;
-		}
+	Uint8* data = NULL;
+	Sint64 size = SDL_GetIOSize( ioStream );
+	if( size <= 0 ) {
+		llog( LOG_ERROR, "Unable to get size of %s: %s", fileName, SDL_GetError( ) );
+		goto clean_up;
 	}
 
-	if( newIdx < 0 ) {
-		llog( LOG_ERROR, "Unable to find free space for sample." );
-		return -1;
+	data = mem_Allocate( (size_t)size );
+	if( data == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate memory for %s", fileName );
+		goto clean_up;
 	}
 
-	// read the entire file into memory and decode it
-	int channels;
-	int rate;
+	if( SDL_ReadIO( ioStream, data, (size_t)size ) != (size_t)size ) {
+		llog( LOG_ERROR, "Unable to read %s: %s", fileName, SDL_GetError( ) );
+		mem_Release( data );
+		data = NULL;
+		goto clean_up;
+	}
+
+	(*outSize) = (size_t)size;
+
+clean_up:
+	SDL_CloseIO( ioStream );
+	return data;
+}
+
+// loads and converts the file into the storage requested, doesn't touch any of the mixer state so it's safe to call from
+//  any thread, returns if it was successful
+static bool createSample( const char* fileName, Uint8 desiredChannels, bool loops, SampleStorage storage, Sample* outSample )
+{
+	SDL_memset( outSample, 0, sizeof( *outSample ) );
+	outSample->loops = loops;
+	outSample->numChannels = desiredChannels;
+
+	bool success = false;
+	size_t fileSize = 0;
+	Uint8* fileData = loadEntireFile( fileName, &fileSize );
 	short* loadData = NULL;
-	int numSamples = stb_vorbis_decode_filename( fileName, &channels, &rate, &loadData );
 	Uint8* destData = NULL;
 
+	if( fileData == NULL ) {
+		goto clean_up;
+	}
+
+	if( storage == SS_VORBIS ) {
+		// we can only decode straight into the mixer if we don't need any conversion
+		int error;
+		stb_vorbis* vorbis = stb_vorbis_open_memory( fileData, (int)fileSize, &error, NULL );
+		if( vorbis == NULL ) {
+			llog( LOG_ERROR, "Unable to open %s for decoding: %i", fileName, error );
+			goto clean_up;
+		}
+
+		stb_vorbis_info info = stb_vorbis_get_info( vorbis );
+		int numSamples = (int)stb_vorbis_stream_length_in_samples( vorbis );
+		stb_vorbis_close( vorbis );
+
+		if( ( info.sample_rate == WORKING_RATE ) && ( info.channels == desiredChannels ) && ( numSamples > 0 ) ) {
+			outSample->storage = SS_VORBIS;
+			outSample->data = fileData;
+			outSample->dataSize = fileSize;
+			outSample->numSamples = numSamples;
+			fileData = NULL;
+			success = true;
+			goto clean_up;
+		}
+
+		llog( LOG_INFO, "%s needs conversion to be played, storing it as 16-bit PCM instead of vorbis.", fileName );
+		storage = SS_PCM16;
+	}
+
+	// decode it
+	int channels;
+	int rate;
+	int numSamples = stb_vorbis_decode_memory( fileData, (int)fileSize, &channels, &rate, &loadData );
+
 	if( numSamples <= 0 ) {
-		newIdx = -1;
-		llog( LOG_ERROR, "No samples in sound file or file doesn't exist." );
+		llog( LOG_ERROR, "No samples in sound file %s", fileName );
 		goto clean_up;
 	}
 
-	// convert it
+	// convert it, anything that isn't stored as floats is stored as 16-bit at the working rate
 	int destLen = 0;
+	SDL_AudioFormat destFormat = ( storage == SS_FLOAT ) ? WORKING_FORMAT : SDL_AUDIO_S16LE;
 	const SDL_AudioSpec srcSpec = { SDL_AUDIO_S16LE, channels, rate };
-	const SDL_AudioSpec destSpec = { WORKING_FORMAT, desiredChannels, WORKING_RATE };
+	const SDL_AudioSpec destSpec = { destFormat, desiredChannels, WORKING_RATE };
 	if( !SDL_ConvertAudioSamples( &srcSpec, (const Uint8*)loadData, numSamples * channels * sizeof( loadData[0] ), &destSpec, &destData, &destLen ) ) {
 		llog( LOG_ERROR, "Unable to convert sound: %s", SDL_GetError( ) );
-		newIdx = -1;
 		goto clean_up;
 	}
 
+	outSample->storage = storage;
+	outSample->numSamples = destLen / ( desiredChannels * SDL_AUDIO_BYTESIZE( destFormat ) );
+
 	// store it
-	samples[newIdx].data = mem_Allocate( destLen );
+	if( storage == SS_ADPCM ) {
+		outSample->data = adpcmEncode( (const Sint16*)destData, outSample->numSamples, desiredChannels, &( outSample->dataSize ) );
+	} else {
+		outSample->data = mem_Allocate( destLen );
+		outSample->dataSize = destLen;
+		if( outSample->data != NULL ) {
+			SDL_memcpy( outSample->data, destData, destLen );
+		}
+	}
 
-	memcpy( samples[newIdx].data, destData, destLen );
+	if( outSample->data == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate memory for sound %s", fileName );
+		goto clean_up;
+	}
 
-	samples[newIdx].numChannels = desiredChannels;
-	samples[newIdx].numSamples = destLen / ( desiredChannels * ( ( SDL_AUDIO_MASK_BITSIZE & WORKING_FORMAT ) / 8 ) );
-	samples[newIdx].loops = loops;
+	success = true;
 
 clean_up:
 	// clean up the working data
+	mem_Release( fileData );
 	mem_Release( loadData );
 	SDL_free( destData );
+	return success;
+}
+
+// returns the index of the first unused sample slot, or -1 if there are none
+static int findFreeSampleIndex( void )
+{
+	for( int i = 0; i < ARRAY_SIZE( samples ); ++i ) {
+		if( samples[i].data == NULL ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+int snd_LoadSample( const char* fileName, Uint8 desiredChannels, bool loops )
+{
+	return snd_LoadSampleAs( fileName, desiredChannels, loops, SS_FLOAT );
+}
+
+int snd_LoadSampleAs( const char* fileName, Uint8 desiredChannels, bool loops, SampleStorage storage )
+{
+	ASSERT( ( desiredChannels >= 1 ) && ( desiredChannels <= 2 ) );
+	ASSERT( ( storage >= 0 ) && ( storage < NUM_SAMPLE_STORAGES ) );
+
+	int newIdx = findFreeSampleIndex( );
+	if( newIdx < 0 ) {
+		llog( LOG_ERROR, "Unable to find free space for sample." );
+		return -1;
+	}
+
+	if( !createSample( fileName, desiredChannels, loops, storage, &( samples[newIdx] ) ) ) {
+		SDL_memset( &( samples[newIdx] ), 0, sizeof( samples[newIdx] ) );
+		return -1;
+	}
+
 	return newIdx;
 }
 
@@ -320,20 +695,17 @@ typedef struct {
 	const char* fileName;
 	Uint8 desiredChannels;
 	bool loops;
+	SampleStorage storage;
 	int* outID;
 
-	SDL_AudioStream* audioStream;
-
-	float* audioData;
-	int audioDataLen;
+	Sample sample;
 
-	//SDL_AudioCVT loadConverter;
 	void ( *onLoadDone )( int );
 } ThreadedSoundLoadData;
 
 static void cleanUpThreadedSoundLoadData( ThreadedSoundLoadData* data )
 {
-	mem_Release( data->audioData );
+	mem_Release( data->sample.data );
 	mem_Release( data );
 }
 
@@ -346,25 +718,15 @@ static void bindSampleJob( void* data )
 
 	ThreadedSoundLoadData* loadData = (ThreadedSoundLoadData*)data;
 
-	int newIdx = -1;
-	for( int i = 0; ( i < ARRAY_SIZE( samples ) ) && ( newIdx < 0 ); ++i ) {
-		if( samples[i].data == NULL ) {
-			newIdx = i;
-		}
-	}
-
+	int newIdx = findFreeSampleIndex( );
 	if( newIdx < 0 ) {
 		llog( LOG_ERROR, "Unable to find free space for sample." );
 		goto clean_up;
 	}
 
-	// store it
-	samples[newIdx].data = mem_Allocate( loadData->audioDataLen );
-	SDL_memcpy( samples[newIdx].data, loadData->audioData, loadData->audioDataLen );
-
-	samples[newIdx].numChannels = loadData->desiredChannels;
-	samples[newIdx].numSamples = loadData->audioDataLen / ( loadData->desiredChannels * SDL_AUDIO_BYTESIZE( WORKING_FORMAT ) );
-	samples[newIdx].loops = loadData->loops;
+	// store it, the sample now owns the data
+	samples[newIdx] = loadData->sample;
+	loadData->sample.data = NULL;
 
 	(*(loadData->outID)) = newIdx;
 
@@ -398,42 +760,21 @@ static void loadSampleJob( void* data )
 
 	ThreadedSoundLoadData* loadData = (ThreadedSoundLoadData*)data;
 
-	// read the entire file into memory and decode it
-	int channels;
-	int rate;
-	short* buffer;
-	int numSamples = stb_vorbis_decode_filename( loadData->fileName, &channels, &rate, &buffer );
-
-	if( numSamples < 0 ) {
-		llog( LOG_ERROR, "Error decoding sound sample %s", loadData->fileName );
-		goto error;
-	}
-
-	// convert it
-	int destLen = 0;
-	Uint8* destData = NULL;
-	const SDL_AudioSpec srcSpec = { SDL_AUDIO_S16LE, channels, rate };
-	const SDL_AudioSpec destSpec = { WORKING_FORMAT, loadData->desiredChannels, WORKING_RATE };
-	if( !SDL_ConvertAudioSamples( &srcSpec, (const Uint8*)buffer, numSamples * channels * sizeof( buffer[0] ), &destSpec, &destData, &destLen ) ) {
-		llog( LOG_ERROR, "Unable to convert sound: %s", SDL_GetError( ) );
-		goto error;
+	if( !createSample( loadData->fileName, loadData->desiredChannels, loadData->loops, loadData->storage, &( loadData->sample ) ) ) {
+		llog( LOG_ERROR, "Error loading sound sample %s", loadData->fileName );
+		jq_AddMainThreadJob( loadSampleFailedJob, (void*)loadData );
+		return;
 	}
 
-	// copy resulting data
-	loadData->audioData = mem_Allocate( destLen );
-	loadData->audioDataLen = destLen;
-	SDL_memcpy( loadData->audioData, destData, destLen );
-	SDL_free( destData );
-
 	jq_AddMainThreadJob( bindSampleJob, (void*)loadData );
-
-	return;
-
-error:
-	jq_AddMainThreadJob( loadSampleFailedJob, (void*)loadData );
 }
 
 void snd_ThreadedLoadSample( const char* fileName, Uint8 desiredChannels, bool loops, int* outID, void (*onLoadDone)( int ) )
+{
+	snd_ThreadedLoadSampleAs( fileName, desiredChannels, loops, SS_FLOAT, outID, onLoadDone );
+}
+
+void snd_ThreadedLoadSampleAs( const char* fileName, Uint8 desiredChannels, bool loops, SampleStorage storage, int* outID, void (*onLoadDone)( int ) )
 {
 	ASSERT_AND_IF_NOT( onLoadDone != NULL ) return;
 	ASSERT_AND_IF_NOT( ( desiredChannels >= 1 ) && ( desiredChannels <= 2 ) ) {
@@ -457,20 +798,45 @@ void snd_ThreadedLoadSample( const char* fileName, Uint8 desiredChannels, bool l
 	loadData->fileName = fileName;
 	loadData->desiredChannels = desiredChannels;
 	loadData->loops = loops;
+	loadData->storage = storage;
 	loadData->outID = outID;
 	loadData->onLoadDone = onLoadDone;
-	loadData->audioData = NULL;
+	SDL_memset( &( loadData->sample ), 0, sizeof( loadData->sample ) );
 
 	jq_AddJob( loadSampleJob, (void*)loadData );
 }
 
-/* Sets up the SDL mixer. Returns 0 on success. */
-int snd_Init( unsigned int numGroups )
+size_t snd_GetSampleMemoryUsage( int sampleID )
+{
+	ASSERT_AND_IF_NOT( ( sampleID >= 0 ) && ( sampleID < MAX_SAMPLES ) ) return 0;
+	return samples[sampleID].dataSize;
+}
+
+float snd_GetSampleLength( int sampleID )
+{
+	ASSERT_AND_IF_NOT( ( sampleID >= 0 ) && ( sampleID < MAX_SAMPLES ) ) return 0.0f;
+	return (float)samples[sampleID].numSamples / (float)WORKING_RATE;
+}
+
+const char* snd_GetSampleStorageName( SampleStorage storage )
+{
+	switch( storage ) {
+	case SS_FLOAT: return "float";
+	case SS_PCM16: return "pcm16";
+	case SS_ADPCM: return "ima-adpcm";
+	case SS_VORBIS: return "vorbis";
+	default: return "unknown";
+	}
+}
+
+// sets up everything the mixer needs that doesn't depend on the output device
+static int initMixerState( unsigned int numGroups )
 {
 	ASSERT( numGroups > 0 );
 
 	// clear out the samples storage
 	SDL_memset( samples, 0, ARRAY_SIZE( samples ) * sizeof( samples[0] ) );
+	SDL_memset( playingSounds, 0, ARRAY_SIZE( playingSounds ) * sizeof( playingSounds[0] ) );
 	for( int i = 0; i < MAX_STREAMING_SOUNDS; ++i ) {
 		streamingSounds[i].access = NULL;
 		streamingSounds[i].sdlStream = NULL;
@@ -485,6 +851,37 @@ int snd_Init( unsigned int numGroups )
 		return -1;
 	}
 
+	workingSilence = SDL_GetSilenceValueForFormat( WORKING_FORMAT );
+
+	sb_Add( sbWorkingBuffer, INITIAL_WORKING_BUFFER_SIZE );
+	if( sbWorkingBuffer == NULL ) {
+		llog( LOG_CRITICAL, "Failed to create audio working buffer." );
+		return -1;
+	}
+
+	sb_Add( sbSoundGroups, numGroups );
+	for( size_t i = 0; i < sb_Count( sbSoundGroups ); ++i ) {
+		sbSoundGroups[i].volume = 1.0f;
+	}
+
+	// load the master volume
+	masterVolume = 1.0f;
+
+	snd_ResetMixStats( );
+
+	return 0;
+}
+
+/* Sets up the SDL mixer. Returns 0 on success. */
+int snd_Init( unsigned int numGroups )
+{
+	offlineMode = false;
+
+	if( initMixerState( numGroups ) < 0 ) {
+		return -1;
+	}
+
+	// the device starts paused so the callback won't be touching anything until we resume it below
 	const SDL_AudioSpec spec = { WORKING_FORMAT, WORKING_CHANNELS, WORKING_RATE };
 	mainAudioStream = SDL_OpenAudioDeviceStream( SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &spec, mixerCallback, NULL );
 
@@ -498,41 +895,176 @@ int snd_Init( unsigned int numGroups )
 	llog( LOG_DEBUG, "Audio: channels - %i  %i", desired.channels, delivered.channels );
 	llog( LOG_DEBUG, "Audio: samples - %i  %i", desired.samples, delivered.samples );//*/
 
-	workingSilence = SDL_GetSilenceValueForFormat( WORKING_FORMAT );
+	SDL_ResumeAudioStreamDevice( mainAudioStream );
 
-	SDL_LockAudioStream( mainAudioStream );
-	sb_Add( sbWorkingBuffer, INITIAL_WORKING_BUFFER_SIZE );
-	SDL_UnlockAudioStream( mainAudioStream );
-	if( sbWorkingBuffer == NULL ) {
-		llog( LOG_CRITICAL, "Failed to create audio working buffer." );
+	return 0;
+}
+
+// Sets up the mixer without an audio device. Nothing is mixed until snd_RenderOffline( ) is called, all mixing
+//  happens on the calling thread. Returns 0 on success.
+int snd_InitOffline( unsigned int numGroups )
+{
+	mainAudioStream = NULL;
+	offlineMode = true;
+
+	if( initMixerState( numGroups ) < 0 ) {
+		offlineMode = false;
 		return -1;
 	}
 
-	sb_Add( sbSoundGroups, numGroups );
-	for( size_t i = 0; i < sb_Count( sbSoundGroups ); ++i ) {
-		sbSoundGroups[i].volume = 1.0f;
+	return 0;
+}
+
+bool snd_IsOffline( void )
+{
+	return offlineMode;
+}
+
+int snd_GetWorkingRate( void )
+{
+	return WORKING_RATE;
+}
+
+int snd_GetWorkingChannels( void )
+{
+	return WORKING_CHANNELS;
+}
+
+// Runs the mixer for the number of frames, buffer must be able to hold numFrames * snd_GetWorkingChannels( ) floats.
+//  If a wav file was opened with snd_BeginOfflineWAV( ) the results are written out to it as well.
+void snd_RenderOffline( float* buffer, int numFrames )
+{
+	ASSERT_AND_IF_NOT( offlineMode ) return;
+	ASSERT_AND_IF_NOT( buffer != NULL ) return;
+	ASSERT_AND_IF_NOT( numFrames >= 0 ) return;
+
+	int len = numFrames * WORKING_CHANNELS * SDL_AUDIO_BYTESIZE( WORKING_FORMAT );
+
+	Uint64 startCounter = SDL_GetPerformanceCounter( );
+	mixerCallback_OLD( NULL, (Uint8*)buffer, len );
+	recordMixStats( startCounter, numFrames );
+
+	if( offlineWAVFile != NULL ) {
+		size_t written = SDL_WriteIO( offlineWAVFile, buffer, (size_t)len );
+		offlineWAVDataSize += (Uint32)written;
+		if( written != (size_t)len ) {
+			llog( LOG_ERROR, "Unable to write offline audio to wav file: %s", SDL_GetError( ) );
+		}
 	}
+}
 
-	// load the master volume
-	masterVolume = 1.0f;
+static bool writeWAVHeader( SDL_IOStream* ioStream, Uint32 dataSize )
+{
+	const Uint16 bytesPerSample = SDL_AUDIO_BYTESIZE( WORKING_FORMAT );
+	bool success = true;
+
+	success = success && ( SDL_WriteIO( ioStream, "RIFF", 4 ) == 4 );
+	success = success && SDL_WriteU32LE( ioStream, 36 + dataSize );
+	success = success && ( SDL_WriteIO( ioStream, "WAVE", 4 ) == 4 );
+
+	success = success && ( SDL_WriteIO( ioStream, "fmt ", 4 ) == 4 );
+	success = success && SDL_WriteU32LE( ioStream, 16 );
+	success = success && SDL_WriteU16LE( ioStream, 3 ); // IEEE float
+	success = success && SDL_WriteU16LE( ioStream, WORKING_CHANNELS );
+	success = success && SDL_WriteU32LE( ioStream, WORKING_RATE );
+	success = success && SDL_WriteU32LE( ioStream, WORKING_RATE * WORKING_CHANNELS * bytesPerSample );
+	success = success && SDL_WriteU16LE( ioStream, WORKING_CHANNELS * bytesPerSample );
+	success = success && SDL_WriteU16LE( ioStream, bytesPerSample * 8 );
+
+	success = success && ( SDL_WriteIO( ioStream, "data", 4 ) == 4 );
+	success = success && SDL_WriteU32LE( ioStream, dataSize );
+
+	return success;
+}
 
-	SDL_ResumeAudioStreamDevice( mainAudioStream );
+// Everything rendered with snd_RenderOffline( ) until snd_EndOfflineWAV( ) is called will be written out to fileName.
+//  Returns if the file was successfully opened.
+bool snd_BeginOfflineWAV( const char* fileName )
+{
+	ASSERT_AND_IF_NOT( offlineMode ) return false;
 
-	return 0;
+	snd_EndOfflineWAV( );
+
+	offlineWAVFile = SDL_IOFromFile( fileName, "wb" );
+	if( offlineWAVFile == NULL ) {
+		llog( LOG_ERROR, "Unable to open %s for writing offline audio: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	// sizes are filled in when we're done
+	offlineWAVDataSize = 0;
+	if( !writeWAVHeader( offlineWAVFile, 0 ) ) {
+		llog( LOG_ERROR, "Unable to write header for %s: %s", fileName, SDL_GetError( ) );
+		SDL_CloseIO( offlineWAVFile );
+		offlineWAVFile = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void snd_EndOfflineWAV( void )
+{
+	if( offlineWAVFile == NULL ) return;
+
+	if( ( SDL_SeekIO( offlineWAVFile, 0, SDL_IO_SEEK_SET ) < 0 ) || !writeWAVHeader( offlineWAVFile, offlineWAVDataSize ) ) {
+		llog( LOG_ERROR, "Unable to finalize offline wav file: %s", SDL_GetError( ) );
+	}
+
+	SDL_CloseIO( offlineWAVFile );
+	offlineWAVFile = NULL;
+	offlineWAVDataSize = 0;
+}
+
+// Timing for each time the mixer has run since the last reset, works with both the device and offline mixing.
+void snd_GetMixStats( SoundMixStats* outStats )
+{
+	ASSERT_AND_IF_NOT( outStats != NULL ) return;
+
+	SDL_LockAudioStream( mainAudioStream ); {
+		(*outStats) = mixStats;
+	} SDL_UnlockAudioStream( mainAudioStream );
+}
+
+void snd_ResetMixStats( void )
+{
+	SDL_LockAudioStream( mainAudioStream ); {
+		SDL_memset( &mixStats, 0, sizeof( mixStats ) );
+	} SDL_UnlockAudioStream( mainAudioStream );
 }
 
 void snd_CleanUp( )
 {
+	snd_EndOfflineWAV( );
 	snd_StopStreamingAllBut( -1 );
+
+	SDL_LockAudioStream( mainAudioStream ); {
+		idSet_Clear( &playingIDSet );
+		for( int i = 0; i < MAX_PLAYING_SOUNDS; ++i ) {
+			if( playingSounds[i].vorbis != NULL ) {
+				stb_vorbis_close( playingSounds[i].vorbis );
+				playingSounds[i].vorbis = NULL;
+			}
+		}
+	} SDL_UnlockAudioStream( mainAudioStream );
 	if( sbWorkingBuffer != NULL ) {
 		SDL_LockAudioStream( mainAudioStream ); {
 			sb_Release( sbStreamWorkingBuffer );
 			sb_Release( sbWorkingBuffer );
-		} SDL_LockAudioStream( mainAudioStream );
+		} SDL_UnlockAudioStream( mainAudioStream );
 	}
 
-	if( mainAudioStream == NULL ) return;
-	SDL_DestroyAudioStream( mainAudioStream );
+	offlineMode = false;
+
+	if( mainAudioStream != NULL ) {
+		SDL_DestroyAudioStream( mainAudioStream );
+		mainAudioStream = NULL;
+	}
+
+	// undo everything from initMixerState( ) so it can be initialized again
+	sb_Release( sbSoundGroups );
+	idSet_Destroy( &playingIDSet );
+	hashMap_Clear( &streamingSoundHashMap );
 }
 
 void snd_SetFocus( bool hasFocus )
@@ -558,7 +1090,7 @@ void snd_SetMasterVolume( float volume )
 
 float snd_GetVolume( unsigned int group )
 {
-    if( mainAudioStream == NULL ) return 0.0f;
+    if( !isMixerActive( ) ) return 0.0f;
     
 	ASSERT( group < sb_Count( sbSoundGroups ) );
 
@@ -567,7 +1099,7 @@ float snd_GetVolume( unsigned int group )
 
 void snd_SetVolume( float volume, unsigned int group )
 {
-    if( mainAudioStream == NULL ) return;
+    if( !isMixerActive( ) ) return;
     
 	ASSERT( group < sb_Count( sbSoundGroups ) );
 	ASSERT( ( volume >= 0.0f ) && ( volume <= 1.0f ) );
@@ -595,7 +1127,7 @@ float snd_VolumeTodB( float volume )
 // TODO: Some sort of event system so we can get when a sound has finished playing?
 EntityID snd_Play( int sampleID, float volume, float pitch, float pan, unsigned int group )
 {
-    if( mainAudioStream == NULL ) {
+    if( !isMixerActive( ) ) {
         return INVALID_ENTITY_ID;
     }
     
@@ -606,7 +1138,20 @@ EntityID snd_Play( int sampleID, float volume, float pitch, float pan, unsigned
 	ASSERT( group >= 0 );
 	ASSERT( group < sb_Count( sbSoundGroups ) );
 
+	// each sound playing a vorbis sample needs it's own decoder, create it before locking so we block the mixer for as
+	//  short a time as possible
+	stb_vorbis* vorbis = NULL;
+	if( samples[sampleID].storage == SS_VORBIS ) {
+		int error;
+		vorbis = stb_vorbis_open_memory( (const unsigned char*)samples[sampleID].data, (int)samples[sampleID].dataSize, &error, NULL );
+		if( vorbis == NULL ) {
+			llog( LOG_ERROR, "Unable to create decoder for sample: %i", error );
+			return INVALID_ENTITY_ID;
+		}
+	}
+
 	EntityID playingID = INVALID_ENTITY_ID;
+	stb_vorbis* oldVorbis = vorbis;
 	SDL_LockAudioStream( mainAudioStream ); {
 		playingID = idSet_ClaimID( &playingIDSet );
 		if( playingID != INVALID_ENTITY_ID ) {
@@ -617,9 +1162,18 @@ EntityID snd_Play( int sampleID, float volume, float pitch, float pan, unsigned
 			playingSounds[idx].pan = pan;
 			playingSounds[idx].pos = 0.0f;
 			playingSounds[idx].group = group;
+			playingSounds[idx].cacheStart = 0;
+			playingSounds[idx].cacheFrames = 0;
+			oldVorbis = playingSounds[idx].vorbis;
+			playingSounds[idx].vorbis = vorbis;
 		}
 	} SDL_UnlockAudioStream( mainAudioStream );
 
+	// either the decoder left by the last sound in this slot or the one we created if we couldn't play
+	if( oldVorbis != NULL ) {
+		stb_vorbis_close( oldVorbis );
+	}
+
 	return playingID;
 }
 
@@ -681,6 +1235,14 @@ void snd_UnloadSample( int sampleID )
 			}
 		}
 
+		// decoders can outlive the sound that used them, but not the data they're decoding
+		for( int i = 0; i < MAX_PLAYING_SOUNDS; ++i ) {
+			if( ( playingSounds[i].vorbis != NULL ) && ( playingSounds[i].sample == sampleID ) ) {
+				stb_vorbis_close( playingSounds[i].vorbis );
+				playingSounds[i].vorbis = NULL;
+			}
+		}
+
 		mem_Release( samples[sampleID].data );
 		samples[sampleID].data = NULL;
 	} SDL_UnlockAudioStream( mainAudioStream );
@@ -830,7 +1392,7 @@ error:
 
 void snd_ThreadedLoadStreaming( const char* fileName, bool loops, unsigned int group, int* outID, void (*onLoadDone)( int ) )
 {
-    if( mainAudioStream == NULL ) {
+    if( !isMixerActive( ) ) {
         if( onLoadDone != NULL ) {
             onLoadDone( 0 );
         }
@@ -871,7 +1433,7 @@ void snd_ChangeStreamLoopPoint( int streamID, unsigned int loopPoint )
 
 void snd_PlayStreaming( int streamID, float volume, float pan, unsigned int startSample ) // todo: fade in?
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
@@ -911,7 +1473,7 @@ void snd_PlayStreaming( int streamID, float volume, float pan, unsigned int star
 
 void snd_StopStreaming( int streamID )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
@@ -929,7 +1491,7 @@ void snd_StopStreaming( int streamID )
 
 void snd_StopStreamingAllBut( int streamID )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
@@ -947,7 +1509,7 @@ void snd_StopStreamingAllBut( int streamID )
 
 bool snd_IsStreamPlaying( int streamID )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return false;
 	}
     
@@ -957,7 +1519,7 @@ bool snd_IsStreamPlaying( int streamID )
 
 void snd_ChangeStreamVolume( int streamID, float volume )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
@@ -969,7 +1531,7 @@ void snd_ChangeStreamVolume( int streamID, float volume )
 
 void snd_ChangeStreamPan( int streamID, float pan )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
@@ -981,7 +1543,7 @@ void snd_ChangeStreamPan( int streamID, float pan )
 
 void snd_UnloadStream( int streamID )
 {
-	if( mainAudioStream == NULL ) {
+	if( !isMixerActive( ) ) {
 		return;
 	}
     
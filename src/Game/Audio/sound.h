@@ -25,9 +25,31 @@ float snd_dBToVolume( float dB );
 float snd_VolumeTodB( float volume );
 
 //***** Loaded all at once
+// How the sample is kept in memory, anything other than SS_FLOAT is decoded in small blocks as it's played, trading
+//  mixer time for memory. Ordered from most memory and least mixer time to least memory and most mixer time.
+//  SS_VORBIS keeps the file as is, if the file isn't at the working rate or doesn't have the desired number of channels
+//  it falls back to SS_PCM16.
+typedef enum {
+	SS_FLOAT,
+	SS_PCM16,
+	SS_ADPCM,
+	SS_VORBIS,
+	NUM_SAMPLE_STORAGES
+} SampleStorage;
+
+// stores the sample as SS_FLOAT
 int snd_LoadSample( const char* fileName, Uint8 desiredChannels, bool loops );
 void snd_ThreadedLoadSample( const char* fileName, Uint8 desiredChannels, bool loops, int* outID, void (*onLoadDone)( int ) );
 
+int snd_LoadSampleAs( const char* fileName, Uint8 desiredChannels, bool loops, SampleStorage storage );
+void snd_ThreadedLoadSampleAs( const char* fileName, Uint8 desiredChannels, bool loops, SampleStorage storage, int* outID, void (*onLoadDone)( int ) );
+
+// memory used to store the sample data in bytes
+size_t snd_GetSampleMemoryUsage( int sampleID );
+// length of the sample in seconds
+float snd_GetSampleLength( int sampleID );
+const char* snd_GetSampleStorageName( SampleStorage storage );
+
 // Returns an id that can be used to change the volume and pitch
 //  volume - how loud the sound will be, in the range [0,1], 0 being off, 1 being loudest
 //  pitch - pitch change for the sound, multiplies the sample rate, 1 for normal, lesser for slower, higher for faster
@@ -53,4 +75,32 @@ void snd_ChangeStreamVolume( int streamID, float volume );
 void snd_ChangeStreamPan( int streamID, float pan );
 void snd_UnloadStream( int streamID );
 
+//***** Offline rendering
+// Used when there is no audio device, everything is mixed on the calling thread when snd_RenderOffline() is called.
+//  Useful for benchmarking the mixer and creating renders for regression testing.
+int snd_InitOffline( unsigned int numGroups );
+bool snd_IsOffline( void );
+
+int snd_GetWorkingRate( void );
+int snd_GetWorkingChannels( void );
+
+// buffer must be able to hold numFrames * snd_GetWorkingChannels() floats, stored in LRLRLR order
+void snd_RenderOffline( float* buffer, int numFrames );
+
+// everything rendered between these calls is written out as a 32-bit float wav file
+bool snd_BeginOfflineWAV( const char* fileName );
+void snd_EndOfflineWAV( void );
+
+// timing of each run of the mixer, times are in seconds
+typedef struct {
+	Uint64 numCallbacks;
+	Uint64 totalFrames;
+	float totalTime;
+	float minTime;
+	float maxTime;
+} SoundMixStats;
+
+void snd_GetMixStats( SoundMixStats* outStats );
+void snd_ResetMixStats( void );
+
 #endif
@@ -0,0 +1,326 @@
+#include "soundScenario.h"
+
+#include <SDL3/SDL.h>
+
+#include "System/platformLog.h"
+#include "System/memory.h"
+#include "Utils/stretchyBuffer.h"
+#include "Utils/helpers.h"
+
+#define NAME_LEN 32
+#define RENDER_BLOCK_FRAMES 1024
+#define MAX_EVENT_ARGS 6
+
+typedef enum {
+	SET_SAMPLE,
+	SET_STREAM,
+	SET_PLAY,
+	SET_STOP,
+	SET_VOLUME,
+	SET_PITCH,
+	SET_PAN,
+	SET_PLAY_STREAM,
+	SET_STOP_STREAM,
+	SET_STREAM_VOLUME,
+	SET_GROUP_VOLUME,
+	SET_MASTER_VOLUME,
+	SET_END,
+	NUM_SCENARIO_EVENT_TYPES
+} ScenarioEventType;
+
+typedef struct {
+	const char* name;
+	int numArgs;
+} ScenarioEventDef;
+
+static ScenarioEventDef eventDefs[NUM_SCENARIO_EVENT_TYPES] = {
+	{ "sample", 4 },
+	{ "stream", 4 },
+	{ "play", 6 },
+	{ "stop", 1 },
+	{ "volume", 2 },
+	{ "pitch", 2 },
+	{ "pan", 2 },
+	{ "playStream", 3 },
+	{ "stopStream", 1 },
+	{ "streamVolume", 2 },
+	{ "groupVolume", 2 },
+	{ "masterVolume", 1 },
+	{ "end", 0 },
+};
+
+typedef struct {
+	Uint64 frame; // when the event happens
+	int line; // keeps events at the same time in the order they were written
+	ScenarioEventType type;
+	char* args[MAX_EVENT_ARGS]; // point into the loaded file text
+} ScenarioEvent;
+
+typedef struct {
+	char name[NAME_LEN];
+	int id;
+	EntityID soundID;
+} NamedSound;
+
+static int sortEvents( const void* left, const void* right )
+{
+	const ScenarioEvent* l = (const ScenarioEvent*)left;
+	const ScenarioEvent* r = (const ScenarioEvent*)right;
+
+	if( l->frame != r->frame ) {
+		return ( l->frame < r->frame ) ? -1 : 1;
+	}
+	return l->line - r->line;
+}
+
+static NamedSound* findNamed( NamedSound* sbNamed, const char* name )
+{
+	for( size_t i = 0; i < sb_Count( sbNamed ); ++i ) {
+		if( SDL_strcmp( sbNamed[i].name, name ) == 0 ) {
+			return &( sbNamed[i] );
+		}
+	}
+	return NULL;
+}
+
+static NamedSound* addNamed( NamedSound** sbNamed, const char* name )
+{
+	NamedSound* named = findNamed( *sbNamed, name );
+	if( named == NULL ) {
+		named = sb_Add( *sbNamed, 1 );
+		SDL_strlcpy( named->name, name, NAME_LEN );
+	}
+	named->id = -1;
+	named->soundID = INVALID_ENTITY_ID;
+	return named;
+}
+
+// returns a stretchy buffer of the events, sorted by time, the events reference the text in fileText
+static ScenarioEvent* parseScenario( char* fileText, const char* fileName )
+{
+	ScenarioEvent* sbEvents = NULL;
+	int lineNum = 0;
+	char* lineSave = NULL;
+	const int rate = snd_GetWorkingRate( );
+
+	for( char* line = SDL_strtok_r( fileText, "\r\n", &lineSave ); line != NULL; line = SDL_strtok_r( NULL, "\r\n", &lineSave ) ) {
+		++lineNum;
+
+		char* comment = SDL_strchr( line, '#' );
+		if( comment != NULL ) {
+			(*comment) = 0;
+		}
+
+		char* tokenSave = NULL;
+		const char* delimiters = " \t";
+		char* timeToken = SDL_strtok_r( line, delimiters, &tokenSave );
+		if( timeToken == NULL ) continue; // empty line
+
+		char* typeToken = SDL_strtok_r( NULL, delimiters, &tokenSave );
+		if( typeToken == NULL ) {
+			llog( LOG_WARN, "%s(%i): missing event type, skipping.", fileName, lineNum );
+			continue;
+		}
+
+		ScenarioEvent evt;
+		SDL_memset( &evt, 0, sizeof( evt ) );
+		evt.line = lineNum;
+		evt.type = NUM_SCENARIO_EVENT_TYPES;
+		for( int i = 0; i < NUM_SCENARIO_EVENT_TYPES; ++i ) {
+			if( SDL_strcmp( typeToken, eventDefs[i].name ) == 0 ) {
+				evt.type = (ScenarioEventType)i;
+				break;
+			}
+		}
+
+		if( evt.type == NUM_SCENARIO_EVENT_TYPES ) {
+			llog( LOG_WARN, "%s(%i): unknown event type %s, skipping.", fileName, lineNum, typeToken );
+			continue;
+		}
+
+		double time = SDL_atof( timeToken );
+		if( time < 0.0 ) time = 0.0;
+		evt.frame = (Uint64)( time * rate + 0.5 );
+
+		bool argsValid = true;
+		for( int i = 0; ( i < eventDefs[evt.type].numArgs ) && argsValid; ++i ) {
+			evt.args[i] = SDL_strtok_r( NULL, delimiters, &tokenSave );
+			argsValid = ( evt.args[i] != NULL );
+		}
+
+		if( !argsValid ) {
+			llog( LOG_WARN, "%s(%i): %s expects %i arguments, skipping.", fileName, lineNum, typeToken, eventDefs[evt.type].numArgs );
+			continue;
+		}
+
+		sb_Push( sbEvents, evt );
+	}
+
+	if( sb_Count( sbEvents ) > 0 ) {
+		SDL_qsort( sbEvents, sb_Count( sbEvents ), sizeof( sbEvents[0] ), sortEvents );
+	}
+
+	return sbEvents;
+}
+
+// returns if the scenario is done
+static bool runEvent( ScenarioEvent* evt, NamedSound** sbSamples, NamedSound** sbStreams, NamedSound** sbPlaying )
+{
+	NamedSound* named = NULL;
+
+	switch( evt->type ) {
+	case SET_SAMPLE:
+		named = addNamed( sbSamples, evt->args[0] );
+		named->id = snd_LoadSample( evt->args[1], (Uint8)SDL_atoi( evt->args[2] ), SDL_atoi( evt->args[3] ) != 0 );
+		if( named->id < 0 ) {
+			llog( LOG_WARN, "Scenario unable to load sample %s", evt->args[1] );
+		}
+		break;
+	case SET_STREAM:
+		named = addNamed( sbStreams, evt->args[0] );
+		named->id = snd_LoadStreaming( evt->args[1], SDL_atoi( evt->args[2] ) != 0, (unsigned int)SDL_atoi( evt->args[3] ) );
+		if( named->id < 0 ) {
+			llog( LOG_WARN, "Scenario unable to load stream %s", evt->args[1] );
+		}
+		break;
+	case SET_PLAY: {
+		NamedSound* sample = findNamed( *sbSamples, evt->args[0] );
+		if( sample == NULL ) {
+			llog( LOG_WARN, "Scenario trying to play unknown sample %s", evt->args[0] );
+			break;
+		}
+		named = addNamed( sbPlaying, evt->args[1] );
+		named->soundID = snd_Play( sample->id, (float)SDL_atof( evt->args[2] ), (float)SDL_atof( evt->args[3] ),
+			(float)SDL_atof( evt->args[4] ), (unsigned int)SDL_atoi( evt->args[5] ) );
+		} break;
+	case SET_STOP:
+		named = findNamed( *sbPlaying, evt->args[0] );
+		if( named != NULL ) snd_Stop( named->soundID );
+		break;
+	case SET_VOLUME:
+		named = findNamed( *sbPlaying, evt->args[0] );
+		if( named != NULL ) snd_ChangeSoundVolume( named->soundID, (float)SDL_atof( evt->args[1] ) );
+		break;
+	case SET_PITCH:
+		named = findNamed( *sbPlaying, evt->args[0] );
+		if( named != NULL ) snd_ChangeSoundPitch( named->soundID, (float)SDL_atof( evt->args[1] ) );
+		break;
+	case SET_PAN:
+		named = findNamed( *sbPlaying, evt->args[0] );
+		if( named != NULL ) snd_ChangeSoundPan( named->soundID, (float)SDL_atof( evt->args[1] ) );
+		break;
+	case SET_PLAY_STREAM:
+		named = findNamed( *sbStreams, evt->args[0] );
+		if( named != NULL ) snd_PlayStreaming( named->id, (float)SDL_atof( evt->args[1] ), (float)SDL_atof( evt->args[2] ), 0 );
+		break;
+	case SET_STOP_STREAM:
+		named = findNamed( *sbStreams, evt->args[0] );
+		if( named != NULL ) snd_StopStreaming( named->id );
+		break;
+	case SET_STREAM_VOLUME:
+		named = findNamed( *sbStreams, evt->args[0] );
+		if( named != NULL ) snd_ChangeStreamVolume( named->id, (float)SDL_atof( evt->args[1] ) );
+		break;
+	case SET_GROUP_VOLUME:
+		snd_SetVolume( (float)SDL_atof( evt->args[1] ), (unsigned int)SDL_atoi( evt->args[0] ) );
+		break;
+	case SET_MASTER_VOLUME:
+		snd_SetMasterVolume( (float)SDL_atof( evt->args[0] ) );
+		break;
+	case SET_END:
+		return true;
+	default:
+		ASSERT_ALWAYS( "Invalid scenario event type" );
+		break;
+	}
+
+	return false;
+}
+
+bool sndScenario_RunOffline( const char* scenarioFile, const char* outWAVFile, SoundMixStats* outStats )
+{
+	ASSERT_AND_IF_NOT( scenarioFile != NULL ) return false;
+
+	if( !snd_IsOffline( ) ) {
+		llog( LOG_ERROR, "Sound scenarios can only be run when the mixer is in offline mode." );
+		return false;
+	}
+
+	size_t fileSize = 0;
+	char* fileData = (char*)SDL_LoadFile( scenarioFile, &fileSize );
+	if( fileData == NULL ) {
+		llog( LOG_ERROR, "Unable to load sound scenario %s: %s", scenarioFile, SDL_GetError( ) );
+		return false;
+	}
+
+	ScenarioEvent* sbEvents = parseScenario( fileData, scenarioFile );
+	NamedSound* sbSamples = NULL;
+	NamedSound* sbStreams = NULL;
+	NamedSound* sbPlaying = NULL;
+	float* renderBuffer = NULL;
+	bool success = false;
+
+	if( sb_Count( sbEvents ) == 0 ) {
+		llog( LOG_ERROR, "No events in sound scenario %s", scenarioFile );
+		goto clean_up;
+	}
+
+	renderBuffer = mem_Allocate( sizeof( float ) * RENDER_BLOCK_FRAMES * snd_GetWorkingChannels( ) );
+	if( renderBuffer == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate render buffer for sound scenario." );
+		goto clean_up;
+	}
+
+	if( ( outWAVFile != NULL ) && !snd_BeginOfflineWAV( outWAVFile ) ) {
+		goto clean_up;
+	}
+
+	snd_ResetMixStats( );
+
+	// render in blocks, splitting them where events happen so everything lands on the frame it should
+	Uint64 currFrame = 0;
+	Uint64 endFrame = sb_Last( sbEvents ).frame;
+	size_t nextEvent = 0;
+	bool done = false;
+	while( !done ) {
+		while( ( nextEvent < sb_Count( sbEvents ) ) && ( sbEvents[nextEvent].frame <= currFrame ) ) {
+			done = runEvent( &( sbEvents[nextEvent] ), &sbSamples, &sbStreams, &sbPlaying ) || done;
+			++nextEvent;
+		}
+
+		if( done || ( currFrame >= endFrame ) ) break;
+
+		Uint64 blockEnd = currFrame + RENDER_BLOCK_FRAMES;
+		if( ( nextEvent < sb_Count( sbEvents ) ) && ( sbEvents[nextEvent].frame < blockEnd ) ) {
+			blockEnd = sbEvents[nextEvent].frame;
+		}
+
+		snd_RenderOffline( renderBuffer, (int)( blockEnd - currFrame ) );
+		currFrame = blockEnd;
+	}
+
+	snd_EndOfflineWAV( );
+
+	if( outStats != NULL ) {
+		snd_GetMixStats( outStats );
+	}
+
+	success = true;
+
+clean_up:
+	for( size_t i = 0; i < sb_Count( sbSamples ); ++i ) {
+		if( sbSamples[i].id >= 0 ) snd_UnloadSample( sbSamples[i].id );
+	}
+	for( size_t i = 0; i < sb_Count( sbStreams ); ++i ) {
+		if( sbStreams[i].id >= 0 ) snd_UnloadStream( sbStreams[i].id );
+	}
+
+	mem_Release( renderBuffer );
+	sb_Release( sbPlaying );
+	sb_Release( sbStreams );
+	sb_Release( sbSamples );
+	sb_Release( sbEvents );
+	SDL_free( fileData );
+
+	return success;
+}
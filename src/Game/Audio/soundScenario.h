@@ -0,0 +1,32 @@
+#ifndef SOUND_SCENARIO_H
+#define SOUND_SCENARIO_H
+
+#include <stdbool.h>
+
+#include "Audio/sound.h"
+
+// Scripted list of sound events that get run through the offline mixer, gives us deterministic renders we can compare
+//  against and a repeatable workload for benchmarking the mixer. The mixer must have been set up with snd_InitOffline().
+//
+// The file is a list of lines, each starting with the time in seconds the event happens at. Names are used to refer to
+//  loaded samples, streams, and playing sounds. Anything after a '#' is ignored.
+//   <time> sample <name> <file> <channels> <loops>
+//   <time> stream <name> <file> <loops> <group>
+//   <time> play <sampleName> <soundName> <volume> <pitch> <pan> <group>
+//   <time> stop <soundName>
+//   <time> volume <soundName> <volume>
+//   <time> pitch <soundName> <pitch>
+//   <time> pan <soundName> <pan>
+//   <time> playStream <streamName> <volume> <pan>
+//   <time> stopStream <streamName>
+//   <time> streamVolume <streamName> <volume>
+//   <time> groupVolume <group> <volume>
+//   <time> masterVolume <volume>
+//   <time> end
+// If there is no end event the scenario stops after the last event.
+
+// Runs the scenario, if outWAVFile is not NULL the render is written out to it. If outStats is not NULL it will be filled
+//  out with the mixer timing for the render. Returns if the scenario was able to be run.
+bool sndScenario_RunOffline( const char* scenarioFile, const char* outWAVFile, SoundMixStats* outStats );
+
+#endif // inclusion guard
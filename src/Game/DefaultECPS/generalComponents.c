@@ -44,11 +44,25 @@ static bool serializeGeneralCallback( Serializer* s, GeneralCallback* callback,
 	ASSERT_AND_IF_NOT( callback != NULL ) return false;
 	ASSERT_AND_IF_NOT( s != NULL ) return false;
 
+	bool wasScript = ( callback->type == CBT_LUA );
 	SERIALIZE_ENUM( s, type, "callbackType", callback->type, CallbackType, return false );
+	if( wasScript && ( callback->type != CBT_LUA ) ) {
+		xLua_ReleaseFunction( callback->script.func );
+	}
+
 	if( callback->type == CBT_SOURCE ) {
 		SERIALIZE_CHECK( s->trackedECPSCallback( s, "sourceFuncID", &( callback->source.callback ) ), type, desc, return false );
 	} else if( callback->type == CBT_LUA ) {
-		SERIALIZE_CHECK( s->cString( s, "scriptFunc", &( callback->script.callback ) ), type, "scriptFunc", return false );
+		// the name is what's stored, if it's changed when reading then we need a new handle
+		const char* currName = wasScript ? xLua_GetFunctionName( callback->script.func ) : NULL;
+		char* funcName = createStringCopy( ( currName != NULL ) ? currName : "" );
+		bool success = s->cString( s, "scriptFunc", &funcName );
+		if( success && ( ( currName == NULL ) || ( SDL_strcmp( currName, funcName ) != 0 ) ) ) {
+			if( wasScript ) xLua_ReleaseFunction( callback->script.func );
+			callback->script.func = createScriptCallback( funcName ).script.func;
+		}
+		mem_Release( funcName );
+		SERIALIZE_CHECK( success, type, "scriptFunc", return false );
 	} else {
 		llog( LOG_ERROR, "Unknown callback type when saving %s for %s.", desc, type );
 		return false;
@@ -774,10 +788,16 @@ static void pointerScriptCleanUp( ECPS* ecps, const Entity* entity, void* compDa
 {
 	GCPointerResponseData* data = (GCPointerResponseData*)compData;
 
-	if( data->overResponse.type == CBT_LUA ) mem_Release( data->overResponse.script.callback );
-	if( data->leaveResponse.type == CBT_LUA ) mem_Release( data->leaveResponse.script.callback );
-	if( data->pressResponse.type == CBT_LUA ) mem_Release( data->pressResponse.script.callback );
-	if( data->releaseResponse.type == CBT_LUA ) mem_Release( data->releaseResponse.script.callback );
+	cleanUpGeneralCallback( &( data->overResponse ) );
+	cleanUpGeneralCallback( &( data->leaveResponse ) );
+	cleanUpGeneralCallback( &( data->pressResponse ) );
+	cleanUpGeneralCallback( &( data->releaseResponse ) );
+}
+
+static void shortLivedCleanUp( ECPS* ecps, const Entity* entity, void* compData, bool fullCleanUp )
+{
+	GCShortLivedData* data = (GCShortLivedData*)compData;
+	cleanUpGeneralCallback( &( data->onDestroyedCallback ) );
 }
 
 void gc_Register( ECPS* ecps )
@@ -800,11 +820,19 @@ void gc_Register( ECPS* ecps )
 	gcPosTweenCompID = ecps_AddComponentType( ecps, "P_TWN", 0, sizeof( GCVec2TweenData ), ALIGN_OF( GCVec2TweenData ), NULL, NULL, serializeVec2TweenComp );
 	gcScaleTweenCompID = ecps_AddComponentType( ecps, "S_TWN", 0, sizeof( GCVec2TweenData ), ALIGN_OF( GCVec2TweenData ), NULL, NULL, serializeVec2TweenComp );
 	gcAlphaTweenCompID = ecps_AddComponentType( ecps, "A_TWN", 0, sizeof( GCFloatTweenData ), ALIGN_OF( GCFloatTweenData ), NULL, NULL, serializeFloatTweenComp );
-	gcShortLivedCompID = ecps_AddComponentType( ecps, "GC_LIFE", 0, sizeof( GCShortLivedData ), ALIGN_OF( GCShortLivedData ), NULL, NULL, serializeShortLivedComp );
+	gcShortLivedCompID = ecps_AddComponentType( ecps, "GC_LIFE", 0, sizeof( GCShortLivedData ), ALIGN_OF( GCShortLivedData ), shortLivedCleanUp, NULL, serializeShortLivedComp );
 	gcAnimSpriteCompID = ecps_AddComponentType( ecps, "ANIM_SPR", 0, sizeof( GCAnimatedSpriteData ), ALIGN_OF( GCAnimatedSpriteData ), NULL, NULL, serializeAnimatedSpriteComp );
 
 	gcGroupIDCompID = ecps_AddComponentType( ecps, "GRP", 0, sizeof( GCGroupIDData ), ALIGN_OF( GCGroupIDData ), NULL, NULL, serializeGroupIDComp );
 
+	// these are only plain values, so they can be saved as packed data instead of going through a serializer
+	ecps_CompileComponentSerialization( ecps, gcTransformCompID );
+	ecps_CompileComponentSerialization( ecps, gcClrCompID );
+	ecps_CompileComponentSerialization( ecps, gcPointerCollisionCompID );
+	ecps_CompileComponentSerialization( ecps, gcFloatVal0CompID );
+	ecps_CompileComponentSerialization( ecps, gcStencilCompID );
+	ecps_CompileComponentSerialization( ecps, gcSizeCompID );
+	ecps_CompileComponentSerialization( ecps, gcGroupIDCompID );
 }
 
 void gc_SwapTransformStates( GCTransformData* tf )
@@ -933,7 +961,10 @@ GeneralCallback createScriptCallback( const char* callback )
 {
 	GeneralCallback gc;
 	gc.type = CBT_LUA;
-	gc.script.callback = createStringCopy( callback );
+	gc.script.func = XLUA_INVALID_FUNC_HANDLE;
+	if( ( callback != NULL ) && ( callback[0] != 0 ) ) {
+		gc.script.func = xLua_AcquireFunction( callback, "i|" );
+	}
 	return gc;
 }
 
@@ -947,7 +978,7 @@ void callGeneralCallback( GeneralCallback* callback, ECPS* ecps, Entity* entity
 		if( callback->source.callback != NULL ) callback->source.callback( ecps, entity );
 	} else if( callback->type == CBT_LUA ) {
 		EntityID id = entity->id;
-		if( callback->script.callback != NULL ) xLua_CallLuaFunction( callback->script.callback, "i|", (int)id );
+		if( callback->script.func != XLUA_INVALID_FUNC_HANDLE ) xLua_CallFunction( callback->script.func, (int)id );
 	} else {
 		llog( LOG_ERROR, "Unknown callback type." );
 	}
@@ -957,6 +988,7 @@ void cleanUpGeneralCallback( GeneralCallback* callback )
 {
 	ASSERT( callback != NULL );
 	if( callback->type == CBT_LUA ) {
-		mem_Release( callback->script.callback );
+		xLua_ReleaseFunction( callback->script.func );
+		callback->script.func = XLUA_INVALID_FUNC_HANDLE;
 	}
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "System/ECPS/ecps_trackedCallbacks.h"
 #include "System/shared.h"
 #include "UI/text.h"
+#include "System/luaInterface.h"
 
 // used for callbacks that could point to source or script files
 typedef struct {
@@ -22,7 +23,7 @@ typedef struct {
 
 typedef struct {
 	CallbackType type;
-	char* callback; // name of the Lua function to call
+	XLuaFuncHandle func; // Lua function to call, takes the entity id
 } ScriptCallback;
 
 typedef union {
@@ -165,6 +166,7 @@ typedef struct {
 	HorizTextAlignment horizAlign;
 	VertTextAlignment vertAlign;
 	bool useTextArea;
+	bool cacheLayout; // for text that rarely changes, uses the text layout cache instead of laying it out every frame
 } GCTextData;
 extern ComponentID gcTextCompID;
 
@@ -218,11 +218,22 @@ static void renderText( ECPS* ecps, const Entity* entity )
 	}
 
 	if( txt->useTextArea ) {
-		txt_DisplayTextArea( txt->text, &baseMatrix, currSize, clr, txt->horizAlign, txt->vertAlign, txt->fontID, 0, NULL, txt->camFlags, txt->depth, txt->pixelSize );
+		if( txt->cacheLayout ) {
+			txt_DisplayCachedTextArea( txt->text, &baseMatrix, currSize, clr, txt->horizAlign, txt->vertAlign, txt->fontID, txt->camFlags, txt->depth, txt->pixelSize );
+		} else {
+			txt_DisplayTextArea( txt->text, &baseMatrix, currSize, clr, txt->horizAlign, txt->vertAlign, txt->fontID, 0, NULL, txt->camFlags, txt->depth, txt->pixelSize );
+		}
 	} else {
 		Vector2 pos;
 		mat3_GetPosition( &baseMatrix, &pos );
-		txt_DisplayString( txt->text, pos, clr, txt->horizAlign, txt->vertAlign, txt->fontID, txt->camFlags, txt->depth, txt->pixelSize );
+		if( txt->cacheLayout ) {
+			// only use the position, same as the uncached version
+			Matrix3 posMatrix = IDENTITY_MATRIX_3;
+			mat3_SetPosition( &posMatrix, &pos );
+			txt_DisplayCachedString( txt->text, &posMatrix, clr, txt->horizAlign, txt->vertAlign, txt->fontID, txt->camFlags, txt->depth, txt->pixelSize );
+		} else {
+			txt_DisplayString( txt->text, pos, clr, txt->horizAlign, txt->vertAlign, txt->fontID, txt->camFlags, txt->depth, txt->pixelSize );
+		}
 	}
 }
 
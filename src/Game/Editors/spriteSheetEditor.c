@@ -23,6 +23,8 @@ static struct nk_rect windowBounds = { 150.0f, 10.0f, 800.0f, 600.f };
 static int xPadding = 2;
 static int yPadding = 2;
 static int maxSize = 4096;
+static bool trimImages = false;
+static bool exportBinary = false;
 
 static void addFileEntry( const char* path )
 {
@@ -114,8 +116,14 @@ static void loadSpriteSheetSetup( const char* filePath )
 
 static void exportSpriteSheet( const char* filePath )
 {
-	if( !img_SaveSpriteSheet( filePath, sbEntries, maxSize, xPadding, yPadding ) ) {
+	if( !img_SaveSpriteSheet( filePath, sbEntries, maxSize, xPadding, yPadding, trimImages ) ) {
 		hub_CreateDialog( "Export Sprite Sheet Error", "There was an error exporting the sprite sheet. Check the log file for more information.", DT_ERROR, 1, "OK", NULL );
+		return;
+	}
+
+	// the images for the pages are left next to it so the next export can reuse them
+	if( exportBinary && !img_ConvertSpriteSheetToBinary( filePath, filePath ) ) {
+		hub_CreateDialog( "Export Sprite Sheet Error", "There was an error converting the sprite sheet to binary. Check the log file for more information.", DT_ERROR, 1, "OK", NULL );
 	}
 }
 
@@ -188,6 +196,14 @@ void spriteSheetEditor_IMGUIProcess( void )
 			nk_property_int( ctx, "Max Dim Size", 256, &maxSize, 32768, 1, 0.0f );
 		} nk_layout_row_end( ctx );
 
+		nk_layout_row_dynamic( ctx, 34, 2 );
+		nk_bool trim = trimImages;
+		nk_checkbox_label( ctx, "Trim transparent borders", &trim );
+		trimImages = trim ? true : false;
+		nk_bool binary = exportBinary;
+		nk_checkbox_label( ctx, "Export binary", &binary );
+		exportBinary = binary ? true : false;
+
 		nk_layout_row_begin( ctx, NK_STATIC, 1, 1 ); // padding
 		size_t itemToDelete = SIZE_MAX;
 		// list of locations: path, and delete button
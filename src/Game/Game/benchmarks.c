@@ -0,0 +1,73 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+
+#include "System/platformLog.h"
+#include "Utils/helpers.h"
+
+typedef struct {
+	const char* name;
+	const char* usage;
+	BenchmarkFunc func;
+	bool needsRendering;
+} Benchmark;
+
+static Benchmark benchmarks[] = {
+	{ "audio", "<scenarioFile> [outWAVFile] [repeats]", bench_AudioMixer, false },
+	{ "audioStorage", "<soundFile> [numLoads] [channels]", bench_AudioSampleStorage, false },
+	{ "text", "<fontFile> [pixelSize] [frames] [stringsPerFrame]", bench_TextRendering, true },
+	{ "textAtlas", "<fontFile> [pixelSize] [firstCodepoint] [numCodepoints] [frames]", bench_TextGlyphAtlas, true },
+	{ "sdfFont", "<fontFile> [maxWorkers] [repeats]", bench_SDFFontGeneration, false },
+	{ "luaCallback", "[numCalls] [repeats]", bench_LuaCallbacks, false },
+	{ "luaComponents", "[numEntities] [frames]", bench_LuaComponentAccess, true },
+	{ "luaLoad", "<scriptDirectory> [repeats]", bench_LuaLoad, false },
+	{ "luaGC", "[frames] [allocationsPerFrame] [liveObjects]", bench_LuaGC, false },
+	{ "luaProfiler", "[frames] [outputDirectory]", bench_LuaProfiler, false },
+	{ "aStar", "[gridSize] [queries]", bench_AStar, false },
+	{ "jps", "[gridSize] [queries]", bench_JumpPointSearch, false },
+	{ "hpa", "[gridSize] [clusterSize] [queries]", bench_HierarchicalPathing, false },
+	{ "pathService", "[gridSize] [agents] [frameBudget]", bench_PathService, false },
+	{ "flowField", "[gridSize] [agents]", bench_FlowField, false },
+	{ "urMCTS", "[secondsPerMove] [games]", bench_GameOfUrMCTS, false },
+	{ "urLatency", "[games] [maxSeconds]", bench_GameOfUrLatency, false },
+	{ "flocking", "[agents] [ticks]", bench_Flocking, false },
+	{ "hexGrid", "[range] [queries]", bench_HexGrid, false },
+	{ "serializer", "[components]", bench_Serialization, false },
+	{ "ecpsSnapshot", "[entities] [outputDirectory]", bench_ECPSSnapshot, false },
+};
+
+int bench_Run( const char* name, int argc, char** argv )
+{
+	for( size_t i = 0; i < ARRAY_SIZE( benchmarks ); ++i ) {
+		if( SDL_strcmp( benchmarks[i].name, name ) == 0 ) {
+			llog( LOG_INFO, "Running benchmark %s", name );
+			int result = benchmarks[i].func( argc, argv );
+			if( result != 0 ) {
+				llog( LOG_ERROR, "Benchmark %s failed. Usage: -bench %s %s", name, name, benchmarks[i].usage );
+			}
+			return result;
+		}
+	}
+
+	llog( LOG_ERROR, "Unknown benchmark %s", name );
+	bench_LogAvailable( );
+	return -1;
+}
+
+bool bench_NeedsRendering( const char* name )
+{
+	for( size_t i = 0; i < ARRAY_SIZE( benchmarks ); ++i ) {
+		if( SDL_strcmp( benchmarks[i].name, name ) == 0 ) {
+			return benchmarks[i].needsRendering;
+		}
+	}
+	return false;
+}
+
+void bench_LogAvailable( void )
+{
+	llog( LOG_INFO, "Available benchmarks:" );
+	for( size_t i = 0; i < ARRAY_SIZE( benchmarks ); ++i ) {
+		llog( LOG_INFO, "  -bench %s %s", benchmarks[i].name, benchmarks[i].usage );
+	}
+}
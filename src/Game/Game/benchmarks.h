@@ -0,0 +1,46 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <stdbool.h>
+
+// Benchmarks that can be run without any user interaction, for use on the build machines. Most are run without a window
+//  or any rendering, the ones that need textures get the full set up but never present anything.
+//  Started from the command line with: -bench <name> [arguments...]
+//  Results are written out through the log.
+
+// arguments are everything after the name of the benchmark, returns 0 on success
+typedef int (*BenchmarkFunc)( int argc, char** argv );
+
+// Runs the benchmark with the matching name, returns the result of the benchmark or -1 if it wasn't found.
+int bench_Run( const char* name, int argc, char** argv );
+
+// Returns if the benchmark needs a window and the renderer set up before it's run.
+bool bench_NeedsRendering( const char* name );
+
+// Logs all the benchmarks available.
+void bench_LogAvailable( void );
+
+// Individual benchmarks, used by bench_Run().
+int bench_AudioMixer( int argc, char** argv );
+int bench_AudioSampleStorage( int argc, char** argv );
+int bench_TextRendering( int argc, char** argv );
+int bench_TextGlyphAtlas( int argc, char** argv );
+int bench_SDFFontGeneration( int argc, char** argv );
+int bench_LuaCallbacks( int argc, char** argv );
+int bench_LuaComponentAccess( int argc, char** argv );
+int bench_LuaLoad( int argc, char** argv );
+int bench_LuaGC( int argc, char** argv );
+int bench_LuaProfiler( int argc, char** argv );
+int bench_AStar( int argc, char** argv );
+int bench_JumpPointSearch( int argc, char** argv );
+int bench_HierarchicalPathing( int argc, char** argv );
+int bench_PathService( int argc, char** argv );
+int bench_FlowField( int argc, char** argv );
+int bench_GameOfUrMCTS( int argc, char** argv );
+int bench_GameOfUrLatency( int argc, char** argv );
+int bench_Flocking( int argc, char** argv );
+int bench_HexGrid( int argc, char** argv );
+int bench_Serialization( int argc, char** argv );
+int bench_ECPSSnapshot( int argc, char** argv );
+
+#endif // inclusion guard
@@ -0,0 +1,157 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+
+#include "Audio/sound.h"
+#include "Audio/soundScenario.h"
+#include "System/platformLog.h"
+#include "System/memory.h"
+
+// Renders the scenario through the offline mixer, the first run is written out to the wav file if there is one so it can
+//  be compared against previous renders. Repeats are used to get more stable timings.
+int bench_AudioMixer( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		return -1;
+	}
+
+	const char* scenarioFile = argv[0];
+	const char* outWAVFile = ( argc >= 2 ) ? argv[1] : NULL;
+	int repeats = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 1;
+	if( repeats < 1 ) repeats = 1;
+
+	if( snd_InitOffline( 2 ) < 0 ) {
+		llog( LOG_ERROR, "Unable to initialize offline mixer." );
+		return -1;
+	}
+
+	int result = 0;
+	float bestAvg = 0.0f;
+	float worstMax = 0.0f;
+	for( int i = 0; i < repeats; ++i ) {
+		SoundMixStats stats;
+		if( !sndScenario_RunOffline( scenarioFile, ( i == 0 ) ? outWAVFile : NULL, &stats ) ) {
+			result = -1;
+			break;
+		}
+
+		if( stats.numCallbacks == 0 ) {
+			llog( LOG_WARN, "Scenario %s didn't render anything.", scenarioFile );
+			break;
+		}
+
+		float avg = stats.totalTime / (float)stats.numCallbacks;
+		float audioSeconds = (float)stats.totalFrames / (float)snd_GetWorkingRate( );
+		llog( LOG_INFO, "Run %i: %i mixes, %.3f seconds of audio in %.6f seconds (%.1fx realtime), per mix avg: %.6f  min: %.6f  max: %.6f",
+			i, (int)stats.numCallbacks, audioSeconds, stats.totalTime,
+			( stats.totalTime > 0.0f ) ? ( audioSeconds / stats.totalTime ) : 0.0f,
+			avg, stats.minTime, stats.maxTime );
+
+		if( ( i == 0 ) || ( avg < bestAvg ) ) bestAvg = avg;
+		if( stats.maxTime > worstMax ) worstMax = stats.maxTime;
+	}
+
+	if( result == 0 ) {
+		llog( LOG_INFO, "Best average mix time: %.6f  Worst mix time: %.6f", bestAvg, worstMax );
+	}
+
+	snd_CleanUp( );
+
+	return result;
+}
+
+#define STORAGE_BENCH_MAX_LOADS 200
+#define STORAGE_BENCH_MIX_SECONDS 10
+#define STORAGE_BENCH_BLOCK_FRAMES 1024
+
+// Loads the same sound repeatedly with each storage type, then mixes as many voices as we can with them. Gives the memory
+//  vs. mixer time tradeoff of each storage type so we can decide what to use for which sounds.
+int bench_AudioSampleStorage( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		return -1;
+	}
+
+	const char* soundFile = argv[0];
+	int numLoads = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 100;
+	int numChannels = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 1;
+	numLoads = SDL_clamp( numLoads, 1, STORAGE_BENCH_MAX_LOADS );
+	numChannels = SDL_clamp( numChannels, 1, 2 );
+
+	if( snd_InitOffline( 1 ) < 0 ) {
+		llog( LOG_ERROR, "Unable to initialize offline mixer." );
+		return -1;
+	}
+
+	int result = 0;
+	int sampleIDs[STORAGE_BENCH_MAX_LOADS];
+	int numFrames = STORAGE_BENCH_BLOCK_FRAMES * snd_GetWorkingChannels( );
+	float* mixBuffer = mem_Allocate( sizeof( float ) * numFrames );
+	if( mixBuffer == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate mix buffer." );
+		snd_CleanUp( );
+		return -1;
+	}
+
+	for( SampleStorage storage = SS_FLOAT; ( storage < NUM_SAMPLE_STORAGES ) && ( result == 0 ); ++storage ) {
+		const char* storageName = snd_GetSampleStorageName( storage );
+
+		// load
+		Uint64 loadStart = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numLoads; ++i ) {
+			sampleIDs[i] = snd_LoadSampleAs( soundFile, (Uint8)numChannels, true, storage );
+			if( sampleIDs[i] < 0 ) {
+				llog( LOG_ERROR, "Unable to load %s as %s.", soundFile, storageName );
+				for( int u = 0; u < i; ++u ) {
+					snd_UnloadSample( sampleIDs[u] );
+				}
+				result = -1;
+				break;
+			}
+		}
+		if( result != 0 ) break;
+		float loadTime = (float)( SDL_GetPerformanceCounter( ) - loadStart ) / (float)SDL_GetPerformanceFrequency( );
+
+		size_t totalBytes = 0;
+		float totalLength = 0.0f;
+		for( int i = 0; i < numLoads; ++i ) {
+			totalBytes += snd_GetSampleMemoryUsage( sampleIDs[i] );
+			totalLength += snd_GetSampleLength( sampleIDs[i] );
+		}
+
+		// mix, fill every voice with a different sample so nothing can be shared between them
+		snd_ResetMixStats( );
+		int numVoices = 0;
+		for( int i = 0; i < numLoads; ++i ) {
+			if( snd_Play( sampleIDs[i], 0.1f, 1.0f, 0.0f, 0 ) == INVALID_ENTITY_ID ) {
+				break;
+			}
+			++numVoices;
+		}
+
+		int framesLeft = STORAGE_BENCH_MIX_SECONDS * snd_GetWorkingRate( );
+		while( framesLeft > 0 ) {
+			int frames = SDL_min( framesLeft, STORAGE_BENCH_BLOCK_FRAMES );
+			snd_RenderOffline( mixBuffer, frames );
+			framesLeft -= frames;
+		}
+
+		SoundMixStats stats;
+		snd_GetMixStats( &stats );
+		float avgMix = ( stats.numCallbacks > 0 ) ? ( stats.totalTime / (float)stats.numCallbacks ) : 0.0f;
+
+		llog( LOG_INFO, "%-10s load: %.4fs total, %.6fs avg  memory: %u bytes, %.1f bytes per second of audio  mix (%i voices): %.4fs total, %.6fs avg, %.6fs max",
+			storageName, loadTime, loadTime / (float)numLoads, (unsigned int)totalBytes,
+			( totalLength > 0.0f ) ? ( (float)totalBytes / totalLength ) : 0.0f,
+			numVoices, stats.totalTime, avgMix, stats.maxTime );
+
+		for( int i = 0; i < numLoads; ++i ) {
+			snd_UnloadSample( sampleIDs[i] );
+		}
+	}
+
+	mem_Release( mixBuffer );
+	snd_CleanUp( );
+
+	return result;
+}
@@ -0,0 +1,181 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+
+#include "Math/mathUtil.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "System/random.h"
+#include "Utils/hexGrid.h"
+#include "Utils/stretchyBuffer.h"
+
+#define HEX_MAP_SIZE 256
+
+static float hexSecondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+static bool blockedByRegion( HexGridCoord coord, void* data )
+{
+	return hex_RegionContains( (const HexRegion*)data, coord );
+}
+
+// makes sure the iterators give the same coords as the stretchy buffer versions, returns the number that don't
+static int verifyIterators( RandomGroup* rg )
+{
+	int mismatches = 0;
+	HexGridCoord* sbList = NULL;
+
+	for( int32_t range = 0; range <= 40; ++range ) {
+		HexGridCoord center = { rand_GetRangeS32( rg, -100, 100 ), rand_GetRangeS32( rg, -100, 100 ) };
+
+		hex_AllInRange( center, range, &sbList );
+		size_t count = 0;
+		HexSpiralIter spiralIter;
+		HexGridCoord c;
+		for( hex_SpiralIterInit( &spiralIter, center, range ); hex_SpiralIterNext( &spiralIter, &c ); ++count ) {
+			if( hex_Distance( center, c ) > range ) ++mismatches;
+		}
+		if( ( count != sb_Count( sbList ) ) || ( count != hex_NumInRange( range ) ) ) ++mismatches;
+
+		if( range > 0 ) {
+			sb_Clear( sbList );
+			hex_Ring( center, range, &sbList );
+			count = 0;
+			HexRingIter ringIter;
+			for( hex_RingIterInit( &ringIter, center, range ); hex_RingIterNext( &ringIter, &c ); ++count ) {
+				if( ( count >= sb_Count( sbList ) ) || ( sbList[count].q != c.q ) || ( sbList[count].r != c.r ) ) ++mismatches;
+			}
+			if( count != sb_Count( sbList ) ) ++mismatches;
+		}
+	}
+
+	// lines have to step to a neighbor each time and end at the end
+	for( int i = 0; i < 10000; ++i ) {
+		HexGridCoord start = { rand_GetRangeS32( rg, -100, 100 ), rand_GetRangeS32( rg, -100, 100 ) };
+		HexGridCoord end = { rand_GetRangeS32( rg, -100, 100 ), rand_GetRangeS32( rg, -100, 100 ) };
+
+		HexLineIter lineIter;
+		HexGridCoord c;
+		HexGridCoord prev = start;
+		int32_t steps = 0;
+		for( hex_LineIterInit( &lineIter, start, end ); hex_LineIterNext( &lineIter, &c ); ++steps ) {
+			if( hex_Distance( prev, c ) > 1 ) ++mismatches;
+			prev = c;
+		}
+		if( ( steps != hex_Distance( start, end ) + 1 ) || ( prev.q != end.q ) || ( prev.r != end.r ) ) ++mismatches;
+	}
+
+	sb_Release( sbList );
+	return mismatches;
+}
+
+int bench_HexGrid( int argc, char** argv )
+{
+	int32_t range = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 20;
+	int numQueries = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 10000;
+	if( range <= 0 ) range = 20;
+	if( numQueries <= 0 ) numQueries = 10000;
+	range = MIN( range, HEX_MAX_FOV_RANGE );
+
+	llog( LOG_INFO, "Hex grid: range %i, %i queries, %ix%i map", range, numQueries, HEX_MAP_SIZE, HEX_MAP_SIZE );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0x4e8 );
+
+	int mismatches = verifyIterators( &rg );
+	llog( LOG_INFO, "  %i mismatches between the iterators and the stretchy buffer versions", mismatches );
+
+	HexRegion walls;
+	HexRegion region;
+	if( !hex_RegionCreate( &walls, HEX_MAP_SIZE, HEX_MAP_SIZE ) ) {
+		return 1;
+	}
+	if( !hex_RegionCreate( &region, HEX_MAP_SIZE, HEX_MAP_SIZE ) ) {
+		hex_RegionDestroy( &walls );
+		return 1;
+	}
+
+	HexGridCoord* centers = mem_Allocate( sizeof( HexGridCoord ) * numQueries );
+	for( int i = 0; i < numQueries; ++i ) {
+		centers[i] = hex_RectIndexToCoord( (uint32_t)rand_GetArrayEntry( &rg, HEX_MAP_SIZE * HEX_MAP_SIZE ), HEX_MAP_SIZE, HEX_MAP_SIZE );
+	}
+
+	// the same work for each, summing the coords so nothing gets optimized out
+	int64_t sum = 0;
+	HexGridCoord* sbList = NULL;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numQueries; ++i ) {
+		hex_AllInRange( centers[i], range, &sbList );
+		for( size_t j = 0; j < sb_Count( sbList ); ++j ) {
+			sum += sbList[j].q + sbList[j].r;
+		}
+	}
+	float sbTime = hexSecondsSince( start );
+	sb_Release( sbList );
+
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numQueries; ++i ) {
+		HexRangeIter iter;
+		HexGridCoord c;
+		for( hex_RangeIterInit( &iter, centers[i], range ); hex_RangeIterNext( &iter, &c ); ) {
+			sum += c.q + c.r;
+		}
+	}
+	float rangeIterTime = hexSecondsSince( start );
+
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numQueries; ++i ) {
+		HexSpiralIter iter;
+		HexGridCoord c;
+		for( hex_SpiralIterInit( &iter, centers[i], range ); hex_SpiralIterNext( &iter, &c ); ) {
+			sum += c.q + c.r;
+		}
+	}
+	float spiralTime = hexSecondsSince( start );
+
+	start = SDL_GetPerformanceCounter( );
+	size_t regionCount = 0;
+	for( int i = 0; i < numQueries; ++i ) {
+		hex_RegionClear( &region );
+		hex_RegionAddRange( &region, centers[i], range );
+		regionCount += hex_RegionCount( &region );
+	}
+	float regionTime = hexSecondsSince( start );
+
+	float perQuery = 1000000.0f / (float)numQueries;
+	llog( LOG_INFO, "  all in range, %zu hexes: stretchy buffer %.3f us, range iterator %.3f us, spiral table %.3f us, region %.3f us (%lld)",
+		hex_NumInRange( range ), sbTime * perQuery, rangeIterTime * perQuery, spiralTime * perQuery, regionTime * perQuery, (long long)sum );
+	llog( LOG_INFO, "    region fill and count includes clearing all %i hexes, %.1f in the map on average", HEX_MAP_SIZE * HEX_MAP_SIZE,
+		(float)regionCount / (float)numQueries );
+
+	// field of view with a few different amounts of walls
+	int numFOV = MAX( numQueries / 10, 1 );
+	int wallDensities[] = { 0, 40, 8 };
+	for( int d = 0; d < 3; ++d ) {
+		hex_RegionClear( &walls );
+		if( wallDensities[d] > 0 ) {
+			for( int i = 0; i < ( HEX_MAP_SIZE * HEX_MAP_SIZE ) / wallDensities[d]; ++i ) {
+				hex_RegionAdd( &walls, hex_RectIndexToCoord( (uint32_t)rand_GetArrayEntry( &rg, HEX_MAP_SIZE * HEX_MAP_SIZE ), HEX_MAP_SIZE, HEX_MAP_SIZE ) );
+			}
+		}
+
+		size_t visible = 0;
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numFOV; ++i ) {
+			hex_FieldOfView( centers[i], range, blockedByRegion, &walls, &region );
+			visible += hex_RegionCount( &region );
+		}
+		float fovTime = hexSecondsSince( start );
+
+		llog( LOG_INFO, "  field of view with %zu walls: %.3f us, %.1f hexes visible on average", hex_RegionCount( &walls ),
+			fovTime * 1000000.0f / (float)numFOV, (float)visible / (float)numFOV );
+	}
+
+	mem_Release( centers );
+	hex_RegionDestroy( &region );
+	hex_RegionDestroy( &walls );
+
+	return ( mismatches == 0 ) ? 0 : 1;
+}
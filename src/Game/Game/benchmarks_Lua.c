@@ -0,0 +1,572 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+
+#include "System/luaInterface.h"
+#include "System/luaBytecodeCache.h"
+#include "System/luaProfiler.h"
+#include "System/platformLog.h"
+#include "System/memory.h"
+#include "DefaultECPS/defaultECPS.h"
+#include "System/ECPS/entityComponentProcessSystem.h"
+#include "Utils/stretchyBuffer.h"
+
+#if SCRIPTING_ENABLED
+
+static const char* benchCallbackScript =
+	"benchCallbackTotal = 0\n"
+	"function benchCallback( id ) benchCallbackTotal = benchCallbackTotal + id end\n";
+
+// same name, different behavior, used to make sure the handle picks up the new function
+static const char* benchReloadScript =
+	"function benchCallback( id ) benchCallbackTotal = benchCallbackTotal - id end\n";
+
+static float secondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+static lua_Integer getCallbackTotal( void )
+{
+	lua_State* ls = xLua_GetState( );
+	lua_getglobal( ls, "benchCallbackTotal" );
+	lua_Integer total = lua_tointeger( ls, -1 );
+	lua_pop( ls, 1 );
+	return total;
+}
+
+static bool runScript( const char* script )
+{
+	lua_State* ls = xLua_GetState( );
+	if( luaL_dostring( ls, script ) != LUA_OK ) {
+		llog( LOG_ERROR, "%s", lua_tostring( ls, -1 ) );
+		lua_pop( ls, 1 );
+		return false;
+	}
+	return true;
+}
+
+// Calls the same one integer callback the entity callbacks use, first by name through xLua_CallLuaFunction() and then
+//  through a cached handle with xLua_CallFunction(). Then redefines the function and makes sure the handle calls the
+//  new one.
+int bench_LuaCallbacks( int argc, char** argv )
+{
+	int numCalls = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 1000000;
+	int repeats = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 3;
+	if( numCalls < 1 ) numCalls = 1000000;
+	if( repeats < 1 ) repeats = 1;
+
+	if( !xLua_Init( ) ) {
+		llog( LOG_ERROR, "Unable to initialize Lua." );
+		return -1;
+	}
+
+	int result = -1;
+	XLuaFuncHandle handle = XLUA_INVALID_FUNC_HANDLE;
+
+	if( !runScript( benchCallbackScript ) ) goto clean_up;
+
+	handle = xLua_AcquireFunction( "benchCallback", "i|" );
+	if( handle == XLUA_INVALID_FUNC_HANDLE ) goto clean_up;
+
+	lua_Integer expectedTotal = 0;
+	for( int i = 0; i < numCalls; ++i ) {
+		expectedTotal += i;
+	}
+
+	float bestByName = 0.0f;
+	float bestByHandle = 0.0f;
+	for( int r = 0; r < repeats; ++r ) {
+		Uint64 start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numCalls; ++i ) {
+			xLua_CallLuaFunction( "benchCallback", "i|", i );
+		}
+		float byName = secondsSince( start );
+
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numCalls; ++i ) {
+			xLua_CallFunction( handle, i );
+		}
+		float byHandle = secondsSince( start );
+
+		llog( LOG_INFO, "Run %i: %i calls, by name: %.6f seconds (%.1f ns per call)  by handle: %.6f seconds (%.1f ns per call)",
+			r, numCalls, byName, ( byName * 1e9f ) / (float)numCalls, byHandle, ( byHandle * 1e9f ) / (float)numCalls );
+
+		if( ( r == 0 ) || ( byName < bestByName ) ) bestByName = byName;
+		if( ( r == 0 ) || ( byHandle < bestByHandle ) ) bestByHandle = byHandle;
+	}
+
+	if( getCallbackTotal( ) != ( expectedTotal * 2 * repeats ) ) {
+		llog( LOG_ERROR, "Callbacks weren't all called." );
+		goto clean_up;
+	}
+
+	llog( LOG_INFO, "Best per call, by name: %.1f ns  by handle: %.1f ns  (%.2fx)",
+		( bestByName * 1e9f ) / (float)numCalls, ( bestByHandle * 1e9f ) / (float)numCalls,
+		( bestByHandle > 0.0f ) ? ( bestByName / bestByHandle ) : 0.0f );
+
+	// redefining the function should be picked up by the handle
+	lua_Integer totalBeforeReload = getCallbackTotal( );
+	if( !runScript( benchReloadScript ) ) goto clean_up;
+	xLua_InvalidateFunctionHandles( );
+	xLua_CallFunction( handle, 1 );
+	if( getCallbackTotal( ) != ( totalBeforeReload - 1 ) ) {
+		llog( LOG_ERROR, "Handle still calls the old function after the script was reloaded." );
+		goto clean_up;
+	}
+
+	result = 0;
+
+clean_up:
+	xLua_ReleaseFunction( handle );
+	xLua_ShutDown( );
+	return result;
+}
+
+// moves every entity in benchEntities, once by copying the transform out to a table and back and once through views
+static const char* benchComponentScript =
+	"benchEntities = {}\n"
+	"function benchMoveByTable( dx, dy )\n"
+	"	for i = 1, #benchEntities do\n"
+	"		local tf = getComponentFromEntity( benchEntities[i], \"GC_TF\" )\n"
+	"		tf.futurePos.x = tf.futurePos.x + dx\n"
+	"		tf.futurePos.y = tf.futurePos.y + dy\n"
+	"		addComponentToEntity( benchEntities[i], \"GC_TF\", tf )\n"
+	"	end\n"
+	"end\n"
+	"local posX = getComponentFieldIndex( \"GC_TF\", \"futurePos.x\" )\n"
+	"local posY = getComponentFieldIndex( \"GC_TF\", \"futurePos.y\" )\n"
+	"local moveX, moveY = 0, 0\n"
+	"local function moveView( id, tf )\n"
+	"	tf[posX] = tf[posX] + moveX\n"
+	"	tf[posY] = tf[posY] + moveY\n"
+	"end\n"
+	"function benchMoveByView( dx, dy )\n"
+	"	moveX, moveY = dx, dy\n"
+	"	return forEachComponentView( moveView, \"GC_TF\" )\n"
+	"end\n";
+
+static bool checkPositions( EntityID* sbEntities, float expectedOffset )
+{
+	for( size_t i = 0; i < sb_Count( sbEntities ); ++i ) {
+		GCTransformData* tf = NULL;
+		if( !ecps_GetComponentFromEntityByID( &defaultECPS, sbEntities[i], gcTransformCompID, &tf ) ) {
+			return false;
+		}
+
+		float expectedX = (float)i + expectedOffset;
+		if( SDL_fabsf( tf->futureState.pos.x - expectedX ) > 0.001f ) {
+			llog( LOG_ERROR, "Entity %i is at %f, expected %f", (int)i, tf->futureState.pos.x, expectedX );
+			return false;
+		}
+	}
+	return true;
+}
+
+// Updates the positions of a lot of entities from a script each frame. First by getting the transform as a table and
+//  adding it back, then through a component view with forEachComponentView( ).
+int bench_LuaComponentAccess( int argc, char** argv )
+{
+	int numEntities = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 10000;
+	int numFrames = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 100;
+	if( numEntities < 1 ) numEntities = 10000;
+	if( numFrames < 1 ) numFrames = 100;
+
+	lua_State* ls = xLua_GetState( );
+	if( ls == NULL ) {
+		llog( LOG_ERROR, "Lua hasn't been initialized." );
+		return -1;
+	}
+
+	int result = -1;
+	EntityID* sbEntities = NULL;
+
+	if( !runScript( benchComponentScript ) ) goto clean_up;
+
+	lua_getglobal( ls, "benchEntities" );
+	for( int i = 0; i < numEntities; ++i ) {
+		GCTransformData tf = gc_CreateTransformPos( vec2( (float)i, 0.0f ) );
+		EntityID id = ecps_CreateEntity( &defaultECPS, 1, gcTransformCompID, &tf );
+		sb_Push( sbEntities, id );
+
+		lua_pushinteger( ls, (lua_Integer)id );
+		lua_rawseti( ls, -2, (lua_Integer)( i + 1 ) );
+	}
+	lua_pop( ls, 1 );
+
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int f = 0; f < numFrames; ++f ) {
+		if( !xLua_CallLuaFunction( "benchMoveByTable", "dd|", 1.0, 0.0 ) ) goto clean_up;
+	}
+	float byTable = secondsSince( start );
+	if( !checkPositions( sbEntities, (float)numFrames ) ) goto clean_up;
+
+	int numProcessed = 0;
+	start = SDL_GetPerformanceCounter( );
+	for( int f = 0; f < numFrames; ++f ) {
+		if( !xLua_CallLuaFunction( "benchMoveByView", "dd|i", 1.0, 0.0, &numProcessed ) ) goto clean_up;
+	}
+	float byView = secondsSince( start );
+	if( !checkPositions( sbEntities, (float)( numFrames * 2 ) ) ) goto clean_up;
+
+	llog( LOG_INFO, "%i entities (%i with views), %i frames", numEntities, numProcessed, numFrames );
+	llog( LOG_INFO, "Tables: %.6f seconds (%.3f ms per frame)  Views: %.6f seconds (%.3f ms per frame)  (%.1fx)",
+		byTable, ( byTable * 1000.0f ) / (float)numFrames, byView, ( byView * 1000.0f ) / (float)numFrames,
+		( byView > 0.0f ) ? ( byTable / byView ) : 0.0f );
+
+	result = 0;
+
+clean_up:
+	for( size_t i = 0; i < sb_Count( sbEntities ); ++i ) {
+		ecps_DestroyEntityByID( &defaultECPS, sbEntities[i] );
+	}
+	sb_Release( sbEntities );
+	return result;
+}
+
+// loads every script in the list into a fresh state without running them, returns how long it took or a negative
+//  value if any of them failed
+static float loadScripts( char** sbFileNames )
+{
+	lua_State* ls = luaL_newstate( );
+	if( ls == NULL ) return -1.0f;
+
+	float time = 0.0f;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( size_t i = 0; i < sb_Count( sbFileNames ); ++i ) {
+		if( xLua_LoadChunk( ls, sbFileNames[i] ) != LUA_OK ) {
+			llog( LOG_ERROR, "%s", lua_tostring( ls, -1 ) );
+			time = -1.0f;
+			break;
+		}
+		lua_pop( ls, 1 );
+	}
+	if( time >= 0.0f ) time = secondsSince( start );
+
+	lua_close( ls );
+	return time;
+}
+
+// Compiles every script in a directory, first from source and then from the bytecode cache. The first cached pass
+//  isn't timed since it's the one that fills the cache.
+int bench_LuaLoad( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		llog( LOG_ERROR, "No script directory given." );
+		return -1;
+	}
+	int repeats = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 5;
+	if( repeats < 1 ) repeats = 5;
+
+	int count = 0;
+	char** files = SDL_GlobDirectory( argv[0], NULL, 0, &count );
+	if( files == NULL ) {
+		llog( LOG_ERROR, "Unable to read directory %s: %s", argv[0], SDL_GetError( ) );
+		return -1;
+	}
+
+	int result = -1;
+	char** sbFileNames = NULL;
+	size_t totalSize = 0;
+	bool wasCacheEnabled = xLua_IsBytecodeCacheEnabled( );
+
+	for( int i = 0; i < count; ++i ) {
+		size_t len = SDL_strlen( files[i] );
+		if( ( len < 4 ) || ( SDL_strcasecmp( files[i] + len - 4, ".lua" ) != 0 ) ) continue;
+
+		size_t pathLen = SDL_strlen( argv[0] ) + len + 2;
+		char* path = mem_Allocate( pathLen );
+		if( path == NULL ) goto clean_up;
+		SDL_snprintf( path, pathLen, "%s/%s", argv[0], files[i] );
+		sb_Push( sbFileNames, path );
+
+		SDL_PathInfo info;
+		if( SDL_GetPathInfo( path, &info ) ) totalSize += (size_t)info.size;
+	}
+
+	if( sb_Count( sbFileNames ) == 0 ) {
+		llog( LOG_ERROR, "No scripts found in %s", argv[0] );
+		goto clean_up;
+	}
+
+	xLua_SetBytecodeCacheEnabled( true );
+	if( loadScripts( sbFileNames ) < 0.0f ) goto clean_up;
+
+	float bestSource = 0.0f;
+	float bestCached = 0.0f;
+	for( int r = 0; r < repeats; ++r ) {
+		xLua_SetBytecodeCacheEnabled( false );
+		float fromSource = loadScripts( sbFileNames );
+
+		xLua_SetBytecodeCacheEnabled( true );
+		float fromCache = loadScripts( sbFileNames );
+
+		if( ( fromSource < 0.0f ) || ( fromCache < 0.0f ) ) goto clean_up;
+
+		llog( LOG_INFO, "Run %i: source: %.6f seconds  cached: %.6f seconds", r, fromSource, fromCache );
+
+		if( ( r == 0 ) || ( fromSource < bestSource ) ) bestSource = fromSource;
+		if( ( r == 0 ) || ( fromCache < bestCached ) ) bestCached = fromCache;
+	}
+
+	llog( LOG_INFO, "%i scripts, %i bytes. Best source: %.3f ms  cached: %.3f ms  (%.2fx)",
+		(int)sb_Count( sbFileNames ), (int)totalSize, bestSource * 1000.0f, bestCached * 1000.0f,
+		( bestCached > 0.0f ) ? ( bestSource / bestCached ) : 0.0f );
+
+	result = 0;
+
+clean_up:
+	xLua_SetBytecodeCacheEnabled( wasCacheEnabled );
+	for( size_t i = 0; i < sb_Count( sbFileNames ); ++i ) {
+		mem_Release( sbFileNames[i] );
+	}
+	sb_Release( sbFileNames );
+	SDL_free( files );
+	return result;
+}
+
+// every frame creates a lot of short lived tables and strings, and replaces some of the long lived ones so the old
+//  objects keep dying too
+static const char* benchChurnScript =
+	"benchLive = {}\n"
+	"local liveCount = 0\n"
+	"local nextLive = 1\n"
+	"function benchSetupLive( count )\n"
+	"	for i = 1, count do benchLive[i] = { i, tostring( i ) } end\n"
+	"	liveCount = count\n"
+	"end\n"
+	"function benchChurn( count )\n"
+	"	for i = 1, count do\n"
+	"		local t = { x = i, y = i * 2, name = \"e\" .. i }\n"
+	"		if ( i % 8 ) == 0 then\n"
+	"			benchLive[nextLive] = t\n"
+	"			nextLive = ( nextLive % liveCount ) + 1\n"
+	"		end\n"
+	"	end\n"
+	"end\n";
+
+typedef struct {
+	float worstFrameMS;
+	float averageFrameMS;
+	float worstCollectionMS;
+	size_t peakHeapBytes;
+} GCBenchResults;
+
+static bool runChurnFrames( XLuaGCMode mode, int numFrames, int allocationsPerFrame, int numLive, GCBenchResults* outResults )
+{
+	SDL_memset( outResults, 0, sizeof( *outResults ) );
+
+	xLua_SetGCMode( mode );
+	if( !xLua_Init( ) ) {
+		llog( LOG_ERROR, "Unable to initialize Lua." );
+		return false;
+	}
+
+	bool done = false;
+	XLuaFuncHandle churn = XLUA_INVALID_FUNC_HANDLE;
+
+	if( !runScript( benchChurnScript ) ) goto clean_up;
+	if( !xLua_CallLuaFunction( "benchSetupLive", "i|", numLive ) ) goto clean_up;
+	xLua_FullGarbageCollect( );
+
+	churn = xLua_AcquireFunction( "benchChurn", "i|" );
+	if( churn == XLUA_INVALID_FUNC_HANDLE ) goto clean_up;
+
+	// a few frames to get the budget settled
+	for( int f = 0; f < 30; ++f ) {
+		xLua_CallFunction( churn, allocationsPerFrame );
+		xLua_GCFrameStep( );
+	}
+
+	float totalMS = 0.0f;
+	for( int f = 0; f < numFrames; ++f ) {
+		Uint64 start = SDL_GetPerformanceCounter( );
+		if( !xLua_CallFunction( churn, allocationsPerFrame ) ) goto clean_up;
+		xLua_GCFrameStep( );
+		float frameMS = secondsSince( start ) * 1000.0f;
+
+		XLuaGCFrameStats stats;
+		xLua_GetGCFrameStats( &stats );
+
+		totalMS += frameMS;
+		outResults->worstFrameMS = SDL_max( outResults->worstFrameMS, frameMS );
+		outResults->worstCollectionMS = SDL_max( outResults->worstCollectionMS, stats.collectionMS );
+		outResults->peakHeapBytes = SDL_max( outResults->peakHeapBytes, stats.heapBytes );
+	}
+	outResults->averageFrameMS = totalMS / (float)numFrames;
+
+	done = true;
+
+clean_up:
+	xLua_ReleaseFunction( churn );
+	xLua_ShutDown( );
+	return done;
+}
+
+// Runs the same allocation heavy script each frame, first with Lua collecting whenever it wants and then with the
+//  collection done in xLua_GCFrameStep( ) with a time budget. The worst frame is what we're trying to improve.
+int bench_LuaGC( int argc, char** argv )
+{
+	int numFrames = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 600;
+	int allocationsPerFrame = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 10000;
+	int numLive = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 200000;
+	if( numFrames < 1 ) numFrames = 600;
+	if( allocationsPerFrame < 1 ) allocationsPerFrame = 10000;
+	if( numLive < 1 ) numLive = 200000;
+
+	XLuaGCMode oldMode = xLua_GetGCMode( );
+	int result = -1;
+
+	GCBenchResults automatic;
+	GCBenchResults budgeted;
+	if( !runChurnFrames( XLUA_GC_AUTOMATIC, numFrames, allocationsPerFrame, numLive, &automatic ) ) goto clean_up;
+	if( !runChurnFrames( XLUA_GC_FRAME_BUDGET, numFrames, allocationsPerFrame, numLive, &budgeted ) ) goto clean_up;
+
+	llog( LOG_INFO, "%i frames, %i allocations per frame, %i long lived objects", numFrames, allocationsPerFrame, numLive );
+	llog( LOG_INFO, "Automatic:    worst frame: %.3f ms  average: %.3f ms  peak heap: %u KB",
+		automatic.worstFrameMS, automatic.averageFrameMS, (uint32_t)( automatic.peakHeapBytes / 1024 ) );
+	llog( LOG_INFO, "Frame budget: worst frame: %.3f ms  average: %.3f ms  peak heap: %u KB  worst collection: %.3f ms",
+		budgeted.worstFrameMS, budgeted.averageFrameMS, (uint32_t)( budgeted.peakHeapBytes / 1024 ), budgeted.worstCollectionMS );
+
+	result = 0;
+
+clean_up:
+	xLua_SetGCMode( oldMode );
+	return result;
+}
+
+// a mix of Lua calls, recursion, and calls into a binding so all the kinds of functions show up in the profile
+static const char* benchProfileScript =
+	"function benchFib( n )\n"
+	"	if n < 2 then return n end\n"
+	"	return benchFib( n - 1 ) + benchFib( n - 2 )\n"
+	"end\n"
+	"local function fillTable( i )\n"
+	"	local t = {}\n"
+	"	for j = 1, 20 do t[j] = j * i end\n"
+	"	return #t\n"
+	"end\n"
+	"function benchProfileFrame( count )\n"
+	"	local total = 0\n"
+	"	for i = 1, count do\n"
+	"		total = total + fillTable( i ) + benchBinding( i )\n"
+	"	end\n"
+	"	return total + benchFib( 12 )\n"
+	"end\n";
+
+static int lua_BenchBinding( lua_State* ls )
+{
+	lua_Integer value = luaL_checkinteger( ls, 1 );
+	lua_Integer total = 0;
+	for( lua_Integer i = 0; i < 200; ++i ) {
+		total += ( value * i ) % 7;
+	}
+	lua_pushinteger( ls, total );
+	return 1;
+}
+
+static float runProfileFrames( int numFrames, int callsPerFrame )
+{
+	int total = 0;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int f = 0; f < numFrames; ++f ) {
+		if( !xLua_CallLuaFunction( "benchProfileFrame", "i|i", callsPerFrame, &total ) ) return -1.0f;
+	}
+	return secondsSince( start );
+}
+
+// Runs the same script with the profiler off, instrumenting, and sampling to see how much it costs. If an output
+//  directory is given the instrumented trace and the folded stacks for both modes are saved there.
+int bench_LuaProfiler( int argc, char** argv )
+{
+	int numFrames = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 200;
+	const char* outDir = ( argc >= 2 ) ? argv[1] : NULL;
+	if( numFrames < 1 ) numFrames = 200;
+	const int callsPerFrame = 1000;
+
+	if( !xLua_Init( ) ) {
+		llog( LOG_ERROR, "Unable to initialize Lua." );
+		return -1;
+	}
+
+	int result = -1;
+	char fileName[512];
+
+	xLua_RegisterCFunction( "benchBinding", lua_BenchBinding );
+	if( !runScript( benchProfileScript ) ) goto clean_up;
+
+	float off = runProfileFrames( numFrames, callsPerFrame );
+
+	xLua_ClearProfile( );
+	xLua_StartProfiling( XLUA_PROFILE_INSTRUMENTED, 0 );
+	float instrumented = runProfileFrames( numFrames, callsPerFrame );
+	xLua_StopProfiling( );
+	xLua_LogProfile( 10 );
+	if( outDir != NULL ) {
+		SDL_snprintf( fileName, sizeof( fileName ), "%s/luaProfile.json", outDir );
+		xLua_SaveProfileTrace( fileName );
+		SDL_snprintf( fileName, sizeof( fileName ), "%s/luaProfileInstrumented.folded", outDir );
+		xLua_SaveProfileFoldedStacks( fileName );
+	}
+
+	xLua_ClearProfile( );
+	xLua_StartProfiling( XLUA_PROFILE_SAMPLED, 0 );
+	float sampled = runProfileFrames( numFrames, callsPerFrame );
+	xLua_StopProfiling( );
+	xLua_LogProfile( 10 );
+	if( outDir != NULL ) {
+		SDL_snprintf( fileName, sizeof( fileName ), "%s/luaProfileSampled.folded", outDir );
+		xLua_SaveProfileFoldedStacks( fileName );
+	}
+
+	// stopping has to remove the hook, so this should be the same as the first run
+	float offAgain = runProfileFrames( numFrames, callsPerFrame );
+
+	if( ( off < 0.0f ) || ( instrumented < 0.0f ) || ( sampled < 0.0f ) || ( offAgain < 0.0f ) ) goto clean_up;
+
+	llog( LOG_INFO, "%i frames, off: %.3f ms per frame  instrumented: %.3f ms (%.2fx)  sampled: %.3f ms (%.2fx)  off again: %.3f ms",
+		numFrames, ( off * 1000.0f ) / numFrames, ( instrumented * 1000.0f ) / numFrames, instrumented / off,
+		( sampled * 1000.0f ) / numFrames, sampled / off, ( offAgain * 1000.0f ) / numFrames );
+
+	result = 0;
+
+clean_up:
+	xLua_StopProfiling( );
+	xLua_ClearProfile( );
+	xLua_ShutDown( );
+	return result;
+}
+
+#else
+
+int bench_LuaCallbacks( int argc, char** argv )
+{
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return -1;
+}
+
+int bench_LuaComponentAccess( int argc, char** argv )
+{
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return -1;
+}
+
+int bench_LuaLoad( int argc, char** argv )
+{
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return -1;
+}
+
+int bench_LuaGC( int argc, char** argv )
+{
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return -1;
+}
+
+int bench_LuaProfiler( int argc, char** argv )
+{
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return -1;
+}
+
+#endif
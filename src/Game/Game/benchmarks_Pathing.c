@@ -0,0 +1,1157 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+#include <float.h>
+#include <math.h>
+
+#include "Utils/aStar.h"
+#include "Utils/jumpPointSearch.h"
+#include "Utils/hpaStar.h"
+#include "Utils/flowField.h"
+#include "Utils/hexGrid.h"
+#include "Math/mathUtil.h"
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/pathService.h"
+#include "System/platformLog.h"
+#include "System/random.h"
+#include "Utils/stretchyBuffer.h"
+
+#define SQRT_2 1.41421356f
+
+typedef struct {
+	int width;
+	int height;
+	uint8_t* blocked;
+} BenchGrid;
+
+static const int gridDirX[] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+static const int gridDirY[] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+static float secondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+static bool isOpen( BenchGrid* grid, int x, int y )
+{
+	return ( x >= 0 ) && ( y >= 0 ) && ( x < grid->width ) && ( y < grid->height ) && !grid->blocked[x + ( y * grid->width )];
+}
+
+// open field with randomly scattered blocked tiles
+static void createScatteredGrid( BenchGrid* grid, int width, int height, float blockedChance, uint32_t seed )
+{
+	RandomGroup rg;
+	rand_Seed( &rg, seed );
+
+	grid->width = width;
+	grid->height = height;
+	grid->blocked = mem_Allocate( (size_t)width * (size_t)height );
+	for( int i = 0; i < width * height; ++i ) {
+		grid->blocked[i] = ( rand_GetNormalizedFloat( &rg ) < blockedChance ) ? 1 : 0;
+	}
+}
+
+static void fillRect( BenchGrid* grid, int left, int top, int right, int bottom, uint8_t value )
+{
+	left = SDL_max( left, 0 );
+	top = SDL_max( top, 0 );
+	right = SDL_min( right, grid->width - 1 );
+	bottom = SDL_min( bottom, grid->height - 1 );
+	for( int y = top; y <= bottom; ++y ) {
+		for( int x = left; x <= right; ++x ) {
+			grid->blocked[x + ( y * grid->width )] = value;
+		}
+	}
+}
+
+// one tile wide corridors with no loops, carved out with a depth first search over every other tile
+static void createMazeGrid( BenchGrid* grid, int width, int height, uint32_t seed )
+{
+	RandomGroup rg;
+	rand_Seed( &rg, seed );
+
+	grid->width = width;
+	grid->height = height;
+	grid->blocked = mem_Allocate( (size_t)width * (size_t)height );
+	SDL_memset( grid->blocked, 1, (size_t)width * (size_t)height );
+
+	int cellsWide = ( width - 1 ) / 2;
+	int cellsHigh = ( height - 1 ) / 2;
+	int* sbStack = NULL;
+	sb_Push( sbStack, 0 );
+	grid->blocked[1 + width] = 0;
+
+	while( sb_Count( sbStack ) > 0 ) {
+		int cell = sb_Last( sbStack );
+		int cx = cell % cellsWide;
+		int cy = cell / cellsWide;
+
+		int options[4];
+		int numOptions = 0;
+		for( int dir = 0; dir < 4; ++dir ) {
+			int nx = cx + gridDirX[dir];
+			int ny = cy + gridDirY[dir];
+			if( ( nx >= 0 ) && ( ny >= 0 ) && ( nx < cellsWide ) && ( ny < cellsHigh ) &&
+				grid->blocked[( ( nx * 2 ) + 1 ) + ( ( ( ny * 2 ) + 1 ) * width )] ) {
+				options[numOptions++] = dir;
+			}
+		}
+
+		if( numOptions == 0 ) {
+			sb_Pop( sbStack );
+			continue;
+		}
+
+		int dir = options[rand_GetArrayEntry( &rg, (size_t)numOptions )];
+		int nx = cx + gridDirX[dir];
+		int ny = cy + gridDirY[dir];
+		grid->blocked[( ( cx * 2 ) + 1 + gridDirX[dir] ) + ( ( ( cy * 2 ) + 1 + gridDirY[dir] ) * width )] = 0;
+		grid->blocked[( ( nx * 2 ) + 1 ) + ( ( ( ny * 2 ) + 1 ) * width )] = 0;
+		sb_Push( sbStack, nx + ( ny * cellsWide ) );
+	}
+
+	sb_Release( sbStack );
+}
+
+// a room in every 32x32 block of tiles, each room covers the center of its block, connected to the rooms right and
+//  below it with narrow corridors
+static void createRoomsGrid( BenchGrid* grid, int width, int height, uint32_t seed )
+{
+	RandomGroup rg;
+	rand_Seed( &rg, seed );
+
+	grid->width = width;
+	grid->height = height;
+	grid->blocked = mem_Allocate( (size_t)width * (size_t)height );
+	SDL_memset( grid->blocked, 1, (size_t)width * (size_t)height );
+
+	const int blockSize = 32;
+	int blocksWide = width / blockSize;
+	int blocksHigh = height / blockSize;
+	for( int by = 0; by < blocksHigh; ++by ) {
+		for( int bx = 0; bx < blocksWide; ++bx ) {
+			int roomWidth = rand_GetRangeS32( &rg, 8, blockSize - 4 );
+			int roomHeight = rand_GetRangeS32( &rg, 8, blockSize - 4 );
+			int left = ( bx * blockSize ) + rand_GetRangeS32( &rg, SDL_max( 1, ( blockSize / 2 ) - roomWidth + 1 ),
+				SDL_min( blockSize / 2, blockSize - roomWidth - 1 ) );
+			int top = ( by * blockSize ) + rand_GetRangeS32( &rg, SDL_max( 1, ( blockSize / 2 ) - roomHeight + 1 ),
+				SDL_min( blockSize / 2, blockSize - roomHeight - 1 ) );
+			fillRect( grid, left, top, left + roomWidth - 1, top + roomHeight - 1, 0 );
+		}
+	}
+
+	// corridors run between block centers, which are always inside the rooms
+	for( int by = 0; by < blocksHigh; ++by ) {
+		for( int bx = 0; bx < blocksWide; ++bx ) {
+			int centerX = ( bx * blockSize ) + ( blockSize / 2 );
+			int centerY = ( by * blockSize ) + ( blockSize / 2 );
+			if( bx + 1 < blocksWide ) {
+				fillRect( grid, centerX, centerY, centerX + blockSize, centerY, 0 );
+			}
+			if( by + 1 < blocksHigh ) {
+				fillRect( grid, centerX, centerY, centerX + 1, centerY + blockSize, 0 );
+			}
+		}
+	}
+}
+
+static void destroyGrid( BenchGrid* grid )
+{
+	mem_Release( grid->blocked );
+	grid->blocked = NULL;
+}
+
+static int randomOpenTile( BenchGrid* grid, RandomGroup* rg )
+{
+	int idx;
+	do {
+		idx = (int)rand_GetArrayEntry( rg, (size_t)( grid->width * grid->height ) );
+	} while( grid->blocked[idx] );
+	return idx;
+}
+
+// picks an open tile in the same blockSize x blockSize block as the tile, there has to be one
+static int randomOpenTileInBlock( BenchGrid* grid, RandomGroup* rg, int tile, int blockSize )
+{
+	int left = ( ( tile % grid->width ) / blockSize ) * blockSize;
+	int top = ( ( tile / grid->width ) / blockSize ) * blockSize;
+	int width = SDL_min( blockSize, grid->width - left );
+	int height = SDL_min( blockSize, grid->height - top );
+	int idx;
+	do {
+		idx = ( left + rand_GetRangeS32( rg, 0, width - 1 ) ) + ( ( top + rand_GetRangeS32( rg, 0, height - 1 ) ) * grid->width );
+	} while( grid->blocked[idx] );
+	return idx;
+}
+
+// eight way movement, diagonals can't cut corners
+static int gridNextNeighbor( void* graph, int nodeID, int currNeighborNodeID )
+{
+	BenchGrid* grid = (BenchGrid*)graph;
+	int x = nodeID % grid->width;
+	int y = nodeID / grid->width;
+
+	int dir = 0;
+	if( currNeighborNodeID != -1 ) {
+		int dx = ( currNeighborNodeID % grid->width ) - x;
+		int dy = ( currNeighborNodeID / grid->width ) - y;
+		while( ( gridDirX[dir] != dx ) || ( gridDirY[dir] != dy ) ) {
+			++dir;
+		}
+		++dir;
+	}
+
+	for( ; dir < 8; ++dir ) {
+		int nx = x + gridDirX[dir];
+		int ny = y + gridDirY[dir];
+		if( !isOpen( grid, nx, ny ) ) continue;
+		if( ( dir >= 4 ) && ( !isOpen( grid, nx, y ) || !isOpen( grid, x, ny ) ) ) continue;
+		return nx + ( ny * grid->width );
+	}
+
+	return -1;
+}
+
+static float gridMoveCost( void* graph, int fromNodeID, int toNodeID )
+{
+	BenchGrid* grid = (BenchGrid*)graph;
+	bool diagonal = ( ( fromNodeID % grid->width ) != ( toNodeID % grid->width ) ) &&
+		( ( fromNodeID / grid->width ) != ( toNodeID / grid->width ) );
+	return diagonal ? SQRT_2 : 1.0f;
+}
+
+// octile distance
+static float gridHeuristic( void* graph, int fromNodeID, int toNodeID )
+{
+	BenchGrid* grid = (BenchGrid*)graph;
+	float dx = fabsf( (float)( ( fromNodeID % grid->width ) - ( toNodeID % grid->width ) ) );
+	float dy = fabsf( (float)( ( fromNodeID / grid->width ) - ( toNodeID / grid->width ) ) );
+	return ( dx + dy ) + ( ( SQRT_2 - 2.0f ) * SDL_min( dx, dy ) );
+}
+
+static float pathCost( BenchGrid* grid, int startNodeID, int* sbPath )
+{
+	// paths go from the target back to the node after the start
+	float cost = 0.0f;
+	int prev = startNodeID;
+	for( int i = (int)sb_Count( sbPath ) - 1; i >= 0; --i ) {
+		cost += gridMoveCost( grid, prev, sbPath[i] );
+		prev = sbPath[i];
+	}
+	return cost;
+}
+
+// the search aStar.c used before it had the heap and reusable contexts, the open list is kept as a sorted stretchy
+//  buffer and every search allocates records for the whole graph
+typedef struct {
+	int loc;
+	float cost;
+} BaselineFrontierData;
+
+typedef struct {
+	int from;
+	float cost;
+} BaselinePathData;
+
+static bool baselineSearch( BenchGrid* grid, int startNodeID, int targetNodeID, int** sbOutPath, uint32_t* outExpansions )
+{
+	size_t nodeCount = (size_t)( grid->width * grid->height );
+	BaselinePathData* sbPathData = NULL;
+	BaselineFrontierData* sbFrontier = NULL;
+	bool found = false;
+
+	sb_Add( sbPathData, nodeCount );
+	for( size_t i = 0; i < nodeCount; ++i ) {
+		sbPathData[i].from = -1;
+		sbPathData[i].cost = INFINITY;
+	}
+
+	BaselineFrontierData init = { startNodeID, 0.0f };
+	sb_Reserve( sbFrontier, nodeCount );
+	sb_Push( sbFrontier, init );
+	sbPathData[startNodeID].from = startNodeID;
+	sbPathData[startNodeID].cost = 0.0f;
+
+	while( sb_Count( sbFrontier ) > 0 ) {
+		BaselineFrontierData front = sb_Pop( sbFrontier );
+		++( *outExpansions );
+		if( front.loc == targetNodeID ) {
+			int current = targetNodeID;
+			while( current != startNodeID ) {
+				sb_Push( ( *sbOutPath ), current );
+				current = sbPathData[current].from;
+			}
+			found = true;
+			break;
+		}
+
+		int neighbor = gridNextNeighbor( grid, front.loc, -1 );
+		while( neighbor != -1 ) {
+			float newCost = sbPathData[front.loc].cost + gridMoveCost( grid, front.loc, neighbor );
+			if( newCost < sbPathData[neighbor].cost ) {
+				sbPathData[neighbor].cost = newCost;
+				sbPathData[neighbor].from = front.loc;
+
+				BaselineFrontierData data;
+				data.loc = neighbor;
+				data.cost = newCost + gridHeuristic( grid, neighbor, targetNodeID );
+
+				size_t idx = 0;
+				while( ( idx < sb_Count( sbFrontier ) ) && ( data.cost < sbFrontier[idx].cost ) ) {
+					++idx;
+				}
+				sb_Insert( sbFrontier, idx, data );
+			}
+			neighbor = gridNextNeighbor( grid, front.loc, neighbor );
+		}
+	}
+
+	sb_Release( sbFrontier );
+	sb_Release( sbPathData );
+	return found;
+}
+
+typedef struct {
+	const char* name;
+	float seconds;
+	uint64_t expansions;
+	uint64_t allocations;
+	int numFound;
+	float totalCost;
+} AStarBenchResult;
+
+static void logAStarResult( AStarBenchResult* result, int numQueries )
+{
+	llog( LOG_INFO, "%-16s %8.3f ms per query  %12.0f expansions per second  %8.1f allocations per query  %i found  total cost %.1f",
+		result->name, ( result->seconds * 1000.0f ) / (float)numQueries, (float)result->expansions / result->seconds,
+		(float)result->allocations / (float)numQueries, result->numFound, result->totalCost );
+}
+
+// Runs the same random queries on a large grid with the old sorted list search, the single use search state, and a
+//  reused search context. The single use search state is what existing callers get without changing anything.
+int bench_AStar( int argc, char** argv )
+{
+	int gridSize = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 512;
+	int numQueries = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 50;
+	if( gridSize < 16 ) gridSize = 512;
+	if( numQueries < 1 ) numQueries = 50;
+
+	BenchGrid grid;
+	createScatteredGrid( &grid, gridSize, gridSize, 0.25f, 0x5eed );
+	size_t nodeCount = (size_t)( gridSize * gridSize );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0xa57a );
+	int* queries = mem_Allocate( sizeof( int ) * 2 * (size_t)numQueries );
+	for( int i = 0; i < numQueries * 2; ++i ) {
+		queries[i] = randomOpenTile( &grid, &rg );
+	}
+
+	int* sbPath = NULL;
+	sb_Reserve( sbPath, nodeCount );
+
+	AStarBenchResult results[3];
+	SDL_memset( results, 0, sizeof( results ) );
+	results[0].name = "sorted list";
+	results[1].name = "search state";
+	results[2].name = "reused context";
+
+	// sorted list
+	{
+		uint64_t allocStart = mem_GetAllocationCount( );
+		Uint64 start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numQueries; ++i ) {
+			uint32_t expansions = 0;
+			sb_Clear( sbPath );
+			if( baselineSearch( &grid, queries[i * 2], queries[( i * 2 ) + 1], &sbPath, &expansions ) ) {
+				++results[0].numFound;
+				results[0].totalCost += pathCost( &grid, queries[i * 2], sbPath );
+			}
+			results[0].expansions += expansions;
+		}
+		results[0].seconds = secondsSince( start );
+		results[0].allocations = mem_GetAllocationCount( ) - allocStart;
+	}
+
+	// search state
+	{
+		uint64_t allocStart = mem_GetAllocationCount( );
+		Uint64 start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numQueries; ++i ) {
+			AStarSearchState state;
+			sb_Clear( sbPath );
+			aStar_CreateSearchState( &grid, nodeCount, queries[i * 2], queries[( i * 2 ) + 1],
+				gridMoveCost, gridHeuristic, gridNextNeighbor, &state );
+			aStar_ProcessPath( &state, -1, &sbPath );
+			if( state.context.found ) {
+				++results[1].numFound;
+				results[1].totalCost += pathCost( &grid, queries[i * 2], sbPath );
+			}
+			results[1].expansions += state.context.numExpansions;
+			aStar_CleanUpSearchState( &state );
+		}
+		results[1].seconds = secondsSince( start );
+		results[1].allocations = mem_GetAllocationCount( ) - allocStart;
+	}
+
+	// reused context, includes the allocations for the first search
+	{
+		AStarContext context;
+		aStar_InitContext( &context );
+
+		uint64_t allocStart = mem_GetAllocationCount( );
+		Uint64 start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numQueries; ++i ) {
+			sb_Clear( sbPath );
+			if( aStar_FindPath( &context, &grid, nodeCount, queries[i * 2], queries[( i * 2 ) + 1],
+					gridMoveCost, gridHeuristic, gridNextNeighbor, &sbPath ) ) {
+				++results[2].numFound;
+				results[2].totalCost += pathCost( &grid, queries[i * 2], sbPath );
+			}
+			results[2].expansions += context.numExpansions;
+		}
+		results[2].seconds = secondsSince( start );
+		results[2].allocations = mem_GetAllocationCount( ) - allocStart;
+
+		aStar_CleanUpContext( &context );
+	}
+
+	llog( LOG_INFO, "%ix%i grid, %i queries", gridSize, gridSize, numQueries );
+	for( int i = 0; i < 3; ++i ) {
+		logAStarResult( &results[i], numQueries );
+	}
+	llog( LOG_INFO, "Reused context is %.2fx faster than the sorted list", results[0].seconds / results[2].seconds );
+
+	int result = 0;
+	for( int i = 1; i < 3; ++i ) {
+		if( ( results[i].numFound != results[0].numFound ) ||
+			( fabsf( results[i].totalCost - results[0].totalCost ) > ( 0.001f * results[0].totalCost ) ) ) {
+			llog( LOG_ERROR, "%s found different paths than the sorted list.", results[i].name );
+			result = -1;
+		}
+	}
+
+	sb_Release( sbPath );
+	mem_Release( queries );
+	destroyGrid( &grid );
+
+	return result;
+}
+
+// converts to what jps_SetAllWalkable( ) wants
+static void setupJPSGrid( BenchGrid* grid, JPSGrid* outJPSGrid )
+{
+	size_t count = (size_t)grid->width * (size_t)grid->height;
+	uint8_t* walkable = mem_Allocate( count );
+	for( size_t i = 0; i < count; ++i ) {
+		walkable[i] = !grid->blocked[i];
+	}
+
+	jps_CreateGrid( outJPSGrid, grid->width, grid->height );
+	jps_SetAllWalkable( outJPSGrid, walkable );
+
+	mem_Release( walkable );
+}
+
+// Compares A* and jump point search on open, maze, and room and corridor maps. Both use a reused context so the only
+//  difference is the search. Also times changing single tiles against rebuilding the whole grid.
+int bench_JumpPointSearch( int argc, char** argv )
+{
+	int gridSize = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 512;
+	int numQueries = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 100;
+	if( gridSize < 64 ) gridSize = 512;
+	if( numQueries < 1 ) numQueries = 100;
+
+	const char* mapNames[] = { "open", "maze", "rooms" };
+	const int numTileChanges = 200;
+	int result = 0;
+
+	AStarContext context;
+	aStar_InitContext( &context );
+	int* sbPath = NULL;
+	int* queries = mem_Allocate( sizeof( int ) * 2 * (size_t)numQueries );
+
+	llog( LOG_INFO, "%ix%i grids, %i queries", gridSize, gridSize, numQueries );
+
+	for( int map = 0; map < 3; ++map ) {
+		BenchGrid grid;
+		switch( map ) {
+		case 0: createScatteredGrid( &grid, gridSize, gridSize, 0.05f, 0x5eed ); break;
+		case 1: createMazeGrid( &grid, gridSize, gridSize, 0x5eed ); break;
+		default: createRoomsGrid( &grid, gridSize, gridSize, 0x5eed ); break;
+		}
+		size_t nodeCount = (size_t)( gridSize * gridSize );
+
+		RandomGroup rg;
+		rand_Seed( &rg, 0xa57a );
+		for( int i = 0; i < numQueries * 2; ++i ) {
+			queries[i] = randomOpenTile( &grid, &rg );
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter( );
+		JPSGrid jpsGrid;
+		setupJPSGrid( &grid, &jpsGrid );
+		float buildSeconds = secondsSince( start );
+
+		uint64_t aStarExpansions = 0;
+		float aStarCost = 0.0f;
+		int aStarFound = 0;
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numQueries; ++i ) {
+			sb_Clear( sbPath );
+			if( aStar_FindPath( &context, &grid, nodeCount, queries[i * 2], queries[( i * 2 ) + 1],
+					gridMoveCost, gridHeuristic, gridNextNeighbor, &sbPath ) ) {
+				++aStarFound;
+				aStarCost += pathCost( &grid, queries[i * 2], sbPath );
+			}
+			aStarExpansions += context.numExpansions;
+		}
+		float aStarSeconds = secondsSince( start );
+
+		uint64_t jpsExpansions = 0;
+		float jpsCost = 0.0f;
+		int jpsFound = 0;
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numQueries; ++i ) {
+			sb_Clear( sbPath );
+			if( jps_FindPath( &jpsGrid, &context, queries[i * 2] % gridSize, queries[i * 2] / gridSize,
+					queries[( i * 2 ) + 1] % gridSize, queries[( i * 2 ) + 1] / gridSize, &sbPath ) ) {
+				++jpsFound;
+				jpsCost += pathCost( &grid, queries[i * 2], sbPath );
+			}
+			jpsExpansions += context.numExpansions;
+		}
+		float jpsSeconds = secondsSince( start );
+
+		// toggle random tiles and then put them back
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < numTileChanges; ++i ) {
+			int tile = (int)rand_GetArrayEntry( &rg, nodeCount );
+			int x = tile % gridSize;
+			int y = tile / gridSize;
+			jps_SetWalkable( &jpsGrid, x, y, !jps_IsWalkable( &jpsGrid, x, y ) );
+			jps_SetWalkable( &jpsGrid, x, y, !jps_IsWalkable( &jpsGrid, x, y ) );
+		}
+		float changeSeconds = secondsSince( start );
+
+		llog( LOG_INFO, "%-6s A*:  %10.1f expansions  %8.3f ms per query", mapNames[map],
+			(float)aStarExpansions / (float)numQueries, ( aStarSeconds * 1000.0f ) / (float)numQueries );
+		llog( LOG_INFO, "%-6s JPS+: %10.1f expansions  %8.3f ms per query  (%.1fx faster)", mapNames[map],
+			(float)jpsExpansions / (float)numQueries, ( jpsSeconds * 1000.0f ) / (float)numQueries, aStarSeconds / jpsSeconds );
+		llog( LOG_INFO, "%-6s full build: %.3f ms  single tile change: %.3f ms", mapNames[map],
+			buildSeconds * 1000.0f, ( changeSeconds * 1000.0f ) / (float)( numTileChanges * 2 ) );
+
+		if( ( jpsFound != aStarFound ) || ( fabsf( jpsCost - aStarCost ) > ( 0.001f * aStarCost ) ) ) {
+			llog( LOG_ERROR, "%s: jump point search found different paths than A*, %i paths with total cost %.1f vs %i paths with total cost %.1f",
+				mapNames[map], jpsFound, jpsCost, aStarFound, aStarCost );
+			result = -1;
+		}
+
+		jps_DestroyGrid( &jpsGrid );
+		destroyGrid( &grid );
+	}
+
+	mem_Release( queries );
+	sb_Release( sbPath );
+	aStar_CleanUpContext( &context );
+
+	return result;
+}
+
+// Builds a hierarchical map over a large room and corridor map, then times queries with and without the path cache,
+//  compares some of them against A*, and times rebuilding after changing tiles.
+int bench_HierarchicalPathing( int argc, char** argv )
+{
+	int gridSize = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 2048;
+	int clusterSize = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 32;
+	int numQueries = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 200;
+	if( gridSize < 64 ) gridSize = 2048;
+	if( clusterSize < 4 ) clusterSize = 32;
+	if( numQueries < 1 ) numQueries = 200;
+
+	const int numAStarQueries = SDL_min( numQueries, 10 );
+	const int numTileChanges = 100;
+	int result = 0;
+
+	BenchGrid grid;
+	createRoomsGrid( &grid, gridSize, gridSize, 0x5eed );
+	size_t nodeCount = (size_t)( gridSize * gridSize );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0xa57a );
+	int* queries = mem_Allocate( sizeof( int ) * 2 * (size_t)numQueries );
+	for( int i = 0; i < numQueries * 2; ++i ) {
+		queries[i] = randomOpenTile( &grid, &rg );
+	}
+
+	uint8_t* walkable = mem_Allocate( nodeCount );
+	for( size_t i = 0; i < nodeCount; ++i ) {
+		walkable[i] = !grid.blocked[i];
+	}
+
+	HPAMap map;
+	if( !hpa_CreateMap( &map, gridSize, gridSize, clusterSize ) ) {
+		result = -1;
+		goto clean_up;
+	}
+
+	Uint64 start = SDL_GetPerformanceCounter( );
+	hpa_SetAllWalkable( &map, walkable );
+	float buildSeconds = secondsSince( start );
+
+	int* sbPath = NULL;
+	float* costs = mem_Allocate( sizeof( float ) * (size_t)numQueries );
+
+	// cold, nothing cached
+	float coldWorst = 0.0f;
+	uint64_t abstractExpansions = 0;
+	int numFound = 0;
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numQueries; ++i ) {
+		hpa_ClearPathCache( &map );
+		Uint64 queryStart = SDL_GetPerformanceCounter( );
+		sb_Clear( sbPath );
+		costs[i] = -1.0f;
+		if( hpa_FindPath( &map, queries[i * 2] % gridSize, queries[i * 2] / gridSize,
+				queries[( i * 2 ) + 1] % gridSize, queries[( i * 2 ) + 1] / gridSize, &sbPath ) ) {
+			costs[i] = pathCost( &grid, queries[i * 2], sbPath );
+			++numFound;
+		}
+		coldWorst = SDL_max( coldWorst, secondsSince( queryStart ) );
+		abstractExpansions += map.queryAbstractExpansions;
+	}
+	float coldSeconds = secondsSince( start );
+
+	// warm, fill the cache with the same queries then time different tiles in the same clusters
+	for( int i = 0; i < numQueries; ++i ) {
+		sb_Clear( sbPath );
+		hpa_FindPath( &map, queries[i * 2] % gridSize, queries[i * 2] / gridSize,
+			queries[( i * 2 ) + 1] % gridSize, queries[( i * 2 ) + 1] / gridSize, &sbPath );
+	}
+
+	float warmWorst = 0.0f;
+	int numCacheHits = 0;
+	float warmSeconds = 0.0f;
+	for( int i = 0; i < numQueries; ++i ) {
+		int startTile = randomOpenTileInBlock( &grid, &rg, queries[i * 2], clusterSize );
+		int targetTile = randomOpenTileInBlock( &grid, &rg, queries[( i * 2 ) + 1], clusterSize );
+		Uint64 queryStart = SDL_GetPerformanceCounter( );
+		sb_Clear( sbPath );
+		hpa_FindPath( &map, startTile % gridSize, startTile / gridSize, targetTile % gridSize, targetTile / gridSize, &sbPath );
+		float querySeconds = secondsSince( queryStart );
+		warmSeconds += querySeconds;
+		warmWorst = SDL_max( warmWorst, querySeconds );
+		numCacheHits += map.queryUsedCache ? 1 : 0;
+	}
+
+	// A* for comparison, only a few since they're slow at this size
+	AStarContext context;
+	aStar_InitContext( &context );
+	float aStarCost = 0.0f;
+	float hpaCost = 0.0f;
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numAStarQueries; ++i ) {
+		sb_Clear( sbPath );
+		bool found = aStar_FindPath( &context, &grid, nodeCount, queries[i * 2], queries[( i * 2 ) + 1],
+			gridMoveCost, gridHeuristic, gridNextNeighbor, &sbPath );
+		if( found != ( costs[i] >= 0.0f ) ) {
+			llog( LOG_ERROR, "Query %i: A* %s a path but the hierarchical search %s.", i,
+				found ? "found" : "didn't find", ( costs[i] >= 0.0f ) ? "did" : "didn't" );
+			result = -1;
+		}
+		if( found ) {
+			aStarCost += pathCost( &grid, queries[i * 2], sbPath );
+			hpaCost += costs[i];
+		}
+	}
+	float aStarSeconds = secondsSince( start );
+	aStar_CleanUpContext( &context );
+
+	// single tile changes, each rebuilt before the next
+	uint32_t clustersBefore = map.numClustersRebuilt;
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numTileChanges; ++i ) {
+		int tile = (int)rand_GetArrayEntry( &rg, nodeCount );
+		int x = tile % gridSize;
+		int y = tile / gridSize;
+		hpa_SetWalkable( &map, x, y, !hpa_IsWalkable( &map, x, y ) );
+		hpa_Update( &map );
+		hpa_SetWalkable( &map, x, y, !hpa_IsWalkable( &map, x, y ) );
+		hpa_Update( &map );
+	}
+	float changeSeconds = secondsSince( start );
+	uint32_t clustersRebuilt = map.numClustersRebuilt - clustersBefore;
+
+	llog( LOG_INFO, "%ix%i rooms map, %ix%i clusters, %i queries, %i found", gridSize, gridSize, clusterSize, clusterSize, numQueries, numFound );
+	llog( LOG_INFO, "Full build: %.3f ms, %i entrances", buildSeconds * 1000.0f, (int)( sb_Count( map.sbNodes ) - sb_Count( map.sbFreeNodes ) ) );
+	llog( LOG_INFO, "Uncached: %.3f ms per query  worst: %.3f ms  %.1f abstract expansions per query",
+		( coldSeconds * 1000.0f ) / (float)numQueries, coldWorst * 1000.0f, (float)abstractExpansions / (float)numQueries );
+	llog( LOG_INFO, "Cached:   %.3f ms per query  worst: %.3f ms  %i cache hits",
+		( warmSeconds * 1000.0f ) / (float)numQueries, warmWorst * 1000.0f, numCacheHits );
+	llog( LOG_INFO, "A*:       %.3f ms per query for the first %i, hierarchical paths are %.2f%% longer",
+		( aStarSeconds * 1000.0f ) / (float)numAStarQueries, numAStarQueries, ( aStarCost > 0.0f ) ? ( ( ( hpaCost / aStarCost ) - 1.0f ) * 100.0f ) : 0.0f );
+	llog( LOG_INFO, "Tile change: %.3f ms per rebuild, %.1f clusters per rebuild",
+		( changeSeconds * 1000.0f ) / (float)( numTileChanges * 2 ), (float)clustersRebuilt / (float)( numTileChanges * 2 ) );
+
+	sb_Release( sbPath );
+	mem_Release( costs );
+	hpa_DestroyMap( &map );
+
+clean_up:
+	mem_Release( walkable );
+	mem_Release( queries );
+	destroyGrid( &grid );
+
+	return result;
+}
+
+typedef struct {
+	int numDelivered;
+	int numFound;
+	float totalCost;
+} PathServiceBenchData;
+
+static void pathServiceBenchDone( PathRequest request, bool found, const int* path, size_t pathLength, void* userData )
+{
+	PathServiceBenchData* data = (PathServiceBenchData*)userData;
+	++data->numDelivered;
+	if( found ) {
+		++data->numFound;
+		data->totalCost += (float)pathLength;
+	}
+}
+
+typedef struct {
+	const char* name;
+	float seconds;
+	float worstFrame;
+	int numFrames;
+	PathServiceBenchData data;
+} PathServiceBenchResult;
+
+// requests a path for every agent and then calls pathSvc_Process( ) once a "frame" until they've all been delivered,
+//  the frame time is how long the main thread spent in pathSvc_Process( )
+static void runPathServiceBench( BenchGrid* grid, int numAgents, int* starts, int* targets, PathServiceBenchResult* result )
+{
+	size_t nodeCount = (size_t)( grid->width * grid->height );
+	SDL_zero( result->data );
+
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numAgents; ++i ) {
+		PathRequestDesc desc;
+		SDL_zero( desc );
+		desc.graph = grid;
+		desc.nodeCount = nodeCount;
+		desc.startNodeID = starts[i];
+		desc.targetNodeID = targets[i];
+		desc.moveCost = gridMoveCost;
+		desc.heuristic = gridHeuristic;
+		desc.nextNeighbor = gridNextNeighbor;
+		desc.priority = i % 4;
+		desc.onDone = pathServiceBenchDone;
+		desc.userData = &( result->data );
+		pathSvc_Request( &desc );
+	}
+	result->worstFrame = secondsSince( start );
+
+	result->numFrames = 0;
+	while( result->data.numDelivered < numAgents ) {
+		Uint64 frameStart = SDL_GetPerformanceCounter( );
+		pathSvc_Process( );
+		result->worstFrame = SDL_max( result->worstFrame, secondsSince( frameStart ) );
+		++result->numFrames;
+
+		if( result->data.numDelivered < numAgents ) {
+			// give the workers some time, like the rest of the frame would
+			SDL_Delay( 1 );
+		}
+	}
+	result->seconds = secondsSince( start );
+}
+
+// Hundreds of agents re-pathing at once. Compares running every search on the spot against the path service with
+//  worker threads and with only a per-frame budget on the main thread, the way the web build runs it. The agents are in
+//  squads that share a start and target so some of the requests are duplicates.
+int bench_PathService( int argc, char** argv )
+{
+	int gridSize = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 256;
+	int numAgents = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 500;
+	int frameBudget = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 4096;
+	if( gridSize < 16 ) gridSize = 256;
+	if( numAgents < 1 ) numAgents = 500;
+	if( frameBudget < 1 ) frameBudget = 4096;
+
+	const int squadSize = 4;
+	int result = 0;
+
+	BenchGrid grid;
+	createScatteredGrid( &grid, gridSize, gridSize, 0.25f, 0x5eed );
+	size_t nodeCount = (size_t)( gridSize * gridSize );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0xa57a );
+	int* starts = mem_Allocate( sizeof( int ) * (size_t)numAgents );
+	int* targets = mem_Allocate( sizeof( int ) * (size_t)numAgents );
+	for( int i = 0; i < numAgents; ++i ) {
+		if( ( i % squadSize ) == 0 ) {
+			starts[i] = randomOpenTile( &grid, &rg );
+			targets[i] = randomOpenTile( &grid, &rg );
+		} else {
+			starts[i] = starts[i - 1];
+			targets[i] = targets[i - 1];
+		}
+	}
+
+	// everything on the spot
+	int* sbPath = NULL;
+	AStarContext context;
+	aStar_InitContext( &context );
+	int syncFound = 0;
+	float syncCost = 0.0f;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numAgents; ++i ) {
+		sb_Clear( sbPath );
+		if( aStar_FindPath( &context, &grid, nodeCount, starts[i], targets[i], gridMoveCost, gridHeuristic, gridNextNeighbor, &sbPath ) ) {
+			++syncFound;
+			syncCost += (float)sb_Count( sbPath );
+		}
+	}
+	float syncSeconds = secondsSince( start );
+	aStar_CleanUpContext( &context );
+	sb_Release( sbPath );
+
+	PathServiceBenchResult results[2];
+	results[0].name = "workers";
+	results[1].name = "frame budget";
+
+	if( !pathSvc_Init( MAX( jq_GetNumThreads( ) - 1, 1 ) ) ) {
+		result = -1;
+		goto clean_up;
+	}
+	runPathServiceBench( &grid, numAgents, starts, targets, &results[0] );
+	PathServiceStats stats;
+	pathSvc_GetStats( &stats );
+	pathSvc_ShutDown( );
+
+	if( !pathSvc_Init( 0 ) ) {
+		result = -1;
+		goto clean_up;
+	}
+	pathSvc_SetFrameBudget( frameBudget );
+	runPathServiceBench( &grid, numAgents, starts, targets, &results[1] );
+	pathSvc_ShutDown( );
+
+	llog( LOG_INFO, "%ix%i grid, %i agents, %i searches after removing duplicates", gridSize, gridSize, numAgents, (int)stats.numSearches );
+	llog( LOG_INFO, "%-14s %8.3f ms in one frame", "on the spot", syncSeconds * 1000.0f );
+	for( int i = 0; i < 2; ++i ) {
+		llog( LOG_INFO, "%-14s %8.3f ms until all delivered  %5i frames  worst main thread frame: %.3f ms",
+			results[i].name, results[i].seconds * 1000.0f, results[i].numFrames, results[i].worstFrame * 1000.0f );
+
+		if( ( results[i].data.numFound != syncFound ) || ( results[i].data.totalCost != syncCost ) ) {
+			llog( LOG_ERROR, "%s found different paths than searching on the spot.", results[i].name );
+			result = -1;
+		}
+	}
+
+clean_up:
+	mem_Release( starts );
+	mem_Release( targets );
+	destroyGrid( &grid );
+
+	return result;
+}
+
+typedef struct {
+	float cost;
+	int cell;
+} FlowBenchEntry;
+
+// neighbors the same way the flow fields see them, done separately so the reference doesn't share any of its code
+static int flowBenchNeighbor( const FlowFieldMap* map, int cell, int dir, float* outDist )
+{
+	if( map->layout == FFL_HEX ) {
+		HexGridCoord coord = hex_GetNeighbor( hex_RectIndexToCoord( (uint32_t)cell, map->width, map->height ), dir );
+		if( !hex_CoordInRect( coord, map->width, map->height ) ) return -1;
+		int neighbor = (int)hex_CoordToRectIndex( coord, map->width, map->height );
+		( *outDist ) = 1.0f;
+		return ( flow_GetCost( map, neighbor ) == FLOW_BLOCKED ) ? -1 : neighbor;
+	}
+
+	int x = cell % map->width;
+	int y = cell / map->width;
+	int nx = x + gridDirX[dir];
+	int ny = y + gridDirY[dir];
+	if( ( nx < 0 ) || ( ny < 0 ) || ( nx >= map->width ) || ( ny >= map->height ) ) return -1;
+	if( ( flow_GetCost( map, nx + ( ny * map->width ) ) == FLOW_BLOCKED ) ||
+		( flow_GetCost( map, nx + ( y * map->width ) ) == FLOW_BLOCKED ) ||
+		( flow_GetCost( map, x + ( ny * map->width ) ) == FLOW_BLOCKED ) ) {
+		return -1;
+	}
+	( *outDist ) = ( dir < 4 ) ? 1.0f : SQRT_2;
+	return nx + ( ny * map->width );
+}
+
+static int flowBenchNextNeighbor( void* graph, int nodeID, int currNeighborNodeID )
+{
+	const FlowFieldMap* map = (const FlowFieldMap*)graph;
+	int numDirections = ( map->layout == FFL_HEX ) ? 6 : 8;
+	float dist;
+
+	int dir = 0;
+	if( currNeighborNodeID >= 0 ) {
+		while( ( dir < numDirections ) && ( flowBenchNeighbor( map, nodeID, dir, &dist ) != currNeighborNodeID ) ) {
+			++dir;
+		}
+		++dir;
+	}
+
+	for( ; dir < numDirections; ++dir ) {
+		int neighbor = flowBenchNeighbor( map, nodeID, dir, &dist );
+		if( neighbor >= 0 ) return neighbor;
+	}
+	return -1;
+}
+
+static float flowBenchMoveCost( void* graph, int fromNodeID, int toNodeID )
+{
+	const FlowFieldMap* map = (const FlowFieldMap*)graph;
+	float dist = 1.0f;
+	if( ( map->layout == FFL_SQUARE ) && ( ( fromNodeID % map->width ) != ( toNodeID % map->width ) ) &&
+		( ( fromNodeID / map->width ) != ( toNodeID / map->width ) ) ) {
+		dist = SQRT_2;
+	}
+	return dist * (float)flow_GetCost( map, toNodeID );
+}
+
+static float flowBenchHeuristic( void* graph, int fromNodeID, int toNodeID )
+{
+	const FlowFieldMap* map = (const FlowFieldMap*)graph;
+	if( map->layout == FFL_HEX ) {
+		return (float)hex_Distance( hex_RectIndexToCoord( (uint32_t)fromNodeID, map->width, map->height ),
+			hex_RectIndexToCoord( (uint32_t)toNodeID, map->width, map->height ) );
+	}
+
+	float dx = fabsf( (float)( ( fromNodeID % map->width ) - ( toNodeID % map->width ) ) );
+	float dy = fabsf( (float)( ( fromNodeID / map->width ) - ( toNodeID / map->width ) ) );
+	return ( dx + dy ) + ( ( SQRT_2 - 2.0f ) * SDL_min( dx, dy ) );
+}
+
+static void flowBenchSiftDown( FlowBenchEntry* heap, size_t count, size_t idx )
+{
+	for( ;; ) {
+		size_t best = idx;
+		size_t left = ( idx * 2 ) + 1;
+		if( ( left < count ) && ( heap[left].cost < heap[best].cost ) ) best = left;
+		if( ( left + 1 < count ) && ( heap[left + 1].cost < heap[best].cost ) ) best = left + 1;
+		if( best == idx ) return;
+		FlowBenchEntry temp = heap[idx];
+		heap[idx] = heap[best];
+		heap[best] = temp;
+		idx = best;
+	}
+}
+
+// plain Dijkstra over the whole map from the goal, with a lazy deletion heap
+static void flowBenchReference( const FlowFieldMap* map, int goal, float* outIntegration )
+{
+	int numCells = map->width * map->height;
+	int numDirections = ( map->layout == FFL_HEX ) ? 6 : 8;
+	for( int i = 0; i < numCells; ++i ) {
+		outIntegration[i] = FLT_MAX;
+	}
+
+	FlowBenchEntry* sbHeap = NULL;
+	outIntegration[goal] = 0.0f;
+	FlowBenchEntry first = { 0.0f, goal };
+	sb_Push( sbHeap, first );
+	while( sb_Count( sbHeap ) > 0 ) {
+		FlowBenchEntry top = sbHeap[0];
+		sbHeap[0] = sb_Last( sbHeap );
+		(void)sb_Pop( sbHeap );
+		flowBenchSiftDown( sbHeap, sb_Count( sbHeap ), 0 );
+		if( top.cost > outIntegration[top.cell] ) continue;
+
+		for( int dir = 0; dir < numDirections; ++dir ) {
+			float dist;
+			int neighbor = flowBenchNeighbor( map, top.cell, dir, &dist );
+			if( neighbor < 0 ) continue;
+
+			float cost = top.cost + ( dist * (float)flow_GetCost( map, top.cell ) );
+			if( cost < outIntegration[neighbor] ) {
+				outIntegration[neighbor] = cost;
+				FlowBenchEntry entry = { cost, neighbor };
+				sb_Push( sbHeap, entry );
+				size_t idx = sb_Count( sbHeap ) - 1;
+				while( ( idx > 0 ) && ( sbHeap[( idx - 1 ) / 2].cost > sbHeap[idx].cost ) ) {
+					FlowBenchEntry temp = sbHeap[idx];
+					sbHeap[idx] = sbHeap[( idx - 1 ) / 2];
+					sbHeap[( idx - 1 ) / 2] = temp;
+					idx = ( idx - 1 ) / 2;
+				}
+			}
+		}
+	}
+	sb_Release( sbHeap );
+}
+
+// builds a field for the map, checks it against the reference, and times sampling it for a lot of agents
+static int runFlowFieldBench( const char* name, FlowFieldMap* map, int numAgents, RandomGroup* rg )
+{
+	int numCells = map->width * map->height;
+	int goal;
+	do {
+		goal = (int)rand_GetArrayEntry( rg, (size_t)numCells );
+	} while( flow_GetCost( map, goal ) == FLOW_BLOCKED );
+
+	Uint64 start = SDL_GetPerformanceCounter( );
+	FlowField* field = flow_Acquire( map, goal );
+	float buildSeconds = secondsSince( start );
+	if( field == NULL ) return -1;
+
+	start = SDL_GetPerformanceCounter( );
+	FlowField* cachedField = flow_Acquire( map, goal );
+	float cachedSeconds = secondsSince( start );
+	flow_Release( map, cachedField );
+
+	float* reference = mem_Allocate( sizeof( float ) * (size_t)numCells );
+	start = SDL_GetPerformanceCounter( );
+	flowBenchReference( map, goal, reference );
+	float referenceSeconds = secondsSince( start );
+
+	int result = 0;
+	int numMismatched = 0;
+	int numReachable = 0;
+	for( int i = 0; i < numCells; ++i ) {
+		if( reference[i] != FLT_MAX ) ++numReachable;
+		if( ( reference[i] == FLT_MAX ) != ( field->integration[i] == FLT_MAX ) ||
+			( ( reference[i] != FLT_MAX ) && ( fabsf( reference[i] - field->integration[i] ) > ( 0.0001f * reference[i] ) ) ) ) {
+			++numMismatched;
+		}
+	}
+	if( numMismatched > 0 ) {
+		llog( LOG_ERROR, "%s: %i cells have a different integration than the reference.", name, numMismatched );
+		result = -1;
+	}
+
+	// agents spread around every reachable cell, following the direction field has to get to the goal
+	Vector2* positions = mem_Allocate( sizeof( Vector2 ) * (size_t)numAgents );
+	int numBadRoutes = 0;
+	for( int i = 0; i < numAgents; ++i ) {
+		int cell;
+		do {
+			cell = (int)rand_GetArrayEntry( rg, (size_t)numCells );
+		} while( reference[cell] == FLT_MAX );
+		positions[i] = flow_CellCenter( map, cell );
+
+		if( i < 100 ) {
+			int steps = 0;
+			while( ( cell != goal ) && ( cell >= 0 ) && ( steps < numCells ) ) {
+				cell = flow_GetNextCell( map, field, cell );
+				++steps;
+			}
+			if( cell != goal ) ++numBadRoutes;
+		}
+	}
+	if( numBadRoutes > 0 ) {
+		llog( LOG_ERROR, "%s: %i agents didn't reach the goal following the field.", name, numBadRoutes );
+		result = -1;
+	}
+
+	const int numSampleRounds = 100;
+	Vector2 dirSum = VEC2_ZERO;
+	start = SDL_GetPerformanceCounter( );
+	for( int round = 0; round < numSampleRounds; ++round ) {
+		for( int i = 0; i < numAgents; ++i ) {
+			Vector2 dir;
+			if( flow_GetDirection( map, field, positions[i], &dir ) ) {
+				vec2_Add( &dirSum, &dir, &dirSum );
+			}
+		}
+	}
+	float sampleSeconds = secondsSince( start );
+
+	// what it would cost for each agent to search for its own path instead, only a few since it's slow
+	const int numSearches = SDL_min( numAgents, 20 );
+	AStarContext context;
+	aStar_InitContext( &context );
+	int* sbPath = NULL;
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numSearches; ++i ) {
+		sb_Clear( sbPath );
+		aStar_FindPath( &context, map, (size_t)numCells, flow_PositionToCell( map, positions[i] ), goal,
+			flowBenchMoveCost, flowBenchHeuristic, flowBenchNextNeighbor, &sbPath );
+	}
+	float searchSeconds = secondsSince( start );
+	sb_Release( sbPath );
+	aStar_CleanUpContext( &context );
+
+	llog( LOG_INFO, "%s: %ix%i cells, %i reachable, %i agents", name, map->width, map->height, numReachable, numAgents );
+	llog( LOG_INFO, "  build: %.3f ms (%u rounds, %u tiles processed)  single threaded Dijkstra: %.3f ms  cached: %.4f ms",
+		buildSeconds * 1000.0f, map->numRounds, map->numTilesProcessed, referenceSeconds * 1000.0f, cachedSeconds * 1000.0f );
+	llog( LOG_INFO, "  sample: %.1f ns per agent (%.1f)  A* per agent: %.3f ms, the field pays for itself after %.1f agents",
+		( sampleSeconds * 1.0e9f ) / (float)( numAgents * numSampleRounds ), dirSum.x + dirSum.y,
+		( searchSeconds * 1000.0f ) / (float)numSearches, buildSeconds / ( searchSeconds / (float)numSearches ) );
+
+	mem_Release( positions );
+	mem_Release( reference );
+	flow_Release( map, field );
+
+	return result;
+}
+
+static void setFlowCosts( FlowFieldMap* map, BenchGrid* grid, RandomGroup* rg )
+{
+	int numCells = map->width * map->height;
+	uint8_t* costs = mem_Allocate( (size_t)numCells );
+	for( int i = 0; i < numCells; ++i ) {
+		// some rough ground so the costs aren't all the same
+		costs[i] = grid->blocked[i] ? FLOW_BLOCKED : ( ( rand_GetNormalizedFloat( rg ) < 0.2f ) ? 3 : 1 );
+	}
+	flow_SetAllCosts( map, costs );
+	mem_Release( costs );
+}
+
+// Builds flow fields on square and hex maps, checks them against a single threaded Dijkstra over the whole map, and
+//  times sampling a direction for every agent against searching for a path for each of them.
+int bench_FlowField( int argc, char** argv )
+{
+	int gridSize = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 512;
+	int numAgents = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 10000;
+	if( gridSize < 32 ) gridSize = 512;
+	if( numAgents < 1 ) numAgents = 10000;
+
+	int result = 0;
+	RandomGroup rg;
+	rand_Seed( &rg, 0xf10f );
+
+	BenchGrid scattered;
+	createScatteredGrid( &scattered, gridSize, gridSize, 0.25f, 0x5eed );
+	BenchGrid rooms;
+	createRoomsGrid( &rooms, gridSize, gridSize, 0x5eed );
+
+	FlowFieldMap map;
+	if( flow_CreateMap( &map, FFL_SQUARE, gridSize, gridSize, VEC2_ZERO, 16.0f ) ) {
+		setFlowCosts( &map, &scattered, &rg );
+		result |= runFlowFieldBench( "square scattered", &map, numAgents, &rg );
+		setFlowCosts( &map, &rooms, &rg );
+		flow_Update( &map );
+		result |= runFlowFieldBench( "square rooms", &map, numAgents, &rg );
+		flow_DestroyMap( &map );
+	} else {
+		result = -1;
+	}
+
+	if( flow_CreateMap( &map, FFL_HEX, gridSize, gridSize, VEC2_ZERO, 16.0f ) ) {
+		setFlowCosts( &map, &scattered, &rg );
+		result |= runFlowFieldBench( "hex scattered", &map, numAgents, &rg );
+		flow_DestroyMap( &map );
+	} else {
+		result = -1;
+	}
+
+	destroyGrid( &scattered );
+	destroyGrid( &rooms );
+
+	return ( result == 0 ) ? 0 : -1;
+}
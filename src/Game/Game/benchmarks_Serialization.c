@@ -0,0 +1,838 @@
+#include "benchmarks.h"
+
+#include <stdio.h>
+#include <SDL3/SDL.h>
+
+#include "DefaultECPS/generalComponents.h"
+#include "Graphics/images.h"
+#include "Math/mathUtil.h"
+#include "Math/vector2.h"
+#include "Others/cmp.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "System/random.h"
+#include "System/serializer.h"
+#include "System/ECPS/entityComponentProcessSystem.h"
+#include "System/ECPS/ecps_fileSerialization.h"
+#include "System/ECPS/ecps_snapshot.h"
+#include "Utils/stretchyBuffer.h"
+
+// the most entities an ECPS can hold is limited by the entity index
+#define BENCH_MAX_ECPS_ENTITIES 60000
+
+#define BENCH_NUM_SPRITE_IMAGES 4
+
+// the current format allocates each component it doesn't pack, and with the memory manager that gets slow quickly
+#define BENCH_MAX_GENERAL_ENTITIES 5000
+
+// everything is serialized in order, so the packed data is a copy of the whole thing
+typedef struct {
+	Vector2 pos;
+	Vector2 vel;
+	float rotRad;
+	int32_t health;
+	uint32_t flags;
+} BenchBodyData;
+
+// has references to other entities, so it's a few copies with the ids in between
+typedef struct {
+	EntityID target;
+	float strength;
+	EntityID owner;
+	int8_t team;
+} BenchLinkData;
+
+static bool serializeBenchBody( Serializer* s, void* data )
+{
+	ASSERT_AND_IF_NOT( s != NULL ) return false;
+	ASSERT_AND_IF_NOT( data != NULL ) return false;
+
+	BenchBodyData* body = (BenchBodyData*)data;
+
+	SERIALIZE_CHECK( s->startStructure( s, "" ), "BenchBodyData", "starting", return false );
+	SERIALIZE_CHECK( vec2_Serialize( s, "pos", &( body->pos ) ), "BenchBodyData", "pos", return false );
+	SERIALIZE_CHECK( vec2_Serialize( s, "vel", &( body->vel ) ), "BenchBodyData", "vel", return false );
+	SERIALIZE_CHECK( s->flt( s, "rotRad", &( body->rotRad ) ), "BenchBodyData", "rotRad", return false );
+	SERIALIZE_CHECK( s->s32( s, "health", &( body->health ) ), "BenchBodyData", "health", return false );
+	SERIALIZE_CHECK( s->u32( s, "flags", &( body->flags ) ), "BenchBodyData", "flags", return false );
+	SERIALIZE_CHECK( s->endStructure( s, "" ), "BenchBodyData", "ending", return false );
+
+	return true;
+}
+
+static bool serializeBenchLink( Serializer* s, void* data )
+{
+	ASSERT_AND_IF_NOT( s != NULL ) return false;
+	ASSERT_AND_IF_NOT( data != NULL ) return false;
+
+	BenchLinkData* link = (BenchLinkData*)data;
+
+	SERIALIZE_CHECK( s->startStructure( s, "" ), "BenchLinkData", "starting", return false );
+	SERIALIZE_CHECK( s->entityID( s, "target", &( link->target ) ), "BenchLinkData", "target", return false );
+	SERIALIZE_CHECK( s->flt( s, "strength", &( link->strength ) ), "BenchLinkData", "strength", return false );
+	SERIALIZE_CHECK( s->entityID( s, "owner", &( link->owner ) ), "BenchLinkData", "owner", return false );
+	SERIALIZE_CHECK( s->s8( s, "team", &( link->team ) ), "BenchLinkData", "team", return false );
+	SERIALIZE_CHECK( s->endStructure( s, "" ), "BenchLinkData", "ending", return false );
+
+	return true;
+}
+
+// the same fields in a different order, so the schema doesn't match one saved with serializeBenchBody( )
+static bool serializeBenchBodyReordered( Serializer* s, void* data )
+{
+	ASSERT_AND_IF_NOT( s != NULL ) return false;
+	ASSERT_AND_IF_NOT( data != NULL ) return false;
+
+	BenchBodyData* body = (BenchBodyData*)data;
+
+	SERIALIZE_CHECK( s->startStructure( s, "" ), "BenchBodyData", "starting", return false );
+	SERIALIZE_CHECK( s->u32( s, "flags", &( body->flags ) ), "BenchBodyData", "flags", return false );
+	SERIALIZE_CHECK( vec2_Serialize( s, "vel", &( body->vel ) ), "BenchBodyData", "vel", return false );
+	SERIALIZE_CHECK( vec2_Serialize( s, "pos", &( body->pos ) ), "BenchBodyData", "pos", return false );
+	SERIALIZE_CHECK( s->s32( s, "health", &( body->health ) ), "BenchBodyData", "health", return false );
+	SERIALIZE_CHECK( s->flt( s, "rotRad", &( body->rotRad ) ), "BenchBodyData", "rotRad", return false );
+	SERIALIZE_CHECK( s->endStructure( s, "" ), "BenchBodyData", "ending", return false );
+
+	return true;
+}
+
+static float serialSecondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+//************************************
+// memory buffer for cmp, grows by doubling
+typedef struct {
+	uint8_t* data;
+	size_t size;
+	size_t pos;
+} BenchBuffer;
+
+static bool benchBufferReader( struct cmp_ctx_s* ctx, void* data, size_t limit )
+{
+	BenchBuffer* buffer = (BenchBuffer*)( ctx->buf );
+	if( ( buffer->pos + limit ) > buffer->size ) return false;
+	SDL_memcpy( data, buffer->data + buffer->pos, limit );
+	buffer->pos += limit;
+	return true;
+}
+
+static bool benchBufferSkipper( struct cmp_ctx_s* ctx, size_t count )
+{
+	BenchBuffer* buffer = (BenchBuffer*)( ctx->buf );
+	if( ( buffer->pos + count ) > buffer->size ) return false;
+	buffer->pos += count;
+	return true;
+}
+
+static size_t benchBufferWriter( struct cmp_ctx_s* ctx, const void* data, size_t count )
+{
+	BenchBuffer* buffer = (BenchBuffer*)( ctx->buf );
+	if( ( buffer->pos + count ) > buffer->size ) {
+		size_t newSize = SDL_max( buffer->size * 2, buffer->pos + count );
+		uint8_t* newData = mem_Resize( buffer->data, newSize );
+		if( newData == NULL ) return 0;
+		buffer->data = newData;
+		buffer->size = newSize;
+	}
+	SDL_memcpy( buffer->data + buffer->pos, data, count );
+	buffer->pos += count;
+	return count;
+}
+
+static void randomBody( RandomGroup* rg, BenchBodyData* out )
+{
+	out->pos = vec2( rand_GetRangeFloat( rg, -1000.0f, 1000.0f ), rand_GetRangeFloat( rg, -1000.0f, 1000.0f ) );
+	out->vel = vec2( rand_GetRangeFloat( rg, -10.0f, 10.0f ), rand_GetRangeFloat( rg, -10.0f, 10.0f ) );
+	out->rotRad = rand_GetRangeFloat( rg, 0.0f, 6.28f );
+	out->health = rand_GetRangeS32( rg, 0, 100 );
+	out->flags = (uint32_t)rand_GetRangeS32( rg, 0, INT32_MAX );
+}
+
+// same as the components when only the serialized fields are looked at
+static bool sameBody( const BenchBodyData* lhs, const BenchBodyData* rhs )
+{
+	return ( lhs->pos.x == rhs->pos.x ) && ( lhs->pos.y == rhs->pos.y ) && ( lhs->vel.x == rhs->vel.x ) && ( lhs->vel.y == rhs->vel.y ) &&
+		( lhs->rotRad == rhs->rotRad ) && ( lhs->health == rhs->health ) && ( lhs->flags == rhs->flags );
+}
+
+//************************************
+// Just the components, saving and loading them all to and from one buffer
+static int benchComponents( int numComponents, RandomGroup* rg )
+{
+	SerializerSchema bodySchema;
+	SerializerSchema linkSchema;
+	if( !serializer_CompileSchema( serializeBenchBody, sizeof( BenchBodyData ), &bodySchema ) ) {
+		return 1;
+	}
+	if( !serializer_CompileSchema( serializeBenchLink, sizeof( BenchLinkData ), &linkSchema ) ) {
+		serializer_DestroySchema( &bodySchema );
+		return 1;
+	}
+
+	llog( LOG_INFO, "  body: %u fields in %u copies, %u bytes packed%s", (uint32_t)sb_Count( bodySchema.sbFields ), (uint32_t)sb_Count( bodySchema.sbOps ),
+		bodySchema.packedSize, serializer_IsSchemaPOD( &bodySchema ) ? ", plain data" : "" );
+	llog( LOG_INFO, "  link: %u fields in %u copies, %u bytes packed%s", (uint32_t)sb_Count( linkSchema.sbFields ), (uint32_t)sb_Count( linkSchema.sbOps ),
+		linkSchema.packedSize, serializer_IsSchemaPOD( &linkSchema ) ? ", plain data" : "" );
+
+	BenchBodyData* bodies = mem_Allocate( sizeof( BenchBodyData ) * numComponents );
+	BenchLinkData* links = mem_Allocate( sizeof( BenchLinkData ) * numComponents );
+	BenchBodyData* readBodies = mem_Allocate( sizeof( BenchBodyData ) * numComponents );
+	BenchLinkData* readLinks = mem_Allocate( sizeof( BenchLinkData ) * numComponents );
+	uint8_t* packed = mem_Allocate( ( (size_t)bodySchema.packedSize + linkSchema.packedSize ) * numComponents );
+
+	for( int i = 0; i < numComponents; ++i ) {
+		randomBody( rg, &bodies[i] );
+
+		SDL_zero( links[i] );
+		links[i].target = (EntityID)rand_GetRangeS32( rg, 1, numComponents );
+		links[i].strength = rand_GetRangeFloat( rg, 0.0f, 1.0f );
+		links[i].owner = (EntityID)rand_GetRangeS32( rg, 1, numComponents );
+		links[i].team = (int8_t)rand_GetRangeS32( rg, 0, 4 );
+	}
+
+	// through the serializer
+	BenchBuffer buffer = { NULL, 0, 0 };
+	cmp_ctx_t cmp;
+	cmp_init( &cmp, &buffer, benchBufferReader, benchBufferSkipper, benchBufferWriter );
+	Serializer s;
+
+	int failures = 0;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	serializer_CreateWriteCmp( &cmp, &s );
+	for( int i = 0; i < numComponents; ++i ) {
+		if( !serializeBenchBody( &s, &bodies[i] ) || !serializeBenchLink( &s, &links[i] ) ) ++failures;
+	}
+	float namedWrite = serialSecondsSince( start );
+	size_t namedSize = buffer.pos;
+
+	buffer.pos = 0;
+	start = SDL_GetPerformanceCounter( );
+	serializer_CreateReadCmp( &cmp, &s );
+	for( int i = 0; i < numComponents; ++i ) {
+		SDL_zero( readBodies[i] );
+		SDL_zero( readLinks[i] );
+		if( !serializeBenchBody( &s, &readBodies[i] ) || !serializeBenchLink( &s, &readLinks[i] ) ) ++failures;
+	}
+	float namedRead = serialSecondsSince( start );
+
+	int mismatches = 0;
+	for( int i = 0; i < numComponents; ++i ) {
+		if( !sameBody( &bodies[i], &readBodies[i] ) || ( SDL_memcmp( &links[i], &readLinks[i], sizeof( BenchLinkData ) ) != 0 ) ) ++mismatches;
+	}
+
+	// packed with the schemas
+	serializer_SetRawEntityID( &s );
+	start = SDL_GetPerformanceCounter( );
+	uint8_t* out = packed;
+	for( int i = 0; i < numComponents; ++i ) {
+		if( !serializer_WritePacked( &bodySchema, &bodies[i], &( s.entityAccessor ), out ) ) ++failures;
+		out += bodySchema.packedSize;
+		if( !serializer_WritePacked( &linkSchema, &links[i], &( s.entityAccessor ), out ) ) ++failures;
+		out += linkSchema.packedSize;
+	}
+	float packedWrite = serialSecondsSince( start );
+	size_t packedSize = (size_t)( out - packed );
+
+	start = SDL_GetPerformanceCounter( );
+	const uint8_t* in = packed;
+	for( int i = 0; i < numComponents; ++i ) {
+		SDL_zero( readBodies[i] );
+		SDL_zero( readLinks[i] );
+		if( !serializer_ReadPacked( bodySchema.sbOps, in, bodySchema.packedSize, &( s.entityAccessor ), &readBodies[i] ) ) ++failures;
+		in += bodySchema.packedSize;
+		if( !serializer_ReadPacked( linkSchema.sbOps, in, linkSchema.packedSize, &( s.entityAccessor ), &readLinks[i] ) ) ++failures;
+		in += linkSchema.packedSize;
+	}
+	float packedRead = serialSecondsSince( start );
+
+	for( int i = 0; i < numComponents; ++i ) {
+		if( !sameBody( &bodies[i], &readBodies[i] ) || ( SDL_memcmp( &links[i], &readLinks[i], sizeof( BenchLinkData ) ) != 0 ) ) ++mismatches;
+	}
+
+	llog( LOG_INFO, "  %i of each component, serializer: write %.3f ms read %.3f ms %zu bytes, packed: write %.3f ms read %.3f ms %zu bytes",
+		numComponents, 1000.0f * namedWrite, 1000.0f * namedRead, namedSize, 1000.0f * packedWrite, 1000.0f * packedRead, packedSize );
+	llog( LOG_INFO, "    %i failures, %i components didn't match after reading", failures, mismatches );
+
+	mem_Release( buffer.data );
+	mem_Release( packed );
+	mem_Release( readLinks );
+	mem_Release( readBodies );
+	mem_Release( links );
+	mem_Release( bodies );
+	serializer_DestroySchema( &linkSchema );
+	serializer_DestroySchema( &bodySchema );
+
+	return ( ( failures == 0 ) && ( mismatches == 0 ) ) ? 0 : 1;
+}
+
+//************************************
+// Whole ECPS, through ecps_GenerateSerializedECPS( ) and ecps_CreateEntitiesFromSerializedComponents( )
+static ComponentID benchBodyCompID;
+static ComponentID benchLinkCompID;
+
+// changed registers the types in the opposite order and reorders the body fields, like a newer build of the game would
+static void setUpBenchECPS( ECPS* ecps, bool compiled, bool changed )
+{
+	SDL_zerop( ecps );
+	ecps_StartInitialization( ecps );
+	if( changed ) {
+		benchLinkCompID = ecps_AddComponentType( ecps, "BENCH_LINK", 0, sizeof( BenchLinkData ), ALIGN_OF( BenchLinkData ), NULL, NULL, serializeBenchLink );
+		benchBodyCompID = ecps_AddComponentType( ecps, "BENCH_BODY", 0, sizeof( BenchBodyData ), ALIGN_OF( BenchBodyData ), NULL, NULL, serializeBenchBodyReordered );
+	} else {
+		benchBodyCompID = ecps_AddComponentType( ecps, "BENCH_BODY", 0, sizeof( BenchBodyData ), ALIGN_OF( BenchBodyData ), NULL, NULL, serializeBenchBody );
+		benchLinkCompID = ecps_AddComponentType( ecps, "BENCH_LINK", 0, sizeof( BenchLinkData ), ALIGN_OF( BenchLinkData ), NULL, NULL, serializeBenchLink );
+	}
+	if( compiled ) {
+		ecps_CompileComponentSerialization( ecps, benchBodyCompID );
+		ecps_CompileComponentSerialization( ecps, benchLinkCompID );
+	}
+	ecps_FinishInitialization( ecps );
+}
+
+// entities are created in order so both should have them in the same order, links should point at the same bodies
+static int countLoadMismatches( ECPS* original, ECPS* loaded )
+{
+	// the component ids can be different in each
+	ComponentID origBodyID = ecps_GetComponentIDByName( original, "BENCH_BODY" );
+	ComponentID origLinkID = ecps_GetComponentIDByName( original, "BENCH_LINK" );
+	ComponentID loadedBodyID = ecps_GetComponentIDByName( loaded, "BENCH_BODY" );
+	ComponentID loadedLinkID = ecps_GetComponentIDByName( loaded, "BENCH_LINK" );
+
+	int mismatches = 0;
+	EntityID origID = idSet_GetFirstValidID( &( original->idSet ) );
+	EntityID loadedID = idSet_GetFirstValidID( &( loaded->idSet ) );
+	while( ( origID != INVALID_ENTITY_ID ) && ( loadedID != INVALID_ENTITY_ID ) ) {
+		BenchBodyData* origBody = NULL;
+		BenchBodyData* loadedBody = NULL;
+		BenchLinkData* origLink = NULL;
+		BenchLinkData* loadedLink = NULL;
+		ecps_GetComponentFromEntityByID( original, origID, origBodyID, &origBody );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, loadedBodyID, &loadedBody );
+		ecps_GetComponentFromEntityByID( original, origID, origLinkID, &origLink );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, loadedLinkID, &loadedLink );
+
+		if( ( origBody == NULL ) || ( loadedBody == NULL ) || !sameBody( origBody, loadedBody ) ) {
+			++mismatches;
+		} else if( ( origLink == NULL ) != ( loadedLink == NULL ) ) {
+			++mismatches;
+		} else if( origLink != NULL ) {
+			BenchBodyData* origTarget = NULL;
+			BenchBodyData* loadedTarget = NULL;
+			ecps_GetComponentFromEntityByID( original, origLink->target, origBodyID, &origTarget );
+			ecps_GetComponentFromEntityByID( loaded, loadedLink->target, loadedBodyID, &loadedTarget );
+			if( ( origTarget == NULL ) || ( loadedTarget == NULL ) || !sameBody( origTarget, loadedTarget ) ||
+				( origLink->strength != loadedLink->strength ) || ( origLink->team != loadedLink->team ) || ( loadedLink->owner != loadedID ) ) {
+				++mismatches;
+			}
+		}
+
+		origID = idSet_GetNextValidID( &( original->idSet ), origID );
+		loadedID = idSet_GetNextValidID( &( loaded->idSet ), loadedID );
+	}
+
+	if( ( origID != INVALID_ENTITY_ID ) || ( loadedID != INVALID_ENTITY_ID ) ) ++mismatches;
+	return mismatches;
+}
+
+static int benchECPS( int numEntities, RandomGroup* rg )
+{
+	ECPS named;
+	ECPS compiled;
+	setUpBenchECPS( &named, false, false );
+	setUpBenchECPS( &compiled, true, false );
+
+	// the same entities in both, every other one has a link to some other entity
+	EntityID* sbNamedIDs = NULL;
+	EntityID* sbCompiledIDs = NULL;
+	for( int i = 0; i < numEntities; ++i ) {
+		BenchBodyData body;
+		randomBody( rg, &body );
+		sb_Push( sbNamedIDs, ecps_CreateEntity( &named, 1, benchBodyCompID, &body ) );
+		sb_Push( sbCompiledIDs, ecps_CreateEntity( &compiled, 1, benchBodyCompID, &body ) );
+	}
+	for( int i = 0; i < numEntities; i += 2 ) {
+		size_t target = rand_GetArrayEntry( rg, (size_t)numEntities );
+		BenchLinkData link;
+		SDL_zero( link );
+		link.strength = rand_GetRangeFloat( rg, 0.0f, 1.0f );
+		link.team = (int8_t)rand_GetRangeS32( rg, 0, 4 );
+
+		link.target = sbNamedIDs[target];
+		link.owner = sbNamedIDs[i];
+		ecps_AddComponentToEntityByID( &named, sbNamedIDs[i], benchLinkCompID, &link );
+
+		link.target = sbCompiledIDs[target];
+		link.owner = sbCompiledIDs[i];
+		ecps_AddComponentToEntityByID( &compiled, sbCompiledIDs[i], benchLinkCompID, &link );
+	}
+	sb_Release( sbNamedIDs );
+	sb_Release( sbCompiledIDs );
+
+	ECPS* sources[2] = { &named, &compiled };
+	const char* labels[2] = { "serializer", "packed" };
+	int mismatches = 0;
+	for( int i = 0; i < 2; ++i ) {
+		SerializedECPS serialized;
+		ecps_InitSerialized( &serialized );
+
+		Uint64 start = SDL_GetPerformanceCounter( );
+		ecps_GenerateSerializedECPS( sources[i], &serialized );
+		float generate = serialSecondsSince( start );
+
+		size_t totalSize = 0;
+		for( size_t e = 0; e < sb_Count( serialized.sbEntityInfos ); ++e ) {
+			for( size_t c = 0; c < sb_Count( serialized.sbEntityInfos[e].sbCompData ); ++c ) {
+				totalSize += serialized.sbEntityInfos[e].sbCompData[c].dataSize;
+			}
+		}
+
+		// load into a new ECPS set up the same way
+		ECPS loaded;
+		setUpBenchECPS( &loaded, i == 1, false );
+		start = SDL_GetPerformanceCounter( );
+		ecps_CreateEntitiesFromSerializedComponents( &loaded, &serialized );
+		float create = serialSecondsSince( start );
+
+		int loadMismatches = countLoadMismatches( sources[i], &loaded );
+		mismatches += loadMismatches;
+
+		llog( LOG_INFO, "  %s: generate %.3f ms, create %.3f ms, %zu bytes of component data, %i entities didn't match", labels[i],
+			1000.0f * generate, 1000.0f * create, totalSize, loadMismatches );
+
+		ecps_CleanUp( &loaded );
+
+		// packed components have to load into a build where the types aren't compiled anymore
+		if( i == 1 ) {
+			setUpBenchECPS( &loaded, false, false );
+			start = SDL_GetPerformanceCounter( );
+			ecps_CreateEntitiesFromSerializedComponents( &loaded, &serialized );
+			create = serialSecondsSince( start );
+
+			loadMismatches = countLoadMismatches( sources[i], &loaded );
+			mismatches += loadMismatches;
+
+			llog( LOG_INFO, "  packed without schemas: create %.3f ms, %i entities didn't match", 1000.0f * create, loadMismatches );
+
+			ecps_CleanUp( &loaded );
+
+			// and into one where the types have changed, so the fields have to be matched by name
+			setUpBenchECPS( &loaded, true, true );
+			start = SDL_GetPerformanceCounter( );
+			ecps_CreateEntitiesFromSerializedComponents( &loaded, &serialized );
+			create = serialSecondsSince( start );
+
+			loadMismatches = countLoadMismatches( sources[i], &loaded );
+			mismatches += loadMismatches;
+
+			llog( LOG_INFO, "  packed with changed schemas: create %.3f ms, %i entities didn't match", 1000.0f * create, loadMismatches );
+
+			ecps_CleanUp( &loaded );
+		}
+		ecps_CleanSerialized( &serialized );
+	}
+
+	ecps_CleanUp( &compiled );
+	ecps_CleanUp( &named );
+
+	return ( mismatches == 0 ) ? 0 : 1;
+}
+
+int bench_Serialization( int argc, char** argv )
+{
+	int numComponents = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 100000;
+	if( numComponents <= 0 ) numComponents = 100000;
+	int numEntities = SDL_min( numComponents, BENCH_MAX_ECPS_ENTITIES );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0x5e71a1 );
+
+	llog( LOG_INFO, "Serialization: %i components", numComponents );
+	int result = benchComponents( numComponents, &rg );
+
+	llog( LOG_INFO, "Serialization: ECPS with %i entities", numEntities );
+	result |= benchECPS( numEntities, &rg );
+
+	return result;
+}
+
+//************************************
+// Whole ECPS saved to a file, the current format against snapshots
+static bool getBenchFileSize( const char* fileName, uint64_t* outSize )
+{
+	SDL_PathInfo info;
+	if( !SDL_GetPathInfo( fileName, &info ) ) return false;
+	( *outSize ) = info.size;
+	return true;
+}
+
+// snapshots store the entities by archetype so they can be loaded in a different order, the body flags are the index
+//  of the entity in sbOrigIDs so they can be matched up
+static int countSnapshotMismatches( ECPS* original, const EntityID* sbOrigIDs, ECPS* loaded )
+{
+	ComponentID origBodyID = ecps_GetComponentIDByName( original, "BENCH_BODY" );
+	ComponentID origLinkID = ecps_GetComponentIDByName( original, "BENCH_LINK" );
+	ComponentID loadedBodyID = ecps_GetComponentIDByName( loaded, "BENCH_BODY" );
+	ComponentID loadedLinkID = ecps_GetComponentIDByName( loaded, "BENCH_LINK" );
+
+	int mismatches = 0;
+	size_t numLoaded = 0;
+	for( EntityID loadedID = idSet_GetFirstValidID( &( loaded->idSet ) ); loadedID != INVALID_ENTITY_ID; loadedID = idSet_GetNextValidID( &( loaded->idSet ), loadedID ) ) {
+		++numLoaded;
+
+		BenchBodyData* origBody = NULL;
+		BenchBodyData* loadedBody = NULL;
+		BenchLinkData* origLink = NULL;
+		BenchLinkData* loadedLink = NULL;
+		ecps_GetComponentFromEntityByID( loaded, loadedID, loadedBodyID, &loadedBody );
+		if( ( loadedBody == NULL ) || ( loadedBody->flags >= sb_Count( sbOrigIDs ) ) ) {
+			++mismatches;
+			continue;
+		}
+
+		EntityID origID = sbOrigIDs[loadedBody->flags];
+		ecps_GetComponentFromEntityByID( original, origID, origBodyID, &origBody );
+		ecps_GetComponentFromEntityByID( original, origID, origLinkID, &origLink );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, loadedLinkID, &loadedLink );
+
+		if( ( origBody == NULL ) || !sameBody( origBody, loadedBody ) ) {
+			++mismatches;
+		} else if( ( origLink == NULL ) != ( loadedLink == NULL ) ) {
+			++mismatches;
+		} else if( origLink != NULL ) {
+			BenchBodyData* origTarget = NULL;
+			BenchBodyData* loadedTarget = NULL;
+			ecps_GetComponentFromEntityByID( original, origLink->target, origBodyID, &origTarget );
+			ecps_GetComponentFromEntityByID( loaded, loadedLink->target, loadedBodyID, &loadedTarget );
+			if( ( origTarget == NULL ) || ( loadedTarget == NULL ) || !sameBody( origTarget, loadedTarget ) ||
+				( origLink->strength != loadedLink->strength ) || ( origLink->team != loadedLink->team ) || ( loadedLink->owner != loadedID ) ) {
+				++mismatches;
+			}
+		}
+	}
+
+	if( numLoaded != sb_Count( sbOrigIDs ) ) ++mismatches;
+	return mismatches;
+}
+
+// the general components are a mix of compiled ones and ones that still go through their serialize function, the
+//  sprite's camera flags are the index of the entity in sbOrigIDs
+static void setUpGeneralBenchECPS( ECPS* ecps )
+{
+	SDL_zerop( ecps );
+	ecps_StartInitialization( ecps );
+	gc_Register( ecps );
+	ecps_FinishInitialization( ecps );
+}
+
+static bool getGeneralBenchIndex( ECPS* ecps, EntityID id, uint32_t* outIdx )
+{
+	GCSpriteData* sprite = NULL;
+	if( ( id == INVALID_ENTITY_ID ) || !ecps_GetComponentFromEntityByID( ecps, id, gcSpriteCompID, &sprite ) ) return false;
+	( *outIdx ) = sprite->camFlags;
+	return true;
+}
+
+// both are either invalid or are the same entity in each ECPS
+static bool sameGeneralBenchReference( ECPS* original, EntityID origID, ECPS* loaded, EntityID loadedID )
+{
+	uint32_t origIdx;
+	uint32_t loadedIdx;
+	bool origValid = getGeneralBenchIndex( original, origID, &origIdx );
+	bool loadedValid = getGeneralBenchIndex( loaded, loadedID, &loadedIdx );
+	return ( origValid == loadedValid ) && ( !origValid || ( origIdx == loadedIdx ) );
+}
+
+static bool sameGeneralBenchCollider( const GCColliderData* orig, const GCColliderData* loaded )
+{
+	if( ( orig == NULL ) || ( loaded == NULL ) ) return orig == loaded;
+	if( orig->base.type != loaded->base.type ) return false;
+	if( orig->base.type == CT_CIRCLE ) return orig->circle.radius == loaded->circle.radius;
+	return vec2_Comp( &( orig->aab.halfDim ), &( loaded->aab.halfDim ) );
+}
+
+static int countGeneralBenchMismatches( ECPS* original, const EntityID* sbOrigIDs, ECPS* loaded )
+{
+	int mismatches = 0;
+	size_t numLoaded = 0;
+	for( EntityID loadedID = idSet_GetFirstValidID( &( loaded->idSet ) ); loadedID != INVALID_ENTITY_ID; loadedID = idSet_GetNextValidID( &( loaded->idSet ), loadedID ) ) {
+		++numLoaded;
+
+		uint32_t idx;
+		if( !getGeneralBenchIndex( loaded, loadedID, &idx ) || ( idx >= sb_Count( sbOrigIDs ) ) ) {
+			++mismatches;
+			continue;
+		}
+		EntityID origID = sbOrigIDs[idx];
+
+		GCTransformData* origTf = NULL;
+		GCTransformData* loadedTf = NULL;
+		GCSpriteData* origSprite = NULL;
+		GCSpriteData* loadedSprite = NULL;
+		GCColorData* origClr = NULL;
+		GCColorData* loadedClr = NULL;
+		GCColliderData* origColl = NULL;
+		GCColliderData* loadedColl = NULL;
+		ecps_GetComponentFromEntityByID( original, origID, gcTransformCompID, &origTf );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, gcTransformCompID, &loadedTf );
+		ecps_GetComponentFromEntityByID( original, origID, gcSpriteCompID, &origSprite );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, gcSpriteCompID, &loadedSprite );
+		ecps_GetComponentFromEntityByID( original, origID, gcClrCompID, &origClr );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, gcClrCompID, &loadedClr );
+		ecps_GetComponentFromEntityByID( original, origID, gcColliderCompID, &origColl );
+		ecps_GetComponentFromEntityByID( loaded, loadedID, gcColliderCompID, &loadedColl );
+
+		if( ( origTf == NULL ) || ( loadedTf == NULL ) ||
+			( SDL_memcmp( &( origTf->currState ), &( loadedTf->currState ), sizeof( GCTransformState ) ) != 0 ) ||
+			( SDL_memcmp( &( origTf->futureState ), &( loadedTf->futureState ), sizeof( GCTransformState ) ) != 0 ) ||
+			!sameGeneralBenchReference( original, origTf->parentID, loaded, loadedTf->parentID ) ||
+			!sameGeneralBenchReference( original, origTf->firstChildID, loaded, loadedTf->firstChildID ) ||
+			!sameGeneralBenchReference( original, origTf->nextSiblingID, loaded, loadedTf->nextSiblingID ) ) {
+			++mismatches;
+		} else if( ( origSprite == NULL ) || ( origSprite->img != loadedSprite->img ) || ( origSprite->depth != loadedSprite->depth ) ) {
+			++mismatches;
+		} else if( ( ( origClr == NULL ) != ( loadedClr == NULL ) ) ||
+			( ( origClr != NULL ) && ( SDL_memcmp( origClr, loadedClr, sizeof( GCColorData ) ) != 0 ) ) ) {
+			++mismatches;
+		} else if( !sameGeneralBenchCollider( origColl, loadedColl ) ) {
+			++mismatches;
+		}
+	}
+
+	if( numLoaded != sb_Count( sbOrigIDs ) ) ++mismatches;
+	return mismatches;
+}
+
+// sprites store their images by name, so the images have to exist, they're never drawn so they don't need a texture
+static int benchGeneralComponentsSnapshot( RandomGroup* rg, int numEntities, const char* serializedFileName, const char* snapshotFileName, int* failures )
+{
+	ImageID images[BENCH_NUM_SPRITE_IMAGES];
+	for( int i = 0; i < BENCH_NUM_SPRITE_IMAGES; ++i ) {
+		Texture texture;
+		SDL_zero( texture );
+		texture.width = 1;
+		texture.height = 1;
+		char imgName[32];
+		SDL_snprintf( imgName, sizeof( imgName ), "benchSprite%i", i );
+		images[i] = img_CreateFromTexture( &texture, ST_DEFAULT, imgName );
+	}
+
+	ECPS source;
+	setUpGeneralBenchECPS( &source );
+	EntityID* sbSourceIDs = NULL;
+	for( int i = 0; i < numEntities; ++i ) {
+		GCTransformData tf = gc_CreateTransformPosRot( vec2( rand_GetRangeFloat( rg, -100.0f, 100.0f ), rand_GetRangeFloat( rg, -100.0f, 100.0f ) ),
+			rand_GetRangeFloat( rg, 0.0f, 6.0f ) );
+		GCSpriteData sprite;
+		SDL_zero( sprite );
+		sprite.img = images[rand_GetArrayEntry( rg, BENCH_NUM_SPRITE_IMAGES )];
+		sprite.depth = (int8_t)rand_GetRangeS32( rg, -10, 10 );
+		sprite.camFlags = (uint32_t)i;
+		EntityID id = ecps_CreateEntity( &source, 2, gcTransformCompID, &tf, gcSpriteCompID, &sprite );
+		sb_Push( sbSourceIDs, id );
+
+		if( ( i % 3 ) == 0 ) {
+			GCColorData clr;
+			clr.currClr = clr_byte( (uint8_t)rand_GetRangeS32( rg, 0, 255 ), (uint8_t)rand_GetRangeS32( rg, 0, 255 ), (uint8_t)rand_GetRangeS32( rg, 0, 255 ), 255 );
+			clr.futureClr = clr.currClr;
+			ecps_AddComponentToEntityByID( &source, id, gcClrCompID, &clr );
+		}
+
+		if( ( i % 2 ) == 0 ) {
+			GCColliderData coll;
+			SDL_zero( coll );
+			if( rand_Choice( rg ) ) {
+				coll.circle.base.type = CT_CIRCLE;
+				coll.circle.radius = rand_GetRangeFloat( rg, 1.0f, 10.0f );
+			} else {
+				coll.aab.base.type = CT_AAB;
+				coll.aab.halfDim = vec2( rand_GetRangeFloat( rg, 1.0f, 10.0f ), rand_GetRangeFloat( rg, 1.0f, 10.0f ) );
+			}
+			ecps_AddComponentToEntityByID( &source, id, gcColliderCompID, &coll );
+		}
+
+		// small hierarchies so the transforms reference each other
+		if( ( i % 4 ) != 0 ) {
+			gc_MountEntity( &source, sbSourceIDs[i - ( i % 4 )], id );
+		}
+	}
+
+	int mismatches = 0;
+
+	SerializedECPS serialized;
+	ecps_InitSerialized( &serialized );
+	Uint64 start = SDL_GetPerformanceCounter( );
+	ecps_GenerateSerializedECPS( &source, &serialized );
+	if( !ecps_SaveSerializedECPS( serializedFileName, &serialized ) ) ++( *failures );
+	float serializedSave = serialSecondsSince( start );
+	ecps_CleanSerialized( &serialized );
+
+	ECPS loaded;
+	setUpGeneralBenchECPS( &loaded );
+	ecps_InitSerialized( &serialized );
+	start = SDL_GetPerformanceCounter( );
+	if( ecps_LoadSerializedECPS( serializedFileName, &serialized ) ) {
+		ecps_CreateEntitiesFromSerializedComponents( &loaded, &serialized );
+	} else {
+		++( *failures );
+	}
+	float serializedLoad = serialSecondsSince( start );
+	int serializedMismatches = countGeneralBenchMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += serializedMismatches;
+	ecps_CleanSerialized( &serialized );
+	ecps_CleanUp( &loaded );
+
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_SaveSnapshot( &source, snapshotFileName ) ) ++( *failures );
+	float snapshotSave = serialSecondsSince( start );
+
+	setUpGeneralBenchECPS( &loaded );
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_LoadSnapshot( &loaded, snapshotFileName ) ) ++( *failures );
+	float snapshotLoad = serialSecondsSince( start );
+	int snapshotMismatches = countGeneralBenchMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += snapshotMismatches;
+	ecps_CleanUp( &loaded );
+
+	uint64_t serializedSize = 0;
+	uint64_t snapshotSize = 0;
+	if( !getBenchFileSize( serializedFileName, &serializedSize ) || !getBenchFileSize( snapshotFileName, &snapshotSize ) ) ++( *failures );
+
+	llog( LOG_INFO, "  general components, current format: save %.3f ms, load %.3f ms, %llu bytes, %i entities didn't match", 1000.0f * serializedSave,
+		1000.0f * serializedLoad, (unsigned long long)serializedSize, serializedMismatches );
+	llog( LOG_INFO, "  general components, snapshot: save %.3f ms, load %.3f ms, %llu bytes, %i entities didn't match", 1000.0f * snapshotSave,
+		1000.0f * snapshotLoad, (unsigned long long)snapshotSize, snapshotMismatches );
+
+	remove( serializedFileName );
+	remove( snapshotFileName );
+	sb_Release( sbSourceIDs );
+	ecps_CleanUp( &source );
+	for( int i = 0; i < BENCH_NUM_SPRITE_IMAGES; ++i ) {
+		img_Clean( images[i] );
+	}
+
+	return mismatches;
+}
+
+int bench_ECPSSnapshot( int argc, char** argv )
+{
+	int numEntities = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 50000;
+	const char* outDir = ( argc >= 2 ) ? argv[1] : ".";
+	if( numEntities <= 0 ) numEntities = 50000;
+	if( numEntities > BENCH_MAX_ECPS_ENTITIES ) {
+		llog( LOG_WARN, "An ECPS can't hold %i entities, using %i", numEntities, BENCH_MAX_ECPS_ENTITIES );
+		numEntities = BENCH_MAX_ECPS_ENTITIES;
+	}
+
+	char serializedFileName[512];
+	char snapshotFileName[512];
+	SDL_snprintf( serializedFileName, sizeof( serializedFileName ), "%s/benchECPS.sav", outDir );
+	SDL_snprintf( snapshotFileName, sizeof( snapshotFileName ), "%s/benchECPS.snap", outDir );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0x54a95 );
+
+	llog( LOG_INFO, "ECPS snapshot: %i entities", numEntities );
+
+	// same set up as the serializer benchmark, with each entity's index in its flags
+	ECPS source;
+	setUpBenchECPS( &source, true, false );
+	EntityID* sbSourceIDs = NULL;
+	for( int i = 0; i < numEntities; ++i ) {
+		BenchBodyData body;
+		randomBody( &rg, &body );
+		body.flags = (uint32_t)i;
+		sb_Push( sbSourceIDs, ecps_CreateEntity( &source, 1, benchBodyCompID, &body ) );
+	}
+	for( int i = 0; i < numEntities; i += 2 ) {
+		BenchLinkData link;
+		SDL_zero( link );
+		link.target = sbSourceIDs[rand_GetArrayEntry( &rg, (size_t)numEntities )];
+		link.owner = sbSourceIDs[i];
+		link.strength = rand_GetRangeFloat( &rg, 0.0f, 1.0f );
+		link.team = (int8_t)rand_GetRangeS32( &rg, 0, 4 );
+		ecps_AddComponentToEntityByID( &source, sbSourceIDs[i], benchLinkCompID, &link );
+	}
+
+	int failures = 0;
+	int mismatches = 0;
+
+	// current format, everything goes through cmp
+	SerializedECPS serialized;
+	ecps_InitSerialized( &serialized );
+	Uint64 start = SDL_GetPerformanceCounter( );
+	ecps_GenerateSerializedECPS( &source, &serialized );
+	if( !ecps_SaveSerializedECPS( serializedFileName, &serialized ) ) ++failures;
+	float serializedSave = serialSecondsSince( start );
+	ecps_CleanSerialized( &serialized );
+
+	ECPS loaded;
+	setUpBenchECPS( &loaded, true, false );
+	ecps_InitSerialized( &serialized );
+	start = SDL_GetPerformanceCounter( );
+	if( ecps_LoadSerializedECPS( serializedFileName, &serialized ) ) {
+		ecps_CreateEntitiesFromSerializedComponents( &loaded, &serialized );
+	} else {
+		++failures;
+	}
+	float serializedLoad = serialSecondsSince( start );
+	int serializedMismatches = countSnapshotMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += serializedMismatches;
+	ecps_CleanSerialized( &serialized );
+	ecps_CleanUp( &loaded );
+
+	// snapshots
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_SaveSnapshot( &source, snapshotFileName ) ) ++failures;
+	float snapshotSave = serialSecondsSince( start );
+
+	setUpBenchECPS( &loaded, true, false );
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_LoadSnapshot( &loaded, snapshotFileName ) ) ++failures;
+	float snapshotLoad = serialSecondsSince( start );
+	int snapshotMismatches = countSnapshotMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += snapshotMismatches;
+	ecps_CleanUp( &loaded );
+
+	// when the layout and schemas have changed each component is converted on its own
+	setUpBenchECPS( &loaded, true, true );
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_LoadSnapshot( &loaded, snapshotFileName ) ) ++failures;
+	float changedLoad = serialSecondsSince( start );
+	int changedMismatches = countSnapshotMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += changedMismatches;
+	ecps_CleanUp( &loaded );
+
+	// without schemas the saved fields are read by name through the serialize functions
+	setUpBenchECPS( &loaded, false, false );
+	start = SDL_GetPerformanceCounter( );
+	if( !ecps_LoadSnapshot( &loaded, snapshotFileName ) ) ++failures;
+	float uncompiledLoad = serialSecondsSince( start );
+	int uncompiledMismatches = countSnapshotMismatches( &source, sbSourceIDs, &loaded );
+	mismatches += uncompiledMismatches;
+	ecps_CleanUp( &loaded );
+
+	uint64_t serializedSize = 0;
+	uint64_t snapshotSize = 0;
+	if( !getBenchFileSize( serializedFileName, &serializedSize ) || !getBenchFileSize( snapshotFileName, &snapshotSize ) ) ++failures;
+
+	llog( LOG_INFO, "  current format: save %.3f ms, load %.3f ms, %llu bytes, %i entities didn't match", 1000.0f * serializedSave,
+		1000.0f * serializedLoad, (unsigned long long)serializedSize, serializedMismatches );
+	llog( LOG_INFO, "  snapshot: save %.3f ms, load %.3f ms, %llu bytes, %i entities didn't match", 1000.0f * snapshotSave,
+		1000.0f * snapshotLoad, (unsigned long long)snapshotSize, snapshotMismatches );
+	llog( LOG_INFO, "  snapshot with changed components: load %.3f ms, %i entities didn't match", 1000.0f * changedLoad, changedMismatches );
+	llog( LOG_INFO, "  snapshot without schemas: load %.3f ms, %i entities didn't match", 1000.0f * uncompiledLoad, uncompiledMismatches );
+
+	remove( serializedFileName );
+	remove( snapshotFileName );
+	sb_Release( sbSourceIDs );
+	ecps_CleanUp( &source );
+
+	int numGeneralEntities = MIN( numEntities, BENCH_MAX_GENERAL_ENTITIES );
+	llog( LOG_INFO, "ECPS snapshot with general components: %i entities", numGeneralEntities );
+	mismatches += benchGeneralComponentsSnapshot( &rg, numGeneralEntities, serializedFileName, snapshotFileName, &failures );
+	llog( LOG_INFO, "    %i failures", failures );
+
+	return ( ( failures == 0 ) && ( mismatches == 0 ) ) ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Math/mathUtil.h"
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "System/random.h"
+#include "Utils/spatialHash.h"
+#include "Utils/steering.h"
+
+// how much space each agent gets, keeps the number of neighbors about the same no matter how many agents there are
+#define FLOCK_AREA_PER_AGENT 900.0f
+
+#define FLOCK_DT ( 1.0f / 60.0f )
+
+static float flockSecondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+static int compareIndices( const void* lhs, const void* rhs )
+{
+	uint32_t a = *(const uint32_t*)lhs;
+	uint32_t b = *(const uint32_t*)rhs;
+	return ( a > b ) - ( a < b );
+}
+
+// every point within radius by checking all of them
+static size_t bruteForceQuery( SteeringAgents* agents, Vector2 center, float radius, uint32_t* outIndices, size_t maxResults )
+{
+	float radiusSqrd = radius * radius;
+	size_t found = 0;
+	for( size_t i = 0; ( i < agents->count ) && ( found < maxResults ); ++i ) {
+		float dx = agents->posX[i] - center.x;
+		float dy = agents->posY[i] - center.y;
+		if( ( ( dx * dx ) + ( dy * dy ) ) <= radiusSqrd ) {
+			outIndices[found] = (uint32_t)i;
+			++found;
+		}
+	}
+	return found;
+}
+
+// compares the hash against checking everything, returns the number of queries that didn't match
+static int verifyQueries( SteeringAgents* agents, SpatialHash* hash, float radius, int numQueries, RandomGroup* rg, float* outAvgFound )
+{
+	size_t maxResults = agents->count;
+	uint32_t* hashed = mem_Allocate( sizeof( uint32_t ) * maxResults );
+	uint32_t* brute = mem_Allocate( sizeof( uint32_t ) * maxResults );
+
+	int mismatches = 0;
+	size_t totalFound = 0;
+	for( int q = 0; q < numQueries; ++q ) {
+		// on or near an agent so there's something to find
+		size_t idx = rand_GetArrayEntry( rg, agents->count );
+		Vector2 center = vec2( agents->posX[idx], agents->posY[idx] );
+		if( ( q % 2 ) != 0 ) {
+			center.x += rand_GetToleranceFloat( rg, 0.0f, radius );
+			center.y += rand_GetToleranceFloat( rg, 0.0f, radius );
+		}
+
+		size_t numHashed = spatialHash_Query( hash, center, radius, hashed, NULL, maxResults );
+		size_t numBrute = bruteForceQuery( agents, center, radius, brute, maxResults );
+		totalFound += numBrute;
+
+		qsort( hashed, numHashed, sizeof( uint32_t ), compareIndices );
+		if( ( numHashed != numBrute ) || ( memcmp( hashed, brute, sizeof( uint32_t ) * numBrute ) != 0 ) ) {
+			++mismatches;
+		}
+	}
+
+	mem_Release( hashed );
+	mem_Release( brute );
+
+	( *outAvgFound ) = (float)totalFound / (float)MAX( numQueries, 1 );
+	return mismatches;
+}
+
+int bench_Flocking( int argc, char** argv )
+{
+	int numAgents = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 10000;
+	int numTicks = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 600;
+	if( numAgents <= 0 ) numAgents = 10000;
+	if( numTicks <= 0 ) numTicks = 600;
+
+	FlockSettings settings = { 40.0f, 15.0f, 1.5f, 1.0f, 1.0f, 16 };
+	float maxSpeed = 120.0f;
+	float maxAccel = 240.0f;
+
+	float halfSize = sqrtf( FLOCK_AREA_PER_AGENT * (float)numAgents ) * 0.5f;
+	Vector2 min = vec2( -halfSize, -halfSize );
+	Vector2 max = vec2( halfSize, halfSize );
+
+	llog( LOG_INFO, "Flocking: %i agents in a %.0f by %.0f area, %i ticks at 60Hz, %i job threads", numAgents, halfSize * 2.0f, halfSize * 2.0f, numTicks, jq_GetNumThreads( ) );
+
+	RandomGroup rg;
+	rand_Seed( &rg, 0xf10c );
+
+	SteeringAgents agents;
+	SpatialHash hash;
+	if( !steering_CreateAgents( &agents, (size_t)numAgents ) ) {
+		return 1;
+	}
+	if( !spatialHash_Init( &hash, settings.neighborRadius, (uint32_t)numAgents ) ) {
+		steering_DestroyAgents( &agents );
+		return 1;
+	}
+
+	for( int i = 0; i < numAgents; ++i ) {
+		Vector2 pos = vec2( rand_GetRangeFloat( &rg, min.x, max.x ), rand_GetRangeFloat( &rg, min.y, max.y ) );
+		Vector2 vel;
+		vec2_FromPolar( rand_GetRangeFloat( &rg, 0.0f, M_TWO_PI_F ), maxSpeed, &vel );
+		steering_AddAgent( &agents, pos, vel );
+	}
+
+	float buildTotal = 0.0f;
+	float flockTotal = 0.0f;
+	float integrateTotal = 0.0f;
+	float worstTick = 0.0f;
+	for( int t = 0; t < numTicks; ++t ) {
+		Uint64 start = SDL_GetPerformanceCounter( );
+		spatialHash_Build( &hash, agents.posX, agents.posY, agents.count );
+		float build = flockSecondsSince( start );
+
+		Uint64 flockStart = SDL_GetPerformanceCounter( );
+		steering_ClearDesired( &agents );
+		steering_Flock( &agents, &hash, &settings );
+		steering_BatchSeek( &agents, VEC2_ZERO, 0.05f );
+		float flock = flockSecondsSince( flockStart );
+
+		Uint64 integrateStart = SDL_GetPerformanceCounter( );
+		steering_Integrate( &agents, maxSpeed, maxAccel, FLOCK_DT, &min, &max );
+		float integrate = flockSecondsSince( integrateStart );
+
+		buildTotal += build;
+		flockTotal += flock;
+		integrateTotal += integrate;
+		worstTick = MAX( worstTick, build + flock + integrate );
+	}
+
+	float tickAvg = ( buildTotal + flockTotal + integrateTotal ) / (float)numTicks;
+	llog( LOG_INFO, "  average tick %.3f ms (%.1f%% of a 60Hz frame), worst %.3f ms", 1000.0f * tickAvg, 100.0f * tickAvg / FLOCK_DT, 1000.0f * worstTick );
+	llog( LOG_INFO, "    hash build %.3f ms, flocking %.3f ms, integrate %.3f ms",
+		1000.0f * buildTotal / (float)numTicks, 1000.0f * flockTotal / (float)numTicks, 1000.0f * integrateTotal / (float)numTicks );
+
+	// check the hash finds the same agents as looking at all of them, after the agents have had time to bunch up
+	spatialHash_Build( &hash, agents.posX, agents.posY, agents.count );
+	float avgFound;
+	int mismatches = verifyQueries( &agents, &hash, settings.neighborRadius, 1000, &rg, &avgFound );
+	llog( LOG_INFO, "  %i of 1000 queries didn't match checking every agent, %.1f agents found on average", mismatches, avgFound );
+
+	// how long finding the neighbors would take without the hash, only a sample of the agents is done
+	int numSamples = MIN( numAgents, 500 );
+	uint32_t* neighbors = mem_Allocate( sizeof( uint32_t ) * agents.count );
+	size_t bruteFound = 0;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numSamples; ++i ) {
+		Vector2 pos = vec2( agents.posX[i], agents.posY[i] );
+		bruteFound += bruteForceQuery( &agents, pos, settings.neighborRadius, neighbors, agents.count );
+	}
+	float bruteTick = flockSecondsSince( start ) * ( (float)numAgents / (float)numSamples );
+
+	size_t hashFound = 0;
+	start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < numSamples; ++i ) {
+		Vector2 pos = vec2( agents.posX[i], agents.posY[i] );
+		hashFound += spatialHash_Query( &hash, pos, settings.neighborRadius, neighbors, NULL, agents.count );
+	}
+	float hashTick = flockSecondsSince( start ) * ( (float)numAgents / (float)numSamples );
+	mem_Release( neighbors );
+
+	llog( LOG_INFO, "  neighbor search for every agent: %.3f ms with the hash, %.3f ms checking every agent (%zu vs %zu found in sample)",
+		1000.0f * hashTick, 1000.0f * bruteTick, hashFound, bruteFound );
+
+	spatialHash_Destroy( &hash );
+	steering_DestroyAgents( &agents );
+
+	return ( mismatches == 0 ) ? 0 : 1;
+}
@@ -0,0 +1,366 @@
+#include "benchmarks.h"
+
+#include <SDL3/SDL.h>
+
+#include "UI/text.h"
+#include "UI/glyphAtlas.h"
+#include "Graphics/triRendering.h"
+#include "Math/matrix3.h"
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "Utils/helpers.h"
+
+// mix of ASCII, Latin-1, and a few codepoints outside of that so all the glyph lookup paths get used
+static const char* benchTextLines[] = {
+	"The quick brown fox jumps over the lazy dog. 0123456789 !\"#$%&'()*+,-./:;<=>?@[]^_`{|}~",
+	"Voix ambigu\xC3\xAB d'un c\xC5\x93ur qui au z\xC3\xA9phyr pr\xC3\xA9" "f\xC3\xA8re les jattes de kiwis.",
+	"Fran\xC3\xA7ois, \xC3\xA0 bient\xC3\xB4t \xE2\x80\x94 na\xC3\xAFve caf\xC3\xA9 \xC2\xAB" "d\xC3\xA9j\xC3\xA0 vu\xC2\xBB \xE2\x80\xA6 \xE2\x82\xAC" "5, \xC2\xA3" "3, \xC2\xA5" "7",
+	"Zw\xC3\xB6lf Boxk\xC3\xA4mpfer jagen Viktor quer \xC3\xBC" "ber den gro\xC3\x9F" "en Sylter Deich.",
+};
+
+static const char* benchTextArea =
+	"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna "
+	"aliqua. \xC3\x80 la fa\xC3\xA7on d'un \xC2\xAB r\xC3\xA9sum\xC3\xA9 \xC2\xBB \xE2\x80\x94 "
+	"Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.\n"
+	"Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla pariatur.";
+
+// number of codepoints that will generate glyphs
+static int countGlyphs( const char* utf8Str )
+{
+	int count = 0;
+	for( const char* c = utf8Str; *c != 0; ++c ) {
+		if( ( ( *c & 0xC0 ) != 0x80 ) && ( *c != '\n' ) ) {
+			++count;
+		}
+	}
+	return count;
+}
+
+static float secondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+// Draws a large amount of text each frame through txt_DisplayString() and txt_DisplayTextArea(), only measures the
+//  cost of generating and submitting the triangles, nothing is drawn. Then does the same through the layout cache. Also
+//  measures just the string measuring since that goes through the same decoding and glyph lookups without generating
+//  any triangles.
+int bench_TextRendering( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		return -1;
+	}
+
+	const char* fontFile = argv[0];
+	int pixelSize = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 24;
+	int numFrames = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 500;
+	int stringsPerFrame = ( argc >= 4 ) ? SDL_atoi( argv[3] ) : 200;
+	if( pixelSize < 1 ) pixelSize = 24;
+	if( numFrames < 1 ) numFrames = 1;
+	if( stringsPerFrame < 1 ) stringsPerFrame = 1;
+
+	// Latin-1 and the extra codepoints used in the test strings
+	for( int c = 0xA0; c <= 0xFF; ++c ) {
+		txt_AddCharacterToLoad( c );
+	}
+	txt_AddCharacterToLoad( 0x0153 );
+	txt_AddCharacterToLoad( 0x2014 );
+	txt_AddCharacterToLoad( 0x2026 );
+	txt_AddCharacterToLoad( 0x20AC );
+
+	int fontID = txt_LoadFont( fontFile, pixelSize );
+	if( fontID < 0 ) {
+		llog( LOG_ERROR, "Unable to load font %s", fontFile );
+		return -1;
+	}
+
+	int glyphsPerFrame = 0;
+	for( int i = 0; i < stringsPerFrame; ++i ) {
+		glyphsPerFrame += countGlyphs( benchTextLines[i % ARRAY_SIZE( benchTextLines )] );
+	}
+	glyphsPerFrame += countGlyphs( benchTextArea );
+
+	triRenderer_Clear( );
+
+	// submitting, the triangle buffers are small so they get cleared after every string
+	float totalTime = 0.0f;
+	float minTime = SDL_MAX_SINT32;
+	float maxTime = 0.0f;
+	Matrix3 areaTf = IDENTITY_MATRIX_3;
+	Vector2 areaPos = vec2( 400.0f, 300.0f );
+	mat3_SetPosition( &areaTf, &areaPos );
+	for( int f = 0; f < numFrames; ++f ) {
+		Uint64 frameStart = SDL_GetPerformanceCounter( );
+
+		for( int i = 0; i < stringsPerFrame; ++i ) {
+			const uint8_t* str = (const uint8_t*)benchTextLines[i % ARRAY_SIZE( benchTextLines )];
+			Vector2 pos = vec2( 10.0f, 10.0f + (float)( ( i * pixelSize ) % 600 ) );
+			txt_DisplayString( str, pos, CLR_WHITE, HORIZ_ALIGN_LEFT, VERT_ALIGN_TOP, fontID, 1, 0, (float)pixelSize );
+			triRenderer_Clear( );
+		}
+
+		txt_DisplayTextArea( (const uint8_t*)benchTextArea, &areaTf, vec2( 600.0f, 400.0f ), CLR_WHITE,
+			HORIZ_ALIGN_LEFT, VERT_ALIGN_TOP, fontID, 0, NULL, 1, 0, (float)pixelSize );
+		triRenderer_Clear( );
+
+		float frameTime = secondsSince( frameStart );
+		totalTime += frameTime;
+		minTime = SDL_min( minTime, frameTime );
+		maxTime = SDL_max( maxTime, frameTime );
+	}
+
+	float avgTime = totalTime / (float)numFrames;
+	llog( LOG_INFO, "Submit: %i frames, %i glyphs per frame, per frame avg: %.6f  min: %.6f  max: %.6f, %.0f glyphs per second",
+		numFrames, glyphsPerFrame, avgTime, minTime, maxTime,
+		( totalTime > 0.0f ) ? ( (float)glyphsPerFrame * (float)numFrames / totalTime ) : 0.0f );
+
+	// same strings through the layout cache, the first frame fills the cache
+	txt_ClearLayoutCache( );
+	txt_ResetLayoutCacheStats( );
+	totalTime = 0.0f;
+	minTime = SDL_MAX_SINT32;
+	maxTime = 0.0f;
+	for( int f = 0; f < numFrames; ++f ) {
+		Uint64 frameStart = SDL_GetPerformanceCounter( );
+
+		for( int i = 0; i < stringsPerFrame; ++i ) {
+			const uint8_t* str = (const uint8_t*)benchTextLines[i % ARRAY_SIZE( benchTextLines )];
+			Matrix3 tf = IDENTITY_MATRIX_3;
+			Vector2 pos = vec2( 10.0f, 10.0f + (float)( ( i * pixelSize ) % 600 ) );
+			mat3_SetPosition( &tf, &pos );
+			txt_DisplayCachedString( str, &tf, CLR_WHITE, HORIZ_ALIGN_LEFT, VERT_ALIGN_TOP, fontID, 1, 0, (float)pixelSize );
+			triRenderer_Clear( );
+		}
+
+		txt_DisplayCachedTextArea( (const uint8_t*)benchTextArea, &areaTf, vec2( 600.0f, 400.0f ), CLR_WHITE,
+			HORIZ_ALIGN_LEFT, VERT_ALIGN_TOP, fontID, 1, 0, (float)pixelSize );
+		triRenderer_Clear( );
+
+		float frameTime = secondsSince( frameStart );
+		totalTime += frameTime;
+		minTime = SDL_min( minTime, frameTime );
+		maxTime = SDL_max( maxTime, frameTime );
+	}
+
+	TextLayoutCacheStats cacheStats;
+	txt_GetLayoutCacheStats( &cacheStats );
+	avgTime = totalTime / (float)numFrames;
+	llog( LOG_INFO, "Cached submit: per frame avg: %.6f  min: %.6f  max: %.6f, %.0f glyphs per second  cache hits: %u  misses: %u  layouts: %u  memory: %u",
+		avgTime, minTime, maxTime,
+		( totalTime > 0.0f ) ? ( (float)glyphsPerFrame * (float)numFrames / totalTime ) : 0.0f,
+		cacheStats.hits, cacheStats.misses, cacheStats.numLayouts, (unsigned int)cacheStats.memoryUsed );
+
+	// measuring only
+	Uint64 measureStart = SDL_GetPerformanceCounter( );
+	Vector2 size;
+	float widthSum = 0.0f;
+	int measuredGlyphs = 0;
+	for( int f = 0; f < numFrames; ++f ) {
+		for( int i = 0; i < stringsPerFrame; ++i ) {
+			const char* str = benchTextLines[i % ARRAY_SIZE( benchTextLines )];
+			txt_CalculateStringRenderSize( str, fontID, (float)pixelSize, &size );
+			widthSum += size.w;
+		}
+	}
+	float measureTime = secondsSince( measureStart );
+	measuredGlyphs = ( glyphsPerFrame - countGlyphs( benchTextArea ) ) * numFrames;
+	llog( LOG_INFO, "Measure: %i glyphs in %.6f seconds, %.0f glyphs per second (width sum %.1f)",
+		measuredGlyphs, measureTime, ( measureTime > 0.0f ) ? ( (float)measuredGlyphs / measureTime ) : 0.0f, widthSum );
+
+	txt_UnloadFont( fontID );
+
+	return 0;
+}
+
+// writes out the codepoint as UTF-8, returns the number of bytes written
+static int encodeUTF8( uint32_t codepoint, char* out )
+{
+	if( codepoint < 0x80 ) {
+		out[0] = (char)codepoint;
+		return 1;
+	} else if( codepoint < 0x800 ) {
+		out[0] = (char)( 0xC0 | ( codepoint >> 6 ) );
+		out[1] = (char)( 0x80 | ( codepoint & 0x3F ) );
+		return 2;
+	} else if( codepoint < 0x10000 ) {
+		out[0] = (char)( 0xE0 | ( codepoint >> 12 ) );
+		out[1] = (char)( 0x80 | ( ( codepoint >> 6 ) & 0x3F ) );
+		out[2] = (char)( 0x80 | ( codepoint & 0x3F ) );
+		return 3;
+	}
+	out[0] = (char)( 0xF0 | ( codepoint >> 18 ) );
+	out[1] = (char)( 0x80 | ( ( codepoint >> 12 ) & 0x3F ) );
+	out[2] = (char)( 0x80 | ( ( codepoint >> 6 ) & 0x3F ) );
+	out[3] = (char)( 0x80 | ( codepoint & 0x3F ) );
+	return 4;
+}
+
+#define ATLAS_BENCH_LINES 16
+#define ATLAS_BENCH_LINE_LENGTH 32
+
+// Compares loading a font up front against loading it as a dynamic font, then draws text from a large range of
+//  codepoints through the dynamic font. The text slides through the range a line per frame so new glyphs keep getting
+//  rasterized and old ones evicted, which is what a chat log or a dialog heavy game with a large character set does.
+//  Defaults to the CJK Unified Ideographs block.
+int bench_TextGlyphAtlas( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		return -1;
+	}
+
+	const char* fontFile = argv[0];
+	int pixelSize = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 24;
+	int firstCodepoint = ( argc >= 3 ) ? (int)SDL_strtol( argv[2], NULL, 0 ) : 0x4E00;
+	int numCodepoints = ( argc >= 4 ) ? SDL_atoi( argv[3] ) : 4096;
+	int numFrames = ( argc >= 5 ) ? SDL_atoi( argv[4] ) : 500;
+	if( pixelSize < 1 ) pixelSize = 24;
+	if( firstCodepoint < 0x20 ) firstCodepoint = 0x4E00;
+	if( numCodepoints < ATLAS_BENCH_LINE_LENGTH ) numCodepoints = ATLAS_BENCH_LINE_LENGTH;
+	if( numFrames < 1 ) numFrames = 1;
+
+	// static font with just the default characters, this is the smallest it can be
+	Uint64 loadStart = SDL_GetPerformanceCounter( );
+	int staticFontID = txt_LoadFont( fontFile, pixelSize );
+	float staticLoadTime = secondsSince( loadStart );
+	if( staticFontID < 0 ) {
+		llog( LOG_ERROR, "Unable to load font %s", fontFile );
+		return -1;
+	}
+	txt_UnloadFont( staticFontID );
+
+	loadStart = SDL_GetPerformanceCounter( );
+	int fontID = txt_LoadDynamicFont( fontFile, pixelSize, false );
+	float dynamicLoadTime = secondsSince( loadStart );
+	if( fontID < 0 ) {
+		llog( LOG_ERROR, "Unable to load dynamic font %s", fontFile );
+		return -1;
+	}
+
+	llog( LOG_INFO, "Load: static (default characters) %.6f  dynamic %.6f", staticLoadTime, dynamicLoadTime );
+
+	char lines[ATLAS_BENCH_LINES][( ATLAS_BENCH_LINE_LENGTH * 4 ) + 1];
+
+	triRenderer_Clear( );
+
+	float totalTime = 0.0f;
+	float firstFrameTime = 0.0f;
+	float minTime = SDL_MAX_SINT32;
+	float maxTime = 0.0f;
+	for( int f = 0; f < numFrames; ++f ) {
+		// each frame shows the next line of the range
+		for( int l = 0; l < ATLAS_BENCH_LINES; ++l ) {
+			int lineStart = ( ( f + l ) * ATLAS_BENCH_LINE_LENGTH ) % numCodepoints;
+			int len = 0;
+			for( int c = 0; c < ATLAS_BENCH_LINE_LENGTH; ++c ) {
+				len += encodeUTF8( (uint32_t)( firstCodepoint + ( ( lineStart + c ) % numCodepoints ) ), &( lines[l][len] ) );
+			}
+			lines[l][len] = 0;
+		}
+
+		Uint64 frameStart = SDL_GetPerformanceCounter( );
+
+		for( int l = 0; l < ATLAS_BENCH_LINES; ++l ) {
+			Vector2 pos = vec2( 10.0f, 10.0f + (float)( l * pixelSize ) );
+			txt_DisplayString( (const uint8_t*)lines[l], pos, CLR_WHITE, HORIZ_ALIGN_LEFT, VERT_ALIGN_TOP, fontID, 1, 0, (float)pixelSize );
+			triRenderer_Clear( );
+		}
+		txt_FlushGlyphAtlas( );
+
+		float frameTime = secondsSince( frameStart );
+		if( f == 0 ) {
+			firstFrameTime = frameTime;
+		}
+		totalTime += frameTime;
+		minTime = SDL_min( minTime, frameTime );
+		maxTime = SDL_max( maxTime, frameTime );
+	}
+
+	GlyphAtlasStats atlasStats;
+	glyphAtlas_GetStats( &atlasStats );
+	llog( LOG_INFO, "Draw: %i frames, %i glyphs per frame, first frame: %.6f  per frame avg: %.6f  min: %.6f  max: %.6f",
+		numFrames, ATLAS_BENCH_LINES * ATLAS_BENCH_LINE_LENGTH, firstFrameTime, totalTime / (float)numFrames, minTime, maxTime );
+	llog( LOG_INFO, "Atlas: pages: %u (%u KB)  glyphs: %u  added: %u  evicted: %u  failed: %u  uploads: %u (%u KB)",
+		atlasStats.numPages, ( atlasStats.numPages * GLYPH_ATLAS_PAGE_SIZE * GLYPH_ATLAS_PAGE_SIZE ) / 1024,
+		atlasStats.numEntries, atlasStats.additions, atlasStats.evictions, atlasStats.failedAdditions,
+		atlasStats.uploads, (unsigned int)( atlasStats.bytesUploaded / 1024 ) );
+
+	txt_UnloadFont( fontID );
+
+	return 0;
+}
+
+// Times generating the image for an sdf font with different numbers of workers, and checks that every worker count
+//  produces exactly the same image as doing everything on one thread. Nothing is loaded or saved.
+int bench_SDFFontGeneration( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		return -1;
+	}
+
+	const char* fontFile = argv[0];
+	int maxWorkers = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : jq_GetNumThreads( );
+	int repeats = ( argc >= 3 ) ? SDL_atoi( argv[2] ) : 3;
+	if( maxWorkers < 1 ) maxWorkers = 1;
+	if( repeats < 1 ) repeats = 1;
+
+	txt_Init( );
+	// Latin-1 as well so there's a reasonable amount of work
+	for( int c = 0xA0; c <= 0xFF; ++c ) {
+		txt_AddCharacterToLoad( c );
+	}
+
+	llog( LOG_INFO, "Job queue threads: %i", jq_GetNumThreads( ) );
+
+	int width = 0;
+	int height = 0;
+	uint8_t* serialImage = txt_GenerateSDFFontImage( fontFile, 1, &width, &height );
+	if( serialImage == NULL ) {
+		llog( LOG_ERROR, "Unable to generate sdf font image for %s", fontFile );
+		return -1;
+	}
+	size_t imageSize = (size_t)width * (size_t)height;
+	uint64_t serialHash = fnv1aHash( FNV1A_START, serialImage, imageSize );
+
+	int result = 0;
+	float serialTime = 0.0f;
+	// powers of two up to the max, and the max itself
+	for( int workers = 1; ; workers = SDL_min( workers * 2, maxWorkers ) ) {
+		float bestTime = SDL_MAX_SINT32;
+		bool identical = true;
+		for( int r = 0; r < repeats; ++r ) {
+			Uint64 start = SDL_GetPerformanceCounter( );
+			uint8_t* image = txt_GenerateSDFFontImage( fontFile, workers, NULL, NULL );
+			float time = secondsSince( start );
+
+			if( image == NULL ) {
+				llog( LOG_ERROR, "Unable to generate sdf font image with %i workers", workers );
+				mem_Release( serialImage );
+				return -1;
+			}
+
+			identical = identical && ( SDL_memcmp( image, serialImage, imageSize ) == 0 );
+			bestTime = SDL_min( bestTime, time );
+			mem_Release( image );
+		}
+
+		if( workers == 1 ) {
+			serialTime = bestTime;
+		}
+
+		llog( LOG_INFO, "Workers: %i  best: %.6f  speed up: %.2fx  matches serial: %s",
+			workers, bestTime, ( bestTime > 0.0f ) ? ( serialTime / bestTime ) : 0.0f, identical ? "yes" : "NO" );
+		if( !identical ) {
+			result = -1;
+		}
+
+		if( workers == maxWorkers ) {
+			break;
+		}
+	}
+
+	llog( LOG_INFO, "Image: %ix%i  hash: %016llx", width, height, (unsigned long long)serialHash );
+	mem_Release( serialImage );
+
+	return result;
+}
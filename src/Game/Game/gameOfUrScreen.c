@@ -28,6 +28,8 @@
 
 #include "DefaultECPS/defaultECPS.h"
 
+#include "benchmarks.h"
+
 #define BUTTON_GROUP_ID 1
 #define LABEL_GROUP_ID 2
 
@@ -96,7 +98,10 @@ typedef union {
 
 #define MCTS_MOVE Move
 #define MCTS_BOARD_STATE BoardState
-#define MCTS_MAX_STEPS 10000
+#define AI_SEARCH_STEPS 10000
+#define MCTS_MAX_STEPS AI_SEARCH_STEPS
+#define AI_TREE_NODES ( AI_SEARCH_STEPS * 8 )
+#define MCTS_MAX_NODES AI_TREE_NODES
 
 static BoardState initialBoardState( void )
 {
@@ -160,7 +165,9 @@ static int8_t movePiece( uint8_t player, int8_t currPos, int8_t amt )
 static int8_t rollDice( void )
 {
 	// four tetrahedrons each with two colored tips, count up the number of colored tips shown to get the number rolled
-	int8_t total = ( rand_GetU16( NULL ) % 2 ) + ( rand_GetU16( NULL ) % 2 ) + ( rand_GetU16( NULL ) % 2 ) + ( rand_GetU16( NULL ) % 2 );
+	//  this is called from the search workers as well, so use their random group
+	RandomGroup* rg = mcts_GetRandom( );
+	int8_t total = ( rand_GetU16( rg ) % 2 ) + ( rand_GetU16( rg ) % 2 ) + ( rand_GetU16( rg ) % 2 ) + ( rand_GetU16( rg ) % 2 );
 	return total;
 }
 
@@ -213,6 +220,7 @@ int ur_getCurrentPlayer( BoardState* state )
 void getRollMoveList( BoardState* state, Move** sbMoveList_Out )
 {
 	Move rollMove;
+	memset( &rollMove, 0, sizeof( rollMove ) );
 	rollMove.type = MT_ROLL;
 	rollMove.roll.player = state->currPlayer;
 
@@ -257,6 +265,7 @@ void getPieceMoveList( BoardState* state, Move** sbMoveList_Out )
 
 			if( !isPastEnd && !isOverOwn && !isOverOtherSafe && !( isInPen && addedInitialMove ) ) {
 				Move m;
+				memset( &m, 0, sizeof( m ) );
 				m.type = MT_PIECE;
 				m.piece.piece = i;
 				m.piece.player = player;
@@ -272,6 +281,7 @@ void getPieceMoveList( BoardState* state, Move** sbMoveList_Out )
 	if( sb_Count( *sbMoveList_Out ) <= 0 ) {
 		// no valid moves, add a skip action
 		Move m;
+		memset( &m, 0, sizeof( m ) );
 		m.type = MT_SKIP;
 		m.skip.player = player;
 		sb_Push( ( *sbMoveList_Out ), m );
@@ -745,7 +755,8 @@ static void aiChooseMove_Enter( void )
 	createRollLabel( );
 
 	float searchConstant = MCTS_DEFAULT_SEARCH_CONSTANT;
-	startMCTSThread( urDefinition, searchConstant, &currBoardState );
+	MCTSParallelSettings settings = { MCTS_PARALLEL_TREE, 0, AI_SEARCH_STEPS, 0.0f };
+	startParallelMCTSThread( urDefinition, searchConstant, &currBoardState, settings );
 }
 
 static void aiChooseMove_Exit( void )
@@ -857,4 +868,261 @@ static void animate_PhysicsTick( float dt )
 static void animate_Render( float t )
 {
 
-}
\ No newline at end of file
+}
+
+
+//****************************************************
+// benchmark, measures the parallel searches against each other with the same amount of time to think
+
+static float urBenchSecondsSince( Uint64 start )
+{
+	return (float)( SDL_GetPerformanceCounter( ) - start ) / (float)SDL_GetPerformanceFrequency( );
+}
+
+// plays the game out with each player using their own settings, returns the winner
+static int urBenchPlayGame( const MCTSParallelSettings* playerSettings[2], int* outRollOuts, float* outSearchSeconds )
+{
+	BoardState state = initialBoardState( );
+	Move* sbMoves = NULL;
+	int winner = ur_getWinner( &state );
+	int turns = 0;
+	while( ( winner < 0 ) && ( turns < 2000 ) ) {
+		sb_Clear( sbMoves );
+		ur_getPossibleMoveList( &state, &sbMoves );
+		Move move = sbMoves[0];
+
+		// only think when there's a choice to make
+		if( sb_Count( sbMoves ) > 1 ) {
+			Uint64 start = SDL_GetPerformanceCounter( );
+			int rollOuts = parallelMonteCarloTreeSearch( urDefinition, MCTS_DEFAULT_SEARCH_CONSTANT, &state, playerSettings[state.currPlayer], &move );
+			outSearchSeconds[state.currPlayer] += urBenchSecondsSince( start );
+			outRollOuts[state.currPlayer] += MAX( rollOuts, 0 );
+		}
+
+		BoardState nextState;
+		ur_applyMove( &state, &move, &nextState );
+		state = nextState;
+		winner = ur_getWinner( &state );
+		++turns;
+	}
+	sb_Release( sbMoves );
+
+	return winner;
+}
+
+// random positions from the middle of games where a piece has to be chosen
+static void urBenchCreatePositions( BoardState* positions, int count )
+{
+	Move* sbMoves = NULL;
+	for( int i = 0; i < count; ++i ) {
+		BoardState state;
+		do {
+			state = initialBoardState( );
+			int numMoves = 20 + (int)rand_GetArrayEntry( &mctsRandom, 60 );
+			for( int m = 0; ( m < numMoves ) || ( state.roll <= 0 ); ++m ) {
+				sb_Clear( sbMoves );
+				ur_getPossibleMoveList( &state, &sbMoves );
+				BoardState nextState;
+				ur_applyMove( &state, &( sbMoves[rand_GetArrayEntry( &mctsRandom, sb_Count( sbMoves ) )] ), &nextState );
+				state = nextState;
+				if( ur_getWinner( &state ) >= 0 ) break;
+			}
+		} while( ur_getWinner( &state ) >= 0 );
+		positions[i] = state;
+	}
+	sb_Release( sbMoves );
+}
+
+int bench_GameOfUrMCTS( int argc, char** argv )
+{
+	float secondsPerMove = ( argc >= 1 ) ? (float)SDL_atof( argv[0] ) : 0.02f;
+	int numGames = ( argc >= 2 ) ? SDL_atoi( argv[1] ) : 20;
+	if( secondsPerMove <= 0.0f ) secondsPerMove = 0.02f;
+	if( numGames < 2 ) numGames = 20;
+
+	rand_Seed( &mctsRandom, 0x0b0a7d );
+	llog( LOG_INFO, "Game of Ur MCTS: %.3f seconds per move, %i games, %i job threads", secondsPerMove, numGames, jq_GetNumThreads( ) );
+
+	MCTSParallelSettings single = { MCTS_PARALLEL_TREE, 1, 0, secondsPerMove };
+	MCTSParallelSettings root = { MCTS_PARALLEL_ROOT, 0, 0, secondsPerMove };
+	MCTSParallelSettings tree = { MCTS_PARALLEL_TREE, 0, 0, secondsPerMove };
+	const MCTSParallelSettings* parallelSettings[] = { &root, &tree };
+	const char* parallelNames[] = { "root parallel", "tree parallel" };
+
+	// play outs per second from the same positions
+#define NUM_BENCH_POSITIONS 16
+	BoardState positions[NUM_BENCH_POSITIONS];
+	urBenchCreatePositions( positions, NUM_BENCH_POSITIONS );
+
+	Move move;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	for( int i = 0; i < NUM_BENCH_POSITIONS; ++i ) {
+		monteCarloTreeSearch( urDefinition, MCTS_DEFAULT_SEARCH_CONSTANT, &( positions[i] ), &move );
+	}
+	float elapsed = urBenchSecondsSince( start );
+	llog( LOG_INFO, "  single threaded, fixed steps: %.0f play outs per second", (float)( AI_SEARCH_STEPS * NUM_BENCH_POSITIONS ) / elapsed );
+
+	const MCTSParallelSettings* rateSettings[] = { &single, &root, &tree };
+	const char* rateNames[] = { "one worker", "root parallel", "tree parallel" };
+	for( int s = 0; s < (int)ARRAY_SIZE( rateSettings ); ++s ) {
+		int totalRollOuts = 0;
+		start = SDL_GetPerformanceCounter( );
+		for( int i = 0; i < NUM_BENCH_POSITIONS; ++i ) {
+			totalRollOuts += MAX( parallelMonteCarloTreeSearch( urDefinition, MCTS_DEFAULT_SEARCH_CONSTANT, &( positions[i] ), rateSettings[s], &move ), 0 );
+		}
+		elapsed = urBenchSecondsSince( start );
+		llog( LOG_INFO, "  %s: %.0f play outs per second", rateNames[s], (float)totalRollOuts / elapsed );
+	}
+#undef NUM_BENCH_POSITIONS
+
+	// win rate against a single worker with the same time to think, swapping who goes first each game
+	for( int s = 0; s < (int)ARRAY_SIZE( parallelSettings ); ++s ) {
+		int wins = 0;
+		int ties = 0;
+		int rollOuts[2] = { 0, 0 };
+		float searchSeconds[2] = { 0.0f, 0.0f };
+		for( int g = 0; g < numGames; ++g ) {
+			int parallelPlayer = g % 2;
+			const MCTSParallelSettings* playerSettings[2];
+			playerSettings[parallelPlayer] = parallelSettings[s];
+			playerSettings[1 - parallelPlayer] = &single;
+
+			int gameRollOuts[2] = { 0, 0 };
+			float gameSeconds[2] = { 0.0f, 0.0f };
+			int winner = urBenchPlayGame( playerSettings, gameRollOuts, gameSeconds );
+			if( winner == parallelPlayer ) {
+				++wins;
+			} else if( winner != ( 1 - parallelPlayer ) ) {
+				++ties;
+			}
+
+			rollOuts[0] += gameRollOuts[parallelPlayer];
+			rollOuts[1] += gameRollOuts[1 - parallelPlayer];
+			searchSeconds[0] += gameSeconds[parallelPlayer];
+			searchSeconds[1] += gameSeconds[1 - parallelPlayer];
+		}
+
+		llog( LOG_INFO, "  %s vs one worker: won %i of %i (%.1f%%), %i ties, %.0f vs %.0f play outs per second", parallelNames[s],
+			wins, numGames, 100.0f * (float)wins / (float)numGames, ties,
+			(float)rollOuts[0] / MAX( searchSeconds[0], 0.0001f ), (float)rollOuts[1] / MAX( searchSeconds[1], 0.0001f ) );
+	}
+
+	return 0;
+}
+
+//****************************************************
+// benchmark, how long each move takes to choose when the tree is kept between moves compared to starting over
+
+typedef struct {
+	float totalSeconds;
+	float worstSeconds;
+	int numDecisions;
+	float reusedVisits;
+} UrLatencyStats;
+
+static void urBenchAddLatency( UrLatencyStats* stats, float seconds )
+{
+	stats->totalSeconds += seconds;
+	stats->worstSeconds = MAX( stats->worstSeconds, seconds );
+	++stats->numDecisions;
+}
+
+// one player keeps its tree for the whole game, the other starts over every move, if maxSeconds is > 0 the player
+//  keeping its tree searches for that long, otherwise until its root has been visited as many times as a full search
+static int urBenchPlayReuseGame( MCTree* tree, int reusePlayer, float maxSeconds, UrLatencyStats* reuseStats, UrLatencyStats* freshStats )
+{
+	BoardState state = initialBoardState( );
+	mcts_Reset( tree, &state );
+
+	Move* sbMoves = NULL;
+	int winner = ur_getWinner( &state );
+	int turns = 0;
+	while( ( winner < 0 ) && ( turns < 2000 ) ) {
+		sb_Clear( sbMoves );
+		ur_getPossibleMoveList( &state, &sbMoves );
+		Move move = sbMoves[0];
+
+		if( sb_Count( sbMoves ) > 1 ) {
+			Uint64 start = SDL_GetPerformanceCounter( );
+			if( state.currPlayer == reusePlayer ) {
+				float visits = mcts_GetRootVisits( tree );
+				reuseStats->reusedVisits += visits;
+				if( maxSeconds > 0.0f ) {
+					mcts_Search( tree, 0, maxSeconds );
+				} else if( visits < (float)AI_SEARCH_STEPS ) {
+					mcts_Search( tree, AI_SEARCH_STEPS - (int)visits, 0.0f );
+				}
+				if( !mcts_GetBestMove( tree, &move ) ) {
+					move = sbMoves[0];
+				}
+				urBenchAddLatency( reuseStats, urBenchSecondsSince( start ) );
+			} else {
+				monteCarloTreeSearch( urDefinition, MCTS_DEFAULT_SEARCH_CONSTANT, &state, &move );
+				urBenchAddLatency( freshStats, urBenchSecondsSince( start ) );
+			}
+		}
+
+		// the tree has to follow every move made, including the rolls and the other player's moves
+		BoardState nextState;
+		ur_applyMove( &state, &move, &nextState );
+		state = nextState;
+		mcts_AdvanceRoot( tree, &move, &state );
+		winner = ur_getWinner( &state );
+		++turns;
+	}
+	sb_Release( sbMoves );
+
+	return winner;
+}
+
+static void urBenchLogLatency( const char* name, UrLatencyStats* stats )
+{
+	int count = MAX( stats->numDecisions, 1 );
+	llog( LOG_INFO, "    %s: average %.2f ms, worst %.2f ms, %.0f visits reused per move", name,
+		1000.0f * stats->totalSeconds / (float)count, 1000.0f * stats->worstSeconds, stats->reusedVisits / (float)count );
+}
+
+int bench_GameOfUrLatency( int argc, char** argv )
+{
+	int numGames = ( argc >= 1 ) ? SDL_atoi( argv[0] ) : 10;
+	float maxSeconds = ( argc >= 2 ) ? (float)SDL_atof( argv[1] ) : 0.05f;
+	if( numGames < 2 ) numGames = 10;
+	if( maxSeconds <= 0.0f ) maxSeconds = 0.05f;
+
+	rand_Seed( &mctsRandom, 0x0b0a7d );
+	llog( LOG_INFO, "Game of Ur MCTS latency: %i games, %.3f second deadline, %i steps per full search", numGames, maxSeconds, AI_SEARCH_STEPS );
+
+	MCTree tree;
+	BoardState state = initialBoardState( );
+	if( !mcts_Create( &tree, &urDefinition, MCTS_DEFAULT_SEARCH_CONSTANT, AI_TREE_NODES, &state ) ) {
+		llog( LOG_ERROR, "Unable to create search tree for benchmark." );
+		return 1;
+	}
+
+	const float deadlines[] = { 0.0f, maxSeconds };
+	const char* names[] = { "reuse, full search", "reuse, deadline" };
+	for( int d = 0; d < (int)ARRAY_SIZE( deadlines ); ++d ) {
+		UrLatencyStats reuseStats = { 0 };
+		UrLatencyStats freshStats = { 0 };
+		int wins = 0;
+		int ties = 0;
+		for( int g = 0; g < numGames; ++g ) {
+			int reusePlayer = g % 2;
+			int winner = urBenchPlayReuseGame( &tree, reusePlayer, deadlines[d], &reuseStats, &freshStats );
+			if( winner == reusePlayer ) {
+				++wins;
+			} else if( winner != ( 1 - reusePlayer ) ) {
+				++ties;
+			}
+		}
+
+		llog( LOG_INFO, "  %s vs fresh full search: won %i of %i (%.1f%%), %i ties", names[d],
+			wins, numGames, 100.0f * (float)wins / (float)numGames, ties );
+		urBenchLogLatency( "fresh", &freshStats );
+		urBenchLogLatency( names[d], &reuseStats );
+	}
+
+	mcts_Destroy( &tree );
+
+	return 0;
+}
@@ -9,7 +9,6 @@
 #include "System/platformLog.h"
 
 #include "Utils/hexGrid.h"
-#include "Utils/stretchyBuffer.h"
 
 // just draw a 7x7 rectangular grid of hexes
 
@@ -173,32 +172,29 @@ static void hexTestScreen_Render( float t )
 		HexGridCoord c = hex_Pointy_PositionToGrid( POINTY_SIZE, mousePos );
 		if( hex_CoordInRect( c, GRID_WIDTH, GRID_HEIGHT ) ) {
 
-			HexGridCoord* sbList = NULL;
-			if( radiusSize > 0 ) hex_Ring( c, radiusSize, &sbList );
-			//hex_AllInRange( c, radiusSize, &sbList );
-
-			for( size_t i = 0; i < sb_Count( sbList ); ++i ) {
-				if( hex_CoordInRect( sbList[i], GRID_WIDTH, GRID_HEIGHT ) ) {
-					Vector2 pos = hex_Pointy_GridToPosition( POINTY_SIZE, sbList[i] );
-					vec2_Add( &pos, &basePos, &pos );
-					img_Render_Pos( hexHiliteImg, 1, 1, &pos );
+			if( radiusSize > 0 ) {
+				HexRingIter ringIter;
+				HexGridCoord ringCoord;
+				for( hex_RingIterInit( &ringIter, c, radiusSize ); hex_RingIterNext( &ringIter, &ringCoord ); ) {
+					if( hex_CoordInRect( ringCoord, GRID_WIDTH, GRID_HEIGHT ) ) {
+						Vector2 pos = hex_Pointy_GridToPosition( POINTY_SIZE, ringCoord );
+						vec2_Add( &pos, &basePos, &pos );
+						img_Render_Pos( hexHiliteImg, 1, 1, &pos );
+					}
 				}
 			}
-
-			sb_Release( sbList );
 		}
 	}
 
-	HexGridCoord* sbLine = NULL;
-	hex_AllInLine( lineStart, lineEnd, &sbLine );
-	for( size_t i = 0; i < sb_Count( sbLine ); ++i ) {
-		if( hex_CoordInRect( sbLine[i], GRID_WIDTH, GRID_HEIGHT ) ) {
-			Vector2 pos = hex_Pointy_GridToPosition( POINTY_SIZE, sbLine[i] );
+	HexLineIter lineIter;
+	HexGridCoord lineCoord;
+	for( hex_LineIterInit( &lineIter, lineStart, lineEnd ); hex_LineIterNext( &lineIter, &lineCoord ); ) {
+		if( hex_CoordInRect( lineCoord, GRID_WIDTH, GRID_HEIGHT ) ) {
+			Vector2 pos = hex_Pointy_GridToPosition( POINTY_SIZE, lineCoord );
 			vec2_Add( &pos, &basePos, &pos );
 			img_Render_Pos( hexHiliteImg, 1, 1, &pos );
 		}
 	}
-	sb_Release( sbLine );
 }
 
 GameState hexTestScreenState = { hexTestScreen_Enter, hexTestScreen_Exit, hexTestScreen_ProcessEvents,
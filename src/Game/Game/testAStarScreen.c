@@ -45,6 +45,7 @@ static int startIdx;
 static int exitIdx;
 
 static int* sbPath;
+static AStarContext searchContext;
 
 static int mapCoordToIdx( int xc, int yc )
 {
@@ -196,12 +197,8 @@ static void searchForPath( void )
 {
 	sb_Clear( sbPath );
 
-	AStarSearchState state;
-
-	aStar_CreateSearchState( NULL, MAP_WIDTH * MAP_HEIGHT, startIdx, exitIdx,
-		moveCost, heuristic, nextNeighbor, &state );
-	aStar_ProcessPath( &state, -1, &sbPath );
-	aStar_CleanUpSearchState( &state );
+	aStar_FindPath( &searchContext, NULL, MAP_WIDTH * MAP_HEIGHT, startIdx, exitIdx,
+		moveCost, heuristic, nextNeighbor, &sbPath );
 }
 
 static void setCurrentStart( void )
@@ -324,6 +321,7 @@ static void testAStarScreen_Enter( void )
 	input_BindOnKeyPress( SDLK_S, resetAndSearch );
 
 	sbPath = NULL;
+	aStar_InitContext( &searchContext );
 
 	searchForPath( );
 }
@@ -338,6 +336,7 @@ static void testAStarScreen_Exit( void )
 	input_ClearAllKeyBinds( );
 
 	sb_Release( sbPath );
+	aStar_CleanUpContext( &searchContext );
 }
 
 static void testAStarScreen_ProcessEvents( SDL_Event* e )
@@ -8,6 +8,8 @@
 #include "Utils/stretchyBuffer.h"
 #include "Input/input.h"
 #include "System/random.h"
+#include "Utils/spatialHash.h"
+#include "Utils/steering.h"
 
 #include <math.h>
 #include <SDL3/SDL_assert.h>
@@ -37,6 +39,14 @@ static Vector2 bordersMax;
 
 static Vector2 testTarget = { 0.0f, 0.0f };
 
+#define NUM_FLOCK_AGENTS 1000
+#define FLOCK_MAX_SPEED 120.0f
+#define FLOCK_MAX_ACCEL 240.0f
+
+static SteeringAgents flock;
+static SpatialHash flockHash;
+static FlockSettings flockSettings = { 40.0f, 15.0f, 1.5f, 1.0f, 1.0f, 16 };
+
 static void createVehicle( Vector2 pos, Color clr )
 {
 	SteeringVehicle v;
@@ -82,6 +92,40 @@ static void drawVehicles( )
 	}
 }
 
+static void createFlock( void )
+{
+	if( !steering_CreateAgents( &flock, NUM_FLOCK_AGENTS ) ) return;
+	if( !spatialHash_Init( &flockHash, flockSettings.neighborRadius, NUM_FLOCK_AGENTS ) ) return;
+
+	for( int i = 0; i < NUM_FLOCK_AGENTS; ++i ) {
+		Vector2 pos = vec2( rand_GetRangeFloat( NULL, bordersMin.x, bordersMax.x ), rand_GetRangeFloat( NULL, bordersMin.y, bordersMax.y ) );
+		Vector2 vel;
+		vec2_FromPolar( rand_GetRangeFloat( NULL, 0.0f, M_TWO_PI_F ), FLOCK_MAX_SPEED, &vel );
+		steering_AddAgent( &flock, pos, vel );
+	}
+}
+
+static void drawFlock( void )
+{
+	for( size_t i = 0; i < flock.count; ++i ) {
+		Vector2 pos = vec2( flock.posX[i], flock.posY[i] );
+		Vector2 tail = vec2( flock.posX[i] - ( flock.velX[i] * 0.05f ), flock.posY[i] - ( flock.velY[i] * 0.05f ) );
+		debugRenderer_Line( 1, pos, tail, CLR_CYAN );
+	}
+}
+
+static void flockPhysics( float dt )
+{
+	if( flock.count == 0 ) return;
+
+	spatialHash_Build( &flockHash, flock.posX, flock.posY, flock.count );
+
+	steering_ClearDesired( &flock );
+	steering_Flock( &flock, &flockHash, &flockSettings );
+	steering_BatchSeek( &flock, testTarget, 0.1f );
+	steering_Integrate( &flock, FLOCK_MAX_SPEED, FLOCK_MAX_ACCEL, dt, &bordersMin, &bordersMax );
+}
+
 static void vehiclePhysics( float dt )
 {
 	for( size_t i = 0; i < sb_Count( sbVehicles ); ++i ) {
@@ -107,75 +151,6 @@ static void vehiclePhysics( float dt )
 	}
 }
 
-//************************************
-// Basic Steering Behaviors
-//  For these we just return the desired velocity, the magnitude represents how much of their max speed they will want to use
-void steering_Seek( Vector2* pos, Vector2* target, Vector2* out )
-{
-	ASSERT( pos != NULL );
-	ASSERT( target != NULL );
-	ASSERT( out != NULL );
-
-	vec2_Subtract( target, pos, out );
-	vec2_Normalize( out );
-}
-
-void steering_Flee( Vector2* pos, Vector2* target, Vector2* out )
-{
-	ASSERT( pos != NULL );
-	ASSERT( target != NULL );
-	ASSERT( out != NULL );
-
-	vec2_Subtract( pos, target, out );
-	vec2_Normalize( out );
-}
-
-void steering_Arrive( Vector2* pos, Vector2* target, float innerRadius, float outerRadius, Vector2* out )
-{
-	ASSERT( pos != NULL );
-	ASSERT( target != NULL );
-	ASSERT( out != NULL );
-	ASSERT( innerRadius <= outerRadius );
-
-	vec2_Subtract( target, pos, out );
-	float dist = vec2_Normalize( out );
-
-	float speed = inverseLerp( innerRadius, outerRadius, dist );
-	vec2_Scale( out, speed, out );
-}
-
-void steering_Wandering( Vector2* pos, Vector2* vel, Vector2* currWanderTarget, float radius, float offset, float displacement, Vector2* newWanderTargetOut, Vector2* desiredVelocityOut )
-{
-	ASSERT( pos != NULL );
-	ASSERT( vel != NULL );
-	ASSERT( desiredVelocityOut != NULL );
-	ASSERT( currWanderTarget != NULL );
-	ASSERT( newWanderTargetOut != NULL );
-	ASSERT( radius > 0.0f );
-
-	// we'll use the circle method, we'll need a target that is stored as an offset from the current position
-
-	// find circle center
-	Vector2 circleCenter = ( *vel );
-	vec2_Normalize( &circleCenter );
-	vec2_Scale( &circleCenter, offset, &circleCenter );
-
-	// create displaced target
-	(*newWanderTargetOut) = vec2( rand_GetToleranceFloat( NULL, 0.0f, displacement ), rand_GetToleranceFloat( NULL, 0.0f, displacement ) );
-	vec2_Add( currWanderTarget, newWanderTargetOut, newWanderTargetOut );
-
-	// project displaced target onto circle
-	Vector2 diff;
-	vec2_Subtract( newWanderTargetOut, &circleCenter, &diff );
-	vec2_Normalize( &diff );
-	vec2_AddScaled( &circleCenter, &diff, radius, newWanderTargetOut );
-
-	( *desiredVelocityOut ) = ( *newWanderTargetOut );
-	vec2_Normalize( desiredVelocityOut );
-}
-
-//************************************
-
 static void repositionTarget( void )
 {
 	Vector2 mousePos;
@@ -200,12 +175,15 @@ static void testSteeringScreen_Enter( void )
 	gfx_SetClearColor( CLR_BLACK );
 
 	createVehicle( VEC2_ZERO, CLR_GREEN );
+	createFlock( );
 
 	input_BindOnMouseButtonPress( SDL_BUTTON_LEFT, repositionTarget );
 }
 
 static void testSteeringScreen_Exit( void )
 {
+	steering_DestroyAgents( &flock );
+	spatialHash_Destroy( &flockHash );
 }
 
 static void testSteeringScreen_ProcessEvents( SDL_Event* e )
@@ -219,6 +197,7 @@ static void testSteeringScreen_Process( void )
 static void testSteeringScreen_Draw( void )
 {
 	drawVehicles( );
+	drawFlock( );
 
 	debugRenderer_Circle( 1, testTarget, 5.0f, CLR_RED );
 }
@@ -236,6 +215,7 @@ static void testSteeringScreen_PhysicsTick( float dt )
 	vec2_Scale( &( sbVehicles[0].vel ), sbVehicles[0].maxSpeed, &( sbVehicles[0].vel ) );
 
 	vehiclePhysics( dt );
+	flockPhysics( dt );
 }
 
 GameState testSteeringScreenState = { testSteeringScreen_Enter, testSteeringScreen_Exit, testSteeringScreen_ProcessEvents,
@@ -450,6 +450,34 @@ bool gfxPlatform_CreateTextureFromLoadedImage( TextureFormat texFormat, LoadedIm
     return true;
 } }
 
+bool gfxPlatform_UpdateTextureRegion( TextureFormat texFormat, Texture* texture, int x, int y, int width, int height, const uint8_t* data )
+{ @autoreleasepool {
+    NSUInteger bytesPerPixel = 0;
+    switch( texFormat ) {
+        case TF_RED:
+        case TF_ALPHA:
+            bytesPerPixel = 1;
+            break;
+        case TF_RGBA:
+            bytesPerPixel = 4;
+            break;
+        default:
+            llog( LOG_ERROR, "No valid texture format." );
+            return false;
+    }
+    
+    if( texture->texture.mtlTexture == NULL ) {
+        llog( LOG_ERROR, "Attempting to update an invalid texture." );
+        return false;
+    }
+    
+    id<MTLTexture> mtlTexture = (__bridge id<MTLTexture>)texture->texture.mtlTexture;
+    MTLRegion region = MTLRegionMake2D( (NSUInteger)x, (NSUInteger)y, (NSUInteger)width, (NSUInteger)height );
+    [mtlTexture replaceRegion:region mipmapLevel:0 withBytes:data bytesPerRow:( bytesPerPixel * (NSUInteger)width )];
+    
+    return true;
+} }
+
 bool gfxPlatform_CreateTextureFromSurface( SDL_Surface* surface, Texture* outTexture )
 {
     outTexture->width = surface->w;
@@ -304,6 +304,39 @@ bool gfxPlatform_CreateTextureFromLoadedImage( TextureFormat texFormat, LoadedIm
 	return true;
 }
 
+bool gfxPlatform_UpdateTextureRegion( TextureFormat texFormat, Texture* texture, int x, int y, int width, int height, const uint8_t* data )
+{
+	GLenum glTexFormat = GL_RGBA;
+	switch( texFormat ) {
+		case TF_RED:
+			glTexFormat = GL_RED;
+			break;
+		case TF_GREEN:
+			glTexFormat = GL_GREEN;
+			break;
+		case TF_BLUE:
+			glTexFormat = GL_BLUE;
+			break;
+		case TF_ALPHA:
+			glTexFormat = GL_ALPHA;
+			break;
+		case TF_RGBA:
+			glTexFormat = GL_RGBA;
+			break;
+	}
+
+	if( texture->texture.id == 0 ) {
+		llog( LOG_INFO, "Attempting to update an invalid texture." );
+		return false;
+	}
+
+	// unpack alignment is set to 1 in init so tightly packed single channel rows are fine
+	GL( glBindTexture( GL_TEXTURE_2D, texture->texture.id ) );
+	GL( glTexSubImage2D( GL_TEXTURE_2D, 0, x, y, width, height, glTexFormat, GL_UNSIGNED_BYTE, data ) );
+
+	return true;
+}
+
 bool gfxPlatform_CreateTextureFromSurface( SDL_Surface* surface, Texture* outTexture )
 {
 	// convert the pixels into a texture
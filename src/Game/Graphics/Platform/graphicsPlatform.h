@@ -44,6 +44,10 @@ bool gfxPlatform_CreateTextureFromLoadedImage( TextureFormat texFormat, LoadedIm
 
 bool gfxPlatform_CreateTextureFromSurface( SDL_Surface* surface, Texture* outTexture );
 
+// Replaces the pixels in a region of an existing texture, data is expected to be tightly packed and in the same format
+//  the texture was created with.
+bool gfxPlatform_UpdateTextureRegion( TextureFormat texFormat, Texture* texture, int x, int y, int width, int height, const uint8_t* data );
+
 void gfxPlatform_UnloadTexture( Texture* texture );
 
 int gfxPlatform_ComparePlatformTextures( PlatformTexture rhs, PlatformTexture lhs );
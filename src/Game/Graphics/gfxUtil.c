@@ -241,6 +241,32 @@ clean_up:
 	return returnCode;
 }
 
+// Replaces a region of a texture created with gfxUtil_CreateTextureFromAlphaBitmap( ) with a tightly packed single channel bitmap.
+//  Returns >= 0 on success, < 0 on failure.
+int gfxUtil_UpdateTextureRegionFromAlphaBitmap( Texture* texture, int x, int y, int width, int height, const uint8_t* data )
+{
+	ASSERT( texture != NULL );
+	ASSERT( data != NULL );
+	ASSERT( ( x >= 0 ) && ( y >= 0 ) );
+	ASSERT( ( ( x + width ) <= texture->width ) && ( ( y + height ) <= texture->height ) );
+
+	if( ( width <= 0 ) || ( height <= 0 ) ) {
+		return 0;
+	}
+
+	TextureFormat texFormat;
+#if defined( __IPHONEOS__ ) || defined( __ANDROID__ ) || defined( __EMSCRIPTEN__ )
+	texFormat = TF_ALPHA;
+#else
+	texFormat = TF_RED;
+#endif
+	if( !gfxPlatform_UpdateTextureRegion( texFormat, texture, x, y, width, height, data ) ) {
+		return -1;
+	}
+
+	return 0;
+}
+
 // Returns whether the SDL_Surface has any pixels that have a transparency that aren't completely clear or solid.
 bool gfxUtil_SurfaceIsTranslucent( SDL_Surface* surface )
 {
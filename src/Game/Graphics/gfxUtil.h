@@ -65,6 +65,10 @@ int gfxUtil_CreateTextureFromRGBABitmap( uint8_t* data, int width, int height, T
 //  Returns >= 0 on success, < 0 on failure.
 int gfxUtil_CreateTextureFromAlphaBitmap( uint8_t* data, int width, int height, Texture* outTexture );
 
+// Replaces a region of a texture created with gfxUtil_CreateTextureFromAlphaBitmap( ) with a tightly packed single channel bitmap.
+//  Returns >= 0 on success, < 0 on failure.
+int gfxUtil_UpdateTextureRegionFromAlphaBitmap( Texture* texture, int x, int y, int width, int height, const uint8_t* data );
+
 // Returns whether the SDL_Surface has any pixels that have a transparency that aren't completely clear or solid.
 bool gfxUtil_SurfaceIsTranslucent( SDL_Surface* surface );
 
@@ -5,6 +5,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "images.h"
 #include "gfxUtil.h"
@@ -18,6 +19,7 @@
 
 #include "Others/cmp.h"
 #include "System/serializer.h"
+#include "System/mappedFile.h"
 
 #include <stb_rect_pack.h>
 
@@ -26,6 +28,7 @@ static const char* ioType = "sprite sheet";
 typedef struct {
 	Vector2* sbMins;
 	Vector2* sbMaxes;
+	Vector2* sbOffsets; // only used if the sprites were trimmed
 	char** sbIDs;
 	uint32_t numSpritesRead;
 	char imageFileName[256];
@@ -56,6 +59,7 @@ static void cleanTempSpriteSheetData( TempSpriteSheetData* data )
 {
 	sb_Release( data->sbMins );
 	sb_Release( data->sbMaxes );
+	sb_Release( data->sbOffsets );
 	for( size_t i = 0; i < sb_Count( data->sbIDs ); ++i ) {
 		mem_Release( data->sbIDs[i] );
 	}
@@ -78,7 +82,7 @@ static bool loadSpriteSheetData( const char* fileName, TempSpriteSheetData** out
 
 	uint32_t version;
 	SERIALIZE_CHECK( s.u32( &s, "version", &version ), ioType, "version number", goto clean_up );
-	if( version != 3 ) {
+	if( ( version != 3 ) && ( version != 4 ) ) {
 		llog( LOG_ERROR, "Unknown version for sprite sheet %s", fileName );
 		goto clean_up;
 	}
@@ -89,6 +93,7 @@ static bool loadSpriteSheetData( const char* fileName, TempSpriteSheetData** out
 		TempSpriteSheetData data;
 		data.sbMins = NULL;
 		data.sbMaxes = NULL;
+		data.sbOffsets = NULL;
 		data.sbIDs = NULL;
 				
 		SERIALIZE_CHECK( s.cStrBuffer( &s, "setFileName", data.imageFileName, ARRAY_SIZE( data.imageFileName ) ), ioType, "rect set image file name", goto clean_up );
@@ -104,12 +109,25 @@ static bool loadSpriteSheetData( const char* fileName, TempSpriteSheetData** out
 			SERIALIZE_CHECK( s.s32( &s, "spriteW", &w ), ioType, "sprite width", goto clean_up );
 			SERIALIZE_CHECK( s.s32( &s, "spriteH", &h ), ioType, "sprite height", goto clean_up );
 
+			// version 4 can have the transparent border trimmed off, offset them so they still draw where the untrimmed
+			//  image would have been
+			Vector2 offset = VEC2_ZERO;
+			if( version >= 4 ) {
+				int trimX, trimY, srcW, srcH;
+				SERIALIZE_CHECK( s.s32( &s, "trimX", &trimX ), ioType, "sprite trim x", goto clean_up );
+				SERIALIZE_CHECK( s.s32( &s, "trimY", &trimY ), ioType, "sprite trim y", goto clean_up );
+				SERIALIZE_CHECK( s.s32( &s, "sourceW", &srcW ), ioType, "sprite source width", goto clean_up );
+				SERIALIZE_CHECK( s.s32( &s, "sourceH", &srcH ), ioType, "sprite source height", goto clean_up );
+				offset = vec2( trimX + ( w / 2.0f ) - ( srcW / 2.0f ), trimY + ( h / 2.0f ) - ( srcH / 2.0f ) );
+			}
+
 			// add the mins and maxes for cutting up the sprites
 			Vector2 min = vec2( (float)x, (float)y );
 			Vector2 max = vec2( (float)( x + w ), (float)( y + h ) );
 
 			sb_Push( data.sbMins, min );
 			sb_Push( data.sbMaxes, max );
+			sb_Push( data.sbOffsets, offset );
 			sb_Push( data.sbIDs, id );
 		}
 
@@ -136,6 +154,423 @@ clean_up:
 	return ret;
 }
 
+// Splits the texture up into the sprites and applies the offsets for any that were trimmed. retIDs is optional.
+static int splitSheetTexture( Texture* texture, int count, Vector2* mins, Vector2* maxes, const Vector2* offsets, char** ids,
+	ShaderType shaderType, int packageID, ImageID* retIDs )
+{
+	ImageID* sbTempIDs = NULL;
+	if( retIDs == NULL ) {
+		retIDs = sb_Add( sbTempIDs, count );
+	}
+
+	int newPackageID = img_SplitTexture( texture, count, shaderType, mins, maxes, ids, packageID, retIDs );
+	if( newPackageID >= 0 ) {
+		for( int i = 0; i < count; ++i ) {
+			if( ( offsets[i].x != 0.0f ) || ( offsets[i].y != 0.0f ) ) {
+				img_SetOffset( retIDs[i], offsets[i] );
+			}
+		}
+	}
+
+	sb_Release( sbTempIDs );
+	return newPackageID;
+}
+
+static int splitTempSheetTexture( Texture* texture, TempSpriteSheetData* data, ShaderType shaderType, int packageID, ImageID* retIDs )
+{
+	return splitSheetTexture( texture, (int)data->numSpritesRead, data->sbMins, data->sbMaxes, data->sbOffsets, data->sbIDs, shaderType, packageID, retIDs );
+}
+
+static void addLoadedSpriteSheet( const char* fileName, int packageID )
+{
+	LoadedSpriteSheet loadedSpriteSheet;
+	loadedSpriteSheet.spriteSheetID = createStringCopy( fileName );
+	loadedSpriteSheet.packageID = packageID;
+	loadedSpriteSheet.loadCount = 1;
+	sb_Push( sbLoadedSpriteSheets, loadedSpriteSheet );
+}
+
+//****************************************************************************
+// Binary sprite sheets. Everything needed to create the sprites is stored in flat arrays that can be used straight out
+//  of a memory mapped file: the rects as mins and maxes, the offsets for trimmed sprites, offsets into a block of interned
+//  id strings, and the raw RGBA pixels for each page. Loading one is mapping the file and a texture upload per page.
+//  All values are little endian, every section starts on a BINARY_SHEET_ALIGNMENT boundary. Because nothing is swapped
+//  binary sheets can only be created and loaded on little endian platforms.
+
+#define BINARY_SHEET_MAGIC 0x42535358 // "XSSB"
+#define BINARY_SHEET_VERSION 5
+#define BINARY_SHEET_ALIGNMENT 16
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numPages;
+	uint32_t numSprites;
+	uint64_t fileSize;
+	uint64_t pagesOffset; // BinarySheetPage[numPages]
+	uint64_t minsOffset; // Vector2[numSprites]
+	uint64_t maxesOffset; // Vector2[numSprites]
+	uint64_t offsetsOffset; // Vector2[numSprites]
+	uint64_t idsOffset; // uint32_t[numSprites], offsets into the string block
+	uint64_t stringsOffset;
+	uint64_t stringsSize;
+} BinarySheetHeader;
+
+typedef struct {
+	uint32_t width;
+	uint32_t height;
+	uint32_t firstSprite; // sprites for each page are stored together
+	uint32_t numSprites;
+	uint64_t pixelsOffset; // width * height RGBA pixels
+	uint64_t reserved;
+} BinarySheetPage;
+
+SDL_COMPILE_TIME_ASSERT( binarySheetHeaderSize, sizeof( BinarySheetHeader ) == 80 );
+SDL_COMPILE_TIME_ASSERT( binarySheetPageSize, sizeof( BinarySheetPage ) == 32 );
+SDL_COMPILE_TIME_ASSERT( binarySheetVectorSize, sizeof( Vector2 ) == 8 );
+
+static uint64_t alignBinaryOffset( uint64_t offset )
+{
+	return ( offset + ( BINARY_SHEET_ALIGNMENT - 1 ) ) & ~(uint64_t)( BINARY_SHEET_ALIGNMENT - 1 );
+}
+
+static bool binaryRangeValid( uint64_t offset, uint64_t size, uint64_t fileSize )
+{
+	return ( ( offset % 4 ) == 0 ) && ( offset <= fileSize ) && ( size <= ( fileSize - offset ) );
+}
+
+// makes sure everything the header and page table reference is inside the file, so nothing after this has to check
+static bool validateBinarySheet( const char* fileName, const MappedFile* file )
+{
+	const BinarySheetHeader* header = (const BinarySheetHeader*)file->data;
+	uint64_t fileSize = file->size;
+
+	if( header->version != BINARY_SHEET_VERSION ) {
+		llog( LOG_ERROR, "Unknown version %u for binary sprite sheet %s", header->version, fileName );
+		return false;
+	}
+
+	uint64_t numSprites = header->numSprites;
+	if( ( header->fileSize != fileSize ) ||
+		!binaryRangeValid( header->pagesOffset, header->numPages * sizeof( BinarySheetPage ), fileSize ) ||
+		!binaryRangeValid( header->minsOffset, numSprites * sizeof( Vector2 ), fileSize ) ||
+		!binaryRangeValid( header->maxesOffset, numSprites * sizeof( Vector2 ), fileSize ) ||
+		!binaryRangeValid( header->offsetsOffset, numSprites * sizeof( Vector2 ), fileSize ) ||
+		!binaryRangeValid( header->idsOffset, numSprites * sizeof( uint32_t ), fileSize ) ||
+		!binaryRangeValid( header->stringsOffset, header->stringsSize, fileSize ) ||
+		( header->stringsSize == 0 ) || ( file->data[header->stringsOffset + header->stringsSize - 1] != 0 ) ) {
+		llog( LOG_ERROR, "Binary sprite sheet %s is truncated or corrupt.", fileName );
+		return false;
+	}
+
+	const uint32_t* ids = (const uint32_t*)( file->data + header->idsOffset );
+	for( uint32_t i = 0; i < header->numSprites; ++i ) {
+		if( ids[i] >= header->stringsSize ) {
+			llog( LOG_ERROR, "Binary sprite sheet %s has an invalid sprite id.", fileName );
+			return false;
+		}
+	}
+
+	const BinarySheetPage* pages = (const BinarySheetPage*)( file->data + header->pagesOffset );
+	for( uint32_t i = 0; i < header->numPages; ++i ) {
+		if( ( pages[i].width == 0 ) || ( pages[i].height == 0 ) ||
+			( ( (uint64_t)pages[i].firstSprite + pages[i].numSprites ) > numSprites ) ||
+			!binaryRangeValid( pages[i].pixelsOffset, (uint64_t)pages[i].width * pages[i].height * 4, fileSize ) ) {
+			llog( LOG_ERROR, "Binary sprite sheet %s has an invalid page.", fileName );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Maps the file and checks if it's a binary sprite sheet. Returns false if there was a problem with the file, if it's
+//  valid but not a binary sheet outIsBinary is set to false and the file isn't left open.
+static bool openBinarySpriteSheet( const char* fileName, MappedFile* outFile, bool* outIsBinary )
+{
+	(*outIsBinary) = false;
+
+	if( !mappedFile_Open( fileName, outFile ) ) {
+		llog( LOG_ERROR, "Unable to open sprite sheet %s", fileName );
+		return false;
+	}
+
+	if( ( outFile->size < sizeof( BinarySheetHeader ) ) || ( SDL_Swap32LE( ( (const BinarySheetHeader*)outFile->data )->magic ) != BINARY_SHEET_MAGIC ) ) {
+		mappedFile_Close( outFile );
+		return true;
+	}
+
+#if SDL_BYTEORDER != SDL_LIL_ENDIAN
+	llog( LOG_ERROR, "Binary sprite sheet %s can only be loaded on little endian platforms.", fileName );
+	mappedFile_Close( outFile );
+	return false;
+#endif
+
+	if( !validateBinarySheet( fileName, outFile ) ) {
+		mappedFile_Close( outFile );
+		return false;
+	}
+
+	(*outIsBinary) = true;
+	return true;
+}
+
+// Creates the textures and sprites from a validated binary sprite sheet, has to be called on the main thread.
+//  Returns the package id, or -1 if there was a problem.
+static int createBinarySheetImages( const char* fileName, const uint8_t* data, ShaderType shaderType, ImageID** sbImgOutArray )
+{
+	const BinarySheetHeader* header = (const BinarySheetHeader*)data;
+	const BinarySheetPage* pages = (const BinarySheetPage*)( data + header->pagesOffset );
+	Vector2* mins = (Vector2*)( data + header->minsOffset );
+	Vector2* maxes = (Vector2*)( data + header->maxesOffset );
+	const Vector2* offsets = (const Vector2*)( data + header->offsetsOffset );
+	const uint32_t* ids = (const uint32_t*)( data + header->idsOffset );
+	const char* strings = (const char*)( data + header->stringsOffset );
+
+	int packageID = -1;
+	bool done = false;
+	char** sbIDs = NULL;
+
+	for( uint32_t p = 0; p < header->numPages; ++p ) {
+		const BinarySheetPage* page = &( pages[p] );
+
+		ImageID* outStart = NULL;
+		if( sbImgOutArray != NULL ) {
+			outStart = sb_Add( *sbImgOutArray, page->numSprites );
+		}
+
+		Texture texture;
+		if( gfxUtil_CreateTextureFromRGBABitmap( (uint8_t*)( data + page->pixelsOffset ), (int)page->width, (int)page->height, &texture ) < 0 ) {
+			llog( LOG_ERROR, "Unable to create texture for sprite sheet: %s", fileName );
+			goto clean_up;
+		}
+
+		sb_Clear( sbIDs );
+		char** pageIDs = sb_Add( sbIDs, page->numSprites );
+		for( uint32_t i = 0; i < page->numSprites; ++i ) {
+			pageIDs[i] = (char*)( strings + ids[page->firstSprite + i] );
+		}
+
+		int newPackageID = splitSheetTexture( &texture, (int)page->numSprites, mins + page->firstSprite, maxes + page->firstSprite,
+			offsets + page->firstSprite, sbIDs, shaderType, packageID, outStart );
+		if( newPackageID < 0 ) {
+			llog( LOG_ERROR, "Problem splitting image for sprite sheet: %s", fileName );
+			goto clean_up;
+		}
+		packageID = newPackageID;
+	}
+
+	done = true;
+
+clean_up:
+	sb_Release( sbIDs );
+
+	if( !done ) {
+		if( packageID >= 0 ) {
+			img_CleanPackage( packageID );
+		}
+		if( sbImgOutArray != NULL ) {
+			sb_Release( *sbImgOutArray );
+		}
+		packageID = -1;
+	}
+
+	return packageID;
+}
+
+static bool writeBinaryPadding( SDL_IOStream* ioStream, uint64_t* position, uint64_t target )
+{
+	static const uint8_t zeros[BINARY_SHEET_ALIGNMENT] = { 0 };
+	while( (*position) < target ) {
+		size_t amount = (size_t)MIN( target - (*position), (uint64_t)sizeof( zeros ) );
+		if( SDL_WriteIO( ioStream, zeros, amount ) != amount ) return false;
+		(*position) += amount;
+	}
+	return true;
+}
+
+static bool writeBinarySection( SDL_IOStream* ioStream, uint64_t* position, uint64_t offset, const void* data, size_t size )
+{
+	if( !writeBinaryPadding( ioStream, position, offset ) ) return false;
+	if( ( size > 0 ) && ( SDL_WriteIO( ioStream, data, size ) != size ) ) return false;
+	(*position) += size;
+	return true;
+}
+
+// Converts a sprite sheet in the older format, along with the images it uses, into a single binary sprite sheet.
+bool img_ConvertSpriteSheetToBinary( const char* fileName, const char* outFileName )
+{
+	bool done = false;
+
+	TempSpriteSheetData* sbTempData = NULL;
+	LoadedImage* sbImages = NULL;
+	BinarySheetPage* sbPages = NULL;
+	Vector2* sbMins = NULL;
+	Vector2* sbMaxes = NULL;
+	Vector2* sbOffsets = NULL;
+	uint32_t* sbIDs = NULL;
+	uint32_t* sbUniqueIDs = NULL;
+	char* sbStrings = NULL;
+	char* tempFileName = NULL;
+	SDL_IOStream* ioStream = NULL;
+
+#if SDL_BYTEORDER != SDL_LIL_ENDIAN
+	llog( LOG_ERROR, "Binary sprite sheets can only be created on little endian platforms." );
+	goto clean_up;
+#endif
+
+	MappedFile existing;
+	bool isBinary;
+	if( !openBinarySpriteSheet( fileName, &existing, &isBinary ) ) {
+		goto clean_up;
+	}
+	if( isBinary ) {
+		mappedFile_Close( &existing );
+		llog( LOG_ERROR, "Sprite sheet %s is already in the binary format.", fileName );
+		goto clean_up;
+	}
+
+	if( !loadSpriteSheetData( fileName, &sbTempData ) ) {
+		goto clean_up;
+	}
+
+	LoadedImage* images = sb_Add( sbImages, sb_Count( sbTempData ) );
+	SDL_memset( images, 0, sizeof( LoadedImage ) * sb_Count( sbTempData ) );
+
+	for( size_t p = 0; p < sb_Count( sbTempData ); ++p ) {
+		TempSpriteSheetData* set = &( sbTempData[p] );
+		if( gfxUtil_LoadImage( set->imageFileName, &( sbImages[p] ) ) < 0 ) {
+			llog( LOG_ERROR, "Unable to load image %s for sprite sheet %s", set->imageFileName, fileName );
+			goto clean_up;
+		}
+
+		BinarySheetPage page;
+		SDL_memset( &page, 0, sizeof( page ) );
+		page.width = (uint32_t)sbImages[p].width;
+		page.height = (uint32_t)sbImages[p].height;
+		page.firstSprite = (uint32_t)sb_Count( sbMins );
+		page.numSprites = set->numSpritesRead;
+		sb_Push( sbPages, page );
+
+		for( uint32_t i = 0; i < set->numSpritesRead; ++i ) {
+			sb_Push( sbMins, set->sbMins[i] );
+			sb_Push( sbMaxes, set->sbMaxes[i] );
+			sb_Push( sbOffsets, set->sbOffsets[i] );
+
+			// ids are interned so any that are repeated are only stored once
+			uint32_t idOffset = UINT32_MAX;
+			for( size_t u = 0; ( u < sb_Count( sbUniqueIDs ) ) && ( idOffset == UINT32_MAX ); ++u ) {
+				if( SDL_strcmp( sbStrings + sbUniqueIDs[u], set->sbIDs[i] ) == 0 ) {
+					idOffset = sbUniqueIDs[u];
+				}
+			}
+
+			if( idOffset == UINT32_MAX ) {
+				idOffset = (uint32_t)sb_Count( sbStrings );
+				size_t len = SDL_strlen( set->sbIDs[i] ) + 1;
+				SDL_memcpy( sb_Add( sbStrings, len ), set->sbIDs[i], len );
+				sb_Push( sbUniqueIDs, idOffset );
+			}
+			sb_Push( sbIDs, idOffset );
+		}
+	}
+
+	if( sbStrings == NULL ) {
+		// the string block is never empty so it's always valid to check the terminator at the end of it
+		sb_Push( sbStrings, 0 );
+	}
+
+	// lay out all the sections
+	uint32_t numSprites = (uint32_t)sb_Count( sbMins );
+	BinarySheetHeader header;
+	SDL_memset( &header, 0, sizeof( header ) );
+	header.magic = BINARY_SHEET_MAGIC;
+	header.version = BINARY_SHEET_VERSION;
+	header.numPages = (uint32_t)sb_Count( sbPages );
+	header.numSprites = numSprites;
+	header.pagesOffset = alignBinaryOffset( sizeof( BinarySheetHeader ) );
+	header.minsOffset = alignBinaryOffset( header.pagesOffset + ( sizeof( BinarySheetPage ) * header.numPages ) );
+	header.maxesOffset = alignBinaryOffset( header.minsOffset + ( sizeof( Vector2 ) * numSprites ) );
+	header.offsetsOffset = alignBinaryOffset( header.maxesOffset + ( sizeof( Vector2 ) * numSprites ) );
+	header.idsOffset = alignBinaryOffset( header.offsetsOffset + ( sizeof( Vector2 ) * numSprites ) );
+	header.stringsOffset = alignBinaryOffset( header.idsOffset + ( sizeof( uint32_t ) * numSprites ) );
+	header.stringsSize = sb_Count( sbStrings );
+
+	uint64_t end = header.stringsOffset + header.stringsSize;
+	for( size_t p = 0; p < sb_Count( sbPages ); ++p ) {
+		sbPages[p].pixelsOffset = alignBinaryOffset( end );
+		end = sbPages[p].pixelsOffset + ( (uint64_t)sbPages[p].width * sbPages[p].height * 4 );
+	}
+	header.fileSize = end;
+
+	// write to a temporary file first so converting in place doesn't lose the original if something goes wrong
+	size_t tempFileNameLen = SDL_strlen( outFileName ) + 5;
+	tempFileName = mem_Allocate( tempFileNameLen );
+	if( tempFileName == NULL ) goto clean_up;
+	SDL_snprintf( tempFileName, tempFileNameLen, "%s.tmp", outFileName );
+
+	ioStream = SDL_IOFromFile( tempFileName, "wb" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open file %s: %s", tempFileName, SDL_GetError( ) );
+		goto clean_up;
+	}
+
+	uint64_t position = 0;
+	bool written =
+		writeBinarySection( ioStream, &position, 0, &header, sizeof( header ) ) &&
+		writeBinarySection( ioStream, &position, header.pagesOffset, sbPages, sizeof( BinarySheetPage ) * header.numPages ) &&
+		writeBinarySection( ioStream, &position, header.minsOffset, sbMins, sizeof( Vector2 ) * numSprites ) &&
+		writeBinarySection( ioStream, &position, header.maxesOffset, sbMaxes, sizeof( Vector2 ) * numSprites ) &&
+		writeBinarySection( ioStream, &position, header.offsetsOffset, sbOffsets, sizeof( Vector2 ) * numSprites ) &&
+		writeBinarySection( ioStream, &position, header.idsOffset, sbIDs, sizeof( uint32_t ) * numSprites ) &&
+		writeBinarySection( ioStream, &position, header.stringsOffset, sbStrings, (size_t)header.stringsSize );
+	for( size_t p = 0; ( p < sb_Count( sbPages ) ) && written; ++p ) {
+		written = writeBinarySection( ioStream, &position, sbPages[p].pixelsOffset, sbImages[p].data, (size_t)sbPages[p].width * sbPages[p].height * 4 );
+	}
+
+	bool closed = SDL_CloseIO( ioStream );
+	ioStream = NULL;
+	if( !written || !closed ) {
+		llog( LOG_ERROR, "Error writing binary sprite sheet %s: %s", tempFileName, SDL_GetError( ) );
+		remove( tempFileName );
+		goto clean_up;
+	}
+
+	if( !SDL_RenamePath( tempFileName, outFileName ) ) {
+		llog( LOG_ERROR, "Unable to move %s to %s: %s", tempFileName, outFileName, SDL_GetError( ) );
+		remove( tempFileName );
+		goto clean_up;
+	}
+
+	llog( LOG_INFO, "Converted sprite sheet %s to %s: %u pages, %u sprites, %u bytes.", fileName, outFileName,
+		header.numPages, numSprites, (uint32_t)header.fileSize );
+
+	done = true;
+
+clean_up:
+	if( ioStream != NULL ) SDL_CloseIO( ioStream );
+	mem_Release( tempFileName );
+
+	for( size_t i = 0; i < sb_Count( sbTempData ); ++i ) {
+		cleanTempSpriteSheetData( &( sbTempData[i] ) );
+		if( ( sbImages != NULL ) && ( sbImages[i].data != NULL ) ) {
+			gfxUtil_ReleaseLoadedImage( &( sbImages[i] ) );
+		}
+	}
+	sb_Release( sbTempData );
+	sb_Release( sbImages );
+	sb_Release( sbPages );
+	sb_Release( sbMins );
+	sb_Release( sbMaxes );
+	sb_Release( sbOffsets );
+	sb_Release( sbIDs );
+	sb_Release( sbUniqueIDs );
+	sb_Release( sbStrings );
+
+	return done;
+}
+
+
 // This opens up the sprite sheet file and loads all the images, putting the ids into imgOutArray. The returned array
 //  uses the stretchy buffer file, so you can use that to find the size, but you shouldn't do anything that modifies
 //   the size of it. imgOutArray is optional, if you don't pass it in you'll have to retrieve the images by id.
@@ -153,6 +588,21 @@ int img_LoadSpriteSheet( const char* fileName, ShaderType shaderType, ImageID**
 		return packageID;
 	}
 
+	MappedFile binaryFile;
+	bool isBinary;
+	if( !openBinarySpriteSheet( fileName, &binaryFile, &isBinary ) ) {
+		return -1;
+	}
+
+	if( isBinary ) {
+		packageID = createBinarySheetImages( fileName, binaryFile.data, shaderType, sbImgOutArray );
+		mappedFile_Close( &binaryFile );
+		if( packageID >= 0 ) {
+			addLoadedSpriteSheet( fileName, packageID );
+		}
+		return packageID;
+	}
+
 	if( !loadSpriteSheetData( fileName, &sbTempData ) ) {
 		return -1;
 	}
@@ -170,7 +620,7 @@ int img_LoadSpriteSheet( const char* fileName, ShaderType shaderType, ImageID**
 		}
 
 		int newPackageID = -1;
-		if( ( newPackageID = img_SplitTexture( &texture, sbTempData[i].numSpritesRead, shaderType, sbTempData[i].sbMins, sbTempData[i].sbMaxes, sbTempData[i].sbIDs, packageID, outStart ) ) < 0 ) {
+		if( ( newPackageID = splitTempSheetTexture( &texture, &( sbTempData[i] ), shaderType, packageID, outStart ) ) < 0 ) {
 			llog( LOG_ERROR, "Problem splitting image for sprite sheet definition file: %s", fileName );
 			goto clean_up;
 		} else {
@@ -178,11 +628,7 @@ int img_LoadSpriteSheet( const char* fileName, ShaderType shaderType, ImageID**
 		}
 	}
 
-	LoadedSpriteSheet loadedSpriteSheet;
-	loadedSpriteSheet.spriteSheetID = createStringCopy( fileName );
-	loadedSpriteSheet.packageID = packageID;
-	loadedSpriteSheet.loadCount = 1;
-	sb_Push( sbLoadedSpriteSheets, loadedSpriteSheet );
+	addLoadedSpriteSheet( fileName, packageID );
 
 	done = true;
 
@@ -193,148 +639,601 @@ clean_up:
 		if( sbImgOutArray != NULL ) {
 			sb_Release( *sbImgOutArray );
 		}
-		packageID = -1;
+		packageID = -1;
+	}
+
+	sb_Release( sbTempData );
+
+	return packageID;
+}
+
+// Unloads all the images associated with the package and marks the sprite sheet as unloaded.
+void img_UnloadSpriteSheet( int packageID )
+{
+	size_t idx = SIZE_MAX;
+	for( size_t i = 0; i < sb_Count( sbLoadedSpriteSheets ) && idx == SIZE_MAX; ++i ) {
+		if( sbLoadedSpriteSheets[i].packageID == packageID ) {
+			idx = i;
+		}
+	}
+
+	if( idx == SIZE_MAX ) {
+		llog( LOG_ERROR, "Sending in invalid packageID when unloading a sprite sheet." );
+		return;
+	}
+
+	sbLoadedSpriteSheets[idx].loadCount -= 1;
+	if( sbLoadedSpriteSheets[idx].loadCount <= 0 ) {
+		mem_Release( sbLoadedSpriteSheets[idx].spriteSheetID );
+		sb_Remove( sbLoadedSpriteSheets, idx );
+		img_CleanPackage( packageID );
+	}
+}
+
+//****************************************************************************
+// Building sprite sheets. Sources are read, hashed, decoded and trimmed in parallel on the job queue. Along with the
+//  sprite sheet a manifest is saved with the hash and placement of every source, the next time the sheet is built
+//  anything that hasn't changed size keeps its placement, new and resized images are fit into the free space, and only
+//  the pages that changed are written out again. If that isn't possible everything is repacked, trying a few different
+//  heuristics and keeping the one that needs the fewest and smallest pages.
+
+#define MANIFEST_VERSION 1
+
+// past this many images needing a new spot it's better to just repack everything
+#define MAX_INCREMENTAL_PLACEMENTS 64
+
+typedef struct {
+	char* path;
+	uint64_t hash;
+	int srcWidth;
+	int srcHeight;
+	int trimX;
+	int trimY;
+	int trimWidth;
+	int trimHeight;
+	int page;
+	int x; // position of the padded rect in the page
+	int y;
+	bool matched;
+} ManifestEntry;
+
+typedef struct {
+	int width;
+	int height;
+	bool dirty;
+} SheetPage;
+
+typedef struct {
+	int maxSize;
+	int xPadding;
+	int yPadding;
+	bool trim;
+	SheetPage* sbPages;
+	ManifestEntry* sbEntries;
+} SheetManifest;
+
+typedef struct {
+	const char* path;
+	uint64_t hash;
+	bool valid;
+	bool contentChanged;
+	LoadedImage image;
+	int srcWidth;
+	int srcHeight;
+	int trimX;
+	int trimY;
+	int trimWidth;
+	int trimHeight;
+	int page; // < 0 if it hasn't been placed
+	int x; // position of the padded rect in the page
+	int y;
+	ManifestEntry* prev;
+} SheetSprite;
+
+typedef struct {
+	const char* fileName;
+	int maxSize;
+	int xPadding;
+	int yPadding;
+	bool trim;
+	SheetSprite* sprites;
+	int numSprites;
+	SheetPage* sbPages;
+	char** sbPageFileNames;
+} SheetBuild;
+
+typedef void (*SheetTaskFunc)( void* ctx, int idx );
+
+typedef struct {
+	SheetTaskFunc func;
+	void* ctx;
+	int count;
+	SDL_AtomicInt nextIdx;
+	SDL_AtomicInt lanesDone;
+} SheetTaskSet;
+
+static void sheetTaskLane( void* data )
+{
+	SheetTaskSet* set = (SheetTaskSet*)data;
+
+	int idx = SDL_AddAtomicInt( &( set->nextIdx ), 1 );
+	while( idx < set->count ) {
+		set->func( set->ctx, idx );
+		idx = SDL_AddAtomicInt( &( set->nextIdx ), 1 );
+	}
+
+	SDL_AddAtomicInt( &( set->lanesDone ), 1 );
+}
+
+// calls func for every index in [0,count), spread across the job queue, and waits for them all to finish
+static void runSheetTasks( SheetTaskFunc func, void* ctx, int count )
+{
+	if( count <= 0 ) return;
+
+	SheetTaskSet set;
+	set.func = func;
+	set.ctx = ctx;
+	set.count = count;
+	SDL_SetAtomicInt( &( set.nextIdx ), 0 );
+	SDL_SetAtomicInt( &( set.lanesDone ), 0 );
+
+	int numLanes = MIN( MAX( jq_GetNumThreads( ), 1 ), count );
+	int lanesQueued = 0;
+	for( int i = 0; i < numLanes; ++i ) {
+		if( jq_AddJob( sheetTaskLane, &set ) ) {
+			++lanesQueued;
+		}
+	}
+
+	if( lanesQueued == 0 ) {
+		sheetTaskLane( &set );
+		return;
+	}
+
+	// help out while waiting so this still finishes if there are no worker threads
+	while( SDL_GetAtomicInt( &( set.lanesDone ) ) < lanesQueued ) {
+		if( !jq_ProcessNextJob( ) ) {
+			SDL_Delay( 1 );
+		}
+	}
+}
+
+static int compareManifestEntries( const void* left, const void* right )
+{
+	return SDL_strcmp( ( (const ManifestEntry*)left )->path, ( (const ManifestEntry*)right )->path );
+}
+
+static void cleanManifest( SheetManifest* manifest )
+{
+	for( size_t i = 0; i < sb_Count( manifest->sbEntries ); ++i ) {
+		mem_Release( manifest->sbEntries[i].path );
+	}
+	sb_Release( manifest->sbEntries );
+	sb_Release( manifest->sbPages );
+}
+
+static char* createManifestFileName( const char* fileName )
+{
+	size_t len = SDL_strlen( fileName ) + 10;
+	char* manifestFileName = mem_Allocate( len );
+	if( manifestFileName != NULL ) {
+		SDL_snprintf( manifestFileName, len, "%s.manifest", fileName );
+	}
+	return manifestFileName;
+}
+
+static bool serializeManifest( Serializer* s, SheetManifest* manifest )
+{
+	uint32_t version = MANIFEST_VERSION;
+	SERIALIZE_CHECK( s->u32( s, "version", &version ), ioType, "manifest version", return false );
+	if( version != MANIFEST_VERSION ) {
+		llog( LOG_INFO, "Unknown sprite sheet manifest version %u, ignoring it.", version );
+		return false;
+	}
+
+	SERIALIZE_CHECK( s->s32( s, "maxSize", &( manifest->maxSize ) ), ioType, "manifest max size", return false );
+	SERIALIZE_CHECK( s->s32( s, "xPadding", &( manifest->xPadding ) ), ioType, "manifest x-padding", return false );
+	SERIALIZE_CHECK( s->s32( s, "yPadding", &( manifest->yPadding ) ), ioType, "manifest y-padding", return false );
+	SERIALIZE_CHECK( s->boolean( s, "trim", &( manifest->trim ) ), ioType, "manifest trim", return false );
+
+	uint32_t numPages = (uint32_t)sb_Count( manifest->sbPages );
+	SERIALIZE_CHECK( s->arraySize( s, "pages", &numPages ), ioType, "manifest page count", return false );
+	if( sb_Count( manifest->sbPages ) != numPages ) {
+		SheetPage* pages = sb_Add( manifest->sbPages, numPages );
+		SDL_memset( pages, 0, sizeof( SheetPage ) * numPages );
+	}
+	for( uint32_t i = 0; i < numPages; ++i ) {
+		SERIALIZE_CHECK( s->s32( s, "pageWidth", &( manifest->sbPages[i].width ) ), ioType, "manifest page width", return false );
+		SERIALIZE_CHECK( s->s32( s, "pageHeight", &( manifest->sbPages[i].height ) ), ioType, "manifest page height", return false );
+	}
+
+	uint32_t numEntries = (uint32_t)sb_Count( manifest->sbEntries );
+	SERIALIZE_CHECK( s->arraySize( s, "entries", &numEntries ), ioType, "manifest entry count", return false );
+	if( sb_Count( manifest->sbEntries ) != numEntries ) {
+		ManifestEntry* entries = sb_Add( manifest->sbEntries, numEntries );
+		SDL_memset( entries, 0, sizeof( ManifestEntry ) * numEntries );
+	}
+	for( uint32_t i = 0; i < numEntries; ++i ) {
+		ManifestEntry* entry = &( manifest->sbEntries[i] );
+		SERIALIZE_CHECK( s->cString( s, "path", &( entry->path ) ), ioType, "manifest entry path", return false );
+		SERIALIZE_CHECK( s->u64( s, "hash", &( entry->hash ) ), ioType, "manifest entry hash", return false );
+		SERIALIZE_CHECK( s->s32( s, "srcWidth", &( entry->srcWidth ) ), ioType, "manifest entry width", return false );
+		SERIALIZE_CHECK( s->s32( s, "srcHeight", &( entry->srcHeight ) ), ioType, "manifest entry height", return false );
+		SERIALIZE_CHECK( s->s32( s, "trimX", &( entry->trimX ) ), ioType, "manifest entry trim x", return false );
+		SERIALIZE_CHECK( s->s32( s, "trimY", &( entry->trimY ) ), ioType, "manifest entry trim y", return false );
+		SERIALIZE_CHECK( s->s32( s, "trimWidth", &( entry->trimWidth ) ), ioType, "manifest entry trim width", return false );
+		SERIALIZE_CHECK( s->s32( s, "trimHeight", &( entry->trimHeight ) ), ioType, "manifest entry trim height", return false );
+		SERIALIZE_CHECK( s->s32( s, "page", &( entry->page ) ), ioType, "manifest entry page", return false );
+		SERIALIZE_CHECK( s->s32( s, "x", &( entry->x ) ), ioType, "manifest entry x-coordinate", return false );
+		SERIALIZE_CHECK( s->s32( s, "y", &( entry->y ) ), ioType, "manifest entry y-coordinate", return false );
+
+		if( ( entry->page < 0 ) || ( entry->page >= (int)numPages ) ) {
+			llog( LOG_INFO, "Invalid page in sprite sheet manifest, ignoring it." );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// the manifest is optional, if it doesn't exist or can't be read everything is just packed from scratch
+static bool loadManifest( const char* fileName, SheetManifest* outManifest )
+{
+	SDL_memset( outManifest, 0, sizeof( *outManifest ) );
+
+	char* manifestFileName = createManifestFileName( fileName );
+	if( manifestFileName == NULL ) return false;
+
+	bool done = false;
+	SDL_IOStream* ioStream = NULL;
+
+	SDL_PathInfo info;
+	if( !SDL_GetPathInfo( manifestFileName, &info ) ) goto clean_up;
+
+	cmp_ctx_t cmp;
+	ioStream = openRWopsCMPFile( manifestFileName, "rb", &cmp );
+	if( ioStream == NULL ) goto clean_up;
+
+	Serializer s;
+	serializer_CreateReadCmp( &cmp, &s );
+	if( !serializeManifest( &s, outManifest ) ) goto clean_up;
+
+	// sorted so entries can be found by path
+	SDL_qsort( outManifest->sbEntries, sb_Count( outManifest->sbEntries ), sizeof( ManifestEntry ), compareManifestEntries );
+
+	done = true;
+
+clean_up:
+	if( ioStream != NULL ) SDL_CloseIO( ioStream );
+	if( !done ) cleanManifest( outManifest );
+	mem_Release( manifestFileName );
+
+	return done;
+}
+
+static bool saveManifest( SheetBuild* build )
+{
+	SheetManifest manifest;
+	manifest.maxSize = build->maxSize;
+	manifest.xPadding = build->xPadding;
+	manifest.yPadding = build->yPadding;
+	manifest.trim = build->trim;
+	manifest.sbPages = build->sbPages;
+	manifest.sbEntries = NULL;
+
+	for( int i = 0; i < build->numSprites; ++i ) {
+		SheetSprite* sprite = &( build->sprites[i] );
+		if( !sprite->valid ) continue;
+
+		ManifestEntry entry;
+		entry.path = (char*)sprite->path;
+		entry.hash = sprite->hash;
+		entry.srcWidth = sprite->srcWidth;
+		entry.srcHeight = sprite->srcHeight;
+		entry.trimX = sprite->trimX;
+		entry.trimY = sprite->trimY;
+		entry.trimWidth = sprite->trimWidth;
+		entry.trimHeight = sprite->trimHeight;
+		entry.page = sprite->page;
+		entry.x = sprite->x;
+		entry.y = sprite->y;
+		entry.matched = false;
+		sb_Push( manifest.sbEntries, entry );
+	}
+
+	bool done = false;
+	char* manifestFileName = createManifestFileName( build->fileName );
+	if( manifestFileName == NULL ) goto clean_up;
+
+	cmp_ctx_t cmp;
+	SDL_IOStream* ioStream = openRWopsCMPFile( manifestFileName, "wb", &cmp );
+	if( ioStream == NULL ) goto clean_up;
+
+	Serializer s;
+	serializer_CreateWriteCmp( &cmp, &s );
+	done = serializeManifest( &s, &manifest );
+
+	if( !SDL_CloseIO( ioStream ) ) {
+		llog( LOG_ERROR, "Error closing file %s: %s", manifestFileName, SDL_GetError( ) );
+		done = false;
+	}
+
+	if( !done ) {
+		remove( manifestFileName );
+	}
+
+clean_up:
+	mem_Release( manifestFileName );
+	sb_Release( manifest.sbEntries );
+
+	return done;
+}
+
+// finds the smallest rect that has all the pixels that aren't completely transparent
+static void trimSprite( SheetSprite* sprite, bool trim )
+{
+	int w = sprite->image.width;
+	int h = sprite->image.height;
+
+	sprite->srcWidth = w;
+	sprite->srcHeight = h;
+	sprite->trimX = 0;
+	sprite->trimY = 0;
+	sprite->trimWidth = w;
+	sprite->trimHeight = h;
+
+	if( !trim ) return;
+
+	int minX = w;
+	int minY = h;
+	int maxX = -1;
+	int maxY = -1;
+	for( int y = 0; y < h; ++y ) {
+		const uint8_t* row = sprite->image.data + ( y * w * 4 );
+		for( int x = 0; x < w; ++x ) {
+			if( row[( x * 4 ) + 3] != 0 ) {
+				minX = MIN( minX, x );
+				maxX = MAX( maxX, x );
+				minY = MIN( minY, y );
+				maxY = MAX( maxY, y );
+			}
+		}
 	}
 
-	sb_Release( sbTempData );
-
-	return packageID;
+	if( maxX < 0 ) {
+		// completely clear, keep a single pixel so there's still something to reference
+		sprite->trimWidth = 1;
+		sprite->trimHeight = 1;
+	} else {
+		sprite->trimX = minX;
+		sprite->trimY = minY;
+		sprite->trimWidth = ( maxX - minX ) + 1;
+		sprite->trimHeight = ( maxY - minY ) + 1;
+	}
 }
 
-// Unloads all the images associated with the package and marks the sprite sheet as unloaded.
-void img_UnloadSpriteSheet( int packageID )
+// reads and hashes the source, only decodes it if it's changed since the last build
+static void readSpriteTask( void* ctx, int idx )
 {
-	size_t idx = SIZE_MAX;
-	for( size_t i = 0; i < sb_Count( sbLoadedSpriteSheets ) && idx == SIZE_MAX; ++i ) {
-		if( sbLoadedSpriteSheets[i].packageID == packageID ) {
-			idx = i;
+	SheetBuild* build = (SheetBuild*)ctx;
+	SheetSprite* sprite = &( build->sprites[idx] );
+
+	size_t fileSize = 0;
+	uint8_t* fileData = (uint8_t*)SDL_LoadFile( sprite->path, &fileSize );
+	if( fileData == NULL ) {
+		llog( LOG_ERROR, "Unable to read file %s for sprite sheet: %s", sprite->path, SDL_GetError( ) );
+		return;
+	}
+
+	sprite->hash = fnv1aHash( FNV1A_START, fileData, fileSize );
+
+	if( ( sprite->prev != NULL ) && ( sprite->prev->hash == sprite->hash ) ) {
+		sprite->srcWidth = sprite->prev->srcWidth;
+		sprite->srcHeight = sprite->prev->srcHeight;
+		sprite->trimX = sprite->prev->trimX;
+		sprite->trimY = sprite->prev->trimY;
+		sprite->trimWidth = sprite->prev->trimWidth;
+		sprite->trimHeight = sprite->prev->trimHeight;
+		sprite->contentChanged = false;
+	} else {
+		if( gfxUtil_LoadImageFromMemory( fileData, fileSize, 4, &( sprite->image ) ) < 0 ) {
+			llog( LOG_ERROR, "Unable to decode image %s for sprite sheet.", sprite->path );
+			SDL_free( fileData );
+			return;
 		}
+		trimSprite( sprite, build->trim );
+		sprite->contentChanged = true;
 	}
 
-	if( idx == SIZE_MAX ) {
-		llog( LOG_ERROR, "Sending in invalid packageID when unloading a sprite sheet." );
+	SDL_free( fileData );
+
+	if( ( ( sprite->trimWidth + build->xPadding ) > build->maxSize ) || ( ( sprite->trimHeight + build->yPadding ) > build->maxSize ) ) {
+		llog( LOG_ERROR, "File %s is too big and won't fit into the size limits. File will be ignored.", sprite->path );
 		return;
 	}
 
-	sbLoadedSpriteSheets[idx].loadCount -= 1;
-	if( sbLoadedSpriteSheets[idx].loadCount <= 0 ) {
-		mem_Release( sbLoadedSpriteSheets[idx].spriteSheetID );
-		sb_Remove( sbLoadedSpriteSheets, idx );
-		img_CleanPackage( packageID );
-	}
+	sprite->valid = true;
 }
 
-void generateRects( SpriteSheetEntry* sbSpriteInfos, stbrp_rect** sbRects, int maxSize, int xPadding, int yPadding )
+// unchanged sprites are only decoded if the page they're on has to be written out again
+static void decodeSpriteTask( void* ctx, int idx )
 {
-	for( size_t i = 0; i < sb_Count( sbSpriteInfos ); ++i ) {
-		// create the rect for the image
-		LoadedImage img;
-		if( gfxUtil_LoadImageInfo( sbSpriteInfos[i].sbPath, &img ) < 0 ) {
-			continue;
-		}
+	SheetBuild* build = (SheetBuild*)ctx;
+	SheetSprite* sprite = &( build->sprites[idx] );
 
-		stbrp_rect newRect;
-		newRect.w = img.width + xPadding;
-		newRect.h = img.height + yPadding;
-		newRect.id = (int)i;
-		newRect.was_packed = 0;
+	if( !sprite->valid || ( sprite->page < 0 ) || ( sprite->image.data != NULL ) || !build->sbPages[sprite->page].dirty ) return;
 
-		if( newRect.w > maxSize || newRect.h > maxSize ) {
-			llog( LOG_ERROR, "File %s is too big and won't fit into the size limits. File will be ignored.", sbSpriteInfos[i].sbPath );
-		} else {
-			sb_Push( *sbRects, newRect );
-		}
+	if( gfxUtil_LoadImage( sprite->path, &( sprite->image ) ) < 0 ) {
+		llog( LOG_ERROR, "Unable to load image %s for inserting into sheet.", sprite->path );
 	}
 }
 
-typedef struct {
-	char* fileName;
-	stbrp_rect* sbRects;
-	int width;
-	int height;
-} RectSet;
+static bool rectsOverlap( int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh )
+{
+	return ( ax < ( bx + bw ) ) && ( bx < ( ax + aw ) ) && ( ay < ( by + bh ) ) && ( by < ( ay + ah ) );
+}
 
-static void insertImage( char* filePath, stbrp_rect* rect, uint8_t* imageData, int imgWidth, int imgHeight, int topPadding, int leftPadding )
+// bottom-left placement against the sprites already on the page, the candidate spots are the top-left corner and
+//  right next to and just below every placed sprite
+static bool findFreeSpot( SheetBuild* build, int page, int w, int h, int* outX, int* outY )
 {
-	LoadedImage img;
-	if( gfxUtil_LoadImage( filePath, &img ) < 0 ) {
-		llog( LOG_ERROR, "Unable to load image %s for inserting into sheet.", filePath );
-		return;
-	}
-	
-	int x = rect->x + leftPadding;
-	int y = rect->y + topPadding;
+	int pageWidth = build->sbPages[page].width;
+	int pageHeight = build->sbPages[page].height;
+
+	int bestX = INT_MAX;
+	int bestY = INT_MAX;
+
+	for( int c = -1; c < build->numSprites; ++c ) {
+		int candidates[2][2];
+		int numCandidates = 0;
+		if( c < 0 ) {
+			candidates[0][0] = 0;
+			candidates[0][1] = 0;
+			numCandidates = 1;
+		} else {
+			SheetSprite* placed = &( build->sprites[c] );
+			if( placed->page != page ) continue;
+			candidates[0][0] = placed->x + placed->trimWidth + build->xPadding;
+			candidates[0][1] = placed->y;
+			candidates[1][0] = placed->x;
+			candidates[1][1] = placed->y + placed->trimHeight + build->yPadding;
+			numCandidates = 2;
+		}
+
+		for( int n = 0; n < numCandidates; ++n ) {
+			int x = candidates[n][0];
+			int y = candidates[n][1];
+			if( ( ( x + w ) > pageWidth ) || ( ( y + h ) > pageHeight ) ) continue;
+			if( ( y > bestY ) || ( ( y == bestY ) && ( x >= bestX ) ) ) continue;
+
+			bool fits = true;
+			for( int o = 0; ( o < build->numSprites ) && fits; ++o ) {
+				SheetSprite* other = &( build->sprites[o] );
+				if( other->page != page ) continue;
+				fits = !rectsOverlap( x, y, w, h, other->x, other->y, other->trimWidth + build->xPadding, other->trimHeight + build->yPadding );
+			}
 
-	// copy each row
-	for( int r = 0; r < img.height; ++r ) {
-		uint8_t* base = imageData + ( ( x + ( imgWidth * ( r + y ) ) ) * 4 );
-		SDL_memcpy( base, img.data + ( img.width * r * 4 ), 4 * img.width );
+			if( fits ) {
+				bestX = x;
+				bestY = y;
+			}
+		}
 	}
+
+	if( bestX == INT_MAX ) return false;
+
+	(*outX) = bestX;
+	(*outY) = bestY;
+	return true;
+}
+
+static int compareSpriteHeights( const void* left, const void* right )
+{
+	const SheetSprite* l = *(const SheetSprite**)left;
+	const SheetSprite* r = *(const SheetSprite**)right;
+	return r->trimHeight - l->trimHeight;
 }
 
-static bool saveSpriteSheetDefinition( const char* fileName, SpriteSheetEntry* entries, size_t numEntries, RectSet* rectSets, size_t numRectSets )
+// keeps the placement of everything that's the same size as the last build and fits anything else into the free space,
+//  returns false if that wasn't possible. outStructureChanged is set if anything was added, moved, or removed.
+static bool reusePlacements( SheetBuild* build, SheetManifest* manifest, bool* outStructureChanged )
 {
+	(*outStructureChanged) = false;
+
 	bool done = false;
+	SheetSprite** sbToPlace = NULL;
 
-	cmp_ctx_t cmp;
-	SDL_IOStream* ioStream = openRWopsCMPFile( fileName, "wb", &cmp );
-	if( ioStream == NULL ) {
-		goto clean_up;
+	SheetPage* pages = sb_Add( build->sbPages, sb_Count( manifest->sbPages ) );
+	for( size_t i = 0; i < sb_Count( manifest->sbPages ); ++i ) {
+		pages[i].width = manifest->sbPages[i].width;
+		pages[i].height = manifest->sbPages[i].height;
+		pages[i].dirty = false;
 	}
 
-	Serializer s;
-	serializer_CreateWriteCmp( &cmp, &s );
-
-	// write out version number
-	uint32_t version = 3;
-	SERIALIZE_CHECK( s.u32( &s, "version", &version ), ioType, "version number", goto clean_up );
+	for( int i = 0; i < build->numSprites; ++i ) {
+		SheetSprite* sprite = &( build->sprites[i] );
+		if( !sprite->valid ) continue;
+
+		ManifestEntry* prev = sprite->prev;
+		if( ( prev != NULL ) && !prev->matched && ( prev->trimWidth == sprite->trimWidth ) && ( prev->trimHeight == sprite->trimHeight ) ) {
+			prev->matched = true;
+			sprite->page = prev->page;
+			sprite->x = prev->x;
+			sprite->y = prev->y;
+			if( sprite->contentChanged ) {
+				build->sbPages[sprite->page].dirty = true;
+			}
+		} else {
+			sb_Push( sbToPlace, sprite );
+		}
+	}
 
-	//  write out all the image names
-	uint32_t numImages = (uint32_t)numRectSets;
-	SERIALIZE_CHECK( s.arraySize( &s, "rectArraySize", &numImages ), ioType, "rect set array size", goto clean_up );
-	for( uint32_t i = 0; i < numImages; ++i ) {
-		RectSet* set = &( rectSets[i] );
+	// anything that's gone needs to be cleared out of it's page
+	for( size_t i = 0; i < sb_Count( manifest->sbEntries ); ++i ) {
+		if( !manifest->sbEntries[i].matched ) {
+			build->sbPages[manifest->sbEntries[i].page].dirty = true;
+			(*outStructureChanged) = true;
+		}
+	}
 
-		SERIALIZE_CHECK( s.cString( &s, "setFileName", &( set->fileName ) ), ioType, "rect set image file name", goto clean_up );
+	if( sb_Count( sbToPlace ) > MAX_INCREMENTAL_PLACEMENTS ) goto clean_up;
+	if( sb_Count( sbToPlace ) > 0 ) {
+		(*outStructureChanged) = true;
+	}
 
-		// write out the entries for each sprite stored in this image
-		//  want to right out the id and rect
-		uint32_t numSprites = (uint32_t)sb_Count( set->sbRects );
-		SERIALIZE_CHECK( s.arraySize( &s, "rectSpriteCount", &numSprites ), ioType, "rect set sprite count", goto clean_up );
-		for( uint32_t a = 0; a < numSprites; ++a ) {
-			stbrp_rect* rect = &( set->sbRects[a] );
-			char* id = SDL_strrchr( entries[rect->id].sbPath, '/' );
-			if( id == NULL ) {
-				id = entries[rect->id].sbPath;
-			} else {
-				++id; // advance past the '/'
+	SDL_qsort( sbToPlace, sb_Count( sbToPlace ), sizeof( SheetSprite* ), compareSpriteHeights );
+	for( size_t i = 0; i < sb_Count( sbToPlace ); ++i ) {
+		SheetSprite* sprite = sbToPlace[i];
+		int w = sprite->trimWidth + build->xPadding;
+		int h = sprite->trimHeight + build->yPadding;
+
+		bool placed = false;
+		for( int p = 0; ( p < (int)sb_Count( build->sbPages ) ) && !placed; ++p ) {
+			int x, y;
+			if( findFreeSpot( build, p, w, h, &x, &y ) ) {
+				sprite->page = p;
+				sprite->x = x;
+				sprite->y = y;
+				build->sbPages[p].dirty = true;
+				placed = true;
 			}
-
-			SERIALIZE_CHECK( s.cString( &s, "spriteID", &id ), ioType, "sprite id", goto clean_up );
-			SERIALIZE_CHECK( s.s32( &s, "spriteX", &( rect->x ) ), ioType, "sprite x-coordinate", goto clean_up );
-			SERIALIZE_CHECK( s.s32( &s, "spriteY", &( rect->y ) ), ioType, "sprite y-coordinate", goto clean_up );
-			SERIALIZE_CHECK( s.s32( &s, "spriteW", &( rect->w ) ), ioType, "sprite width", goto clean_up );
-			SERIALIZE_CHECK( s.s32( &s, "spriteH", &( rect->h ) ), ioType, "sprite height", goto clean_up );
 		}
+
+		if( !placed ) goto clean_up;
 	}
 
 	done = true;
 
 clean_up:
-
-	if( !SDL_CloseIO( ioStream ) ) {
-		llog( LOG_ERROR, "Error closing file %s: %s", fileName, SDL_GetError( ) );
-		done = false;
-	}
+	sb_Release( sbToPlace );
 
 	if( !done ) {
-		remove( fileName );
+		for( int i = 0; i < build->numSprites; ++i ) {
+			build->sprites[i].page = -1;
+		}
+		sb_Clear( build->sbPages );
 	}
 
 	return done;
 }
 
-static RectSet* generateRectSets( stbrp_rect* sbBaseRects, int maxSize, int xPadding, int yPadding, int leftPadding, int topPadding )
+typedef struct {
+	char* fileName;
+	stbrp_rect* sbRects;
+	int width;
+	int height;
+} RectSet;
+
+typedef struct {
+	int heuristic;
+	bool growWidthFirst;
+	int maxSize;
+	stbrp_rect* sbRects;
+	RectSet* sbRectSets;
+	int64_t totalArea;
+} PackAttempt;
+
+static RectSet* generateRectSets( stbrp_rect* sbBaseRects, int maxSize, int heuristic, bool growWidthFirst )
 {
 	// create the set of rect sets that we'll use to define where things are stored in the image
 	//  we'll want to be able to use multiple images for one sprite sheet
@@ -343,6 +1242,7 @@ static RectSet* generateRectSets( stbrp_rect* sbBaseRects, int maxSize, int xPad
 	//   as a valid set that will be it's own image, remove all of those from the current rect set and
 	//   continue
 	RectSet* sbRectSets = NULL;
+	stbrp_node* sbNodes = NULL;
 
 	stbrp_context rpContext;
 	while( sb_Count( sbBaseRects ) > 0 ) {
@@ -360,23 +1260,22 @@ static RectSet* generateRectSets( stbrp_rect* sbBaseRects, int maxSize, int xPad
 		maxWidth = MIN( maxSize, nextHighestWidth );
 		maxHeight = MIN( maxSize, nextHighestHeight );
 
-		// try to find a tight packing for the images
-		int packSuccess = 0;
-		stbrp_node* sbNodes = NULL;
-		while( !( packSuccess || ( ( maxWidth >= maxSize ) && ( maxHeight >= maxSize ) ) ) ) {
-
+		// try to find a tight packing for the images, the last attempt is at the maximum size
+		for( ;; ) {
 			sb_Clear( sbNodes );
 			sb_Add( sbNodes, maxWidth );
 
 			stbrp_init_target( &rpContext, maxWidth, maxHeight, sbNodes, (int)sb_Count( sbNodes ) );
-			packSuccess = stbrp_pack_rects( &rpContext, sbBaseRects, (int)sb_Count( sbBaseRects ) );
+			stbrp_setup_heuristic( &rpContext, heuristic );
+			int packSuccess = stbrp_pack_rects( &rpContext, sbBaseRects, (int)sb_Count( sbBaseRects ) );
 
-			if( !packSuccess ) {
-				if( maxWidth > maxHeight ) {
-					maxHeight <<= 1;
-				} else {
-					maxWidth <<= 1;
-				}
+			if( packSuccess || ( ( maxWidth >= maxSize ) && ( maxHeight >= maxSize ) ) ) break;
+
+			bool growWidth = growWidthFirst ? ( maxWidth <= maxHeight ) : ( maxWidth < maxHeight );
+			if( ( growWidth && ( maxWidth < maxSize ) ) || ( maxHeight >= maxSize ) ) {
+				maxWidth = MIN( maxWidth << 1, maxSize );
+			} else {
+				maxHeight = MIN( maxHeight << 1, maxSize );
 			}
 		}
 
@@ -389,86 +1288,398 @@ static RectSet* generateRectSets( stbrp_rect* sbBaseRects, int maxSize, int xPad
 			sb_Remove( sbBaseRects, i );
 			--i;
 		}
+
+		if( newRectSet.sbRects == NULL ) {
+			// shouldn't happen since everything fits in the maximum size, but don't loop forever if it does
+			llog( LOG_ERROR, "Unable to pack any images into a sprite sheet page." );
+			break;
+		}
 		sb_Push( sbRectSets, newRectSet );
 	}
 
-	// adjust all the rectangles for padding
+	sb_Release( sbNodes );
+
+	return sbRectSets;
+}
+
+static void packAttemptTask( void* ctx, int idx )
+{
+	PackAttempt* attempt = &( ( (PackAttempt*)ctx )[idx] );
+	attempt->sbRectSets = generateRectSets( attempt->sbRects, attempt->maxSize, attempt->heuristic, attempt->growWidthFirst );
+
+	attempt->totalArea = 0;
+	for( size_t i = 0; i < sb_Count( attempt->sbRectSets ); ++i ) {
+		attempt->totalArea += (int64_t)attempt->sbRectSets[i].width * attempt->sbRectSets[i].height;
+	}
+}
+
+static void releaseRectSets( RectSet* sbRectSets )
+{
 	for( size_t i = 0; i < sb_Count( sbRectSets ); ++i ) {
-		RectSet* set = &( sbRectSets[i] );
-		for( size_t a = 0; a < sb_Count( set->sbRects ); ++a ) {
-			stbrp_rect* rect = &( set->sbRects[a] );
-			rect->x += leftPadding;
-			rect->y += topPadding;
-			rect->w -= xPadding;
-			rect->h -= yPadding;
+		sb_Release( sbRectSets[i].sbRects );
+	}
+	sb_Release( sbRectSets );
+}
+
+// packs everything from scratch, each heuristic is tried in parallel and the one with the fewest pages, then the
+//  least area, is kept
+static bool packAllSprites( SheetBuild* build, SheetPage** sbOutPages )
+{
+	PackAttempt attempts[] = {
+		{ STBRP_HEURISTIC_Skyline_BL_sortHeight, true },
+		{ STBRP_HEURISTIC_Skyline_BL_sortHeight, false },
+		{ STBRP_HEURISTIC_Skyline_BF_sortHeight, true },
+		{ STBRP_HEURISTIC_Skyline_BF_sortHeight, false },
+	};
+
+	stbrp_rect* sbBaseRects = NULL;
+	for( int i = 0; i < build->numSprites; ++i ) {
+		if( !build->sprites[i].valid ) continue;
+
+		stbrp_rect newRect;
+		newRect.w = build->sprites[i].trimWidth + build->xPadding;
+		newRect.h = build->sprites[i].trimHeight + build->yPadding;
+		newRect.id = i;
+		newRect.was_packed = 0;
+		sb_Push( sbBaseRects, newRect );
+	}
+
+	if( sbBaseRects == NULL ) {
+		return false;
+	}
+
+	for( int i = 0; i < (int)ARRAY_SIZE( attempts ); ++i ) {
+		attempts[i].maxSize = build->maxSize;
+		attempts[i].sbRects = NULL;
+		attempts[i].sbRectSets = NULL;
+		SDL_memcpy( sb_Add( attempts[i].sbRects, sb_Count( sbBaseRects ) ), sbBaseRects, sizeof( stbrp_rect ) * sb_Count( sbBaseRects ) );
+	}
+	sb_Release( sbBaseRects );
+
+	runSheetTasks( packAttemptTask, attempts, (int)ARRAY_SIZE( attempts ) );
+
+	int best = -1;
+	for( int i = 0; i < (int)ARRAY_SIZE( attempts ); ++i ) {
+		if( attempts[i].sbRectSets == NULL ) continue;
+		if( ( best < 0 ) ||
+			( sb_Count( attempts[i].sbRectSets ) < sb_Count( attempts[best].sbRectSets ) ) ||
+			( ( sb_Count( attempts[i].sbRectSets ) == sb_Count( attempts[best].sbRectSets ) ) && ( attempts[i].totalArea < attempts[best].totalArea ) ) ) {
+			best = i;
 		}
 	}
 
-	return sbRectSets;
+	if( best >= 0 ) {
+		RectSet* sbRectSets = attempts[best].sbRectSets;
+		for( size_t p = 0; p < sb_Count( sbRectSets ); ++p ) {
+			SheetPage page = { sbRectSets[p].width, sbRectSets[p].height, true };
+			sb_Push( *sbOutPages, page );
+
+			for( size_t r = 0; r < sb_Count( sbRectSets[p].sbRects ); ++r ) {
+				stbrp_rect* rect = &( sbRectSets[p].sbRects[r] );
+				build->sprites[rect->id].page = (int)p;
+				build->sprites[rect->id].x = rect->x;
+				build->sprites[rect->id].y = rect->y;
+			}
+		}
+	}
+
+	for( int i = 0; i < (int)ARRAY_SIZE( attempts ); ++i ) {
+		sb_Release( attempts[i].sbRects );
+		releaseRectSets( attempts[i].sbRectSets );
+	}
+
+	return ( best >= 0 );
+}
+
+// puts together the image for the page and saves it out
+static void writePageTask( void* ctx, int idx )
+{
+	SheetBuild* build = (SheetBuild*)ctx;
+	SheetPage* page = &( build->sbPages[idx] );
+	if( !page->dirty ) return;
+
+	int leftPadding = build->xPadding / 2;
+	int topPadding = build->yPadding / 2;
+
+	size_t imgSize = sizeof( uint8_t ) * 4 * page->width * page->height;
+	uint8_t* imageData = mem_Allocate( imgSize );
+	if( imageData == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate image for sprite sheet page %s.", build->sbPageFileNames[idx] );
+		return;
+	}
+	SDL_memset( imageData, 0, imgSize );
+
+	for( int i = 0; i < build->numSprites; ++i ) {
+		SheetSprite* sprite = &( build->sprites[i] );
+		if( !sprite->valid || ( sprite->page != idx ) || ( sprite->image.data == NULL ) ) continue;
+
+		int x = sprite->x + leftPadding;
+		int y = sprite->y + topPadding;
+
+		// copy each row of the trimmed area
+		for( int r = 0; r < sprite->trimHeight; ++r ) {
+			uint8_t* base = imageData + ( ( x + ( page->width * ( r + y ) ) ) * 4 );
+			const uint8_t* src = sprite->image.data + ( ( sprite->trimX + ( sprite->image.width * ( r + sprite->trimY ) ) ) * 4 );
+			SDL_memcpy( base, src, 4 * sprite->trimWidth );
+		}
+	}
+
+	gfxUtil_SaveImage( build->sbPageFileNames[idx], imageData, page->width, page->height, 4 );
+	mem_Release( imageData );
+}
+
+static bool saveSpriteSheetDefinition( SheetBuild* build )
+{
+	bool done = false;
+
+	int leftPadding = build->xPadding / 2;
+	int topPadding = build->yPadding / 2;
+
+	cmp_ctx_t cmp;
+	SDL_IOStream* ioStream = openRWopsCMPFile( build->fileName, "wb", &cmp );
+	if( ioStream == NULL ) {
+		return false;
+	}
+
+	Serializer s;
+	serializer_CreateWriteCmp( &cmp, &s );
+
+	// write out version number
+	uint32_t version = 4;
+	SERIALIZE_CHECK( s.u32( &s, "version", &version ), ioType, "version number", goto clean_up );
+
+	//  write out all the image names
+	uint32_t numImages = (uint32_t)sb_Count( build->sbPages );
+	SERIALIZE_CHECK( s.arraySize( &s, "rectArraySize", &numImages ), ioType, "rect set array size", goto clean_up );
+	for( uint32_t i = 0; i < numImages; ++i ) {
+		SERIALIZE_CHECK( s.cString( &s, "setFileName", &( build->sbPageFileNames[i] ) ), ioType, "rect set image file name", goto clean_up );
+
+		// write out the entries for each sprite stored in this image
+		//  want to write out the id, rect, and how it was trimmed
+		uint32_t numSprites = 0;
+		for( int a = 0; a < build->numSprites; ++a ) {
+			if( build->sprites[a].valid && ( build->sprites[a].page == (int)i ) ) ++numSprites;
+		}
+		SERIALIZE_CHECK( s.arraySize( &s, "rectSpriteCount", &numSprites ), ioType, "rect set sprite count", goto clean_up );
+		for( int a = 0; a < build->numSprites; ++a ) {
+			SheetSprite* sprite = &( build->sprites[a] );
+			if( !sprite->valid || ( sprite->page != (int)i ) ) continue;
+
+			char* id = SDL_strrchr( sprite->path, '/' );
+			if( id == NULL ) {
+				id = (char*)sprite->path;
+			} else {
+				++id; // advance past the '/'
+			}
+
+			int x = sprite->x + leftPadding;
+			int y = sprite->y + topPadding;
+
+			SERIALIZE_CHECK( s.cString( &s, "spriteID", &id ), ioType, "sprite id", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "spriteX", &x ), ioType, "sprite x-coordinate", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "spriteY", &y ), ioType, "sprite y-coordinate", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "spriteW", &( sprite->trimWidth ) ), ioType, "sprite width", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "spriteH", &( sprite->trimHeight ) ), ioType, "sprite height", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "trimX", &( sprite->trimX ) ), ioType, "sprite trim x", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "trimY", &( sprite->trimY ) ), ioType, "sprite trim y", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "sourceW", &( sprite->srcWidth ) ), ioType, "sprite source width", goto clean_up );
+			SERIALIZE_CHECK( s.s32( &s, "sourceH", &( sprite->srcHeight ) ), ioType, "sprite source height", goto clean_up );
+		}
+	}
+
+	done = true;
+
+clean_up:
+
+	if( !SDL_CloseIO( ioStream ) ) {
+		llog( LOG_ERROR, "Error closing file %s: %s", build->fileName, SDL_GetError( ) );
+		done = false;
+	}
+
+	if( !done ) {
+		remove( build->fileName );
+	}
+
+	return done;
+}
+
+static char* createPageFileName( const char* fileName, int page )
+{
+	// add in length of underscore, .png, and terminator
+	size_t fileNameLen = SDL_strlen( fileName ) + digitsInU32( (uint32_t)page ) + 6;
+	char* pageFileName = mem_Allocate( fileNameLen );
+	if( pageFileName == NULL ) return NULL;
+
+	int ret = SDL_snprintf( pageFileName, fileNameLen, "%s_%i.png", fileName, page );
+	if( ( ret < 0 ) || ( ret >= fileNameLen ) ) {
+		llog( LOG_ERROR, "Error creating file name for image. %s", ret >= 0 ? "String is too long." : "Encoding error." );
+		mem_Release( pageFileName );
+		return NULL;
+	}
+
+	return pageFileName;
 }
 
 // Takes in a list of file names and generates the sprite sheet and saves it out to fileName.
-bool img_SaveSpriteSheet( const char* fileName, SpriteSheetEntry* sbEntries, int maxSize, int xPadding, int yPadding )
+bool img_SaveSpriteSheet( const char* fileName, SpriteSheetEntry* sbEntries, int maxSize, int xPadding, int yPadding, bool trim )
 {
 	bool done = false;
+	Uint64 startTime = SDL_GetTicks( );
+
+	SheetManifest manifest;
+	bool hasManifest = loadManifest( fileName, &manifest );
+
+	// if the options have changed none of the previous results can be used
+	bool canReuse = hasManifest && ( manifest.maxSize == maxSize ) && ( manifest.xPadding == xPadding ) &&
+		( manifest.yPadding == yPadding ) && ( manifest.trim == trim );
+
+	SheetBuild build;
+	build.fileName = fileName;
+	build.maxSize = maxSize;
+	build.xPadding = xPadding;
+	build.yPadding = yPadding;
+	build.trim = trim;
+	build.numSprites = (int)sb_Count( sbEntries );
+	build.sbPages = NULL;
+	build.sbPageFileNames = NULL;
+	build.sprites = mem_Allocate( sizeof( SheetSprite ) * MAX( build.numSprites, 1 ) );
+	if( build.sprites == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate sprite data when saving sprite sheet." );
+		goto clean_up;
+	}
+	SDL_memset( build.sprites, 0, sizeof( SheetSprite ) * MAX( build.numSprites, 1 ) );
 
-	int leftPadding = xPadding / 2;
-	int topPadding = yPadding / 2;
+	for( int i = 0; i < build.numSprites; ++i ) {
+		build.sprites[i].path = sbEntries[i].sbPath;
+		build.sprites[i].page = -1;
 
-	// first create the layouts, we may have to use mulitple image files to fit everything
-	stbrp_rect* sbBaseRects = NULL;
-	generateRects( sbEntries, &sbBaseRects, maxSize, xPadding, yPadding );
+		if( canReuse ) {
+			ManifestEntry key;
+			key.path = sbEntries[i].sbPath;
+			build.sprites[i].prev = SDL_bsearch( &key, manifest.sbEntries, sb_Count( manifest.sbEntries ), sizeof( ManifestEntry ), compareManifestEntries );
+		}
+	}
 
-	if( sbBaseRects == NULL ) {
+	// read, hash, decode, and trim everything
+	runSheetTasks( readSpriteTask, &build, build.numSprites );
+
+	int numValid = 0;
+	int numChanged = 0;
+	for( int i = 0; i < build.numSprites; ++i ) {
+		if( build.sprites[i].valid ) ++numValid;
+		if( build.sprites[i].valid && build.sprites[i].contentChanged ) ++numChanged;
+	}
+
+	if( numValid == 0 ) {
 		llog( LOG_ERROR, "No images found when trying to save sprite sheet." );
-		return false;
+		goto clean_up;
 	}
 
-	RectSet* sbRectSets = generateRectSets( sbBaseRects, maxSize, xPadding, yPadding, leftPadding, topPadding );
+	// use the last layout if we can, unless repacking from scratch would use fewer pages
+	bool structureChanged = true;
+	bool reused = canReuse && reusePlacements( &build, &manifest, &structureChanged );
+	if( !reused || structureChanged ) {
+		SheetPage* sbPackedPages = NULL;
+		SheetSprite* reusedSprites = NULL;
+		if( reused ) {
+			reusedSprites = mem_Allocate( sizeof( SheetSprite ) * build.numSprites );
+			if( reusedSprites != NULL ) SDL_memcpy( reusedSprites, build.sprites, sizeof( SheetSprite ) * build.numSprites );
+		}
 
-	// for each RectSet create an image
-	for( size_t i = 0; i < sb_Count( sbRectSets ); ++i ) {
-		// add in length of underscore, .png, and terminator
-		size_t fileNameLen = SDL_strlen( fileName ) + digitsInU32( (uint32_t)i ) + 6;
-		sbRectSets[i].fileName = mem_Allocate( fileNameLen );
-		int ret = SDL_snprintf( sbRectSets[i].fileName, fileNameLen, "%s_%i.png", fileName, (int)i );
-		if( ( ret < 0 ) || ( ret >= fileNameLen ) ) {
-			llog( LOG_ERROR, "Error creating file name for image. %s", ret >= 0 ? "String is too long." : "Encoding error." );
+		if( !packAllSprites( &build, &sbPackedPages ) ) {
+			llog( LOG_ERROR, "Unable to pack images for sprite sheet." );
+			mem_Release( reusedSprites );
 			goto clean_up;
 		}
 
-		size_t imgSize = sizeof( uint8_t ) * 4 * sbRectSets[i].width * sbRectSets[i].height;
-		uint8_t* imageData = mem_Allocate( imgSize );
-		SDL_memset( imageData, 0, imgSize );
-		for( size_t a = 0; a < sb_Count( sbRectSets[i].sbRects ); ++a ) {
-			insertImage( sbEntries[sbRectSets[i].sbRects[a].id].sbPath, &( sbRectSets[i].sbRects[a] ), imageData, sbRectSets[i].width, sbRectSets[i].height, topPadding, leftPadding );
+		if( reused && ( reusedSprites != NULL ) && ( sb_Count( build.sbPages ) <= sb_Count( sbPackedPages ) ) ) {
+			SDL_memcpy( build.sprites, reusedSprites, sizeof( SheetSprite ) * build.numSprites );
+			sb_Release( sbPackedPages );
+		} else {
+			reused = false;
+			sb_Release( build.sbPages );
+			build.sbPages = sbPackedPages;
+		}
+		mem_Release( reusedSprites );
+	}
+
+	for( size_t i = 0; i < sb_Count( build.sbPages ); ++i ) {
+		char* pageFileName = createPageFileName( fileName, (int)i );
+		if( pageFileName == NULL ) goto clean_up;
+		sb_Push( build.sbPageFileNames, pageFileName );
+
+		// if the page has gone missing it has to be written out again
+		SDL_PathInfo info;
+		if( !SDL_GetPathInfo( pageFileName, &info ) ) {
+			build.sbPages[i].dirty = true;
+		}
+	}
+
+	// load anything that wasn't decoded but is on a page being written out, then write out all the changed pages
+	runSheetTasks( decodeSpriteTask, &build, build.numSprites );
+	runSheetTasks( writePageTask, &build, (int)sb_Count( build.sbPages ) );
+
+	int numPagesWritten = 0;
+	for( size_t i = 0; i < sb_Count( build.sbPages ); ++i ) {
+		if( build.sbPages[i].dirty ) ++numPagesWritten;
+	}
+
+	// clear out pages left over from a previous build that had more
+	if( hasManifest ) {
+		for( size_t i = sb_Count( build.sbPages ); i < sb_Count( manifest.sbPages ); ++i ) {
+			char* oldPageFileName = createPageFileName( fileName, (int)i );
+			if( oldPageFileName != NULL ) {
+				remove( oldPageFileName );
+				mem_Release( oldPageFileName );
+			}
 		}
-		gfxUtil_SaveImage( sbRectSets[i].fileName, imageData, sbRectSets[i].width, sbRectSets[i].height, 4 );
-		mem_Release( imageData );
 	}
 
 	// now save out the sprite sheet definition
-	done = saveSpriteSheetDefinition( fileName, sbEntries, sb_Count( sbEntries ), sbRectSets, sb_Count( sbRectSets ) );
+	done = saveSpriteSheetDefinition( &build );
+
+	if( done && !saveManifest( &build ) ) {
+		llog( LOG_WARN, "Unable to save manifest for sprite sheet %s, the next build will repack everything.", fileName );
+	}
+
+	llog( LOG_INFO, "Built sprite sheet %s in %i ms: %i images, %i changed, %s, %i of %i pages written.",
+		fileName, (int)( SDL_GetTicks( ) - startTime ), numValid, numChanged, reused ? "kept layout" : "repacked",
+		numPagesWritten, (int)sb_Count( build.sbPages ) );
 
 clean_up:
 	if( !done ) {
 		// something wrong happened, delete the files and let the user know
 		llog( LOG_ERROR, "Error creating sprite sheet, cleaning up invalid files." );
 
-		for( size_t i = 0; i < sb_Count( sbRectSets ); ++i ) {
-			if( sbRectSets[i].fileName != NULL ) {
-				llog( LOG_ERROR, "Removing invalid sprite sheet file %s.", sbRectSets[i].fileName );
-				remove( sbRectSets[i].fileName );
-			}
+		for( size_t i = 0; i < sb_Count( build.sbPageFileNames ); ++i ) {
+			llog( LOG_ERROR, "Removing invalid sprite sheet file %s.", build.sbPageFileNames[i] );
+			remove( build.sbPageFileNames[i] );
+		}
+
+		// the manifest won't match anything now
+		char* manifestFileName = createManifestFileName( fileName );
+		if( manifestFileName != NULL ) {
+			remove( manifestFileName );
+			mem_Release( manifestFileName );
 		}
 	}
 
-	for( size_t i = 0; i < sb_Count( sbRectSets ); ++i ) {
-		mem_Release( sbRectSets[i].fileName );
-		sb_Release( sbRectSets[i].sbRects );
+	for( int i = 0; ( build.sprites != NULL ) && ( i < build.numSprites ); ++i ) {
+		if( build.sprites[i].image.data != NULL ) {
+			gfxUtil_ReleaseLoadedImage( &( build.sprites[i].image ) );
+		}
+	}
+	mem_Release( build.sprites );
+
+	for( size_t i = 0; i < sb_Count( build.sbPageFileNames ); ++i ) {
+		mem_Release( build.sbPageFileNames[i] );
+	}
+	sb_Release( build.sbPageFileNames );
+	sb_Release( build.sbPages );
+
+	if( hasManifest ) {
+		cleanManifest( &manifest );
 	}
-	sb_Release( sbRectSets );
-	sb_Release( sbBaseRects );
 
 	return done;
 }
@@ -482,6 +1693,9 @@ typedef struct {
 	LoadedImage* sbLoadedImages;
 	TempSpriteSheetData* sbTempSheetData;
 
+	bool isBinary;
+	MappedFile binaryFile;
+
 	void (*onLoadDone)( int );
 } ThreadedSpriteSheetLoadData;
 
@@ -496,6 +1710,14 @@ static void bindSpriteSheetJob( void* data )
 
 	ThreadedSpriteSheetLoadData* loadData = (ThreadedSpriteSheetLoadData*)data;
 
+	if( loadData->isBinary ) {
+		int binaryPackageID = createBinarySheetImages( loadData->fileName, loadData->binaryFile.data, loadData->shaderType, NULL );
+		mappedFile_Close( &( loadData->binaryFile ) );
+		if( loadData->onLoadDone != NULL ) loadData->onLoadDone( binaryPackageID );
+		mem_Release( data );
+		return;
+	}
+
 	//llog( LOG_DEBUG, "Done loading %s", loadData->fileName );
 	int ret = 0;
 	int packageID = -1;
@@ -507,8 +1729,7 @@ static void bindSpriteSheetJob( void* data )
 		}
 
 		int newPackageID;
-		newPackageID = img_SplitTexture( &texture, loadData->sbTempSheetData[i].numSpritesRead, loadData->shaderType,
-			loadData->sbTempSheetData[i].sbMins, loadData->sbTempSheetData[i].sbMaxes, loadData->sbTempSheetData[i].sbIDs, packageID, NULL );
+		newPackageID = splitTempSheetTexture( &texture, &( loadData->sbTempSheetData[i] ), loadData->shaderType, packageID, NULL );
 		if( newPackageID == -1 ) {
 			llog( LOG_DEBUG, "Unable to split texture for %s", loadData->fileName );
 			goto clean_up;
@@ -560,6 +1781,16 @@ static void loadSpriteSheetJob( void* data )
 
 	ThreadedSpriteSheetLoadData* loadData = (ThreadedSpriteSheetLoadData*)data;
 
+	// binary sheets have everything in them, the file is mapped here and the textures are created from it on the main thread
+	if( !openBinarySpriteSheet( loadData->fileName, &( loadData->binaryFile ), &( loadData->isBinary ) ) ) {
+		goto error;
+	}
+
+	if( loadData->isBinary ) {
+		jq_AddMainThreadJob( bindSpriteSheetJob, data );
+		return;
+	}
+
 	// there are two things we have to load here, the file data from the sprite sheet file, and the image
 	if( !loadSpriteSheetData( loadData->fileName, &( loadData->sbTempSheetData ) ) ) {
 		goto error;
@@ -608,6 +1839,8 @@ void img_ThreadedLoadSpriteSheet( const char* fileName, ShaderType shaderType, v
 	loadData->onLoadDone = onLoadDone;
 	loadData->sbTempSheetData = NULL;
 	loadData->sbLoadedImages = NULL;
+	loadData->isBinary = false;
+	SDL_memset( &( loadData->binaryFile ), 0, sizeof( loadData->binaryFile ) );
 
 	jq_AddJob( loadSpriteSheetJob, (void*)loadData );
 }
@@ -19,8 +19,15 @@ int img_LoadSpriteSheet( const char* fileName, ShaderType shaderType, ImageID**
 //  <= 0 it unloads all the images associated with the package.
 void img_UnloadSpriteSheet( int packageID );
 
-// Takes in a list of file names and generates the sprite sheet and saves it out to fileName.
-bool img_SaveSpriteSheet( const char* fileName, SpriteSheetEntry* sbEntries, int maxSize, int xPadding, int yPadding );
+// Takes in a list of file names and generates the sprite sheet and saves it out to fileName. If trim is set the fully
+//  transparent border around each image is cut off, the sprites are given an offset when loaded so they still draw in the
+//  same spot. A manifest is saved next to fileName, if it's there when the sheet is built again anything that hasn't
+//  changed keeps it's spot and only the pages that changed are written out.
+bool img_SaveSpriteSheet( const char* fileName, SpriteSheetEntry* sbEntries, int maxSize, int xPadding, int yPadding, bool trim );
+
+// Converts a sprite sheet and the images it uses into a single binary file, fileName and outFileName can be the same.
+//  Binary sprite sheets are loaded the same way as any other, but only need the file mapped and one texture upload per page.
+bool img_ConvertSpriteSheetToBinary( const char* fileName, const char* outFileName );
 
 void img_ThreadedLoadSpriteSheet( const char* fileName, ShaderType shaderType, void ( *onLoadDone )( int ) );
 
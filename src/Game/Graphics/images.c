@@ -642,6 +642,15 @@ void img_ForceTransparency( ImageID id, bool transparent )
 	}
 }
 
+bool img_HasTransparency( ImageID id )
+{
+	if( ( id >= MAX_IMAGES ) || ( !( images[id].flags & IMGFLAG_IN_USE ) ) ) {
+		return false;
+	}
+
+	return ( images[id].flags & IMGFLAG_HAS_TRANSPARENCY ) != 0;
+}
+
 // Gets the size of the image, putting it into the out Vector2. Returns if it succeeds.
 bool img_GetSize( ImageID id, Vector2* out )
 {
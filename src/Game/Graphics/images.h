@@ -80,6 +80,9 @@ void img_GetOffset( ImageID id, Vector2* out );
 
 void img_ForceTransparency( ImageID id, bool transparent );
 
+// Returns if the image will be rendered as transparent.
+bool img_HasTransparency( ImageID id );
+
 // Gets the size of the image, putting it into the out Vector2. Returns false if there's an issue.
 bool img_GetSize( ImageID id, Vector2* out );
 
@@ -26,6 +26,9 @@ struct ComponentType {
 
 	// serialization functions, used to save out the components, if you don't need to worry about serializing or deserializing stuff you can ignore it
 	SerializeComponent serialize;
+
+	// created from serialize by ecps_CompileComponentSerialization( ), the hash is 0 if it isn't being used
+	SerializerSchema schema;
 };
 
 #endif // inclusion guard
\ No newline at end of file
@@ -26,6 +26,7 @@ ComponentID ecps_ct_AddType( ComponentTypeCollection* ctc, const char* name, uin
 	newType.cleanUp = cleanUp;
 	newType.version = version;
 	newType.serialize = NULL;
+	memset( &( newType.schema ), 0, sizeof( newType.schema ) );
 
 	if( name != NULL ) {
 		strncpy( newType.name, name, sizeof( newType.name ) - 1 );
@@ -68,6 +69,9 @@ void ecps_ct_CreateBitFlags( ComponentBitFlags* outFlags, int numComponents, ...
 
 void ecps_ct_CleanUp( ComponentTypeCollection* ctc )
 {
+	for( size_t i = 0; i < sb_Count( ctc->sbTypes ); ++i ) {
+		serializer_DestroySchema( &( ctc->sbTypes[i].schema ) );
+	}
 	sb_Release( ctc->sbTypes );
 }
 
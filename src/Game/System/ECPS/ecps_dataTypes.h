@@ -23,6 +23,12 @@ typedef struct {
 
 	ComponentID ecpsComponentID; // this is used internally while serializing and deserializing
 	bool used; // whether the component is used during the serialization
+
+	// if the component type has a compiled schema the components are stored packed instead of going through the
+	//  serialize function, the hash is 0 if they aren't, see serializer_CompileSchema( )
+	uint64_t schemaHash;
+	struct SerializedField* sbSchemaFields; // fields the packed data was written with
+	struct SerializerOp* sbReadOps; // created when loading if the schema is different from the current one
 } SerializedComponentInfo;
 
 typedef struct {
@@ -44,6 +50,10 @@ typedef struct {
 typedef struct {
 	SerializedComponentInfo* sbCompInfos;
 	SerializedEntityInfo* sbEntityInfos;
+
+	// components with a compiled schema all point into this instead of being allocated separately
+	uint8_t* packedData;
+	size_t packedDataSize;
 } SerializedECPS;
 
 typedef struct {
@@ -104,17 +104,32 @@ void ecps_InitSerialized( SerializedECPS* serializedECPS )
 {
 	serializedECPS->sbCompInfos = NULL;
 	serializedECPS->sbEntityInfos = NULL;
+	serializedECPS->packedData = NULL;
+	serializedECPS->packedDataSize = 0;
 }
 
 void ecps_CleanSerialized( SerializedECPS* serializedECPS )
 {
+	for( size_t i = 0; i < sb_Count( serializedECPS->sbCompInfos ); ++i ) {
+		sb_Release( serializedECPS->sbCompInfos[i].sbSchemaFields );
+		sb_Release( serializedECPS->sbCompInfos[i].sbReadOps );
+	}
 	for( size_t i = 0; i < sb_Count( serializedECPS->sbEntityInfos ); ++i ) {
 		for( size_t a = 0; a < sb_Count( serializedECPS->sbEntityInfos[i].sbCompData ); ++a ) {
-			mem_Release( serializedECPS->sbEntityInfos[i].sbCompData[a].data );
+			uint8_t* data = serializedECPS->sbEntityInfos[i].sbCompData[a].data;
+			if( ( data < serializedECPS->packedData ) || ( data >= ( serializedECPS->packedData + serializedECPS->packedDataSize ) ) ) {
+				mem_Release( data );
+			}
 		}
+		sb_Release( serializedECPS->sbEntityInfos[i].sbCompData );
 	}
 	sb_Release( serializedECPS->sbCompInfos );
 	sb_Release( serializedECPS->sbEntityInfos );
+	mem_Release( serializedECPS->packedData );
+	serializedECPS->sbCompInfos = NULL;
+	serializedECPS->sbEntityInfos = NULL;
+	serializedECPS->packedData = NULL;
+	serializedECPS->packedDataSize = 0;
 }
 
 static SerializedComponentInfo* generateSerializedComponentInfo( const ECPS* ecps )
@@ -138,6 +153,16 @@ static SerializedComponentInfo* generateSerializedComponentInfo( const ECPS* ecp
 
 		newInfo.used = false;
 
+		newInfo.schemaHash = sbTypes[i].schema.hash;
+		newInfo.sbSchemaFields = NULL;
+		newInfo.sbReadOps = NULL;
+		if( newInfo.schemaHash != 0 ) {
+			size_t numFields = sb_Count( sbTypes[i].schema.sbFields );
+			if( numFields > 0 ) {
+				SDL_memcpy( sb_Add( newInfo.sbSchemaFields, numFields ), sbTypes[i].schema.sbFields, sizeof( SerializedField ) * numFields );
+			}
+		}
+
 		sb_Push( sbInfos, newInfo );
 	}
 
@@ -165,8 +190,27 @@ static SerializedEntityInfo* generateSerializedEntityInfo( const ECPS* ecps )
 	return sbInfos;
 }
 
-static void generateSerializedComponents( const ECPS* ecps, SerializedEntityInfo* sbEntityInfos, SerializedComponentInfo* sbComponentInfos )
+// the total size of all the packed components, so they can all be put in one allocation
+static size_t calculatePackedComponentsSize( const ECPS* ecps, SerializedEntityInfo* sbEntityInfos )
 {
+	size_t total = 0;
+	for( ComponentID compID = 0; compID < sb_Count( ecps->componentTypes.sbTypes ); ++compID ) {
+		const SerializerSchema* schema = ecps_GetComponentSchema( ecps, compID );
+		if( ( compID == sharedComponent_ID ) || ( schema == NULL ) ) continue;
+
+		for( size_t i = 0; i < sb_Count( sbEntityInfos ); ++i ) {
+			if( ecps_DoesEntityHaveComponentByID( ecps, sbEntityInfos[i].ecpsEntityID, compID ) ) {
+				total += schema->packedSize;
+			}
+		}
+	}
+	return total;
+}
+
+static void generateSerializedComponents( const ECPS* ecps, SerializedEntityInfo* sbEntityInfos, SerializedComponentInfo* sbComponentInfos, uint8_t* packedData )
+{
+	uint8_t* nextPacked = packedData;
+
 	for( size_t i = 0; i < sb_Count( sbEntityInfos ); ++i ) {
 		EntityID entityID = sbEntityInfos[i].ecpsEntityID;
 
@@ -181,25 +225,34 @@ static void generateSerializedComponents( const ECPS* ecps, SerializedEntityInfo
 			void* compData = NULL;
 			if( ecps_GetComponentFromEntityByID( ecps, entityID, compID, &compData ) ) {
 
-				// find internal id for component
+				// the component infos are created in the same order as the component types
 				SerializedComponent serializedComp;
-				for( size_t x = 0; x < sb_Count( sbComponentInfos ); ++x ) {
-					if( SDL_strcmp( sbComponentInfos[x].externalID, ecps->componentTypes.sbTypes[compID].name ) == 0 ) {
-						serializedComp.internalCompID = sbComponentInfos[x].internalID;
-
-						// make the component type as used, later when we save it out we can cull all those that don't have this flag set
-						sbComponentInfos[x].used = true;
+				serializedComp.internalCompID = sbComponentInfos[compID].internalID;
 
-						break;
-					}
-				}
+				// make the component type as used, later when we save it out we can cull all those that don't have this flag set
+				sbComponentInfos[compID].used = true;
 
 				// store the data, we're not cleaning up the buffer after because we're relying on it's allocated buffer to store data
 				ByteBuffer buffer;
 				buffer_Init( &buffer );
 
+				const SerializerSchema* schema = ecps_GetComponentSchema( ecps, compID );
 				SerializeComponent serialize = ecps_GetComponentSerializationFunction( ecps, compID );
-				if( serialize != NULL ) {
+				if( ( schema != NULL ) && ( nextPacked != NULL ) ) {
+					// compiled, just copy the fields out
+					buffer.data = nextPacked;
+					buffer.size = schema->packedSize;
+					buffer.pos = schema->packedSize;
+					nextPacked += schema->packedSize;
+
+					Serializer s;
+					serializer_SetEntityInfo( sbEntityInfos, &s );
+					if( !serializer_WritePacked( schema, compData, &( s.entityAccessor ), buffer.data ) ) {
+						llog( LOG_ERROR, "Error packing component %s in entity %0x", ecps->componentTypes.sbTypes[compID].name, entityID );
+					}
+				} else if( schema != NULL ) {
+					llog( LOG_ERROR, "No packed data for component %s in entity %0x", ecps->componentTypes.sbTypes[compID].name, entityID );
+				} else if( serialize != NULL ) {
 					cmp_ctx_t ctx;
 					cmp_init( &ctx, &buffer, serializationReader, serializationSkipper, serializationWriter );
 					Serializer s;
@@ -227,13 +280,27 @@ void ecps_GenerateSerializedECPS( const ECPS* ecps, SerializedECPS* serializedEC
 
 	serializedECPS->sbCompInfos = generateSerializedComponentInfo( ecps );
 	serializedECPS->sbEntityInfos = generateSerializedEntityInfo( ecps );
-	generateSerializedComponents( ecps, serializedECPS->sbEntityInfos, serializedECPS->sbCompInfos );
+
+	// every allocation has a cost, so the packed components all share one
+	serializedECPS->packedDataSize = calculatePackedComponentsSize( ecps, serializedECPS->sbEntityInfos );
+	serializedECPS->packedData = NULL;
+	if( serializedECPS->packedDataSize > 0 ) {
+		serializedECPS->packedData = mem_Allocate( serializedECPS->packedDataSize );
+		if( serializedECPS->packedData == NULL ) {
+			llog( LOG_ERROR, "Unable to allocate %zu bytes for packed components", serializedECPS->packedDataSize );
+			serializedECPS->packedDataSize = 0;
+		}
+	}
+
+	generateSerializedComponents( ecps, serializedECPS->sbEntityInfos, serializedECPS->sbCompInfos, serializedECPS->packedData );
 }
 
 static bool deserializeMapComponentTypes( const ECPS* ecps, SerializedComponentInfo* sbComponentInfos )
 {
 	// make sure all the components in the stored sbComponentInfos exist
 	for( size_t i = 0; i < sb_Count( sbComponentInfos ); ++i ) {
+		sb_Release( sbComponentInfos[i].sbReadOps );
+
 		// may have been from a set of component infos just created, if it's not used then skip past it
 		if( !sbComponentInfos[i].used ) continue;
 
@@ -251,6 +318,20 @@ static bool deserializeMapComponentTypes( const ECPS* ecps, SerializedComponentI
 					llog( LOG_DEBUG, "Component %s mapped to component id %u", sbComponentInfos[i].externalID, compID );
 					sbComponentInfos[i].ecpsComponentID = compID;
 				}
+
+				// packed components need a schema to read them, if it's changed since they were written match up the fields by name
+				if( sbComponentInfos[i].schemaHash != 0 ) {
+					const SerializerSchema* schema = ecps_GetComponentSchema( ecps, compID );
+					if( schema == NULL ) {
+						// the saved fields are passed to the serialize function by name instead
+						llog( LOG_WARN, "Component %s was saved packed but doesn't have a compiled schema anymore, reading %u saved fields by name.",
+							sbComponentInfos[i].externalID, (uint32_t)sb_Count( sbComponentInfos[i].sbSchemaFields ) );
+					} else if( schema->hash != sbComponentInfos[i].schemaHash ) {
+						uint32_t numMatched = serializer_MatchSchema( schema, sbComponentInfos[i].sbSchemaFields, &( sbComponentInfos[i].sbReadOps ) );
+						llog( LOG_WARN, "Schema for component %s has changed, %u of %u saved fields found.", sbComponentInfos[i].externalID,
+							numMatched, (uint32_t)sb_Count( sbComponentInfos[i].sbSchemaFields ) );
+					}
+				}
 			}
 		}
 
@@ -317,7 +398,26 @@ static bool deserializeEntityComponents( ECPS* ecps, SerializedEntityInfo* sbEnt
 			}
 
 			SerializeComponent deserialize = ecps->componentTypes.sbTypes[info.ecpsComponentID].serialize;
-			if( deserialize != NULL ) {
+			if( ( info.schemaHash != 0 ) && ( ecps_GetComponentSchema( ecps, info.ecpsComponentID ) == NULL ) ) {
+				if( deserialize != NULL ) {
+					PackedFieldReader reader;
+					Serializer s;
+					serializer_CreateReadPackedFields( &reader, info.sbSchemaFields, sbEntityInfos[i].sbCompData[a].data, sbEntityInfos[i].sbCompData[a].dataSize, &s );
+					serializer_SetEntityInfo( sbEntityInfos, &s );
+					if( !deserialize( &s, compData ) ) {
+						llog( LOG_ERROR, "Error reading packed component %s by name in deserialized entity.", info.externalID );
+					}
+				} else {
+					llog( LOG_WARN, "Component %s was saved packed but doesn't have a way to read it anymore, leaving it zeroed.", info.externalID );
+				}
+			} else if( info.schemaHash != 0 ) {
+				const SerializerOp* sbOps = ( info.sbReadOps != NULL ) ? info.sbReadOps : ecps->componentTypes.sbTypes[info.ecpsComponentID].schema.sbOps;
+				Serializer s;
+				serializer_SetEntityInfo( sbEntityInfos, &s );
+				if( !serializer_ReadPacked( sbOps, sbEntityInfos[i].sbCompData[a].data, sbEntityInfos[i].sbCompData[a].dataSize, &( s.entityAccessor ), compData ) ) {
+					llog( LOG_ERROR, "Error unpacking component %s in deserialized entity.", info.externalID );
+				}
+			} else if( deserialize != NULL ) {
 				// create the cmp context to read from
 				cmp_ctx_t cmp;
 				ByteBuffer dataBuffer;
@@ -374,6 +474,25 @@ void ecps_CreateEntitiesFromSerializedComponents( ECPS* ecps, SerializedECPS* se
 uint32_t ecps_GetLocalIDFromSerializeEntityID( SerializedEntityInfo* sbEntityInfos, EntityID id )
 {
 	// returns 0 if it isn't able to find the entity with the id
+	if( id == INVALID_ENTITY_ID ) return 0;
+
+	// ecps_GenerateSerializedECPS( ) creates the infos in order of the entity index, so try searching for it first
+	size_t count = sb_Count( sbEntityInfos );
+	uint16_t index = idSet_GetIndex( id );
+	size_t low = 0;
+	size_t high = count;
+	while( low < high ) {
+		size_t mid = low + ( ( high - low ) / 2 );
+		if( idSet_GetIndex( sbEntityInfos[mid].ecpsEntityID ) < index ) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	if( ( low < count ) && ( sbEntityInfos[low].ecpsEntityID == id ) ) {
+		return sbEntityInfos[low].internalID;
+	}
+
 	for( size_t i = 0; i < sb_Count( sbEntityInfos ); ++i ) {
 		if( sbEntityInfos[i].ecpsEntityID == id ) {
 			return sbEntityInfos[i].internalID;
@@ -386,6 +505,13 @@ uint32_t ecps_GetLocalIDFromSerializeEntityID( SerializedEntityInfo* sbEntityInf
 EntityID ecps_GetEntityIDfromSerializedLocalID( SerializedEntityInfo* sbEntityInfos, uint32_t id )
 {
 	// returns INVALID_ENTITY_ID if it isn't able to find the entity with the local id
+	if( id == 0 ) return INVALID_ENTITY_ID;
+
+	// local ids are usually handed out in order starting at 1
+	if( ( id <= sb_Count( sbEntityInfos ) ) && ( sbEntityInfos[id - 1].internalID == id ) ) {
+		return sbEntityInfos[id - 1].ecpsEntityID;
+	}
+
 	for( size_t i = 0; i < sb_Count( sbEntityInfos ); ++i ) {
 		if( sbEntityInfos[i].internalID == id ) {
 			return sbEntityInfos[i].ecpsEntityID;
@@ -429,6 +555,23 @@ size_t serializationFileWriter( struct cmp_ctx_s* ctx, const void* data, size_t
 
 //***************************************************************
 
+// files start with this, the ones from before there was a version start with the array of component infos instead
+#define SERIALIZED_ECPS_FILE_VERSION 1
+
+static bool writeSchemaFields( cmp_ctx_t* cmp, const SerializedField* sbFields )
+{
+	if( !cmp_write_array( cmp, (uint32_t)sb_Count( sbFields ) ) ) {
+		return false;
+	}
+
+	for( size_t i = 0; i < sb_Count( sbFields ); ++i ) {
+		if( !cmp_write_str( cmp, sbFields[i].name, (uint32_t)SDL_strlen( sbFields[i].name ) ) ) return false;
+		if( !cmp_write_u8( cmp, (uint8_t)sbFields[i].type ) ) return false;
+	}
+
+	return true;
+}
+
 // save and load to external files
 bool ecps_SaveSerializedECPS( const char* fileName, SerializedECPS* serializedECPS )
 {
@@ -445,6 +588,11 @@ bool ecps_SaveSerializedECPS( const char* fileName, SerializedECPS* serializedEC
 	cmp_init( &cmp, ioStream, serializationFileReader, serializationFileSkipper, serializationFileWriter );
 	bool done = false;
 
+	if( !cmp_write_u32( &cmp, SERIALIZED_ECPS_FILE_VERSION ) ) {
+		llog( LOG_ERROR, "Unable to write file version: %s", cmp_strerror( &cmp ) );
+		goto clean_up;
+	}
+
 	// find the number of used components
 	uint32_t numCompInfos = 0;
 	for( uint32_t i = 0; i < sb_Count( serializedECPS->sbCompInfos ); ++i ) {
@@ -475,6 +623,16 @@ bool ecps_SaveSerializedECPS( const char* fileName, SerializedECPS* serializedEC
 			llog( LOG_ERROR, "Unable to write component external id: %s", cmp_strerror( &cmp ) );
 			goto clean_up;
 		}
+
+		// the schema the packed components were written with, so they can still be read if it changes
+		if( !cmp_write_u64( &cmp, serializedECPS->sbCompInfos[i].schemaHash ) ) {
+			llog( LOG_ERROR, "Unable to write component schema hash: %s", cmp_strerror( &cmp ) );
+			goto clean_up;
+		}
+		if( !writeSchemaFields( &cmp, serializedECPS->sbCompInfos[i].sbSchemaFields ) ) {
+			llog( LOG_ERROR, "Unable to write component schema fields: %s", cmp_strerror( &cmp ) );
+			goto clean_up;
+		}
 	}
 
 	// write out the entity info
@@ -536,12 +694,28 @@ bool ecps_LoadSerializedECPS( const char* fileName, SerializedECPS* serializedEC
 	}
 
 	bool done = false;
-	// read the component infos
+
+	// older files don't have a version, they go straight into the component infos
+	uint32_t version = 0;
 	uint32_t numCompInfos = 0;
-	if( !cmp_read_array( &cmp, &numCompInfos ) ) {
-		llog( LOG_ERROR, "Unable to read component type count: %s", cmp_strerror( &cmp ) );
+	cmp_object_t firstObj;
+	if( !cmp_read_object( &cmp, &firstObj ) ) {
+		llog( LOG_ERROR, "Unable to read file version: %s", cmp_strerror( &cmp ) );
+		goto clean_up;
+	}
+	if( cmp_object_is_array( &firstObj ) ) {
+		cmp_object_as_array( &firstObj, &numCompInfos );
+	} else if( cmp_object_as_uint( &firstObj, &version ) && ( version <= SERIALIZED_ECPS_FILE_VERSION ) ) {
+		if( !cmp_read_array( &cmp, &numCompInfos ) ) {
+			llog( LOG_ERROR, "Unable to read component type count: %s", cmp_strerror( &cmp ) );
+			goto clean_up;
+		}
+	} else {
+		llog( LOG_ERROR, "Unknown file version for %s", fileName );
 		goto clean_up;
 	}
+
+	// read the component infos
 	for( uint32_t i = 0; i < numCompInfos; ++i ) {
 		SerializedComponentInfo compInfo;
 		if( !cmp_read_u32( &cmp, &( compInfo.internalID ) ) ) {
@@ -561,9 +735,43 @@ bool ecps_LoadSerializedECPS( const char* fileName, SerializedECPS* serializedEC
 
 		compInfo.ecpsComponentID = INVALID_COMPONENT_ID;
 		compInfo.used = true;
+		compInfo.schemaHash = 0;
+		compInfo.sbSchemaFields = NULL;
+		compInfo.sbReadOps = NULL;
 
+		// push it now so the fields get cleaned up if something fails
 		sb_Push( serializedECPS->sbCompInfos, compInfo );
 
+		if( version >= 1 ) {
+			SerializedComponentInfo* info = &sb_Last( serializedECPS->sbCompInfos );
+			if( !cmp_read_u64( &cmp, &( info->schemaHash ) ) ) {
+				llog( LOG_ERROR, "Unable to read component schema hash: %s", cmp_strerror( &cmp ) );
+				goto clean_up;
+			}
+
+			uint32_t numFields = 0;
+			if( !cmp_read_array( &cmp, &numFields ) ) {
+				llog( LOG_ERROR, "Unable to read component schema field count: %s", cmp_strerror( &cmp ) );
+				goto clean_up;
+			}
+			for( uint32_t f = 0; f < numFields; ++f ) {
+				SerializedField field;
+				SDL_zero( field );
+				uint32_t nameSize = (uint32_t)ARRAY_SIZE( field.name );
+				uint8_t type;
+				if( !cmp_read_str( &cmp, field.name, &nameSize ) || !cmp_read_u8( &cmp, &type ) ) {
+					llog( LOG_ERROR, "Unable to read component schema field: %s", cmp_strerror( &cmp ) );
+					goto clean_up;
+				}
+				if( type > SFT_IMAGE_ID ) {
+					llog( LOG_ERROR, "Unknown schema field type %u for component %s", type, info->externalID );
+					goto clean_up;
+				}
+				field.type = (SerializedFieldType)type;
+				sb_Push( info->sbSchemaFields, field );
+			}
+		}
+
 		llog( LOG_DEBUG, "Read in component info - internal id: %u, external version: %u, external id: %s", compInfo.internalID, compInfo.externalVersion, compInfo.externalID );
 	}
 
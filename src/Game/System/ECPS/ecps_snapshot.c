@@ -0,0 +1,972 @@
+#include "ecps_snapshot.h"
+
+#include <stdio.h>
+#include <SDL3/SDL.h>
+
+#include "entityComponentProcessSystem.h"
+#include "ecps_componentBitFlags.h"
+#include "ecps_componentTypes.h"
+
+#include "Math/mathUtil.h"
+#include "System/mappedFile.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "System/serializer.h"
+#include "Others/cmp.h"
+#include "Utils/helpers.h"
+#include "Utils/stretchyBuffer.h"
+
+// Everything is stored in flat arrays that are used straight out of the mapped file. Each packaged component array is
+//  an archetype, its entities are stored exactly as they're laid out in the ECPS except that only the fields the
+//  component schemas know about are kept, and entity ids are replaced by local ids. Local ids are handed out in the order
+//  the entities are stored starting at 1, so remapping them when loading is a lookup in an array. The relocations
+//  are the offsets in each entity that hold a local id, the entity's own id at the start of it isn't included.
+//  Component types without a compiled schema are left zeroed in the blocks and written through their serialize function
+//  into a blob instead, with a record for each of them in each entity. The records for an archetype are stored entity
+//  by entity, in the order the columns are.
+//  All values are little endian, every section starts on a SNAPSHOT_ALIGNMENT boundary.
+
+#define SNAPSHOT_MAGIC 0x53534345 // "ECSS"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_ALIGNMENT 16
+#define SNAPSHOT_NAME_SIZE 40
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t numComponentTypes;
+	uint32_t numFields;
+	uint32_t numColumns;
+	uint32_t numArchetypes;
+	uint32_t numRelocations;
+	uint32_t numRecords;
+	uint32_t numEntities;
+	uint32_t reserved;
+	uint64_t fileSize;
+	uint64_t componentTypesOffset; // SnapshotComponentType[numComponentTypes]
+	uint64_t fieldsOffset; // SnapshotField[numFields]
+	uint64_t columnsOffset; // SnapshotColumn[numColumns]
+	uint64_t archetypesOffset; // SnapshotArchetype[numArchetypes]
+	uint64_t relocationsOffset; // uint32_t[numRelocations]
+	uint64_t recordsOffset; // SnapshotRecord[numRecords]
+	uint64_t blobOffset;
+	uint64_t blobSize;
+} SnapshotHeader;
+
+typedef struct {
+	char name[SNAPSHOT_NAME_SIZE];
+	uint32_t version;
+	uint32_t size;
+	uint32_t firstField;
+	uint32_t numFields;
+	uint64_t schemaHash; // 0 if the component type doesn't have any data or is stored in the blob
+} SnapshotComponentType;
+
+typedef struct {
+	char name[MAX_SERIALIZED_FIELD_NAME_SIZE + 1];
+	uint32_t type;
+	uint32_t offset;
+} SnapshotField;
+
+typedef struct {
+	uint32_t componentType;
+	uint32_t offset; // from the start of each entity
+} SnapshotColumn;
+
+typedef struct {
+	uint32_t entitySize;
+	uint32_t numEntities;
+	uint32_t firstLocalID;
+	uint32_t firstColumn;
+	uint32_t numColumns;
+	uint32_t firstRelocation;
+	uint32_t numRelocations;
+	uint32_t firstRecord; // numEntities * the number of columns stored in the blob
+	uint64_t dataOffset; // entitySize * numEntities
+} SnapshotArchetype;
+
+typedef struct {
+	uint32_t offset; // from the start of the blob
+	uint32_t size;
+} SnapshotRecord;
+
+SDL_COMPILE_TIME_ASSERT( snapshotHeaderSize, sizeof( SnapshotHeader ) == 112 );
+SDL_COMPILE_TIME_ASSERT( snapshotComponentTypeSize, sizeof( SnapshotComponentType ) == 64 );
+SDL_COMPILE_TIME_ASSERT( snapshotFieldSize, sizeof( SnapshotField ) == 72 );
+SDL_COMPILE_TIME_ASSERT( snapshotColumnSize, sizeof( SnapshotColumn ) == 8 );
+SDL_COMPILE_TIME_ASSERT( snapshotArchetypeSize, sizeof( SnapshotArchetype ) == 40 );
+SDL_COMPILE_TIME_ASSERT( snapshotRecordSize, sizeof( SnapshotRecord ) == 8 );
+SDL_COMPILE_TIME_ASSERT( snapshotNameSize, SNAPSHOT_NAME_SIZE > MAX_COMPONENT_NAME_SIZE );
+SDL_COMPILE_TIME_ASSERT( snapshotEntityIDSize, sizeof( EntityID ) == sizeof( uint32_t ) );
+
+static uint64_t alignSnapshotOffset( uint64_t offset )
+{
+	return ( offset + ( SNAPSHOT_ALIGNMENT - 1 ) ) & ~(uint64_t)( SNAPSHOT_ALIGNMENT - 1 );
+}
+
+static bool snapshotRangeValid( uint64_t offset, uint64_t size, uint64_t fileSize )
+{
+	return ( ( offset % SNAPSHOT_ALIGNMENT ) == 0 ) && ( offset <= fileSize ) && ( size <= ( fileSize - offset ) );
+}
+
+static bool writeSnapshotPadding( SDL_IOStream* ioStream, uint64_t* position, uint64_t target )
+{
+	static const uint8_t zeros[SNAPSHOT_ALIGNMENT] = { 0 };
+	while( (*position) < target ) {
+		size_t amount = (size_t)MIN( target - (*position), (uint64_t)sizeof( zeros ) );
+		if( SDL_WriteIO( ioStream, zeros, amount ) != amount ) return false;
+		(*position) += amount;
+	}
+	return true;
+}
+
+static bool writeSnapshotSection( SDL_IOStream* ioStream, uint64_t* position, uint64_t offset, const void* data, size_t size )
+{
+	if( !writeSnapshotPadding( ioStream, position, offset ) ) return false;
+	if( ( size > 0 ) && ( SDL_WriteIO( ioStream, data, size ) != size ) ) return false;
+	(*position) += size;
+	return true;
+}
+
+// references to entities that aren't in the ECPS anymore are saved as 0
+static uint32_t getSnapshotLocalID( const ECPS* ecps, const uint32_t* sbLocalIDs, EntityID id )
+{
+	if( ( id == INVALID_ENTITY_ID ) || !idSet_IsIDValid( &( ecps->idSet ), id ) ) return 0;
+
+	uint16_t idx = idSet_GetIndex( id );
+	return ( idx < sb_Count( sbLocalIDs ) ) ? sbLocalIDs[idx] : 0;
+}
+
+static EntityID getSnapshotEntityID( const EntityID* newIDs, uint32_t numEntities, uint32_t localID )
+{
+	return ( ( localID > 0 ) && ( localID <= numEntities ) ) ? newIDs[localID - 1] : INVALID_ENTITY_ID;
+}
+
+static bool isLiveEntity( const ECPS* ecps, const uint8_t* entityData )
+{
+	EntityID id = *( (const EntityID*)entityData );
+	return ( id != INVALID_ENTITY_ID ) && idSet_IsIDValid( &( ecps->idSet ), id );
+}
+
+// component types that have data but were saved without a schema are in the blob
+static bool isBlobComponentType( const SnapshotComponentType* type )
+{
+	return ( type->size > 0 ) && ( type->schemaHash == 0 );
+}
+
+//***************************************************************
+// Saving
+
+// adds the component type and its fields if it hasn't been already, returns the index of it in the snapshot
+static uint32_t addSnapshotComponentType( const ComponentType* type, int32_t* typeIndex, SnapshotComponentType** sbTypes, SnapshotField** sbFields )
+{
+	if( ( *typeIndex ) >= 0 ) return (uint32_t)( *typeIndex );
+
+	SnapshotComponentType newType;
+	SDL_memset( &newType, 0, sizeof( newType ) );
+	SDL_strlcpy( newType.name, type->name, sizeof( newType.name ) );
+	newType.version = type->version;
+	newType.size = (uint32_t)type->size;
+	newType.firstField = (uint32_t)sb_Count( *sbFields );
+	newType.numFields = (uint32_t)sb_Count( type->schema.sbFields );
+	newType.schemaHash = type->schema.hash;
+
+	for( size_t i = 0; i < sb_Count( type->schema.sbFields ); ++i ) {
+		SnapshotField field;
+		SDL_memset( &field, 0, sizeof( field ) );
+		SDL_strlcpy( field.name, type->schema.sbFields[i].name, sizeof( field.name ) );
+		field.type = (uint32_t)type->schema.sbFields[i].type;
+		field.offset = type->schema.sbFields[i].offset;
+		sb_Push( *sbFields, field );
+	}
+
+	( *typeIndex ) = (int32_t)sb_Count( *sbTypes );
+	sb_Push( *sbTypes, newType );
+	return (uint32_t)( *typeIndex );
+}
+
+// copies only the fields in the schema, so anything the schema doesn't know about (e.g. padding) is left zeroed
+static void copySchemaFields( const ECPS* ecps, const uint32_t* sbLocalIDs, const SerializerSchema* schema, const uint8_t* src, uint8_t* dest )
+{
+	for( size_t i = 0; i < sb_Count( schema->sbOps ); ++i ) {
+		const SerializerOp* op = &( schema->sbOps[i] );
+		if( op->type == SOT_COPY ) {
+			SDL_memcpy( dest + op->dataOffset, src + op->dataOffset, op->size );
+		} else {
+			EntityID id;
+			SDL_memcpy( &id, src + op->dataOffset, sizeof( id ) );
+			uint32_t localID = getSnapshotLocalID( ecps, sbLocalIDs, id );
+			SDL_memcpy( dest + op->dataOffset, &localID, sizeof( localID ) );
+		}
+	}
+}
+
+typedef struct {
+	const ECPS* ecps;
+	const uint32_t* sbLocalIDs;
+} SnapshotSaveIDs;
+
+static bool snapshotSaveGetEntityID( struct EntityAccessor* a, uint32_t localID, EntityID* outID )
+{
+	// only used for writing
+	return false;
+}
+
+static bool snapshotSaveGetLocalID( struct EntityAccessor* a, EntityID id, uint32_t* outID )
+{
+	ASSERT_AND_IF_NOT( a != NULL ) return false;
+	ASSERT_AND_IF_NOT( a->ctx != NULL ) return false;
+	ASSERT_AND_IF_NOT( outID != NULL ) return false;
+
+	SnapshotSaveIDs* ids = (SnapshotSaveIDs*)( a->ctx );
+	( *outID ) = getSnapshotLocalID( ids->ecps, ids->sbLocalIDs, id );
+	return true;
+}
+
+static size_t snapshotBlobWriter( struct cmp_ctx_s* ctx, const void* data, size_t count )
+{
+	uint8_t** sbBlob = (uint8_t**)( ctx->buf );
+	SDL_memcpy( sb_Add( *sbBlob, count ), data, count );
+	return count;
+}
+
+// writes the component through its serialize function, image ids and callbacks are stored by name
+static bool writeSnapshotRecord( const ComponentType* type, void* compData, SnapshotSaveIDs* ids, uint8_t** sbBlob, SnapshotRecord* outRecord )
+{
+	outRecord->offset = (uint32_t)sb_Count( *sbBlob );
+	outRecord->size = 0;
+
+	// nothing to write it with, it will be zeroed when loaded
+	if( type->serialize == NULL ) return true;
+
+	cmp_ctx_t cmp;
+	cmp_init( &cmp, sbBlob, NULL, NULL, snapshotBlobWriter );
+	Serializer s;
+	serializer_CreateWriteCmp( &cmp, &s );
+	s.entityAccessor.ctx = ids;
+	s.entityAccessor.getEntityID = snapshotSaveGetEntityID;
+	s.entityAccessor.getLocalID = snapshotSaveGetLocalID;
+
+	if( !type->serialize( &s, compData ) ) {
+		llog( LOG_ERROR, "Error serializing component %s: %s", type->name, cmp_strerror( &cmp ) );
+		return false;
+	}
+
+	if( sb_Count( *sbBlob ) > UINT32_MAX ) {
+		llog( LOG_ERROR, "Too much serialized component data for a snapshot." );
+		return false;
+	}
+
+	outRecord->size = (uint32_t)( sb_Count( *sbBlob ) - outRecord->offset );
+	return true;
+}
+
+bool ecps_SaveSnapshot( const ECPS* ecps, const char* fileName )
+{
+	ASSERT_AND_IF_NOT( ecps != NULL ) return false;
+	ASSERT_AND_IF_NOT( fileName != NULL ) return false;
+	ASSERT_AND_IF_NOT( !ecps->isRunningProcess ) return false;
+
+	bool done = false;
+
+	uint32_t* sbLocalIDs = NULL; // by entity index
+	uint32_t* sbArrayCounts = NULL;
+	SnapshotComponentType* sbTypes = NULL;
+	SnapshotField* sbFields = NULL;
+	SnapshotColumn* sbColumns = NULL;
+	SnapshotArchetype* sbArchetypes = NULL;
+	uint32_t* sbRelocations = NULL;
+	SnapshotRecord* sbRecords = NULL;
+	uint8_t* sbData = NULL; // all the archetype blocks, offsets in it are relative to the first block
+	uint8_t* sbBlob = NULL;
+	char* tempFileName = NULL;
+	SDL_IOStream* ioStream = NULL;
+
+	const ComponentData* compData = &( ecps->componentData );
+	const ComponentType* ecpsTypes = ecps->componentTypes.sbTypes;
+	size_t numECPSTypes = sb_Count( ecpsTypes );
+
+	int32_t typeIndices[MAX_NUM_COMPONENT_TYPES];
+	for( size_t i = 0; i < MAX_NUM_COMPONENT_TYPES; ++i ) {
+		typeIndices[i] = -1;
+	}
+
+	SnapshotSaveIDs saveIDs;
+	saveIDs.ecps = ecps;
+
+	// number the entities in the order they'll be stored
+	size_t directorySize = sb_Count( compData->sbEntityDirectory );
+	if( directorySize > 0 ) {
+		SDL_memset( sb_Add( sbLocalIDs, directorySize ), 0, sizeof( uint32_t ) * directorySize );
+	}
+	uint32_t numEntities = 0;
+	for( size_t a = 0; a < sb_Count( compData->sbComponentArrays ); ++a ) {
+		const PackagedComponentArray* pca = &( compData->sbComponentArrays[a] );
+		uint32_t count = 0;
+		for( size_t offset = 0; offset < sb_Count( pca->sbData ); offset += pca->entitySize ) {
+			if( isLiveEntity( ecps, &( pca->sbData[offset] ) ) ) {
+				++numEntities;
+				++count;
+				sbLocalIDs[idSet_GetIndex( *( (const EntityID*)( &( pca->sbData[offset] ) ) ) )] = numEntities;
+			}
+		}
+		sb_Push( sbArrayCounts, count );
+	}
+	saveIDs.sbLocalIDs = sbLocalIDs;
+
+	uint32_t firstLocalID = 1;
+	for( size_t a = 0; a < sb_Count( compData->sbComponentArrays ); ++a ) {
+		const PackagedComponentArray* pca = &( compData->sbComponentArrays[a] );
+		if( sbArrayCounts[a] == 0 ) continue;
+
+		SnapshotArchetype archetype;
+		SDL_memset( &archetype, 0, sizeof( archetype ) );
+		archetype.entitySize = (uint32_t)pca->entitySize;
+		archetype.numEntities = sbArrayCounts[a];
+		archetype.firstLocalID = firstLocalID;
+		archetype.firstColumn = (uint32_t)sb_Count( sbColumns );
+		archetype.firstRelocation = (uint32_t)sb_Count( sbRelocations );
+		archetype.firstRecord = (uint32_t)sb_Count( sbRecords );
+		firstLocalID += sbArrayCounts[a];
+
+		ComponentID columnIDs[MAX_NUM_COMPONENT_TYPES];
+		ComponentID blobColumnIDs[MAX_NUM_COMPONENT_TYPES];
+		uint32_t numBlobColumns = 0;
+		for( ComponentID compID = 0; compID < numECPSTypes; ++compID ) {
+			if( ( compID == sharedComponent_ID ) || ( pca->structure.entries[compID].offset < 0 ) ) continue;
+
+			const ComponentType* type = &( ecpsTypes[compID] );
+			if( ( type->size > 0 ) && ( type->schema.hash == 0 ) ) {
+				blobColumnIDs[numBlobColumns++] = compID;
+			}
+
+			SnapshotColumn column;
+			column.componentType = addSnapshotComponentType( type, &( typeIndices[compID] ), &sbTypes, &sbFields );
+			column.offset = (uint32_t)pca->structure.entries[compID].offset;
+			sb_Push( sbColumns, column );
+			columnIDs[sb_Count( sbColumns ) - 1 - archetype.firstColumn] = compID;
+
+			for( size_t i = 0; i < sb_Count( type->schema.sbOps ); ++i ) {
+				if( type->schema.sbOps[i].type == SOT_ENTITY_ID ) {
+					sb_Push( sbRelocations, column.offset + type->schema.sbOps[i].dataOffset );
+				}
+			}
+		}
+		archetype.numColumns = (uint32_t)sb_Count( sbColumns ) - archetype.firstColumn;
+		archetype.numRelocations = (uint32_t)sb_Count( sbRelocations ) - archetype.firstRelocation;
+
+		// copy the entities over, only keeping what the schemas know about
+		size_t blockStart = (size_t)alignSnapshotOffset( sb_Count( sbData ) );
+		size_t blockSize = pca->entitySize * sbArrayCounts[a];
+		sb_Add( sbData, ( blockStart - sb_Count( sbData ) ) + blockSize );
+		SDL_memset( sbData + blockStart, 0, blockSize );
+		archetype.dataOffset = blockStart;
+
+		uint8_t* dest = sbData + blockStart;
+		for( size_t offset = 0; offset < sb_Count( pca->sbData ); offset += pca->entitySize ) {
+			const uint8_t* src = &( pca->sbData[offset] );
+			if( !isLiveEntity( ecps, src ) ) continue;
+
+			uint32_t localID = getSnapshotLocalID( ecps, sbLocalIDs, *( (const EntityID*)src ) );
+			SDL_memcpy( dest, &localID, sizeof( localID ) );
+
+			for( uint32_t c = 0; c < archetype.numColumns; ++c ) {
+				uint32_t offset = sbColumns[archetype.firstColumn + c].offset;
+				copySchemaFields( ecps, sbLocalIDs, &( ecpsTypes[columnIDs[c]].schema ), src + offset, dest + offset );
+			}
+
+			// anything without a schema goes in the blob
+			for( uint32_t c = 0; c < numBlobColumns; ++c ) {
+				const ComponentType* type = &( ecpsTypes[blobColumnIDs[c]] );
+				void* compData = (void*)( src + pca->structure.entries[blobColumnIDs[c]].offset );
+				SnapshotRecord record;
+				if( !writeSnapshotRecord( type, compData, &saveIDs, &sbBlob, &record ) ) {
+					llog( LOG_ERROR, "Unable to save snapshot %s.", fileName );
+					goto clean_up;
+				}
+				sb_Push( sbRecords, record );
+			}
+
+			dest += pca->entitySize;
+		}
+
+		sb_Push( sbArchetypes, archetype );
+	}
+
+	// lay out all the sections
+	SnapshotHeader header;
+	SDL_memset( &header, 0, sizeof( header ) );
+	header.magic = SNAPSHOT_MAGIC;
+	header.version = SNAPSHOT_VERSION;
+	header.numComponentTypes = (uint32_t)sb_Count( sbTypes );
+	header.numFields = (uint32_t)sb_Count( sbFields );
+	header.numColumns = (uint32_t)sb_Count( sbColumns );
+	header.numArchetypes = (uint32_t)sb_Count( sbArchetypes );
+	header.numRelocations = (uint32_t)sb_Count( sbRelocations );
+	header.numRecords = (uint32_t)sb_Count( sbRecords );
+	header.numEntities = numEntities;
+	header.componentTypesOffset = alignSnapshotOffset( sizeof( SnapshotHeader ) );
+	header.fieldsOffset = alignSnapshotOffset( header.componentTypesOffset + ( sizeof( SnapshotComponentType ) * header.numComponentTypes ) );
+	header.columnsOffset = alignSnapshotOffset( header.fieldsOffset + ( sizeof( SnapshotField ) * header.numFields ) );
+	header.archetypesOffset = alignSnapshotOffset( header.columnsOffset + ( sizeof( SnapshotColumn ) * header.numColumns ) );
+	header.relocationsOffset = alignSnapshotOffset( header.archetypesOffset + ( sizeof( SnapshotArchetype ) * header.numArchetypes ) );
+
+	header.recordsOffset = alignSnapshotOffset( header.relocationsOffset + ( sizeof( uint32_t ) * header.numRelocations ) );
+
+	uint64_t dataStart = alignSnapshotOffset( header.recordsOffset + ( sizeof( SnapshotRecord ) * header.numRecords ) );
+	for( size_t i = 0; i < sb_Count( sbArchetypes ); ++i ) {
+		sbArchetypes[i].dataOffset += dataStart;
+	}
+	header.blobOffset = alignSnapshotOffset( dataStart + sb_Count( sbData ) );
+	header.blobSize = sb_Count( sbBlob );
+	header.fileSize = header.blobOffset + header.blobSize;
+
+	// write to a temporary file first so an existing snapshot isn't lost if something goes wrong
+	size_t tempFileNameLen = SDL_strlen( fileName ) + 5;
+	tempFileName = mem_Allocate( tempFileNameLen );
+	if( tempFileName == NULL ) goto clean_up;
+	SDL_snprintf( tempFileName, tempFileNameLen, "%s.tmp", fileName );
+
+	ioStream = SDL_IOFromFile( tempFileName, "wb" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open file %s: %s", tempFileName, SDL_GetError( ) );
+		goto clean_up;
+	}
+
+	uint64_t position = 0;
+	bool written =
+		writeSnapshotSection( ioStream, &position, 0, &header, sizeof( header ) ) &&
+		writeSnapshotSection( ioStream, &position, header.componentTypesOffset, sbTypes, sizeof( SnapshotComponentType ) * header.numComponentTypes ) &&
+		writeSnapshotSection( ioStream, &position, header.fieldsOffset, sbFields, sizeof( SnapshotField ) * header.numFields ) &&
+		writeSnapshotSection( ioStream, &position, header.columnsOffset, sbColumns, sizeof( SnapshotColumn ) * header.numColumns ) &&
+		writeSnapshotSection( ioStream, &position, header.archetypesOffset, sbArchetypes, sizeof( SnapshotArchetype ) * header.numArchetypes ) &&
+		writeSnapshotSection( ioStream, &position, header.relocationsOffset, sbRelocations, sizeof( uint32_t ) * header.numRelocations ) &&
+		writeSnapshotSection( ioStream, &position, header.recordsOffset, sbRecords, sizeof( SnapshotRecord ) * header.numRecords ) &&
+		writeSnapshotSection( ioStream, &position, dataStart, sbData, sb_Count( sbData ) ) &&
+		writeSnapshotSection( ioStream, &position, header.blobOffset, sbBlob, sb_Count( sbBlob ) );
+
+	bool closed = SDL_CloseIO( ioStream );
+	ioStream = NULL;
+	if( !written || !closed ) {
+		llog( LOG_ERROR, "Error writing snapshot %s: %s", tempFileName, SDL_GetError( ) );
+		remove( tempFileName );
+		goto clean_up;
+	}
+
+	if( !SDL_RenamePath( tempFileName, fileName ) ) {
+		llog( LOG_ERROR, "Unable to move %s to %s: %s", tempFileName, fileName, SDL_GetError( ) );
+		remove( tempFileName );
+		goto clean_up;
+	}
+
+	llog( LOG_DEBUG, "Saved snapshot %s: %u entities in %u archetypes, %u bytes.", fileName, numEntities, header.numArchetypes, (uint32_t)header.fileSize );
+
+	done = true;
+
+clean_up:
+	if( ioStream != NULL ) SDL_CloseIO( ioStream );
+	mem_Release( tempFileName );
+	sb_Release( sbBlob );
+	sb_Release( sbData );
+	sb_Release( sbRecords );
+	sb_Release( sbRelocations );
+	sb_Release( sbArchetypes );
+	sb_Release( sbColumns );
+	sb_Release( sbFields );
+	sb_Release( sbTypes );
+	sb_Release( sbArrayCounts );
+	sb_Release( sbLocalIDs );
+
+	return done;
+}
+
+//***************************************************************
+// Loading
+
+typedef enum {
+	SRT_NONE, // nothing saved or nothing to read it with, left zeroed
+	SRT_DIRECT, // same size and schema, can be copied as is
+	SRT_CONVERT, // schema has changed, moves the fields from where they were to where they are now
+	SRT_FIELDS_BY_NAME, // saved with a schema, but the type doesn't have one now so the fields are read through its serialize function
+	SRT_SERIALIZED // in the blob, read through its serialize function
+} SnapshotReadType;
+
+typedef struct {
+	ComponentID compID;
+	SnapshotReadType readType;
+	SerializerOp* sbConvertOps; // for SRT_CONVERT
+	SerializedField* sbSavedFields; // for SRT_CONVERT and SRT_FIELDS_BY_NAME, the fields as they were saved
+	uint8_t* sbPacked; // for SRT_FIELDS_BY_NAME, the saved fields one after the other
+} SnapshotTypeMapping;
+
+typedef struct {
+	const EntityID* newIDs;
+	uint32_t numEntities;
+} SnapshotLoadIDs;
+
+typedef struct {
+	uint32_t arrayIdx;
+	size_t firstOffset;
+} SnapshotBlock;
+
+static bool snapshotStringValid( const char* str, size_t size )
+{
+	for( size_t i = 0; i < size; ++i ) {
+		if( str[i] == 0 ) return true;
+	}
+	return false;
+}
+
+// makes sure everything the header and tables reference is inside the file, so nothing after this has to check
+static bool validateSnapshot( const char* fileName, const MappedFile* file )
+{
+	if( file->size < sizeof( SnapshotHeader ) ) {
+		llog( LOG_ERROR, "Snapshot %s is too small.", fileName );
+		return false;
+	}
+
+	const SnapshotHeader* header = (const SnapshotHeader*)file->data;
+	if( header->magic != SNAPSHOT_MAGIC ) {
+		llog( LOG_ERROR, "%s isn't a snapshot.", fileName );
+		return false;
+	}
+	if( header->version != SNAPSHOT_VERSION ) {
+		llog( LOG_ERROR, "Unknown version %u for snapshot %s", header->version, fileName );
+		return false;
+	}
+
+	uint64_t fileSize = header->fileSize;
+	if( ( fileSize > file->size ) ||
+		!snapshotRangeValid( header->componentTypesOffset, (uint64_t)header->numComponentTypes * sizeof( SnapshotComponentType ), fileSize ) ||
+		!snapshotRangeValid( header->fieldsOffset, (uint64_t)header->numFields * sizeof( SnapshotField ), fileSize ) ||
+		!snapshotRangeValid( header->columnsOffset, (uint64_t)header->numColumns * sizeof( SnapshotColumn ), fileSize ) ||
+		!snapshotRangeValid( header->archetypesOffset, (uint64_t)header->numArchetypes * sizeof( SnapshotArchetype ), fileSize ) ||
+		!snapshotRangeValid( header->relocationsOffset, (uint64_t)header->numRelocations * sizeof( uint32_t ), fileSize ) ||
+		!snapshotRangeValid( header->recordsOffset, (uint64_t)header->numRecords * sizeof( SnapshotRecord ), fileSize ) ||
+		!snapshotRangeValid( header->blobOffset, header->blobSize, fileSize ) ) {
+		llog( LOG_ERROR, "Snapshot %s is truncated or corrupt.", fileName );
+		return false;
+	}
+
+	const SnapshotComponentType* types = (const SnapshotComponentType*)( file->data + header->componentTypesOffset );
+	const SnapshotField* fields = (const SnapshotField*)( file->data + header->fieldsOffset );
+	for( uint32_t t = 0; t < header->numComponentTypes; ++t ) {
+		if( !snapshotStringValid( types[t].name, sizeof( types[t].name ) ) ||
+			( (uint64_t)types[t].firstField + types[t].numFields > header->numFields ) ) {
+			llog( LOG_ERROR, "Snapshot %s has an invalid component type.", fileName );
+			return false;
+		}
+
+		for( uint32_t f = types[t].firstField; f < ( types[t].firstField + types[t].numFields ); ++f ) {
+			if( !snapshotStringValid( fields[f].name, sizeof( fields[f].name ) ) || ( fields[f].type > SFT_IMAGE_ID ) ||
+				( (uint64_t)fields[f].offset + serializer_GetFieldTypeSize( (SerializedFieldType)fields[f].type ) > types[t].size ) ) {
+				llog( LOG_ERROR, "Snapshot %s has an invalid field in component type %s.", fileName, types[t].name );
+				return false;
+			}
+		}
+	}
+
+	const SnapshotColumn* columns = (const SnapshotColumn*)( file->data + header->columnsOffset );
+	const SnapshotArchetype* archetypes = (const SnapshotArchetype*)( file->data + header->archetypesOffset );
+	const uint32_t* relocations = (const uint32_t*)( file->data + header->relocationsOffset );
+	const SnapshotRecord* records = (const SnapshotRecord*)( file->data + header->recordsOffset );
+	for( uint32_t r = 0; r < header->numRecords; ++r ) {
+		if( (uint64_t)records[r].offset + records[r].size > header->blobSize ) {
+			llog( LOG_ERROR, "Snapshot %s has an invalid record.", fileName );
+			return false;
+		}
+	}
+
+	uint64_t totalEntities = 0;
+	for( uint32_t a = 0; a < header->numArchetypes; ++a ) {
+		totalEntities += archetypes[a].numEntities;
+	}
+	// entity ids only have 16 bits for the index
+	if( ( totalEntities != header->numEntities ) || ( header->numEntities > UINT16_MAX ) ) {
+		llog( LOG_ERROR, "Snapshot %s has an invalid number of entities.", fileName );
+		return false;
+	}
+
+	for( uint32_t a = 0; a < header->numArchetypes; ++a ) {
+		const SnapshotArchetype* archetype = &( archetypes[a] );
+		bool valid = ( archetype->entitySize >= sizeof( EntityID ) ) &&
+			( archetype->firstLocalID > 0 ) && ( (uint64_t)archetype->firstLocalID - 1 + archetype->numEntities <= header->numEntities ) &&
+			( (uint64_t)archetype->firstColumn + archetype->numColumns <= header->numColumns ) &&
+			( (uint64_t)archetype->firstRelocation + archetype->numRelocations <= header->numRelocations ) &&
+			snapshotRangeValid( archetype->dataOffset, (uint64_t)archetype->entitySize * archetype->numEntities, fileSize );
+
+		uint32_t numBlobColumns = 0;
+		for( uint32_t c = archetype->firstColumn; valid && ( c < ( archetype->firstColumn + archetype->numColumns ) ); ++c ) {
+			valid = ( columns[c].componentType < header->numComponentTypes ) &&
+				( (uint64_t)columns[c].offset + types[columns[c].componentType].size <= archetype->entitySize );
+			if( valid && isBlobComponentType( &( types[columns[c].componentType] ) ) ) {
+				++numBlobColumns;
+			}
+		}
+		valid = valid && ( (uint64_t)archetype->firstRecord + ( (uint64_t)archetype->numEntities * numBlobColumns ) <= header->numRecords );
+
+		for( uint32_t r = archetype->firstRelocation; valid && ( r < ( archetype->firstRelocation + archetype->numRelocations ) ); ++r ) {
+			valid = ( (uint64_t)relocations[r] + sizeof( uint32_t ) <= archetype->entitySize );
+		}
+
+		if( !valid ) {
+			llog( LOG_ERROR, "Snapshot %s has an invalid archetype.", fileName );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// finds the component types in the ECPS, and if any have changed how to convert them
+static bool mapSnapshotComponentTypes( ECPS* ecps, const SnapshotHeader* header, const uint8_t* data, SnapshotTypeMapping* outMappings )
+{
+	const SnapshotComponentType* types = (const SnapshotComponentType*)( data + header->componentTypesOffset );
+	const SnapshotField* fields = (const SnapshotField*)( data + header->fieldsOffset );
+
+	for( uint32_t t = 0; t < header->numComponentTypes; ++t ) {
+		SnapshotTypeMapping* mapping = &( outMappings[t] );
+
+		mapping->compID = ecps_GetComponentIDByName( ecps, types[t].name );
+		if( mapping->compID == INVALID_COMPONENT_ID ) {
+			llog( LOG_ERROR, "Unable to find component of type %s in ECPS.", types[t].name );
+			return false;
+		}
+
+		const ComponentType* type = &( ecps->componentTypes.sbTypes[mapping->compID] );
+		if( type->version != types[t].version ) {
+			llog( LOG_ERROR, "Component versions for type %s don't match.", types[t].name );
+			return false;
+		}
+
+		if( ( type->size == 0 ) || ( types[t].size == 0 ) ) {
+			mapping->readType = SRT_NONE;
+			continue;
+		}
+
+		if( isBlobComponentType( &( types[t] ) ) ) {
+			if( type->serialize != NULL ) {
+				mapping->readType = SRT_SERIALIZED;
+			} else {
+				llog( LOG_WARN, "Component %s doesn't have a serialize function anymore, leaving it zeroed.", types[t].name );
+				mapping->readType = SRT_NONE;
+			}
+			continue;
+		}
+
+		// the hash only covers the names and types, the fields also have to be where they were
+		bool direct = ( type->size == types[t].size ) && ( type->schema.hash == types[t].schemaHash ) &&
+			( sb_Count( type->schema.sbFields ) == types[t].numFields );
+		for( uint32_t f = 0; direct && ( f < types[t].numFields ); ++f ) {
+			direct = ( type->schema.sbFields[f].offset == fields[types[t].firstField + f].offset );
+		}
+		if( direct ) {
+			mapping->readType = SRT_DIRECT;
+			continue;
+		}
+
+		if( ( type->schema.hash == 0 ) && ( type->serialize == NULL ) ) {
+			llog( LOG_WARN, "Component %s was saved with a schema but doesn't have a way to read it anymore, leaving it zeroed.", types[t].name );
+			mapping->readType = SRT_NONE;
+			continue;
+		}
+
+		// match up the fields by name, the saved components are copies of the old structure
+		size_t packedSize = 0;
+		for( uint32_t f = types[t].firstField; f < ( types[t].firstField + types[t].numFields ); ++f ) {
+			SerializedField field;
+			SDL_strlcpy( field.name, fields[f].name, sizeof( field.name ) );
+			field.type = (SerializedFieldType)fields[f].type;
+			field.offset = fields[f].offset;
+			sb_Push( mapping->sbSavedFields, field );
+			packedSize += serializer_GetFieldTypeSize( field.type );
+		}
+
+		if( type->schema.hash != 0 ) {
+			mapping->readType = SRT_CONVERT;
+			uint32_t numMatched = serializer_MatchSchemaLayout( &( type->schema ), mapping->sbSavedFields, &( mapping->sbConvertOps ) );
+			llog( LOG_WARN, "Schema for component %s has changed, %u of %u saved fields found.", types[t].name, numMatched, types[t].numFields );
+		} else {
+			mapping->readType = SRT_FIELDS_BY_NAME;
+			if( packedSize > 0 ) {
+				sb_Add( mapping->sbPacked, packedSize );
+			}
+			llog( LOG_WARN, "Component %s doesn't have a compiled schema anymore, reading %u saved fields by name.", types[t].name, types[t].numFields );
+		}
+	}
+
+	return true;
+}
+
+static void remapSnapshotID( uint8_t* data, const EntityID* newIDs, uint32_t numEntities )
+{
+	uint32_t localID;
+	SDL_memcpy( &localID, data, sizeof( localID ) );
+	EntityID id = getSnapshotEntityID( newIDs, numEntities, localID );
+	SDL_memcpy( data, &id, sizeof( id ) );
+}
+
+static bool snapshotLoadGetEntityID( struct EntityAccessor* a, uint32_t localID, EntityID* outID )
+{
+	ASSERT_AND_IF_NOT( a != NULL ) return false;
+	ASSERT_AND_IF_NOT( a->ctx != NULL ) return false;
+	ASSERT_AND_IF_NOT( outID != NULL ) return false;
+
+	SnapshotLoadIDs* ids = (SnapshotLoadIDs*)( a->ctx );
+	( *outID ) = getSnapshotEntityID( ids->newIDs, ids->numEntities, localID );
+	return true;
+}
+
+static bool snapshotLoadGetLocalID( struct EntityAccessor* a, EntityID id, uint32_t* outID )
+{
+	// only used for reading
+	return false;
+}
+
+static void setSnapshotLoadIDs( SnapshotLoadIDs* ids, Serializer* s )
+{
+	s->entityAccessor.ctx = ids;
+	s->entityAccessor.getEntityID = snapshotLoadGetEntityID;
+	s->entityAccessor.getLocalID = snapshotLoadGetLocalID;
+}
+
+typedef struct {
+	const uint8_t* data;
+	size_t size;
+	size_t pos;
+} SnapshotBlobReader;
+
+static bool snapshotBlobReader( struct cmp_ctx_s* ctx, void* data, size_t limit )
+{
+	SnapshotBlobReader* reader = (SnapshotBlobReader*)( ctx->buf );
+	if( limit > ( reader->size - reader->pos ) ) return false;
+	SDL_memcpy( data, reader->data + reader->pos, limit );
+	reader->pos += limit;
+	return true;
+}
+
+static bool snapshotBlobSkipper( struct cmp_ctx_s* ctx, size_t count )
+{
+	SnapshotBlobReader* reader = (SnapshotBlobReader*)( ctx->buf );
+	if( count > ( reader->size - reader->pos ) ) return false;
+	reader->pos += count;
+	return true;
+}
+
+static void readSnapshotRecord( const ComponentType* type, const uint8_t* blob, const SnapshotRecord* record, SnapshotLoadIDs* ids, void* compData )
+{
+	// wasn't anything to write it with when it was saved
+	if( record->size == 0 ) return;
+
+	SnapshotBlobReader reader;
+	reader.data = blob + record->offset;
+	reader.size = record->size;
+	reader.pos = 0;
+
+	cmp_ctx_t cmp;
+	cmp_init( &cmp, &reader, snapshotBlobReader, snapshotBlobSkipper, NULL );
+	Serializer s;
+	serializer_CreateReadCmp( &cmp, &s );
+	setSnapshotLoadIDs( ids, &s );
+
+	if( !type->serialize( &s, compData ) ) {
+		llog( LOG_ERROR, "Error reading component %s from snapshot: %s", type->name, cmp_strerror( &cmp ) );
+	}
+}
+
+// puts the saved fields one after the other so they can be read by name
+static void readSnapshotFieldsByName( const ComponentType* type, SnapshotTypeMapping* mapping, const uint8_t* src, SnapshotLoadIDs* ids, void* compData )
+{
+	size_t packedOffset = 0;
+	for( size_t f = 0; f < sb_Count( mapping->sbSavedFields ); ++f ) {
+		size_t size = serializer_GetFieldTypeSize( mapping->sbSavedFields[f].type );
+		SDL_memcpy( mapping->sbPacked + packedOffset, src + mapping->sbSavedFields[f].offset, size );
+		packedOffset += size;
+	}
+
+	PackedFieldReader reader;
+	Serializer s;
+	serializer_CreateReadPackedFields( &reader, mapping->sbSavedFields, mapping->sbPacked, sb_Count( mapping->sbPacked ), &s );
+	setSnapshotLoadIDs( ids, &s );
+
+	if( !type->serialize( &s, compData ) ) {
+		llog( LOG_ERROR, "Error reading component %s by name from snapshot.", type->name );
+	}
+}
+
+// returns whether the block could be copied as is
+static bool fillSnapshotBlock( ECPS* ecps, const uint8_t* data, const SnapshotArchetype* archetype, const SnapshotBlock* block,
+	SnapshotTypeMapping* mappings, SnapshotLoadIDs* ids )
+{
+	const SnapshotHeader* header = (const SnapshotHeader*)data;
+	const SnapshotComponentType* types = (const SnapshotComponentType*)( data + header->componentTypesOffset );
+	const SnapshotColumn* columns = (const SnapshotColumn*)( data + header->columnsOffset ) + archetype->firstColumn;
+	const uint32_t* relocations = (const uint32_t*)( data + header->relocationsOffset ) + archetype->firstRelocation;
+	const SnapshotRecord* records = (const SnapshotRecord*)( data + header->recordsOffset ) + archetype->firstRecord;
+	const uint8_t* blob = data + header->blobOffset;
+	const EntityID* blockIDs = ids->newIDs + ( archetype->firstLocalID - 1 );
+
+	PackagedComponentArray* pca = &( ecps->componentData.sbComponentArrays[block->arrayIdx] );
+	const uint8_t* src = data + archetype->dataOffset;
+	uint8_t* dest = pca->sbData + block->firstOffset;
+
+	// if nothing has moved it's one copy and then fixing up the ids, the columns in the blob are zeroed in the block
+	uint32_t numBlobColumns = 0;
+	bool sameLayout = ( pca->entitySize == archetype->entitySize );
+	for( uint32_t c = 0; c < archetype->numColumns; ++c ) {
+		const SnapshotComponentType* savedType = &( types[columns[c].componentType] );
+		const SnapshotTypeMapping* mapping = &( mappings[columns[c].componentType] );
+		bool inBlock = ( mapping->readType == SRT_DIRECT ) ||
+			( ( savedType->schemaHash == 0 ) && ( ecps->componentTypes.sbTypes[mapping->compID].size == savedType->size ) );
+		sameLayout = sameLayout && inBlock && ( pca->structure.entries[mapping->compID].offset == (int32_t)columns[c].offset );
+		if( isBlobComponentType( savedType ) ) {
+			++numBlobColumns;
+		}
+	}
+
+	if( sameLayout ) {
+		SDL_memcpy( dest, src, (size_t)archetype->entitySize * archetype->numEntities );
+		for( uint32_t i = 0; i < archetype->numEntities; ++i ) {
+			uint8_t* entity = dest + ( (size_t)i * pca->entitySize );
+			SDL_memcpy( entity, &( blockIDs[i] ), sizeof( EntityID ) );
+			for( uint32_t r = 0; r < archetype->numRelocations; ++r ) {
+				remapSnapshotID( entity + relocations[r], ids->newIDs, ids->numEntities );
+			}
+		}
+		if( numBlobColumns == 0 ) return true;
+	}
+
+	// otherwise go through each component, converting any that have changed, and read anything that wasn't in the block
+	Serializer rawSerializer;
+	serializer_SetRawEntityID( &rawSerializer );
+	for( uint32_t i = 0; i < archetype->numEntities; ++i ) {
+		const uint8_t* srcEntity = src + ( (size_t)i * archetype->entitySize );
+		uint8_t* destEntity = dest + ( (size_t)i * pca->entitySize );
+		const SnapshotRecord* entityRecords = records + ( (size_t)i * numBlobColumns );
+
+		for( uint32_t c = 0; c < archetype->numColumns; ++c ) {
+			SnapshotTypeMapping* mapping = &( mappings[columns[c].componentType] );
+			const ComponentType* type = &( ecps->componentTypes.sbTypes[mapping->compID] );
+			uint8_t* compData = destEntity + pca->structure.entries[mapping->compID].offset;
+
+			if( mapping->readType == SRT_SERIALIZED ) {
+				readSnapshotRecord( type, blob, entityRecords, ids, compData );
+			} else if( mapping->readType == SRT_FIELDS_BY_NAME ) {
+				readSnapshotFieldsByName( type, mapping, srcEntity + columns[c].offset, ids, compData );
+			} else if( !sameLayout && ( ( mapping->readType == SRT_DIRECT ) || ( mapping->readType == SRT_CONVERT ) ) ) {
+				if( mapping->readType == SRT_DIRECT ) {
+					SDL_memcpy( compData, srcEntity + columns[c].offset, type->size );
+				} else {
+					serializer_ReadPacked( mapping->sbConvertOps, srcEntity + columns[c].offset, types[columns[c].componentType].size, &( rawSerializer.entityAccessor ), compData );
+				}
+
+				for( size_t o = 0; o < sb_Count( type->schema.sbOps ); ++o ) {
+					if( type->schema.sbOps[o].type == SOT_ENTITY_ID ) {
+						remapSnapshotID( compData + type->schema.sbOps[o].dataOffset, ids->newIDs, ids->numEntities );
+					}
+				}
+			}
+
+			if( isBlobComponentType( &( types[columns[c].componentType] ) ) ) {
+				++entityRecords;
+			}
+		}
+	}
+
+	return sameLayout;
+}
+
+bool ecps_LoadSnapshot( ECPS* ecps, const char* fileName )
+{
+	ASSERT_AND_IF_NOT( ecps != NULL ) return false;
+	ASSERT_AND_IF_NOT( fileName != NULL ) return false;
+	ASSERT_AND_IF_NOT( !ecps->isRunningProcess ) return false;
+
+	MappedFile file;
+	if( !mappedFile_Open( fileName, &file ) ) {
+		llog( LOG_ERROR, "Unable to open snapshot %s", fileName );
+		return false;
+	}
+
+	bool done = false;
+	SnapshotTypeMapping* mappings = NULL;
+	SnapshotBlock* blocks = NULL;
+	EntityID* newIDs = NULL;
+	uint32_t numCreated = 0; // entities are created in local id order, so these are the first ones in newIDs
+
+	if( !validateSnapshot( fileName, &file ) ) goto clean_up;
+
+	const SnapshotHeader* header = (const SnapshotHeader*)file.data;
+	const SnapshotColumn* columns = (const SnapshotColumn*)( file.data + header->columnsOffset );
+	const SnapshotArchetype* archetypes = (const SnapshotArchetype*)( file.data + header->archetypesOffset );
+
+	// cleared as soon as it exists, the clean up releases the buffers in it
+	mappings = mem_Allocate( sizeof( SnapshotTypeMapping ) * MAX( header->numComponentTypes, 1 ) );
+	if( mappings != NULL ) {
+		SDL_memset( mappings, 0, sizeof( SnapshotTypeMapping ) * MAX( header->numComponentTypes, 1 ) );
+	}
+	blocks = mem_Allocate( sizeof( SnapshotBlock ) * MAX( header->numArchetypes, 1 ) );
+	newIDs = mem_Allocate( sizeof( EntityID ) * MAX( header->numEntities, 1 ) );
+	if( ( mappings == NULL ) || ( blocks == NULL ) || ( newIDs == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate memory to load snapshot %s", fileName );
+		goto clean_up;
+	}
+
+	if( !mapSnapshotComponentTypes( ecps, header, file.data, mappings ) ) goto clean_up;
+
+	// create all the entities first so references between them can be remapped
+	for( uint32_t a = 0; a < header->numArchetypes; ++a ) {
+		ComponentBitFlags flags;
+		SDL_memset( &flags, 0, sizeof( flags ) );
+		for( uint32_t c = archetypes[a].firstColumn; c < ( archetypes[a].firstColumn + archetypes[a].numColumns ); ++c ) {
+			ecps_cbf_SetFlagOn( &flags, mappings[columns[c].componentType].compID );
+		}
+
+		if( archetypes[a].firstLocalID != ( numCreated + 1 ) ) {
+			llog( LOG_ERROR, "Snapshot %s has archetypes out of order.", fileName );
+			goto clean_up;
+		}
+
+		if( !ecps_CreateEntityBlock( ecps, &flags, archetypes[a].numEntities, newIDs + numCreated, &( blocks[a].arrayIdx ), &( blocks[a].firstOffset ) ) ) {
+			llog( LOG_ERROR, "Unable to create entities for snapshot %s", fileName );
+			goto clean_up;
+		}
+		numCreated += archetypes[a].numEntities;
+	}
+
+	SnapshotLoadIDs loadIDs;
+	loadIDs.newIDs = newIDs;
+	loadIDs.numEntities = header->numEntities;
+
+	uint32_t numCopied = 0;
+	for( uint32_t a = 0; a < header->numArchetypes; ++a ) {
+		if( fillSnapshotBlock( ecps, file.data, &( archetypes[a] ), &( blocks[a] ), mappings, &loadIDs ) ) {
+			++numCopied;
+		}
+	}
+
+	llog( LOG_DEBUG, "Loaded snapshot %s: %u entities in %u archetypes, %u copied directly.", fileName, header->numEntities, header->numArchetypes, numCopied );
+
+	done = true;
+
+clean_up:
+	if( !done ) {
+		for( uint32_t i = 0; i < numCreated; ++i ) {
+			ecps_DestroyEntityByID( ecps, newIDs[i] );
+		}
+	}
+
+	if( mappings != NULL ) {
+		for( uint32_t t = 0; t < ( (const SnapshotHeader*)file.data )->numComponentTypes; ++t ) {
+			sb_Release( mappings[t].sbConvertOps );
+			sb_Release( mappings[t].sbSavedFields );
+			sb_Release( mappings[t].sbPacked );
+		}
+	}
+	mem_Release( mappings );
+	mem_Release( blocks );
+	mem_Release( newIDs );
+	mappedFile_Close( &file );
+
+	return done;
+}
@@ -0,0 +1,22 @@
+#ifndef ECPS_SNAPSHOT_H
+#define ECPS_SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "ecps_dataTypes.h"
+
+// Snapshots are for loading a lot of entities quickly, e.g. a level. Each packaged component array is stored as the block
+//  of entities the ECPS keeps in memory, along with where every entity reference in it is. Loading maps the file, copies
+//  each block into the ECPS in one go, and then fixes up the references. If the component types have changed since the
+//  snapshot was saved the components are copied over one at a time, matching fields by name.
+//  Only component types with a compiled schema are stored in the blocks, see ecps_CompileComponentSerialization( ). Any
+//  others are written through their serialize function and read back the same way, which is a lot slower.
+
+// saves all the entities in the ECPS, returns false if there were any problems
+bool ecps_SaveSnapshot( const ECPS* ecps, const char* fileName );
+
+// creates all the entities in the snapshot in the ECPS, returns false if there were any problems, nothing is created if
+//  there was
+bool ecps_LoadSnapshot( ECPS* ecps, const char* fileName );
+
+#endif // inclusion guard
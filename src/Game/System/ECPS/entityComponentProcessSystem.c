@@ -340,6 +340,7 @@ ComponentID ecps_AddComponentType( ECPS* ecps, const char* name, uint32_t versio
 	newType.cleanUp = cleanUp;
 	newType.version = version;
 	newType.serialize = serialize;
+	SDL_zero( newType.schema );
 
 	if( name != NULL ) {
 		strncpy( newType.name, name, MAX_COMPONENT_NAME_SIZE );
@@ -522,6 +523,28 @@ void ecps_RunCustomProcess( ECPS* ecps, PreProcFunc preProc, ProcFunc proc, Post
 	internalRunProcess( ecps, preProc, proc, postProc, &bitFlags );
 }
 
+void ecps_RunCustomProcessByIDs( ECPS* ecps, PreProcFunc preProc, ProcFunc proc, PostProcFunc postProc, size_t numComponents, const ComponentID* componentIDs )
+{
+	ASSERT_AND_IF_NOT( ecps != NULL ) return;
+	ASSERT_AND_IF_NOT( ( numComponents == 0 ) || ( componentIDs != NULL ) ) return;
+
+	ComponentBitFlags bitFlags;
+	memset( &bitFlags, 0, sizeof( ComponentBitFlags ) );
+	for( size_t i = 0; i < numComponents; ++i ) {
+		if( !ecps_ct_IsComponentTypeValid( &( ecps->componentTypes ), componentIDs[i] ) ) {
+			llog( LOG_ERROR, "Invalid component type %i attempting to be used for a process.", componentIDs[i] );
+			return;
+		}
+		ecps_cbf_SetFlagOn( &bitFlags, componentIDs[i] );
+	}
+
+	// all processes require the ID and enabled components
+	ecps_cbf_SetFlagOn( &bitFlags, sharedComponent_Enabled );
+	ecps_cbf_SetFlagOn( &bitFlags, sharedComponent_ID );
+
+	internalRunProcess( ecps, preProc, proc, postProc, &bitFlags );
+}
+
 // run a process, must have been created with the associated entity-component-process system
 void ecps_RunProcess( ECPS* ecps, Process* process )
 {
@@ -711,6 +734,43 @@ EntityID ecps_CreateEntity( ECPS* ecps, size_t numComponents, ... )
 	return entityID;
 }
 
+bool ecps_CreateEntityBlock( ECPS* ecps, const ComponentBitFlags* flags, size_t count, EntityID* outIDs, uint32_t* outArrayIdx, size_t* outFirstOffset )
+{
+	ASSERT_AND_IF_NOT( ecps != NULL ) return false;
+	ASSERT_AND_IF_NOT( flags != NULL ) return false;
+	ASSERT_AND_IF_NOT( ( outIDs != NULL ) || ( count == 0 ) ) return false;
+	ASSERT_AND_IF_NOT( outArrayIdx != NULL ) return false;
+	ASSERT_AND_IF_NOT( outFirstOffset != NULL ) return false;
+	ASSERT_AND_IF_NOT( !ecps->isRunningProcess ) return false;
+
+	if( !idSet_ClaimIDs( &( ecps->idSet ), count, outIDs ) ) {
+		llog( LOG_ERROR, "Not enough entity ids left to create %zu entities.", count );
+		return false;
+	}
+
+	ComponentBitFlags blockFlags;
+	memcpy( &blockFlags, flags, sizeof( ComponentBitFlags ) );
+	ecps_cbf_SetFlagOn( &blockFlags, sharedComponent_ID );
+
+	// always goes at the end instead of looking for empty spots, the whole block is one allocation and one clear
+	uint32_t pcaIdx = createOrFindPackagedArray( ecps, &blockFlags );
+	PackagedComponentArray* pca = &( ecps->componentData.sbComponentArrays[pcaIdx] );
+	size_t firstOffset = sb_Count( pca->sbData );
+	if( count > 0 ) {
+		uint8_t* data = sb_Add( pca->sbData, pca->entitySize * count );
+		memset( data, 0, pca->entitySize * count );
+
+		for( size_t i = 0; i < count; ++i ) {
+			( *(EntityID*)( data + ( i * pca->entitySize ) ) ) = outIDs[i];
+			modifyEntityDirectoryEntry( ecps, outIDs[i], pcaIdx, firstOffset + ( i * pca->entitySize ) );
+		}
+	}
+
+	( *outArrayIdx ) = pcaIdx;
+	( *outFirstOffset ) = firstOffset;
+	return true;
+}
+
 // finds the entity with the given id
 bool ecps_GetEntityByID( const ECPS* ecps, EntityID entityID, Entity* outEntity )
 {
@@ -1234,6 +1294,41 @@ void ecps_DestroyAllEntities( ECPS* ecps )
 	ecps->componentData.sbEntityDirectory = NULL;
 }
 
+bool ecps_CompileComponentSerialization( ECPS* ecps, ComponentID componentID )
+{
+	ASSERT_AND_IF_NOT( ecps != NULL ) return false;
+	ASSERT_AND_IF_NOT( ecps_ct_IsComponentTypeValid( &( ecps->componentTypes ), componentID ) ) return false;
+
+	ComponentType* type = &( ecps->componentTypes.sbTypes[componentID] );
+	if( type->serialize == NULL ) {
+		llog( LOG_WARN, "Component type %s has no serialize function to compile.", type->name );
+		return false;
+	}
+
+	serializer_DestroySchema( &( type->schema ) );
+	if( !serializer_CompileSchema( type->serialize, type->size, &( type->schema ) ) ) {
+		llog( LOG_WARN, "Component type %s will be serialized without a compiled schema.", type->name );
+		return false;
+	}
+
+	llog( LOG_DEBUG, "Compiled schema for component type %s, %u fields, %u copies, %u bytes packed%s", type->name,
+		(uint32_t)sb_Count( type->schema.sbFields ), (uint32_t)sb_Count( type->schema.sbOps ), type->schema.packedSize,
+		serializer_IsSchemaPOD( &( type->schema ) ) ? ", plain data" : "" );
+	return true;
+}
+
+const SerializerSchema* ecps_GetComponentSchema( const ECPS* ecps, ComponentID componentID )
+{
+	ASSERT( ecps != NULL );
+
+	if( componentID >= sb_Count( ecps->componentTypes.sbTypes ) ) {
+		return NULL;
+	}
+
+	const SerializerSchema* schema = &( ecps->componentTypes.sbTypes[componentID].schema );
+	return ( schema->hash != 0 ) ? schema : NULL;
+}
+
 SerializeComponent ecps_GetComponentSerializationFunction( const ECPS* ecps, ComponentID componentID )
 {
 	ASSERT( ecps != NULL );
@@ -38,6 +38,10 @@ bool ecps_CreateProcess( ECPS* ecps,
 //  or one off processes that you don't always need access to
 void ecps_RunCustomProcess( ECPS* ecps, PreProcFunc preProc, ProcFunc proc, PostProcFunc postProc, size_t numComponents, ... );
 
+// same as ecps_RunCustomProcess( ) but with the components in an array, for when the number of components isn't known
+//  until runtime
+void ecps_RunCustomProcessByIDs( ECPS* ecps, PreProcFunc preProc, ProcFunc proc, PostProcFunc postProc, size_t numComponents, const ComponentID* componentIDs );
+
 // run a process, must have been created with the associated entity-component-process system
 void ecps_RunProcess( ECPS* ecps, Process* process );
 
@@ -49,6 +53,12 @@ void ecps_RunProcess( ECPS* ecps, Process* process );
 //  the returned id is 0 if the creation fails
 EntityID ecps_CreateEntity( ECPS* ecps, size_t numComponents, ... );
 
+// for loading large numbers of entities at once, creates count entities with the components in flags at the end of the
+//  matching packaged array. The entities are zeroed except for their ids, which are also written to outIDs. The first one
+//  is at outFirstOffset in the array's sbData and each one after that is entitySize further on.
+//  Can't be used while a process is running, returns false without creating anything if there aren't enough ids left.
+bool ecps_CreateEntityBlock( ECPS* ecps, const ComponentBitFlags* flags, size_t count, EntityID* outIDs, uint32_t* outArrayIdx, size_t* outFirstOffset );
+
 // finds the entity with the given id
 bool ecps_GetEntityByID( const ECPS* ecps, EntityID entityID, Entity* outEntity );
 
@@ -92,6 +102,14 @@ void ecps_DestroyAllEntities( ECPS* ecps );
 
 SerializeComponent ecps_GetComponentSerializationFunction( const ECPS* ecps, ComponentID componentID );
 
+// compiles the serialize function of the component type into a schema, after this ecps_GenerateSerializedECPS( ) stores
+//  the components packed instead of going through the serializer, returns false if it can't be compiled in which case
+//  the serialize function will still be used, see serializer_CompileSchema( )
+bool ecps_CompileComponentSerialization( ECPS* ecps, ComponentID componentID );
+
+// returns NULL if the component type doesn't have a compiled schema
+const SerializerSchema* ecps_GetComponentSchema( const ECPS* ecps, ComponentID componentID );
+
 // debugging stuff
 void ecps_DumpEntityByID( ECPS* ecps, const EntityID id, const char* tag );
 void ecps_DumpEntity( ECPS* ecps, const Entity* entity, const char* tag );
@@ -103,6 +103,18 @@ int jq_Initialize( uint8_t numThreads )
 	return 0;
 }
 
+// Returns the number of threads processing jobs, 0 if there's no threading support.
+int jq_GetNumThreads( void )
+{
+	int count = 0;
+	for( size_t i = 0; i < sb_Count( sbThreadPool ); ++i ) {
+		if( sbThreadPool[i] != NULL ) {
+			++count;
+		}
+	}
+	return count;
+}
+
 void jq_ShutDown( void )
 {
 #ifdef THREAD_SUPPORT
@@ -23,6 +23,9 @@ bool jq_ProcessNextJob( void );
 // Returns if all the non-main thread jobs are done
 bool jq_AllJobsDone( void );
 
+// Returns the number of threads processing jobs, 0 if there's no threading support.
+int jq_GetNumThreads( void );
+
 // Goes through all the jobs added to the main thread and processes them
 //  If there is no threading support then all other jobs are processed here as well
 void jq_ProcessMainThreadJobs( void );
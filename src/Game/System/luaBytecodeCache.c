@@ -0,0 +1,380 @@
+#include "luaBytecodeCache.h"
+
+#if SCRIPTING_ENABLED
+
+#include <SDL3/SDL.h>
+
+#include "System/platformLog.h"
+#include "System/memory.h"
+#include "Utils/stretchyBuffer.h"
+#include "Utils/hashMap.h"
+#include "Utils/helpers.h"
+
+#define CACHE_FORMAT_VERSION 1
+
+typedef struct {
+	char magic[4];
+	uint32_t formatVersion;
+	uint32_t luaVersion;
+	uint32_t bytecodeSize;
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+} BytecodeHeader;
+
+typedef struct {
+	uint64_t sourceHash;
+	uint64_t sourceSize;
+	uint8_t* sbBytecode;
+} CachedChunk;
+
+static const char cacheMagic[4] = { 'X', 'L', 'B', 'C' };
+
+static bool cacheEnabled = true;
+
+// file name -> index into sbCachedChunks
+static HashMap cacheMap;
+static bool cacheMapCreated = false;
+static CachedChunk* sbCachedChunks = NULL;
+
+// prefix + name + suffix, release with mem_Release
+static char* createString( const char* prefix, const char* name, const char* suffix )
+{
+	size_t len = SDL_strlen( prefix ) + SDL_strlen( name ) + SDL_strlen( suffix ) + 1;
+	char* str = mem_Allocate( len );
+	if( str == NULL ) return NULL;
+	SDL_snprintf( str, len, "%s%s%s", prefix, name, suffix );
+	return str;
+}
+
+// matches what luaL_loadfile skips, a UTF-8 BOM and a first line starting with '#'
+//  the newline is left so line numbers in errors stay the same
+static const char* skipSourcePrefix( const uint8_t* source, size_t* size )
+{
+	const char* start = (const char*)source;
+	const char* end = start + *size;
+
+	if( ( ( end - start ) >= 3 ) && ( SDL_memcmp( start, "\xEF\xBB\xBF", 3 ) == 0 ) ) {
+		start += 3;
+	}
+
+	if( ( start < end ) && ( *start == '#' ) ) {
+		while( ( start < end ) && ( *start != '\n' ) ) {
+			++start;
+		}
+	}
+
+	*size = (size_t)( end - start );
+	return start;
+}
+
+static int compileSource( lua_State* ls, const uint8_t* source, size_t sourceSize, const char* chunkName )
+{
+	size_t size = sourceSize;
+	const char* start = skipSourcePrefix( source, &size );
+	return luaL_loadbufferx( ls, start, size, chunkName, "t" );
+}
+
+// if the precompiled file is valid the chunk is pushed onto the stack, otherwise the stack is left unchanged
+static bool tryLoadBytecode( lua_State* ls, const char* fileName, const char* chunkName, bool checkSource, uint64_t sourceHash, size_t sourceSize )
+{
+	size_t fileSize = 0;
+	uint8_t* data = SDL_LoadFile( fileName, &fileSize );
+	if( data == NULL ) return false;
+
+	bool loaded = false;
+
+	BytecodeHeader header;
+	if( fileSize < sizeof( header ) ) goto clean_up;
+	SDL_memcpy( &header, data, sizeof( header ) );
+
+	if( ( SDL_memcmp( header.magic, cacheMagic, sizeof( cacheMagic ) ) != 0 ) ||
+		( header.formatVersion != CACHE_FORMAT_VERSION ) ||
+		( header.luaVersion != LUA_VERSION_RELEASE_NUM ) ||
+		( header.bytecodeSize != ( fileSize - sizeof( header ) ) ) ) {
+		goto clean_up;
+	}
+
+	if( checkSource && ( ( header.sourceHash != sourceHash ) || ( header.sourceSize != (uint64_t)sourceSize ) ) ) {
+		goto clean_up;
+	}
+
+	if( luaL_loadbufferx( ls, (const char*)( data + sizeof( header ) ), header.bytecodeSize, chunkName, "b" ) != LUA_OK ) {
+		// most likely built with different sized integers or floats, fall back to the source
+		llog( LOG_WARN, "Unable to load bytecode from %s: %s", fileName, lua_tostring( ls, -1 ) );
+		lua_pop( ls, 1 );
+		goto clean_up;
+	}
+
+	loaded = true;
+
+clean_up:
+	SDL_free( data );
+	return loaded;
+}
+
+static int dumpWriter( lua_State* ls, const void* p, size_t size, void* userData )
+{
+	uint8_t** psbBytecode = (uint8_t**)userData;
+	if( size > 0 ) {
+		SDL_memcpy( sb_Add( *psbBytecode, size ), p, size );
+	}
+	return 0;
+}
+
+// if there's an up to date copy of the file in memory the chunk is pushed onto the stack, otherwise the stack is left
+//  unchanged
+static bool tryLoadCachedChunk( lua_State* ls, const char* fileName, const char* chunkName, uint64_t sourceHash, size_t sourceSize )
+{
+	int idx;
+	if( !cacheMapCreated || !hashMap_Find( &cacheMap, fileName, &idx ) ) return false;
+
+	CachedChunk* chunk = &sbCachedChunks[idx];
+	if( ( chunk->sourceHash != sourceHash ) || ( chunk->sourceSize != (uint64_t)sourceSize ) ) return false;
+
+	if( luaL_loadbufferx( ls, (const char*)chunk->sbBytecode, sb_Count( chunk->sbBytecode ), chunkName, "b" ) != LUA_OK ) {
+		llog( LOG_WARN, "Unable to load cached bytecode for %s: %s", fileName, lua_tostring( ls, -1 ) );
+		lua_pop( ls, 1 );
+		return false;
+	}
+
+	return true;
+}
+
+// dumps the function on the top of the stack into the cache, the function is left on the stack
+static void cacheChunk( lua_State* ls, const char* fileName, uint64_t sourceHash, size_t sourceSize )
+{
+	uint8_t* sbBytecode = NULL;
+	if( lua_dump( ls, dumpWriter, &sbBytecode, 0 ) != 0 ) {
+		llog( LOG_WARN, "Unable to dump bytecode for %s.", fileName );
+		sb_Release( sbBytecode );
+		return;
+	}
+
+	if( !cacheMapCreated ) {
+		hashMap_Init( &cacheMap, 64, NULL );
+		cacheMapCreated = true;
+	}
+
+	int idx;
+	if( hashMap_Find( &cacheMap, fileName, &idx ) ) {
+		sb_Release( sbCachedChunks[idx].sbBytecode );
+	} else {
+		idx = (int)sb_Count( sbCachedChunks );
+		sb_Add( sbCachedChunks, 1 );
+		hashMap_Set( &cacheMap, fileName, idx );
+	}
+
+	sbCachedChunks[idx].sourceHash = sourceHash;
+	sbCachedChunks[idx].sourceSize = (uint64_t)sourceSize;
+	sbCachedChunks[idx].sbBytecode = sbBytecode;
+}
+
+// dumps the function on the top of the stack to the file, the function is left on the stack
+static bool saveBytecode( lua_State* ls, const char* fileName, uint64_t sourceHash, size_t sourceSize, bool strip )
+{
+	bool done = false;
+	uint8_t* sbBytecode = NULL;
+	char* tempFileName = NULL;
+	SDL_IOStream* ioStream = NULL;
+
+	if( lua_dump( ls, dumpWriter, &sbBytecode, strip ? 1 : 0 ) != 0 ) {
+		llog( LOG_ERROR, "Unable to dump bytecode for %s.", fileName );
+		goto clean_up;
+	}
+
+	BytecodeHeader header;
+	SDL_memset( &header, 0, sizeof( header ) );
+	SDL_memcpy( header.magic, cacheMagic, sizeof( cacheMagic ) );
+	header.formatVersion = CACHE_FORMAT_VERSION;
+	header.luaVersion = LUA_VERSION_RELEASE_NUM;
+	header.bytecodeSize = (uint32_t)sb_Count( sbBytecode );
+	header.sourceHash = sourceHash;
+	header.sourceSize = (uint64_t)sourceSize;
+
+	// write to a temporary file first so a partially written file is never loaded
+	tempFileName = createString( "", fileName, ".tmp" );
+	if( tempFileName == NULL ) goto clean_up;
+
+	ioStream = SDL_IOFromFile( tempFileName, "wb" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open file %s: %s", tempFileName, SDL_GetError( ) );
+		goto clean_up;
+	}
+
+	bool written =
+		( SDL_WriteIO( ioStream, &header, sizeof( header ) ) == sizeof( header ) ) &&
+		( SDL_WriteIO( ioStream, sbBytecode, sb_Count( sbBytecode ) ) == sb_Count( sbBytecode ) );
+
+	bool closed = SDL_CloseIO( ioStream );
+	ioStream = NULL;
+	if( !written || !closed ) {
+		llog( LOG_ERROR, "Error writing bytecode %s: %s", tempFileName, SDL_GetError( ) );
+		SDL_RemovePath( tempFileName );
+		goto clean_up;
+	}
+
+	if( !SDL_RenamePath( tempFileName, fileName ) ) {
+		llog( LOG_ERROR, "Unable to move %s to %s: %s", tempFileName, fileName, SDL_GetError( ) );
+		SDL_RemovePath( tempFileName );
+		goto clean_up;
+	}
+
+	done = true;
+
+clean_up:
+	if( ioStream != NULL ) SDL_CloseIO( ioStream );
+	mem_Release( tempFileName );
+	sb_Release( sbBytecode );
+	return done;
+}
+
+int xLua_LoadChunk( lua_State* ls, const char* fileName )
+{
+	SDL_assert( ls != NULL );
+	SDL_assert( fileName != NULL );
+
+	int status = LUA_ERRFILE;
+	char* chunkName = NULL;
+	char* precompiledPath = NULL;
+
+	size_t sourceSize = 0;
+	uint8_t* source = SDL_LoadFile( fileName, &sourceSize );
+	uint64_t sourceHash = ( source != NULL ) ? fnv1aHash( FNV1A_START, source, sourceSize ) : 0;
+
+	chunkName = createString( "@", fileName, "" );
+	if( chunkName == NULL ) {
+		lua_pushfstring( ls, "out of memory loading %s", fileName );
+		status = LUA_ERRMEM;
+		goto clean_up;
+	}
+
+	if( cacheEnabled ) {
+		if( ( source != NULL ) && tryLoadCachedChunk( ls, fileName, chunkName, sourceHash, sourceSize ) ) {
+			status = LUA_OK;
+			goto clean_up;
+		}
+
+		// without the source there's nothing to check the precompiled file against, assume it's up to date
+		precompiledPath = createString( "", fileName, "c" );
+		if( ( precompiledPath != NULL ) && tryLoadBytecode( ls, precompiledPath, chunkName, source != NULL, sourceHash, sourceSize ) ) {
+			status = LUA_OK;
+			goto clean_up;
+		}
+	}
+
+	if( source == NULL ) {
+		lua_pushfstring( ls, "cannot open %s: %s", fileName, SDL_GetError( ) );
+		status = LUA_ERRFILE;
+		goto clean_up;
+	}
+
+	status = compileSource( ls, source, sourceSize, chunkName );
+	if( ( status == LUA_OK ) && cacheEnabled ) {
+		// missing or stale, replace it so the next load can skip compiling
+		cacheChunk( ls, fileName, sourceHash, sourceSize );
+	}
+
+clean_up:
+	mem_Release( precompiledPath );
+	mem_Release( chunkName );
+	SDL_free( source );
+	return status;
+}
+
+void xLua_SetBytecodeCacheEnabled( bool enabled )
+{
+	cacheEnabled = enabled;
+}
+
+bool xLua_IsBytecodeCacheEnabled( void )
+{
+	return cacheEnabled;
+}
+
+void xLua_ClearBytecodeCache( void )
+{
+	for( size_t i = 0; i < sb_Count( sbCachedChunks ); ++i ) {
+		sb_Release( sbCachedChunks[i].sbBytecode );
+	}
+	sb_Release( sbCachedChunks );
+
+	if( cacheMapCreated ) {
+		hashMap_Clear( &cacheMap );
+		cacheMapCreated = false;
+	}
+}
+
+bool xLua_PrecompileFile( const char* fileName, const char* outFileName, bool strip )
+{
+	SDL_assert( fileName != NULL );
+	SDL_assert( outFileName != NULL );
+
+	size_t sourceSize = 0;
+	uint8_t* source = SDL_LoadFile( fileName, &sourceSize );
+	if( source == NULL ) {
+		llog( LOG_ERROR, "Unable to load script %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	bool done = false;
+	char* chunkName = NULL;
+
+	// nothing is run so a bare state is all that's needed
+	lua_State* ls = luaL_newstate( );
+	if( ls == NULL ) {
+		llog( LOG_ERROR, "Unable to create Lua state." );
+		goto clean_up;
+	}
+
+	chunkName = createString( "@", fileName, "" );
+	if( chunkName == NULL ) goto clean_up;
+
+	if( compileSource( ls, source, sourceSize, chunkName ) != LUA_OK ) {
+		llog( LOG_ERROR, "%s", lua_tostring( ls, -1 ) );
+		goto clean_up;
+	}
+
+	done = saveBytecode( ls, outFileName, fnv1aHash( FNV1A_START, source, sourceSize ), sourceSize, strip );
+
+clean_up:
+	if( ls != NULL ) lua_close( ls );
+	mem_Release( chunkName );
+	SDL_free( source );
+	return done;
+}
+
+int xLua_PrecompileDirectory( const char* directory, bool strip )
+{
+	SDL_assert( directory != NULL );
+
+	int count = 0;
+	char** files = SDL_GlobDirectory( directory, NULL, 0, &count );
+	if( files == NULL ) {
+		llog( LOG_ERROR, "Unable to read directory %s: %s", directory, SDL_GetError( ) );
+		return -1;
+	}
+
+	int numCompiled = 0;
+	int numFailed = 0;
+	for( int i = 0; i < count; ++i ) {
+		size_t len = SDL_strlen( files[i] );
+		if( ( len < 4 ) || ( SDL_strcasecmp( files[i] + len - 4, ".lua" ) != 0 ) ) continue;
+
+		char* fileName = createString( directory, "/", files[i] );
+		char* outFileName = ( fileName != NULL ) ? createString( "", fileName, "c" ) : NULL;
+		if( ( outFileName != NULL ) && xLua_PrecompileFile( fileName, outFileName, strip ) ) {
+			++numCompiled;
+		} else {
+			++numFailed;
+		}
+		mem_Release( outFileName );
+		mem_Release( fileName );
+	}
+	SDL_free( files );
+
+	llog( LOG_INFO, "Precompiled %i scripts in %s, %i failed.", numCompiled, directory, numFailed );
+
+	return numFailed;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef LUA_BYTECODE_CACHE_H
+#define LUA_BYTECODE_CACHE_H
+
+#include <stdbool.h>
+
+#if SCRIPTING_ENABLED
+
+#include "System/luaInterface.h"
+
+// Compiled scripts are stored with lua_dump so they don't have to be parsed and compiled again. Each one has the hash
+//  and size of the source it was compiled from and the Lua version, if any of those don't match the compiled version is
+//  ignored and the source is compiled instead.
+//
+// Two places are checked before compiling the source:
+//  the cache in memory, filled whenever a source file is compiled so reloading a script is quick
+//  a precompiled file next to the source with a 'c' appended to the name (Scripts/main.lua -> Scripts/main.luac),
+//   created offline with xLua_PrecompileFile( ) or xLua_PrecompileDirectory( ) for shipping builds
+// If the source file is missing a precompiled file is used as long as it was built with the same version of Lua.
+// Lua doesn't verify bytecode, so it's only ever loaded from somewhere the scripts themselves come from, never from
+//  anywhere writable like the save directory.
+
+// works like luaL_loadfile, pushes the compiled chunk on success or an error message on failure
+int xLua_LoadChunk( lua_State* ls, const char* fileName );
+
+// turning the cache off means every file is compiled from source and nothing new is cached
+void xLua_SetBytecodeCacheEnabled( bool enabled );
+bool xLua_IsBytecodeCacheEnabled( void );
+
+// releases everything in the memory cache
+void xLua_ClearBytecodeCache( void );
+
+// compiles the source file and writes it out in the format xLua_LoadChunk( ) expects
+//  strip removes the debug information, making the file smaller but errors won't have line numbers
+bool xLua_PrecompileFile( const char* fileName, const char* outFileName, bool strip );
+
+// precompiles every .lua file in the directory and it's sub-directories, returns the number of files that failed
+//  or -1 if the directory couldn't be read
+int xLua_PrecompileDirectory( const char* directory, bool strip );
+
+#endif // scripting enabled
+
+#endif // inclusion guard
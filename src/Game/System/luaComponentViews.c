@@ -0,0 +1,358 @@
+#include "luaComponentViews.h"
+
+#if SCRIPTING_ENABLED
+
+#include <SDL3/SDL.h>
+
+#include "System/platformLog.h"
+#include "System/serializer.h"
+#include "System/luaProfiler.h"
+#include "System/ECPS/entityComponentProcessSystem.h"
+#include "DefaultECPS/defaultECPS.h"
+#include "Utils/stretchyBuffer.h"
+#include "Utils/helpers.h"
+
+#define VIEW_METATABLE "Xturos.ComponentView"
+#define MAX_VIEW_COMPONENTS 8
+
+typedef struct {
+	uint8_t* data; // set while being handed out by forEachComponentView( ), otherwise the entity is looked up on every access
+	EntityID entityID;
+	ComponentID compID;
+} ComponentView;
+
+typedef struct {
+	bool generated;
+	SerializedField* sbFields;
+	int nameTableRef; // field name to field index
+} ComponentLayout;
+
+// indexed by ComponentID, the layouts are generated the first time a script uses the component
+static ComponentLayout* sbLayouts = NULL;
+
+typedef struct {
+	bool running;
+	bool failed; // the error message is left on the top of the stack
+	lua_State* ls;
+	int funcIdx;
+	int firstViewIdx;
+	int numViews;
+	ComponentID compIDs[MAX_VIEW_COMPONENTS];
+	ComponentView* views[MAX_VIEW_COMPONENTS];
+	lua_Integer count;
+} ViewProcessState;
+
+static ViewProcessState viewProcessState;
+
+static ComponentLayout* getLayout( lua_State* ls, ComponentID compID )
+{
+	while( sb_Count( sbLayouts ) <= compID ) {
+		ComponentLayout empty;
+		SDL_zero( empty );
+		empty.nameTableRef = LUA_NOREF;
+		sb_Push( sbLayouts, empty );
+	}
+
+	ComponentLayout* layout = &( sbLayouts[compID] );
+	if( layout->generated ) {
+		return layout;
+	}
+
+	size_t compSize = 0;
+	ecps_GetComponentTypeSize( &defaultECPS, compID, &compSize );
+	SerializeComponent serialize = ecps_GetComponentSerializationFunction( &defaultECPS, compID );
+	if( ( serialize == NULL ) || !serializer_GenerateFieldLayout( serialize, compSize, &( layout->sbFields ) ) ) {
+		llog( LOG_WARN, "Unable to find the fields of component %u, it won't have any fields in scripts.", compID );
+	}
+
+	lua_createtable( ls, 0, (int)sb_Count( layout->sbFields ) );
+	for( size_t i = 0; i < sb_Count( layout->sbFields ); ++i ) {
+		lua_pushinteger( ls, (lua_Integer)( i + 1 ) );
+		lua_setfield( ls, -2, layout->sbFields[i].name );
+	}
+	layout->nameTableRef = luaL_ref( ls, LUA_REGISTRYINDEX );
+	layout->generated = true;
+
+	return layout;
+}
+
+static ComponentID checkComponentName( lua_State* ls, int arg )
+{
+	const char* compName = luaL_checkstring( ls, arg );
+	ComponentID compID = ecps_GetComponentIDByName( &defaultECPS, compName );
+	if( compID == INVALID_COMPONENT_ID ) {
+		luaL_error( ls, "component type \"%s\" doesn't exist", compName );
+	}
+	return compID;
+}
+
+// finds the field for the key at keyIdx, either the name or the index from getComponentFieldIndex( )
+static const SerializedField* checkField( lua_State* ls, const ComponentLayout* layout, int keyIdx )
+{
+	lua_Integer idx = 0;
+	if( lua_type( ls, keyIdx ) == LUA_TNUMBER ) {
+		idx = lua_tointeger( ls, keyIdx );
+	} else {
+		lua_rawgeti( ls, LUA_REGISTRYINDEX, layout->nameTableRef );
+		lua_pushvalue( ls, keyIdx );
+		lua_rawget( ls, -2 );
+		idx = lua_tointeger( ls, -1 );
+		lua_pop( ls, 2 );
+	}
+
+	if( ( idx < 1 ) || ( idx > (lua_Integer)sb_Count( layout->sbFields ) ) ) {
+		luaL_error( ls, "component has no field %s", luaL_tolstring( ls, keyIdx, NULL ) );
+		return NULL;
+	}
+
+	return &( layout->sbFields[idx - 1] );
+}
+
+static uint8_t* getViewData( lua_State* ls, ComponentView* view )
+{
+	if( view->data != NULL ) {
+		return view->data;
+	}
+
+	void* data = NULL;
+	if( ( view->entityID == INVALID_ENTITY_ID ) || !ecps_GetComponentFromEntityByID( &defaultECPS, view->entityID, view->compID, &data ) ) {
+		luaL_error( ls, "component view is no longer valid" );
+		return NULL;
+	}
+	return (uint8_t*)data;
+}
+
+static int view_Index( lua_State* ls )
+{
+	// the metatable is protected so this is only ever called with a view
+	ComponentView* view = (ComponentView*)lua_touserdata( ls, 1 );
+	const SerializedField* field = checkField( ls, getLayout( ls, view->compID ), 2 );
+	const uint8_t* value = getViewData( ls, view ) + field->offset;
+
+	switch( field->type ) {
+	case SFT_S8:
+		lua_pushinteger( ls, *(const int8_t*)value );
+		break;
+	case SFT_S32:
+		lua_pushinteger( ls, *(const int32_t*)value );
+		break;
+	case SFT_U32:
+	case SFT_ENTITY_ID:
+	case SFT_IMAGE_ID:
+		lua_pushinteger( ls, *(const uint32_t*)value );
+		break;
+	case SFT_S64:
+		lua_pushinteger( ls, *(const int64_t*)value );
+		break;
+	case SFT_U64:
+		lua_pushinteger( ls, (lua_Integer)( *(const uint64_t*)value ) );
+		break;
+	case SFT_FLOAT:
+		lua_pushnumber( ls, *(const float*)value );
+		break;
+	case SFT_BOOL:
+		lua_pushboolean( ls, *(const bool*)value ? 1 : 0 );
+		break;
+	default:
+		lua_pushnil( ls );
+		break;
+	}
+
+	return 1;
+}
+
+static int view_NewIndex( lua_State* ls )
+{
+	ComponentView* view = (ComponentView*)lua_touserdata( ls, 1 );
+	const SerializedField* field = checkField( ls, getLayout( ls, view->compID ), 2 );
+	uint8_t* value = getViewData( ls, view ) + field->offset;
+
+	switch( field->type ) {
+	case SFT_S8:
+		*(int8_t*)value = (int8_t)luaL_checkinteger( ls, 3 );
+		break;
+	case SFT_S32:
+		*(int32_t*)value = (int32_t)luaL_checkinteger( ls, 3 );
+		break;
+	case SFT_U32:
+	case SFT_ENTITY_ID:
+	case SFT_IMAGE_ID:
+		*(uint32_t*)value = (uint32_t)luaL_checkinteger( ls, 3 );
+		break;
+	case SFT_S64:
+		*(int64_t*)value = (int64_t)luaL_checkinteger( ls, 3 );
+		break;
+	case SFT_U64:
+		*(uint64_t*)value = (uint64_t)luaL_checkinteger( ls, 3 );
+		break;
+	case SFT_FLOAT:
+		*(float*)value = (float)luaL_checknumber( ls, 3 );
+		break;
+	case SFT_BOOL:
+		*(bool*)value = ( lua_toboolean( ls, 3 ) != 0 );
+		break;
+	}
+
+	return 0;
+}
+
+static ComponentView* pushView( lua_State* ls, ComponentID compID, EntityID entityID )
+{
+	ComponentView* view = (ComponentView*)lua_newuserdatauv( ls, sizeof( ComponentView ), 0 );
+	view->data = NULL;
+	view->entityID = entityID;
+	view->compID = compID;
+	luaL_setmetatable( ls, VIEW_METATABLE );
+	return view;
+}
+
+static int lua_GetComponentView( lua_State* ls )
+{
+	EntityID entityID = (EntityID)luaL_checkinteger( ls, 1 );
+	ComponentID compID = checkComponentName( ls, 2 );
+
+	if( !ecps_DoesEntityHaveComponentByID( &defaultECPS, entityID, compID ) ) {
+		lua_pushnil( ls );
+		return 1;
+	}
+
+	getLayout( ls, compID );
+	pushView( ls, compID, entityID );
+	return 1;
+}
+
+static int lua_GetComponentFieldIndex( lua_State* ls )
+{
+	ComponentID compID = checkComponentName( ls, 1 );
+	luaL_checkstring( ls, 2 );
+	ComponentLayout* layout = getLayout( ls, compID );
+
+	lua_rawgeti( ls, LUA_REGISTRYINDEX, layout->nameTableRef );
+	lua_pushvalue( ls, 2 );
+	lua_rawget( ls, -2 );
+	return 1;
+}
+
+static int lua_GetComponentFieldNames( lua_State* ls )
+{
+	ComponentID compID = checkComponentName( ls, 1 );
+	ComponentLayout* layout = getLayout( ls, compID );
+
+	lua_createtable( ls, (int)sb_Count( layout->sbFields ), 0 );
+	for( size_t i = 0; i < sb_Count( layout->sbFields ); ++i ) {
+		lua_pushstring( ls, layout->sbFields[i].name );
+		lua_rawseti( ls, -2, (lua_Integer)( i + 1 ) );
+	}
+	return 1;
+}
+
+static void viewProcess( ECPS* ecps, const Entity* entity )
+{
+	ViewProcessState* state = &viewProcessState;
+	if( state->failed ) return;
+
+	lua_State* ls = state->ls;
+	lua_pushvalue( ls, state->funcIdx );
+	lua_pushinteger( ls, (lua_Integer)entity->id );
+	for( int i = 0; i < state->numViews; ++i ) {
+		ComponentView* view = state->views[i];
+		void* data = NULL;
+		ecps_GetComponentFromEntity( entity, state->compIDs[i], &data );
+		view->data = (uint8_t*)data;
+		view->entityID = entity->id;
+		lua_pushvalue( ls, state->firstViewIdx + i );
+	}
+
+	if( lua_pcall( ls, state->numViews + 1, 0, 0 ) != LUA_OK ) {
+		state->failed = true;
+		return;
+	}
+	++( state->count );
+}
+
+static int lua_ForEachComponentView( lua_State* ls )
+{
+	luaL_checktype( ls, 1, LUA_TFUNCTION );
+	int numViews = lua_gettop( ls ) - 1;
+	if( ( numViews < 1 ) || ( numViews > MAX_VIEW_COMPONENTS ) ) {
+		return luaL_error( ls, "forEachComponentView needs between 1 and %d components", MAX_VIEW_COMPONENTS );
+	}
+
+	// the ecps can only run one process at a time
+	if( viewProcessState.running || defaultECPS.isRunningProcess ) {
+		return luaL_error( ls, "forEachComponentView can't be used while another process is running" );
+	}
+
+	luaL_checkstack( ls, numViews + 4, NULL );
+
+	ViewProcessState* state = &viewProcessState;
+	SDL_zero( *state );
+	state->ls = ls;
+	state->funcIdx = 1;
+	state->numViews = numViews;
+	state->firstViewIdx = lua_gettop( ls ) + 1;
+	for( int i = 0; i < numViews; ++i ) {
+		state->compIDs[i] = checkComponentName( ls, i + 2 );
+	}
+
+	// these are the only views created, they're pointed at each entity as it's processed
+	for( int i = 0; i < numViews; ++i ) {
+		getLayout( ls, state->compIDs[i] );
+		state->views[i] = pushView( ls, state->compIDs[i], INVALID_ENTITY_ID );
+	}
+
+	state->running = true;
+	ecps_RunCustomProcessByIDs( &defaultECPS, NULL, viewProcess, NULL, (size_t)numViews, state->compIDs );
+	state->running = false;
+
+	// anything still holding onto the views won't be able to access anything
+	for( int i = 0; i < numViews; ++i ) {
+		state->views[i]->data = NULL;
+		state->views[i]->entityID = INVALID_ENTITY_ID;
+	}
+
+	if( state->failed ) {
+		return lua_error( ls );
+	}
+
+	lua_pushinteger( ls, state->count );
+	return 1;
+}
+
+void xLua_RegisterComponentViews( lua_State* ls )
+{
+	ASSERT_AND_IF_NOT( ls != NULL ) return;
+
+	luaL_newmetatable( ls, VIEW_METATABLE );
+	lua_pushcfunction( ls, view_Index );
+	lua_setfield( ls, -2, "__index" );
+	lua_pushcfunction( ls, view_NewIndex );
+	lua_setfield( ls, -2, "__newindex" );
+	lua_pushboolean( ls, 0 );
+	lua_setfield( ls, -2, "__metatable" );
+	lua_pop( ls, 1 );
+
+	lua_register( ls, "getComponentView", lua_GetComponentView );
+	lua_register( ls, "getComponentFieldIndex", lua_GetComponentFieldIndex );
+	lua_register( ls, "getComponentFieldNames", lua_GetComponentFieldNames );
+	lua_register( ls, "forEachComponentView", lua_ForEachComponentView );
+
+	// so the profiler counts them as part of the engine
+	xLua_ProfilerAddBinding( view_Index );
+	xLua_ProfilerAddBinding( view_NewIndex );
+	xLua_ProfilerAddBinding( lua_GetComponentView );
+	xLua_ProfilerAddBinding( lua_GetComponentFieldIndex );
+	xLua_ProfilerAddBinding( lua_GetComponentFieldNames );
+	xLua_ProfilerAddBinding( lua_ForEachComponentView );
+}
+
+void xLua_CleanUpComponentViews( lua_State* ls )
+{
+	for( size_t i = 0; i < sb_Count( sbLayouts ); ++i ) {
+		if( ls != NULL ) luaL_unref( ls, LUA_REGISTRYINDEX, sbLayouts[i].nameTableRef );
+		sb_Release( sbLayouts[i].sbFields );
+	}
+	sb_Release( sbLayouts );
+}
+
+#endif // scripting enabled
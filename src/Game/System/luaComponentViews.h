@@ -0,0 +1,29 @@
+#ifndef LUA_COMPONENT_VIEWS_H
+#define LUA_COMPONENT_VIEWS_H
+
+#if SCRIPTING_ENABLED
+
+#include "System/luaInterface.h"
+
+// Component views let scripts read and write the fields of a component in place, instead of copying the whole component
+//  out to a table and back with getComponentFromEntity( ) and addComponentToEntity( ). The fields are found by running
+//  the component's serialize function, see serializer_GenerateFieldLayout( ).
+//
+// Functions available to scripts:
+//  getComponentView( entityID, componentName ) - view that looks the entity up on every access, nil if the entity doesn't
+//   have the component
+//  getComponentFieldIndex( componentName, fieldName ) - index that can be used instead of the name to skip the lookup
+//  getComponentFieldNames( componentName ) - array of all the field names
+//  forEachComponentView( func, componentName, ... ) - calls func( entityID, view, ... ) for every entity with all the
+//   components, returns how many entities it was called for. The views are reused between calls and should not be kept
+//   past them. Adding and removing entities and components is delayed until all the entities have been processed.
+//
+// Fields are accessed with their serialized names, nested structures are joined with '.', e.g. view["futurePos.x"]
+void xLua_RegisterComponentViews( lua_State* ls );
+
+// the cached field lookups are stored in the Lua state, call before closing it
+void xLua_CleanUpComponentViews( lua_State* ls );
+
+#endif // scripting enabled
+
+#endif // inclusion guard
@@ -26,6 +26,9 @@ static lua_State* luaState = NULL;
 #include "Graphics/imageSheets.h"
 #include "UI/uiEntities.h"
 #include "DefaultECPS/defaultECPS.h"
+#include "System/luaComponentViews.h"
+#include "System/luaBytecodeCache.h"
+#include "System/luaProfiler.h"
 
 static int lua_LoadAndDoFile( lua_State* ls )
 {
@@ -615,6 +618,7 @@ static int lua_AddComponentToEntity( lua_State* ls )
 	ecps_GetComponentTypeSize( &defaultECPS, compID, &compSize );
 
 	void* compData = mem_Allocate( compSize );
+	SDL_memset( compData, 0, compSize ); // anything the serialize function doesn't touch shouldn't be garbage
 
 	Serializer luaDeserializer;
 	serializer_CreateReadLua( ls, &luaDeserializer );
@@ -751,18 +755,201 @@ static int lua_GetComponentFromEntity( lua_State* ls )
 #pragma warning( pop )
 //************************************************************************************
 
+//************************************************************************************
+// Garbage collection
+// In XLUA_GC_FRAME_BUDGET mode Lua's collector is stopped so it never runs in the middle of a script. A cycle is started
+//  once the heap has doubled since the last one finished and is stepped through in small pieces until the frame's budget
+//  is used up. Nothing is collected between frames, so long loads should be followed by xLua_FullGarbageCollect( ). If
+//  an allocation fails Lua will still do an emergency collection.
+
+// Lua's default, start the next cycle once the heap has doubled
+#define GC_PAUSE_PERCENT 200
+// Lua's default step size is 2^13 bytes, which works out to sweeping around 100,000 objects in one step. At 2^1 each
+//  step rounds down to the smallest amount of work Lua can do so the budget can be checked between them. 0 would
+//  leave the step size unchanged.
+#define GC_DEFAULT_STEP_SIZE 13
+#define GC_BUDGETED_STEP_SIZE 1
+
+static XLuaGCMode gcMode = XLUA_GC_AUTOMATIC;
+static float gcMinBudgetMS = 0.25f;
+static float gcMaxBudgetMS = 2.0f;
+
+static size_t gcHeapBytes = 0;
+static size_t gcThresholdBytes = 0;
+static bool gcCycleRunning = false;
+static float gcCurrentCycleMS = 0.0f;
+static float gcLastCycleMS = 0.0f;
+static float gcAllocationRate = 0.0f; // bytes per frame, smoothed
+
+static XLuaGCFrameStats gcFrameStats;
+static XLuaGCFrameStats gcLastFrameStats;
+
+static void setGCThreshold( void )
+{
+	gcThresholdBytes = ( gcHeapBytes / 100 ) * GC_PAUSE_PERCENT;
+}
+
+static void applyGCMode( void )
+{
+	if( luaState == NULL ) return;
+
+	// only the incremental collector can be stepped in small enough pieces
+	if( gcMode == XLUA_GC_FRAME_BUDGET ) {
+		lua_gc( luaState, LUA_GCINC, 0, 0, GC_BUDGETED_STEP_SIZE );
+		// stepping still works when stopped
+		lua_gc( luaState, LUA_GCSTOP );
+		setGCThreshold( );
+	} else {
+		lua_gc( luaState, LUA_GCINC, 0, 0, GC_DEFAULT_STEP_SIZE );
+		lua_gc( luaState, LUA_GCRESTART );
+	}
+	gcCycleRunning = false;
+	gcCurrentCycleMS = 0.0f;
+}
+
+// how long each frame needs to spend collecting so the cycle is done before the heap grows past the next threshold,
+//  based on how long the last cycle took and how fast memory is being allocated
+static float calculateGCBudget( void )
+{
+	float budget = gcMinBudgetMS;
+
+	size_t headroom = gcThresholdBytes - ( gcThresholdBytes / ( GC_PAUSE_PERCENT / 100 ) );
+	if( ( headroom > 0 ) && ( gcLastCycleMS > 0.0f ) ) {
+		float framesUntilThreshold = (float)headroom / SDL_max( gcAllocationRate, 1.0f );
+		budget = ( gcLastCycleMS / framesUntilThreshold ) * 1.25f;
+	}
+
+	// falling behind, the heap has grown half again past where the cycle started
+	if( gcHeapBytes > ( gcThresholdBytes + ( gcThresholdBytes / 2 ) ) ) {
+		budget = gcMaxBudgetMS;
+	}
+	budget = SDL_clamp( budget, gcMinBudgetMS, gcMaxBudgetMS );
+
+	// can't keep up even at the maximum, let the budget grow with the heap instead of letting the heap grow without limit
+	if( gcHeapBytes > ( gcThresholdBytes * 2 ) ) {
+		budget = gcMaxBudgetMS * ( (float)gcHeapBytes / (float)( gcThresholdBytes * 2 ) );
+	}
+
+	return budget;
+}
+
+static void finishGCCycle( void )
+{
+	gcCycleRunning = false;
+	gcLastCycleMS = gcCurrentCycleMS;
+	gcCurrentCycleMS = 0.0f;
+	setGCThreshold( );
+	gcFrameStats.cycleFinished = true;
+}
+
+void xLua_SetGCMode( XLuaGCMode mode )
+{
+	gcMode = mode;
+	applyGCMode( );
+}
+
+XLuaGCMode xLua_GetGCMode( void )
+{
+	return gcMode;
+}
+
+void xLua_SetGCFrameBudget( float minMS, float maxMS )
+{
+	ASSERT_AND_IF_NOT( ( minMS >= 0.0f ) && ( maxMS >= minMS ) ) return;
+
+	gcMinBudgetMS = minMS;
+	gcMaxBudgetMS = maxMS;
+}
+
+void xLua_GCFrameStep( void )
+{
+	if( luaState == NULL ) return;
+
+	gcAllocationRate = ( gcAllocationRate * 0.9f ) + ( (float)gcFrameStats.bytesAllocated * 0.1f );
+
+	if( gcMode == XLUA_GC_FRAME_BUDGET ) {
+		if( !gcCycleRunning && ( gcHeapBytes >= gcThresholdBytes ) ) {
+			gcCycleRunning = true;
+		}
+
+		if( gcCycleRunning ) {
+			float budget = calculateGCBudget( );
+			Uint64 budgetTicks = (Uint64)( ( budget / 1000.0f ) * (float)SDL_GetPerformanceFrequency( ) );
+			Uint64 start = SDL_GetPerformanceCounter( );
+			do {
+				++gcFrameStats.numSteps;
+				// a basic step, has to check the time often enough to stay close to the budget
+				if( lua_gc( luaState, LUA_GCSTEP, 0 ) != 0 ) {
+					finishGCCycle( );
+					break;
+				}
+			} while( ( SDL_GetPerformanceCounter( ) - start ) < budgetTicks );
+
+			float elapsedMS = ( (float)( SDL_GetPerformanceCounter( ) - start ) * 1000.0f ) / (float)SDL_GetPerformanceFrequency( );
+			if( gcCycleRunning ) gcCurrentCycleMS += elapsedMS;
+			else gcLastCycleMS += elapsedMS;
+			gcFrameStats.collectionMS += elapsedMS;
+			gcFrameStats.budgetMS = budget;
+		}
+	}
+
+	gcFrameStats.heapBytes = gcHeapBytes;
+	gcLastFrameStats = gcFrameStats;
+	SDL_memset( &gcFrameStats, 0, sizeof( gcFrameStats ) );
+}
+
+void xLua_FullGarbageCollect( void )
+{
+	if( luaState == NULL ) return;
+
+	Uint64 start = SDL_GetPerformanceCounter( );
+	lua_gc( luaState, LUA_GCCOLLECT );
+	gcFrameStats.collectionMS += ( (float)( SDL_GetPerformanceCounter( ) - start ) * 1000.0f ) / (float)SDL_GetPerformanceFrequency( );
+	++gcFrameStats.numFullCollections;
+
+	// any partial cycle was finished by the full collection, it's time isn't useful for the budget
+	gcCycleRunning = false;
+	gcCurrentCycleMS = 0.0f;
+	setGCThreshold( );
+}
+
+void xLua_GetGCFrameStats( XLuaGCFrameStats* outStats )
+{
+	ASSERT_AND_IF_NOT( outStats != NULL ) return;
+	*outStats = gcLastFrameStats;
+}
+
+static int lua_FullGarbageCollect( lua_State* ls )
+{
+	xLua_FullGarbageCollect( );
+	return 0;
+}
+
 //************************************************************************************
 // C level callbacks
 static void* memoryAllocation( void* ud, void* ptr, size_t oldSize, size_t newSize )
 {
 	// based on this:
 	//  https://www.lua.org/manual/5.3/manual.html#4.8
+	// when ptr is NULL oldSize is the type of object being created instead of a size
+	size_t oldBytes = ( ptr != NULL ) ? oldSize : 0;
+
 	if( newSize == 0 ) {
 		mem_Release( ptr );
+		gcHeapBytes -= oldBytes;
+		++gcFrameStats.numFrees;
 		return NULL;
 	}
 
-	return mem_Resize( ptr, newSize );
+	void* newPtr = mem_Resize( ptr, newSize );
+	if( newPtr != NULL ) {
+		gcHeapBytes = ( gcHeapBytes - oldBytes ) + newSize;
+		if( newSize > oldBytes ) {
+			gcFrameStats.bytesAllocated += newSize - oldBytes;
+			if( ptr == NULL ) ++gcFrameStats.numAllocations;
+		}
+	}
+	return newPtr;
 }
 
 static void warnFunction( void* ud, const char* msg, int tocont )
@@ -912,6 +1099,7 @@ void xLua_RegisterCFunction( const char* luaFuncName, lua_CFunction cFunc )
 	ASSERT( luaState != NULL );
 	// todo: error handling
 	lua_register( luaState, luaFuncName, cFunc );
+	xLua_ProfilerAddBinding( cFunc );
 }
 
 static int loadAndRunFile( lua_State* ls )
@@ -952,16 +1140,71 @@ static int loadAndRunFileOnce( lua_State* ls )
 	// see if the file is already loaded, if it is then don't do it
 }
 
+// pushes the next parameter from the variable arguments, returns false if the type is unknown
+static bool pushParameter( char type, va_list* vl )
+{
+	switch( type ) {
+	case 'i':
+		lua_pushinteger( luaState, va_arg( *vl, int ) );
+		return true;
+	case 'd':
+		lua_pushnumber( luaState, va_arg( *vl, double ) );
+		return true;
+	case 's':
+		lua_pushstring( luaState, va_arg( *vl, char* ) );
+		return true;
+	case 'b':
+		lua_pushboolean( luaState, va_arg( *vl, int ) ? 1 : 0 ); // bools are promoted to int when passed through ...
+		return true;
+	case 'n':
+		lua_pushnil( luaState );
+		return true;
+	default:
+		return false;
+	}
+}
+
+// writes the return value at idx out to the next pointer in the variable arguments, returns false if the type is unknown
+static bool readReturn( char type, int idx, va_list* vl )
+{
+	switch( type ) {
+	case 'i':
+		*va_arg( *vl, int* ) = (int)lua_tointeger( luaState, idx );
+		return true;
+	case 'd':
+		*va_arg( *vl, double* ) = lua_tonumber( luaState, idx );
+		return true;
+	case 's': {
+		size_t size;
+		const char* luaStr = lua_tolstring( luaState, idx, &size );
+		char** retStr = va_arg( *vl, char** );
+		if( ( luaStr == NULL ) || ( size == 0 ) ) {
+			*retStr = NULL;
+		} else {
+			*retStr = mem_Allocate( sizeof( char ) * ( size + 1 ) );
+			SDL_memcpy( *retStr, luaStr, sizeof( char ) * ( size + 1 ) );
+		}
+	}	return true;
+	case 'b':
+		*va_arg( *vl, bool* ) = ( lua_toboolean( luaState, idx ) == 1 );
+		return true;
+	case 'n':
+		// don't do anything
+		return true;
+	default:
+		return false;
+	}
+}
+
 // the signature is a string we use to define the parameters to send into the function
 //  and the returns to get back from it
 // i = integer
 // d = double
-// f = float
 // s = string
 // b = bool
 // n = nil when parameter, ignored when return, do not pass in anything for nil parameters
 // | = break between parameters and return
-// so the signature "df|si" would be for a function that takes a double and a float, and returns a string and an integer
+// so the signature "ds|si" would be for a function that takes a double and a string, and returns a string and an integer
 //  based on code from here: https://www.lua.org/pil/25.3.html
 // for strings we create a copy of it, so they must be released after being returned from here, use mem_Release
 //  if the string is empty or returns NULL we just return NULL for the value
@@ -971,6 +1214,7 @@ bool xLua_CallLuaFunction( const char* funcName, const char* signature, ... )
 	int retCnt = 0;
 
 	if( !xLua_GetGlobalFunc( funcName ) ) {
+		lua_pop( luaState, 1 );
 		return false;
 	}
 
@@ -978,81 +1222,37 @@ bool xLua_CallLuaFunction( const char* funcName, const char* signature, ... )
 	va_start( vl, signature );
 	bool paramsDone = false;
 	while( ( signature != NULL ) && ( *signature ) && !paramsDone ) {
-		switch( *signature ) {
-		case 'i':
-			lua_pushinteger( luaState, va_arg( vl, int ) );
-			break;
-		case 'd':
-			lua_pushnumber( luaState, va_arg( vl, double ) );
-			break;
-		case 's':
-			lua_pushstring( luaState, va_arg( vl, char* ) );
-			break;
-		case 'b':
-			lua_pushboolean( luaState, va_arg( vl, bool ) ? 1 : 0 );
-			break;
-		case 'n':
-			lua_pushnil( luaState );
-			break;
-		case '|':
+		if( *signature == '|' ) {
 			paramsDone = true;
-			break;
-		default:
+		} else if( !lua_checkstack( luaState, 1 ) ) {
+			llog( LOG_ERROR, "Too many parameters to Lua function." );
+			lua_pop( luaState, argCnt + 1 );
+			va_end( vl );
+			return false;
+		} else if( pushParameter( *signature, &vl ) ) {
+			++argCnt;
+		} else {
 			llog( LOG_ERROR, "Unknown parameter definition '%c' when calling function %s.", *signature, funcName );
-			break;
 		}
 		++signature;
-
-		if( !paramsDone ) {
-			++argCnt;
-			if( !lua_checkstack( luaState, 1 ) ) {
-				llog( LOG_ERROR, "Too many parameters to Lua function." );
-				return false;
-			}
-		}
 	}
 
 	// call the function
-	retCnt = (int)SDL_strlen( signature );
+	retCnt = ( signature != NULL ) ? (int)SDL_strlen( signature ) : 0;
 	int status = xLua_DoCall( argCnt, retCnt );
 	if( status != LUA_OK ) {
 		// there was an error, none of the return signature values are needed as there won't be any
 		//  just log the error and return that it failed
 		llog( LOG_ERROR, "%s", lua_tostring( luaState, -1 ) );
 		lua_pop( luaState, 1 );
+		va_end( vl );
 		return false;
 	}
 
 	int idx = -retCnt;
 	while( ( signature != NULL ) && *signature ) {
-		switch( *signature ) {
-		case 'i':
-			*va_arg( vl, int* ) = (int)lua_tointeger( luaState, idx );
-			break;
-		case 'd':
-			*va_arg( vl, double* ) = lua_tonumber( luaState, idx );
-			break;
-		case 's': {
-			size_t size;
-			const char* luaStr = lua_tolstring( luaState, idx, &size );
-			char* retStr = va_arg( vl, char* );
-			if( ( luaStr == NULL ) || ( size == 0 ) ) {
-				retStr = NULL;
-			} else {
-				retStr = mem_Allocate( sizeof( char ) * ( size + 1 ) );
-				SDL_memcpy( retStr, luaStr, sizeof( char ) * ( size + 1 ) );
-			}
-		}
-			break;
-		case 'b':
-			*va_arg( vl, bool* ) = ( lua_toboolean( luaState, idx ) == 1 );
-			break;
-		case 'n':
-			// don't do anything
-			break;
-		default:
+		if( !readReturn( *signature, idx, &vl ) ) {
 			llog( LOG_ERROR, "Unknown parameter definition '%c' when calling function %s.", *signature, funcName );
-			break;
 		}
 
 		++idx;
@@ -1065,6 +1265,252 @@ bool xLua_CallLuaFunction( const char* funcName, const char* signature, ... )
 	return true;
 }
 
+//************************************************************************************
+// Cached function handles, used for things that are called often like entity callbacks.
+
+#define MAX_FUNC_VALUES 8
+#define HANDLE_INDEX_MASK 0xFFFF
+#define HANDLE_GENERATION_SHIFT 16
+
+typedef struct {
+	char* funcName;
+	char* signature;
+	int refCount; // slot is free when this is 0
+	uint16_t slotGeneration; // changed every time the slot is reused so old handles to it stop working
+
+	int ref; // registry reference to the function, LUA_NOREF if it hasn't been found
+	uint32_t resolvedGeneration; // scriptGeneration when ref was last looked up
+
+	char params[MAX_FUNC_VALUES];
+	int numParams;
+	char returns[MAX_FUNC_VALUES];
+	int numReturns;
+} FuncHandleEntry;
+
+static FuncHandleEntry* sbFuncEntries = NULL;
+
+// changed whenever a file is run or the state is recreated, any handles resolved before that need to be looked up again
+static uint32_t scriptGeneration = 1;
+
+static bool parseSignature( const char* signature, FuncHandleEntry* entry )
+{
+	entry->numParams = 0;
+	entry->numReturns = 0;
+
+	bool paramsDone = false;
+	for( const char* c = signature; ( c != NULL ) && ( *c != 0 ); ++c ) {
+		if( *c == '|' ) {
+			if( paramsDone ) {
+				llog( LOG_ERROR, "Multiple parameter breaks in Lua function signature %s.", signature );
+				return false;
+			}
+			paramsDone = true;
+			continue;
+		}
+
+		if( SDL_strchr( "idsbn", *c ) == NULL ) {
+			llog( LOG_ERROR, "Unknown parameter definition '%c' in Lua function signature %s.", *c, signature );
+			return false;
+		}
+
+		if( paramsDone ) {
+			if( entry->numReturns >= MAX_FUNC_VALUES ) {
+				llog( LOG_ERROR, "Too many returns in Lua function signature %s.", signature );
+				return false;
+			}
+			entry->returns[entry->numReturns++] = *c;
+		} else {
+			if( entry->numParams >= MAX_FUNC_VALUES ) {
+				llog( LOG_ERROR, "Too many parameters in Lua function signature %s.", signature );
+				return false;
+			}
+			entry->params[entry->numParams++] = *c;
+		}
+	}
+
+	return true;
+}
+
+static FuncHandleEntry* getFuncEntry( XLuaFuncHandle handle )
+{
+	uint32_t idx = ( handle & HANDLE_INDEX_MASK );
+	if( ( idx == 0 ) || ( idx > sb_Count( sbFuncEntries ) ) ) {
+		return NULL;
+	}
+
+	FuncHandleEntry* entry = &( sbFuncEntries[idx - 1] );
+	if( ( entry->refCount <= 0 ) || ( entry->slotGeneration != (uint16_t)( handle >> HANDLE_GENERATION_SHIFT ) ) ) {
+		return NULL;
+	}
+
+	return entry;
+}
+
+static XLuaFuncHandle createFuncHandle( size_t idx )
+{
+	return ( (XLuaFuncHandle)sbFuncEntries[idx].slotGeneration << HANDLE_GENERATION_SHIFT ) | (XLuaFuncHandle)( idx + 1 );
+}
+
+// looks up the global function and stores it in the registry, if it isn't found the entry won't try again until the
+//  scripts have changed
+static void resolveFuncEntry( FuncHandleEntry* entry )
+{
+	if( entry->ref != LUA_NOREF ) {
+		luaL_unref( luaState, LUA_REGISTRYINDEX, entry->ref );
+		entry->ref = LUA_NOREF;
+	}
+	entry->resolvedGeneration = scriptGeneration;
+
+	if( lua_getglobal( luaState, entry->funcName ) != LUA_TFUNCTION ) {
+		llog( LOG_ERROR, "%s is not a global function", entry->funcName );
+		lua_pop( luaState, 1 );
+		return;
+	}
+
+	entry->ref = luaL_ref( luaState, LUA_REGISTRYINDEX );
+}
+
+XLuaFuncHandle xLua_AcquireFunction( const char* funcName, const char* signature )
+{
+	ASSERT_AND_IF_NOT( funcName != NULL ) return XLUA_INVALID_FUNC_HANDLE;
+	if( signature == NULL ) signature = "";
+
+	// share the entry if there's already one
+	size_t freeIdx = SIZE_MAX;
+	for( size_t i = 0; i < sb_Count( sbFuncEntries ); ++i ) {
+		FuncHandleEntry* entry = &( sbFuncEntries[i] );
+		if( entry->refCount <= 0 ) {
+			if( freeIdx == SIZE_MAX ) freeIdx = i;
+			continue;
+		}
+
+		if( ( SDL_strcmp( entry->funcName, funcName ) == 0 ) && ( SDL_strcmp( entry->signature, signature ) == 0 ) ) {
+			++( entry->refCount );
+			return createFuncHandle( i );
+		}
+	}
+
+	FuncHandleEntry newEntry;
+	SDL_zero( newEntry );
+	if( !parseSignature( signature, &newEntry ) ) {
+		return XLUA_INVALID_FUNC_HANDLE;
+	}
+
+	if( freeIdx == SIZE_MAX ) {
+		if( sb_Count( sbFuncEntries ) >= HANDLE_INDEX_MASK ) {
+			llog( LOG_ERROR, "Too many Lua function handles." );
+			return XLUA_INVALID_FUNC_HANDLE;
+		}
+		freeIdx = sb_Count( sbFuncEntries );
+		sb_Push( sbFuncEntries, newEntry );
+	} else {
+		newEntry.slotGeneration = (uint16_t)( sbFuncEntries[freeIdx].slotGeneration + 1 );
+		sbFuncEntries[freeIdx] = newEntry;
+	}
+
+	FuncHandleEntry* entry = &( sbFuncEntries[freeIdx] );
+	entry->funcName = createStringCopy( funcName );
+	entry->signature = createStringCopy( signature );
+	entry->refCount = 1;
+	entry->ref = LUA_NOREF;
+	entry->resolvedGeneration = 0; // look it up the first time it's called
+
+	return createFuncHandle( freeIdx );
+}
+
+void xLua_ReleaseFunction( XLuaFuncHandle handle )
+{
+	FuncHandleEntry* entry = getFuncEntry( handle );
+	if( entry == NULL ) return;
+
+	--( entry->refCount );
+	if( entry->refCount > 0 ) return;
+
+	if( ( entry->ref != LUA_NOREF ) && ( luaState != NULL ) ) {
+		luaL_unref( luaState, LUA_REGISTRYINDEX, entry->ref );
+	}
+	entry->ref = LUA_NOREF;
+
+	mem_Release( entry->funcName );
+	entry->funcName = NULL;
+	mem_Release( entry->signature );
+	entry->signature = NULL;
+}
+
+const char* xLua_GetFunctionName( XLuaFuncHandle handle )
+{
+	FuncHandleEntry* entry = getFuncEntry( handle );
+	return ( entry != NULL ) ? entry->funcName : NULL;
+}
+
+bool xLua_CallFunction( XLuaFuncHandle handle, ... )
+{
+	ASSERT( luaState != NULL );
+
+	FuncHandleEntry* entry = getFuncEntry( handle );
+	if( entry == NULL ) {
+		llog( LOG_ERROR, "Attempting to call an invalid Lua function handle." );
+		return false;
+	}
+
+	if( entry->resolvedGeneration != scriptGeneration ) {
+		resolveFuncEntry( entry );
+	}
+
+	if( entry->ref == LUA_NOREF ) {
+		return false;
+	}
+
+	if( !lua_checkstack( luaState, entry->numParams + 2 ) ) {
+		llog( LOG_ERROR, "Unable to grow Lua stack to call %s.", entry->funcName );
+		return false;
+	}
+
+	// the function being called could acquire other handles and move the entries, so copy what we need after the call
+	char returns[MAX_FUNC_VALUES];
+	int numReturns = entry->numReturns;
+	SDL_memcpy( returns, entry->returns, sizeof( returns[0] ) * numReturns );
+
+	lua_rawgeti( luaState, LUA_REGISTRYINDEX, entry->ref );
+
+	va_list vl;
+	va_start( vl, handle );
+	for( int i = 0; i < entry->numParams; ++i ) {
+		pushParameter( entry->params[i], &vl );
+	}
+
+	int status = xLua_DoCall( entry->numParams, numReturns );
+	if( status != LUA_OK ) {
+		llog( LOG_ERROR, "%s", lua_tostring( luaState, -1 ) );
+		lua_pop( luaState, 1 );
+		va_end( vl );
+		return false;
+	}
+
+	for( int i = 0; i < numReturns; ++i ) {
+		readReturn( returns[i], i - numReturns, &vl );
+	}
+	lua_pop( luaState, numReturns );
+
+	va_end( vl );
+
+	return true;
+}
+
+void xLua_InvalidateFunctionHandles( void )
+{
+	++scriptGeneration;
+}
+
+// the registry goes away with the state, the handles stay valid and will find their functions again once there's a new one
+static void dropFunctionReferences( void )
+{
+	for( size_t i = 0; i < sb_Count( sbFuncEntries ); ++i ) {
+		sbFuncEntries[i].ref = LUA_NOREF;
+	}
+	++scriptGeneration;
+}
+
 // gets all the keys in a global table
 //  uses stretchy buffers, so use the sb_ functions to query and clean up
 char** xLua_GetLuaTableKeys( const char* tableName )
@@ -1164,7 +1610,13 @@ bool xLua_LoadAndDoFile( const char* fileName )
 	// TODO: need to cache files that have already been executed and not run them again, should
 	//       return whatever the original file execution returned
 
-	int status = luaL_dofile( luaState, fileName );	
+	// uses the compiled version if there's an up to date one
+	int status = xLua_LoadChunk( luaState, fileName );
+	if( status == LUA_OK ) {
+		status = lua_pcall( luaState, 0, LUA_MULTRET, 0 );
+	}
+	// even a failed file could have changed globals before it stopped
+	xLua_InvalidateFunctionHandles( );
 	if( status != LUA_OK ) {
 		llog( LOG_ERROR, "%s", lua_tostring( luaState, -1 ) );
 		lua_pop( luaState, 1 );
@@ -1215,6 +1667,7 @@ bool xLua_Init( void )
 	}
 
 	lua_setwarnf( luaState, warnFunction, NULL );
+	applyGCMode( );
 
 	// load the basic libraries, copied from linit.c but modified to only open the libraries we want
 	const luaL_Reg* lib;
@@ -1271,6 +1724,8 @@ bool xLua_Init( void )
 	xLua_RegisterCFunction( "addComponentToEntity", lua_AddComponentToEntity );
 	xLua_RegisterCFunction( "removeComponentFromEntity", lua_RemoveComponentFromEntity );
 	xLua_RegisterCFunction( "getComponentFromEntity", lua_GetComponentFromEntity );
+	xLua_RegisterCFunction( "fullGarbageCollect", lua_FullGarbageCollect );
+	xLua_RegisterComponentViews( luaState );
 
 	return true;
 }
@@ -1282,8 +1737,20 @@ void xLua_ShutDown( void )
 		return;
 	}
 
+	xLua_StopProfiling( );
+	dropFunctionReferences( );
+	xLua_CleanUpComponentViews( luaState );
 	lua_close( luaState );
 	luaState = NULL;
+
+	gcHeapBytes = 0;
+	gcThresholdBytes = 0;
+	gcCycleRunning = false;
+	gcCurrentCycleMS = 0.0f;
+	gcLastCycleMS = 0.0f;
+	gcAllocationRate = 0.0f;
+	SDL_memset( &gcFrameStats, 0, sizeof( gcFrameStats ) );
+	SDL_memset( &gcLastFrameStats, 0, sizeof( gcLastFrameStats ) );
 }
 
 // for when you want to access it for something the interface doesn't provide
@@ -1347,4 +1814,60 @@ bool xLua_CallLuaFunction( const char* funcName, const char* paramDef, ... )
 	return false;
 }
 
+XLuaFuncHandle xLua_AcquireFunction( const char* funcName, const char* signature )
+{
+	return XLUA_INVALID_FUNC_HANDLE;
+}
+
+void xLua_ReleaseFunction( XLuaFuncHandle handle )
+{
+	return;
+}
+
+const char* xLua_GetFunctionName( XLuaFuncHandle handle )
+{
+	return NULL;
+}
+
+bool xLua_CallFunction( XLuaFuncHandle handle, ... )
+{
+	ASSERT_ALWAYS( "Scripting not enabled." );
+	return false;
+}
+
+void xLua_InvalidateFunctionHandles( void )
+{
+	return;
+}
+
+void xLua_SetGCMode( XLuaGCMode mode )
+{
+	return;
+}
+
+XLuaGCMode xLua_GetGCMode( void )
+{
+	return XLUA_GC_AUTOMATIC;
+}
+
+void xLua_SetGCFrameBudget( float minMS, float maxMS )
+{
+	return;
+}
+
+void xLua_GCFrameStep( void )
+{
+	return;
+}
+
+void xLua_FullGarbageCollect( void )
+{
+	return;
+}
+
+void xLua_GetGCFrameStats( XLuaGCFrameStats* outStats )
+{
+	SDL_memset( outStats, 0, sizeof( *outStats ) );
+}
+
 #endif
\ No newline at end of file
@@ -2,6 +2,36 @@
 #define LUA_INTERFACE_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Handle to a global Lua function. The function is looked up once and kept in the registry along with the parsed signature,
+//  so calling through a handle avoids the global lookup and signature parsing xLua_CallLuaFunction does on every call.
+//  Loading a file can redefine any global so the reference is looked up again the first time the handle is used after one.
+typedef uint32_t XLuaFuncHandle;
+#define XLUA_INVALID_FUNC_HANDLE 0
+
+// XLUA_GC_AUTOMATIC leaves collection up to Lua, which runs it during whatever allocation pushes it over the limit.
+//  XLUA_GC_FRAME_BUDGET moves collection to xLua_GCFrameStep( ), which is given a time budget each frame. The budget
+//  grows with the allocation rate so each cycle finishes before the heap grows too far, and is clamped to the range
+//  given in xLua_SetGCFrameBudget( ).
+typedef enum {
+	XLUA_GC_AUTOMATIC,
+	XLUA_GC_FRAME_BUDGET
+} XLuaGCMode;
+
+// everything is for the last call to xLua_GCFrameStep( )
+typedef struct {
+	size_t heapBytes;
+	size_t bytesAllocated; // newly requested by Lua, doesn't subtract anything freed
+	uint32_t numAllocations;
+	uint32_t numFrees;
+	uint32_t numSteps;
+	uint32_t numFullCollections;
+	float collectionMS; // only collections that were asked for, in XLUA_GC_AUTOMATIC mode Lua collects during allocations
+	float budgetMS; // 0 if there was nothing to collect
+	bool cycleFinished;
+} XLuaGCFrameStats;
 
 #if SCRIPTING_ENABLED
 
@@ -28,6 +58,20 @@ void xLua_RegisterCFunction( const char* luaFuncName, lua_CFunction cFunc );
 
 bool xLua_CallLuaFunction( const char* funcName, const char* paramDef, ... );
 
+// handles to the same function with the same signature are shared, every acquire needs a matching release
+//  the signature uses the same format as xLua_CallLuaFunction, returns XLUA_INVALID_FUNC_HANDLE if it's invalid
+XLuaFuncHandle xLua_AcquireFunction( const char* funcName, const char* signature );
+void xLua_ReleaseFunction( XLuaFuncHandle handle );
+
+// returns the name the handle was acquired with, NULL if the handle is invalid
+const char* xLua_GetFunctionName( XLuaFuncHandle handle );
+
+// same as xLua_CallLuaFunction but with the signature given when the handle was acquired
+bool xLua_CallFunction( XLuaFuncHandle handle, ... );
+
+// forces every handle to look up its function again, only needed if globals are changed without going through xLua_LoadAndDoFile
+void xLua_InvalidateFunctionHandles( void );
+
 // gets all the keys in a global table
 //  uses stretchy buffers, so use the sb_ functions to query and clean up
 char** xLua_GetLuaTableKeys( const char* tableName );
@@ -44,6 +88,20 @@ bool xLua_Init( void );
 // shutdown Lua
 void xLua_ShutDown( void );
 
+// can be set before or after xLua_Init( )
+void xLua_SetGCMode( XLuaGCMode mode );
+XLuaGCMode xLua_GetGCMode( void );
+void xLua_SetGCFrameBudget( float minMS, float maxMS );
+
+// call once a frame, does the collection in XLUA_GC_FRAME_BUDGET mode and gathers the stats in both modes
+void xLua_GCFrameStep( void );
+
+// finishes any cycle in progress and does a full collection, for when a hitch won't be noticed (e.g. level transitions)
+//  scripts can call this with fullGarbageCollect( )
+void xLua_FullGarbageCollect( void );
+
+void xLua_GetGCFrameStats( XLuaGCFrameStats* outStats );
+
 // for when you want to access it for something the interface doesn't provide
 lua_State* xLua_GetState( void );
 
@@ -62,6 +120,17 @@ bool xLua_Init( void );
 void xLua_ShutDown( void );
 bool xLua_LoadAndDoFile( const char* fileName );
 bool xLua_CallLuaFunction( const char* funcName, const char* paramDef, ... );
+XLuaFuncHandle xLua_AcquireFunction( const char* funcName, const char* signature );
+void xLua_ReleaseFunction( XLuaFuncHandle handle );
+const char* xLua_GetFunctionName( XLuaFuncHandle handle );
+bool xLua_CallFunction( XLuaFuncHandle handle, ... );
+void xLua_InvalidateFunctionHandles( void );
+void xLua_SetGCMode( XLuaGCMode mode );
+XLuaGCMode xLua_GetGCMode( void );
+void xLua_SetGCFrameBudget( float minMS, float maxMS );
+void xLua_GCFrameStep( void );
+void xLua_FullGarbageCollect( void );
+void xLua_GetGCFrameStats( XLuaGCFrameStats* outStats );
 
 #endif // scripting enable
 
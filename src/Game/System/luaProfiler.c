@@ -0,0 +1,642 @@
+#include "luaProfiler.h"
+
+#if SCRIPTING_ENABLED
+
+#include <SDL3/SDL.h>
+
+#include "System/platformLog.h"
+#include "System/memory.h"
+#include "Utils/stretchyBuffer.h"
+#include "Utils/hashMap.h"
+#include "Utils/helpers.h"
+
+#define DEFAULT_SAMPLE_INSTRUCTIONS 1000
+#define MAX_STACK_DEPTH 256
+#define MAX_TRACE_EVENTS 1000000
+#define MAX_FUNCTION_NAME_SIZE 128
+#define FUNCTION_CACHE_SIZE 256 // needs to be a power of two
+
+typedef enum {
+	FK_SCRIPT,
+	FK_BINDING,
+	FK_LIBRARY,
+	NUM_FUNCTION_KINDS
+} FunctionKind;
+
+static const char* kindNames[NUM_FUNCTION_KINDS] = { "script", "binding", "library" };
+
+typedef struct {
+	const void* key; // source for Lua functions, the function pointer for C functions
+	int line; // where a Lua function is defined, -1 for C functions
+	int lastLine; // these two tell apart Lua functions defined on the same line
+	int shape;
+	char name[MAX_FUNCTION_NAME_SIZE];
+	FunctionKind kind;
+	uint64_t calls;
+	uint64_t inclusiveTicks;
+	uint64_t exclusiveTicks;
+	uint64_t samples;
+	int activeCount; // recursive calls only count towards the inclusive time once
+} ProfiledFunction;
+
+// one for each unique call stack, the root has no function
+typedef struct {
+	int function;
+	int parent;
+	int firstChild;
+	int nextSibling;
+	uint64_t calls;
+	uint64_t inclusiveTicks;
+	uint64_t exclusiveTicks;
+	uint64_t samples;
+} CallNode;
+
+typedef struct {
+	int node;
+	int depth; // of the Lua stack
+	Uint64 startTicks;
+	Uint64 childTicks;
+} ActiveCall;
+
+typedef struct {
+	int function;
+	Uint64 startTicks;
+	Uint64 durationTicks;
+} TraceEvent;
+
+typedef struct {
+	const void* key;
+	int line;
+	int lastLine;
+	int shape;
+	int function;
+} FunctionCacheEntry;
+
+static lua_State* profiledState = NULL;
+static lua_State* lastProfiledState = NULL;
+static XLuaProfileMode profileMode = XLUA_PROFILE_INSTRUMENTED;
+
+// time spent in the hook is removed so the profiler doesn't count itself
+static Uint64 hookTicks = 0;
+static Uint64 profileBaseTicks = 0;
+
+static ProfiledFunction* sbFunctions = NULL;
+static HashMap functionMap;
+static bool functionMapCreated = false;
+static FunctionCacheEntry functionCache[FUNCTION_CACHE_SIZE];
+
+static CallNode* sbNodes = NULL;
+static ActiveCall* sbCallStack = NULL;
+static TraceEvent* sbTrace = NULL;
+static size_t numDroppedEvents = 0;
+
+static lua_CFunction* sbBindings = NULL;
+
+static Uint64 profileClock( void )
+{
+	return SDL_GetPerformanceCounter( ) - hookTicks;
+}
+
+static double ticksToMicroseconds( uint64_t ticks )
+{
+	return ( (double)ticks * 1000000.0 ) / (double)SDL_GetPerformanceFrequency( );
+}
+
+static bool isBinding( lua_CFunction func )
+{
+	for( size_t i = 0; i < sb_Count( sbBindings ); ++i ) {
+		if( sbBindings[i] == func ) return true;
+	}
+	return false;
+}
+
+static void clearFunctionLookup( void )
+{
+	if( functionMapCreated ) {
+		hashMap_Clear( &functionMap );
+		functionMapCreated = false;
+	}
+	for( size_t i = 0; i < FUNCTION_CACHE_SIZE; ++i ) {
+		functionCache[i].key = NULL;
+	}
+}
+
+// functions called from C (e.g. with xLua_CallLuaFunction or pcall) don't have a name, see if they're a global
+static const char* findGlobalName( lua_State* ls, lua_Debug* ar, char* buffer, size_t bufferSize )
+{
+	const char* name = NULL;
+
+	lua_getinfo( ls, "f", ar );
+	lua_pushglobaltable( ls );
+	lua_pushnil( ls );
+	while( lua_next( ls, -2 ) != 0 ) {
+		if( ( lua_type( ls, -2 ) == LUA_TSTRING ) && lua_rawequal( ls, -1, -4 ) ) {
+			SDL_strlcpy( buffer, lua_tostring( ls, -2 ), bufferSize );
+			name = buffer;
+			lua_pop( ls, 2 );
+			break;
+		}
+		lua_pop( ls, 1 );
+	}
+	lua_pop( ls, 2 );
+
+	return name;
+}
+
+static void setFunctionName( ProfiledFunction* func, lua_State* ls, lua_Debug* ar )
+{
+	// the name comes from how it was called, so the same function can have different names, just use the first one
+	lua_getinfo( ls, "n", ar );
+
+	char globalName[MAX_FUNCTION_NAME_SIZE];
+	if( ar->name == NULL ) {
+		ar->name = findGlobalName( ls, ar, globalName, sizeof( globalName ) );
+	}
+
+	if( func->kind == FK_SCRIPT ) {
+		if( ar->name != NULL ) {
+			SDL_snprintf( func->name, sizeof( func->name ), "%s (%s:%i)", ar->name, ar->short_src, ar->linedefined );
+		} else if( ar->linedefined == 0 ) {
+			SDL_snprintf( func->name, sizeof( func->name ), "main chunk (%s)", ar->short_src );
+		} else {
+			SDL_snprintf( func->name, sizeof( func->name ), "anonymous (%s:%i)", ar->short_src, ar->linedefined );
+		}
+	} else {
+		if( ar->name != NULL ) {
+			SDL_snprintf( func->name, sizeof( func->name ), "%s", ar->name );
+		} else {
+			SDL_snprintf( func->name, sizeof( func->name ), "C function %p", func->key );
+		}
+	}
+
+	// these would break the folded stack format
+	for( char* c = func->name; *c != 0; ++c ) {
+		if( ( *c == ';' ) || ( *c == '\n' ) || ( *c == '\r' ) ) {
+			*c = ':';
+		}
+	}
+}
+
+// ar has to have been filled in with at least "S"
+static int getFunction( lua_State* ls, lua_Debug* ar )
+{
+	const void* key;
+	int line;
+	int lastLine;
+	int shape;
+	lua_CFunction cFunc = NULL;
+	if( ar->what[0] == 'C' ) {
+		lua_getinfo( ls, "f", ar );
+		cFunc = lua_tocfunction( ls, -1 );
+		lua_pop( ls, 1 );
+		key = (const void*)cFunc;
+		line = -1;
+		lastLine = -1;
+		shape = 0;
+	} else {
+		// there's no way to get at the prototype, so use everything we know about it to tell apart functions that
+		//  start on the same line
+		lua_getinfo( ls, "u", ar );
+		key = (const void*)ar->source;
+		line = ar->linedefined;
+		lastLine = ar->lastlinedefined;
+		shape = ( ( ( ar->nups << 8 ) | ar->nparams ) << 1 ) | ( ar->isvararg ? 1 : 0 );
+	}
+
+	size_t cacheIdx = ( ( (uintptr_t)key >> 4 ) ^ (uintptr_t)line ^ ( (uintptr_t)lastLine << 3 ) ^ (uintptr_t)shape ) & ( FUNCTION_CACHE_SIZE - 1 );
+	FunctionCacheEntry* cached = &functionCache[cacheIdx];
+	if( ( cached->key == key ) && ( cached->line == line ) && ( cached->lastLine == lastLine ) && ( cached->shape == shape ) ) {
+		return cached->function;
+	}
+
+	char mapKey[96];
+	SDL_snprintf( mapKey, sizeof( mapKey ), "%p:%i:%i:%i", key, line, lastLine, shape );
+
+	if( !functionMapCreated ) {
+		hashMap_Init( &functionMap, 256, NULL );
+		functionMapCreated = true;
+	}
+
+	int idx;
+	if( !hashMap_Find( &functionMap, mapKey, &idx ) ) {
+		ProfiledFunction newFunc;
+		SDL_memset( &newFunc, 0, sizeof( newFunc ) );
+		newFunc.key = key;
+		newFunc.line = line;
+		newFunc.lastLine = lastLine;
+		newFunc.shape = shape;
+		if( line >= 0 ) {
+			newFunc.kind = FK_SCRIPT;
+		} else {
+			newFunc.kind = isBinding( cFunc ) ? FK_BINDING : FK_LIBRARY;
+		}
+		setFunctionName( &newFunc, ls, ar );
+
+		idx = (int)sb_Count( sbFunctions );
+		sb_Push( sbFunctions, newFunc );
+		hashMap_Set( &functionMap, mapKey, idx );
+	}
+
+	cached->key = key;
+	cached->line = line;
+	cached->lastLine = lastLine;
+	cached->shape = shape;
+	cached->function = idx;
+
+	return idx;
+}
+
+static int findChildNode( int parent, int function )
+{
+	for( int c = sbNodes[parent].firstChild; c >= 0; c = sbNodes[c].nextSibling ) {
+		if( sbNodes[c].function == function ) return c;
+	}
+
+	CallNode node;
+	SDL_memset( &node, 0, sizeof( node ) );
+	node.function = function;
+	node.parent = parent;
+	node.firstChild = -1;
+	node.nextSibling = sbNodes[parent].firstChild;
+
+	int idx = (int)sb_Count( sbNodes );
+	sb_Push( sbNodes, node );
+	sbNodes[parent].firstChild = idx;
+	return idx;
+}
+
+static void createRootNode( void )
+{
+	if( sb_Count( sbNodes ) > 0 ) return;
+
+	CallNode root;
+	SDL_memset( &root, 0, sizeof( root ) );
+	root.function = -1;
+	root.parent = -1;
+	root.firstChild = -1;
+	root.nextSibling = -1;
+	sb_Push( sbNodes, root );
+}
+
+static void startCall( int function, int depth, Uint64 now )
+{
+	int parent = ( sb_Count( sbCallStack ) > 0 ) ? sb_Last( sbCallStack ).node : 0;
+
+	ActiveCall call;
+	call.node = findChildNode( parent, function );
+	call.depth = depth;
+	call.startTicks = now;
+	call.childTicks = 0;
+	sb_Push( sbCallStack, call );
+
+	++sbFunctions[function].activeCount;
+}
+
+static void finishCall( Uint64 now )
+{
+	ActiveCall call = sb_Pop( sbCallStack );
+	Uint64 duration = now - call.startTicks;
+	Uint64 exclusive = ( duration > call.childTicks ) ? ( duration - call.childTicks ) : 0;
+
+	CallNode* node = &sbNodes[call.node];
+	++node->calls;
+	node->inclusiveTicks += duration;
+	node->exclusiveTicks += exclusive;
+
+	ProfiledFunction* func = &sbFunctions[node->function];
+	++func->calls;
+	func->exclusiveTicks += exclusive;
+	--func->activeCount;
+	if( func->activeCount <= 0 ) {
+		func->activeCount = 0;
+		func->inclusiveTicks += duration;
+	}
+
+	if( sb_Count( sbCallStack ) > 0 ) {
+		sb_Last( sbCallStack ).childTicks += duration;
+	}
+
+	if( sb_Count( sbTrace ) < MAX_TRACE_EVENTS ) {
+		TraceEvent evt = { node->function, call.startTicks, duration };
+		sb_Push( sbTrace, evt );
+	} else {
+		++numDroppedEvents;
+	}
+}
+
+static void finishAllCalls( Uint64 now )
+{
+	while( sb_Count( sbCallStack ) > 0 ) {
+		finishCall( now );
+	}
+}
+
+// finishes every call at or above depth, they've either returned or been unwound
+static void finishCallsFrom( int depth, Uint64 now )
+{
+	while( ( sb_Count( sbCallStack ) > 0 ) && ( sb_Last( sbCallStack ).depth >= depth ) ) {
+		finishCall( now );
+	}
+}
+
+// number of levels on the Lua stack, getting a level walks the stack so search for the last one instead of stepping
+//  through them all
+static int stackDepth( lua_State* ls )
+{
+	lua_Debug info;
+	int low = 1;
+	int high = 1;
+	while( lua_getstack( ls, high, &info ) ) {
+		low = high;
+		high *= 2;
+	}
+	while( low < high ) {
+		int mid = ( low + high ) / 2;
+		if( lua_getstack( ls, mid, &info ) ) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return high;
+}
+
+static void takeSample( lua_State* ls )
+{
+	int stack[MAX_STACK_DEPTH];
+	int depth = 0;
+
+	lua_Debug info;
+	for( int level = 0; ( depth < MAX_STACK_DEPTH ) && lua_getstack( ls, level, &info ); ++level ) {
+		lua_getinfo( ls, "S", &info );
+		stack[depth++] = getFunction( ls, &info );
+	}
+	if( depth == 0 ) return;
+
+	int node = 0;
+	for( int i = depth - 1; i >= 0; --i ) {
+		node = findChildNode( node, stack[i] );
+	}
+	++sbNodes[node].samples;
+	++sbFunctions[stack[0]].samples;
+}
+
+static void profileHook( lua_State* ls, lua_Debug* ar )
+{
+	Uint64 hookStart = SDL_GetPerformanceCounter( );
+	Uint64 now = hookStart - hookTicks;
+
+	// coroutines inherit the hook, they're counted as part of whatever resumed them
+	if( ls != profiledState ) goto done;
+
+	switch( ar->event ) {
+	case LUA_HOOKCALL:
+	case LUA_HOOKTAILCALL: {
+		lua_getinfo( ls, "S", ar );
+		int function = getFunction( ls, ar );
+
+		// anything already at this depth is gone, a tail call replaces its caller and errors caught by lua_pcall unwind
+		//  the stack without any return hooks
+		int depth = stackDepth( ls );
+		finishCallsFrom( depth, now );
+		startCall( function, depth, now );
+	} break;
+
+	case LUA_HOOKRET:
+		// anything above the call returning was unwound by an error, if there's nothing at this depth it was called
+		//  before we started profiling
+		finishCallsFrom( stackDepth( ls ), now );
+		break;
+
+	case LUA_HOOKCOUNT:
+		takeSample( ls );
+		break;
+	}
+
+done:
+	hookTicks += SDL_GetPerformanceCounter( ) - hookStart;
+}
+
+bool xLua_StartProfiling( XLuaProfileMode mode, int sampleInstructions )
+{
+	lua_State* ls = xLua_GetState( );
+	if( ls == NULL ) {
+		llog( LOG_ERROR, "Lua hasn't been initialized." );
+		return false;
+	}
+
+	if( profiledState != NULL ) {
+		llog( LOG_WARN, "Already profiling." );
+		return false;
+	}
+
+	// results from different modes can't be combined
+	if( ( sb_Count( sbNodes ) > 1 ) && ( mode != profileMode ) ) {
+		xLua_ClearProfile( );
+	}
+
+	// a new state can reuse the addresses of the old one
+	if( ls != lastProfiledState ) {
+		clearFunctionLookup( );
+		lastProfiledState = ls;
+	}
+
+	createRootNode( );
+	if( profileBaseTicks == 0 ) {
+		hookTicks = 0;
+		profileBaseTicks = profileClock( );
+	}
+
+	profiledState = ls;
+	profileMode = mode;
+
+	if( mode == XLUA_PROFILE_SAMPLED ) {
+		lua_sethook( ls, profileHook, LUA_MASKCOUNT, ( sampleInstructions > 0 ) ? sampleInstructions : DEFAULT_SAMPLE_INSTRUCTIONS );
+	} else {
+		lua_sethook( ls, profileHook, LUA_MASKCALL | LUA_MASKRET, 0 );
+	}
+
+	return true;
+}
+
+void xLua_StopProfiling( void )
+{
+	if( profiledState == NULL ) return;
+
+	lua_sethook( profiledState, NULL, 0, 0 );
+	finishAllCalls( profileClock( ) );
+	profiledState = NULL;
+}
+
+bool xLua_IsProfiling( void )
+{
+	return ( profiledState != NULL );
+}
+
+void xLua_ClearProfile( void )
+{
+	ASSERT_AND_IF_NOT( profiledState == NULL ) return;
+
+	clearFunctionLookup( );
+	sb_Release( sbFunctions );
+	sb_Release( sbNodes );
+	sb_Release( sbCallStack );
+	sb_Release( sbTrace );
+	numDroppedEvents = 0;
+	hookTicks = 0;
+	profileBaseTicks = 0;
+}
+
+void xLua_ProfilerAddBinding( lua_CFunction func )
+{
+	if( ( func == NULL ) || isBinding( func ) ) return;
+	sb_Push( sbBindings, func );
+
+	for( size_t i = 0; i < sb_Count( sbFunctions ); ++i ) {
+		if( ( sbFunctions[i].line < 0 ) && ( sbFunctions[i].key == (const void*)func ) ) {
+			sbFunctions[i].kind = FK_BINDING;
+		}
+	}
+}
+
+static uint64_t functionWeight( int idx )
+{
+	return ( profileMode == XLUA_PROFILE_SAMPLED ) ? sbFunctions[idx].samples : sbFunctions[idx].exclusiveTicks;
+}
+
+static int compareFunctionWeight( const void* left, const void* right )
+{
+	uint64_t l = functionWeight( *(const int*)left );
+	uint64_t r = functionWeight( *(const int*)right );
+	return ( l < r ) - ( l > r );
+}
+
+void xLua_LogProfile( int maxFunctions )
+{
+	if( sb_Count( sbFunctions ) == 0 ) {
+		llog( LOG_INFO, "No Lua profile recorded." );
+		return;
+	}
+
+	int* sbOrder = NULL;
+	uint64_t kindTotals[NUM_FUNCTION_KINDS] = { 0 };
+	for( size_t i = 0; i < sb_Count( sbFunctions ); ++i ) {
+		sb_Push( sbOrder, (int)i );
+		kindTotals[sbFunctions[i].kind] += functionWeight( (int)i );
+	}
+	SDL_qsort( sbOrder, sb_Count( sbOrder ), sizeof( sbOrder[0] ), compareFunctionWeight );
+
+	int count = (int)sb_Count( sbOrder );
+	if( ( maxFunctions > 0 ) && ( maxFunctions < count ) ) count = maxFunctions;
+
+	if( profileMode == XLUA_PROFILE_SAMPLED ) {
+		llog( LOG_INFO, "Lua profile, samples in scripts: %llu  bindings: %llu  libraries: %llu",
+			(unsigned long long)kindTotals[FK_SCRIPT], (unsigned long long)kindTotals[FK_BINDING], (unsigned long long)kindTotals[FK_LIBRARY] );
+		for( int i = 0; i < count; ++i ) {
+			ProfiledFunction* func = &sbFunctions[sbOrder[i]];
+			llog( LOG_INFO, "  %10llu samples  [%s] %s", (unsigned long long)func->samples, kindNames[func->kind], func->name );
+		}
+	} else {
+		llog( LOG_INFO, "Lua profile, exclusive time in scripts: %.3f ms  bindings: %.3f ms  libraries: %.3f ms",
+			ticksToMicroseconds( kindTotals[FK_SCRIPT] ) / 1000.0, ticksToMicroseconds( kindTotals[FK_BINDING] ) / 1000.0,
+			ticksToMicroseconds( kindTotals[FK_LIBRARY] ) / 1000.0 );
+		for( int i = 0; i < count; ++i ) {
+			ProfiledFunction* func = &sbFunctions[sbOrder[i]];
+			llog( LOG_INFO, "  excl: %10.3f ms  incl: %10.3f ms  calls: %10llu  [%s] %s",
+				ticksToMicroseconds( func->exclusiveTicks ) / 1000.0, ticksToMicroseconds( func->inclusiveTicks ) / 1000.0,
+				(unsigned long long)func->calls, kindNames[func->kind], func->name );
+		}
+		if( numDroppedEvents > 0 ) {
+			llog( LOG_INFO, "  %u calls weren't recorded for the trace.", (uint32_t)numDroppedEvents );
+		}
+	}
+
+	sb_Release( sbOrder );
+}
+
+static void writeJSONString( SDL_IOStream* ioStream, const char* str )
+{
+	SDL_WriteU8( ioStream, '"' );
+	for( const char* c = str; *c != 0; ++c ) {
+		if( ( *c == '"' ) || ( *c == '\\' ) ) {
+			SDL_IOprintf( ioStream, "\\%c", *c );
+		} else if( (unsigned char)*c < 0x20 ) {
+			SDL_IOprintf( ioStream, "\\u%04x", (unsigned int)(unsigned char)*c );
+		} else {
+			SDL_WriteU8( ioStream, (Uint8)*c );
+		}
+	}
+	SDL_WriteU8( ioStream, '"' );
+}
+
+bool xLua_SaveProfileTrace( const char* fileName )
+{
+	ASSERT_AND_IF_NOT( fileName != NULL ) return false;
+
+	if( profileMode != XLUA_PROFILE_INSTRUMENTED ) {
+		llog( LOG_ERROR, "Traces can only be saved when instrumenting." );
+		return false;
+	}
+
+	SDL_IOStream* ioStream = SDL_IOFromFile( fileName, "w" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open file %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	SDL_IOprintf( ioStream, "{\"traceEvents\":[\n" );
+	for( size_t i = 0; i < sb_Count( sbTrace ); ++i ) {
+		ProfiledFunction* func = &sbFunctions[sbTrace[i].function];
+		SDL_IOprintf( ioStream, "{\"name\":" );
+		writeJSONString( ioStream, func->name );
+		SDL_IOprintf( ioStream, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}%s\n",
+			kindNames[func->kind], ticksToMicroseconds( sbTrace[i].startTicks - profileBaseTicks ),
+			ticksToMicroseconds( sbTrace[i].durationTicks ), ( ( i + 1 ) < sb_Count( sbTrace ) ) ? "," : "" );
+	}
+	SDL_IOprintf( ioStream, "],\"displayTimeUnit\":\"ms\"}\n" );
+
+	if( !SDL_CloseIO( ioStream ) ) {
+		llog( LOG_ERROR, "Error writing trace %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	llog( LOG_INFO, "Saved %u Lua calls to %s", (uint32_t)sb_Count( sbTrace ), fileName );
+	return true;
+}
+
+bool xLua_SaveProfileFoldedStacks( const char* fileName )
+{
+	ASSERT_AND_IF_NOT( fileName != NULL ) return false;
+
+	SDL_IOStream* ioStream = SDL_IOFromFile( fileName, "w" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Unable to open file %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	int path[MAX_STACK_DEPTH];
+	for( size_t i = 1; i < sb_Count( sbNodes ); ++i ) {
+		CallNode* node = &sbNodes[i];
+		uint64_t weight = ( profileMode == XLUA_PROFILE_SAMPLED ) ? node->samples : (uint64_t)ticksToMicroseconds( node->exclusiveTicks );
+		if( weight == 0 ) continue;
+
+		int depth = 0;
+		for( int n = (int)i; ( n > 0 ) && ( depth < MAX_STACK_DEPTH ); n = sbNodes[n].parent ) {
+			path[depth++] = sbNodes[n].function;
+		}
+
+		for( int d = depth - 1; d >= 0; --d ) {
+			SDL_IOprintf( ioStream, "%s%s", sbFunctions[path[d]].name, ( d > 0 ) ? ";" : "" );
+		}
+		SDL_IOprintf( ioStream, " %llu\n", (unsigned long long)weight );
+	}
+
+	if( !SDL_CloseIO( ioStream ) ) {
+		llog( LOG_ERROR, "Error writing folded stacks %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	return true;
+}
+
+#endif
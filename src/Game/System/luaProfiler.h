@@ -0,0 +1,51 @@
+#ifndef LUA_PROFILER_H
+#define LUA_PROFILER_H
+
+#include <stdbool.h>
+
+#if SCRIPTING_ENABLED
+
+#include "System/luaInterface.h"
+
+// Profiles scripts using Lua's debug hooks. Nothing is hooked while the profiler is stopped so having it compiled in
+//  costs nothing.
+//
+// XLUA_PROFILE_INSTRUMENTED uses the call and return hooks to time every call. Gives exact call counts and inclusive
+//  and exclusive times, and can be saved as a Chrome trace. Adds a fixed cost to every call, so functions that are
+//  called a lot will look more expensive than they are.
+// XLUA_PROFILE_SAMPLED uses the count hook to record the stack every so many instructions. Much cheaper, but only sees
+//  Lua code, time inside C functions is only seen as time not spent running instructions.
+//
+// Functions are grouped into scripts, engine bindings (anything registered with xLua_RegisterCFunction( ) or
+//  xLua_ProfilerAddBinding( )) and the Lua libraries, so it's easy to tell if the time is in the scripts or the engine.
+// Only the main Lua thread is profiled, time spent in coroutines is counted as part of the function that resumed them.
+typedef enum {
+	XLUA_PROFILE_INSTRUMENTED,
+	XLUA_PROFILE_SAMPLED
+} XLuaProfileMode;
+
+// sampleInstructions is only used in XLUA_PROFILE_SAMPLED mode, <= 0 uses the default
+bool xLua_StartProfiling( XLuaProfileMode mode, int sampleInstructions );
+void xLua_StopProfiling( void );
+bool xLua_IsProfiling( void );
+
+// throws away everything recorded so far, can't be done while profiling
+void xLua_ClearProfile( void );
+
+// marks a C function as an engine binding, for functions that are registered without xLua_RegisterCFunction( )
+void xLua_ProfilerAddBinding( lua_CFunction func );
+
+// logs the functions with the most exclusive time and the totals for scripts, bindings, and libraries
+void xLua_LogProfile( int maxFunctions );
+
+// saves the calls in the Chrome trace event format, can be opened in chrome://tracing or https://ui.perfetto.dev
+//  only available for XLUA_PROFILE_INSTRUMENTED
+bool xLua_SaveProfileTrace( const char* fileName );
+
+// saves folded stacks ("outer;inner;innermost weight" per line) that flamegraph.pl and speedscope can read
+//  the weight is exclusive microseconds when instrumented and the number of samples when sampled
+bool xLua_SaveProfileFoldedStacks( const char* fileName );
+
+#endif // scripting enabled
+
+#endif // inclusion guard
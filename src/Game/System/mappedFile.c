@@ -0,0 +1,122 @@
+#include "mappedFile.h"
+
+#include <SDL3/SDL.h>
+
+#if defined( _WIN32 )
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+	#define USE_FILE_MAPPING
+#elif !defined( __ANDROID__ ) && !defined( __EMSCRIPTEN__ )
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#define USE_MMAP
+#endif
+
+#include "System/platformLog.h"
+
+static bool loadEntireFile( const char* fileName, MappedFile* outFile )
+{
+	size_t size = 0;
+	void* data = SDL_LoadFile( fileName, &size );
+	if( data == NULL ) {
+		llog( LOG_ERROR, "Unable to load file %s: %s", fileName, SDL_GetError( ) );
+		return false;
+	}
+
+	if( size == 0 ) {
+		SDL_free( data );
+		return false;
+	}
+
+	outFile->data = (const uint8_t*)data;
+	outFile->size = size;
+	outFile->isMapped = false;
+	return true;
+}
+
+bool mappedFile_Open( const char* fileName, MappedFile* outFile )
+{
+	SDL_assert( fileName != NULL );
+	SDL_assert( outFile != NULL );
+
+	SDL_memset( outFile, 0, sizeof( *outFile ) );
+
+#if defined( USE_FILE_MAPPING )
+	HANDLE file = CreateFileA( fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( file == INVALID_HANDLE_VALUE ) {
+		// could be somewhere SDL knows how to get to but we don't
+		return loadEntireFile( fileName, outFile );
+	}
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( file, &size ) || ( size.QuadPart <= 0 ) ) {
+		CloseHandle( file );
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping == NULL ) {
+		CloseHandle( file );
+		return loadEntireFile( fileName, outFile );
+	}
+
+	const uint8_t* data = (const uint8_t*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if( data == NULL ) {
+		CloseHandle( mapping );
+		CloseHandle( file );
+		return loadEntireFile( fileName, outFile );
+	}
+
+	outFile->data = data;
+	outFile->size = (size_t)size.QuadPart;
+	outFile->isMapped = true;
+	outFile->fileHandle = file;
+	outFile->mappingHandle = mapping;
+	return true;
+#elif defined( USE_MMAP )
+	int fd = open( fileName, O_RDONLY );
+	if( fd < 0 ) {
+		return loadEntireFile( fileName, outFile );
+	}
+
+	struct stat info;
+	if( ( fstat( fd, &info ) != 0 ) || ( info.st_size <= 0 ) ) {
+		close( fd );
+		return false;
+	}
+
+	void* data = mmap( NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd ); // the mapping keeps the file alive
+	if( data == MAP_FAILED ) {
+		return loadEntireFile( fileName, outFile );
+	}
+
+	outFile->data = (const uint8_t*)data;
+	outFile->size = (size_t)info.st_size;
+	outFile->isMapped = true;
+	return true;
+#else
+	return loadEntireFile( fileName, outFile );
+#endif
+}
+
+void mappedFile_Close( MappedFile* file )
+{
+	if( ( file == NULL ) || ( file->data == NULL ) ) return;
+
+	if( !file->isMapped ) {
+		SDL_free( (void*)file->data );
+	} else {
+#if defined( USE_FILE_MAPPING )
+		UnmapViewOfFile( file->data );
+		CloseHandle( (HANDLE)file->mappingHandle );
+		CloseHandle( (HANDLE)file->fileHandle );
+#elif defined( USE_MMAP )
+		munmap( (void*)file->data, file->size );
+#endif
+	}
+
+	SDL_memset( file, 0, sizeof( *file ) );
+}
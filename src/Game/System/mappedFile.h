@@ -0,0 +1,25 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Read only view of an entire file. On desktop platforms the file is memory mapped so nothing is read until it's
+//  touched, on platforms where that isn't possible (Android assets, the web) the whole file is loaded into memory instead.
+typedef struct {
+	const uint8_t* data;
+	size_t size;
+
+	bool isMapped;
+	void* fileHandle;
+	void* mappingHandle;
+} MappedFile;
+
+// Returns false if the file couldn't be opened or is empty.
+bool mappedFile_Open( const char* fileName, MappedFile* outFile );
+
+// Releases the view, any pointers into the data are invalid after this.
+void mappedFile_Close( MappedFile* file );
+
+#endif // inclusion guard
@@ -89,6 +89,8 @@ typedef struct {
 	void* watchedAddress;
 	MemoryBlockHeader* watchedHeader;
 	size_t totalSize;
+
+	uint64_t allocationCount;
 } MemoryArena;
 
 static MemoryArena memoryBlock = { NULL, NULL, NULL, NULL };
@@ -761,6 +763,7 @@ void* mem_Allocate_Data( size_t size, const char* fileName, const int line )
 		assert( result != NULL );
 
 		if( result != NULL ) {
+			++memoryBlock.allocationCount;
 	#ifdef TEST_EVERY_CHANGE
 			internal_verifyPointer( result, false );
 	#endif
@@ -799,6 +802,7 @@ void* mem_Resize_Data( void* memory, size_t newSize, const char* fileName, const
 				MemoryBlockHeader* header = (MemoryBlockHeader*)( (uintptr_t)memory - MEMORY_HEADER_SIZE );
 				if( newSize > header->size ) {
 					result = growBlock( header, newSize, fileName, line );
+					++memoryBlock.allocationCount;
 				} else if( newSize < header->size ) {
 					result = shrinkBlock( header, newSize, fileName, line );
 				}
@@ -971,6 +975,15 @@ size_t mem_GetMemoryUsed( void )
 	return memoryTotal;
 }
 
+uint64_t mem_GetAllocationCount( void )
+{
+	uint64_t count;
+	lockMemoryMutex( ); {
+		count = memoryBlock.allocationCount;
+	} unlockMemoryMutex( );
+	return count;
+}
+
 // gets the amount memory used between the start and the last allocated block
 //  works better than mem_GetMemoryUsed() if you want to determine the maximum amount of memory the program uses as it
 //  takes fragmentation into account
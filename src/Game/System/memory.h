@@ -48,6 +48,10 @@ void mem_DetachAllChildren( void* parent );
 // gets the amount of currently allocated memory
 size_t mem_GetMemoryUsed( void );
 
+// gets the number of allocations since mem_Init( ), resizes that grow a block count as an allocation
+//  compare it before and after some code to see if it's allocating when it shouldn't be
+uint64_t mem_GetAllocationCount( void );
+
 // gets the amount memory used between the start and the last allocated block
 //  works better than mem_GetMemoryUsed() if you want to determine the maximum amount of memory the program uses as it
 //  takes fragmentation into account
@@ -0,0 +1,754 @@
+#include "pathService.h"
+
+#include <SDL3/SDL.h>
+
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "Math/mathUtil.h"
+#include "Utils/helpers.h"
+#include "Utils/stretchyBuffer.h"
+
+#define MAX_WORKERS 16
+#define NUM_BUCKETS 256
+#define MAX_REQUESTS 0xFFFF
+#define DEFAULT_FRAME_BUDGET 4096
+
+// how many nodes a worker expands before checking if it should stop
+#define WORKER_SLICE 1024
+
+typedef enum {
+	SS_FREE,
+	SS_QUEUED,
+	SS_SEARCHING,
+	SS_DONE, // finished but not delivered yet
+	SS_DELIVERED
+} SearchState;
+
+typedef struct {
+	SearchState state;
+
+	void* graph;
+	size_t nodeCount;
+	int startNodeID;
+	int targetNodeID;
+	AStar_CostFunc moveCost;
+	AStar_CostFunc heuristic;
+	AStar_GetNextNeighborFunc nextNeighbor;
+
+	int priority;
+	uint32_t order;
+	int heapIndex;
+
+	int bucket;
+	int nextInBucket;
+
+	// the requests waiting on this, only touched by the main thread
+	int* sbRequests;
+	int refCount;
+
+	bool found;
+	int* sbPath;
+} Search;
+
+typedef struct {
+	uint16_t generation;
+	bool used;
+	PathRequestStatus status;
+	int priority;
+	int search;
+	PathService_ResultFunc onDone;
+	void* userData;
+} RequestSlot;
+
+typedef struct {
+	AStarContext context;
+	int* sbPath;
+	bool busy; // has a job queued or running
+	int search;
+	SDL_AtomicInt abort;
+} PathWorker;
+
+static SDL_Mutex* mutex = NULL;
+
+static Search* sbSearches = NULL;
+static int* sbFreeSearches = NULL;
+static int buckets[NUM_BUCKETS];
+static int* sbQueue = NULL; // heap of queued searches
+static uint32_t nextOrder = 0;
+
+static int* sbCompleted = NULL;
+static int* sbDelivering = NULL;
+static PathRequest* sbDeliverRequests = NULL;
+
+static RequestSlot* sbRequests = NULL;
+static int* sbFreeRequests = NULL;
+
+static PathWorker workers[MAX_WORKERS];
+static int numWorkers = 0;
+static bool shuttingDown = false;
+
+// used when there are no workers
+static AStarContext mainContext;
+static int* sbMainPath = NULL;
+static int mainSearch = -1;
+static int frameBudget = DEFAULT_FRAME_BUDGET;
+
+static PathServiceStats stats;
+
+#ifdef THREAD_SUPPORT
+static void lock( void )
+{
+	if( mutex == NULL ) return;
+	SDL_LockMutex( mutex );
+}
+
+static void unlock( void )
+{
+	if( mutex == NULL ) return;
+	SDL_UnlockMutex( mutex );
+}
+#else
+static void lock( void ) { }
+static void unlock( void ) { }
+#endif
+
+static PathRequest makeHandle( int idx )
+{
+	return ( ( (uint32_t)sbRequests[idx].generation ) << 16 ) | (uint32_t)idx;
+}
+
+// returns the slot index for the handle, -1 if it's not valid
+static int getRequestIdx( PathRequest request )
+{
+	int idx = (int)( request & 0xFFFF );
+	uint16_t generation = (uint16_t)( request >> 16 );
+	if( ( generation == 0 ) || ( idx >= (int)sb_Count( sbRequests ) ) ) return -1;
+	if( !sbRequests[idx].used || ( sbRequests[idx].generation != generation ) ) return -1;
+	return idx;
+}
+
+// ***** Queue
+
+// returns whether search a should be done before search b
+static bool isHigherPriority( int a, int b )
+{
+	if( sbSearches[a].priority != sbSearches[b].priority ) {
+		return sbSearches[a].priority > sbSearches[b].priority;
+	}
+	return (int32_t)( sbSearches[a].order - sbSearches[b].order ) < 0;
+}
+
+static void queueSwap( int a, int b )
+{
+	int temp = sbQueue[a];
+	sbQueue[a] = sbQueue[b];
+	sbQueue[b] = temp;
+	sbSearches[sbQueue[a]].heapIndex = a;
+	sbSearches[sbQueue[b]].heapIndex = b;
+}
+
+static void queueSiftUp( int heapIdx )
+{
+	while( heapIdx > 0 ) {
+		int parentIdx = ( heapIdx - 1 ) / 2;
+		if( !isHigherPriority( sbQueue[heapIdx], sbQueue[parentIdx] ) ) break;
+		queueSwap( heapIdx, parentIdx );
+		heapIdx = parentIdx;
+	}
+}
+
+static void queueSiftDown( int heapIdx )
+{
+	int count = (int)sb_Count( sbQueue );
+	for( ;; ) {
+		int best = heapIdx;
+		int left = ( heapIdx * 2 ) + 1;
+		int right = left + 1;
+		if( ( left < count ) && isHigherPriority( sbQueue[left], sbQueue[best] ) ) best = left;
+		if( ( right < count ) && isHigherPriority( sbQueue[right], sbQueue[best] ) ) best = right;
+		if( best == heapIdx ) break;
+		queueSwap( heapIdx, best );
+		heapIdx = best;
+	}
+}
+
+static void queuePush( int searchIdx )
+{
+	sbSearches[searchIdx].heapIndex = (int)sb_Count( sbQueue );
+	sb_Push( sbQueue, searchIdx );
+	queueSiftUp( sbSearches[searchIdx].heapIndex );
+}
+
+static void queueRemove( int searchIdx )
+{
+	int heapIdx = sbSearches[searchIdx].heapIndex;
+	int lastIdx = (int)sb_Count( sbQueue ) - 1;
+	if( heapIdx != lastIdx ) {
+		queueSwap( heapIdx, lastIdx );
+	}
+	(void)sb_Pop( sbQueue );
+	sbSearches[searchIdx].heapIndex = -1;
+
+	if( heapIdx < lastIdx ) {
+		queueSiftUp( heapIdx );
+		queueSiftDown( sbSearches[sbQueue[heapIdx]].heapIndex );
+	}
+}
+
+// ***** Searches
+
+static int hashSearch( void* graph, size_t nodeCount, int startNodeID, int targetNodeID )
+{
+	uint64_t h = (uint64_t)(uintptr_t)graph;
+	h ^= ( (uint64_t)nodeCount * 0x9E3779B97F4A7C15ull );
+	h ^= ( (uint64_t)(uint32_t)startNodeID * 0xC2B2AE3D27D4EB4Full );
+	h ^= ( (uint64_t)(uint32_t)targetNodeID * 0x165667B19E3779F9ull );
+	h ^= ( h >> 29 );
+	h *= 0xBF58476D1CE4E5B9ull;
+	h ^= ( h >> 32 );
+	return (int)( h & ( NUM_BUCKETS - 1 ) );
+}
+
+static void removeFromBucket( int searchIdx )
+{
+	int* link = &( buckets[sbSearches[searchIdx].bucket] );
+	while( *link != -1 ) {
+		if( *link == searchIdx ) {
+			*link = sbSearches[searchIdx].nextInBucket;
+			break;
+		}
+		link = &( sbSearches[*link].nextInBucket );
+	}
+	sbSearches[searchIdx].nextInBucket = -1;
+}
+
+// finds a search for the same thing that's queued or running
+static int findMatchingSearch( const PathRequestDesc* desc, int bucket )
+{
+	for( int idx = buckets[bucket]; idx != -1; idx = sbSearches[idx].nextInBucket ) {
+		Search* search = &( sbSearches[idx] );
+		if( ( search->graph == desc->graph ) && ( search->nodeCount == desc->nodeCount ) &&
+			( search->startNodeID == desc->startNodeID ) && ( search->targetNodeID == desc->targetNodeID ) &&
+			( search->moveCost == desc->moveCost ) && ( search->heuristic == desc->heuristic ) &&
+			( search->nextNeighbor == desc->nextNeighbor ) ) {
+			return idx;
+		}
+	}
+	return -1;
+}
+
+static int createSearch( const PathRequestDesc* desc, int bucket )
+{
+	int idx;
+	if( sb_Count( sbFreeSearches ) > 0 ) {
+		idx = sb_Pop( sbFreeSearches );
+	} else {
+		idx = (int)sb_Count( sbSearches );
+		Search* newSearch = sb_Add( sbSearches, 1 );
+		SDL_zerop( newSearch );
+	}
+
+	Search* search = &( sbSearches[idx] );
+	int* sbSearchRequests = search->sbRequests;
+	int* sbPath = search->sbPath;
+	SDL_zerop( search );
+	search->sbRequests = sbSearchRequests;
+	search->sbPath = sbPath;
+	sb_Clear( search->sbRequests );
+	sb_Clear( search->sbPath );
+
+	search->state = SS_QUEUED;
+	search->graph = desc->graph;
+	search->nodeCount = desc->nodeCount;
+	search->startNodeID = desc->startNodeID;
+	search->targetNodeID = desc->targetNodeID;
+	search->moveCost = desc->moveCost;
+	search->heuristic = desc->heuristic;
+	search->nextNeighbor = desc->nextNeighbor;
+	search->priority = desc->priority;
+	search->order = nextOrder++;
+
+	search->bucket = bucket;
+	search->nextInBucket = buckets[bucket];
+	buckets[bucket] = idx;
+
+	queuePush( idx );
+
+	++stats.numSearches;
+	return idx;
+}
+
+static void freeSearch( int searchIdx )
+{
+	Search* search = &( sbSearches[searchIdx] );
+	ASSERT( search->refCount == 0 );
+	search->state = SS_FREE;
+	sb_Clear( search->sbRequests );
+	sb_Clear( search->sbPath );
+	sb_Push( sbFreeSearches, searchIdx );
+}
+
+// takes the highest priority search off the queue and marks it as being searched, returns -1 if there isn't one
+static int takeQueuedSearch( void )
+{
+	if( sb_Count( sbQueue ) == 0 ) return -1;
+	int searchIdx = sbQueue[0];
+	queueRemove( searchIdx );
+	sbSearches[searchIdx].state = SS_SEARCHING;
+	return searchIdx;
+}
+
+// stores the result and adds it to the list of searches to deliver, path is NULL if nothing was found
+static void finishSearch( int searchIdx, bool found, const int* path )
+{
+	Search* search = &( sbSearches[searchIdx] );
+	removeFromBucket( searchIdx );
+	search->state = SS_DONE;
+	search->found = found;
+	sb_Clear( search->sbPath );
+	if( found && ( sb_Count( path ) > 0 ) ) {
+		int* dest = sb_Add( search->sbPath, sb_Count( path ) );
+		SDL_memcpy( dest, path, sizeof( path[0] ) * sb_Count( path ) );
+	}
+	sb_Push( sbCompleted, searchIdx );
+}
+
+// ***** Workers
+
+static void workerJob( void* data )
+{
+	PathWorker* worker = (PathWorker*)data;
+
+	lock( ); {
+		int searchIdx = shuttingDown ? -1 : takeQueuedSearch( );
+		while( searchIdx >= 0 ) {
+			// copy out what we need, the search list can move while we don't have the lock
+			Search search = sbSearches[searchIdx];
+			worker->search = searchIdx;
+			SDL_SetAtomicInt( &( worker->abort ), 0 );
+			unlock( );
+
+			bool found = false;
+			bool aborted = false;
+			sb_Clear( worker->sbPath );
+			if( aStar_StartSearch( &( worker->context ), search.graph, search.nodeCount, search.startNodeID, search.targetNodeID,
+				search.moveCost, search.heuristic, search.nextNeighbor ) ) {
+				while( !aStar_StepSearch( &( worker->context ), WORKER_SLICE ) ) {
+					if( SDL_GetAtomicInt( &( worker->abort ) ) != 0 ) {
+						aborted = true;
+						break;
+					}
+				}
+				if( !aborted ) {
+					found = aStar_GetPath( &( worker->context ), &( worker->sbPath ) );
+				}
+			}
+
+			lock( );
+			finishSearch( searchIdx, found, worker->sbPath );
+			worker->search = -1;
+			searchIdx = shuttingDown ? -1 : takeQueuedSearch( );
+		}
+		worker->busy = false;
+	} unlock( );
+}
+
+// queues jobs for idle workers if there's anything waiting, expects the lock to be held
+static void startWorkers( void )
+{
+	int numWaiting = (int)sb_Count( sbQueue );
+	for( int i = 0; ( i < numWorkers ) && ( numWaiting > 0 ); ++i ) {
+		if( workers[i].busy ) continue;
+
+		workers[i].busy = true;
+		jq_AddJob( workerJob, &( workers[i] ) );
+		--numWaiting;
+	}
+}
+
+// runs searches on the main thread until the frame's budget is used up
+static void runFrameBudget( void )
+{
+	int budget = frameBudget;
+	stats.numBudgetedExpansions = 0;
+
+	while( budget > 0 ) {
+		if( mainSearch < 0 ) {
+			mainSearch = takeQueuedSearch( );
+			if( mainSearch < 0 ) break;
+
+			Search* search = &( sbSearches[mainSearch] );
+			if( !aStar_StartSearch( &mainContext, search->graph, search->nodeCount, search->startNodeID, search->targetNodeID,
+				search->moveCost, search->heuristic, search->nextNeighbor ) ) {
+				finishSearch( mainSearch, false, NULL );
+				mainSearch = -1;
+				continue;
+			}
+		}
+
+		if( sbSearches[mainSearch].refCount == 0 ) {
+			// everyone waiting on it was released
+			finishSearch( mainSearch, false, NULL );
+			mainSearch = -1;
+			continue;
+		}
+
+		uint32_t prevExpansions = mainContext.numExpansions;
+		bool done = aStar_StepSearch( &mainContext, budget );
+		int used = MAX( (int)( mainContext.numExpansions - prevExpansions ), 1 );
+		budget -= used;
+		stats.numBudgetedExpansions += (uint32_t)used;
+
+		if( done ) {
+			sb_Clear( sbMainPath );
+			bool found = aStar_GetPath( &mainContext, &sbMainPath );
+			finishSearch( mainSearch, found, sbMainPath );
+			mainSearch = -1;
+		}
+	}
+}
+
+// ***** Requests
+
+static void detachRequest( int requestIdx )
+{
+	RequestSlot* slot = &( sbRequests[requestIdx] );
+	int searchIdx = slot->search;
+	slot->search = -1;
+	if( searchIdx < 0 ) return;
+
+	Search* search = &( sbSearches[searchIdx] );
+	for( size_t i = 0; i < sb_Count( search->sbRequests ); ++i ) {
+		if( search->sbRequests[i] == requestIdx ) {
+			search->sbRequests[i] = sb_Last( search->sbRequests );
+			(void)sb_Pop( search->sbRequests );
+			break;
+		}
+	}
+
+	--search->refCount;
+	if( search->refCount > 0 ) return;
+
+	switch( search->state ) {
+	case SS_QUEUED:
+		queueRemove( searchIdx );
+		removeFromBucket( searchIdx );
+		freeSearch( searchIdx );
+		break;
+	case SS_SEARCHING:
+		// let whoever is running it know it's not needed, it's freed once it's finished
+		for( int i = 0; i < numWorkers; ++i ) {
+			if( workers[i].search == searchIdx ) {
+				SDL_SetAtomicInt( &( workers[i].abort ), 1 );
+			}
+		}
+		// don't want anything new joining a search that's going to be thrown away
+		removeFromBucket( searchIdx );
+		break;
+	case SS_DELIVERED:
+		freeSearch( searchIdx );
+		break;
+	default:
+		// waiting to be delivered, it will be freed then
+		break;
+	}
+}
+
+static void releaseRequest( int requestIdx )
+{
+	detachRequest( requestIdx );
+	RequestSlot* slot = &( sbRequests[requestIdx] );
+	slot->used = false;
+	slot->status = PRS_INVALID;
+	sb_Push( sbFreeRequests, requestIdx );
+}
+
+// sets the priority of the search to the highest priority of the requests waiting on it
+static void updateSearchPriority( int searchIdx )
+{
+	Search* search = &( sbSearches[searchIdx] );
+	if( ( search->state != SS_QUEUED ) || ( sb_Count( search->sbRequests ) == 0 ) ) return;
+
+	int priority = sbRequests[search->sbRequests[0]].priority;
+	for( size_t i = 1; i < sb_Count( search->sbRequests ); ++i ) {
+		priority = MAX( priority, sbRequests[search->sbRequests[i]].priority );
+	}
+
+	if( priority == search->priority ) return;
+	search->priority = priority;
+	queueSiftUp( search->heapIndex );
+	queueSiftDown( search->heapIndex );
+}
+
+// ***** Interface
+
+bool pathSvc_Init( int maxWorkers )
+{
+	shuttingDown = false;
+	for( int i = 0; i < NUM_BUCKETS; ++i ) {
+		buckets[i] = -1;
+	}
+	SDL_zero( stats );
+
+	aStar_InitContext( &mainContext );
+	mainSearch = -1;
+
+	numWorkers = MIN( MIN( maxWorkers, jq_GetNumThreads( ) ), MAX_WORKERS );
+	numWorkers = MAX( numWorkers, 0 );
+	for( int i = 0; i < numWorkers; ++i ) {
+		aStar_InitContext( &( workers[i].context ) );
+		workers[i].sbPath = NULL;
+		workers[i].busy = false;
+		workers[i].search = -1;
+		SDL_SetAtomicInt( &( workers[i].abort ), 0 );
+	}
+
+#ifdef THREAD_SUPPORT
+	mutex = SDL_CreateMutex( );
+	if( mutex == NULL ) {
+		llog( LOG_ERROR, "Unable to create path service mutex: %s", SDL_GetError( ) );
+		return false;
+	}
+#endif
+
+	llog( LOG_INFO, "Path service using %i workers", numWorkers );
+	return true;
+}
+
+void pathSvc_ShutDown( void )
+{
+	lock( ); {
+		shuttingDown = true;
+		for( int i = 0; i < numWorkers; ++i ) {
+			SDL_SetAtomicInt( &( workers[i].abort ), 1 );
+		}
+	} unlock( );
+
+	// wait for any running searches to stop, helping out in case the jobs haven't been picked up yet
+	for( int i = 0; i < numWorkers; ++i ) {
+		for( ;; ) {
+			bool busy;
+			lock( ); {
+				busy = workers[i].busy;
+			} unlock( );
+			if( !busy ) break;
+
+			if( !jq_ProcessNextJob( ) ) {
+				SDL_Delay( 1 );
+			}
+		}
+		aStar_CleanUpContext( &( workers[i].context ) );
+		sb_Release( workers[i].sbPath );
+	}
+	numWorkers = 0;
+
+	aStar_CleanUpContext( &mainContext );
+	sb_Release( sbMainPath );
+	mainSearch = -1;
+
+	for( size_t i = 0; i < sb_Count( sbSearches ); ++i ) {
+		sb_Release( sbSearches[i].sbRequests );
+		sb_Release( sbSearches[i].sbPath );
+	}
+	sb_Release( sbSearches );
+	sb_Release( sbFreeSearches );
+	sb_Release( sbQueue );
+	sb_Release( sbCompleted );
+	sb_Release( sbDelivering );
+	sb_Release( sbDeliverRequests );
+	sb_Release( sbRequests );
+	sb_Release( sbFreeRequests );
+
+#ifdef THREAD_SUPPORT
+	SDL_DestroyMutex( mutex );
+#endif
+	mutex = NULL;
+}
+
+void pathSvc_SetFrameBudget( int maxExpansions )
+{
+	frameBudget = MAX( maxExpansions, 1 );
+}
+
+PathRequest pathSvc_Request( const PathRequestDesc* desc )
+{
+	ASSERT_AND_IF_NOT( desc != NULL ) return 0;
+	ASSERT_AND_IF_NOT( desc->nextNeighbor != NULL ) return 0;
+
+	if( ( desc->startNodeID < 0 ) || ( desc->targetNodeID < 0 ) ||
+		( (size_t)desc->startNodeID >= desc->nodeCount ) || ( (size_t)desc->targetNodeID >= desc->nodeCount ) ) {
+		return 0;
+	}
+
+	PathRequest handle = 0;
+	lock( ); {
+		int requestIdx;
+		if( sb_Count( sbFreeRequests ) > 0 ) {
+			requestIdx = sb_Pop( sbFreeRequests );
+		} else if( sb_Count( sbRequests ) < MAX_REQUESTS ) {
+			requestIdx = (int)sb_Count( sbRequests );
+			RequestSlot* newSlot = sb_Add( sbRequests, 1 );
+			SDL_zerop( newSlot );
+		} else {
+			llog( LOG_ERROR, "Too many path requests outstanding" );
+			goto clean_up;
+		}
+
+		RequestSlot* slot = &( sbRequests[requestIdx] );
+		++slot->generation;
+		if( slot->generation == 0 ) slot->generation = 1;
+		slot->used = true;
+		slot->status = PRS_PENDING;
+		slot->priority = desc->priority;
+		slot->onDone = desc->onDone;
+		slot->userData = desc->userData;
+
+		int bucket = hashSearch( desc->graph, desc->nodeCount, desc->startNodeID, desc->targetNodeID );
+		int searchIdx = findMatchingSearch( desc, bucket );
+		if( searchIdx >= 0 ) {
+			++stats.numDeduplicated;
+		} else {
+			searchIdx = createSearch( desc, bucket );
+		}
+
+		slot->search = searchIdx;
+		sb_Push( sbSearches[searchIdx].sbRequests, requestIdx );
+		++sbSearches[searchIdx].refCount;
+		if( desc->priority > sbSearches[searchIdx].priority ) {
+			updateSearchPriority( searchIdx );
+		}
+
+		++stats.numRequests;
+		handle = makeHandle( requestIdx );
+
+		startWorkers( );
+	}
+clean_up:
+	unlock( );
+
+	return handle;
+}
+
+void pathSvc_SetPriority( PathRequest request, int priority )
+{
+	lock( ); {
+		int requestIdx = getRequestIdx( request );
+		if( requestIdx >= 0 ) {
+			sbRequests[requestIdx].priority = priority;
+			if( sbRequests[requestIdx].search >= 0 ) {
+				updateSearchPriority( sbRequests[requestIdx].search );
+			}
+		}
+	} unlock( );
+}
+
+PathRequestStatus pathSvc_GetStatus( PathRequest request )
+{
+	// status is only changed on the main thread
+	int requestIdx = getRequestIdx( request );
+	if( requestIdx < 0 ) return PRS_INVALID;
+	return sbRequests[requestIdx].status;
+}
+
+bool pathSvc_GetPath( PathRequest request, int** sbOutPath )
+{
+	ASSERT_AND_IF_NOT( sbOutPath != NULL ) return false;
+
+	int requestIdx = getRequestIdx( request );
+	if( ( requestIdx < 0 ) || ( sbRequests[requestIdx].status != PRS_FOUND ) ) return false;
+
+	// delivered searches are never touched by the workers
+	Search* search = &( sbSearches[sbRequests[requestIdx].search] );
+	size_t count = sb_Count( search->sbPath );
+	if( count > 0 ) {
+		int* dest = sb_Add( *sbOutPath, count );
+		SDL_memcpy( dest, search->sbPath, sizeof( dest[0] ) * count );
+	}
+	return true;
+}
+
+void pathSvc_Release( PathRequest request )
+{
+	lock( ); {
+		int requestIdx = getRequestIdx( request );
+		if( requestIdx >= 0 ) {
+			releaseRequest( requestIdx );
+		}
+	} unlock( );
+}
+
+void pathSvc_Process( void )
+{
+	lock( ); {
+		if( numWorkers == 0 ) {
+			runFrameBudget( );
+		} else {
+			startWorkers( );
+		}
+
+		// swap so the workers can keep adding while we deliver
+		int* sbTemp = sbDelivering;
+		sbDelivering = sbCompleted;
+		sbCompleted = sbTemp;
+		sb_Clear( sbCompleted );
+	} unlock( );
+
+	stats.numDelivered = 0;
+	for( size_t i = 0; i < sb_Count( sbDelivering ); ++i ) {
+		int searchIdx = sbDelivering[i];
+
+		// the callbacks can make and release requests, so hold on to the search and work from a copy of its requests
+		sb_Clear( sbDeliverRequests );
+		lock( ); {
+			Search* search = &( sbSearches[searchIdx] );
+			search->state = SS_DELIVERED;
+			++search->refCount;
+			for( size_t r = 0; r < sb_Count( search->sbRequests ); ++r ) {
+				int requestIdx = search->sbRequests[r];
+				sbRequests[requestIdx].status = search->found ? PRS_FOUND : PRS_NOT_FOUND;
+				sb_Push( sbDeliverRequests, makeHandle( requestIdx ) );
+				++stats.numDelivered;
+			}
+		} unlock( );
+
+		for( size_t r = 0; r < sb_Count( sbDeliverRequests ); ++r ) {
+			PathRequest request = sbDeliverRequests[r];
+			int requestIdx = getRequestIdx( request );
+			if( ( requestIdx < 0 ) || ( sbRequests[requestIdx].onDone == NULL ) ) continue;
+
+			// the path buffer isn't moved by the search list growing and is kept alive by the reference we're holding
+			const Search* search = &( sbSearches[searchIdx] );
+			const int* path = search->sbPath;
+			size_t pathLength = sb_Count( search->sbPath );
+			bool found = search->found;
+
+			sbRequests[requestIdx].onDone( request, found, path, pathLength, sbRequests[requestIdx].userData );
+			pathSvc_Release( request );
+		}
+
+		lock( ); {
+			Search* search = &( sbSearches[searchIdx] );
+			--search->refCount;
+			if( search->refCount == 0 ) {
+				freeSearch( searchIdx );
+			}
+		} unlock( );
+	}
+	sb_Clear( sbDelivering );
+}
+
+void pathSvc_GetStats( PathServiceStats* outStats )
+{
+	ASSERT_AND_IF_NOT( outStats != NULL ) return;
+
+	lock( ); {
+		stats.numPending = (uint32_t)sb_Count( sbQueue );
+		stats.numSearching = 0;
+		for( int i = 0; i < numWorkers; ++i ) {
+			if( workers[i].search >= 0 ) ++stats.numSearching;
+		}
+		if( mainSearch >= 0 ) ++stats.numSearching;
+		*outStats = stats;
+	} unlock( );
+}
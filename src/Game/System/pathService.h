@@ -0,0 +1,96 @@
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Utils/aStar.h"
+
+// Runs A* searches in the background so callers don't have to drive them. Requests are queued by priority and picked
+//  up by jobs on the job queue, each job has its own search context so nothing is shared between the threads but the
+//  queue. Identical requests (same graph, callbacks, start, and target) that are waiting or being searched share a
+//  single search.
+// Results are only handed back in pathSvc_Process( ), which the main loop calls once a frame after the main thread
+//  jobs, so the callbacks always run on the main thread at the same point in the frame.
+// Without worker threads (the web build) the searches are run in pathSvc_Process( ) instead, limited to a number of
+//  node expansions per frame, a search that goes over the budget picks up where it left off next frame.
+// The graph is read from the worker threads while searching, don't change it while there are requests pending.
+
+// 0 is never a valid handle, handles include a generation so one that's been released will be treated as invalid
+typedef uint32_t PathRequest;
+
+typedef enum {
+	PRS_INVALID,
+	PRS_PENDING,
+	PRS_FOUND,
+	PRS_NOT_FOUND
+} PathRequestStatus;
+
+// called from pathSvc_Process( ) when a request is done, the path is from the target back to the node after the start,
+//  the same as aStar_GetPath( ), and is only valid during the call, the request is released after the callback returns
+typedef void (*PathService_ResultFunc)( PathRequest request, bool found, const int* path, size_t pathLength, void* userData );
+
+typedef struct {
+	void* graph;
+	size_t nodeCount;
+	int startNodeID;
+	int targetNodeID;
+	AStar_CostFunc moveCost;
+	AStar_CostFunc heuristic;
+	AStar_GetNextNeighborFunc nextNeighbor;
+
+	// higher priorities are searched first, requests with the same priority are searched in the order they were made
+	int priority;
+
+	// if NULL the result has to be polled with pathSvc_GetStatus( ) and the request released with pathSvc_Release( )
+	PathService_ResultFunc onDone;
+	void* userData;
+} PathRequestDesc;
+
+typedef struct {
+	uint32_t numPending;
+	uint32_t numSearching;
+
+	// for the last call to pathSvc_Process( )
+	uint32_t numDelivered;
+	uint32_t numBudgetedExpansions;
+
+	// totals since the service was started
+	uint64_t numRequests;
+	uint64_t numSearches;
+	uint64_t numDeduplicated;
+} PathServiceStats;
+
+// maxWorkers is how many searches can run at the same time, clamped to the number of job queue threads. Each one holds
+//  a job queue thread for as long as there are searches waiting, so leave at least one thread free for everything else.
+//  call after jq_Initialize( )
+bool pathSvc_Init( int maxWorkers );
+
+// cancels everything and waits for the running searches to finish
+void pathSvc_ShutDown( void );
+
+// number of node expansions pathSvc_Process( ) will do each frame when there are no worker threads, defaults to 4096
+void pathSvc_SetFrameBudget( int maxExpansions );
+
+// queues a search, returns 0 if the request isn't valid
+PathRequest pathSvc_Request( const PathRequestDesc* desc );
+
+// raises or lowers the priority of a request that hasn't been searched yet
+void pathSvc_SetPriority( PathRequest request, int priority );
+
+PathRequestStatus pathSvc_GetStatus( PathRequest request );
+
+// if the request found a path this pushes it onto sbOutPath, returns whether it did
+bool pathSvc_GetPath( PathRequest request, int** sbOutPath );
+
+// cancels the request if it isn't done yet and frees anything used by it, the handle is invalid after this
+void pathSvc_Release( PathRequest request );
+
+// runs the frame's search budget if there aren't any worker threads, starts workers for anything waiting, and
+//  delivers the results of any finished searches
+void pathSvc_Process( void );
+
+void pathSvc_GetStats( PathServiceStats* outStats );
+
+#endif // inclusion guard
@@ -1,9 +1,12 @@
 #include "serializer.h"
 
 #include <float.h>
+#include <SDL3/SDL_endian.h>
 
 #include "Utils/helpers.h"
+#include "Utils/stretchyBuffer.h"
 #include "System/luaInterface.h"
+#include "System/platformLog.h"
 #include "Others/cmp.h"
 #include "System/ECPS/ecps_trackedCallbacks.h"
 #include "Graphics/images.h"
@@ -128,7 +131,9 @@ static bool cmpSerializer_writeImageID( struct Serializer* s, const char* name,
 	CMP_STANDARD_START;
 	ASSERT_AND_IF_NOT( imgID != NULL ) return false;
 
+	// invalid images don't have a name, they're read back as invalid
 	const char* id = img_GetImgStringID( *imgID );
+	if( id == NULL ) id = "";
 	return cmp_write_str( cmp, id, (uint32_t)SDL_strlen( id ) );
 }
 
@@ -289,6 +294,7 @@ static bool cmpSerializer_readTrackedECPSCallback( struct Serializer* s, const c
 	}
 
 	(*c) = ecps_GetTrackedECPSCallbackFromID( id );
+	mem_Release( id );
 	return true;
 }
 
@@ -303,6 +309,7 @@ static bool cmpSerializer_readTrackedEaseFunc( struct Serializer* s, const char*
 	}
 
 	(*e) = ecps_GetTrackedTweenFuncFromID( id );
+	mem_Release( id );
 	return true;
 }
 
@@ -311,13 +318,13 @@ static bool cmpSerializer_readImageID( struct Serializer* s, const char* name, I
 	CMP_STANDARD_START;
 	ASSERT_AND_IF_NOT( imgID != NULL ) return false;
 
-
 	char* id = NULL;
 	if( !cmpSerializer_readStr( s, name, &id ) ) {
 		return false;
 	}
 
 	(*imgID) = img_GetExistingByStrID( id );
+	mem_Release( id );
 	return true;
 }
 
@@ -473,7 +480,7 @@ static bool luaSerializer_writeS8( struct Serializer* s, const char* name, int8_
 	lua_pushinteger( ls, (lua_Integer)(*c) );
 	lua_settable( ls, -3 );
 
-	return false;
+	return true;
 }
 
 static bool luaSerializer_writeFloat( struct Serializer* s, const char* name, float* f )
@@ -968,6 +975,654 @@ void serializer_CreateReadLua( void* ctx, Serializer* outSerializer )
 
 #endif // SCRIPTING_ENABLED
 
+#pragma region FIELD LAYOUT
+//**********************************
+// field layout recorder, doesn't read or write anything, just notes where each value is relative to the data
+typedef struct {
+	const uint8_t* base;
+	size_t size;
+
+	char path[MAX_SERIALIZED_FIELD_NAME_SIZE + 1];
+	size_t pathLengths[SERIALIZER_MAX_FIELD_DEPTH];
+	int depth;
+
+	SerializedField* sbFields;
+	uint32_t numSkipped; // values that were serialized but couldn't be recorded
+} FieldLayoutCtx;
+
+#define LAYOUT_STANDARD_START \
+	ASSERT_AND_IF_NOT( s != NULL ) return false; \
+	ASSERT_AND_IF_NOT( s->ctx != NULL ) return false; \
+	FieldLayoutCtx* layout = (FieldLayoutCtx*)(s->ctx);
+
+// names of nested structures are joined with '.', path has to be MAX_SERIALIZED_FIELD_NAME_SIZE + 1 long
+static bool pushFieldPath( char* path, size_t* pathLengths, int* depth, const char* name )
+{
+	ASSERT_AND_IF_NOT( ( *depth ) < SERIALIZER_MAX_FIELD_DEPTH ) return false;
+
+	size_t length = SDL_strlen( path );
+	pathLengths[*depth] = length;
+	++( *depth );
+
+	if( ( name != NULL ) && ( name[0] != 0 ) ) {
+		if( length > 0 ) SDL_strlcat( path, ".", MAX_SERIALIZED_FIELD_NAME_SIZE + 1 );
+		SDL_strlcat( path, name, MAX_SERIALIZED_FIELD_NAME_SIZE + 1 );
+	}
+	return true;
+}
+
+static bool popFieldPath( char* path, const size_t* pathLengths, int* depth )
+{
+	ASSERT_AND_IF_NOT( ( *depth ) > 0 ) return false;
+
+	--( *depth );
+	path[pathLengths[*depth]] = 0;
+	return true;
+}
+
+static void getFieldName( const char* path, const char* name, char* outName )
+{
+	if( path[0] != 0 ) {
+		SDL_snprintf( outName, MAX_SERIALIZED_FIELD_NAME_SIZE + 1, "%s.%s", path, name );
+	} else {
+		SDL_strlcpy( outName, name, MAX_SERIALIZED_FIELD_NAME_SIZE + 1 );
+	}
+}
+
+static bool fieldLayout_startStructure( struct Serializer* s, const char* name )
+{
+	LAYOUT_STANDARD_START;
+	return pushFieldPath( layout->path, layout->pathLengths, &( layout->depth ), name );
+}
+
+static bool fieldLayout_endStructure( struct Serializer* s, const char* name )
+{
+	LAYOUT_STANDARD_START;
+	return popFieldPath( layout->path, layout->pathLengths, &( layout->depth ) );
+}
+
+static bool fieldLayout_record( struct Serializer* s, const char* name, const void* value, size_t valueSize, SerializedFieldType type )
+{
+	LAYOUT_STANDARD_START;
+	ASSERT_AND_IF_NOT( value != NULL ) return false;
+
+	// anything outside the data is a temporary the serialize function is converting through
+	const uint8_t* ptr = (const uint8_t*)value;
+	if( ( ptr < layout->base ) || ( ( ptr + valueSize ) > ( layout->base + layout->size ) ) ) {
+		++( layout->numSkipped );
+		return true;
+	}
+
+	SerializedField field;
+	SDL_zero( field );
+	getFieldName( layout->path, name, field.name );
+	field.type = type;
+	field.offset = (uint32_t)( ptr - layout->base );
+
+	sb_Push( layout->sbFields, field );
+	return true;
+}
+
+static bool fieldLayout_s64( struct Serializer* s, const char* name, int64_t* d )
+{
+	return fieldLayout_record( s, name, d, sizeof( *d ), SFT_S64 );
+}
+
+static bool fieldLayout_cString( struct Serializer* s, const char* name, char** str )
+{
+	LAYOUT_STANDARD_START;
+	++( layout->numSkipped );
+	return true;
+}
+
+static bool fieldLayout_cStrBuffer( struct Serializer* s, const char* name, char* str, size_t bufferSize )
+{
+	LAYOUT_STANDARD_START;
+	++( layout->numSkipped );
+	return true;
+}
+
+static bool fieldLayout_u32( struct Serializer* s, const char* name, uint32_t* i )
+{
+	return fieldLayout_record( s, name, i, sizeof( *i ), SFT_U32 );
+}
+
+static bool fieldLayout_s8( struct Serializer* s, const char* name, int8_t* c )
+{
+	return fieldLayout_record( s, name, c, sizeof( *c ), SFT_S8 );
+}
+
+static bool fieldLayout_flt( struct Serializer* s, const char* name, float* f )
+{
+	return fieldLayout_record( s, name, f, sizeof( *f ), SFT_FLOAT );
+}
+
+static bool fieldLayout_u64( struct Serializer* s, const char* name, uint64_t* u )
+{
+	return fieldLayout_record( s, name, u, sizeof( *u ), SFT_U64 );
+}
+
+static bool fieldLayout_s32( struct Serializer* s, const char* name, int32_t* i )
+{
+	return fieldLayout_record( s, name, i, sizeof( *i ), SFT_S32 );
+}
+
+static bool fieldLayout_boolean( struct Serializer* s, const char* name, bool* b )
+{
+	return fieldLayout_record( s, name, b, sizeof( *b ), SFT_BOOL );
+}
+
+static bool fieldLayout_trackedECPSCallback( struct Serializer* s, const char* name, TrackedCallback* c )
+{
+	LAYOUT_STANDARD_START;
+	++( layout->numSkipped );
+	return true;
+}
+
+static bool fieldLayout_trackedEaseFunc( struct Serializer* s, const char* name, EaseFunc* e )
+{
+	LAYOUT_STANDARD_START;
+	++( layout->numSkipped );
+	return true;
+}
+
+static bool fieldLayout_imageID( struct Serializer* s, const char* name, ImageID* imgID )
+{
+	return fieldLayout_record( s, name, imgID, sizeof( *imgID ), SFT_IMAGE_ID );
+}
+
+static bool fieldLayout_entityID( struct Serializer* s, const char* name, uint32_t* id )
+{
+	return fieldLayout_record( s, name, id, sizeof( *id ), SFT_ENTITY_ID );
+}
+
+static bool fieldLayout_arraySize( struct Serializer* s, const char* name, uint32_t* size )
+{
+	// the elements aren't at fixed offsets, so the size isn't useful on it's own
+	LAYOUT_STANDARD_START;
+	++( layout->numSkipped );
+	return true;
+}
+
+static bool recordFieldLayout( bool ( *serialize )( Serializer* s, void* data ), size_t dataSize, uint8_t fill, SerializedField** sbOutFields, uint32_t* outNumSkipped )
+{
+	// some serialize functions update what's passed in, so use a copy they can do what they want with
+	uint8_t* data = mem_Allocate( dataSize );
+	if( data == NULL ) return false;
+	SDL_memset( data, fill, dataSize );
+
+	FieldLayoutCtx ctx;
+	SDL_zero( ctx );
+	ctx.base = data;
+	ctx.size = dataSize;
+
+	Serializer s = {
+		(void*)&ctx,
+		fieldLayout_startStructure,
+		fieldLayout_endStructure,
+		fieldLayout_s64,
+		fieldLayout_cString,
+		fieldLayout_cStrBuffer,
+		fieldLayout_u32,
+		fieldLayout_s8,
+		fieldLayout_flt,
+		fieldLayout_u64,
+		fieldLayout_s32,
+		fieldLayout_boolean,
+		fieldLayout_trackedECPSCallback,
+		fieldLayout_trackedEaseFunc,
+		fieldLayout_imageID,
+		fieldLayout_entityID,
+		fieldLayout_arraySize,
+		{ NULL, NULL, NULL }
+	};
+	serializer_SetRawEntityID( &s );
+
+	bool success = serialize( &s, data );
+	mem_Release( data );
+
+	if( !success ) {
+		sb_Release( ctx.sbFields );
+		return false;
+	}
+
+	( *sbOutFields ) = ctx.sbFields;
+	if( outNumSkipped != NULL ) {
+		( *outNumSkipped ) = ctx.numSkipped;
+	}
+	return true;
+}
+
+bool serializer_GenerateFieldLayout( bool ( *serialize )( Serializer* s, void* data ), size_t dataSize, SerializedField** sbOutFields )
+{
+	ASSERT_AND_IF_NOT( serialize != NULL ) return false;
+	ASSERT_AND_IF_NOT( sbOutFields != NULL ) return false;
+
+	return recordFieldLayout( serialize, dataSize, 0, sbOutFields, NULL );
+}
+#pragma endregion
+
+#pragma region COMPILED SCHEMA
+//**********************************
+// compiled schemas, turn the field layout into a list of copies to and from packed data
+size_t serializer_GetFieldTypeSize( SerializedFieldType type )
+{
+	switch( type ) {
+	case SFT_S8: return sizeof( int8_t );
+	case SFT_S32: return sizeof( int32_t );
+	case SFT_U32: return sizeof( uint32_t );
+	case SFT_S64: return sizeof( int64_t );
+	case SFT_U64: return sizeof( uint64_t );
+	case SFT_FLOAT: return sizeof( float );
+	case SFT_BOOL: return sizeof( bool );
+	case SFT_ENTITY_ID: return sizeof( uint32_t );
+	case SFT_IMAGE_ID: return sizeof( ImageID );
+	}
+	return 0;
+}
+
+// FNV-1a over the names and types of the fields
+static uint64_t hashFields( const SerializedField* sbFields )
+{
+	uint64_t hash = FNV1A_START;
+	for( size_t i = 0; i < sb_Count( sbFields ); ++i ) {
+		// 0xff can't be in a name, separates it from the type
+		uint8_t type[] = { 0xff, (uint8_t)sbFields[i].type };
+		hash = fnv1aHash( hash, sbFields[i].name, SDL_strlen( sbFields[i].name ) );
+		hash = fnv1aHash( hash, type, sizeof( type ) );
+	}
+
+	// 0 is used to mean there's no schema
+	return ( hash == 0 ) ? 1 : hash;
+}
+
+static void pushOp( SerializerOp** sbOps, SerializerOpType type, uint32_t dataOffset, uint32_t packedOffset, uint32_t size )
+{
+	// merge copies that are next to each other in both
+	if( ( type == SOT_COPY ) && ( sb_Count( *sbOps ) > 0 ) ) {
+		SerializerOp* last = &sb_Last( *sbOps );
+		if( ( last->type == SOT_COPY ) && ( ( last->dataOffset + last->size ) == dataOffset ) && ( ( last->packedOffset + last->size ) == packedOffset ) ) {
+			last->size += size;
+			return;
+		}
+	}
+
+	SerializerOp op;
+	op.type = type;
+	op.dataOffset = dataOffset;
+	op.packedOffset = packedOffset;
+	op.size = size;
+	sb_Push( ( *sbOps ), op );
+}
+
+static bool sameLayout( const SerializedField* sbLhs, const SerializedField* sbRhs )
+{
+	if( sb_Count( sbLhs ) != sb_Count( sbRhs ) ) return false;
+
+	for( size_t i = 0; i < sb_Count( sbLhs ); ++i ) {
+		if( ( sbLhs[i].type != sbRhs[i].type ) || ( sbLhs[i].offset != sbRhs[i].offset ) || ( SDL_strcmp( sbLhs[i].name, sbRhs[i].name ) != 0 ) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool serializer_CompileSchema( bool ( *serialize )( Serializer* s, void* data ), size_t dataSize, SerializerSchema* outSchema )
+{
+	ASSERT_AND_IF_NOT( serialize != NULL ) return false;
+	ASSERT_AND_IF_NOT( outSchema != NULL ) return false;
+	ASSERT_AND_IF_NOT( dataSize < UINT32_MAX ) return false;
+
+	SDL_zero( *outSchema );
+
+#if SDL_BYTEORDER != SDL_LIL_ENDIAN
+	// packed data is stored as it is in memory, keep it the same everywhere
+	llog( LOG_WARN, "Compiled schemas are only supported on little endian platforms." );
+	return false;
+#endif
+
+	// run it with the data cleared and with it filled, if the fields are different then the serialize function is
+	//  deciding what to do based on the data
+	SerializedField* sbZeroed = NULL;
+	SerializedField* sbFilled = NULL;
+	uint32_t zeroedSkipped = 0;
+	uint32_t filledSkipped = 0;
+	if( !recordFieldLayout( serialize, dataSize, 0x00, &sbZeroed, &zeroedSkipped ) ||
+		!recordFieldLayout( serialize, dataSize, 0xff, &sbFilled, &filledSkipped ) ) {
+		llog( LOG_WARN, "Unable to compile schema, serialize function failed." );
+		sb_Release( sbZeroed );
+		sb_Release( sbFilled );
+		return false;
+	}
+
+	bool valid = true;
+	if( ( zeroedSkipped > 0 ) || ( filledSkipped > 0 ) ) {
+		llog( LOG_WARN, "Unable to compile schema, serialize function uses values that can't be packed." );
+		valid = false;
+	} else if( !sameLayout( sbZeroed, sbFilled ) ) {
+		llog( LOG_WARN, "Unable to compile schema, serialized fields change based on the data." );
+		valid = false;
+	} else {
+		for( size_t i = 0; ( i < sb_Count( sbZeroed ) ) && valid; ++i ) {
+			if( sbZeroed[i].type == SFT_IMAGE_ID ) {
+				llog( LOG_WARN, "Unable to compile schema, image ids are saved by name and can't be packed." );
+				valid = false;
+			}
+		}
+	}
+
+	sb_Release( sbFilled );
+	if( !valid ) {
+		sb_Release( sbZeroed );
+		return false;
+	}
+
+	uint32_t packedOffset = 0;
+	for( size_t i = 0; i < sb_Count( sbZeroed ); ++i ) {
+		uint32_t size = (uint32_t)serializer_GetFieldTypeSize( sbZeroed[i].type );
+		SerializerOpType type = ( sbZeroed[i].type == SFT_ENTITY_ID ) ? SOT_ENTITY_ID : SOT_COPY;
+		pushOp( &( outSchema->sbOps ), type, sbZeroed[i].offset, packedOffset, size );
+		packedOffset += size;
+	}
+
+	outSchema->sbFields = sbZeroed;
+	outSchema->dataSize = (uint32_t)dataSize;
+	outSchema->packedSize = packedOffset;
+	outSchema->hash = hashFields( sbZeroed );
+
+	return true;
+}
+
+void serializer_DestroySchema( SerializerSchema* schema )
+{
+	ASSERT_AND_IF_NOT( schema != NULL ) return;
+
+	sb_Release( schema->sbFields );
+	sb_Release( schema->sbOps );
+	SDL_zero( *schema );
+}
+
+bool serializer_IsSchemaPOD( const SerializerSchema* schema )
+{
+	ASSERT_AND_IF_NOT( schema != NULL ) return false;
+
+	return ( sb_Count( schema->sbOps ) == 1 ) && ( schema->sbOps[0].type == SOT_COPY ) &&
+		( schema->sbOps[0].dataOffset == 0 ) && ( schema->sbOps[0].size == schema->dataSize );
+}
+
+// the saved fields are either packed one after the other or at their offsets in the structure they were recorded from
+static uint32_t matchFields( const SerializerSchema* schema, const SerializedField* sbSavedFields, bool useSavedOffsets, SerializerOp** sbOutOps )
+{
+	uint32_t numMatched = 0;
+	uint32_t packedOffset = 0;
+	for( size_t i = 0; i < sb_Count( sbSavedFields ); ++i ) {
+		uint32_t size = (uint32_t)serializer_GetFieldTypeSize( sbSavedFields[i].type );
+		uint32_t savedOffset = useSavedOffsets ? sbSavedFields[i].offset : packedOffset;
+
+		for( size_t f = 0; f < sb_Count( schema->sbFields ); ++f ) {
+			if( ( schema->sbFields[f].type == sbSavedFields[i].type ) && ( SDL_strcmp( schema->sbFields[f].name, sbSavedFields[i].name ) == 0 ) ) {
+				SerializerOpType type = ( sbSavedFields[i].type == SFT_ENTITY_ID ) ? SOT_ENTITY_ID : SOT_COPY;
+				pushOp( sbOutOps, type, schema->sbFields[f].offset, savedOffset, size );
+				++numMatched;
+				break;
+			}
+		}
+
+		packedOffset += size;
+	}
+
+	return numMatched;
+}
+
+uint32_t serializer_MatchSchema( const SerializerSchema* schema, const SerializedField* sbSavedFields, SerializerOp** sbOutOps )
+{
+	ASSERT_AND_IF_NOT( schema != NULL ) return 0;
+	ASSERT_AND_IF_NOT( sbOutOps != NULL ) return 0;
+
+	return matchFields( schema, sbSavedFields, false, sbOutOps );
+}
+
+uint32_t serializer_MatchSchemaLayout( const SerializerSchema* schema, const SerializedField* sbSavedFields, SerializerOp** sbOutOps )
+{
+	ASSERT_AND_IF_NOT( schema != NULL ) return 0;
+	ASSERT_AND_IF_NOT( sbOutOps != NULL ) return 0;
+
+	return matchFields( schema, sbSavedFields, true, sbOutOps );
+}
+
+bool serializer_WritePacked( const SerializerSchema* schema, const void* data, EntityAccessor* accessor, uint8_t* outPacked )
+{
+	ASSERT_AND_IF_NOT( schema != NULL ) return false;
+	ASSERT_AND_IF_NOT( data != NULL ) return false;
+	ASSERT_AND_IF_NOT( outPacked != NULL ) return false;
+
+	const uint8_t* bytes = (const uint8_t*)data;
+	for( size_t i = 0; i < sb_Count( schema->sbOps ); ++i ) {
+		const SerializerOp* op = &( schema->sbOps[i] );
+		if( op->type == SOT_COPY ) {
+			SDL_memcpy( outPacked + op->packedOffset, bytes + op->dataOffset, op->size );
+		} else {
+			ASSERT_AND_IF_NOT( accessor != NULL ) return false;
+
+			uint32_t id;
+			uint32_t localID;
+			SDL_memcpy( &id, bytes + op->dataOffset, sizeof( id ) );
+			if( !accessor->getLocalID( accessor, (EntityID)id, &localID ) ) {
+				return false;
+			}
+			SDL_memcpy( outPacked + op->packedOffset, &localID, sizeof( localID ) );
+		}
+	}
+
+	return true;
+}
+
+bool serializer_ReadPacked( const SerializerOp* sbOps, const uint8_t* packed, size_t packedSize, EntityAccessor* accessor, void* data )
+{
+	ASSERT_AND_IF_NOT( ( packed != NULL ) || ( packedSize == 0 ) ) return false;
+	ASSERT_AND_IF_NOT( data != NULL ) return false;
+
+	uint8_t* bytes = (uint8_t*)data;
+	for( size_t i = 0; i < sb_Count( sbOps ); ++i ) {
+		const SerializerOp* op = &( sbOps[i] );
+		if( ( (size_t)op->packedOffset + op->size ) > packedSize ) {
+			return false;
+		}
+
+		if( op->type == SOT_COPY ) {
+			SDL_memcpy( bytes + op->dataOffset, packed + op->packedOffset, op->size );
+		} else {
+			ASSERT_AND_IF_NOT( accessor != NULL ) return false;
+
+			uint32_t localID;
+			EntityID id;
+			SDL_memcpy( &localID, packed + op->packedOffset, sizeof( localID ) );
+			if( !accessor->getEntityID( accessor, localID, &id ) ) {
+				return false;
+			}
+			uint32_t stored = (uint32_t)id;
+			SDL_memcpy( bytes + op->dataOffset, &stored, sizeof( stored ) );
+		}
+	}
+
+	return true;
+}
+#pragma endregion
+
+#pragma region PACKED FIELD READER
+//**********************************
+// reads values out of packed data by name, for packed data that doesn't have a schema to read it anymore
+#define PACKED_READER_STANDARD_START \
+	ASSERT_AND_IF_NOT( s != NULL ) return false; \
+	ASSERT_AND_IF_NOT( s->ctx != NULL ) return false; \
+	PackedFieldReader* reader = (PackedFieldReader*)(s->ctx);
+
+// returns where the value is in the packed data, NULL if it wasn't saved
+static const uint8_t* findPackedField( PackedFieldReader* reader, const char* name, SerializedFieldType type )
+{
+	char fullName[MAX_SERIALIZED_FIELD_NAME_SIZE + 1];
+	getFieldName( reader->path, name, fullName );
+
+	size_t packedOffset = 0;
+	for( size_t i = 0; i < sb_Count( reader->sbSavedFields ); ++i ) {
+		size_t size = serializer_GetFieldTypeSize( reader->sbSavedFields[i].type );
+		if( ( reader->sbSavedFields[i].type == type ) && ( SDL_strcmp( reader->sbSavedFields[i].name, fullName ) == 0 ) ) {
+			return ( ( packedOffset + size ) <= reader->packedSize ) ? ( reader->packed + packedOffset ) : NULL;
+		}
+		packedOffset += size;
+	}
+
+	return NULL;
+}
+
+static bool packedReader_read( struct Serializer* s, const char* name, void* value, SerializedFieldType type )
+{
+	PACKED_READER_STANDARD_START;
+	ASSERT_AND_IF_NOT( value != NULL ) return false;
+
+	const uint8_t* packed = findPackedField( reader, name, type );
+	if( packed != NULL ) {
+		SDL_memcpy( value, packed, serializer_GetFieldTypeSize( type ) );
+	}
+	return true;
+}
+
+static bool packedReader_startStructure( struct Serializer* s, const char* name )
+{
+	PACKED_READER_STANDARD_START;
+	return pushFieldPath( reader->path, reader->pathLengths, &( reader->depth ), name );
+}
+
+static bool packedReader_endStructure( struct Serializer* s, const char* name )
+{
+	PACKED_READER_STANDARD_START;
+	return popFieldPath( reader->path, reader->pathLengths, &( reader->depth ) );
+}
+
+static bool packedReader_s64( struct Serializer* s, const char* name, int64_t* d )
+{
+	return packedReader_read( s, name, d, SFT_S64 );
+}
+
+// strings, callbacks, ease functions, and array sizes are never packed
+static bool packedReader_cString( struct Serializer* s, const char* name, char** str )
+{
+	return true;
+}
+
+static bool packedReader_cStrBuffer( struct Serializer* s, const char* name, char* str, size_t bufferSize )
+{
+	return true;
+}
+
+static bool packedReader_u32( struct Serializer* s, const char* name, uint32_t* i )
+{
+	return packedReader_read( s, name, i, SFT_U32 );
+}
+
+static bool packedReader_s8( struct Serializer* s, const char* name, int8_t* c )
+{
+	return packedReader_read( s, name, c, SFT_S8 );
+}
+
+static bool packedReader_flt( struct Serializer* s, const char* name, float* f )
+{
+	return packedReader_read( s, name, f, SFT_FLOAT );
+}
+
+static bool packedReader_u64( struct Serializer* s, const char* name, uint64_t* u )
+{
+	return packedReader_read( s, name, u, SFT_U64 );
+}
+
+static bool packedReader_s32( struct Serializer* s, const char* name, int32_t* i )
+{
+	return packedReader_read( s, name, i, SFT_S32 );
+}
+
+static bool packedReader_boolean( struct Serializer* s, const char* name, bool* b )
+{
+	return packedReader_read( s, name, b, SFT_BOOL );
+}
+
+static bool packedReader_trackedECPSCallback( struct Serializer* s, const char* name, TrackedCallback* c )
+{
+	return true;
+}
+
+static bool packedReader_trackedEaseFunc( struct Serializer* s, const char* name, EaseFunc* e )
+{
+	return true;
+}
+
+// image ids aren't the same between runs, so they're never packed either
+static bool packedReader_imageID( struct Serializer* s, const char* name, ImageID* imgID )
+{
+	return true;
+}
+
+static bool packedReader_entityID( struct Serializer* s, const char* name, uint32_t* id )
+{
+	PACKED_READER_STANDARD_START;
+	ASSERT_AND_IF_NOT( id != NULL ) return false;
+
+	const uint8_t* packed = findPackedField( reader, name, SFT_ENTITY_ID );
+	if( packed == NULL ) return true;
+
+	uint32_t localID;
+	EntityID entityID;
+	SDL_memcpy( &localID, packed, sizeof( localID ) );
+	if( !s->entityAccessor.getEntityID( &s->entityAccessor, localID, &entityID ) ) {
+		return false;
+	}
+	( *id ) = (uint32_t)entityID;
+
+	return true;
+}
+
+static bool packedReader_arraySize( struct Serializer* s, const char* name, uint32_t* size )
+{
+	return true;
+}
+
+void serializer_CreateReadPackedFields( PackedFieldReader* reader, const SerializedField* sbSavedFields, const uint8_t* packed, size_t packedSize,
+	Serializer* outSerializer )
+{
+	ASSERT_AND_IF_NOT( reader != NULL ) return;
+	ASSERT_AND_IF_NOT( ( packed != NULL ) || ( packedSize == 0 ) ) return;
+	ASSERT_AND_IF_NOT( outSerializer != NULL ) return;
+
+	SDL_zerop( reader );
+	reader->sbSavedFields = sbSavedFields;
+	reader->packed = packed;
+	reader->packedSize = packedSize;
+
+	*outSerializer = (Serializer){
+		(void*)reader,
+		packedReader_startStructure,
+		packedReader_endStructure,
+		packedReader_s64,
+		packedReader_cString,
+		packedReader_cStrBuffer,
+		packedReader_u32,
+		packedReader_s8,
+		packedReader_flt,
+		packedReader_u64,
+		packedReader_s32,
+		packedReader_boolean,
+		packedReader_trackedECPSCallback,
+		packedReader_trackedEaseFunc,
+		packedReader_imageID,
+		packedReader_entityID,
+		packedReader_arraySize,
+		{ NULL, NULL, NULL }
+	};
+
+	serializer_SetRawEntityID( outSerializer );
+}
+#pragma endregion
+
 static bool rawGetEntityID( struct EntityAccessor* a, uint32_t localID, EntityID* outID )
 {
 	ASSERT_AND_IF_NOT( outID != NULL ) return false;
@@ -54,6 +54,104 @@ void serializer_CreateReadLua( void* ctx, Serializer* outSerializer );
 void serializer_SetRawEntityID( Serializer* serializer ); // this is the default, don't need to call it
 void serializer_SetEntityInfo( void* ctx, Serializer* serializer );
 
+// field information pulled out of a serialize function, for direct access to the data without going through a serializer
+typedef enum {
+	SFT_S8,
+	SFT_S32,
+	SFT_U32,
+	SFT_S64,
+	SFT_U64,
+	SFT_FLOAT,
+	SFT_BOOL,
+	SFT_ENTITY_ID,
+	SFT_IMAGE_ID
+} SerializedFieldType;
+
+#define MAX_SERIALIZED_FIELD_NAME_SIZE 63
+
+typedef struct SerializedField {
+	char name[MAX_SERIALIZED_FIELD_NAME_SIZE + 1]; // names of nested structures are joined with '.', e.g. "futurePos.x"
+	SerializedFieldType type;
+	uint32_t offset; // from the start of the data
+} SerializedField;
+
+// Runs the serialize function over a zeroed block of dataSize bytes and records every plain value it touches that is stored
+//  in that block. Strings, callbacks, ease functions, and values copied to locals before being serialized (e.g. enums)
+//  are skipped. If the serialize function branches on the data then only the fields on the zeroed path are found.
+//  Uses a stretchy buffer, returns false if the serialize function failed.
+bool serializer_GenerateFieldLayout( bool ( *serialize )( Serializer* s, void* data ), size_t dataSize, SerializedField** sbOutFields );
+
+// size of the value in the data
+size_t serializer_GetFieldTypeSize( SerializedFieldType type );
+
+// Compiled schemas, for data that is saved and loaded a lot. A serialize function that only touches plain values stored
+//  in the data, and does them in the same order no matter what the data is, can be turned into a list of copies.
+//  Packed data is every field one after the other in the order the serialize function does them, each with its size
+//  and byte order in memory. Fields that are next to each other in both are done with one copy, so a structure that
+//  is entirely serialized in order is a single memcpy. Entity ids still go through the EntityAccessor.
+//  The hash is made from the names and types of the fields, packed data can be read by any schema with the same hash,
+//  if it's different serializer_MatchSchema( ) will match the fields up by name.
+typedef enum {
+	SOT_COPY,
+	SOT_ENTITY_ID
+} SerializerOpType;
+
+typedef struct SerializerOp {
+	uint32_t dataOffset;
+	uint32_t packedOffset;
+	uint32_t size;
+	SerializerOpType type;
+} SerializerOp;
+
+typedef struct {
+	uint64_t hash; // 0 if there's no schema
+	SerializedField* sbFields; // in the order they're serialized
+	SerializerOp* sbOps;
+	uint32_t dataSize;
+	uint32_t packedSize;
+} SerializerSchema;
+
+// Creates the schema from the field layout, fails if the serialize function uses anything that can't be packed (strings,
+//  callbacks, image ids, values converted through locals), or if the fields it uses change with the data.
+bool serializer_CompileSchema( bool ( *serialize )( Serializer* s, void* data ), size_t dataSize, SerializerSchema* outSchema );
+void serializer_DestroySchema( SerializerSchema* schema );
+
+// if the packed data is just a copy of the whole structure
+bool serializer_IsSchemaPOD( const SerializerSchema* schema );
+
+// Creates the copies needed to read data packed with a different schema, fields are matched by name and type, anything
+//  that wasn't saved is left alone. Returns how many of the saved fields were matched. Uses a stretchy buffer.
+uint32_t serializer_MatchSchema( const SerializerSchema* schema, const SerializedField* sbSavedFields, SerializerOp** sbOutOps );
+
+// Same as serializer_MatchSchema( ) but for data that is a copy of the structure the saved fields were recorded from,
+//  the "packed" data given to serializer_ReadPacked( ) is then the old structure and the fields are read from their offsets.
+uint32_t serializer_MatchSchemaLayout( const SerializerSchema* schema, const SerializedField* sbSavedFields, SerializerOp** sbOutOps );
+
+// outPacked has to be at least schema->packedSize bytes
+bool serializer_WritePacked( const SerializerSchema* schema, const void* data, EntityAccessor* accessor, uint8_t* outPacked );
+
+// sbOps is either the schema's sbOps or the ones from serializer_MatchSchema( ), fails if the packed data is too small
+bool serializer_ReadPacked( const SerializerOp* sbOps, const uint8_t* packed, size_t packedSize, EntityAccessor* accessor, void* data );
+
+// Reads packed data by name through a serialize function, for when the type no longer has a compiled schema to read it
+//  with. Every value the serialize function asks for is looked up in the saved fields by its full name and type, anything
+//  that wasn't saved is left alone. Entity ids go through the serializer's EntityAccessor.
+#define SERIALIZER_MAX_FIELD_DEPTH 8
+
+typedef struct {
+	const SerializedField* sbSavedFields;
+	const uint8_t* packed;
+	size_t packedSize;
+
+	char path[MAX_SERIALIZED_FIELD_NAME_SIZE + 1];
+	size_t pathLengths[SERIALIZER_MAX_FIELD_DEPTH];
+	int depth;
+} PackedFieldReader;
+
+// reader has to stay valid as long as the serializer is used, the packed data is the saved fields one after the other
+void serializer_CreateReadPackedFields( PackedFieldReader* reader, const SerializedField* sbSavedFields, const uint8_t* packed, size_t packedSize,
+	Serializer* outSerializer );
+
 // helper macros
 #define SERIALIZE_CHECK( call, baseType, entryName, onFail ) if( !call ) { llog( LOG_ERROR, "Issue serializing %s in %s.", (entryName), (baseType) ); onFail; }
 #define SERIALIZE_ENUM( serializerPtr, baseType, entryName, access, enumType, onFail ) { \
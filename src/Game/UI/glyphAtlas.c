@@ -0,0 +1,373 @@
+#include "glyphAtlas.h"
+
+#include <string.h>
+
+#include "Graphics/Platform/graphicsPlatform.h"
+#include "Math/mathUtil.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "Utils/stretchyBuffer.h"
+#include "Utils/helpers.h"
+
+// empty space around each glyph so linear filtering doesn't pull in it's neighbors
+#define GLYPH_PADDING 1
+// shelf heights are rounded up to this so similar sized glyphs can share them
+#define SHELF_HEIGHT_STEP 4
+
+typedef struct {
+	int y;
+	int height;
+	int nextX;
+	uint32_t lastUsedFrame;
+} Shelf;
+
+typedef struct {
+	Texture texture;
+	uint8_t* pixels;
+	Shelf* sbShelves;
+	int nextShelfY;
+
+	int dirtyMinY;
+	int dirtyMaxY;
+} AtlasPage;
+
+typedef struct {
+	bool inUse;
+	int page;
+	int shelf;
+	int x, y;
+	int width, height;
+	int owner;
+	int ownerData;
+	int nextFree;
+} AtlasEntry;
+
+static AtlasPage pages[GLYPH_ATLAS_MAX_PAGES];
+static int numPages = 0;
+
+static AtlasEntry* sbEntries = NULL;
+static int firstFreeEntry = -1;
+
+static uint32_t currentFrame = 1;
+static GlyphAtlasEvictCallback evictCallback = NULL;
+static GlyphAtlasStats stats;
+
+static void markDirty( AtlasPage* page, int minY, int maxY )
+{
+	page->dirtyMinY = MIN( page->dirtyMinY, minY );
+	page->dirtyMaxY = MAX( page->dirtyMaxY, maxY );
+}
+
+static int createPage( void )
+{
+	if( numPages >= GLYPH_ATLAS_MAX_PAGES ) {
+		return -1;
+	}
+
+	AtlasPage* page = &( pages[numPages] );
+	memset( page, 0, sizeof( *page ) );
+
+	page->pixels = mem_Allocate( GLYPH_ATLAS_PAGE_SIZE * GLYPH_ATLAS_PAGE_SIZE );
+	if( page->pixels == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate pixels for glyph atlas page." );
+		return -1;
+	}
+	memset( page->pixels, 0, GLYPH_ATLAS_PAGE_SIZE * GLYPH_ATLAS_PAGE_SIZE );
+
+	if( gfxUtil_CreateTextureFromAlphaBitmap( page->pixels, GLYPH_ATLAS_PAGE_SIZE, GLYPH_ATLAS_PAGE_SIZE, &( page->texture ) ) < 0 ) {
+		llog( LOG_ERROR, "Unable to create texture for glyph atlas page." );
+		mem_Release( page->pixels );
+		page->pixels = NULL;
+		return -1;
+	}
+
+	page->dirtyMinY = GLYPH_ATLAS_PAGE_SIZE;
+	page->dirtyMaxY = 0;
+
+	++numPages;
+	return ( numPages - 1 );
+}
+
+static int allocateEntry( void )
+{
+	int idx;
+	if( firstFreeEntry >= 0 ) {
+		idx = firstFreeEntry;
+		firstFreeEntry = sbEntries[idx].nextFree;
+	} else {
+		sb_Add( sbEntries, 1 );
+		idx = (int)sb_Count( sbEntries ) - 1;
+	}
+
+	memset( &( sbEntries[idx] ), 0, sizeof( sbEntries[idx] ) );
+	sbEntries[idx].inUse = true;
+	sbEntries[idx].nextFree = -1;
+	++stats.numEntries;
+	return idx;
+}
+
+static void freeEntry( int idx )
+{
+	sbEntries[idx].inUse = false;
+	sbEntries[idx].nextFree = firstFreeEntry;
+	firstFreeEntry = idx;
+	--stats.numEntries;
+}
+
+// removes everything from the shelf and clears it's pixels so the next set of glyphs don't pick up any of the old ones
+static void evictShelf( int pageIdx, int shelfIdx )
+{
+	size_t count = sb_Count( sbEntries );
+	for( size_t i = 0; i < count; ++i ) {
+		AtlasEntry* entry = &( sbEntries[i] );
+		if( !entry->inUse || ( entry->page != pageIdx ) || ( entry->shelf != shelfIdx ) ) continue;
+
+		// grab these before freeing in case the callback removes other entries
+		int owner = entry->owner;
+		int ownerData = entry->ownerData;
+		freeEntry( (int)i );
+		++stats.evictions;
+
+		if( evictCallback != NULL ) {
+			evictCallback( owner, ownerData );
+		}
+	}
+
+	AtlasPage* page = &( pages[pageIdx] );
+	Shelf* shelf = &( page->sbShelves[shelfIdx] );
+	memset( page->pixels + ( shelf->y * GLYPH_ATLAS_PAGE_SIZE ), 0, (size_t)( shelf->height * GLYPH_ATLAS_PAGE_SIZE ) );
+	markDirty( page, shelf->y, shelf->y + shelf->height );
+	shelf->nextX = 0;
+}
+
+// finds a spot for a padded rectangle, returns if one was found
+static bool findSpace( int width, int height, int* outPage, int* outShelf )
+{
+	// use the shortest existing shelf it fits in
+	int bestPage = -1;
+	int bestShelf = -1;
+	int bestHeight = GLYPH_ATLAS_PAGE_SIZE + 1;
+	for( int p = 0; p < numPages; ++p ) {
+		Shelf* sbShelves = pages[p].sbShelves;
+		for( size_t s = 0; s < sb_Count( sbShelves ); ++s ) {
+			if( ( sbShelves[s].height >= height ) && ( sbShelves[s].height < bestHeight ) &&
+				( ( sbShelves[s].nextX + width ) <= GLYPH_ATLAS_PAGE_SIZE ) ) {
+				bestPage = p;
+				bestShelf = (int)s;
+				bestHeight = sbShelves[s].height;
+			}
+		}
+	}
+
+	// don't waste a tall shelf on a short glyph if there's still room to start a new one
+	int shelfHeight = ( ( height + SHELF_HEIGHT_STEP - 1 ) / SHELF_HEIGHT_STEP ) * SHELF_HEIGHT_STEP;
+	shelfHeight = MIN( shelfHeight, GLYPH_ATLAS_PAGE_SIZE );
+	if( ( bestShelf >= 0 ) && ( bestHeight <= ( shelfHeight + ( shelfHeight / 2 ) ) ) ) {
+		(*outPage) = bestPage;
+		(*outShelf) = bestShelf;
+		return true;
+	}
+
+	// start a new shelf
+	int newShelfPage = -1;
+	for( int p = 0; ( p < numPages ) && ( newShelfPage < 0 ); ++p ) {
+		if( ( pages[p].nextShelfY + shelfHeight ) <= GLYPH_ATLAS_PAGE_SIZE ) {
+			newShelfPage = p;
+		}
+	}
+	if( newShelfPage < 0 ) {
+		newShelfPage = createPage( );
+	}
+	if( newShelfPage >= 0 ) {
+		AtlasPage* page = &( pages[newShelfPage] );
+		Shelf newShelf = { page->nextShelfY, shelfHeight, 0, 0 };
+		sb_Push( page->sbShelves, newShelf );
+		page->nextShelfY += shelfHeight;
+
+		(*outPage) = newShelfPage;
+		(*outShelf) = (int)sb_Count( page->sbShelves ) - 1;
+		return true;
+	}
+
+	// fall back to the taller shelf
+	if( bestShelf >= 0 ) {
+		(*outPage) = bestPage;
+		(*outShelf) = bestShelf;
+		return true;
+	}
+
+	// everything is full, clear out the least recently used shelf that's tall enough
+	int evictPage = -1;
+	int evictShelfIdx = -1;
+	uint32_t oldestFrame = currentFrame;
+	for( int p = 0; p < numPages; ++p ) {
+		Shelf* sbShelves = pages[p].sbShelves;
+		for( size_t s = 0; s < sb_Count( sbShelves ); ++s ) {
+			if( ( sbShelves[s].height >= height ) && ( sbShelves[s].lastUsedFrame < oldestFrame ) ) {
+				evictPage = p;
+				evictShelfIdx = (int)s;
+				oldestFrame = sbShelves[s].lastUsedFrame;
+			}
+		}
+	}
+
+	if( evictShelfIdx < 0 ) {
+		return false;
+	}
+
+	evictShelf( evictPage, evictShelfIdx );
+	(*outPage) = evictPage;
+	(*outShelf) = evictShelfIdx;
+	return true;
+}
+
+bool glyphAtlas_Init( GlyphAtlasEvictCallback onEvict )
+{
+	glyphAtlas_ShutDown( );
+	evictCallback = onEvict;
+	return true;
+}
+
+void glyphAtlas_ShutDown( void )
+{
+	for( int i = 0; i < numPages; ++i ) {
+		gfxPlatform_UnloadTexture( &( pages[i].texture ) );
+		mem_Release( pages[i].pixels );
+		sb_Release( pages[i].sbShelves );
+		memset( &( pages[i] ), 0, sizeof( pages[i] ) );
+	}
+	numPages = 0;
+
+	sb_Release( sbEntries );
+	firstFreeEntry = -1;
+	currentFrame = 1;
+	evictCallback = NULL;
+	memset( &stats, 0, sizeof( stats ) );
+}
+
+// Copies the width x height single channel bitmap into the atlas. Returns the id of the entry, or -1 if there was no room.
+int glyphAtlas_Add( int width, int height, const uint8_t* pixels, int owner, int ownerData )
+{
+	ASSERT( ( width > 0 ) && ( height > 0 ) );
+	ASSERT( pixels != NULL );
+
+	int paddedWidth = width + GLYPH_PADDING;
+	int paddedHeight = height + GLYPH_PADDING;
+	if( ( paddedWidth > GLYPH_ATLAS_PAGE_SIZE ) || ( paddedHeight > GLYPH_ATLAS_PAGE_SIZE ) ) {
+		llog( LOG_WARN, "Glyph of size %ix%i is too large for the atlas.", width, height );
+		++stats.failedAdditions;
+		return -1;
+	}
+
+	int pageIdx, shelfIdx;
+	if( !findSpace( paddedWidth, paddedHeight, &pageIdx, &shelfIdx ) ) {
+		++stats.failedAdditions;
+		return -1;
+	}
+
+	AtlasPage* page = &( pages[pageIdx] );
+	Shelf* shelf = &( page->sbShelves[shelfIdx] );
+
+	int idx = allocateEntry( );
+	AtlasEntry* entry = &( sbEntries[idx] );
+	entry->page = pageIdx;
+	entry->shelf = shelfIdx;
+	entry->x = shelf->nextX;
+	entry->y = shelf->y;
+	entry->width = width;
+	entry->height = height;
+	entry->owner = owner;
+	entry->ownerData = ownerData;
+
+	shelf->nextX += paddedWidth;
+	shelf->lastUsedFrame = currentFrame;
+
+	// the padding is cleared along with the glyph
+	for( int row = 0; row < paddedHeight; ++row ) {
+		uint8_t* dest = page->pixels + ( ( entry->y + row ) * GLYPH_ATLAS_PAGE_SIZE ) + entry->x;
+		if( row < height ) {
+			memcpy( dest, pixels + ( row * width ), (size_t)width );
+			dest[width] = 0;
+		} else {
+			memset( dest, 0, (size_t)paddedWidth );
+		}
+	}
+	markDirty( page, entry->y, entry->y + paddedHeight );
+
+	++stats.additions;
+	return idx;
+}
+
+// Frees up the space used by the entry. Doesn't call the evict callback.
+void glyphAtlas_Remove( int entry )
+{
+	ASSERT_AND_IF_NOT( ( entry >= 0 ) && ( entry < (int)sb_Count( sbEntries ) ) && sbEntries[entry].inUse ) return;
+
+	// the space is only reclaimed when the whole shelf is evicted
+	freeEntry( entry );
+}
+
+// Marks the entry as used this frame.
+void glyphAtlas_Touch( int entry )
+{
+	ASSERT_AND_IF_NOT( ( entry >= 0 ) && ( entry < (int)sb_Count( sbEntries ) ) && sbEntries[entry].inUse ) return;
+
+	AtlasEntry* atlasEntry = &( sbEntries[entry] );
+	pages[atlasEntry->page].sbShelves[atlasEntry->shelf].lastUsedFrame = currentFrame;
+}
+
+// Gets the texture and uvs for the entry. Returns false if the entry isn't valid.
+bool glyphAtlas_GetEntry( int entry, Texture* outTexture, Vector2* outUVMin, Vector2* outUVMax )
+{
+	if( ( entry < 0 ) || ( entry >= (int)sb_Count( sbEntries ) ) || !sbEntries[entry].inUse ) {
+		return false;
+	}
+
+	AtlasEntry* atlasEntry = &( sbEntries[entry] );
+	if( outTexture != NULL ) {
+		(*outTexture) = pages[atlasEntry->page].texture;
+	}
+
+	const float invSize = 1.0f / (float)GLYPH_ATLAS_PAGE_SIZE;
+	if( outUVMin != NULL ) {
+		outUVMin->x = (float)atlasEntry->x * invSize;
+		outUVMin->y = (float)atlasEntry->y * invSize;
+	}
+	if( outUVMax != NULL ) {
+		outUVMax->x = (float)( atlasEntry->x + atlasEntry->width ) * invSize;
+		outUVMax->y = (float)( atlasEntry->y + atlasEntry->height ) * invSize;
+	}
+
+	return true;
+}
+
+// Uploads any changed pixels and advances the frame used for eviction.
+void glyphAtlas_Flush( void )
+{
+	for( int i = 0; i < numPages; ++i ) {
+		AtlasPage* page = &( pages[i] );
+		if( page->dirtyMaxY <= page->dirtyMinY ) continue;
+
+		// full rows are sent so the data is contiguous, which avoids needing row length support on older GLES
+		int rows = page->dirtyMaxY - page->dirtyMinY;
+		if( gfxUtil_UpdateTextureRegionFromAlphaBitmap( &( page->texture ), 0, page->dirtyMinY, GLYPH_ATLAS_PAGE_SIZE, rows,
+				page->pixels + ( page->dirtyMinY * GLYPH_ATLAS_PAGE_SIZE ) ) < 0 ) {
+			llog( LOG_ERROR, "Unable to upload glyph atlas page %i.", i );
+		} else {
+			++stats.uploads;
+			stats.bytesUploaded += (size_t)( rows * GLYPH_ATLAS_PAGE_SIZE );
+		}
+
+		page->dirtyMinY = GLYPH_ATLAS_PAGE_SIZE;
+		page->dirtyMaxY = 0;
+	}
+
+	++currentFrame;
+}
+
+void glyphAtlas_GetStats( GlyphAtlasStats* outStats )
+{
+	ASSERT( outStats != NULL );
+	(*outStats) = stats;
+	outStats->numPages = (uint32_t)numPages;
+}
@@ -0,0 +1,52 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Graphics/gfxUtil.h"
+#include "Math/vector2.h"
+
+// Single channel texture pages that glyphs get packed into as they're needed, instead of creating one texture per font
+//  with every glyph in it up front. Space in a page is handed out in shelves, rows of a fixed height that are filled left
+//  to right. When everything is full the least recently used shelf is cleared out and reused, anything used this frame is
+//  never evicted so the quads already submitted stay valid. Pixels are written to a copy on the CPU and uploaded in one
+//  go per page when glyphAtlas_Flush( ) is called, that should be done once a frame before rendering.
+
+#define GLYPH_ATLAS_PAGE_SIZE 1024
+#define GLYPH_ATLAS_MAX_PAGES 4
+
+// Called when an entry is evicted to make room, owner and ownerData are what was passed in to glyphAtlas_Add( ).
+typedef void (*GlyphAtlasEvictCallback)( int owner, int ownerData );
+
+typedef struct {
+	uint32_t numPages;
+	uint32_t numEntries;
+	uint32_t additions;
+	uint32_t evictions;
+	uint32_t failedAdditions;
+	uint32_t uploads;
+	size_t bytesUploaded;
+} GlyphAtlasStats;
+
+bool glyphAtlas_Init( GlyphAtlasEvictCallback onEvict );
+void glyphAtlas_ShutDown( void );
+
+// Copies the width x height single channel bitmap into the atlas. Returns the id of the entry, or -1 if there was no room.
+int glyphAtlas_Add( int width, int height, const uint8_t* pixels, int owner, int ownerData );
+
+// Frees up the space used by the entry. Doesn't call the evict callback.
+void glyphAtlas_Remove( int entry );
+
+// Marks the entry as used this frame.
+void glyphAtlas_Touch( int entry );
+
+// Gets the texture and uvs for the entry. Returns false if the entry isn't valid.
+bool glyphAtlas_GetEntry( int entry, Texture* outTexture, Vector2* outUVMin, Vector2* outUVMax );
+
+// Uploads any changed pixels and advances the frame used for eviction.
+void glyphAtlas_Flush( void );
+
+void glyphAtlas_GetStats( GlyphAtlasStats* outStats );
+
+#endif // inclusion guard
@@ -16,9 +16,22 @@
 #include <stb_rect_pack.h>
 
 
+// threads generating sdf fonts set a scratch arena so the temporary allocations stb_truetype makes for each glyph
+//  don't have to go through the general allocator, the arena is reset after each glyph
+typedef struct {
+	uint8_t* memory;
+	size_t size;
+	size_t used;
+} ScratchArena;
+
+static SDL_TLSID stbttScratchTLS;
+
+static void* stbttAllocate( size_t size );
+static void stbttRelease( void* ptr );
+
 #define STB_TRUETYPE_IMPLEMENTATION
-#define STBTT_malloc(x,u)	((void)(u),mem_Allocate(x))
-#define STBTT_free(x,u)		((void)(u),mem_Release(x))
+#define STBTT_malloc(x,u)	((void)(u),stbttAllocate(x))
+#define STBTT_free(x,u)		((void)(u),stbttRelease(x))
 #include <stb_truetype.h>
 
 
@@ -34,6 +47,7 @@
 //#pragma warning( pop )
 
 #include "Utils/stretchyBuffer.h"
+#include "Utils/helpers.h"
 #include "Graphics/images.h"
 #include "Math/mathUtil.h"
 
@@ -42,13 +56,43 @@
 #include "System/jobQueue.h"
 
 #include "Graphics/gfxUtil.h"
+#include "Graphics/triRendering.h"
+#include "Graphics/Platform/graphicsPlatform.h"
+#include "UI/glyphAtlas.h"
 
 typedef struct {
 	int32_t codepoint;
 	int imageID;
 	float advance;
+
+	// cached from the image once the font is done loading so drawing doesn't have to look anything up, the quad is
+	//  relative to the pen position at the base size of the font
+	bool renderable;
+	bool transparent;
+	ShaderType shaderType;
+	PlatformTexture texture;
+	Vector2 quadMin;
+	Vector2 quadMax;
+	Vector2 uvMin;
+	Vector2 uvMax;
+
+	// only used by dynamic fonts, where the glyph is in the glyph atlas
+	int fontGlyphIndex;
+	int atlasEntry;
 } Glyph;
 
+#define DYNAMIC_GLYPH_NOT_RASTERIZED -1
+#define DYNAMIC_GLYPH_EMPTY -2
+
+typedef struct {
+	int32_t codepoint;
+	int32_t glyphIdx;
+} GlyphHashEntry;
+
+// Basic Latin and Latin-1 Supplement, codepoints below this are looked up directly
+#define DIRECT_GLYPH_LOOKUP_SIZE 256
+#define EMPTY_GLYPH_HASH_CODEPOINT -1
+
 static const uint32_t LINE_FEED = 0xA;
 static const uint32_t END_OF_STRING = 0;
 
@@ -65,6 +109,23 @@ typedef struct {
 
 	size_t missingCharGlyphIdx;
 
+	// index into glyphsBuffer for each codepoint in the direct range, codepoints without a glyph use the missing
+	//  character glyph
+	int32_t directGlyphLookup[DIRECT_GLYPH_LOOKUP_SIZE];
+
+	// open addressed hash table for everything outside the direct range, has ( 1 << glyphHashBits ) entries
+	GlyphHashEntry* glyphHash;
+	int glyphHashBits;
+	size_t glyphHashCount;
+
+	// dynamic fonts keep the font file around and only create glyphs when they're first used, the glyphs are put in
+	//  the glyph atlas when they're drawn and can be evicted from it when they haven't been used in a while
+	bool isDynamic;
+	bool isSDF;
+	uint8_t* fontData;
+	stbtt_fontinfo fontInfo;
+	float rasterScale;
+
 	float descent;
 	float lineGap;
 	float ascent;
@@ -82,6 +143,86 @@ stbtt_pack_range fontPackRange = { 0 };
 
 static bool textInitialized = false;
 
+// a glyph positioned relative to where the string is drawn from
+typedef struct {
+	Vector2 min;
+	Vector2 max;
+	Vector2 uvMin;
+	Vector2 uvMax;
+	PlatformTexture texture;
+	ShaderType shaderType;
+	bool transparent;
+	int atlasEntry;
+} TextQuad;
+
+// set when a dynamic glyph couldn't be put in the atlas while laying out, so the layout shouldn't be cached
+static bool layoutMissingGlyphs = false;
+
+// used when laying out strings that aren't cached
+static TextQuad* sbWorkingQuads = NULL;
+
+#define MAX_CACHED_LAYOUTS 1024
+#define LAYOUT_HASH_BUCKETS 1024
+#define DEFAULT_LAYOUT_CACHE_BUDGET ( 512 * 1024 )
+
+typedef struct {
+	bool inUse;
+	uint64_t hash;
+
+	// everything used to create the layout, the text is stored in the same allocation as the quads
+	uint8_t* text;
+	size_t textLen;
+	int fontID;
+	float pixelSize;
+	bool isArea;
+	Vector2 areaSize;
+	HorizTextAlignment hAlign;
+	VertTextAlignment vAlign;
+
+	TextQuad* quads;
+	size_t numQuads;
+	size_t memoryUsed;
+
+	int nextInBucket;
+	int lruPrev;
+	int lruNext;
+} CachedTextLayout;
+
+static CachedTextLayout cachedLayouts[MAX_CACHED_LAYOUTS];
+static int layoutBuckets[LAYOUT_HASH_BUCKETS];
+static int lruHead = -1;
+static int lruTail = -1;
+static TextLayoutCacheStats layoutCacheStats = { 0, 0, 0, 0, 0, DEFAULT_LAYOUT_CACHE_BUDGET };
+
+static void resetLayoutCache( void );
+static void evictLayoutsUsingFont( int fontID );
+
+static void* stbttAllocate( size_t size )
+{
+	ScratchArena* arena = (ScratchArena*)SDL_GetTLS( &stbttScratchTLS );
+	if( arena != NULL ) {
+		size_t start = ( arena->used + 15 ) & ~(size_t)15;
+		if( ( start + size ) <= arena->size ) {
+			arena->used = start + size;
+			return arena->memory + start;
+		}
+	}
+
+	return mem_Allocate( size );
+}
+
+static void stbttRelease( void* ptr )
+{
+	// anything in the scratch arena is freed all at once when it's reset
+	ScratchArena* arena = (ScratchArena*)SDL_GetTLS( &stbttScratchTLS );
+	if( ( arena != NULL ) && ( (uint8_t*)ptr >= arena->memory ) && ( (uint8_t*)ptr < ( arena->memory + arena->size ) ) ) {
+		return;
+	}
+
+	mem_Release( ptr );
+}
+static void onGlyphEvicted( int fontID, int glyphIdx );
+
 // Sets up the default codepoints to load and clears out any currently loaded fonts.
 int txt_Init( void )
 {
@@ -95,10 +236,20 @@ int txt_Init( void )
 			sb_Release( fonts[i].glyphsBuffer );
 		}
 		fonts[i].glyphsBuffer = NULL;
+
+		mem_Release( fonts[i].glyphHash );
+		fonts[i].glyphHash = NULL;
+
+		mem_Release( fonts[i].fontData );
+		fonts[i].fontData = NULL;
+		fonts[i].isDynamic = false;
 	}
 
 	sb_Add( sbStringCodepointBuffer, 1024 );
 
+	resetLayoutCache( );
+	glyphAtlas_Init( onGlyphEvicted );
+
 	textInitialized = true;
 
 	return 0;
@@ -121,6 +272,272 @@ void txt_AddCharacterToLoad( int c )
 	fontPackRange.num_chars = (int)sb_Count( fontPackRange.array_of_unicode_codepoints );
 }
 
+static uint32_t glyphHashIndex( int32_t codepoint, int bits )
+{
+	// fibonacci hashing, the top bits are the well mixed ones
+	return ( (uint32_t)codepoint * 2654435761u ) >> ( 32 - bits );
+}
+
+// grabs everything we need to draw the glyph from the image
+static void cacheGlyphQuad( Glyph* glyph )
+{
+	glyph->atlasEntry = DYNAMIC_GLYPH_NOT_RASTERIZED;
+	glyph->renderable = img_IsValidImage( glyph->imageID );
+	if( !glyph->renderable ) {
+		return;
+	}
+
+	Vector2 size;
+	Vector2 offset;
+	img_GetSize( glyph->imageID, &size );
+	img_GetOffset( glyph->imageID, &offset );
+	vec2_AddScaled( &offset, &size, -0.5f, &( glyph->quadMin ) );
+	vec2_AddScaled( &offset, &size, 0.5f, &( glyph->quadMax ) );
+
+	img_GetUVCoordinates( glyph->imageID, &( glyph->uvMin ), &( glyph->uvMax ) );
+	img_GetTextureID( glyph->imageID, &( glyph->texture ) );
+	glyph->shaderType = img_GetShaderType( glyph->imageID );
+	glyph->transparent = img_HasTransparency( glyph->imageID );
+}
+
+// builds the lookup tables and caches the quads for all the glyphs, should be called once the glyphs and their images
+//  are done being set up
+static void finishFontGlyphs( Font* font )
+{
+	size_t glyphCount = sb_Count( font->glyphsBuffer );
+
+	for( size_t i = 0; i < glyphCount; ++i ) {
+		cacheGlyphQuad( &( font->glyphsBuffer[i] ) );
+	}
+
+	for( int i = 0; i < DIRECT_GLYPH_LOOKUP_SIZE; ++i ) {
+		font->directGlyphLookup[i] = -1;
+	}
+
+	// when there are duplicates we want the first one, same as searching through the list would give us
+	size_t numHashed = 0;
+	for( size_t i = 0; i < glyphCount; ++i ) {
+		int32_t codepoint = font->glyphsBuffer[i].codepoint;
+		if( ( codepoint >= 0 ) && ( codepoint < DIRECT_GLYPH_LOOKUP_SIZE ) ) {
+			if( font->directGlyphLookup[codepoint] < 0 ) {
+				font->directGlyphLookup[codepoint] = (int32_t)i;
+			}
+		} else {
+			++numHashed;
+		}
+	}
+
+	for( int i = 0; i < DIRECT_GLYPH_LOOKUP_SIZE; ++i ) {
+		if( font->directGlyphLookup[i] < 0 ) {
+			font->directGlyphLookup[i] = (int32_t)font->missingCharGlyphIdx;
+		}
+	}
+
+	mem_Release( font->glyphHash );
+	font->glyphHash = NULL;
+	font->glyphHashBits = 0;
+	font->glyphHashCount = 0;
+	if( numHashed == 0 ) {
+		return;
+	}
+
+	// keep the load factor at or below one half so probes stay short
+	int bits = 1;
+	while( ( (size_t)1 << bits ) < ( numHashed * 2 ) ) {
+		++bits;
+	}
+	size_t hashSize = (size_t)1 << bits;
+
+	font->glyphHash = mem_Allocate( sizeof( GlyphHashEntry ) * hashSize );
+	if( font->glyphHash == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate glyph hash table, only the direct range of glyphs will be displayed." );
+		return;
+	}
+	font->glyphHashBits = bits;
+
+	for( size_t i = 0; i < hashSize; ++i ) {
+		font->glyphHash[i].codepoint = EMPTY_GLYPH_HASH_CODEPOINT;
+	}
+
+	uint32_t mask = (uint32_t)( hashSize - 1 );
+	for( size_t i = 0; i < glyphCount; ++i ) {
+		int32_t codepoint = font->glyphsBuffer[i].codepoint;
+		if( ( codepoint >= 0 ) && ( codepoint < DIRECT_GLYPH_LOOKUP_SIZE ) ) continue;
+
+		uint32_t idx = glyphHashIndex( codepoint, bits );
+		while( ( font->glyphHash[idx].codepoint != EMPTY_GLYPH_HASH_CODEPOINT ) && ( font->glyphHash[idx].codepoint != codepoint ) ) {
+			idx = ( idx + 1 ) & mask;
+		}
+
+		if( font->glyphHash[idx].codepoint == EMPTY_GLYPH_HASH_CODEPOINT ) {
+			font->glyphHash[idx].codepoint = codepoint;
+			font->glyphHash[idx].glyphIdx = (int32_t)i;
+			++font->glyphHashCount;
+		}
+	}
+}
+
+// adds a codepoint to the glyph hash table, growing it if needed, used by dynamic fonts as glyphs are created
+static void insertGlyphHash( Font* font, int32_t codepoint, int32_t glyphIdx )
+{
+	size_t hashSize = ( font->glyphHash != NULL ) ? ( (size_t)1 << font->glyphHashBits ) : 0;
+
+	// keep the load factor at or below one half so probes stay short
+	if( ( ( font->glyphHashCount + 1 ) * 2 ) > hashSize ) {
+		int newBits = ( font->glyphHash != NULL ) ? ( font->glyphHashBits + 1 ) : 6;
+		size_t newSize = (size_t)1 << newBits;
+		GlyphHashEntry* newHash = mem_Allocate( sizeof( GlyphHashEntry ) * newSize );
+		if( newHash == NULL ) {
+			llog( LOG_ERROR, "Unable to grow glyph hash table." );
+			return;
+		}
+
+		for( size_t i = 0; i < newSize; ++i ) {
+			newHash[i].codepoint = EMPTY_GLYPH_HASH_CODEPOINT;
+		}
+
+		uint32_t newMask = (uint32_t)( newSize - 1 );
+		for( size_t i = 0; i < hashSize; ++i ) {
+			if( font->glyphHash[i].codepoint == EMPTY_GLYPH_HASH_CODEPOINT ) continue;
+
+			uint32_t idx = glyphHashIndex( font->glyphHash[i].codepoint, newBits );
+			while( newHash[idx].codepoint != EMPTY_GLYPH_HASH_CODEPOINT ) {
+				idx = ( idx + 1 ) & newMask;
+			}
+			newHash[idx] = font->glyphHash[i];
+		}
+
+		mem_Release( font->glyphHash );
+		font->glyphHash = newHash;
+		font->glyphHashBits = newBits;
+		hashSize = newSize;
+	}
+
+	uint32_t mask = (uint32_t)( hashSize - 1 );
+	uint32_t idx = glyphHashIndex( codepoint, font->glyphHashBits );
+	while( ( font->glyphHash[idx].codepoint != EMPTY_GLYPH_HASH_CODEPOINT ) && ( font->glyphHash[idx].codepoint != codepoint ) ) {
+		idx = ( idx + 1 ) & mask;
+	}
+
+	if( font->glyphHash[idx].codepoint == EMPTY_GLYPH_HASH_CODEPOINT ) {
+		font->glyphHash[idx].codepoint = codepoint;
+		font->glyphHash[idx].glyphIdx = glyphIdx;
+		++font->glyphHashCount;
+	}
+}
+
+// creates the glyph for a codepoint in a dynamic font, only the metrics are grabbed here, the glyph isn't rasterized
+//  until it's drawn. Returns the index of the glyph to use for the codepoint.
+static int32_t addDynamicGlyph( Font* font, int32_t codepoint )
+{
+	int fontGlyphIndex = stbtt_FindGlyphIndex( &( font->fontInfo ), codepoint );
+
+	int32_t glyphIdx;
+	if( ( fontGlyphIndex == 0 ) && ( sb_Count( font->glyphsBuffer ) > 0 ) ) {
+		// the font doesn't have it, remember that so we don't have to search for it again
+		glyphIdx = (int32_t)font->missingCharGlyphIdx;
+	} else {
+		Glyph* glyph = sb_Add( font->glyphsBuffer, 1 );
+		SDL_memset( glyph, 0, sizeof( *glyph ) );
+
+		int advance, lsb;
+		stbtt_GetGlyphHMetrics( &( font->fontInfo ), fontGlyphIndex, &advance, &lsb );
+
+		glyph->codepoint = codepoint;
+		glyph->imageID = -1;
+		glyph->advance = (float)advance * font->rasterScale;
+		glyph->renderable = false;
+		glyph->transparent = true;
+		glyph->shaderType = font->isSDF ? ST_SIMPLE_SDF : ST_ALPHA_ONLY;
+		glyph->fontGlyphIndex = fontGlyphIndex;
+		glyph->atlasEntry = DYNAMIC_GLYPH_NOT_RASTERIZED;
+
+		glyphIdx = (int32_t)( sb_Count( font->glyphsBuffer ) - 1 );
+	}
+
+	if( ( codepoint >= 0 ) && ( codepoint < DIRECT_GLYPH_LOOKUP_SIZE ) ) {
+		font->directGlyphLookup[codepoint] = glyphIdx;
+	} else {
+		insertGlyphHash( font, codepoint, glyphIdx );
+	}
+
+	return glyphIdx;
+}
+
+#define DYNAMIC_SDF_PADDING 4
+#define DYNAMIC_SDF_ON_EDGE_VALUE 128
+
+// renders the glyph and puts it in the atlas
+static void rasterizeGlyph( int fontID, Glyph* glyph )
+{
+	Font* font = &( fonts[fontID] );
+
+	int width = 0;
+	int height = 0;
+	int xOff = 0;
+	int yOff = 0;
+	uint8_t* bitmap;
+	if( font->isSDF ) {
+		bitmap = stbtt_GetGlyphSDF( &( font->fontInfo ), font->rasterScale, glyph->fontGlyphIndex, DYNAMIC_SDF_PADDING, DYNAMIC_SDF_ON_EDGE_VALUE,
+			(float)DYNAMIC_SDF_ON_EDGE_VALUE / (float)DYNAMIC_SDF_PADDING, &width, &height, &xOff, &yOff );
+	} else {
+		bitmap = stbtt_GetGlyphBitmap( &( font->fontInfo ), font->rasterScale, font->rasterScale, glyph->fontGlyphIndex, &width, &height, &xOff, &yOff );
+	}
+
+	if( ( bitmap == NULL ) || ( width <= 0 ) || ( height <= 0 ) ) {
+		// nothing to draw, usually whitespace
+		glyph->atlasEntry = DYNAMIC_GLYPH_EMPTY;
+		stbtt_FreeBitmap( bitmap, NULL );
+		return;
+	}
+
+	int entry = glyphAtlas_Add( width, height, bitmap, fontID, (int)( glyph - font->glyphsBuffer ) );
+	stbtt_FreeBitmap( bitmap, NULL );
+	if( entry < 0 ) {
+		// atlas is full of glyphs used this frame, try again next time it's drawn
+		layoutMissingGlyphs = true;
+		return;
+	}
+
+	Texture texture;
+	glyphAtlas_GetEntry( entry, &texture, &( glyph->uvMin ), &( glyph->uvMax ) );
+	glyph->texture = texture.texture;
+	glyph->quadMin = vec2( (float)xOff, (float)yOff );
+	glyph->quadMax = vec2( (float)( xOff + width ), (float)( yOff + height ) );
+	glyph->atlasEntry = entry;
+	glyph->renderable = true;
+}
+
+static void onGlyphEvicted( int fontID, int glyphIdx )
+{
+	Glyph* glyph = &( fonts[fontID].glyphsBuffer[glyphIdx] );
+	glyph->atlasEntry = DYNAMIC_GLYPH_NOT_RASTERIZED;
+	glyph->renderable = false;
+
+	// cached layouts for the font could be pointing at where the glyph used to be
+	evictLayoutsUsingFont( fontID );
+}
+
+// makes sure the glyph is ready to be drawn, for dynamic fonts this will put it in the atlas if it isn't already
+//  there, returns whether the glyph can be drawn
+static bool prepareGlyph( int fontID, Glyph* glyph )
+{
+	if( !fonts[fontID].isDynamic ) {
+		return glyph->renderable;
+	}
+
+	if( glyph->atlasEntry == DYNAMIC_GLYPH_NOT_RASTERIZED ) {
+		rasterizeGlyph( fontID, glyph );
+	}
+
+	if( glyph->atlasEntry < 0 ) {
+		return false;
+	}
+
+	glyphAtlas_Touch( glyph->atlasEntry );
+	return true;
+}
+
 int findUnusedFontID( void )
 {
 	int newFont = 0;
@@ -286,6 +703,8 @@ int txt_LoadFont( const char* fileName, int pixelHeight )
 		img_SetOffset( retIDs[i], offset );
 	}
 
+	finishFontGlyphs( &( fonts[newFont] ) );
+
 	// TODO: get a way to do this with fewer temporary allocations
 clean_up:
 	SDL_CloseIO( ioStream );
@@ -419,6 +838,8 @@ static void bindFontTask( void* data )
 		img_SetOffset( retIDs[i], offset );
 	}
 
+	finishFontGlyphs( &( fonts[newFont] ) );
+
 	// all done, set our new font
 	(*(fontData->outFontID)) = newFont;
 
@@ -549,35 +970,258 @@ void txt_UnloadFont( int fontID )
 {
 	ASSERT( fontID >= 0 );
 
+	evictLayoutsUsingFont( fontID );
+
+	if( fonts[fontID].isDynamic ) {
+		for( size_t i = 0; i < sb_Count( fonts[fontID].glyphsBuffer ); ++i ) {
+			if( fonts[fontID].glyphsBuffer[i].atlasEntry >= 0 ) {
+				glyphAtlas_Remove( fonts[fontID].glyphsBuffer[i].atlasEntry );
+			}
+		}
+		mem_Release( fonts[fontID].fontData );
+		fonts[fontID].fontData = NULL;
+		fonts[fontID].isDynamic = false;
+	} else {
+		img_CleanPackage( fonts[fontID].packageID );
+	}
+
 	sb_Release( fonts[fontID].glyphsBuffer );
 	fonts[fontID].glyphsBuffer = NULL;
-	img_CleanPackage( fonts[fontID].packageID );
+	mem_Release( fonts[fontID].glyphHash );
+	fonts[fontID].glyphHash = NULL;
+	fonts[fontID].glyphHashBits = 0;
+	fonts[fontID].glyphHashCount = 0;
+}
+
+// Loads the font at fileName as a dynamic font, with a height of pixelHeight.
+//  Returns an ID to be used when displaying a string, returns -1 if there was an issue.
+int txt_LoadDynamicFont( const char* fileName, int pixelHeight, bool useSDF )
+{
+	int newFont = -1;
+	uint8_t* buffer = NULL;
+	SDL_IOStream* ioStream = NULL;
+
+	int fontID = findUnusedFontID( );
+	if( fontID < 0 ) {
+		llog( LOG_ERROR, "Unable to find empty font to use for %s", fileName );
+		goto clean_up;
+	}
+
+	ioStream = SDL_IOFromFile( fileName, "r" );
+	if( ioStream == NULL ) {
+		llog( LOG_ERROR, "Error opening font file %s", fileName );
+		goto clean_up;
+	}
+
+	// the font data is used for as long as the font is loaded, so read in the whole thing
+	Sint64 fileSize = SDL_GetIOSize( ioStream );
+	if( fileSize <= 0 ) {
+		llog( LOG_ERROR, "Unable to get size of font file %s", fileName );
+		goto clean_up;
+	}
+
+	buffer = mem_Allocate( (size_t)fileSize );
+	if( buffer == NULL ) {
+		llog( LOG_ERROR, "Error allocating font data buffer for %s", fileName );
+		goto clean_up;
+	}
+
+	if( SDL_ReadIO( ioStream, (void*)buffer, (size_t)fileSize ) != (size_t)fileSize ) {
+		llog( LOG_ERROR, "Error reading font file %s", fileName );
+		goto clean_up;
+	}
+
+	Font* font = &( fonts[fontID] );
+	if( !stbtt_InitFont( &( font->fontInfo ), buffer, 0 ) ) {
+		llog( LOG_ERROR, "Unable to initialize font %s", fileName );
+		goto clean_up;
+	}
+
+	int ascent, descent, lineGap;
+	stbtt_GetFontVMetrics( &( font->fontInfo ), &ascent, &descent, &lineGap );
+	font->rasterScale = stbtt_ScaleForPixelHeight( &( font->fontInfo ), (float)pixelHeight );
+	font->ascent = (float)ascent * font->rasterScale;
+	font->descent = (float)descent * font->rasterScale;
+	font->lineGap = (float)lineGap * font->rasterScale;
+	font->nextLineDescent = font->ascent - font->descent + font->lineGap;
+	font->baseSize = pixelHeight;
+	font->packageID = -1;
+
+	font->isDynamic = true;
+	font->isSDF = useSDF;
+	font->fontData = buffer;
+	buffer = NULL;
+
+	font->glyphHash = NULL;
+	font->glyphHashBits = 0;
+	font->glyphHashCount = 0;
+	for( int i = 0; i < DIRECT_GLYPH_LOOKUP_SIZE; ++i ) {
+		font->directGlyphLookup[i] = -1;
+	}
+
+	// the missing character glyph is always the first, this also marks the font as being in use
+	font->glyphsBuffer = NULL;
+	font->missingCharGlyphIdx = (size_t)addDynamicGlyph( font, missingChar );
+
+	newFont = fontID;
+
+clean_up:
+	if( ioStream != NULL ) {
+		SDL_CloseIO( ioStream );
+	}
+	mem_Release( buffer );
+
+	return newFont;
+}
+
+// Uploads any glyphs that were added to the glyph atlas, should be called once a frame after everything has been
+//  drawn but before rendering.
+void txt_FlushGlyphAtlas( void )
+{
+	glyphAtlas_Flush( );
 }
 
 Glyph* getCodepointGlyph( int fontID, int codepoint )
 {
 	Font* font = &( fonts[fontID] );
-	Glyph* out = NULL;
-	size_t glyphCount = sb_Count( font->glyphsBuffer );
-	// TODO: Make this faster
-	for( size_t i = 0; i < glyphCount; ++i ) {
-		if( font->glyphsBuffer[i].codepoint == codepoint ) {
-			return &( font->glyphsBuffer[i] );
+
+	if( ( codepoint >= 0 ) && ( codepoint < DIRECT_GLYPH_LOOKUP_SIZE ) ) {
+		int32_t glyphIdx = font->directGlyphLookup[codepoint];
+		if( glyphIdx < 0 ) {
+			// only dynamic fonts will have codepoints without a glyph yet
+			glyphIdx = addDynamicGlyph( font, codepoint );
+		}
+		return &( font->glyphsBuffer[glyphIdx] );
+	}
+
+	if( font->glyphHash != NULL ) {
+		uint32_t mask = ( 1u << font->glyphHashBits ) - 1;
+		uint32_t idx = glyphHashIndex( codepoint, font->glyphHashBits );
+		while( font->glyphHash[idx].codepoint != EMPTY_GLYPH_HASH_CODEPOINT ) {
+			if( font->glyphHash[idx].codepoint == codepoint ) {
+				return &( font->glyphsBuffer[font->glyphHash[idx].glyphIdx] );
+			}
+			idx = ( idx + 1 ) & mask;
 		}
 	}
+
+	if( font->isDynamic ) {
+		return &( font->glyphsBuffer[addDynamicGlyph( font, codepoint )] );
+	}
+
 	return &( font->glyphsBuffer[ font->missingCharGlyphIdx ] );
 }
 
+#define UTF8_REPLACEMENT_CHARACTER 0xFFFD
+
 // Gets the code point from a string, will advance the string past the current codepoint to the next.
+//  Invalid sequences give back the replacement character and only advance past the first byte, this will never advance
+//  past the null terminator.
+//  https://tools.ietf.org/html/rfc3629
 uint32_t getUTF8CodePoint( const uint8_t** strData )
 {
-	// TODO: Get this working with actual UTF-8 and not just the ASCII subset
-	//  https://tools.ietf.org/html/rfc3629
-	uint32_t c = (**strData);
-	++(*strData);
+	const uint8_t* str = (*strData);
+	uint32_t c = str[0];
+
+	// ASCII
+	if( c < 0x80 ) {
+		++(*strData);
+		return c;
+	}
+
+	int numContinuation;
+	uint32_t minValue;
+	if( ( c & 0xE0 ) == 0xC0 ) {
+		numContinuation = 1;
+		minValue = 0x80;
+		c &= 0x1F;
+	} else if( ( c & 0xF0 ) == 0xE0 ) {
+		numContinuation = 2;
+		minValue = 0x800;
+		c &= 0x0F;
+	} else if( ( c & 0xF8 ) == 0xF0 ) {
+		numContinuation = 3;
+		minValue = 0x10000;
+		c &= 0x07;
+	} else {
+		// stray continuation byte or invalid lead byte
+		++(*strData);
+		return UTF8_REPLACEMENT_CHARACTER;
+	}
+
+	// a null terminator will fail this check so we won't read past the end of the string
+	for( int i = 1; i <= numContinuation; ++i ) {
+		if( ( str[i] & 0xC0 ) != 0x80 ) {
+			++(*strData);
+			return UTF8_REPLACEMENT_CHARACTER;
+		}
+		c = ( c << 6 ) | ( str[i] & 0x3F );
+	}
+
+	// overlong encodings, surrogates, and values past the end of unicode aren't allowed
+	if( ( c < minValue ) || ( ( c >= 0xD800 ) && ( c <= 0xDFFF ) ) || ( c > 0x10FFFF ) ) {
+		++(*strData);
+		return UTF8_REPLACEMENT_CHARACTER;
+	}
+
+	(*strData) += numContinuation + 1;
 	return c;
 }
 
+// appends the quad for the glyph with it's pen position at penPos
+static void appendGlyphQuad( const Glyph* glyph, const Vector2* penPos, float scale, TextQuad** sbQuads )
+{
+	TextQuad* quad = sb_Add( (*sbQuads), 1 );
+	vec2_AddScaled( penPos, &( glyph->quadMin ), scale, &( quad->min ) );
+	vec2_AddScaled( penPos, &( glyph->quadMax ), scale, &( quad->max ) );
+	quad->uvMin = glyph->uvMin;
+	quad->uvMax = glyph->uvMax;
+	quad->texture = glyph->texture;
+	quad->shaderType = glyph->shaderType;
+	quad->transparent = glyph->transparent;
+	quad->atlasEntry = glyph->atlasEntry;
+}
+
+// adds the triangles for all the quads, transformed by tf
+static void submitTextQuads( const TextQuad* quads, size_t count, const Matrix3* tf, const Color* clr, uint32_t camFlags, int8_t depth )
+{
+	PlatformTexture extraTexture = gfxPlatform_GetDefaultPlatformTexture( );
+	bool clrTransparent = ( clr->a != 1.0f );
+
+	TriVert verts[4];
+	for( int i = 0; i < 4; ++i ) {
+		verts[i].col = *clr;
+	}
+
+	for( size_t i = 0; i < count; ++i ) {
+		const TextQuad* quad = &( quads[i] );
+
+		// keep the glyphs used by cached layouts from being evicted
+		if( quad->atlasEntry >= 0 ) {
+			glyphAtlas_Touch( quad->atlasEntry );
+		}
+
+		Vector2 corner;
+		mat3_TransformVec2Pos( tf, &( quad->min ), &( verts[0].pos ) );
+		verts[0].uv = quad->uvMin;
+
+		corner = vec2( quad->min.x, quad->max.y );
+		mat3_TransformVec2Pos( tf, &corner, &( verts[1].pos ) );
+		verts[1].uv = vec2( quad->uvMin.x, quad->uvMax.y );
+
+		corner = vec2( quad->max.x, quad->min.y );
+		mat3_TransformVec2Pos( tf, &corner, &( verts[2].pos ) );
+		verts[2].uv = vec2( quad->uvMax.x, quad->uvMin.y );
+
+		mat3_TransformVec2Pos( tf, &( quad->max ), &( verts[3].pos ) );
+		verts[3].uv = quad->uvMax;
+
+		TriType type = ( quad->transparent || clrTransparent ) ? TT_TRANSPARENT : TT_SOLID;
+		triRenderer_Add( verts[0], verts[1], verts[2], quad->shaderType, quad->texture, extraTexture, 0.0f, -1, camFlags, depth, type );
+		triRenderer_Add( verts[1], verts[2], verts[3], quad->shaderType, quad->texture, extraTexture, 0.0f, -1, camFlags, depth, type );
+	}
+}
+
 // Gets the total width of the string once it's been rendered
 float calcStringRenderWidth( const uint8_t* str, int fontID, float scale )
 {
@@ -686,23 +1330,15 @@ void txt_CalculateStringRenderSize( const char* utf8Str, int fontID, float desir
 	outSize->h = calcRenderHeight( (const uint8_t*)utf8Str, fontID ) * scale;
 }
 
-// Draws a string on the screen. The base line is determined by pos.
-void txt_DisplayString( const uint8_t* utf8Str, Vector2 pos, Color clr, HorizTextAlignment hAlign, VertTextAlignment vAlign,
-	int fontID, int camFlags, int8_t depth, float desiredPixelSize )
+// creates the quads for the string, the base line of the first line is at the origin
+static void layoutString( const uint8_t* utf8Str, HorizTextAlignment hAlign, VertTextAlignment vAlign, int fontID, float scale,
+	TextQuad** sbQuads )
 {
-	ASSERT( utf8Str != NULL );
-
-	if( fontID < 0 ) return;
-
-	float scale = desiredPixelSize / fonts[fontID].baseSize;
-
-	// TODO: Alignment options?
 	// TODO: Handle multi-line text better (sometimes letters overlap right now)
-	const uint8_t* str = (uint8_t*)utf8Str;
-	Vector2 currPos = pos;
+	const uint8_t* str = utf8Str;
+	Vector2 currPos = VEC2_ZERO;
 	positionStringStartX( str, fontID, hAlign, scale, &currPos );
 	positionStringStartY( str, fontID, vAlign, scale, &currPos );
-	Vector2 scaleVec = vec2( scale, scale );
 	uint32_t codepoint = 0;
 	do {
 		codepoint = getUTF8CodePoint( &str );
@@ -710,23 +1346,37 @@ void txt_DisplayString( const uint8_t* utf8Str, Vector2 pos, Color clr, HorizTex
 			// end of line do nothing
 		} else if( codepoint == 0xA ) {
 			// new line
-			currPos.x = pos.x;
+			currPos.x = 0.0f;
 			currPos.y += fonts[fontID].nextLineDescent * scale;
 			positionStringStartX( str, fontID, hAlign, scale, &currPos );
 		} else {
 			Glyph* glyph = getCodepointGlyph( fontID, codepoint );
-			if( glyph != NULL ) {
-				Vector2 offset;
-				img_GetOffset( glyph->imageID, &offset );
-				Vector2 renderPos;
-				vec2_AddScaled( &currPos, &offset, scale, &renderPos );
-				img_Render_PosScaleVClr( glyph->imageID, camFlags, depth, &renderPos, &scaleVec, &clr );
-				currPos.x += glyph->advance * scale;
+			if( prepareGlyph( fontID, glyph ) ) {
+				appendGlyphQuad( glyph, &currPos, scale, sbQuads );
 			}
+			currPos.x += glyph->advance * scale;
 		}
 	} while( codepoint != 0 );
 }
 
+// Draws a string on the screen. The base line is determined by pos.
+void txt_DisplayString( const uint8_t* utf8Str, Vector2 pos, Color clr, HorizTextAlignment hAlign, VertTextAlignment vAlign,
+	int fontID, int camFlags, int8_t depth, float desiredPixelSize )
+{
+	ASSERT( utf8Str != NULL );
+
+	if( fontID < 0 ) return;
+
+	float scale = desiredPixelSize / fonts[fontID].baseSize;
+
+	sb_Clear( sbWorkingQuads );
+	layoutString( utf8Str, hAlign, vAlign, fontID, scale, &sbWorkingQuads );
+
+	Matrix3 tf = IDENTITY_MATRIX_3;
+	mat3_SetPosition( &tf, &pos );
+	submitTextQuads( sbWorkingQuads, sb_Count( sbWorkingQuads ), &tf, &clr, camFlags, depth );
+}
+
 // returns whether we can break the line at the specified codepoint
 //  gotten from here: https://en.wikipedia.org/wiki/Whitespace_character#Unicode
 bool isBreakableCodepoint( int codepoint )
@@ -763,24 +1413,13 @@ void convertOutToBuffer( const uint8_t* utf8Str )
 	} while( codepoint != 0 );
 }
 
-// Draws a string on the screen to an area. Splits up lines and such. If outCharPos is not equal to NULL it will
-//  grab the position of the character at storeCharPos and put it in there. Returns if outCharPos is valid.
-bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vector2 size, Color clr,
-	HorizTextAlignment hAlign, VertTextAlignment vAlign, int fontID, size_t storeCharPos, Vector2* outCharPos,
-	uint32_t camFlags, int8_t depth, float desiredPixelSize )
+// creates the quads for the string wrapped to fit inside an area of size centered on the origin, if outCharPos is not
+//  NULL it will get the position of the character at storeCharPos. Returns if outCharPos is valid.
+static bool layoutTextArea( const uint8_t* utf8Str, Vector2 size, HorizTextAlignment hAlign, VertTextAlignment vAlign,
+	int fontID, float scale, size_t storeCharPos, Vector2* outCharPos, TextQuad** sbQuads )
 {
-	ASSERT( utf8Str != NULL );
-
-	if( fontID < 0 ) {
-		return false;
-	}
-
 	Vector2 upperLeft = vec2( -size.x / 2.0f, -size.y / 2.0f );
 
-	float scale = desiredPixelSize / fonts[fontID].baseSize;
-
-	const uint8_t* str = (uint8_t*)utf8Str;
-
 	bool posValid = false;
 	size_t charBufferPos = SIZE_MAX;
 
@@ -874,13 +1513,6 @@ bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vecto
 		break;
 	}
 
-	Matrix3 characterTf;
-	mat3_CreateScale( scale, &characterTf );
-	ImageRenderInstruction inst = img_CreateDefaultRenderInstruction( );
-	inst.camFlags = camFlags;
-	inst.depth = depth;
-	inst.color = clr;
-	
 	positionCodepointsStartX( sbStringCodepointBuffer, fontID, hAlign, size.x, scale, &renderPos );
 	for( size_t i = 0; ( i < sb_Count( sbStringCodepointBuffer ) ) && ( sbStringCodepointBuffer[i] != 0 ); ++i ) {
 		if( sbStringCodepointBuffer[i] == LINE_FEED ) {
@@ -890,18 +1522,10 @@ bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vecto
 			positionCodepointsStartX( &( sbStringCodepointBuffer[i+1] ), fontID, hAlign, size.x, scale, &renderPos );
 		} else {
 			Glyph* glyph = getCodepointGlyph( fontID, sbStringCodepointBuffer[i] );
-			if( glyph != NULL ) {			
-				// set the data for this character
-				inst.imgID = glyph->imageID;
-				Vector2 offset, finalPos;
-				img_GetOffset( inst.imgID, &offset );
-				vec2_AddScaled( &renderPos, &offset, scale, &finalPos );
-				mat3_SetPosition( &characterTf, &finalPos );
-				mat3_Multiply( centerTf, &characterTf, &(inst.mat) );
-				img_ImmediateRender( &inst );
-
-				renderPos.x += ( glyph->advance * scale );
+			if( prepareGlyph( fontID, glyph ) ) {
+				appendGlyphQuad( glyph, &renderPos, scale, sbQuads );
 			}
+			renderPos.x += ( glyph->advance * scale );
 		}
 
 		if( ( i == charBufferPos ) && ( outCharPos != NULL ) ) {
@@ -918,6 +1542,298 @@ bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vecto
 	return posValid;
 }
 
+// Draws a string on the screen to an area. Splits up lines and such. If outCharPos is not equal to NULL it will
+//  grab the position of the character at storeCharPos and put it in there. Returns if outCharPos is valid.
+bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vector2 size, Color clr,
+	HorizTextAlignment hAlign, VertTextAlignment vAlign, int fontID, size_t storeCharPos, Vector2* outCharPos,
+	uint32_t camFlags, int8_t depth, float desiredPixelSize )
+{
+	ASSERT( utf8Str != NULL );
+
+	if( fontID < 0 ) {
+		return false;
+	}
+
+	float scale = desiredPixelSize / fonts[fontID].baseSize;
+
+	sb_Clear( sbWorkingQuads );
+	bool posValid = layoutTextArea( utf8Str, size, hAlign, vAlign, fontID, scale, storeCharPos, outCharPos, &sbWorkingQuads );
+	submitTextQuads( sbWorkingQuads, sb_Count( sbWorkingQuads ), centerTf, &clr, camFlags, depth );
+
+	return posValid;
+}
+
+//***** Layout cache
+static uint64_t hashLayoutKey( const uint8_t* utf8Str, size_t len, int fontID, float pixelSize, bool isArea, Vector2 areaSize,
+	HorizTextAlignment hAlign, VertTextAlignment vAlign )
+{
+	uint64_t hash = fnv1aHash( FNV1A_START, utf8Str, len );
+
+	uint32_t params[] = {
+		(uint32_t)fontID,
+		*(uint32_t*)&pixelSize,
+		(uint32_t)isArea,
+		*(uint32_t*)&( areaSize.x ),
+		*(uint32_t*)&( areaSize.y ),
+		(uint32_t)hAlign,
+		(uint32_t)vAlign
+	};
+
+	return fnv1aHash( hash, params, sizeof( params ) );
+}
+
+static void lruUnlink( int idx )
+{
+	CachedTextLayout* layout = &( cachedLayouts[idx] );
+
+	if( layout->lruPrev >= 0 ) {
+		cachedLayouts[layout->lruPrev].lruNext = layout->lruNext;
+	} else {
+		lruHead = layout->lruNext;
+	}
+
+	if( layout->lruNext >= 0 ) {
+		cachedLayouts[layout->lruNext].lruPrev = layout->lruPrev;
+	} else {
+		lruTail = layout->lruPrev;
+	}
+
+	layout->lruPrev = -1;
+	layout->lruNext = -1;
+}
+
+static void lruPushFront( int idx )
+{
+	CachedTextLayout* layout = &( cachedLayouts[idx] );
+	layout->lruPrev = -1;
+	layout->lruNext = lruHead;
+	if( lruHead >= 0 ) {
+		cachedLayouts[lruHead].lruPrev = idx;
+	}
+	lruHead = idx;
+	if( lruTail < 0 ) {
+		lruTail = idx;
+	}
+}
+
+static void evictLayout( int idx )
+{
+	CachedTextLayout* layout = &( cachedLayouts[idx] );
+	ASSERT_AND_IF_NOT( layout->inUse ) return;
+
+	// remove it from it's bucket
+	int* link = &( layoutBuckets[layout->hash % LAYOUT_HASH_BUCKETS] );
+	while( (*link) != idx ) {
+		ASSERT_AND_IF_NOT( (*link) >= 0 ) break;
+		link = &( cachedLayouts[*link].nextInBucket );
+	}
+	if( (*link) == idx ) {
+		(*link) = layout->nextInBucket;
+	}
+
+	lruUnlink( idx );
+
+	layoutCacheStats.memoryUsed -= layout->memoryUsed;
+	--layoutCacheStats.numLayouts;
+
+	mem_Release( layout->quads );
+	SDL_memset( layout, 0, sizeof( *layout ) );
+	layout->lruPrev = layout->lruNext = layout->nextInBucket = -1;
+}
+
+static void resetLayoutCache( void )
+{
+	for( int i = 0; i < MAX_CACHED_LAYOUTS; ++i ) {
+		if( cachedLayouts[i].inUse ) {
+			mem_Release( cachedLayouts[i].quads );
+		}
+		SDL_memset( &( cachedLayouts[i] ), 0, sizeof( cachedLayouts[i] ) );
+		cachedLayouts[i].lruPrev = cachedLayouts[i].lruNext = cachedLayouts[i].nextInBucket = -1;
+	}
+
+	for( int i = 0; i < LAYOUT_HASH_BUCKETS; ++i ) {
+		layoutBuckets[i] = -1;
+	}
+
+	lruHead = -1;
+	lruTail = -1;
+	layoutCacheStats.memoryUsed = 0;
+	layoutCacheStats.numLayouts = 0;
+}
+
+static void evictLayoutsUsingFont( int fontID )
+{
+	for( int i = 0; i < MAX_CACHED_LAYOUTS; ++i ) {
+		if( cachedLayouts[i].inUse && ( cachedLayouts[i].fontID == fontID ) ) {
+			evictLayout( i );
+		}
+	}
+}
+
+// gets the cached layout, creating it if it doesn't exist, returns NULL if it couldn't be cached
+static CachedTextLayout* acquireCachedLayout( const uint8_t* utf8Str, int fontID, float pixelSize, bool isArea, Vector2 areaSize,
+	HorizTextAlignment hAlign, VertTextAlignment vAlign )
+{
+	if( !textInitialized ) {
+		return NULL;
+	}
+
+	size_t len = SDL_strlen( (const char*)utf8Str );
+	uint64_t hash = hashLayoutKey( utf8Str, len, fontID, pixelSize, isArea, areaSize, hAlign, vAlign );
+
+	int idx = layoutBuckets[hash % LAYOUT_HASH_BUCKETS];
+	while( idx >= 0 ) {
+		CachedTextLayout* layout = &( cachedLayouts[idx] );
+		if( ( layout->hash == hash ) && ( layout->textLen == len ) && ( layout->fontID == fontID ) &&
+			( layout->pixelSize == pixelSize ) && ( layout->isArea == isArea ) && ( layout->hAlign == hAlign ) &&
+			( layout->vAlign == vAlign ) && ( !isArea || ( ( layout->areaSize.x == areaSize.x ) && ( layout->areaSize.y == areaSize.y ) ) ) &&
+			( SDL_memcmp( layout->text, utf8Str, len ) == 0 ) ) {
+
+			lruUnlink( idx );
+			lruPushFront( idx );
+			++layoutCacheStats.hits;
+			return layout;
+		}
+		idx = layout->nextInBucket;
+	}
+
+	++layoutCacheStats.misses;
+
+	// build it in the working buffer first so we know how much memory it needs
+	float scale = pixelSize / fonts[fontID].baseSize;
+	sb_Clear( sbWorkingQuads );
+	layoutMissingGlyphs = false;
+	if( isArea ) {
+		layoutTextArea( utf8Str, areaSize, hAlign, vAlign, fontID, scale, SIZE_MAX, NULL, &sbWorkingQuads );
+	} else {
+		layoutString( utf8Str, hAlign, vAlign, fontID, scale, &sbWorkingQuads );
+	}
+
+	// don't want to keep a layout around that's missing glyphs
+	if( layoutMissingGlyphs ) {
+		return NULL;
+	}
+
+	size_t numQuads = sb_Count( sbWorkingQuads );
+	size_t memoryNeeded = ( sizeof( TextQuad ) * numQuads ) + len + 1;
+	if( memoryNeeded > layoutCacheStats.memoryBudget ) {
+		return NULL;
+	}
+
+	// make room, the least recently used layouts go first
+	int newIdx = -1;
+	for( int i = 0; ( i < MAX_CACHED_LAYOUTS ) && ( newIdx < 0 ); ++i ) {
+		if( !cachedLayouts[i].inUse ) newIdx = i;
+	}
+	while( ( ( newIdx < 0 ) || ( ( layoutCacheStats.memoryUsed + memoryNeeded ) > layoutCacheStats.memoryBudget ) ) && ( lruTail >= 0 ) ) {
+		int evictIdx = lruTail;
+		evictLayout( evictIdx );
+		++layoutCacheStats.evictions;
+		if( newIdx < 0 ) newIdx = evictIdx;
+	}
+
+	if( newIdx < 0 ) {
+		return NULL;
+	}
+
+	// the quads and the copy of the string share the allocation
+	uint8_t* memory = mem_Allocate( memoryNeeded );
+	if( memory == NULL ) {
+		llog( LOG_WARN, "Unable to allocate memory for cached text layout." );
+		return NULL;
+	}
+
+	CachedTextLayout* layout = &( cachedLayouts[newIdx] );
+	layout->inUse = true;
+	layout->hash = hash;
+	layout->quads = (TextQuad*)memory;
+	layout->numQuads = numQuads;
+	layout->text = memory + ( sizeof( TextQuad ) * numQuads );
+	layout->textLen = len;
+	layout->fontID = fontID;
+	layout->pixelSize = pixelSize;
+	layout->isArea = isArea;
+	layout->areaSize = areaSize;
+	layout->hAlign = hAlign;
+	layout->vAlign = vAlign;
+	layout->memoryUsed = memoryNeeded;
+
+	SDL_memcpy( layout->quads, sbWorkingQuads, sizeof( TextQuad ) * numQuads );
+	SDL_memcpy( layout->text, utf8Str, len + 1 );
+
+	int bucket = (int)( hash % LAYOUT_HASH_BUCKETS );
+	layout->nextInBucket = layoutBuckets[bucket];
+	layoutBuckets[bucket] = newIdx;
+	lruPushFront( newIdx );
+
+	layoutCacheStats.memoryUsed += memoryNeeded;
+	++layoutCacheStats.numLayouts;
+
+	return layout;
+}
+
+void txt_DisplayCachedString( const uint8_t* utf8Str, const Matrix3* tf, Color clr, HorizTextAlignment hAlign, VertTextAlignment vAlign,
+	int fontID, uint32_t camFlags, int8_t depth, float desiredPixelSize )
+{
+	ASSERT( utf8Str != NULL );
+	ASSERT( tf != NULL );
+
+	if( fontID < 0 ) return;
+
+	CachedTextLayout* layout = acquireCachedLayout( utf8Str, fontID, desiredPixelSize, false, VEC2_ZERO, hAlign, vAlign );
+	if( layout != NULL ) {
+		submitTextQuads( layout->quads, layout->numQuads, tf, &clr, camFlags, depth );
+	} else {
+		// couldn't be cached, fall back to the normal path
+		sb_Clear( sbWorkingQuads );
+		layoutString( utf8Str, hAlign, vAlign, fontID, desiredPixelSize / fonts[fontID].baseSize, &sbWorkingQuads );
+		submitTextQuads( sbWorkingQuads, sb_Count( sbWorkingQuads ), tf, &clr, camFlags, depth );
+	}
+}
+
+void txt_DisplayCachedTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vector2 size, Color clr,
+	HorizTextAlignment hAlign, VertTextAlignment vAlign, int fontID, uint32_t camFlags, int8_t depth, float desiredPixelSize )
+{
+	ASSERT( utf8Str != NULL );
+	ASSERT( centerTf != NULL );
+
+	if( fontID < 0 ) return;
+
+	CachedTextLayout* layout = acquireCachedLayout( utf8Str, fontID, desiredPixelSize, true, size, hAlign, vAlign );
+	if( layout != NULL ) {
+		submitTextQuads( layout->quads, layout->numQuads, centerTf, &clr, camFlags, depth );
+	} else {
+		txt_DisplayTextArea( utf8Str, centerTf, size, clr, hAlign, vAlign, fontID, 0, NULL, camFlags, depth, desiredPixelSize );
+	}
+}
+
+void txt_SetLayoutCacheBudget( size_t bytes )
+{
+	layoutCacheStats.memoryBudget = bytes;
+	while( ( layoutCacheStats.memoryUsed > layoutCacheStats.memoryBudget ) && ( lruTail >= 0 ) ) {
+		evictLayout( lruTail );
+		++layoutCacheStats.evictions;
+	}
+}
+
+void txt_ClearLayoutCache( void )
+{
+	resetLayoutCache( );
+}
+
+void txt_GetLayoutCacheStats( TextLayoutCacheStats* outStats )
+{
+	ASSERT_AND_IF_NOT( outStats != NULL ) return;
+	(*outStats) = layoutCacheStats;
+}
+
+void txt_ResetLayoutCacheStats( void )
+{
+	layoutCacheStats.hits = 0;
+	layoutCacheStats.misses = 0;
+	layoutCacheStats.evictions = 0;
+}
+
 // copied from stb_truetype.h, want to be able to calculate the size without creating the image so we can do the
 //  packing without having to render each letter
 static void calcSDFCodepointSize( stbtt_fontinfo* font, int codepoint, float scale, int padding, int* outWidth, int* outHeight )
@@ -1230,6 +2146,8 @@ static int loadSDFFont( const char* fileName )
 		}
 	}
 
+	finishFontGlyphs( &( fonts[fontID] ) );
+
 clean_up:
 
 	mem_Release( retIDs );
@@ -1250,53 +2168,199 @@ clean_up:
 #undef CHECK_READ
 }
 
-// Creates a font that's rendered out as a signed distance field. Will also attempt to save a version of this font that
-//  can be loaded later much quicker.
-int txt_CreateSDFFont( const char* fileName )
+#define SDF_FONT_PIXEL_HEIGHT 64
+#define SDF_FONT_PADDING 4 //6; //4; // 6 instead of 4 to solve flickering issues with some fonts
+#define SDF_FONT_ON_EDGE_VALUE 128
+#define SDF_FONT_IMAGE_SIZE 1024
+// enough for the largest glyph at the size we render at, anything larger falls back to the general allocator
+#define SDF_SCRATCH_SIZE ( 256 * 1024 )
+
+// everything needed to render the glyphs of an sdf font into a single image, the rects are packed before anything is
+//  rendered so where each glyph ends up doesn't depend on the order the glyphs are finished in
+typedef struct {
+	const stbtt_fontinfo* font;
+	float scale;
+	stbrp_rect* rects;
+	int numRects;
+	uint8_t* image;
+	int imageWidth;
+	const char* fileName;
+
+	SDL_AtomicInt nextRect;
+	SDL_AtomicInt rectsDone;
+	SDL_AtomicInt lanesDone;
+
+	// only used when everything is rendered on the calling thread
+	SDFFontProgressFunc progress;
+	void* progressData;
+} SDFRenderJob;
+
+// each lane pulls glyphs until there are none left, they each have their own scratch memory so they don't end up
+//  fighting over the lock in the general allocator
+typedef struct {
+	SDFRenderJob* job;
+	ScratchArena arena;
+} SDFRenderLane;
+
+static void renderSDFGlyph( SDFRenderJob* job, int idx )
 {
-	ASSERT( textInitialized );
-	if( !textInitialized ) {
-		return 0;
+	stbrp_rect* rect = &( job->rects[idx] );
+	if( !rect->was_packed ) {
+		llog( LOG_WARN, "Unable to pack codepoint %i for font %s.", rect->id, job->fileName );
+		return;
+	}
+
+	int sdfWidth, sdfHeight, sdfXOff, sdfYOff;
+	unsigned char* charSDF = stbtt_GetCodepointSDF( job->font, job->scale, rect->id, SDF_FONT_PADDING, SDF_FONT_ON_EDGE_VALUE,
+		(float)SDF_FONT_ON_EDGE_VALUE / (float)SDF_FONT_PADDING, &sdfWidth, &sdfHeight, &sdfXOff, &sdfYOff );
+	if( charSDF == NULL ) {
+		return;
+	}
+
+	// pack into image
+	//  would really like a version of memcpy with stride
+	for( int yo = 0; yo < rect->h; ++yo ) {
+		unsigned char* rowDest = job->image + ( rect->x + ( ( rect->y + yo ) * job->imageWidth ) );
+		unsigned char* rowSrc = charSDF + ( yo * rect->w );
+		memcpy( rowDest, rowSrc, sizeof( unsigned char ) * rect->w );
+	}
+	STBTT_free( charSDF, 0 );
+}
+
+static void renderSDFGlyphsTask( void* data )
+{
+	SDFRenderLane* lane = (SDFRenderLane*)data;
+	SDFRenderJob* job = lane->job;
+
+	SDL_SetTLS( &stbttScratchTLS, &( lane->arena ), NULL );
+
+	int idx;
+	while( ( idx = SDL_AddAtomicInt( &( job->nextRect ), 1 ) ) < job->numRects ) {
+		renderSDFGlyph( job, idx );
+		lane->arena.used = 0;
+
+		int done = SDL_AddAtomicInt( &( job->rectsDone ), 1 ) + 1;
+		if( job->progress != NULL ) {
+			job->progress( done, job->numRects, job->progressData );
+		}
+	}
+
+	SDL_SetTLS( &stbttScratchTLS, NULL, NULL );
+	SDL_AddAtomicInt( &( job->lanesDone ), 1 );
+}
+
+// renders all the glyphs into the image, when numWorkers is more than one the glyphs are split up between jobs on the
+//  job queue and the calling thread waits for them to finish. The resulting image is the same no matter how many
+//  workers are used.
+static bool renderSDFGlyphs( SDFRenderJob* job, int numWorkers, SDFFontProgressFunc progress, void* progressData )
+{
+	numWorkers = MAX( numWorkers, 1 );
+	numWorkers = MIN( numWorkers, MAX( job->numRects, 1 ) );
+
+	SDL_SetAtomicInt( &( job->nextRect ), 0 );
+	SDL_SetAtomicInt( &( job->rectsDone ), 0 );
+	SDL_SetAtomicInt( &( job->lanesDone ), 0 );
+	job->progress = NULL;
+	job->progressData = NULL;
+
+	SDFRenderLane* lanes = mem_Allocate( sizeof( SDFRenderLane ) * numWorkers );
+	if( lanes == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate sdf render lanes for font %s", job->fileName );
+		return false;
 	}
-	/*
-	int font = loadSDFFont( fileName );
-	if( font == -1 ) {
-		font = generateSDFFont( fileName );
-		// have save inside generate, as we may have to do some processing after it's saved
-		if( !saveSDFFont( filename, font ) ) {
-			llog( LOG_WARN, "Unable to save generated sdf font: %s", fileName );
+
+	bool success = true;
+	int numLanes = 0;
+	for( ; numLanes < numWorkers; ++numLanes ) {
+		lanes[numLanes].job = job;
+		lanes[numLanes].arena.used = 0;
+		lanes[numLanes].arena.size = SDF_SCRATCH_SIZE;
+		lanes[numLanes].arena.memory = mem_Allocate( SDF_SCRATCH_SIZE );
+		if( lanes[numLanes].arena.memory == NULL ) {
+			llog( LOG_ERROR, "Unable to allocate sdf scratch memory for font %s", job->fileName );
+			success = false;
+			goto clean_up;
 		}
 	}
-	return font;
-	*/
 
-	// first try to load an existing sdf font, if it doesn't exist then create it
-	int newFont = loadSDFFont( fileName );
-	if( newFont != -1 ) {
-		return newFont;
+	if( numLanes == 1 ) {
+		job->progress = progress;
+		job->progressData = progressData;
+		renderSDFGlyphsTask( &( lanes[0] ) );
+	} else {
+		int lanesQueued = 0;
+		for( int i = 0; i < numLanes; ++i ) {
+			if( jq_AddJob( renderSDFGlyphsTask, &( lanes[i] ) ) ) {
+				++lanesQueued;
+			}
+		}
+
+		// if none of the lanes could be queued we'll do all the work here
+		if( lanesQueued == 0 ) {
+			renderSDFGlyphsTask( &( lanes[0] ) );
+			lanesQueued = 1;
+		}
+
+		// help out with the jobs while waiting so this doesn't stall when every worker is busy or there are no threads
+		int lastReported = -1;
+		while( SDL_GetAtomicInt( &( job->lanesDone ) ) < lanesQueued ) {
+			int done = SDL_GetAtomicInt( &( job->rectsDone ) );
+			if( ( progress != NULL ) && ( done != lastReported ) ) {
+				progress( done, job->numRects, progressData );
+				lastReported = done;
+			}
+
+			if( !jq_ProcessNextJob( ) ) {
+				SDL_Delay( 1 );
+			}
+		}
+
+		if( progress != NULL ) {
+			progress( job->numRects, job->numRects, progressData );
+		}
 	}
 
-	int pixelHeight = 64;
-	int padding = 4; //6; //4; // 6 instead of 4 to solve flickering issues with some fonts
-	unsigned char onEdgeValue = 128;
-	float pixelDistScale = (float)onEdgeValue/(float)padding;
+clean_up:
+	for( int i = 0; i < numLanes; ++i ) {
+		mem_Release( lanes[i].arena.memory );
+	}
+	mem_Release( lanes );
 
-	// first we'd like to generate the borders so we can pack everything tightly without having
-	//  to store every image
-	unsigned char* baseImage = NULL;
-	stbrp_rect* rects = NULL;
-	stbrp_node* nodes = NULL;
-	uint8_t* buffer = NULL;
+	return success;
+}
+
+// the results of generating an sdf font, everything needed to create the glyphs and save the font
+typedef struct {
+	uint8_t* fontData;
 	stbtt_fontinfo font;
-	Glyph* sbGlyphStorage = NULL;
-	Vector2* mins = NULL;
-	Vector2* maxes = NULL;
-	Vector2* offsets = NULL;
-	ImageID* retIDs = NULL;
+	float scale;
+	int ascent;
+	int descent;
+	int lineGap;
+	stbrp_rect* rects;
+	int numRects;
+	uint8_t* image;
+} SDFFontBuild;
+
+static void cleanUpSDFFontBuild( SDFFontBuild* build )
+{
+	mem_Release( build->fontData );
+	mem_Release( build->rects );
+	mem_Release( build->image );
+	SDL_memset( build, 0, sizeof( *build ) );
+}
+
+// reads in the font, packs all the glyphs, and renders them out
+static bool buildSDFFont( const char* fileName, int numWorkers, SDFFontProgressFunc progress, void* progressData, SDFFontBuild* outBuild )
+{
+	bool success = false;
+	stbrp_node* nodes = NULL;
+	SDL_IOStream* ioStream = NULL;
+
+	SDL_memset( outBuild, 0, sizeof( *outBuild ) );
 
 #define OUT_ERROR( s ) \
 	{ \
-		newFont = -1; \
 		llog( LOG_ERROR, "%s for font %s", (s), fileName ); \
 		goto clean_up; \
 	}
@@ -1304,119 +2368,166 @@ int txt_CreateSDFFont( const char* fileName )
 #define CHECK_POINTER( p, s ) \
 	{ if( (p) == NULL ) OUT_ERROR( s ); }
 
-	// find an unused font ID
-	newFont = findUnusedFontID( );
-	if( newFont < 0 ) {
-		OUT_ERROR( "Unable to find empty font to use" );
-	}
+	ioStream = SDL_IOFromFile( fileName, "r" );
+	CHECK_POINTER( ioStream, "Error opening file" );
 
-	//  some temporary memory for loading the file
-	size_t bufferSize = 1024 * 1024;
-	buffer = mem_Allocate( bufferSize * sizeof( uint8_t ) ); // megabyte sized buffer, should never load a file larger than this
-	CHECK_POINTER( buffer, "Error allocating font data buffer" );
+	Sint64 fileSize = SDL_GetIOSize( ioStream );
+	if( fileSize <= 0 ) {
+		OUT_ERROR( "Unable to get file size" );
+	}
 
-	SDL_IOStream* ioStream = SDL_IOFromFile( fileName, "r" );
-	CHECK_POINTER( ioStream, "Error opening file" );
+	outBuild->fontData = mem_Allocate( (size_t)fileSize );
+	CHECK_POINTER( outBuild->fontData, "Error allocating font data buffer" );
 
-	size_t numRead = SDL_ReadIO( ioStream, (void*)buffer, sizeof( uint8_t ) * bufferSize );
-	if( numRead >= bufferSize ) {
-		OUT_ERROR( "Too much data read in from file" );
+	if( SDL_ReadIO( ioStream, (void*)outBuild->fontData, (size_t)fileSize ) != (size_t)fileSize ) {
+		OUT_ERROR( "Error reading file" );
 	}
-	
-	// get some of the basic font stuff, need to do this so we can handle multiple lines of text
-	int ascent, descent, lineGap;
-	float scale;
-	stbtt_InitFont( &font, buffer, 0 );
-	stbtt_GetFontVMetrics( &font, &ascent, &descent, &lineGap );
-	scale = stbtt_ScaleForPixelHeight( &font, (float)pixelHeight );
-	fonts[newFont].ascent = (float)ascent * scale;
-	fonts[newFont].descent = (float)descent * scale;
-	fonts[newFont].lineGap = (float)lineGap * scale;
-	fonts[newFont].nextLineDescent = fonts[newFont].ascent - fonts[newFont].descent + fonts[newFont].lineGap;
-	fonts[newFont].baseSize = pixelHeight;
 
-	//float test = (float)pixelHeight / ( ascent - descent );
+	// get some of the basic font stuff, need to do this so we can handle multiple lines of text
+	if( !stbtt_InitFont( &( outBuild->font ), outBuild->fontData, 0 ) ) {
+		OUT_ERROR( "Unable to initialize font" );
+	}
+	stbtt_GetFontVMetrics( &( outBuild->font ), &( outBuild->ascent ), &( outBuild->descent ), &( outBuild->lineGap ) );
+	outBuild->scale = stbtt_ScaleForPixelHeight( &( outBuild->font ), (float)SDF_FONT_PIXEL_HEIGHT );
 
-	const int WIDTH = 1024;
-	const int HEIGHT = 1024;
 	// generate the boxes for all the glyphs we want to pack and then pack them
-	rects = mem_Allocate( sizeof( stbrp_rect ) * fontPackRange.num_chars );
-	CHECK_POINTER( rects, "Error packing rects" );
+	outBuild->numRects = fontPackRange.num_chars;
+	outBuild->rects = mem_Allocate( sizeof( stbrp_rect ) * outBuild->numRects );
+	CHECK_POINTER( outBuild->rects, "Error packing rects" );
 
-	for( int i = 0; i < fontPackRange.num_chars; ++i ) {
+	for( int i = 0; i < outBuild->numRects; ++i ) {
 		int width, height;
-		calcSDFCodepointSize( &font, fontPackRange.array_of_unicode_codepoints[i], scale, padding, &width, &height );
-		rects[i].w = (stbrp_coord)width;
-		rects[i].h = (stbrp_coord)height;
-		rects[i].id = fontPackRange.array_of_unicode_codepoints[i];
+		calcSDFCodepointSize( &( outBuild->font ), fontPackRange.array_of_unicode_codepoints[i], outBuild->scale, SDF_FONT_PADDING, &width, &height );
+		outBuild->rects[i].w = (stbrp_coord)width;
+		outBuild->rects[i].h = (stbrp_coord)height;
+		outBuild->rects[i].id = fontPackRange.array_of_unicode_codepoints[i];
 	}
 	// TODO: find a way to pack to approximate a minimum size image
-	nodes = mem_Allocate( sizeof( stbrp_node ) * WIDTH );
+	nodes = mem_Allocate( sizeof( stbrp_node ) * SDF_FONT_IMAGE_SIZE );
 	CHECK_POINTER( nodes, "Error allocating packing nodes" );
 
 	stbrp_context packContext;
-	stbrp_init_target( &packContext, WIDTH, HEIGHT, nodes, WIDTH );
-	stbrp_pack_rects( &packContext, rects, fontPackRange.num_chars );
+	stbrp_init_target( &packContext, SDF_FONT_IMAGE_SIZE, SDF_FONT_IMAGE_SIZE, nodes, SDF_FONT_IMAGE_SIZE );
+	stbrp_pack_rects( &packContext, outBuild->rects, outBuild->numRects );
+
+	// generate the images for each glyphs and place it in the appropriate spot in the master image, cleared so anything
+	//  not covered by a glyph is the same every time
+	outBuild->image = mem_Allocate( sizeof( unsigned char ) * SDF_FONT_IMAGE_SIZE * SDF_FONT_IMAGE_SIZE );
+	CHECK_POINTER( outBuild->image, "Error allocating full image" );
+	SDL_memset( outBuild->image, 0, sizeof( unsigned char ) * SDF_FONT_IMAGE_SIZE * SDF_FONT_IMAGE_SIZE );
+
+	SDFRenderJob job;
+	job.font = &( outBuild->font );
+	job.scale = outBuild->scale;
+	job.rects = outBuild->rects;
+	job.numRects = outBuild->numRects;
+	job.image = outBuild->image;
+	job.imageWidth = SDF_FONT_IMAGE_SIZE;
+	job.fileName = fileName;
+	if( !renderSDFGlyphs( &job, numWorkers, progress, progressData ) ) {
+		OUT_ERROR( "Unable to render glyphs" );
+	}
+
+	success = true;
+
+clean_up:
+	if( ioStream != NULL ) {
+		SDL_CloseIO( ioStream );
+	}
 	mem_Release( nodes );
-	nodes = NULL;
 
-	// generate the images for each glyphs and place it in the appropriate spot in the master image
-	baseImage = mem_Allocate( sizeof( unsigned char ) * WIDTH * HEIGHT );
-	CHECK_POINTER( baseImage, "Error allocating full image" );
+	if( !success ) {
+		cleanUpSDFFontBuild( outBuild );
+	}
 
-	for( int i = 0; i < fontPackRange.num_chars; ++i ) {
-		if( !rects[i].was_packed ) {
-			llog( LOG_WARN, "Unable to pack codepoint %i for font %s.", rects[i].id, fileName );
-			continue;
-		}
+	return success;
 
-		int sdfWidth, sdfHeight, sdfXOff, sdfYOff;
-		unsigned char* charSDF = stbtt_GetCodepointSDF( &font, scale, rects[i].id, padding, onEdgeValue, pixelDistScale, &sdfWidth, &sdfHeight, &sdfXOff, &sdfYOff );
-		if( charSDF == NULL ) {
-			continue;
-		}
+#undef CHECK_POINTER
+#undef OUT_ERROR
+}
 
-		//llog( LOG_INFO, "Packing codepoint %i - x: %i  y: %i  w: %i  h: %i  xo: %i  yo: %i", rects[i].id, rects[i].x, rects[i].y, sdfWidth, sdfHeight, sdfXOff, sdfYOff );
-		//if( rects[i].w != sdfWidth ) llog( LOG_WARN, "  - widths don't match!" );
-		//if( rects[i].h != sdfHeight ) llog( LOG_WARN, "  - heights don't match!" );
-
-		// pack into image
-		//  would really like a version of memcpy with stride
-		int x = rects[i].x;
-		for( int yo = 0; yo < rects[i].h; ++yo ) {
-			unsigned char* rowDest = baseImage + ( ( rects[i].x ) + ( ( rects[i].y + yo ) * WIDTH ) );//( ( y * WIDTH ) + x );
-			unsigned char* rowSrc = charSDF + ( yo * rects[i].w );
-			memcpy( rowDest, rowSrc, sizeof( unsigned char ) * rects[i].w );
-		}
-		STBTT_free( charSDF, 0 );
+// Creates a font that's rendered out as a signed distance field. Will also attempt to save a version of this font that
+//  can be loaded later much quicker.
+int txt_CreateSDFFont( const char* fileName )
+{
+	return txt_CreateSDFFontThreaded( fileName, MAX( jq_GetNumThreads( ), 1 ), NULL, NULL );
+}
+
+// Same as txt_CreateSDFFont( ), but the glyph rendering is split up between numWorkers jobs on the job queue.
+int txt_CreateSDFFontThreaded( const char* fileName, int numWorkers, SDFFontProgressFunc progress, void* progressData )
+{
+	ASSERT( textInitialized );
+	if( !textInitialized ) {
+		return 0;
 	}
 
+	// first try to load an existing sdf font, if it doesn't exist then create it
+	int newFont = loadSDFFont( fileName );
+	if( newFont != -1 ) {
+		return newFont;
+	}
+
+	SDFFontBuild build = { 0 };
+	Glyph* sbGlyphStorage = NULL;
+	Vector2* mins = NULL;
+	Vector2* maxes = NULL;
+	Vector2* offsets = NULL;
+	ImageID* retIDs = NULL;
+
+#define OUT_ERROR( s ) \
+	{ \
+		newFont = -1; \
+		llog( LOG_ERROR, "%s for font %s", (s), fileName ); \
+		goto clean_up; \
+	}
+
+#define CHECK_POINTER( p, s ) \
+	{ if( (p) == NULL ) OUT_ERROR( s ); }
+
+	// find an unused font ID
+	newFont = findUnusedFontID( );
+	if( newFont < 0 ) {
+		OUT_ERROR( "Unable to find empty font to use" );
+	}
+
+	if( !buildSDFFont( fileName, numWorkers, progress, progressData, &build ) ) {
+		OUT_ERROR( "Unable to generate sdf font" );
+	}
+
+	float scale = build.scale;
+	fonts[newFont].ascent = (float)build.ascent * scale;
+	fonts[newFont].descent = (float)build.descent * scale;
+	fonts[newFont].lineGap = (float)build.lineGap * scale;
+	fonts[newFont].nextLineDescent = fonts[newFont].ascent - fonts[newFont].descent + fonts[newFont].lineGap;
+	fonts[newFont].baseSize = SDF_FONT_PIXEL_HEIGHT;
+
 	// split the bitmap
-	mins = mem_Allocate( sizeof( Vector2 ) * fontPackRange.num_chars );
+	mins = mem_Allocate( sizeof( Vector2 ) * build.numRects );
 	CHECK_POINTER( mins, "Unable to allocate mins list" );
 
-	maxes = mem_Allocate( sizeof( Vector2 ) * fontPackRange.num_chars );
+	maxes = mem_Allocate( sizeof( Vector2 ) * build.numRects );
 	CHECK_POINTER( maxes, "Unable to allocate maxes list" );
 
-	offsets = mem_Allocate( sizeof( Vector2 ) * fontPackRange.num_chars );
+	offsets = mem_Allocate( sizeof( Vector2 ) * build.numRects );
 	CHECK_POINTER( offsets, "Unable to allocate offsets list" );
 
-	for( int i = 0; i < fontPackRange.num_chars; ++i ) {
+	stbrp_rect* rects = build.rects;
+	for( int i = 0; i < build.numRects; ++i ) {
 		mins[i].x = (float)rects[i].x;
 		mins[i].y = (float)rects[i].y;
 		maxes[i].x = (float)( rects[i].x + rects[i].w );
 		maxes[i].y = (float)( rects[i].y + rects[i].h );
 	}
-	retIDs = mem_Allocate( sizeof( int ) * fontPackRange.num_chars );
+	retIDs = mem_Allocate( sizeof( int ) * build.numRects );
 
-	fonts[newFont].packageID = img_SplitAlphaBitmap( baseImage, WIDTH, HEIGHT, fontPackRange.num_chars, ST_SIMPLE_SDF, mins, maxes, retIDs );
+	fonts[newFont].packageID = img_SplitAlphaBitmap( build.image, SDF_FONT_IMAGE_SIZE, SDF_FONT_IMAGE_SIZE, build.numRects, ST_SIMPLE_SDF, mins, maxes, retIDs );
 	if( fonts[newFont].packageID < 0 ) {
 		OUT_ERROR( "Unable to split images" );
 	}
 
 	// create the glyph storage then go through each glyph image and adjust the offset
-	sb_Add( sbGlyphStorage, fontPackRange.num_chars );
-	for( int i = 0; i < fontPackRange.num_chars; ++i ) {
+	sb_Add( sbGlyphStorage, build.numRects );
+	for( int i = 0; i < build.numRects; ++i ) {
 		if( !rects[i].was_packed ) {
 			// wasn't packed so we won't create a glyph for it
 			llog( LOG_WARN, "Glyph not packed. Not creating glyph for codepoint %i for font %s.", rects[i].id, fileName );
@@ -1424,7 +2535,7 @@ int txt_CreateSDFFont( const char* fileName )
 		}
 
 		int advance, lsb;
-		stbtt_GetCodepointHMetrics( &font, rects[i].id, &advance, &lsb);
+		stbtt_GetCodepointHMetrics( &( build.font ), rects[i].id, &advance, &lsb );
 
 		// because stbrp_pack_rects( ) conserves order we can treat these as parallel arrays
 		sbGlyphStorage[i].codepoint = rects[i].id;
@@ -1432,11 +2543,11 @@ int txt_CreateSDFFont( const char* fileName )
 		sbGlyphStorage[i].imageID = retIDs[i];
 
 		int ix0, iy0, ix1, iy1;
-		stbtt_GetCodepointBitmapBox( &font, rects[i].id, scale, scale, &ix0, &iy0, &ix1, &iy1 );
+		stbtt_GetCodepointBitmapBox( &( build.font ), rects[i].id, scale, scale, &ix0, &iy0, &ix1, &iy1 );
 
 		Vector2 offset;
-		offset.x = ( rects[i].w / 2.0f ) - padding;
-		offset.y = ( -rects[i].h / 2.0f ) + padding + iy1;
+		offset.x = ( rects[i].w / 2.0f ) - SDF_FONT_PADDING;
+		offset.y = ( -rects[i].h / 2.0f ) + SDF_FONT_PADDING + iy1;
 		img_SetOffset( retIDs[i], offset );
 		offsets[i] = offset; // used for saving
 
@@ -1448,29 +2559,25 @@ int txt_CreateSDFFont( const char* fileName )
 
 	// save out the font so next time we can load it faster
 	LoadedImage fontImg;
-	fontImg.width = WIDTH;
-	fontImg.height = HEIGHT;
+	fontImg.width = SDF_FONT_IMAGE_SIZE;
+	fontImg.height = SDF_FONT_IMAGE_SIZE;
 	fontImg.comp = 1;
-	fontImg.data = baseImage;
-	saveSDFFont( fileName, descent, lineGap, ascent, pixelHeight, sbGlyphStorage, mins, maxes, offsets, &fontImg );
+	fontImg.data = build.image;
+	saveSDFFont( fileName, build.descent, build.lineGap, build.ascent, SDF_FONT_PIXEL_HEIGHT, sbGlyphStorage, mins, maxes, offsets, &fontImg );
 
 	// now go through and scale everything
 	for( size_t i = 0; i < sb_Count( sbGlyphStorage ); ++i ) {
 		sbGlyphStorage[i].advance *= scale;
 	}
 
+	finishFontGlyphs( &( fonts[newFont] ) );
+
 clean_up:
 	mem_Release( offsets );
 	mem_Release( mins );
 	mem_Release( maxes );
 	mem_Release( retIDs );
-	mem_Release( baseImage );
-	mem_Release( buffer );
-	mem_Release( fontPackRange.chardata_for_range );
-	mem_Release( rects );
-	mem_Release( nodes );
-	fontPackRange.chardata_for_range = NULL;
-	fontPackRange.font_size = 0.0f;
+	cleanUpSDFFontBuild( &build );
 
 	if( newFont < 0 ) {
 		// creating font failed, release pre-allocated storage
@@ -1483,6 +2590,24 @@ clean_up:
 #undef OUT_ERROR
 }
 
+// Renders the image for an sdf font without creating the font or saving anything, for checking and timing the
+//  generation. The image is SDF_FONT_IMAGE_SIZE on each side and should be freed with mem_Release( ).
+uint8_t* txt_GenerateSDFFontImage( const char* fileName, int numWorkers, int* outWidth, int* outHeight )
+{
+	SDFFontBuild build;
+	if( !buildSDFFont( fileName, numWorkers, NULL, NULL, &build ) ) {
+		return NULL;
+	}
+
+	uint8_t* image = build.image;
+	build.image = NULL;
+	cleanUpSDFFontBuild( &build );
+
+	if( outWidth != NULL ) (*outWidth) = SDF_FONT_IMAGE_SIZE;
+	if( outHeight != NULL ) (*outHeight) = SDF_FONT_IMAGE_SIZE;
+	return image;
+}
+
 int txt_GetBaseSize( int fontID )
 {
 	ASSERT( fontID >= 0 );
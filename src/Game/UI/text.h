@@ -2,6 +2,8 @@
 #define TEXT_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "Graphics/color.h"
 #include "Math/vector2.h"
@@ -39,6 +41,17 @@ int txt_LoadFont( const char* fileName, int pixelHeight );
 //  Puts the resulting font ID into outFontID
 void txt_ThreadedLoadFont( const char* fileName, float pixelHeight, int* outFontID );
 
+// Loads the font at fileName as a dynamic font, instead of rendering a fixed set of characters up front the glyphs are
+//  rendered into a shared atlas the first time they're drawn. Use this for fonts with large character sets, memory and
+//  load time scale with the text actually displayed. Glyphs that haven't been drawn recently are evicted when the atlas
+//  is full. If useSDF is true the glyphs are rendered as signed distance fields.
+//  Returns an ID to be used when displaying a string, returns -1 if there was an issue.
+int txt_LoadDynamicFont( const char* fileName, int pixelHeight, bool useSDF );
+
+// Uploads any glyphs that were added to the glyph atlas, should be called once a frame after everything has been
+//  drawn but before rendering.
+void txt_FlushGlyphAtlas( void );
+
 // Frees up the font specified by fontID.
 void txt_UnloadFont( int fontID );
 
@@ -57,6 +70,33 @@ bool txt_DisplayTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vecto
 
 int txt_GetCharacterImage( int fontID, int c );
 
+// Cached versions of txt_DisplayString( ) and txt_DisplayTextArea( ). The glyph quads are created the first time a
+//  string is displayed with a specific font, size, alignment, and area, and are reused after that, so the only per
+//  frame cost is transforming the quads by tf. Use these for text that doesn't change often, text that changes every
+//  frame should go through the normal functions so it doesn't push everything else out of the cache. Layouts are evicted
+//  least recently used first when the cache goes over it's memory budget.
+//  For txt_DisplayCachedString( ) the base line starts at the origin of tf.
+void txt_DisplayCachedString( const uint8_t* utf8Str, const Matrix3* tf, Color clr, HorizTextAlignment hAlign, VertTextAlignment vAlign,
+	int fontID, uint32_t camFlags, int8_t depth, float desiredPixelSize );
+void txt_DisplayCachedTextArea( const uint8_t* utf8Str, const Matrix3* centerTf, Vector2 size, Color clr,
+	HorizTextAlignment hAlign, VertTextAlignment vAlign, int fontID, uint32_t camFlags, int8_t depth, float desiredPixelSize );
+
+typedef struct {
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t evictions;
+	uint32_t numLayouts;
+	size_t memoryUsed;
+	size_t memoryBudget;
+} TextLayoutCacheStats;
+
+// Sets the maximum amount of memory used by cached layouts, evicts layouts if we're already over it.
+void txt_SetLayoutCacheBudget( size_t bytes );
+void txt_ClearLayoutCache( void );
+void txt_GetLayoutCacheStats( TextLayoutCacheStats* outStats );
+// Resets the hits, misses, and evictions.
+void txt_ResetLayoutCacheStats( void );
+
 
 // Creates a font that's rendered out as a signed distance field. Will also attempt to save a version of this font that
 //  can be loaded later much quicker.
@@ -64,4 +104,17 @@ int txt_GetCharacterImage( int fontID, int c );
 //  can either use it non-SDF, or convert it to a TTF font.
 int txt_CreateSDFFont( const char* fileName );
 
+// Called as glyphs are rendered while generating an sdf font, always called on the thread that started the generation.
+typedef void (*SDFFontProgressFunc)( int glyphsDone, int totalGlyphs, void* userData );
+
+// Same as txt_CreateSDFFont( ), but the glyph rendering is split up between numWorkers jobs on the job queue, the
+//  calling thread waits and helps process jobs until they're done. The resulting font is the same no matter how many
+//  workers are used, so previously saved fonts are still valid. progress can be NULL. txt_CreateSDFFont( ) uses one
+//  worker per job queue thread.
+int txt_CreateSDFFontThreaded( const char* fileName, int numWorkers, SDFFontProgressFunc progress, void* userData );
+
+// Renders the image for an sdf font without creating the font or saving anything, for checking and timing the
+//  generation. Returns NULL on failure, the image is single channel and should be freed with mem_Release( ).
+uint8_t* txt_GenerateSDFFontImage( const char* fileName, int numWorkers, int* outWidth, int* outHeight );
+
 #endif // inclusion guard
\ No newline at end of file
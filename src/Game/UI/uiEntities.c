@@ -32,6 +32,7 @@ EntityID createLabel( ECPS* ecps, const char* utf8Str, Vector2 position, Color f
 	textData.pixelSize = fontPixelSize;
 	textData.text = (uint8_t*)createStringCopy( utf8Str );
 	textData.textIsDynamic = true;
+	textData.cacheLayout = true;
 	textData.horizAlign = hAlign;
 	textData.vertAlign = vAlign;
 	textData.useTextArea = useTextArea;
@@ -110,6 +111,7 @@ EntityID button_CreateImageButton( ECPS* ecps, Vector2 position, Vector2 normalS
 		textData.pixelSize = fontPixelSize;
 		textData.text = (uint8_t*)createStringCopy( text );
 		textData.textIsDynamic = true;
+		textData.cacheLayout = true;
 		textData.horizAlign = HORIZ_ALIGN_CENTER;
 		textData.vertAlign = VERT_ALIGN_CENTER;
 
@@ -186,6 +188,7 @@ static EntityID create3x3Button( ECPS* ecps, Vector2 position, Vector2 size,
 		textData.pixelSize = fontPixelSize;
 		textData.text = (uint8_t*)createStringCopy( text );
 		textData.textIsDynamic = true;
+		textData.cacheLayout = true;
 		textData.horizAlign = HORIZ_ALIGN_CENTER;
 		textData.vertAlign = VERT_ALIGN_CENTER;
 
@@ -288,6 +291,7 @@ EntityID button_CreateTextButton( ECPS* ecps, Vector2 position, Vector2 size,
 	textData.pixelSize = fontPixelSize;
 	textData.text = (uint8_t*)createStringCopy( text );
 	textData.textIsDynamic = true;
+	textData.cacheLayout = true;
 	textData.horizAlign = HORIZ_ALIGN_CENTER;
 	textData.vertAlign = VERT_ALIGN_CENTER;
 
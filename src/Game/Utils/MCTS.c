@@ -1,29 +1,43 @@
 #include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
 #include <math.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
+#include "Math/mathUtil.h"
 #include "Utils/stretchyBuffer.h"
 #include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
 #include "System/random.h"
 
 // Implementation of the Monte Carlo Search Tree algorithm
 //  Before inclusion of this file you'll need to #define a few things:
 //   #define MAX_PLAYERS # => how many players the game can handle at once, defaults to 2
 //   #define MTSC_MOVE typeName => a type defining the moves that a game can make, defaults to int
+//                             moves are compared with memcmp( ), so any padding in them should be zeroed
 //   #define MTCS_BOARD_STATE typeName => a type defining the state of the game's board, defaults to int
 //   #define MCTS_MAX_ROLL_OUT_DEPTH # => how far the roll out will go before stopping, defaults to 512
 //   #define MCTS_MAX_STEPS # => how many simulation steps will be run, defaults to 1000
 //   #define MCTS_OPEN_LOOP => use an open loop variation of the MCTS, only stores the actions and not the states which are regenerated
 //                             every time it needs to be accessed, use with stochastic games, is more processor intensive but uses less memory
+//   #define MCTS_MAX_NODES # => size of the node pool monteCarloTreeSearch( ) uses, the tree stops growing when it's used up, defaults to MCTS_MAX_STEPS * 8
+//   #define MCTS_HASH_STATE( statePtr ) => function returning a uint64_t hash of a board state, turns on sharing scores between nodes
+//                                           that reach the same state through different moves, can't be used with MCTS_OPEN_LOOP
+//   #define MCTS_MAX_PARALLEL_NODES # => how many nodes the parallel search can create, split between the trees, defaults to MCTS_MAX_NODES
+//   #define MCTS_VIRTUAL_LOSS # => how many losses a worker adds to each node it passes through with the parallel tree search, defaults to 1
 //  Once included this will create the MCTS implementation. Note that all functions here are
 //   static, so they won't be accessible outside where they're defined. This allows you to
 //   have multiple implementations of this if necessary. This is done because C doesn't
 //   support templates.
 
 // TODO: Improvements
-//  store the tree between runs, that way we can grow the tree out as play continues, also prune the tree for branches that aren't taken
-//  improve caching of game states to avoid redudant stored states, doing this may also help reduce some of the issues with the interface
-//  abstract out the test to see if it's done so we can base it on time, number of iterations, or any other desired condition
+//  # store the tree between runs, done with mcts_Create( ) and mcts_AdvanceRoot( )
+//  # improve caching of game states to avoid redudant stored states, done with MCTS_HASH_STATE for closed loop searches
+//  abstract out the test to see if it's done, mcts_Search( ) handles time and number of steps but nothing else yet
 //  # improve the interface for this, having it included with the defines works, but it's messy
 //    - for this what can we do?
 //       values we're currently defining can be stored in a structure
@@ -31,7 +45,6 @@
 //        we're not assuming the number of players or what order their turns can go in)
 //     the move, state, and number of players won't work with storing this because they also modify the definition of structures used
 //     with just straight C i'm not Cing a way to do this, so we'll just leave that be for right now
-//  improve multi-threading so we can have multiple threads working on the same tree, possibly divide it into some task based thing
 
 #ifndef MCTS_MOVE
 #define MCTS_MOVE int
@@ -53,6 +66,18 @@
 #define MCTS_MAX_STEPS 1000
 #endif
 
+#ifndef MCTS_MAX_NODES
+#define MCTS_MAX_NODES ( MCTS_MAX_STEPS * 8 )
+#endif
+
+#ifndef MCTS_MAX_PARALLEL_NODES
+#define MCTS_MAX_PARALLEL_NODES MCTS_MAX_NODES
+#endif
+
+#ifndef MCTS_VIRTUAL_LOSS
+#define MCTS_VIRTUAL_LOSS 1
+#endif
+
 #ifndef MCTS_DEFAULT_SEARCH_CONSTANT
 #define MCTS_DEFAULT_SEARCH_CONSTANT 1.4142135637f
 #endif
@@ -81,16 +106,28 @@ typedef struct {
 
 	size_t parent;
 	size_t firstChild;
-	size_t nextSibling;
+	size_t nextSibling; // also used to link together the free nodes in the pool
 
 	MCTS_MOVE causingMove; // the move that will result in the parent state moving to this state
 #ifndef MCTS_OPEN_LOOP
 	MCTS_BOARD_STATE state;
 #endif
+#ifdef MCTS_HASH_STATE
+	uint64_t hash;
+	size_t statsNode; // the node holding the scores for this state, all the nodes with the same state share them
+#endif
+	bool inUse;
 } MCTreeNode;
 
 typedef struct {
-	MCTreeNode* sbNodes;
+	// the nodes come from a pool that's allocated when the tree is created so growing the tree never touches the heap,
+	//  if the pool runs out the tree stops growing and the search carries on with roll outs from the leaves
+	MCTreeNode* nodes;
+	size_t capacity;
+	size_t numUsed; // nodes past this have never been handed out
+	size_t firstFree; // released nodes, linked through nextSibling
+	size_t numFree;
+
 	size_t rootNode;
 	MCTSGameDefinition* gameDefinition;
 	float searchConstant;
@@ -99,103 +136,316 @@ typedef struct {
 	MCTS_BOARD_STATE initialState;
 #endif
 
+	MCTS_MOVE* sbMoves; // so we don't have to reallocate every single time we expand or roll out
+	size_t* sbReleased;
+
+#ifdef MCTS_HASH_STATE
+	size_t* transpositions; // open addressing table of the nodes holding the scores for each state
+	size_t transpositionMask;
+	size_t* sbKept;
+#endif
 } MCTree;
 
 static void SDL_assertTree( MCTree* tree )
 {
 	ASSERT( tree != NULL );
 
-	size_t cnt = sb_Count( tree->sbNodes );
-	size_t invalid = INVALID_NODE;
-	for( size_t i = 0; i < sb_Count( tree->sbNodes ); ++i ) {
-		ASSERT( ( tree->sbNodes[i].parent < sb_Count( tree->sbNodes ) ) || ( ( tree->sbNodes[i].parent == INVALID_NODE ) && ( i == 0 ) ) );
-		ASSERT( ( tree->sbNodes[i].firstChild < sb_Count( tree->sbNodes ) ) || ( tree->sbNodes[i].firstChild == INVALID_NODE ) );
-		ASSERT( ( tree->sbNodes[i].nextSibling < sb_Count( tree->sbNodes ) ) || ( tree->sbNodes[i].nextSibling == INVALID_NODE ) );
+	for( size_t i = 0; i < tree->numUsed; ++i ) {
+		if( !tree->nodes[i].inUse ) continue;
+		ASSERT( ( tree->nodes[i].parent < tree->numUsed ) || ( ( tree->nodes[i].parent == INVALID_NODE ) && ( i == tree->rootNode ) ) );
+		ASSERT( ( tree->nodes[i].firstChild < tree->numUsed ) || ( tree->nodes[i].firstChild == INVALID_NODE ) );
+		ASSERT( ( tree->nodes[i].nextSibling < tree->numUsed ) || ( tree->nodes[i].nextSibling == INVALID_NODE ) );
 	}
 }
 
+// the node the scores for idx are stored in
+static MCTreeNode* nodeStats( MCTree* tree, size_t idx )
+{
+#ifdef MCTS_HASH_STATE
+	return &( tree->nodes[tree->nodes[idx].statsNode] );
+#else
+	return &( tree->nodes[idx] );
+#endif
+}
+
+static size_t numFreeNodes( MCTree* tree )
+{
+	return ( tree->capacity - tree->numUsed ) + tree->numFree;
+}
+
+static size_t allocNode( MCTree* tree )
+{
+	size_t idx = INVALID_NODE;
+	if( tree->firstFree != INVALID_NODE ) {
+		idx = tree->firstFree;
+		tree->firstFree = tree->nodes[idx].nextSibling;
+		--tree->numFree;
+	} else if( tree->numUsed < tree->capacity ) {
+		idx = tree->numUsed;
+		++tree->numUsed;
+	}
+	return idx;
+}
+
+static void releaseNode( MCTree* tree, size_t idx )
+{
+	tree->nodes[idx].inUse = false;
+	tree->nodes[idx].nextSibling = tree->firstFree;
+	tree->firstFree = idx;
+	++tree->numFree;
+}
+
 static void initNode( MCTree* tree, size_t idx )
 {
 	ASSERT( tree != NULL );
 
-	tree->sbNodes[idx].evalCnt = 0;
+	tree->nodes[idx].evalCnt = 0;
 	for( int s = 0; s < MCTS_NUM_PLAYERS; ++s ) {
-		tree->sbNodes[idx].scores[s] = 0.0f;
+		tree->nodes[idx].scores[s] = 0.0f;
+	}
+
+	tree->nodes[idx].firstChild = INVALID_NODE;
+	tree->nodes[idx].nextSibling = INVALID_NODE;
+	tree->nodes[idx].parent = INVALID_NODE;
+	tree->nodes[idx].inUse = true;
+#ifdef MCTS_HASH_STATE
+	tree->nodes[idx].statsNode = idx;
+#endif
+}
+
+#ifdef MCTS_HASH_STATE
+#ifdef MCTS_OPEN_LOOP
+#error "MCTS_HASH_STATE needs the states stored in the tree, it can't be used with MCTS_OPEN_LOOP"
+#endif
+
+static size_t findTransposition( MCTree* tree, uint64_t hash, MCTS_BOARD_STATE* state )
+{
+	size_t slot = (size_t)hash & tree->transpositionMask;
+	while( tree->transpositions[slot] != INVALID_NODE ) {
+		MCTreeNode* node = &( tree->nodes[tree->transpositions[slot]] );
+		if( ( node->hash == hash ) && ( memcmp( &( node->state ), state, sizeof( MCTS_BOARD_STATE ) ) == 0 ) ) {
+			return tree->transpositions[slot];
+		}
+		slot = ( slot + 1 ) & tree->transpositionMask;
+	}
+	return INVALID_NODE;
+}
+
+// the table has at least twice as many slots as there are nodes so there's always an empty one
+static void addTransposition( MCTree* tree, size_t idx )
+{
+	size_t slot = (size_t)tree->nodes[idx].hash & tree->transpositionMask;
+	while( tree->transpositions[slot] != INVALID_NODE ) {
+		slot = ( slot + 1 ) & tree->transpositionMask;
+	}
+	tree->transpositions[slot] = idx;
+}
+
+static void clearTranspositions( MCTree* tree )
+{
+	memset( tree->transpositions, 0xFF, sizeof( size_t ) * ( tree->transpositionMask + 1 ) );
+}
+
+// shares the scores of any node already in the tree with the same state
+static void linkTransposition( MCTree* tree, size_t idx )
+{
+	MCTreeNode* node = &( tree->nodes[idx] );
+	node->hash = MCTS_HASH_STATE( &( node->state ) );
+	size_t existing = findTransposition( tree, node->hash, &( node->state ) );
+	if( existing != INVALID_NODE ) {
+		node->statsNode = existing;
+	} else {
+		node->statsNode = idx;
+		addTransposition( tree, idx );
+	}
+}
+
+// after nodes have been released the ones that are left may be sharing scores with a node that's gone, the first of
+//  those takes over the scores and the rest share with it
+static void rebuildTranspositions( MCTree* tree )
+{
+	clearTranspositions( tree );
+
+	sb_Clear( tree->sbKept );
+	sb_Push( tree->sbKept, tree->rootNode );
+	for( size_t i = 0; i < sb_Count( tree->sbKept ); ++i ) {
+		size_t idx = tree->sbKept[i];
+		if( tree->nodes[idx].statsNode == idx ) {
+			addTransposition( tree, idx );
+		}
+		for( size_t child = tree->nodes[idx].firstChild; child != INVALID_NODE; child = tree->nodes[child].nextSibling ) {
+			sb_Push( tree->sbKept, child );
+		}
 	}
 
-	tree->sbNodes[idx].firstChild = INVALID_NODE;
-	tree->sbNodes[idx].nextSibling = INVALID_NODE;
-	tree->sbNodes[idx].parent = INVALID_NODE;
+	for( size_t i = 0; i < sb_Count( tree->sbKept ); ++i ) {
+		MCTreeNode* node = &( tree->nodes[tree->sbKept[i]] );
+		if( tree->nodes[node->statsNode].inUse ) continue;
+
+		size_t existing = findTransposition( tree, node->hash, &( node->state ) );
+		if( existing != INVALID_NODE ) {
+			node->statsNode = existing;
+		} else {
+			MCTreeNode* oldStats = &( tree->nodes[node->statsNode] );
+			memcpy( node->scores, oldStats->scores, sizeof( node->scores ) );
+			node->evalCnt = oldStats->evalCnt;
+			node->statsNode = tree->sbKept[i];
+			addTransposition( tree, tree->sbKept[i] );
+		}
+	}
 }
+#endif
 
 static void setChild( MCTree* tree, size_t parentIdx, size_t childIdx )
 {
 	ASSERT( parentIdx != childIdx );
-	ASSERT( parentIdx < sb_Count( tree->sbNodes ) );
-	ASSERT( childIdx < sb_Count( tree->sbNodes ) );
+	ASSERT( parentIdx < tree->numUsed );
+	ASSERT( childIdx < tree->numUsed );
 
-	tree->sbNodes[childIdx].parent = parentIdx;
+	tree->nodes[childIdx].parent = parentIdx;
 
-	if( tree->sbNodes[parentIdx].firstChild == INVALID_NODE ) {
-		tree->sbNodes[parentIdx].firstChild = childIdx;
+	if( tree->nodes[parentIdx].firstChild == INVALID_NODE ) {
+		tree->nodes[parentIdx].firstChild = childIdx;
 	} else {
-		size_t lastChild = tree->sbNodes[parentIdx].firstChild;
-		while( tree->sbNodes[lastChild].nextSibling != INVALID_NODE ) {
-			lastChild = tree->sbNodes[lastChild].nextSibling;
+		size_t lastChild = tree->nodes[parentIdx].firstChild;
+		while( tree->nodes[lastChild].nextSibling != INVALID_NODE ) {
+			lastChild = tree->nodes[lastChild].nextSibling;
 		}
-		tree->sbNodes[lastChild].nextSibling = childIdx;
+		tree->nodes[lastChild].nextSibling = childIdx;
 	}
 
-	tree->sbNodes[childIdx].nextSibling = INVALID_NODE;
+	tree->nodes[childIdx].nextSibling = INVALID_NODE;
 
 	//SDL_assertTree( tree );
 }
 
+// returns false if the pool is out of nodes
 #ifdef MCTS_OPEN_LOOP
-static void addChild( MCTree* tree, size_t parentIdx, MCTS_MOVE* causingMove )
+static bool addChild( MCTree* tree, size_t parentIdx, MCTS_MOVE* causingMove )
 #else
-static void addChild( MCTree* tree, size_t parentIdx, MCTS_BOARD_STATE* state, MCTS_MOVE* causingMove )
+static bool addChild( MCTree* tree, size_t parentIdx, MCTS_BOARD_STATE* state, MCTS_MOVE* causingMove )
 #endif
 {
-	sb_Add( tree->sbNodes, 1 );
-	size_t ni = ( sb_Count( tree->sbNodes ) - 1 );
+	size_t ni = allocNode( tree );
+	if( ni == INVALID_NODE ) {
+		return false;
+	}
 	initNode( tree, ni );
 	setChild( tree, parentIdx, ni );
 
 #ifndef MCTS_OPEN_LOOP
-	tree->sbNodes[ni].state = ( *state );
+	tree->nodes[ni].state = ( *state );
+#endif
+	tree->nodes[ni].causingMove = ( *causingMove );
+#ifdef MCTS_HASH_STATE
+	linkTransposition( tree, ni );
 #endif
-	tree->sbNodes[ni].causingMove = ( *causingMove );
+
+	return true;
 }
 
 // we're assuming if two moves are the same they have the same result
 static bool hasChildWithMove( MCTree* tree, size_t parentIdx, MCTS_MOVE* causingMove )
 {
-	size_t childIdx = tree->sbNodes[parentIdx].firstChild;
+	size_t childIdx = tree->nodes[parentIdx].firstChild;
 	while( childIdx != INVALID_NODE ) {
-		if( memcmp( &( tree->sbNodes[childIdx].causingMove ), causingMove, sizeof( MCTS_MOVE ) ) == 0 ) {
+		if( memcmp( &( tree->nodes[childIdx].causingMove ), causingMove, sizeof( MCTS_MOVE ) ) == 0 ) {
 			return true;
 		}
-		childIdx = tree->sbNodes[childIdx].nextSibling;
+		childIdx = tree->nodes[childIdx].nextSibling;
 	}
 
 	return false;
 }
 
-static void mcts_Init( MCTree* tree, MCTSGameDefinition* gameDefinition, MCTS_BOARD_STATE* initialState )
+#ifdef MCTS_OPEN_LOOP
+// a node can be reached with different random results, so the moves from it can change between visits, the ones
+//  possible this time are in sbMoves
+static bool isPossibleMove( MCTree* tree, MCTS_MOVE* move )
 {
-	sb_Clear( tree->sbNodes );
-	sb_Reserve( tree->sbNodes, 10000 );
+	for( size_t i = 0; i < sb_Count( tree->sbMoves ); ++i ) {
+		if( memcmp( &( tree->sbMoves[i] ), move, sizeof( MCTS_MOVE ) ) == 0 ) {
+			return true;
+		}
+	}
+	return false;
+}
+#endif
 
-	sb_Add( tree->sbNodes, 1 );
-	initNode( tree, 0 );
+// throws away the whole tree and starts over from the state
+static void mcts_Reset( MCTree* tree, MCTS_BOARD_STATE* state )
+{
+	ASSERT( tree != NULL );
+	ASSERT( state != NULL );
+
+	tree->numUsed = 0;
+	tree->firstFree = INVALID_NODE;
+	tree->numFree = 0;
+#ifdef MCTS_HASH_STATE
+	clearTranspositions( tree );
+#endif
+
+	tree->rootNode = allocNode( tree );
+	initNode( tree, tree->rootNode );
 #ifdef MCTS_OPEN_LOOP
-	memcpy( &( tree->initialState ), initialState, sizeof( MCTS_BOARD_STATE ) );
+	memcpy( &( tree->initialState ), state, sizeof( MCTS_BOARD_STATE ) );
 #else
-	memcpy( &( tree->sbNodes[0].state ), initialState, sizeof( MCTS_BOARD_STATE ) );
+	memcpy( &( tree->nodes[tree->rootNode].state ), state, sizeof( MCTS_BOARD_STATE ) );
+#endif
+#ifdef MCTS_HASH_STATE
+	linkTransposition( tree, tree->rootNode );
 #endif
-	tree->rootNode = 0;
+}
+
+// maxNodes is the size of the pool, the game definition has to stay valid as long as the tree is used
+static bool mcts_Create( MCTree* tree, MCTSGameDefinition* gameDefinition, float searchConstant, size_t maxNodes, MCTS_BOARD_STATE* initialState )
+{
+	ASSERT( tree != NULL );
+	ASSERT( gameDefinition != NULL );
+	ASSERT( maxNodes > 0 );
+
+	memset( tree, 0, sizeof( MCTree ) );
 	tree->gameDefinition = gameDefinition;
+	tree->searchConstant = searchConstant;
+
+	tree->nodes = mem_Allocate( sizeof( MCTreeNode ) * maxNodes );
+	if( tree->nodes == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate node pool for tree search." );
+		return false;
+	}
+	tree->capacity = maxNodes;
+
+#ifdef MCTS_HASH_STATE
+	size_t tableSize = 1;
+	while( tableSize < ( maxNodes * 2 ) ) {
+		tableSize *= 2;
+	}
+	tree->transpositions = mem_Allocate( sizeof( size_t ) * tableSize );
+	if( tree->transpositions == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate transposition table for tree search." );
+		mem_Release( tree->nodes );
+		tree->nodes = NULL;
+		return false;
+	}
+	tree->transpositionMask = tableSize - 1;
+#endif
+
+	mcts_Reset( tree, initialState );
+	return true;
+}
+
+static void mcts_Destroy( MCTree* tree )
+{
+	ASSERT( tree != NULL );
+
+	mem_Release( tree->nodes );
+	sb_Release( tree->sbMoves );
+	sb_Release( tree->sbReleased );
+#ifdef MCTS_HASH_STATE
+	mem_Release( tree->transpositions );
+	sb_Release( tree->sbKept );
+#endif
+	memset( tree, 0, sizeof( MCTree ) );
 }
 
 // We expand all the actions into child nodes
@@ -204,35 +454,36 @@ static void mcts_Expand( MCTree* tree, size_t idx, MCTS_BOARD_STATE* idxState )
 {
 	ASSERT( tree != NULL );
 
-	MCTS_MOVE* moves = NULL;
-	tree->gameDefinition->getPossibleMoveList( idxState, &moves );
+	sb_Clear( tree->sbMoves );
+	tree->gameDefinition->getPossibleMoveList( idxState, &( tree->sbMoves ) );
 
-	for( size_t i = 0; i < sb_Count( moves ); ++i ) {
+	for( size_t i = 0; i < sb_Count( tree->sbMoves ); ++i ) {
 		// see if the move already exists in this nodes children, if not then add it
-		if( !hasChildWithMove( tree, idx, &( moves[i] ) ) ) {
-			addChild( tree, idx, &( moves[i] ) );
+		if( !hasChildWithMove( tree, idx, &( tree->sbMoves[i] ) ) ) {
+			if( !addChild( tree, idx, &( tree->sbMoves[i] ) ) ) break;
 		}
 		//SDL_assertTree( tree );
 	}
-
-	sb_Release( moves );
 }
 #else
 static void mcts_Expand( MCTree* tree, size_t idx )
 {
 	ASSERT( tree != NULL );
 
-	MCTS_MOVE* moves = NULL;
-	tree->gameDefinition->getPossibleMoveList( &( tree->sbNodes[idx].state ), &moves );
+	sb_Clear( tree->sbMoves );
+	tree->gameDefinition->getPossibleMoveList( &( tree->nodes[idx].state ), &( tree->sbMoves ) );
+
+	// all or nothing, a node that's been expanded is never looked at again
+	if( numFreeNodes( tree ) < sb_Count( tree->sbMoves ) ) {
+		return;
+	}
 
-	for( size_t i = 0; i < sb_Count( moves ); ++i ) {
+	for( size_t i = 0; i < sb_Count( tree->sbMoves ); ++i ) {
 		MCTS_BOARD_STATE newState;
-		tree->gameDefinition->applyMove( &( tree->sbNodes[idx].state ), &( moves[i] ), &newState );
-		addChild( tree, idx, &newState, &( moves[i] ) );
+		tree->gameDefinition->applyMove( &( tree->nodes[idx].state ), &( tree->sbMoves[i] ), &newState );
+		addChild( tree, idx, &newState, &( tree->sbMoves[i] ) );
 		//SDL_assertTree( tree );
 	}
-
-	sb_Release( moves );
 }
 #endif
 
@@ -244,6 +495,8 @@ static void mcts_Expand( MCTree* tree, size_t idx )
 // n = number of times parent of node to check has been evaluated
 // j = number of times the node to check has been evaluated
 // if j = 0, then UCB1 = infinity
+// in open loop searches only the children possible from idxState are looked at, expects tree->sbMoves to be filled in by
+//  mcts_Expand( ), returns INVALID_NODE if there aren't any
 #ifdef MCTS_OPEN_LOOP
 static size_t mtcs_BestChild( MCTree* tree, size_t idx, MCTS_BOARD_STATE* idxState, MCTS_BOARD_STATE* outState )
 #else
@@ -257,21 +510,29 @@ static size_t mtcs_BestChild( MCTree* tree, size_t idx )
 	int numFound = 0;
 	size_t best = INVALID_NODE;
 	float bestScore = 0.0f;
-	size_t curr = tree->sbNodes[idx].firstChild;
-	float logCnt = logf( tree->sbNodes[idx].evalCnt );
+	size_t curr = tree->nodes[idx].firstChild;
+	float logCnt = logf( nodeStats( tree, idx )->evalCnt );
 #ifdef MCTS_OPEN_LOOP
 	unsigned int currPlayer = tree->gameDefinition->getCurrentPlayer( idxState ); // get the move that led to this
 #else
-	unsigned int currPlayer = tree->gameDefinition->getCurrentPlayer( &( tree->sbNodes[idx].state ) ); // get the move that led to this
+	unsigned int currPlayer = tree->gameDefinition->getCurrentPlayer( &( tree->nodes[idx].state ) ); // get the move that led to this
 #endif
 
 	while( curr != INVALID_NODE ) {
+#ifdef MCTS_OPEN_LOOP
+		if( !isPossibleMove( tree, &( tree->nodes[curr].causingMove ) ) ) {
+			curr = tree->nodes[curr].nextSibling;
+			continue;
+		}
+#endif
+
 		// if the node to check has never been evaluated then it's score is infinity, otherwise use UCB1
 		float uctValue = INFINITY;
 
-		if( tree->sbNodes[curr].evalCnt > 0.0f ) {
-			uctValue = ( tree->sbNodes[curr].scores[currPlayer] / tree->sbNodes[curr].evalCnt ) +
-				( tree->searchConstant * sqrtf( logCnt / tree->sbNodes[curr].evalCnt ) );
+		MCTreeNode* stats = nodeStats( tree, curr );
+		if( stats->evalCnt > 0.0f ) {
+			uctValue = ( stats->scores[currPlayer] / stats->evalCnt ) +
+				( tree->searchConstant * sqrtf( logCnt / stats->evalCnt ) );
 		}
 
 		if( ( uctValue > bestScore ) || ( best == INVALID_NODE ) ) {
@@ -287,11 +548,15 @@ static size_t mtcs_BestChild( MCTree* tree, size_t idx )
 			}
 		}
 
-		curr = tree->sbNodes[curr].nextSibling;
+		curr = tree->nodes[curr].nextSibling;
 	}
 #ifdef MCTS_OPEN_LOOP
+	if( best == INVALID_NODE ) {
+		return INVALID_NODE;
+	}
+
 	MCTS_BOARD_STATE newState;
-	tree->gameDefinition->applyMove( idxState, &( tree->sbNodes[best].causingMove ), &newState );
+	tree->gameDefinition->applyMove( idxState, &( tree->nodes[best].causingMove ), &newState );
 	( *outState ) = newState;
 #endif
 
@@ -316,11 +581,16 @@ static size_t mcts_TreePolicy( MCTree* tree )
 #endif
 
 	size_t idx = tree->rootNode;
-	while( tree->sbNodes[idx].firstChild != INVALID_NODE ) {
+	while( tree->nodes[idx].firstChild != INVALID_NODE ) {
 		
 #ifdef MCTS_OPEN_LOOP
 		mcts_Expand( tree, idx, outState );
-		idx = mtcs_BestChild( tree, idx, outState, outState );
+		size_t child = mtcs_BestChild( tree, idx, outState, outState );
+		if( child == INVALID_NODE ) {
+			// none of the children are possible and there wasn't room to add any that are, run from here
+			return idx;
+		}
+		idx = child;
 #else
 		idx = mtcs_BestChild( tree, idx );
 #endif
@@ -330,19 +600,24 @@ static size_t mcts_TreePolicy( MCTree* tree )
 #ifdef MCTS_OPEN_LOOP
 	currState = outState;
 #else
-	currState = &( tree->sbNodes[idx].state );
+	currState = &( tree->nodes[idx].state );
 #endif
 	// got a leaf
-	if( ( tree->sbNodes[idx].evalCnt > 0.0f ) && ( tree->gameDefinition->getWinner( currState ) < 0 ) ) {
-		// has been visited and is not a terminal node in the tree, expand
+	if( ( nodeStats( tree, idx )->evalCnt > 0.0f ) && ( tree->gameDefinition->getWinner( currState ) < 0 ) ) {
+		// has been visited and is not a terminal node in the tree, expand, if the pool is empty we run from here
 #ifdef MCTS_OPEN_LOOP
 		mcts_Expand( tree, idx, outState );
-		idx = mtcs_BestChild( tree, idx, outState, outState );
-		currState = outState;
+		if( tree->nodes[idx].firstChild != INVALID_NODE ) {
+			size_t child = mtcs_BestChild( tree, idx, outState, outState );
+			if( child != INVALID_NODE ) {
+				idx = child;
+			}
+		}
 #else
 		mcts_Expand( tree, idx );
-		idx = mtcs_BestChild( tree, idx );
-		currState = &( tree->sbNodes[idx].state );
+		if( tree->nodes[idx].firstChild != INVALID_NODE ) {
+			idx = mtcs_BestChild( tree, idx );
+		}
 #endif
 	}
 
@@ -351,10 +626,9 @@ static size_t mcts_TreePolicy( MCTree* tree )
 
 // Choose random moves to advance the state until we reach a terminal state or we've gone
 //  on for too long.
-static MCTS_MOVE* sbRolloutMoves = NULL; // so we don't have to reallocate every single time we run this
 static int minDepth = MCTS_MAX_ROLL_OUT_DEPTH;
 static int maxDepth = -1;
-static void mcts_RollOut( MCTSGameDefinition* gameDefinition, MCTS_BOARD_STATE* state, float* outScore, int* outScoresIdx )
+static void mcts_RollOut( MCTSGameDefinition* gameDefinition, MCTS_BOARD_STATE* state, RandomGroup* rg, MCTS_MOVE** sbMoves, float* outScore, int* outScoresIdx )
 {
 	MCTS_BOARD_STATE nextState;
 	MCTS_BOARD_STATE currState = ( *state );
@@ -363,10 +637,10 @@ static void mcts_RollOut( MCTSGameDefinition* gameDefinition, MCTS_BOARD_STATE*
 
 	winner = gameDefinition->getWinner( &currState );
 	while( ( depth < MCTS_MAX_ROLL_OUT_DEPTH ) && ( winner == -1 ) ) {
-		sb_Clear( sbRolloutMoves );
-		gameDefinition->getPossibleMoveList( &currState, &sbRolloutMoves );
-		ASSERT( sb_Count( sbRolloutMoves ) > 0 );
-		gameDefinition->applyMove( &currState, &( sbRolloutMoves[rand_GetArrayEntry( &mctsRandom, sb_Count( sbRolloutMoves ) )] ), &nextState );
+		sb_Clear( *sbMoves );
+		gameDefinition->getPossibleMoveList( &currState, sbMoves );
+		ASSERT( sb_Count( *sbMoves ) > 0 );
+		gameDefinition->applyMove( &currState, &( ( *sbMoves )[rand_GetArrayEntry( rg, sb_Count( *sbMoves ) )] ), &nextState );
 		currState = nextState;
 		winner = gameDefinition->getWinner( &currState );
 		++depth;
@@ -390,17 +664,18 @@ static void mcts_BackPropagate( MCTree* tree, size_t idx, int playerIdx, float s
 	ASSERT( tree != NULL );
 
 	while( idx != INVALID_NODE ) {
+		MCTreeNode* stats = nodeStats( tree, idx );
 		for( int i = 0; i < MCTS_NUM_PLAYERS; ++i ) {
 			if( i == playerIdx ) {
-				tree->sbNodes[idx].scores[i] += score;
+				stats->scores[i] += score;
 			} else if( playerIdx < 0 ) {
 				// handle ties
-				tree->sbNodes[idx].scores[i] += score * 0.5f;
+				stats->scores[i] += score * 0.5f;
 			}
 		}
-		tree->sbNodes[idx].evalCnt += 1.0f;
+		stats->evalCnt += 1.0f;
 
-		idx = tree->sbNodes[idx].parent;
+		idx = tree->nodes[idx].parent;
 	}
 }
 
@@ -417,18 +692,116 @@ static void mcts_Step( MCTree* tree )
 #ifdef MCTS_OPEN_LOOP
 	MCTS_BOARD_STATE state;
 	size_t idx = mcts_TreePolicy( tree, &state );
-	mcts_RollOut( tree->gameDefinition, &state, &score, &player );
+	mcts_RollOut( tree->gameDefinition, &state, &mctsRandom, &( tree->sbMoves ), &score, &player );
 	mcts_BackPropagate( tree, idx, player, score );
 #else
 	size_t idx = mcts_TreePolicy( tree );
-	mcts_RollOut( tree->gameDefinition, &( tree->sbNodes[idx].state ), &score, &player );
+	mcts_RollOut( tree->gameDefinition, &( tree->nodes[idx].state ), &mctsRandom, &( tree->sbMoves ), &score, &player );
 	mcts_BackPropagate( tree, idx, player, score );
 #endif
 }
 
 static float mcts_Best_ByEvalCount( MCTree* tree, size_t nodeIdx )
 {
-	return tree->sbNodes[nodeIdx].evalCnt;
+	return nodeStats( tree, nodeIdx )->evalCnt;
+}
+
+// moves the root of the tree to the node for the move, keeping everything that's been searched below it and releasing
+//  the rest, call this for every move made in the game so the tree follows along. If the move hasn't been searched, or
+//  it had a random result that doesn't match the searched one, the tree starts over from newState.
+static void mcts_AdvanceRoot( MCTree* tree, MCTS_MOVE* move, MCTS_BOARD_STATE* newState )
+{
+	ASSERT( tree != NULL );
+	ASSERT( move != NULL );
+	ASSERT( newState != NULL );
+
+	size_t newRoot = INVALID_NODE;
+	for( size_t child = tree->nodes[tree->rootNode].firstChild; ( child != INVALID_NODE ) && ( newRoot == INVALID_NODE ); child = tree->nodes[child].nextSibling ) {
+		if( memcmp( &( tree->nodes[child].causingMove ), move, sizeof( MCTS_MOVE ) ) != 0 ) continue;
+#ifdef MCTS_OPEN_LOOP
+		newRoot = child;
+#else
+		if( memcmp( &( tree->nodes[child].state ), newState, sizeof( MCTS_BOARD_STATE ) ) == 0 ) {
+			newRoot = child;
+		} else {
+			break;
+		}
+#endif
+	}
+
+	if( newRoot == INVALID_NODE ) {
+		mcts_Reset( tree, newState );
+		return;
+	}
+
+	// everything that isn't under the new root is released
+	sb_Clear( tree->sbReleased );
+	sb_Push( tree->sbReleased, tree->rootNode );
+	for( size_t i = 0; i < sb_Count( tree->sbReleased ); ++i ) {
+		for( size_t child = tree->nodes[tree->sbReleased[i]].firstChild; child != INVALID_NODE; child = tree->nodes[child].nextSibling ) {
+			if( child != newRoot ) {
+				sb_Push( tree->sbReleased, child );
+			}
+		}
+		tree->nodes[tree->sbReleased[i]].inUse = false;
+	}
+
+	tree->rootNode = newRoot;
+	tree->nodes[newRoot].parent = INVALID_NODE;
+	tree->nodes[newRoot].nextSibling = INVALID_NODE;
+#ifdef MCTS_OPEN_LOOP
+	memcpy( &( tree->initialState ), newState, sizeof( MCTS_BOARD_STATE ) );
+#endif
+#ifdef MCTS_HASH_STATE
+	// the scores may need to be moved out of the released nodes before they're reused
+	rebuildTranspositions( tree );
+#endif
+
+	for( size_t i = 0; i < sb_Count( tree->sbReleased ); ++i ) {
+		releaseNode( tree, tree->sbReleased[i] );
+	}
+}
+
+// how many times the root has been visited, includes everything carried over by mcts_AdvanceRoot( )
+static float mcts_GetRootVisits( MCTree* tree )
+{
+	return nodeStats( tree, tree->rootNode )->evalCnt;
+}
+
+// gets the most visited move from the root so far, returns false if nothing has been searched yet
+static bool mcts_GetBestMove( MCTree* tree, MCTS_MOVE* outBestMove )
+{
+	ASSERT( tree != NULL );
+	ASSERT( outBestMove != NULL );
+
+#ifdef MCTS_OPEN_LOOP
+	// the root may have been reached with a different random result when the tree was reused, so some of the children
+	//  may not be possible now
+	sb_Clear( tree->sbMoves );
+	tree->gameDefinition->getPossibleMoveList( &( tree->initialState ), &( tree->sbMoves ) );
+#endif
+
+	size_t node = tree->nodes[tree->rootNode].firstChild;
+	float bestScore = -1.0f;
+	size_t bestIdx = INVALID_NODE;
+	while( node != INVALID_NODE ) {
+		float score = mcts_Best_ByEvalCount( tree, node );
+#ifdef MCTS_OPEN_LOOP
+		if( !isPossibleMove( tree, &( tree->nodes[node].causingMove ) ) ) score = -1.0f;
+#endif
+		if( ( score >= 0.0f ) && ( score >= bestScore ) ) {
+			bestScore = score;
+			bestIdx = node;
+		}
+		node = tree->nodes[node].nextSibling;
+	}
+
+	if( bestIdx == INVALID_NODE ) {
+		return false;
+	}
+
+	( *outBestMove ) = tree->nodes[bestIdx].causingMove;
+	return true;
 }
 
 // so we'll need some way to get which players turn it was during a board state, then update the score for only that
@@ -439,36 +812,65 @@ static float mcts_Best_ByEvalCount( MCTree* tree, size_t nodeIdx )
 //  - treePolicy and child choice will have to take player index into account
 //  - need an array to store each players scores
 static float amtAIDone = 0.0f;
-static void monteCarloTreeSearch( MCTSGameDefinition definition, float searchConstant, MCTS_BOARD_STATE* initialState, MCTS_MOVE* outBestMove )
+
+// runs steps until one of the limits is hit, 0 means no limit but at least one has to be set, the best move can be
+//  grabbed with mcts_GetBestMove( ) at any point, returns how many steps were run
+static int mcts_Search( MCTree* tree, int maxSteps, float maxSeconds )
 {
-	MCTree tree;
-	tree.sbNodes = NULL;
-	tree.searchConstant = searchConstant;
-	mcts_Init( &tree, &definition, initialState );
+	ASSERT( tree != NULL );
+	ASSERT( ( maxSteps > 0 ) || ( maxSeconds > 0.0f ) );
 
-	for( size_t i = 0; i < MCTS_MAX_STEPS; ++i ) {
-		mcts_Step( &tree );
-		amtAIDone = (float)i / (float)MCTS_MAX_STEPS;
+	Uint64 start = SDL_GetPerformanceCounter( );
+	Uint64 deadline = 0;
+	if( maxSeconds > 0.0f ) {
+		deadline = start + (Uint64)( maxSeconds * (float)SDL_GetPerformanceFrequency( ) );
 	}
 
-	// get the best move from the tree, we'll do the most visited one
-	size_t node = tree.sbNodes[tree.rootNode].firstChild;
-	float bestScore = -1.0f;
-	size_t bestIdx = INVALID_NODE;
-	while( node != INVALID_NODE ) {
-		float score = mcts_Best_ByEvalCount( &tree, node );
-		if( score >= bestScore ) {
-			bestScore = score;
-			bestIdx = node;
+	int steps = 0;
+	while( ( maxSteps <= 0 ) || ( steps < maxSteps ) ) {
+		Uint64 now = SDL_GetPerformanceCounter( );
+		if( ( deadline != 0 ) && ( now >= deadline ) ) break;
+
+		mcts_Step( tree );
+		++steps;
+
+		amtAIDone = 0.0f;
+		if( maxSteps > 0 ) {
+			amtAIDone = (float)steps / (float)maxSteps;
 		}
-		node = tree.sbNodes[node].nextSibling;
+		if( deadline != 0 ) {
+			amtAIDone = MAX( amtAIDone, (float)( now - start ) / (float)( deadline - start ) );
+		}
+	}
+
+	return steps;
+}
+
+// used if the search couldn't be run
+static void firstPossibleMove( MCTSGameDefinition* definition, MCTS_BOARD_STATE* state, MCTS_MOVE* outMove )
+{
+	MCTS_MOVE* sbMoves = NULL;
+	definition->getPossibleMoveList( state, &sbMoves );
+	ASSERT( sb_Count( sbMoves ) > 0 );
+	( *outMove ) = sbMoves[0];
+	sb_Release( sbMoves );
+}
+
+static void monteCarloTreeSearch( MCTSGameDefinition definition, float searchConstant, MCTS_BOARD_STATE* initialState, MCTS_MOVE* outBestMove )
+{
+	MCTree tree;
+	if( !mcts_Create( &tree, &definition, searchConstant, MCTS_MAX_NODES, initialState ) ) {
+		firstPossibleMove( &definition, initialState, outBestMove );
+		return;
 	}
 
-	ASSERT( bestIdx != INVALID_NODE );
+	mcts_Search( &tree, MCTS_MAX_STEPS, 0.0f );
 
-	( *outBestMove ) = tree.sbNodes[bestIdx].causingMove;
+	// get the best move from the tree, we'll do the most visited one
+	bool found = mcts_GetBestMove( &tree, outBestMove );
+	ASSERT( found );
 
-	sb_Release( tree.sbNodes );
+	mcts_Destroy( &tree );
 }
 
 typedef struct {
@@ -515,9 +917,501 @@ static void startMCTSThread( MCTSGameDefinition gameDefinition, float searchCons
 	jq_AddJob( runMCTSThread, (void*)threadData );
 }
 
+//************************************
+// Parallel search
+//  Runs the search across the job queue's workers, the calling thread helps out so it still finishes if there aren't
+//   any. There are two ways of splitting up the work:
+//   MCTS_PARALLEL_ROOT: each worker grows its own tree from the same state and nothing is shared while searching, at
+//    the end the visit counts for each move from the root are added up across all the trees.
+//   MCTS_PARALLEL_TREE: all the workers share one tree. The statistics are updated atomically and every node a worker
+//    passes through on the way down is given a virtual loss, which steers the other workers towards different branches
+//    until the real result is propagated back up.
+//  The nodes are allocated up front, when they run out the tree stops growing and the search carries on doing roll
+//   outs from the leaves. Scores are stored as half points so ties can be added atomically.
+//  The game definition's callbacks will be called from multiple threads at the same time, use mcts_GetRandom( ) for
+//   anything random so each worker uses its own RandomGroup.
+
+#define MCTS_MAX_LANES 16
+#define INVALID_SHARED_NODE -1
+
+typedef enum {
+	MCTS_PARALLEL_ROOT,
+	MCTS_PARALLEL_TREE
+} MCTSParallelMode;
+
+typedef struct {
+	MCTSParallelMode mode;
+	int maxWorkers; // 0 to use every job queue thread
+	int maxSteps; // total across all the workers, 0 for no limit
+	float maxSeconds; // 0 for no limit, at least one of the limits has to be set
+} MCTSParallelSettings;
+
+typedef struct {
+	SDL_AtomicInt halfScores[MCTS_NUM_PLAYERS];
+	SDL_AtomicInt evalCnt; // includes the virtual losses from workers that haven't finished with this node yet
+	SDL_AtomicInt firstChild;
+	SDL_AtomicInt nextSibling;
+	SDL_AtomicInt expandLock;
+
+	int parent;
+	MCTS_MOVE causingMove;
+#ifndef MCTS_OPEN_LOOP
+	MCTS_BOARD_STATE state;
+#endif
+} MCSharedNode;
+
+typedef struct {
+	MCSharedNode* nodes;
+	int capacity;
+	SDL_AtomicInt nodeCount;
+#ifdef MCTS_OPEN_LOOP
+	MCTS_BOARD_STATE initialState;
+#endif
+} MCSharedTree;
+
+typedef struct {
+	MCTSGameDefinition* gameDefinition;
+	float searchConstant;
+	MCTSParallelMode mode;
+
+	MCSharedTree trees[MCTS_MAX_LANES];
+	int numTrees;
+
+	int maxSteps;
+	float maxSeconds;
+	Uint64 startTime;
+	Uint64 deadline; // 0 if there isn't one
+	SDL_AtomicInt stepsStarted;
+	SDL_AtomicInt stepsDone;
+
+	RandomGroup laneRandoms[MCTS_MAX_LANES];
+	SDL_AtomicInt nextLane;
+	SDL_AtomicInt lanesDone;
+} MCParallelSearch;
+
+typedef struct {
+	MCTS_MOVE move;
+	int evalCnt;
+} MCMoveTotal;
+
+static SDL_TLSID mctsRandomTLS;
+
+// the RandomGroup for the worker running on this thread, NULL (the default group) outside of a parallel search
+static RandomGroup* mcts_GetRandom( void )
+{
+	return (RandomGroup*)SDL_GetTLS( &mctsRandomTLS );
+}
+
+static bool mcts_InitSharedTree( MCSharedTree* tree, int capacity, MCTS_BOARD_STATE* initialState )
+{
+	tree->nodes = mem_Allocate( sizeof( MCSharedNode ) * (size_t)capacity );
+	if( tree->nodes == NULL ) {
+		return false;
+	}
+	tree->capacity = capacity;
+	SDL_SetAtomicInt( &( tree->nodeCount ), 1 );
+
+	MCSharedNode* root = &( tree->nodes[0] );
+	SDL_memset( root, 0, sizeof( MCSharedNode ) );
+	root->parent = INVALID_SHARED_NODE;
+	SDL_SetAtomicInt( &( root->firstChild ), INVALID_SHARED_NODE );
+	SDL_SetAtomicInt( &( root->nextSibling ), INVALID_SHARED_NODE );
+#ifdef MCTS_OPEN_LOOP
+	tree->initialState = ( *initialState );
+#else
+	root->state = ( *initialState );
+#endif
+
+	return true;
+}
+
+// returns the index of the first of count new nodes, or INVALID_SHARED_NODE if the tree is full
+static int mcts_AllocSharedNodes( MCSharedTree* tree, int count )
+{
+	// avoid pushing the count further past the end once it's full
+	if( SDL_GetAtomicInt( &( tree->nodeCount ) ) + count > tree->capacity ) {
+		return INVALID_SHARED_NODE;
+	}
+
+	int first = SDL_AddAtomicInt( &( tree->nodeCount ), count );
+	if( first + count > tree->capacity ) {
+		return INVALID_SHARED_NODE;
+	}
+	return first;
+}
+
+static void mcts_InitSharedNode( MCSharedTree* tree, int idx, int parent, MCTS_MOVE* causingMove )
+{
+	MCSharedNode* node = &( tree->nodes[idx] );
+	for( int i = 0; i < MCTS_NUM_PLAYERS; ++i ) {
+		SDL_SetAtomicInt( &( node->halfScores[i] ), 0 );
+	}
+	SDL_SetAtomicInt( &( node->evalCnt ), 0 );
+	SDL_SetAtomicInt( &( node->firstChild ), INVALID_SHARED_NODE );
+	SDL_SetAtomicInt( &( node->nextSibling ), INVALID_SHARED_NODE );
+	SDL_SetAtomicInt( &( node->expandLock ), 0 );
+	node->parent = parent;
+	node->causingMove = ( *causingMove );
+}
+
+// adds the children for any moves the node doesn't have yet, if another worker is already expanding the node this
+//  leaves it to them instead of waiting
+static void mcts_SharedExpand( MCParallelSearch* search, MCSharedTree* tree, int idx, MCTS_BOARD_STATE* idxState, MCTS_MOVE** sbMoves )
+{
+	MCSharedNode* node = &( tree->nodes[idx] );
+	if( !SDL_CompareAndSwapAtomicInt( &( node->expandLock ), 0, 1 ) ) {
+		return;
+	}
+
+	sb_Clear( *sbMoves );
+	search->gameDefinition->getPossibleMoveList( idxState, sbMoves );
+
+#ifdef MCTS_OPEN_LOOP
+	// find the end of the list, anything that's already there has been seen before
+	int lastChild = INVALID_SHARED_NODE;
+	int curr = SDL_GetAtomicInt( &( node->firstChild ) );
+	while( curr != INVALID_SHARED_NODE ) {
+		for( size_t i = 0; i < sb_Count( *sbMoves ); ++i ) {
+			if( memcmp( &( tree->nodes[curr].causingMove ), &( ( *sbMoves )[i] ), sizeof( MCTS_MOVE ) ) == 0 ) {
+				sb_Remove( *sbMoves, i );
+				break;
+			}
+		}
+		lastChild = curr;
+		curr = SDL_GetAtomicInt( &( tree->nodes[curr].nextSibling ) );
+	}
+
+	// the child is set up before it's linked in so any worker reading the list will see a finished node
+	for( size_t i = 0; i < sb_Count( *sbMoves ); ++i ) {
+		int child = mcts_AllocSharedNodes( tree, 1 );
+		if( child == INVALID_SHARED_NODE ) break;
+
+		mcts_InitSharedNode( tree, child, idx, &( ( *sbMoves )[i] ) );
+		if( lastChild == INVALID_SHARED_NODE ) {
+			SDL_SetAtomicInt( &( node->firstChild ), child );
+		} else {
+			SDL_SetAtomicInt( &( tree->nodes[lastChild].nextSibling ), child );
+		}
+		lastChild = child;
+	}
+#else
+	int count = (int)sb_Count( *sbMoves );
+	int first = INVALID_SHARED_NODE;
+	if( ( SDL_GetAtomicInt( &( node->firstChild ) ) == INVALID_SHARED_NODE ) && ( count > 0 ) ) {
+		first = mcts_AllocSharedNodes( tree, count );
+	}
+
+	if( first != INVALID_SHARED_NODE ) {
+		for( int i = 0; i < count; ++i ) {
+			mcts_InitSharedNode( tree, first + i, idx, &( ( *sbMoves )[i] ) );
+			search->gameDefinition->applyMove( idxState, &( ( *sbMoves )[i] ), &( tree->nodes[first + i].state ) );
+			if( i > 0 ) {
+				SDL_SetAtomicInt( &( tree->nodes[first + i - 1].nextSibling ), first + i );
+			}
+		}
+		SDL_SetAtomicInt( &( node->firstChild ), first );
+	}
+#endif
+
+	SDL_SetAtomicInt( &( node->expandLock ), 0 );
+}
+
+// same as mtcs_BestChild( ), the virtual losses count as visits that scored nothing
+static int mcts_SharedBestChild( MCParallelSearch* search, MCSharedTree* tree, int idx, MCTS_BOARD_STATE* idxState, RandomGroup* rg )
+{
+	int numFound = 0;
+	int best = INVALID_SHARED_NODE;
+	float bestScore = 0.0f;
+	float logCnt = logf( (float)SDL_GetAtomicInt( &( tree->nodes[idx].evalCnt ) ) );
+	int currPlayer = search->gameDefinition->getCurrentPlayer( idxState );
+
+	int curr = SDL_GetAtomicInt( &( tree->nodes[idx].firstChild ) );
+	while( curr != INVALID_SHARED_NODE ) {
+		float uctValue = INFINITY;
+
+		float evalCnt = (float)SDL_GetAtomicInt( &( tree->nodes[curr].evalCnt ) );
+		if( evalCnt > 0.0f ) {
+			float score = (float)SDL_GetAtomicInt( &( tree->nodes[curr].halfScores[currPlayer] ) ) * 0.5f;
+			uctValue = ( score / evalCnt ) + ( search->searchConstant * sqrtf( logCnt / evalCnt ) );
+		}
+
+		if( ( uctValue > bestScore ) || ( best == INVALID_SHARED_NODE ) ) {
+			numFound = 1;
+			best = curr;
+			bestScore = uctValue;
+		} else if( uctValue == bestScore ) {
+			++numFound;
+			if( ( rand_GetU32( rg ) % numFound ) == 0 ) {
+				best = curr;
+			}
+		}
+
+		curr = SDL_GetAtomicInt( &( tree->nodes[curr].nextSibling ) );
+	}
+
+	return best;
+}
+
+static void mcts_SharedStep( MCParallelSearch* search, MCSharedTree* tree, RandomGroup* rg, MCTS_MOVE** sbMoves )
+{
+	MCTSGameDefinition* def = search->gameDefinition;
+	MCTS_BOARD_STATE* currState;
+#ifdef MCTS_OPEN_LOOP
+	MCTS_BOARD_STATE state = tree->initialState;
+	MCTS_BOARD_STATE nextState;
+	currState = &state;
+#endif
+
+	// selection, adding a virtual loss to everything on the way down
+	int idx = 0;
+	SDL_AddAtomicInt( &( tree->nodes[idx].evalCnt ), MCTS_VIRTUAL_LOSS );
+	while( SDL_GetAtomicInt( &( tree->nodes[idx].firstChild ) ) != INVALID_SHARED_NODE ) {
+#ifdef MCTS_OPEN_LOOP
+		mcts_SharedExpand( search, tree, idx, currState, sbMoves );
+		idx = mcts_SharedBestChild( search, tree, idx, currState, rg );
+		def->applyMove( currState, &( tree->nodes[idx].causingMove ), &nextState );
+		state = nextState;
+#else
+		currState = &( tree->nodes[idx].state );
+		idx = mcts_SharedBestChild( search, tree, idx, currState, rg );
+#endif
+		SDL_AddAtomicInt( &( tree->nodes[idx].evalCnt ), MCTS_VIRTUAL_LOSS );
+	}
+
+#ifndef MCTS_OPEN_LOOP
+	currState = &( tree->nodes[idx].state );
+#endif
+
+	// expansion, only if it's been visited by something other than us
+	if( ( SDL_GetAtomicInt( &( tree->nodes[idx].evalCnt ) ) > MCTS_VIRTUAL_LOSS ) && ( def->getWinner( currState ) < 0 ) ) {
+		mcts_SharedExpand( search, tree, idx, currState, sbMoves );
+		if( SDL_GetAtomicInt( &( tree->nodes[idx].firstChild ) ) != INVALID_SHARED_NODE ) {
+			int parent = idx;
+			idx = mcts_SharedBestChild( search, tree, parent, currState, rg );
+#ifdef MCTS_OPEN_LOOP
+			def->applyMove( currState, &( tree->nodes[idx].causingMove ), &nextState );
+			state = nextState;
+#else
+			currState = &( tree->nodes[idx].state );
+#endif
+			SDL_AddAtomicInt( &( tree->nodes[idx].evalCnt ), MCTS_VIRTUAL_LOSS );
+		}
+	}
+
+	float score;
+	int player;
+	mcts_RollOut( def, currState, rg, sbMoves, &score, &player );
+
+	// back propagation, the visit was already counted by the virtual loss so just remove any extra
+	while( idx != INVALID_SHARED_NODE ) {
+		MCSharedNode* node = &( tree->nodes[idx] );
+		if( player < 0 ) {
+			for( int i = 0; i < MCTS_NUM_PLAYERS; ++i ) {
+				SDL_AddAtomicInt( &( node->halfScores[i] ), 1 );
+			}
+		} else {
+			SDL_AddAtomicInt( &( node->halfScores[player] ), 2 );
+		}
+#if MCTS_VIRTUAL_LOSS != 1
+		SDL_AddAtomicInt( &( node->evalCnt ), 1 - MCTS_VIRTUAL_LOSS );
+#endif
+		idx = node->parent;
+	}
+}
+
+static void mcts_ParallelLane( void* data )
+{
+	MCParallelSearch* search = (MCParallelSearch*)data;
+
+	int lane = SDL_AddAtomicInt( &( search->nextLane ), 1 );
+	MCSharedTree* tree = &( search->trees[( search->mode == MCTS_PARALLEL_ROOT ) ? lane : 0] );
+	RandomGroup* rg = &( search->laneRandoms[lane] );
+	SDL_SetTLS( &mctsRandomTLS, rg, NULL );
+
+	MCTS_MOVE* sbMoves = NULL;
+	for( ;; ) {
+		if( ( search->deadline != 0 ) && ( SDL_GetPerformanceCounter( ) >= search->deadline ) ) break;
+		if( ( search->maxSteps > 0 ) && ( SDL_AddAtomicInt( &( search->stepsStarted ), 1 ) >= search->maxSteps ) ) break;
+
+		mcts_SharedStep( search, tree, rg, &sbMoves );
+		int stepsDone = SDL_AddAtomicInt( &( search->stepsDone ), 1 ) + 1;
+
+		if( lane == 0 ) {
+			if( search->maxSteps > 0 ) {
+				amtAIDone = (float)stepsDone / (float)search->maxSteps;
+			}
+			if( search->deadline != 0 ) {
+				float elapsed = (float)( SDL_GetPerformanceCounter( ) - search->startTime ) / (float)SDL_GetPerformanceFrequency( );
+				amtAIDone = MAX( amtAIDone, elapsed / search->maxSeconds );
+			}
+		}
+	}
+	sb_Release( sbMoves );
+
+	SDL_SetTLS( &mctsRandomTLS, NULL, NULL );
+	SDL_AddAtomicInt( &( search->lanesDone ), 1 );
+}
+
+// returns the number of roll outs that were done, -1 if the search couldn't be run
+static int parallelMonteCarloTreeSearch( MCTSGameDefinition definition, float searchConstant, MCTS_BOARD_STATE* initialState, const MCTSParallelSettings* settings, MCTS_MOVE* outBestMove )
+{
+	ASSERT( initialState != NULL );
+	ASSERT( settings != NULL );
+	ASSERT( outBestMove != NULL );
+	ASSERT( ( settings->maxSteps > 0 ) || ( settings->maxSeconds > 0.0f ) );
+
+	int numLanes = MAX( jq_GetNumThreads( ), 1 );
+	if( settings->maxWorkers > 0 ) {
+		numLanes = MIN( numLanes, settings->maxWorkers );
+	}
+	numLanes = MIN( numLanes, MCTS_MAX_LANES );
+
+	int stepsDone = -1;
+	MCTS_MOVE* sbMoves = NULL;
+	MCMoveTotal* sbTotals = NULL;
+	MCParallelSearch* search = mem_Allocate( sizeof( MCParallelSearch ) );
+	if( search == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate parallel tree search." );
+		return -1;
+	}
+	SDL_memset( search, 0, sizeof( MCParallelSearch ) );
+	search->gameDefinition = &definition;
+	search->searchConstant = searchConstant;
+	search->mode = settings->mode;
+	search->maxSteps = settings->maxSteps;
+	search->maxSeconds = settings->maxSeconds;
+
+	search->numTrees = ( settings->mode == MCTS_PARALLEL_ROOT ) ? numLanes : 1;
+	int capacity = MAX( MCTS_MAX_PARALLEL_NODES / search->numTrees, 1024 );
+	for( int i = 0; i < search->numTrees; ++i ) {
+		if( !mcts_InitSharedTree( &( search->trees[i] ), capacity, initialState ) ) {
+			llog( LOG_ERROR, "Unable to allocate nodes for parallel tree search." );
+			goto clean_up;
+		}
+	}
+
+	for( int i = 0; i < numLanes; ++i ) {
+		rand_Seed( &( search->laneRandoms[i] ), rand_GetU32( &mctsRandom ) );
+	}
+
+	search->startTime = SDL_GetPerformanceCounter( );
+	if( settings->maxSeconds > 0.0f ) {
+		search->deadline = search->startTime + (Uint64)( settings->maxSeconds * (float)SDL_GetPerformanceFrequency( ) );
+	}
+
+	int lanesQueued = 0;
+	for( int i = 0; i < numLanes; ++i ) {
+		if( jq_AddJob( mcts_ParallelLane, search ) ) {
+			++lanesQueued;
+		}
+	}
+
+	if( lanesQueued == 0 ) {
+		mcts_ParallelLane( search );
+		lanesQueued = 1;
+	}
+
+	// help out while waiting so this still finishes if there are no worker threads
+	while( SDL_GetAtomicInt( &( search->lanesDone ) ) < lanesQueued ) {
+		if( !jq_ProcessNextJob( ) ) {
+			SDL_Delay( 0 );
+		}
+	}
+
+	// add up the visits for each move from the root, with root parallelization the same move can be in multiple trees
+	for( int t = 0; t < search->numTrees; ++t ) {
+		MCSharedTree* tree = &( search->trees[t] );
+		int child = SDL_GetAtomicInt( &( tree->nodes[0].firstChild ) );
+		while( child != INVALID_SHARED_NODE ) {
+			MCMoveTotal* total = NULL;
+			for( size_t i = 0; ( i < sb_Count( sbTotals ) ) && ( total == NULL ); ++i ) {
+				if( memcmp( &( sbTotals[i].move ), &( tree->nodes[child].causingMove ), sizeof( MCTS_MOVE ) ) == 0 ) {
+					total = &( sbTotals[i] );
+				}
+			}
+			if( total == NULL ) {
+				total = sb_Add( sbTotals, 1 );
+				total->move = tree->nodes[child].causingMove;
+				total->evalCnt = 0;
+			}
+			total->evalCnt += SDL_GetAtomicInt( &( tree->nodes[child].evalCnt ) );
+
+			child = SDL_GetAtomicInt( &( tree->nodes[child].nextSibling ) );
+		}
+	}
+
+	int best = -1;
+	for( int i = 0; i < (int)sb_Count( sbTotals ); ++i ) {
+		if( ( best < 0 ) || ( sbTotals[i].evalCnt >= sbTotals[best].evalCnt ) ) {
+			best = i;
+		}
+	}
+
+	if( best >= 0 ) {
+		( *outBestMove ) = sbTotals[best].move;
+	} else {
+		// never got a chance to look at anything
+		definition.getPossibleMoveList( initialState, &sbMoves );
+		ASSERT( sb_Count( sbMoves ) > 0 );
+		( *outBestMove ) = sbMoves[0];
+	}
+	stepsDone = SDL_GetAtomicInt( &( search->stepsDone ) );
+
+clean_up:
+	for( int i = 0; i < search->numTrees; ++i ) {
+		mem_Release( search->trees[i].nodes );
+	}
+	mem_Release( search );
+	sb_Release( sbTotals );
+	sb_Release( sbMoves );
+
+	return stepsDone;
+}
+
+typedef struct {
+	MCTSGameDefinition gameDefinition;
+	MCTS_BOARD_STATE gameState;
+	float searchConstant;
+	MCTSParallelSettings settings;
+} ParallelBoardGameThreadData;
+
+static void runParallelMCTSThread( void* data )
+{
+	MCTS_MOVE* move = (MCTS_MOVE*)mem_Allocate( sizeof( MCTS_MOVE ) );
+	ParallelBoardGameThreadData* threadData = (ParallelBoardGameThreadData*)data;
+
+	parallelMonteCarloTreeSearch( threadData->gameDefinition, threadData->searchConstant, &( threadData->gameState ), &( threadData->settings ), move );
+
+	mem_Release( data );
+
+	jq_AddMainThreadJob( setMCTSMove, move );
+}
+
+// same as startMCTSThread( ) but the search itself is split across the job queue
+static void startParallelMCTSThread( MCTSGameDefinition gameDefinition, float searchConstant, void* currentState, MCTSParallelSettings settings )
+{
+	aiChosenMoveReady = false;
+	amtAIDone = 0.0f;
+
+	ParallelBoardGameThreadData* threadData = (ParallelBoardGameThreadData*)mem_Allocate( sizeof( ParallelBoardGameThreadData ) );
+	threadData->gameDefinition = gameDefinition;
+	threadData->searchConstant = searchConstant;
+	threadData->settings = settings;
+	memcpy( &( threadData->gameState ), currentState, sizeof( MCTS_BOARD_STATE ) );
+
+	jq_AddJob( runParallelMCTSThread, (void*)threadData );
+}
+
 // clean up
 #undef MCTS_MOVE
 #undef MCTS_BOARD_STATE
 #undef MCTS_NUM_PLAYERS
 #undef MCTS_MAX_ROLL_OUT_DEPTH
-#undef MCTS_MAX_STEPS
\ No newline at end of file
+#undef MCTS_MAX_STEPS
+#undef MCTS_MAX_NODES
+#undef MCTS_HASH_STATE
+#undef MCTS_MAX_PARALLEL_NODES
+#undef MCTS_VIRTUAL_LOSS
+#undef MCTS_MAX_LANES
+#undef INVALID_SHARED_NODE
+#undef INVALID_NODE
\ No newline at end of file
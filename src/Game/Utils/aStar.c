@@ -1,73 +1,336 @@
 #include "aStar.h"
 
 #include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_stdinc.h>
 #include <float.h>
 #include <math.h>
 
 #include "System/memory.h"
 #include "stretchyBuffer.h"
 
+#define HEAP_ARITY 4
+
 // used if they don't give us a move or heuristic cost function
 static float defaultCost( void* graph, int fromNode, int toNode )
 {
 	return 1.0f;
 }
 
-// creates a search state we can send to process and extract, we should call aStar_CleanUpSearchState
-//  after we're done with it to clean up any memory we have allocated here
-void aStar_CreateSearchState( void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
-	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor,
-	AStarSearchState* outState )
+// returns whether a should come off the open heap before b
+static bool isHigherPriority( const AStarNodeRecord* nodes, int a, int b )
 {
-	ASSERT( outState != NULL );
-	ASSERT( nextNeighbor != NULL );
+	if( nodes[a].priority != nodes[b].priority ) {
+		return nodes[a].priority < nodes[b].priority;
+	}
 
-	outState->graph = graph;
-	outState->moveCost = ( moveCost == NULL ) ? defaultCost : moveCost;
-	outState->heuristic = ( heuristic == NULL ) ? defaultCost : heuristic;
-	outState->nextNeighbor = nextNeighbor;
+	// on ties prefer the node that's further from the start, it's usually closer to the target
+	return nodes[a].cost > nodes[b].cost;
+}
 
-	outState->sbPath = NULL;
-	outState->sbFrontier = NULL;
+static void heapSiftUp( AStarContext* context, int heapIdx )
+{
+	AStarNodeRecord* nodes = context->sbNodes;
+	int* heap = context->sbOpenHeap;
 
-	if( nodeCount == 0 ) {
-		return;
+	int nodeID = heap[heapIdx];
+	while( heapIdx > 0 ) {
+		int parentIdx = ( heapIdx - 1 ) / HEAP_ARITY;
+		int parentID = heap[parentIdx];
+		if( !isHigherPriority( nodes, nodeID, parentID ) ) {
+			break;
+		}
+
+		heap[heapIdx] = parentID;
+		nodes[parentID].heapIndex = heapIdx;
+		heapIdx = parentIdx;
 	}
 
-	sb_Add( outState->sbPath, nodeCount );
-	for( size_t i = 0; i < sb_Count( outState->sbPath ); ++i ) {
-		outState->sbPath[i].from = -1;
-		outState->sbPath[i].cost = INFINITY;
+	heap[heapIdx] = nodeID;
+	nodes[nodeID].heapIndex = heapIdx;
+}
+
+static void heapSiftDown( AStarContext* context, int heapIdx )
+{
+	AStarNodeRecord* nodes = context->sbNodes;
+	int* heap = context->sbOpenHeap;
+	int count = (int)sb_Count( heap );
+
+	int nodeID = heap[heapIdx];
+	while( true ) {
+		int firstChildIdx = ( heapIdx * HEAP_ARITY ) + 1;
+		if( firstChildIdx >= count ) {
+			break;
+		}
+
+		int endChildIdx = firstChildIdx + HEAP_ARITY;
+		if( endChildIdx > count ) {
+			endChildIdx = count;
+		}
+
+		int bestIdx = firstChildIdx;
+		for( int i = firstChildIdx + 1; i < endChildIdx; ++i ) {
+			if( isHigherPriority( nodes, heap[i], heap[bestIdx] ) ) {
+				bestIdx = i;
+			}
+		}
+
+		if( !isHigherPriority( nodes, heap[bestIdx], nodeID ) ) {
+			break;
+		}
+
+		heap[heapIdx] = heap[bestIdx];
+		nodes[heap[heapIdx]].heapIndex = heapIdx;
+		heapIdx = bestIdx;
 	}
 
-	AStarFrontierData initASD;
-	initASD.loc = startNodeID;
-	initASD.cost = 0.0f;
-	sb_Reserve( outState->sbFrontier, nodeCount ); // just reserve some data
-	sb_Push( outState->sbFrontier, initASD );
+	heap[heapIdx] = nodeID;
+	nodes[nodeID].heapIndex = heapIdx;
+}
 
-	outState->sbPath[startNodeID].from = startNodeID;
-	outState->sbPath[startNodeID].cost = 0.0f;
+static void heapPush( AStarContext* context, int nodeID )
+{
+	sb_Push( context->sbOpenHeap, nodeID );
+	heapSiftUp( context, (int)sb_Count( context->sbOpenHeap ) - 1 );
+}
+
+static int heapPop( AStarContext* context )
+{
+	int topID = context->sbOpenHeap[0];
+	context->sbNodes[topID].heapIndex = -1;
 
-	outState->targetNodeID = targetNodeID;
-	outState->startNodeID = startNodeID;
+	int lastID = sb_Pop( context->sbOpenHeap );
+	if( sb_Count( context->sbOpenHeap ) > 0 ) {
+		context->sbOpenHeap[0] = lastID;
+		heapSiftDown( context, 0 );
+	}
+
+	return topID;
 }
 
-// in case we need to test for this, if it's invalid aStar_ProcessPath will handle it by returning
-//  an empty path
-bool aStar_IsValid( AStarSearchState* state )
+// gets the record for the node, resetting it if it was last used by a previous search
+static AStarNodeRecord* touchNode( AStarContext* context, int nodeID )
+{
+	AStarNodeRecord* node = &( context->sbNodes[nodeID] );
+	if( node->generation != context->generation ) {
+		node->generation = context->generation;
+		node->cost = INFINITY;
+		node->priority = INFINITY;
+		node->from = -1;
+		node->heapIndex = -1;
+	}
+	return node;
+}
+
+void aStar_InitContext( AStarContext* context )
+{
+	ASSERT( context != NULL );
+
+	SDL_memset( context, 0, sizeof( *context ) );
+	context->startNodeID = -1;
+	context->targetNodeID = -1;
+}
+
+void aStar_CleanUpContext( AStarContext* context )
+{
+	ASSERT( context != NULL );
+
+	sb_Release( context->sbNodes );
+	sb_Release( context->sbOpenHeap );
+	aStar_InitContext( context );
+}
+
+// grows the node records to fit nodeCount and starts a new generation, nothing is left open or visited
+void aStar_ResetContext( AStarContext* context, size_t nodeCount )
+{
+	ASSERT( context != NULL );
+
+	context->nodeCount = nodeCount;
+	context->searching = false;
+	context->found = false;
+	context->numExpansions = 0;
+
+	sb_Clear( context->sbOpenHeap );
+
+	// new records get generation 0, which no search uses
+	size_t oldCount = sb_Count( context->sbNodes );
+	if( oldCount < nodeCount ) {
+		AStarNodeRecord* newNodes = sb_Add( context->sbNodes, nodeCount - oldCount );
+		SDL_memset( newNodes, 0, sizeof( newNodes[0] ) * ( nodeCount - oldCount ) );
+	}
+
+	++context->generation;
+	if( context->generation == 0 ) {
+		// wrapped around, clear the stamps so records from long ago aren't mistaken for current ones
+		for( size_t i = 0; i < sb_Count( context->sbNodes ); ++i ) {
+			context->sbNodes[i].generation = 0;
+		}
+		context->generation = 1;
+	}
+}
+
+// gets the record for the node, unvisited nodes have an infinite cost and no from node
+AStarNodeRecord* aStar_GetNodeRecord( AStarContext* context, int nodeID )
+{
+	ASSERT( ( nodeID >= 0 ) && ( (size_t)nodeID < context->nodeCount ) );
+	return touchNode( context, nodeID );
+}
+
+// if cost is lower than what the node has now it's recorded and the node is added to or moved up in the open heap
+//  returns whether the node was updated
+bool aStar_OpenNode( AStarContext* context, int nodeID, int fromNodeID, float cost, float heuristic )
 {
-	if( state->sbPath == NULL ) {
+	AStarNodeRecord* node = aStar_GetNodeRecord( context, nodeID );
+	if( cost >= node->cost ) {
 		return false;
 	}
 
-	if( state->sbFrontier == NULL ) {
+	node->cost = cost;
+	node->priority = cost + heuristic;
+	node->from = fromNodeID;
+
+	// the cost only goes down, so nodes already in the heap only have to move up
+	if( node->heapIndex >= 0 ) {
+		heapSiftUp( context, node->heapIndex );
+	} else {
+		heapPush( context, nodeID );
+	}
+
+	return true;
+}
+
+// takes the node with the lowest cost plus heuristic out of the open heap, returns -1 if the heap is empty
+int aStar_PopOpenNode( AStarContext* context )
+{
+	if( sb_Count( context->sbOpenHeap ) <= 0 ) {
+		return -1;
+	}
+
+	++context->numExpansions;
+	return heapPop( context );
+}
+
+// sets up a new search, if moveCost or heuristic are NULL every move costs 1
+//  returns false if the start or target aren't valid nodes
+bool aStar_StartSearch( AStarContext* context, void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
+	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor )
+{
+	ASSERT( context != NULL );
+	ASSERT( nextNeighbor != NULL );
+
+	aStar_ResetContext( context, nodeCount );
+
+	context->graph = graph;
+	context->startNodeID = startNodeID;
+	context->targetNodeID = targetNodeID;
+	context->moveCost = ( moveCost == NULL ) ? defaultCost : moveCost;
+	context->heuristic = ( heuristic == NULL ) ? defaultCost : heuristic;
+	context->nextNeighbor = nextNeighbor;
+
+	if( ( startNodeID < 0 ) || ( (size_t)startNodeID >= nodeCount ) ||
+		( targetNodeID < 0 ) || ( (size_t)targetNodeID >= nodeCount ) ) {
+		return false;
+	}
+
+	aStar_OpenNode( context, startNodeID, startNodeID, 0.0f, 0.0f );
+
+	context->searching = true;
+	return true;
+}
+
+// expands numSteps nodes of the current search, pass in -1 for numSteps to go until the end
+//  returns whether the search is done
+bool aStar_StepSearch( AStarContext* context, int numSteps )
+{
+	ASSERT( context != NULL );
+
+	while( context->searching && ( numSteps != 0 ) ) {
+		if( numSteps > 0 ) --numSteps;
+
+		int currentID = aStar_PopOpenNode( context );
+		if( currentID == -1 ) {
+			// no path found
+			context->searching = false;
+			break;
+		}
+
+		if( currentID == context->targetNodeID ) {
+			context->found = true;
+			context->searching = false;
+			break;
+		}
+
+		float currentCost = context->sbNodes[currentID].cost;
+		int neighborID = context->nextNeighbor( context->graph, currentID, -1 );
+		while( neighborID != -1 ) {
+			ASSERT( ( neighborID >= 0 ) && ( (size_t)neighborID < context->nodeCount ) );
+
+			float newCost = currentCost + context->moveCost( context->graph, currentID, neighborID );
+			if( newCost < aStar_GetNodeRecord( context, neighborID )->cost ) {
+				aStar_OpenNode( context, neighborID, currentID, newCost,
+					context->heuristic( context->graph, neighborID, context->targetNodeID ) );
+			}
+
+			neighborID = context->nextNeighbor( context->graph, currentID, neighborID );
+		}
+	}
+
+	return !context->searching;
+}
+
+// if the last search found the target this pushes the path onto sbOutPath, going from the target back to the node
+//  after the start, returns whether a path was found
+bool aStar_GetPath( AStarContext* context, int** sbOutPath )
+{
+	ASSERT( context != NULL );
+
+	if( !context->found ) {
 		return false;
 	}
 
+	if( sbOutPath != NULL ) {
+		int current = context->targetNodeID;
+		while( current != context->startNodeID ) {
+			sb_Push( (*sbOutPath), current );
+			current = context->sbNodes[current].from;
+		}
+	}
+
 	return true;
 }
 
+// starts a search and runs it until it's done, returns whether a path was found and puts it into sbOutPath
+bool aStar_FindPath( AStarContext* context, void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
+	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor, int** sbOutPath )
+{
+	if( !aStar_StartSearch( context, graph, nodeCount, startNodeID, targetNodeID, moveCost, heuristic, nextNeighbor ) ) {
+		return false;
+	}
+
+	aStar_StepSearch( context, -1 );
+	return aStar_GetPath( context, sbOutPath );
+}
+
+// creates a search state we can send to process and extract, we should call aStar_CleanUpSearchState
+//  after we're done with it to clean up any memory we have allocated here
+void aStar_CreateSearchState( void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
+	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor,
+	AStarSearchState* outState )
+{
+	ASSERT( outState != NULL );
+	ASSERT( nextNeighbor != NULL );
+
+	aStar_InitContext( &( outState->context ) );
+	outState->valid = aStar_StartSearch( &( outState->context ), graph, nodeCount, startNodeID, targetNodeID,
+		moveCost, heuristic, nextNeighbor );
+}
+
+// in case we need to test for this, if it's invalid aStar_ProcessPath will handle it by returning
+//  an empty path
+bool aStar_IsValid( AStarSearchState* state )
+{
+	return state->valid;
+}
+
 // process numSteps nodes in the search state, pass in -1 for numSteps to go until the end
 //  returns whether processing is done and puts the resulting path into a stretchy buffer in sbOutPaths
 bool aStar_ProcessPath( AStarSearchState* state, int numSteps, int** sbOutPaths )
@@ -76,59 +339,14 @@ bool aStar_ProcessPath( AStarSearchState* state, int numSteps, int** sbOutPaths
 		return true;
 	}
 
-	// everything should already be setup
-	bool done = false;
-	bool processingDone = false;
-	while( !( done || processingDone ) ) {
-		if( sb_Count( state->sbFrontier ) <= 0 ) {
-			// no path found
-			processingDone = true;
-		} else {
-		
-			AStarFrontierData front = sb_Pop( state->sbFrontier );
-			if( front.loc == state->targetNodeID ) {
-				// found the path, generate it and put it into sbOutPaths and stop processing
-				if( sbOutPaths != NULL ) {
-					int current = state->targetNodeID;
-					while( current != state->startNodeID ) {
-						sb_Push( (*sbOutPaths), current );
-						current = state->sbPath[current].from;
-					}
-				}
-				processingDone = true;
-			} else {
-
-				int neighbor = state->nextNeighbor( state->graph, front.loc, -1 );
-				while( neighbor != -1 ) {
-					float newCost = state->sbPath[front.loc].cost + state->moveCost( state->graph, front.loc, neighbor );
-					// no set check because we're initializing the values to FLT_MAX
-					if( newCost < state->sbPath[neighbor].cost ) {
-						ASSERT( neighbor < (int)sb_Count( state->sbPath ) );
-
-						state->sbPath[neighbor].cost = newCost;
-						state->sbPath[neighbor].from = front.loc;
-
-						AStarFrontierData asfd;
-						asfd.loc = neighbor;
-
-						asfd.cost = newCost + state->heuristic( state->graph, neighbor, state->targetNodeID );
-
-						// insertion sort into frontier, simulate a priority queue
-						// TODO: Create a proper priority queue if speed ever becomes an issue here
-						size_t idx = 0;
-						while( ( idx < sb_Count( state->sbFrontier ) ) && ( asfd.cost < state->sbFrontier[idx].cost ) ) {
-							++idx;
-						}
-						sb_Insert( state->sbFrontier, idx, asfd );
-					}
-					neighbor = state->nextNeighbor( state->graph, front.loc, neighbor );
-				}
-			}
-		}
-
+	// only hand out the path once, when the search finishes
+	if( !state->context.searching ) {
+		return true;
+	}
 
-		if( numSteps > 0 ) --numSteps;
-		done = ( numSteps == 0 );
+	bool processingDone = aStar_StepSearch( &( state->context ), numSteps );
+	if( processingDone ) {
+		aStar_GetPath( &( state->context ), sbOutPaths );
 	}
 
 	return processingDone;
@@ -137,9 +355,6 @@ bool aStar_ProcessPath( AStarSearchState* state, int numSteps, int** sbOutPaths
 // cleans up all the extra data created by the search state
 void aStar_CleanUpSearchState( AStarSearchState* state )
 {
-	sb_Release( state->sbFrontier );
-	state->sbFrontier = NULL;
-
-	sb_Release( state->sbPath );
-	state->sbPath = NULL;
+	aStar_CleanUpContext( &( state->context ) );
+	state->valid = false;
 }
\ No newline at end of file
@@ -4,18 +4,9 @@
 #include <stdbool.h>
 #include <stdarg.h>
 #include <stddef.h>
+#include <stdint.h>
 
 // generic implementation of A*
-typedef struct {
-	int loc;
-	float cost;
-} AStarFrontierData;
-
-typedef struct {
-	int from;
-	float cost;
-} AStarPathData;
-
 typedef float (*AStar_CostFunc)( void* graph, int fromNodeID, int toNodeID );
 
 // uses -1 as a flag value for no neighbor, it's passed into currNeighborNodeID at the start and should
@@ -23,17 +14,97 @@ typedef float (*AStar_CostFunc)( void* graph, int fromNodeID, int toNodeID );
 typedef int (*AStar_GetNextNeighborFunc)( void* graph, int nodeID, int currNeighborNodeID );
 
 typedef struct {
-	AStarFrontierData* sbFrontier;
-	AStarPathData* sbPath;
+	float cost; // cost to get here from the start
+	float priority; // cost plus the heuristic
+	int from;
+	int heapIndex; // -1 if it's not in the open heap
+	uint32_t generation;
+} AStarNodeRecord;
 
-	int startNodeID;
-	int targetNodeID;
+// Holds everything a search needs so it can be reused between searches. Node records are stamped with the generation
+//  of the search that last touched them and anything with an older stamp is treated as unvisited, so starting a new
+//  search doesn't have to clear anything. Once the buffers have grown to fit the graph searches won't allocate.
+// The open set is an indexed 4-ary heap, so updating the cost of a node already in it doesn't have to search for it.
+typedef struct {
+	AStarNodeRecord* sbNodes;
+	int* sbOpenHeap;
+
+	uint32_t generation;
 
 	void* graph;
+	size_t nodeCount;
+
+	int startNodeID;
+	int targetNodeID;
 
 	AStar_CostFunc moveCost;
 	AStar_CostFunc heuristic;
 	AStar_GetNextNeighborFunc nextNeighbor;
+
+	bool searching;
+	bool found;
+
+	// number of nodes taken off the open heap during the current search
+	uint32_t numExpansions;
+} AStarContext;
+
+/*
+General usage:
+	AStarContext context;
+	aStar_InitContext( &context );
+	...
+	int* sbPath = NULL;
+	if( aStar_FindPath( &context, graph, graphSize, start, target, nodeDist, nodeDist, nextNeighbor, &sbPath ) ) {
+		processPath( sbPath );
+	}
+	sb_Release( sbPath );
+	...
+	aStar_CleanUpContext( &context );
+*/
+
+void aStar_InitContext( AStarContext* context );
+void aStar_CleanUpContext( AStarContext* context );
+
+// sets up a new search, if moveCost or heuristic are NULL every move costs 1
+//  returns false if the start or target aren't valid nodes
+// NOTE: nodeCount has to be greater than the highest node id possible for graph to return
+bool aStar_StartSearch( AStarContext* context, void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
+	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor );
+
+// expands numSteps nodes of the current search, pass in -1 for numSteps to go until the end
+//  returns whether the search is done
+bool aStar_StepSearch( AStarContext* context, int numSteps );
+
+// if the last search found the target this pushes the path onto sbOutPath, going from the target back to the node
+//  after the start, returns whether a path was found
+bool aStar_GetPath( AStarContext* context, int** sbOutPath );
+
+// starts a search and runs it until it's done, returns whether a path was found and puts it into sbOutPath
+bool aStar_FindPath( AStarContext* context, void* graph, size_t nodeCount, int startNodeID, int targetNodeID,
+	AStar_CostFunc moveCost, AStar_CostFunc heuristic, AStar_GetNextNeighborFunc nextNeighbor, int** sbOutPath );
+
+// Lower level access for searches that generate their own successors, like jump point search. Call
+//  aStar_ResetContext( ), open the start node, then expand whatever aStar_PopOpenNode( ) returns until it's the target
+//  or -1. The records keep the from nodes to build the path with.
+
+// grows the node records to fit nodeCount and starts a new generation, nothing is left open or visited
+void aStar_ResetContext( AStarContext* context, size_t nodeCount );
+
+// gets the record for the node, unvisited nodes have an infinite cost and no from node
+AStarNodeRecord* aStar_GetNodeRecord( AStarContext* context, int nodeID );
+
+// if cost is lower than what the node has now it's recorded and the node is added to or moved up in the open heap
+//  returns whether the node was updated
+bool aStar_OpenNode( AStarContext* context, int nodeID, int fromNodeID, float cost, float heuristic );
+
+// takes the node with the lowest cost plus heuristic out of the open heap, returns -1 if the heap is empty
+int aStar_PopOpenNode( AStarContext* context );
+
+// single use searches, sets up a context for every search, use an AStarContext directly if you're doing a lot of
+//  searches
+typedef struct {
+	AStarContext context;
+	bool valid;
 } AStarSearchState;
 
 /*
@@ -0,0 +1,737 @@
+#include "flowField.h"
+
+#include <float.h>
+#include <math.h>
+#include <SDL3/SDL.h>
+
+#include "hexGrid.h"
+#include "helpers.h"
+#include "stretchyBuffer.h"
+#include "Math/mathUtil.h"
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+
+#define TILE_SIZE 32
+#define TILE_CELLS ( TILE_SIZE * TILE_SIZE )
+
+#define DEFAULT_MAX_UNUSED_FIELDS 8
+
+#define SQRT_2 1.41421356f
+
+// how far past the lowest waiting cost to spread each round, in tiles at a cost of 1
+#define FRONT_WIDTH 4.0f
+
+#define SIDE_LEFT 0x1
+#define SIDE_RIGHT 0x2
+#define SIDE_TOP 0x4
+#define SIDE_BOTTOM 0x8
+
+// clockwise from east, the odd ones are diagonal
+static const int squareDirX[] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int squareDirY[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+// returns the neighbor of the cell at x, y in the direction, -1 if it's off the map, blocked, or would cut a corner
+static int getNeighbor( const FlowFieldMap* map, int x, int y, int dir, int* outX, int* outY, float* outDist )
+{
+	if( map->layout == FFL_SQUARE ) {
+		int nx = x + squareDirX[dir];
+		int ny = y + squareDirY[dir];
+		if( ( nx < 0 ) || ( ny < 0 ) || ( nx >= map->width ) || ( ny >= map->height ) ) return -1;
+
+		int neighbor = nx + ( ny * map->width );
+		if( map->costs[neighbor] == FLOW_BLOCKED ) return -1;
+
+		if( ( dir & 1 ) != 0 ) {
+			if( ( map->costs[nx + ( y * map->width )] == FLOW_BLOCKED ) || ( map->costs[x + ( ny * map->width )] == FLOW_BLOCKED ) ) {
+				return -1;
+			}
+			( *outDist ) = SQRT_2;
+		} else {
+			( *outDist ) = 1.0f;
+		}
+		( *outX ) = nx;
+		( *outY ) = ny;
+		return neighbor;
+	}
+
+	// same as hex_RectIndexToCoord( ) without having to divide
+	HexGridCoord coord;
+	coord.q = x - ( y / 2 );
+	coord.r = y;
+	coord = hex_GetNeighbor( coord, dir );
+	if( !hex_CoordInRect( coord, map->width, map->height ) ) return -1;
+
+	int neighbor = (int)hex_CoordToRectIndex( coord, map->width, map->height );
+	if( map->costs[neighbor] == FLOW_BLOCKED ) return -1;
+
+	( *outDist ) = 1.0f;
+	( *outX ) = coord.q + ( coord.r / 2 );
+	( *outY ) = coord.r;
+	return neighbor;
+}
+
+// ***** Parallel tiles
+
+typedef void (*FlowTaskFunc)( void* ctx, int idx );
+
+typedef struct {
+	FlowTaskFunc func;
+	void* ctx;
+	int count;
+	SDL_AtomicInt nextIdx;
+	SDL_AtomicInt lanesDone;
+} FlowTaskSet;
+
+static void flowTaskLane( void* data )
+{
+	FlowTaskSet* set = (FlowTaskSet*)data;
+
+	int idx = SDL_AddAtomicInt( &( set->nextIdx ), 1 );
+	while( idx < set->count ) {
+		set->func( set->ctx, idx );
+		idx = SDL_AddAtomicInt( &( set->nextIdx ), 1 );
+	}
+
+	SDL_AddAtomicInt( &( set->lanesDone ), 1 );
+}
+
+// calls func for every index in [0,count), spread across the job queue, and waits for them all to finish
+static void runFlowTasks( FlowTaskFunc func, void* ctx, int count )
+{
+	if( count <= 0 ) return;
+
+	FlowTaskSet set;
+	set.func = func;
+	set.ctx = ctx;
+	set.count = count;
+	SDL_SetAtomicInt( &( set.nextIdx ), 0 );
+	SDL_SetAtomicInt( &( set.lanesDone ), 0 );
+
+	// not worth the overhead of a job
+	if( count == 1 ) {
+		flowTaskLane( &set );
+		return;
+	}
+
+	int numLanes = MIN( MAX( jq_GetNumThreads( ), 1 ), count );
+	int lanesQueued = 0;
+	for( int i = 0; i < numLanes; ++i ) {
+		if( jq_AddJob( flowTaskLane, &set ) ) {
+			++lanesQueued;
+		}
+	}
+
+	if( lanesQueued == 0 ) {
+		flowTaskLane( &set );
+		return;
+	}
+
+	// help out while waiting so this still finishes if there are no worker threads, the passes are short so only
+	//  give up the rest of the time slice instead of sleeping
+	while( SDL_GetAtomicInt( &( set.lanesDone ) ) < lanesQueued ) {
+		if( !jq_ProcessNextJob( ) ) {
+			SDL_Delay( 0 );
+		}
+	}
+}
+
+typedef struct {
+	uint8_t sides;
+	float lowest; // lowest cost that changed on the edges
+	float remaining; // lowest cost in the tile that wasn't spread
+} TileChange;
+
+typedef struct {
+	FlowFieldMap* map;
+	FlowField* field;
+	float threshold;
+	int* tiles;
+	TileChange* changes;
+} TilePass;
+
+// indexed heap of the cells in a tile by their position in the tile
+typedef struct {
+	int count;
+	int heap[TILE_CELLS];
+	int heapPos[TILE_CELLS]; // -1 if not in the heap
+} TileHeap;
+
+static void tileHeapSwap( TileHeap* heap, int a, int b )
+{
+	int temp = heap->heap[a];
+	heap->heap[a] = heap->heap[b];
+	heap->heap[b] = temp;
+	heap->heapPos[heap->heap[a]] = a;
+	heap->heapPos[heap->heap[b]] = b;
+}
+
+static void tileHeapSiftUp( TileHeap* heap, const float* values, int heapIdx )
+{
+	while( heapIdx > 0 ) {
+		int parentIdx = ( heapIdx - 1 ) / 2;
+		if( values[heap->heap[heapIdx]] >= values[heap->heap[parentIdx]] ) break;
+		tileHeapSwap( heap, heapIdx, parentIdx );
+		heapIdx = parentIdx;
+	}
+}
+
+static void tileHeapSiftDown( TileHeap* heap, const float* values, int heapIdx )
+{
+	for( ;; ) {
+		int best = heapIdx;
+		int left = ( heapIdx * 2 ) + 1;
+		int right = left + 1;
+		if( ( left < heap->count ) && ( values[heap->heap[left]] < values[heap->heap[best]] ) ) best = left;
+		if( ( right < heap->count ) && ( values[heap->heap[right]] < values[heap->heap[best]] ) ) best = right;
+		if( best == heapIdx ) break;
+		tileHeapSwap( heap, heapIdx, best );
+		heapIdx = best;
+	}
+}
+
+// adds the local id or moves it up if it's already in the heap, call after lowering its value
+static void tileHeapUpdate( TileHeap* heap, const float* values, int localID )
+{
+	if( heap->heapPos[localID] < 0 ) {
+		heap->heap[heap->count] = localID;
+		heap->heapPos[localID] = heap->count;
+		++heap->count;
+	}
+	tileHeapSiftUp( heap, values, heap->heapPos[localID] );
+}
+
+static int tileHeapPop( TileHeap* heap, const float* values )
+{
+	int localID = heap->heap[0];
+	--heap->count;
+	if( heap->count > 0 ) {
+		tileHeapSwap( heap, 0, heap->count );
+		tileHeapSiftDown( heap, values, 0 );
+	}
+	heap->heapPos[localID] = -1;
+	return localID;
+}
+
+// if the cell is on the edge of the tile the tiles next to it will have to be processed again
+static void trackChange( TileChange* change, int x, int y, int x0, int y0, int x1, int y1, float value )
+{
+	uint8_t sides = 0;
+	if( x == x0 ) sides |= SIDE_LEFT;
+	if( x == ( x1 - 1 ) ) sides |= SIDE_RIGHT;
+	if( y == y0 ) sides |= SIDE_TOP;
+	if( y == ( y1 - 1 ) ) sides |= SIDE_BOTTOM;
+	if( sides == 0 ) return;
+
+	change->sides |= sides;
+	change->lowest = MIN( change->lowest, value );
+}
+
+// Dijkstra inside the tile up to the pass threshold, seeded with the goal, any improvements from the cells around it,
+//  and anything left over from the last time. Only writes to cells in the tile and only reads the tiles around it, so
+//  tiles that aren't touching can be done at the same time.
+static void integrateTile( void* ctx, int idx )
+{
+	TilePass* pass = (TilePass*)ctx;
+	FlowFieldMap* map = pass->map;
+	float* integration = pass->field->integration;
+	const uint8_t* costs = map->costs;
+
+	int tile = pass->tiles[idx];
+	int x0 = ( tile % map->tilesWide ) * TILE_SIZE;
+	int y0 = ( tile / map->tilesWide ) * TILE_SIZE;
+	int x1 = MIN( x0 + TILE_SIZE, map->width );
+	int y1 = MIN( y0 + TILE_SIZE, map->height );
+	int tileWidth = x1 - x0;
+
+	// work on a copy of the tile so the heap doesn't have to look through the whole field
+	TileHeap heap;
+	float values[TILE_CELLS];
+	heap.count = 0;
+	for( int y = y0; y < y1; ++y ) {
+		int localRow = ( y - y0 ) * tileWidth;
+		for( int x = x0; x < x1; ++x ) {
+			values[localRow + ( x - x0 )] = integration[x + ( y * map->width )];
+			heap.heapPos[localRow + ( x - x0 )] = -1;
+		}
+	}
+
+	float prevBound = map->tileBounds[tile];
+	TileChange changed = { 0, FLT_MAX, FLT_MAX };
+	for( int y = y0; y < y1; ++y ) {
+		for( int x = x0; x < x1; ++x ) {
+			int cell = x + ( y * map->width );
+			if( costs[cell] == FLOW_BLOCKED ) continue;
+
+			int localID = ( x - x0 ) + ( ( y - y0 ) * tileWidth );
+			float best = values[localID];
+			if( cell == pass->field->goal ) {
+				best = 0.0f;
+			}
+
+			// only the cells on the edges have neighbors outside the tile
+			if( ( x == x0 ) || ( y == y0 ) || ( x == ( x1 - 1 ) ) || ( y == ( y1 - 1 ) ) ) {
+				for( int dir = 0; dir < map->numDirections; ++dir ) {
+					float dist;
+					int nx, ny;
+					int neighbor = getNeighbor( map, x, y, dir, &nx, &ny, &dist );
+					if( ( neighbor < 0 ) || ( integration[neighbor] == FLT_MAX ) ) continue;
+					if( ( nx >= x0 ) && ( nx < x1 ) && ( ny >= y0 ) && ( ny < y1 ) ) continue;
+
+					best = MIN( best, integration[neighbor] + ( dist * (float)costs[neighbor] ) );
+				}
+			}
+
+			if( best < values[localID] ) {
+				values[localID] = best;
+				tileHeapUpdate( &heap, values, localID );
+				trackChange( &changed, x, y, x0, y0, x1, y1, best );
+			} else if( ( best != FLT_MAX ) && ( best >= prevBound ) ) {
+				// wasn't spread last time
+				tileHeapUpdate( &heap, values, localID );
+			}
+		}
+	}
+
+	while( ( heap.count > 0 ) && ( values[heap.heap[0]] <= pass->threshold ) ) {
+		int localID = tileHeapPop( &heap, values );
+		int x = x0 + ( localID % tileWidth );
+		int y = y0 + ( localID / tileWidth );
+		float cellCost = (float)costs[x + ( y * map->width )];
+
+		for( int dir = 0; dir < map->numDirections; ++dir ) {
+			float dist;
+			int nx, ny;
+			if( getNeighbor( map, x, y, dir, &nx, &ny, &dist ) < 0 ) continue;
+			if( ( nx < x0 ) || ( nx >= x1 ) || ( ny < y0 ) || ( ny >= y1 ) ) continue;
+
+			// moving from the neighbor into this cell
+			int neighborID = ( nx - x0 ) + ( ( ny - y0 ) * tileWidth );
+			float cost = values[localID] + ( dist * cellCost );
+			if( cost < values[neighborID] ) {
+				values[neighborID] = cost;
+				tileHeapUpdate( &heap, values, neighborID );
+				trackChange( &changed, nx, ny, x0, y0, x1, y1, cost );
+			}
+		}
+	}
+
+	for( int y = y0; y < y1; ++y ) {
+		SDL_memcpy( &( integration[x0 + ( y * map->width )] ), &( values[( y - y0 ) * tileWidth] ), sizeof( float ) * (size_t)tileWidth );
+	}
+
+	if( heap.count > 0 ) {
+		changed.remaining = values[heap.heap[0]];
+	}
+	map->tileBounds[tile] = changed.remaining;
+	pass->changes[idx] = changed;
+}
+
+// points every cell at the neighbor that's cheapest to get to the goal through
+static void buildTileDirections( void* ctx, int idx )
+{
+	TilePass* pass = (TilePass*)ctx;
+	const FlowFieldMap* map = pass->map;
+	const float* integration = pass->field->integration;
+	int8_t* directions = pass->field->directions;
+
+	int x0 = ( idx % map->tilesWide ) * TILE_SIZE;
+	int y0 = ( idx / map->tilesWide ) * TILE_SIZE;
+	int x1 = MIN( x0 + TILE_SIZE, map->width );
+	int y1 = MIN( y0 + TILE_SIZE, map->height );
+
+	for( int y = y0; y < y1; ++y ) {
+		for( int x = x0; x < x1; ++x ) {
+			int cell = x + ( y * map->width );
+			directions[cell] = -1;
+			if( ( cell == pass->field->goal ) || ( integration[cell] == FLT_MAX ) ) continue;
+
+			float best = FLT_MAX;
+			for( int dir = 0; dir < map->numDirections; ++dir ) {
+				float dist;
+				int nx, ny;
+				int neighbor = getNeighbor( map, x, y, dir, &nx, &ny, &dist );
+				if( ( neighbor < 0 ) || ( integration[neighbor] == FLT_MAX ) ) continue;
+
+				float cost = integration[neighbor] + ( dist * (float)map->costs[neighbor] );
+				if( cost < best ) {
+					best = cost;
+					directions[cell] = (int8_t)dir;
+				}
+			}
+		}
+	}
+}
+
+// marks the tiles next to the sides of the tile that changed
+static void markNeighborTiles( FlowFieldMap* map, int tile, const TileChange* change )
+{
+	uint8_t sides = change->sides;
+	int tx = tile % map->tilesWide;
+	int ty = tile / map->tilesWide;
+	for( int dy = -1; dy <= 1; ++dy ) {
+		for( int dx = -1; dx <= 1; ++dx ) {
+			if( ( dx == 0 ) && ( dy == 0 ) ) continue;
+			if( ( dx < 0 ) && !( sides & SIDE_LEFT ) ) continue;
+			if( ( dx > 0 ) && !( sides & SIDE_RIGHT ) ) continue;
+			if( ( dy < 0 ) && !( sides & SIDE_TOP ) ) continue;
+			if( ( dy > 0 ) && !( sides & SIDE_BOTTOM ) ) continue;
+
+			int nx = tx + dx;
+			int ny = ty + dy;
+			if( ( nx < 0 ) || ( ny < 0 ) || ( nx >= map->tilesWide ) || ( ny >= map->tilesHigh ) ) continue;
+			int neighborTile = nx + ( ny * map->tilesWide );
+			map->tileKeys[neighborTile] = MIN( map->tileKeys[neighborTile], change->lowest );
+		}
+	}
+}
+
+static void buildField( FlowFieldMap* map, FlowField* field )
+{
+	size_t numCells = (size_t)( map->width * map->height );
+	size_t numTiles = (size_t)( map->tilesWide * map->tilesHigh );
+	for( size_t i = 0; i < numCells; ++i ) {
+		field->integration[i] = FLT_MAX;
+	}
+	for( size_t i = 0; i < numTiles; ++i ) {
+		map->tileKeys[i] = FLT_MAX;
+		map->tileBounds[i] = FLT_MAX;
+	}
+
+	map->numRounds = 0;
+	map->numTilesProcessed = 0;
+
+	TilePass pass;
+	pass.map = map;
+	pass.field = field;
+
+	if( map->costs[field->goal] != FLOW_BLOCKED ) {
+		int goalX = field->goal % map->width;
+		int goalY = field->goal / map->width;
+		map->tileKeys[( goalX / TILE_SIZE ) + ( ( goalY / TILE_SIZE ) * map->tilesWide )] = 0.0f;
+	}
+
+	int* sbTiles = NULL;
+	TileChange* sbChanges = NULL;
+	for( ;; ) {
+		float lowestKey = FLT_MAX;
+		for( size_t i = 0; i < numTiles; ++i ) {
+			lowestKey = MIN( lowestKey, map->tileKeys[i] );
+		}
+		if( lowestKey == FLT_MAX ) break;
+
+		// only the tiles near the front, anything further out would probably just get overwritten
+		pass.threshold = lowestKey + ( TILE_SIZE * FRONT_WIDTH );
+		++map->numRounds;
+
+		// tiles with the same phase are never next to each other
+		for( int phase = 0; phase < 4; ++phase ) {
+			sb_Clear( sbTiles );
+			for( int ty = ( phase >> 1 ); ty < map->tilesHigh; ty += 2 ) {
+				for( int tx = ( phase & 1 ); tx < map->tilesWide; tx += 2 ) {
+					int tile = tx + ( ty * map->tilesWide );
+					if( map->tileKeys[tile] <= pass.threshold ) {
+						map->tileKeys[tile] = FLT_MAX;
+						sb_Push( sbTiles, tile );
+					}
+				}
+			}
+
+			int count = (int)sb_Count( sbTiles );
+			if( count == 0 ) continue;
+
+			sb_Clear( sbChanges );
+			sb_Add( sbChanges, count );
+			pass.tiles = sbTiles;
+			pass.changes = sbChanges;
+			runFlowTasks( integrateTile, &pass, count );
+
+			for( int i = 0; i < count; ++i ) {
+				if( sbChanges[i].sides != 0 ) {
+					markNeighborTiles( map, sbTiles[i], &( sbChanges[i] ) );
+				}
+				map->tileKeys[sbTiles[i]] = MIN( map->tileKeys[sbTiles[i]], sbChanges[i].remaining );
+			}
+			map->numTilesProcessed += (uint32_t)count;
+		}
+	}
+	sb_Release( sbTiles );
+	sb_Release( sbChanges );
+
+	runFlowTasks( buildTileDirections, &pass, (int)numTiles );
+
+	field->stale = false;
+}
+
+// ***** Cache
+
+static void destroyField( FlowField* field )
+{
+	mem_Release( field->integration );
+	mem_Release( field->directions );
+	mem_Release( field );
+}
+
+static FlowField* createField( FlowFieldMap* map, int goal )
+{
+	size_t numCells = (size_t)( map->width * map->height );
+
+	FlowField* field = mem_Allocate( sizeof( FlowField ) );
+	if( field == NULL ) return NULL;
+
+	field->goal = goal;
+	field->refCount = 0;
+	field->stale = true;
+	field->lastUsed = 0;
+	field->integration = mem_Allocate( sizeof( float ) * numCells );
+	field->directions = mem_Allocate( sizeof( int8_t ) * numCells );
+	if( ( field->integration == NULL ) || ( field->directions == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate flow field for %ix%i map.", map->width, map->height );
+		destroyField( field );
+		return NULL;
+	}
+
+	return field;
+}
+
+// throws away the least recently used fields that no one is using until there are few enough
+static void trimUnusedFields( FlowFieldMap* map )
+{
+	for( ;; ) {
+		int numUnused = 0;
+		int oldest = -1;
+		for( size_t i = 0; i < sb_Count( map->sbFields ); ++i ) {
+			if( map->sbFields[i]->refCount > 0 ) continue;
+			++numUnused;
+			if( ( oldest < 0 ) || ( map->sbFields[i]->lastUsed < map->sbFields[oldest]->lastUsed ) ) {
+				oldest = (int)i;
+			}
+		}
+
+		if( numUnused <= map->maxUnusedFields ) return;
+
+		destroyField( map->sbFields[oldest] );
+		sb_Remove( map->sbFields, oldest );
+	}
+}
+
+// ***** Interface
+
+bool flow_CreateMap( FlowFieldMap* map, FlowFieldLayout layout, int width, int height, Vector2 origin, float cellSize )
+{
+	ASSERT( map != NULL );
+	ASSERT( width > 0 );
+	ASSERT( height > 0 );
+	ASSERT( cellSize > 0.0f );
+
+	SDL_zerop( map );
+	map->layout = layout;
+	map->width = width;
+	map->height = height;
+	map->origin = origin;
+	map->cellSize = cellSize;
+	map->maxUnusedFields = DEFAULT_MAX_UNUSED_FIELDS;
+
+	if( layout == FFL_SQUARE ) {
+		map->numDirections = 8;
+		for( int i = 0; i < 8; ++i ) {
+			map->directionVectors[i] = vec2( (float)squareDirX[i], (float)squareDirY[i] );
+			vec2_Normalize( &( map->directionVectors[i] ) );
+		}
+	} else {
+		map->numDirections = 6;
+		HexGridCoord center = { 0, 0 };
+		for( int i = 0; i < 6; ++i ) {
+			map->directionVectors[i] = hex_Pointy_GridToPosition( 1.0f, hex_GetNeighbor( center, i ) );
+			vec2_Normalize( &( map->directionVectors[i] ) );
+		}
+	}
+
+	map->tilesWide = ( width + TILE_SIZE - 1 ) / TILE_SIZE;
+	map->tilesHigh = ( height + TILE_SIZE - 1 ) / TILE_SIZE;
+
+	size_t numCells = (size_t)( width * height );
+	map->costs = mem_Allocate( numCells );
+	map->tileKeys = mem_Allocate( sizeof( float ) * (size_t)( map->tilesWide * map->tilesHigh ) );
+	map->tileBounds = mem_Allocate( sizeof( float ) * (size_t)( map->tilesWide * map->tilesHigh ) );
+	if( ( map->costs == NULL ) || ( map->tileKeys == NULL ) || ( map->tileBounds == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate flow field map of %ix%i cells.", width, height );
+		flow_DestroyMap( map );
+		return false;
+	}
+	SDL_memset( map->costs, 1, numCells );
+
+	return true;
+}
+
+void flow_DestroyMap( FlowFieldMap* map )
+{
+	ASSERT( map != NULL );
+
+	for( size_t i = 0; i < sb_Count( map->sbFields ); ++i ) {
+		if( map->sbFields[i]->refCount > 0 ) {
+			llog( LOG_WARN, "Destroying flow field map while the field for cell %i is still in use.", map->sbFields[i]->goal );
+		}
+		destroyField( map->sbFields[i] );
+	}
+	sb_Release( map->sbFields );
+
+	mem_Release( map->costs );
+	mem_Release( map->tileKeys );
+	mem_Release( map->tileBounds );
+	map->costs = NULL;
+	map->tileKeys = NULL;
+	map->tileBounds = NULL;
+}
+
+void flow_SetCost( FlowFieldMap* map, int cell, uint8_t cost )
+{
+	ASSERT( map != NULL );
+	ASSERT( ( cell >= 0 ) && ( cell < ( map->width * map->height ) ) );
+
+	cost = MAX( cost, 1 );
+	if( map->costs[cell] == cost ) return;
+
+	map->costs[cell] = cost;
+	for( size_t i = 0; i < sb_Count( map->sbFields ); ++i ) {
+		map->sbFields[i]->stale = true;
+	}
+}
+
+void flow_SetAllCosts( FlowFieldMap* map, const uint8_t* costs )
+{
+	ASSERT( map != NULL );
+	ASSERT( costs != NULL );
+
+	size_t numCells = (size_t)( map->width * map->height );
+	for( size_t i = 0; i < numCells; ++i ) {
+		map->costs[i] = MAX( costs[i], 1 );
+	}
+	for( size_t i = 0; i < sb_Count( map->sbFields ); ++i ) {
+		map->sbFields[i]->stale = true;
+	}
+}
+
+uint8_t flow_GetCost( const FlowFieldMap* map, int cell )
+{
+	ASSERT( map != NULL );
+	ASSERT( ( cell >= 0 ) && ( cell < ( map->width * map->height ) ) );
+	return map->costs[cell];
+}
+
+void flow_Update( FlowFieldMap* map )
+{
+	ASSERT( map != NULL );
+
+	for( size_t i = 0; i < sb_Count( map->sbFields ); ) {
+		FlowField* field = map->sbFields[i];
+		if( !field->stale ) {
+			++i;
+		} else if( field->refCount > 0 ) {
+			buildField( map, field );
+			++i;
+		} else {
+			destroyField( field );
+			sb_Remove( map->sbFields, i );
+		}
+	}
+}
+
+FlowField* flow_Acquire( FlowFieldMap* map, int goal )
+{
+	ASSERT( map != NULL );
+
+	if( ( goal < 0 ) || ( goal >= ( map->width * map->height ) ) ) return NULL;
+
+	FlowField* field = NULL;
+	for( size_t i = 0; ( i < sb_Count( map->sbFields ) ) && ( field == NULL ); ++i ) {
+		if( map->sbFields[i]->goal == goal ) {
+			field = map->sbFields[i];
+		}
+	}
+
+	if( field == NULL ) {
+		field = createField( map, goal );
+		if( field == NULL ) return NULL;
+		sb_Push( map->sbFields, field );
+	}
+
+	if( field->stale ) {
+		buildField( map, field );
+	}
+
+	++field->refCount;
+	field->lastUsed = ++map->useCounter;
+	trimUnusedFields( map );
+
+	return field;
+}
+
+void flow_Release( FlowFieldMap* map, FlowField* field )
+{
+	ASSERT( map != NULL );
+	if( field == NULL ) return;
+
+	ASSERT_AND_IF_NOT( field->refCount > 0 ) return;
+	--field->refCount;
+	field->lastUsed = ++map->useCounter;
+	trimUnusedFields( map );
+}
+
+int flow_PositionToCell( const FlowFieldMap* map, Vector2 pos )
+{
+	ASSERT( map != NULL );
+
+	if( map->layout == FFL_SQUARE ) {
+		int x = (int)floorf( ( pos.x - map->origin.x ) / map->cellSize );
+		int y = (int)floorf( ( pos.y - map->origin.y ) / map->cellSize );
+		if( ( x < 0 ) || ( y < 0 ) || ( x >= map->width ) || ( y >= map->height ) ) return -1;
+		return x + ( y * map->width );
+	}
+
+	Vector2 local;
+	vec2_Subtract( &pos, &( map->origin ), &local );
+	HexGridCoord coord = hex_Pointy_PositionToGrid( map->cellSize, local );
+	if( !hex_CoordInRect( coord, map->width, map->height ) ) return -1;
+	return (int)hex_CoordToRectIndex( coord, map->width, map->height );
+}
+
+Vector2 flow_CellCenter( const FlowFieldMap* map, int cell )
+{
+	ASSERT( map != NULL );
+
+	Vector2 center;
+	if( map->layout == FFL_SQUARE ) {
+		center.x = map->origin.x + ( ( (float)( cell % map->width ) + 0.5f ) * map->cellSize );
+		center.y = map->origin.y + ( ( (float)( cell / map->width ) + 0.5f ) * map->cellSize );
+	} else {
+		center = hex_Pointy_GridToPosition( map->cellSize, hex_RectIndexToCoord( (uint32_t)cell, map->width, map->height ) );
+		vec2_Add( &center, &( map->origin ), &center );
+	}
+	return center;
+}
+
+int flow_GetNextCell( const FlowFieldMap* map, const FlowField* field, int cell )
+{
+	ASSERT( map != NULL );
+	ASSERT( field != NULL );
+
+	if( ( cell < 0 ) || ( cell >= ( map->width * map->height ) ) || ( field->directions[cell] < 0 ) ) return -1;
+
+	float dist;
+	int nx, ny;
+	return getNeighbor( map, cell % map->width, cell / map->width, field->directions[cell], &nx, &ny, &dist );
+}
+
+bool flow_GetDirection( const FlowFieldMap* map, const FlowField* field, Vector2 pos, Vector2* outDir )
+{
+	ASSERT( map != NULL );
+	ASSERT( field != NULL );
+	ASSERT( outDir != NULL );
+
+	int cell = flow_PositionToCell( map, pos );
+	if( ( cell < 0 ) || ( field->directions[cell] < 0 ) ) return false;
+
+	( *outDir ) = map->directionVectors[field->directions[cell]];
+	return true;
+}
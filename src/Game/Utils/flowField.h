@@ -0,0 +1,99 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Math/vector2.h"
+
+// Flow fields for lots of agents heading to the same place. Instead of every agent searching for its own path, the cost
+//  to reach the goal is found for every cell once (the integration field) and each cell stores which neighbor to move
+//  to next (the direction field), so getting an agent's direction is just a lookup.
+//
+// Works on square grids, eight directions with no cutting corners, and on the pointy topped hex layout used by
+//  hex_CoordInRect( ) and hex_CoordToRectIndex( ). Cells are indexed the same way as the rectangular array in both.
+//  Moving into a cell costs its cost times the distance moved.
+//
+// The integration field is built by splitting the map into tiles and running Dijkstra inside each tile, seeded from
+//  the neighboring tiles, over and over until nothing changes. Tiles that don't touch each other are done at the same
+//  time on the job queue. Each round only spreads costs up to a bit past the lowest one waiting anywhere on the map,
+//  tiles stop there and pick up where they left off later, so they aren't filled in with costs that are just going to
+//  be replaced. The end result is the same as running Dijkstra over the whole map.
+//
+// Fields are cached by goal and reference counted, agents going to the same goal share one field. Fields that are no
+//  longer referenced are kept around in case someone wants them again until there are too many.
+
+#define FLOW_BLOCKED 255
+
+typedef enum {
+	FFL_SQUARE,
+	FFL_HEX
+} FlowFieldLayout;
+
+typedef struct {
+	int goal;
+	int refCount;
+	bool stale;
+	uint32_t lastUsed;
+
+	float* integration; // cost to get to the goal from each cell, FLT_MAX if it can't
+	int8_t* directions; // which neighbor to move to, -1 for the goal and cells that can't reach it
+} FlowField;
+
+typedef struct {
+	FlowFieldLayout layout;
+	int width;
+	int height;
+	uint8_t* costs; // 1 to 254, or FLOW_BLOCKED
+
+	// for converting between world positions and cells, for hex maps cellSize is the size of the hexes
+	Vector2 origin;
+	float cellSize;
+
+	int numDirections;
+	Vector2 directionVectors[8];
+
+	int tilesWide;
+	int tilesHigh;
+	float* tileKeys; // lowest cost waiting to be spread in or next to each tile, FLT_MAX if there isn't one
+	float* tileBounds; // every cell in the tile with a cost lower than this has been spread to its neighbors
+
+	FlowField** sbFields;
+	int maxUnusedFields;
+	uint32_t useCounter;
+
+	// for the last field built
+	uint32_t numRounds;
+	uint32_t numTilesProcessed;
+} FlowFieldMap;
+
+// creates a map with every cell costing 1, square cells have their top left corner at origin + ( x, y ) * cellSize,
+//  hex cells are centered on origin + hex_Pointy_GridToPosition( cellSize, coord )
+bool flow_CreateMap( FlowFieldMap* map, FlowFieldLayout layout, int width, int height, Vector2 origin, float cellSize );
+void flow_DestroyMap( FlowFieldMap* map );
+
+// changing costs makes all the fields stale, the ones still in use are rebuilt in flow_Update( )
+void flow_SetCost( FlowFieldMap* map, int cell, uint8_t cost );
+void flow_SetAllCosts( FlowFieldMap* map, const uint8_t* costs );
+uint8_t flow_GetCost( const FlowFieldMap* map, int cell );
+
+// rebuilds any stale fields that are still being used and throws away the stale ones that aren't
+void flow_Update( FlowFieldMap* map );
+
+// gets the field for the goal cell, building it if it isn't cached, returns NULL if the goal isn't valid
+//  every call needs a matching flow_Release( ), the field stays valid until then
+FlowField* flow_Acquire( FlowFieldMap* map, int goal );
+void flow_Release( FlowFieldMap* map, FlowField* field );
+
+// returns the cell the position is in, -1 if it's outside the map
+int flow_PositionToCell( const FlowFieldMap* map, Vector2 pos );
+Vector2 flow_CellCenter( const FlowFieldMap* map, int cell );
+
+// returns the cell to move to next from cell, -1 if cell is the goal or can't reach it
+int flow_GetNextCell( const FlowFieldMap* map, const FlowField* field, int cell );
+
+// gets the unit length direction to move in from the position, returns false if the position isn't in a cell that
+//  can reach the goal or is in the goal cell
+bool flow_GetDirection( const FlowFieldMap* map, const FlowField* field, Vector2 pos, Vector2* outDir );
+
+#endif // inclusion guard
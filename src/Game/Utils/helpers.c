@@ -221,6 +221,15 @@ int nextHighestPowerOfTwo( int v )
 	return v;
 }
 
+uint64_t fnv1aHash( uint64_t hash, const void* data, size_t size )
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	for( size_t i = 0; i < size; ++i ) {
+		hash = ( hash ^ bytes[i] ) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
 xtUUID createRandomUUID( )
 {
 	xtUUID uuid;
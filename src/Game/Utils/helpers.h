@@ -78,6 +78,11 @@ SDL_IOStream* openRWopsCMPFile( const char* filePath, const char* mode, cmp_ctx_
 
 int nextHighestPowerOfTwo( int v );
 
+// FNV-1a, to hash multiple blocks of data together pass the result for the previous block in as hash, the first block
+//  uses FNV1A_START
+#define FNV1A_START 0xcbf29ce484222325ull
+uint64_t fnv1aHash( uint64_t hash, const void* data, size_t size );
+
 typedef struct {
 	uint8_t parts[16];
 } xtUUID;
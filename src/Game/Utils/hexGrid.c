@@ -1,10 +1,14 @@
 #include "hexGrid.h"
 
 #include <math.h>
+#include <string.h>
 #include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_timer.h>
 
 #include "stretchyBuffer.h"
 #include "../Math/mathUtil.h"
+#include "../System/memory.h"
 #include "../System/platformLog.h"
 
 #define SQRT_THREE 1.73205080757f
@@ -155,40 +159,23 @@ void hex_AllInRange( HexGridCoord base, int32_t range, HexGridCoord** sbOutList
 	ASSERT( range >= 0 );
 
 	sb_Clear( *sbOutList );
+	sb_Reserve( ( *sbOutList ), hex_NumInRange( range ) );
 
-	for( int32_t x = -range; x <= range; ++x ) {
-
-		int32_t min = MAX( -range, -x - range );
-		int32_t max = MIN( range, -x + range );
-		for( int32_t y = min; y <= max; ++y ) {
-			int32_t z = -x - y;
-
-			HexGridCoord c;
-			c.q = x;
-			c.r = z;
-
-			add( &base, &c, &c );
-
-			sb_Push( ( *sbOutList ), c );
-		}
+	HexRangeIter iter;
+	HexGridCoord c;
+	for( hex_RangeIterInit( &iter, base, range ); hex_RangeIterNext( &iter, &c ); ) {
+		sb_Push( ( *sbOutList ), c );
 	}
 }
 
-static HexGridCoord hexLerp( HexGridCoord from, HexGridCoord to, float t )
-{
-	return roundHexCoord( lerp( (float)from.q, (float)to.q, t ), lerp( (float)from.r, (float)to.r, t ) );
-}
-
 // Get all hex coords along a line between two hex coords and put them into the stretchy buffer sbOutList
 void hex_AllInLine( HexGridCoord start, HexGridCoord end, HexGridCoord** sbOutList )
 {
 	ASSERT( sbOutList != NULL );
 
-	int32_t dist = hex_Distance( start, end );
-
-	for( int32_t i = 0; i <= dist; ++i ) {
-		float t = ( 1.0f / dist ) * i;
-		HexGridCoord c = hexLerp( start, end, t );
+	HexLineIter iter;
+	HexGridCoord c;
+	for( hex_LineIterInit( &iter, start, end ); hex_LineIterNext( &iter, &c ); ) {
 		sb_Push( ( *sbOutList ), c );
 	}
 }
@@ -199,18 +186,10 @@ void hex_Ring( HexGridCoord center, int32_t range, HexGridCoord** sbOutList )
 	ASSERT( sbOutList != NULL );
 	ASSERT( range > 0 );
 
-	// grab a direction and scale it by range, use the neighbors array
-	//  start at neighbor 4 as that works best when starting with getting neighbor 0 in loop below
-	HexGridCoord c = neighborOffets[4]; 
-	c.q *= range;
-	c.r *= range;
-	add( &center, &c, &c );
-
-	for( int i = 0; i < 6; ++i ) {
-		for( int j = 0; j < range; ++j ) {
-			sb_Push( ( *sbOutList ), c );
-			c = hex_GetNeighbor( c, i );
-		}
+	HexRingIter iter;
+	HexGridCoord c;
+	for( hex_RingIterInit( &iter, center, range ); hex_RingIterNext( &iter, &c ); ) {
+		sb_Push( ( *sbOutList ), c );
 	}
 }
 
@@ -220,6 +199,578 @@ float hex_FlatSize( float size )
 	return SQRT_THREE * size;
 }
 
+size_t hex_NumInRange( int32_t range )
+{
+	if( range < 0 ) return 0;
+	return ( 3 * (size_t)range * ( (size_t)range + 1 ) ) + 1;
+}
+
+//***************************************************************************
+// Spiral offset table
+#define SPIRAL_TABLE_SIZE ( ( 3 * HEX_OFFSET_TABLE_RANGE * ( HEX_OFFSET_TABLE_RANGE + 1 ) ) + 1 )
+static HexGridCoord spiralOffsets[SPIRAL_TABLE_SIZE];
+
+// 0 = not built, 1 = being built, 2 = done
+static SDL_AtomicInt spiralTableState;
+
+static void buildSpiralTable( void )
+{
+	HexGridCoord origin = { 0, 0 };
+	size_t count = 0;
+	spiralOffsets[count++] = origin;
+	for( int32_t ring = 1; ring <= HEX_OFFSET_TABLE_RANGE; ++ring ) {
+		HexRingIter iter;
+		HexGridCoord c;
+		for( hex_RingIterInit( &iter, origin, ring ); hex_RingIterNext( &iter, &c ); ) {
+			spiralOffsets[count++] = c;
+		}
+	}
+	ASSERT( count == SPIRAL_TABLE_SIZE );
+}
+
+const HexGridCoord* hex_GetSpiralOffsets( int32_t range, size_t* outCount )
+{
+	ASSERT( outCount != NULL );
+
+	if( ( range < 0 ) || ( range > HEX_OFFSET_TABLE_RANGE ) ) {
+		( *outCount ) = 0;
+		return NULL;
+	}
+
+	if( SDL_GetAtomicInt( &spiralTableState ) != 2 ) {
+		if( SDL_CompareAndSwapAtomicInt( &spiralTableState, 0, 1 ) ) {
+			buildSpiralTable( );
+			SDL_SetAtomicInt( &spiralTableState, 2 );
+		} else {
+			// another thread is building it, it doesn't take long
+			while( SDL_GetAtomicInt( &spiralTableState ) != 2 ) {
+				SDL_Delay( 0 );
+			}
+		}
+	}
+
+	( *outCount ) = hex_NumInRange( range );
+	return spiralOffsets;
+}
+
+//***************************************************************************
+// Iterators
+void hex_RangeIterInit( HexRangeIter* iter, HexGridCoord base, int32_t range )
+{
+	ASSERT( iter != NULL );
+
+	iter->base = base;
+	iter->range = range;
+	iter->x = -range;
+	iter->y = MAX( -range, -iter->x - range );
+	iter->yMax = MIN( range, -iter->x + range );
+}
+
+bool hex_RangeIterNext( HexRangeIter* iter, HexGridCoord* outCoord )
+{
+	ASSERT( iter != NULL );
+	ASSERT( outCoord != NULL );
+
+	if( iter->x > iter->range ) return false;
+
+	// same as hex_AllInRange( ) used to do, y is the cube coordinate so r = -x - y
+	outCoord->q = iter->base.q + iter->x;
+	outCoord->r = iter->base.r - iter->x - iter->y;
+
+	++iter->y;
+	if( iter->y > iter->yMax ) {
+		++iter->x;
+		iter->y = MAX( -iter->range, -iter->x - iter->range );
+		iter->yMax = MIN( iter->range, -iter->x + iter->range );
+	}
+
+	return true;
+}
+
+void hex_RingIterInit( HexRingIter* iter, HexGridCoord center, int32_t range )
+{
+	ASSERT( iter != NULL );
+	ASSERT( range >= 0 );
+
+	// start at neighbor 4 as that works best when starting with getting neighbor 0 after
+	iter->curr.q = center.q + ( neighborOffets[4].q * range );
+	iter->curr.r = center.r + ( neighborOffets[4].r * range );
+	iter->range = range;
+	iter->side = 0;
+	iter->step = 0;
+}
+
+bool hex_RingIterNext( HexRingIter* iter, HexGridCoord* outCoord )
+{
+	ASSERT( iter != NULL );
+	ASSERT( outCoord != NULL );
+
+	if( iter->side >= 6 ) return false;
+
+	( *outCoord ) = iter->curr;
+
+	if( iter->range == 0 ) {
+		iter->side = 6;
+		return true;
+	}
+
+	iter->curr.q += neighborOffets[iter->side].q;
+	iter->curr.r += neighborOffets[iter->side].r;
+	++iter->step;
+	if( iter->step >= iter->range ) {
+		iter->step = 0;
+		++iter->side;
+	}
+
+	return true;
+}
+
+void hex_SpiralIterInit( HexSpiralIter* iter, HexGridCoord center, int32_t range )
+{
+	ASSERT( iter != NULL );
+
+	iter->center = center;
+	iter->range = range;
+	iter->idx = 0;
+	iter->offsets = hex_GetSpiralOffsets( range, &( iter->count ) );
+	iter->currRing = 0;
+	hex_RingIterInit( &( iter->ring ), center, 0 );
+}
+
+bool hex_SpiralIterNext( HexSpiralIter* iter, HexGridCoord* outCoord )
+{
+	ASSERT( iter != NULL );
+	ASSERT( outCoord != NULL );
+
+	if( iter->range < 0 ) return false;
+
+	if( iter->offsets != NULL ) {
+		if( iter->idx >= iter->count ) return false;
+
+		outCoord->q = iter->center.q + iter->offsets[iter->idx].q;
+		outCoord->r = iter->center.r + iter->offsets[iter->idx].r;
+		++iter->idx;
+		return true;
+	}
+
+	// too big for the table, walk each ring
+	while( !hex_RingIterNext( &( iter->ring ), outCoord ) ) {
+		++iter->currRing;
+		if( iter->currRing > iter->range ) return false;
+		hex_RingIterInit( &( iter->ring ), iter->center, iter->currRing );
+	}
+
+	return true;
+}
+
+void hex_LineIterInit( HexLineIter* iter, HexGridCoord start, HexGridCoord end )
+{
+	ASSERT( iter != NULL );
+
+	iter->startX = start.q;
+	iter->startZ = start.r;
+	iter->diffX = end.q - start.q;
+	iter->diffZ = end.r - start.r;
+	iter->dist = hex_Distance( start, end );
+	iter->step = 0;
+}
+
+// value / denom rounded to the nearest integer, halves away from zero like roundf( )
+static int64_t roundedDivide( int64_t value, int64_t denom )
+{
+	if( value >= 0 ) {
+		return ( ( 2 * value ) + denom ) / ( 2 * denom );
+	}
+	return -( ( ( -2 * value ) + denom ) / ( 2 * denom ) );
+}
+
+static int64_t absInt64( int64_t v )
+{
+	return ( v < 0 ) ? -v : v;
+}
+
+bool hex_LineIterNext( HexLineIter* iter, HexGridCoord* outCoord )
+{
+	ASSERT( iter != NULL );
+	ASSERT( outCoord != NULL );
+
+	if( iter->step > iter->dist ) return false;
+
+	if( iter->dist == 0 ) {
+		outCoord->q = (int32_t)iter->startX;
+		outCoord->r = (int32_t)iter->startZ;
+		++iter->step;
+		return true;
+	}
+
+	// the same as lerping in cube coordinates and rounding, everything is scaled up by the distance so it stays exact
+	int64_t dist = iter->dist;
+	int64_t x = ( iter->startX * dist ) + ( iter->diffX * iter->step );
+	int64_t z = ( iter->startZ * dist ) + ( iter->diffZ * iter->step );
+	int64_t y = -x - z;
+
+	int64_t rx = roundedDivide( x, dist );
+	int64_t ry = roundedDivide( y, dist );
+	int64_t rz = roundedDivide( z, dist );
+
+	int64_t xDiff = absInt64( ( rx * dist ) - x );
+	int64_t yDiff = absInt64( ( ry * dist ) - y );
+	int64_t zDiff = absInt64( ( rz * dist ) - z );
+
+	if( ( xDiff > yDiff ) && ( xDiff > zDiff ) ) {
+		rx = -ry - rz;
+	} else if( yDiff > zDiff ) {
+		ry = -rx - rz;
+	} else {
+		rz = -rx - ry;
+	}
+
+	outCoord->q = (int32_t)rx;
+	outCoord->r = (int32_t)rz;
+	++iter->step;
+
+	return true;
+}
+
+//***************************************************************************
+// Regions
+static int lowestSetBit( uint64_t v )
+{
+	// de Bruijn multiplication, works the same everywhere
+	static const int debruijnIndices[64] = {
+		0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+		62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+		63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+		46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+	};
+	return debruijnIndices[( ( v & ( ~v + 1 ) ) * 0x03f79d71b4cb0a89ull ) >> 58];
+}
+
+static size_t countSetBits( uint64_t v )
+{
+	v = v - ( ( v >> 1 ) & 0x5555555555555555ull );
+	v = ( v & 0x3333333333333333ull ) + ( ( v >> 2 ) & 0x3333333333333333ull );
+	v = ( v + ( v >> 4 ) ) & 0x0f0f0f0f0f0f0f0full;
+	return (size_t)( ( v * 0x0101010101010101ull ) >> 56 );
+}
+
+bool hex_RegionCreate( HexRegion* region, int32_t width, int32_t height )
+{
+	ASSERT( region != NULL );
+	ASSERT( width > 0 );
+	ASSERT( height > 0 );
+
+	region->width = width;
+	region->height = height;
+	region->numWords = ( ( (size_t)width * (size_t)height ) + 63 ) / 64;
+	region->bits = mem_Allocate( sizeof( uint64_t ) * region->numWords );
+	if( region->bits == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate hex region." );
+		region->numWords = 0;
+		return false;
+	}
+
+	hex_RegionClear( region );
+	return true;
+}
+
+void hex_RegionDestroy( HexRegion* region )
+{
+	ASSERT( region != NULL );
+
+	mem_Release( region->bits );
+	region->bits = NULL;
+	region->numWords = 0;
+}
+
+void hex_RegionClear( HexRegion* region )
+{
+	ASSERT( region != NULL );
+
+	if( region->numWords > 0 ) {
+		memset( region->bits, 0, sizeof( uint64_t ) * region->numWords );
+	}
+}
+
+void hex_RegionAdd( HexRegion* region, HexGridCoord coord )
+{
+	ASSERT( region != NULL );
+
+	if( !hex_CoordInRect( coord, region->width, region->height ) ) return;
+
+	uint32_t idx = hex_CoordToRectIndex( coord, region->width, region->height );
+	region->bits[idx / 64] |= ( 1ull << ( idx % 64 ) );
+}
+
+void hex_RegionRemove( HexRegion* region, HexGridCoord coord )
+{
+	ASSERT( region != NULL );
+
+	if( !hex_CoordInRect( coord, region->width, region->height ) ) return;
+
+	uint32_t idx = hex_CoordToRectIndex( coord, region->width, region->height );
+	region->bits[idx / 64] &= ~( 1ull << ( idx % 64 ) );
+}
+
+bool hex_RegionContains( const HexRegion* region, HexGridCoord coord )
+{
+	ASSERT( region != NULL );
+
+	if( !hex_CoordInRect( coord, region->width, region->height ) ) return false;
+
+	uint32_t idx = hex_CoordToRectIndex( coord, region->width, region->height );
+	return ( region->bits[idx / 64] & ( 1ull << ( idx % 64 ) ) ) != 0;
+}
+
+// sets every bit from first to last, including both
+static void setBitRange( HexRegion* region, size_t first, size_t last )
+{
+	size_t firstWord = first / 64;
+	size_t lastWord = last / 64;
+	uint64_t firstMask = ~0ull << ( first % 64 );
+	uint64_t lastMask = ~0ull >> ( 63 - ( last % 64 ) );
+
+	if( firstWord == lastWord ) {
+		region->bits[firstWord] |= ( firstMask & lastMask );
+		return;
+	}
+
+	region->bits[firstWord] |= firstMask;
+	for( size_t w = firstWord + 1; w < lastWord; ++w ) {
+		region->bits[w] = ~0ull;
+	}
+	region->bits[lastWord] |= lastMask;
+}
+
+void hex_RegionAddRange( HexRegion* region, HexGridCoord center, int32_t range )
+{
+	ASSERT( region != NULL );
+	ASSERT( range >= 0 );
+
+	// each row of the range is a run of q, which is a run of bits in the same row of the rectangle
+	int32_t minRow = MAX( center.r - range, 0 );
+	int32_t maxRow = MIN( center.r + range, region->height - 1 );
+	for( int32_t r = minRow; r <= maxRow; ++r ) {
+		int32_t dr = r - center.r;
+		int32_t minQ = center.q + MAX( -range, -dr - range );
+		int32_t maxQ = center.q + MIN( range, -dr + range );
+
+		// same as hex_CoordToRectIndex( )
+		int32_t minCol = MAX( minQ + ( r / 2 ), 0 );
+		int32_t maxCol = MIN( maxQ + ( r / 2 ), region->width - 1 );
+		if( minCol > maxCol ) continue;
+
+		size_t rowStart = (size_t)r * (size_t)region->width;
+		setBitRange( region, rowStart + (size_t)minCol, rowStart + (size_t)maxCol );
+	}
+}
+
+size_t hex_RegionCount( const HexRegion* region )
+{
+	ASSERT( region != NULL );
+
+	size_t count = 0;
+	for( size_t i = 0; i < region->numWords; ++i ) {
+		count += countSetBits( region->bits[i] );
+	}
+	return count;
+}
+
+void hex_RegionUnion( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs )
+{
+	ASSERT( out != NULL );
+	ASSERT( lhs != NULL );
+	ASSERT( rhs != NULL );
+	ASSERT( ( out->numWords == lhs->numWords ) && ( lhs->numWords == rhs->numWords ) );
+
+	for( size_t i = 0; i < out->numWords; ++i ) {
+		out->bits[i] = lhs->bits[i] | rhs->bits[i];
+	}
+}
+
+void hex_RegionIntersect( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs )
+{
+	ASSERT( out != NULL );
+	ASSERT( lhs != NULL );
+	ASSERT( rhs != NULL );
+	ASSERT( ( out->numWords == lhs->numWords ) && ( lhs->numWords == rhs->numWords ) );
+
+	for( size_t i = 0; i < out->numWords; ++i ) {
+		out->bits[i] = lhs->bits[i] & rhs->bits[i];
+	}
+}
+
+void hex_RegionSubtract( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs )
+{
+	ASSERT( out != NULL );
+	ASSERT( lhs != NULL );
+	ASSERT( rhs != NULL );
+	ASSERT( ( out->numWords == lhs->numWords ) && ( lhs->numWords == rhs->numWords ) );
+
+	for( size_t i = 0; i < out->numWords; ++i ) {
+		out->bits[i] = lhs->bits[i] & ~rhs->bits[i];
+	}
+}
+
+void hex_RegionIterInit( HexRegionIter* iter, const HexRegion* region )
+{
+	ASSERT( iter != NULL );
+	ASSERT( region != NULL );
+
+	iter->region = region;
+	iter->word = 0;
+	iter->remaining = ( region->numWords > 0 ) ? region->bits[0] : 0;
+}
+
+bool hex_RegionIterNext( HexRegionIter* iter, HexGridCoord* outCoord )
+{
+	ASSERT( iter != NULL );
+	ASSERT( outCoord != NULL );
+
+	while( iter->remaining == 0 ) {
+		++iter->word;
+		if( iter->word >= iter->region->numWords ) return false;
+		iter->remaining = iter->region->bits[iter->word];
+	}
+
+	size_t idx = ( iter->word * 64 ) + (size_t)lowestSetBit( iter->remaining );
+	iter->remaining &= iter->remaining - 1;
+
+	( *outCoord ) = hex_RectIndexToCoord( (uint32_t)idx, iter->region->width, iter->region->height );
+	return true;
+}
+
+//***************************************************************************
+// Field of view
+//  Angles are measured as how far around a ring a spot is, from 0 to 1, starting at the first hex hex_Ring( ) gives.
+//  Every ring is the same hexagon scaled up, so the same value is in the same direction for every ring. The hex at
+//  index i of ring k covers ( i - 0.5 ) / 6k to ( i + 0.5 ) / 6k, the first one wraps around past 0.
+#define FOV_EPSILON 0.000001f
+
+// every shadow is at least as wide as half a hex in the outer ring, and they never overlap
+#define MAX_FOV_SHADOWS ( ( 6 * HEX_MAX_FOV_RANGE ) + 2 )
+
+typedef struct {
+	float start;
+	float end;
+} FOVShadow;
+
+// adds a shadow that starts at or after the last one
+static void appendShadow( FOVShadow* shadows, size_t* count, float start, float end )
+{
+	if( ( ( *count ) > 0 ) && ( start <= ( shadows[( *count ) - 1].end + FOV_EPSILON ) ) ) {
+		shadows[( *count ) - 1].end = MAX( shadows[( *count ) - 1].end, end );
+		return;
+	}
+
+	ASSERT( ( *count ) < MAX_FOV_SHADOWS );
+	shadows[*count].start = start;
+	shadows[*count].end = end;
+	++( *count );
+}
+
+// the starts are only ever increasing as a ring is checked, so cursor skips everything that ends before them
+static bool isShadowed( const FOVShadow* shadows, size_t count, size_t* cursor, float start, float end )
+{
+	while( ( ( *cursor ) < count ) && ( shadows[*cursor].end < ( start - FOV_EPSILON ) ) ) {
+		++( *cursor );
+	}
+
+	if( ( *cursor ) >= count ) return false;
+	return ( shadows[*cursor].start <= ( start + FOV_EPSILON ) ) && ( shadows[*cursor].end >= ( end - FOV_EPSILON ) );
+}
+
+void hex_FieldOfView( HexGridCoord origin, int32_t range, HexBlocksSightFunc blocksSight, void* data, HexRegion* outVisible )
+{
+	ASSERT( blocksSight != NULL );
+	ASSERT( outVisible != NULL );
+	ASSERT( range >= 0 );
+
+	hex_RegionClear( outVisible );
+	if( !hex_CoordInRect( origin, outVisible->width, outVisible->height ) ) return;
+	hex_RegionAdd( outVisible, origin );
+
+	range = MIN( range, HEX_MAX_FOV_RANGE );
+
+	FOVShadow shadowBuffers[2][MAX_FOV_SHADOWS];
+	FOVShadow newShadows[MAX_FOV_SHADOWS];
+	FOVShadow* shadows = shadowBuffers[0];
+	size_t numShadows = 0;
+
+	for( int32_t ring = 1; ring <= range; ++ring ) {
+		// everything is in shadow
+		if( ( numShadows == 1 ) && ( shadows[0].start <= FOV_EPSILON ) && ( shadows[0].end >= ( 1.0f - FOV_EPSILON ) ) ) break;
+
+		float hexWidth = 1.0f / (float)( 6 * ring );
+		size_t numNew = 0;
+		size_t cursor = 0;
+		bool firstBlocks = false;
+
+		HexRingIter iter;
+		HexGridCoord c;
+		int32_t idx = 0;
+		for( hex_RingIterInit( &iter, origin, ring ); hex_RingIterNext( &iter, &c ); ++idx ) {
+			bool onMap = hex_CoordInRect( c, outVisible->width, outVisible->height );
+			bool blocks = !onMap || blocksSight( c, data );
+
+			float center = (float)idx * hexWidth;
+			float start = ( (float)idx - 0.5f ) * hexWidth;
+			float end = ( (float)idx + 0.5f ) * hexWidth;
+
+			bool visible;
+			if( idx == 0 ) {
+				// split into the part after 0 and the part that wraps around before 1
+				size_t headCursor = 0;
+				size_t tailCursor = ( numShadows > 0 ) ? ( numShadows - 1 ) : 0;
+				if( blocks ) {
+					visible = !( isShadowed( shadows, numShadows, &headCursor, 0.0f, end ) && isShadowed( shadows, numShadows, &tailCursor, 1.0f + start, 1.0f ) );
+				} else {
+					visible = !isShadowed( shadows, numShadows, &headCursor, 0.0f, 0.0f );
+				}
+			} else if( blocks ) {
+				visible = !isShadowed( shadows, numShadows, &cursor, start, end );
+			} else {
+				visible = !isShadowed( shadows, numShadows, &cursor, center, center );
+			}
+
+			if( visible && onMap ) {
+				hex_RegionAdd( outVisible, c );
+			}
+
+			if( blocks ) {
+				if( idx == 0 ) {
+					firstBlocks = true;
+					appendShadow( newShadows, &numNew, 0.0f, end );
+				} else {
+					appendShadow( newShadows, &numNew, start, end );
+				}
+			}
+		}
+
+		if( firstBlocks ) {
+			appendShadow( newShadows, &numNew, 1.0f - ( 0.5f * hexWidth ), 1.0f );
+		}
+
+		// merge the new shadows in with the old ones
+		FOVShadow* merged = ( shadows == shadowBuffers[0] ) ? shadowBuffers[1] : shadowBuffers[0];
+		size_t numMerged = 0;
+		size_t o = 0;
+		size_t n = 0;
+		while( ( o < numShadows ) || ( n < numNew ) ) {
+			if( ( n >= numNew ) || ( ( o < numShadows ) && ( shadows[o].start <= newShadows[n].start ) ) ) {
+				appendShadow( merged, &numMerged, shadows[o].start, shadows[o].end );
+				++o;
+			} else {
+				appendShadow( merged, &numMerged, newShadows[n].start, newShadows[n].end );
+				++n;
+			}
+		}
+
+		shadows = merged;
+		numShadows = numMerged;
+	}
+}
+
 //***************************************************************************
 // Various functions to convert hex coordinates to grid indices
 //  For these we'll assume the hex coord [0,0] corresponds to index 0
@@ -1,6 +1,8 @@
 #ifndef HEX_GRID
 #define HEX_GRID
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "../Math/vector2.h"
 
@@ -68,6 +70,120 @@ void hex_Ring( HexGridCoord center, int32_t range, HexGridCoord** sbOutList );
 // Get the distance from a flat side of the hex to the opposite flat side
 float hex_FlatSize( float size );
 
+// Returns how many hex coords are within range steps of a coord, including the coord itself.
+size_t hex_NumInRange( int32_t range );
+
+// Offsets of every hex coord within range steps of [0,0], starting with [0,0] and then going out ring by ring in the
+//  same order as hex_Ring( ). The table is built the first time it's needed and shared, returns NULL if range is
+//  larger than HEX_OFFSET_TABLE_RANGE.
+#define HEX_OFFSET_TABLE_RANGE 32
+const HexGridCoord* hex_GetSpiralOffsets( int32_t range, size_t* outCount );
+
+//***************************************************************************
+// Iterators, these don't allocate anything so they can be used every frame. Set them up with the Init function and
+//  call Next until it returns false.
+//  for( hex_RangeIterInit( &iter, base, range ); hex_RangeIterNext( &iter, &coord ); ) { ... }
+
+// every hex coord within range steps of base, same order as hex_AllInRange( )
+typedef struct {
+	HexGridCoord base;
+	int32_t range;
+	int32_t x;
+	int32_t y;
+	int32_t yMax;
+} HexRangeIter;
+
+void hex_RangeIterInit( HexRangeIter* iter, HexGridCoord base, int32_t range );
+bool hex_RangeIterNext( HexRangeIter* iter, HexGridCoord* outCoord );
+
+// every hex coord exactly range steps from center, same order as hex_Ring( ), a range of 0 gives just the center
+typedef struct {
+	HexGridCoord curr;
+	int32_t range;
+	int32_t side;
+	int32_t step;
+} HexRingIter;
+
+void hex_RingIterInit( HexRingIter* iter, HexGridCoord center, int32_t range );
+bool hex_RingIterNext( HexRingIter* iter, HexGridCoord* outCoord );
+
+// every hex coord within range steps of center, starting at the center and going out ring by ring
+typedef struct {
+	HexGridCoord center;
+	int32_t range;
+	const HexGridCoord* offsets;
+	size_t idx;
+	size_t count;
+	int32_t currRing;
+	HexRingIter ring;
+} HexSpiralIter;
+
+void hex_SpiralIterInit( HexSpiralIter* iter, HexGridCoord center, int32_t range );
+bool hex_SpiralIterNext( HexSpiralIter* iter, HexGridCoord* outCoord );
+
+// every hex coord along the line from start to end, including both, same as hex_AllInLine( ) but with integer math
+typedef struct {
+	int64_t startX;
+	int64_t startZ;
+	int64_t diffX;
+	int64_t diffZ;
+	int32_t dist;
+	int32_t step;
+} HexLineIter;
+
+void hex_LineIterInit( HexLineIter* iter, HexGridCoord start, HexGridCoord end );
+bool hex_LineIterNext( HexLineIter* iter, HexGridCoord* outCoord );
+
+//***************************************************************************
+// Regions, a set of hex coords on a rectangular map stored as one bit per hex, laid out the same as
+//  hex_CoordToRectIndex( ). Good for things like movement ranges that need to be combined. Combining regions requires
+//  them to be the same size.
+
+typedef struct {
+	int32_t width;
+	int32_t height;
+	size_t numWords;
+	uint64_t* bits;
+} HexRegion;
+
+bool hex_RegionCreate( HexRegion* region, int32_t width, int32_t height );
+void hex_RegionDestroy( HexRegion* region );
+void hex_RegionClear( HexRegion* region );
+
+// coords outside the map are ignored
+void hex_RegionAdd( HexRegion* region, HexGridCoord coord );
+void hex_RegionRemove( HexRegion* region, HexGridCoord coord );
+bool hex_RegionContains( const HexRegion* region, HexGridCoord coord );
+void hex_RegionAddRange( HexRegion* region, HexGridCoord center, int32_t range );
+size_t hex_RegionCount( const HexRegion* region );
+
+// out can be the same as either of the others
+void hex_RegionUnion( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs );
+void hex_RegionIntersect( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs );
+void hex_RegionSubtract( HexRegion* out, const HexRegion* lhs, const HexRegion* rhs );
+
+typedef struct {
+	const HexRegion* region;
+	size_t word;
+	uint64_t remaining;
+} HexRegionIter;
+
+void hex_RegionIterInit( HexRegionIter* iter, const HexRegion* region );
+bool hex_RegionIterNext( HexRegionIter* iter, HexGridCoord* outCoord );
+
+//***************************************************************************
+// Field of view, uses shadow casting going out ring by ring. Each hex covers a range of angles around the origin, once
+//  a hex that blocks sight is seen it shadows everything behind it. Hexes that don't block sight are visible if their
+//  center isn't in shadow, hexes that do are visible if any part of them isn't, so the edges of walls show up.
+//  Hexes off the map block sight. Ranges past HEX_MAX_FOV_RANGE are clamped.
+
+#define HEX_MAX_FOV_RANGE 128
+
+typedef bool (*HexBlocksSightFunc)( HexGridCoord coord, void* data );
+
+// clears outVisible and fills it in with everything visible from origin
+void hex_FieldOfView( HexGridCoord origin, int32_t range, HexBlocksSightFunc blocksSight, void* data, HexRegion* outVisible );
+
 //***************************************************************************
 // Various functions to convert hex coordinates to grid indices
 
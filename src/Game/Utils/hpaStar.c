@@ -0,0 +1,806 @@
+#include "hpaStar.h"
+
+#include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_stdinc.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "Utils/stretchyBuffer.h"
+
+#define SQRT_2 1.41421356f
+
+// entrances this long or longer get a transition at each end instead of one in the middle
+#define LARGE_ENTRANCE_LENGTH 6
+
+// the start and target are searched for directly when the area around them is less than this many clusters across,
+//  going through the entrances adds detours that are a big part of a path that short
+#define DIRECT_SEARCH_CLUSTERS 4
+
+// joining the ends of a query to a cached path can add up to about a cluster of detour at each end, so the cache is
+//  only used when that's small compared to the length of the path
+#define MIN_CACHED_CLUSTER_DISTANCE 3
+
+#define BORDER_RIGHT 0
+#define BORDER_BOTTOM 1
+
+static const int dirX[8] = { 1, 0, -1, 0, 1, -1, -1, 1 };
+static const int dirY[8] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+
+static float octileDistance( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return (float)( dx + dy ) + ( ( SQRT_2 - 2.0f ) * (float)SDL_min( dx, dy ) );
+}
+
+bool hpa_IsWalkable( const HPAMap* map, int x, int y )
+{
+	if( ( x < 0 ) || ( y < 0 ) || ( x >= map->width ) || ( y >= map->height ) ) {
+		return false;
+	}
+	return map->walkable[x + ( y * map->width )] != 0;
+}
+
+static int clusterAt( const HPAMap* map, int x, int y )
+{
+	return ( x / map->clusterSize ) + ( ( y / map->clusterSize ) * map->clustersWide );
+}
+
+static void getClusterBounds( const HPAMap* map, int cluster, int* outLeft, int* outTop, int* outWidth, int* outHeight )
+{
+	( *outLeft ) = ( cluster % map->clustersWide ) * map->clusterSize;
+	( *outTop ) = ( cluster / map->clustersWide ) * map->clusterSize;
+	( *outWidth ) = SDL_min( map->clusterSize, map->width - ( *outLeft ) );
+	( *outHeight ) = SDL_min( map->clusterSize, map->height - ( *outTop ) );
+}
+
+// A* limited to the tiles in the rectangle, if targetTile is -1 it searches the whole rectangle so the costs to every
+//  tile can be read from the local context
+//  pushes the path from the target back to the tile after the start onto sbOutPath if it's not NULL
+static bool searchRect( HPAMap* map, int left, int top, int width, int height, int startTile, int targetTile, int** sbOutPath )
+{
+	AStarContext* context = &( map->localContext );
+	aStar_ResetContext( context, (size_t)( width * height ) );
+
+	int startX = ( startTile % map->width ) - left;
+	int startY = ( startTile / map->width ) - top;
+	int targetX = ( targetTile < 0 ) ? -1 : ( ( targetTile % map->width ) - left );
+	int targetY = ( targetTile < 0 ) ? -1 : ( ( targetTile / map->width ) - top );
+	int startLocal = startX + ( startY * width );
+	int targetLocal = ( targetTile < 0 ) ? -1 : ( targetX + ( targetY * width ) );
+	context->startNodeID = startLocal;
+	context->targetNodeID = targetLocal;
+
+	aStar_OpenNode( context, startLocal, startLocal, 0.0f, ( targetLocal < 0 ) ? 0.0f : octileDistance( targetX - startX, targetY - startY ) );
+
+	bool found = false;
+	int currentLocal;
+	while( ( currentLocal = aStar_PopOpenNode( context ) ) != -1 ) {
+		if( currentLocal == targetLocal ) {
+			found = true;
+			break;
+		}
+
+		int x = currentLocal % width;
+		int y = currentLocal / width;
+		float currentCost = aStar_GetNodeRecord( context, currentLocal )->cost;
+		for( int dir = 0; dir < 8; ++dir ) {
+			int nextX = x + dirX[dir];
+			int nextY = y + dirY[dir];
+			if( ( nextX < 0 ) || ( nextY < 0 ) || ( nextX >= width ) || ( nextY >= height ) ) continue;
+			if( !map->walkable[( left + nextX ) + ( ( top + nextY ) * map->width )] ) continue;
+
+			float step = 1.0f;
+			if( dir >= 4 ) {
+				// no cutting corners, both tiles are always inside the rectangle
+				if( !map->walkable[( left + nextX ) + ( ( top + y ) * map->width )] ||
+					!map->walkable[( left + x ) + ( ( top + nextY ) * map->width )] ) {
+					continue;
+				}
+				step = SQRT_2;
+			}
+
+			float heuristic = ( targetLocal < 0 ) ? 0.0f : octileDistance( targetX - nextX, targetY - nextY );
+			aStar_OpenNode( context, nextX + ( nextY * width ), currentLocal, currentCost + step, heuristic );
+		}
+	}
+
+	if( targetLocal < 0 ) {
+		return true;
+	}
+
+	if( found && ( sbOutPath != NULL ) ) {
+		int current = targetLocal;
+		while( current != startLocal ) {
+			sb_Push( ( *sbOutPath ), ( left + ( current % width ) ) + ( ( top + ( current / width ) ) * map->width ) );
+			current = context->sbNodes[current].from;
+		}
+	}
+
+	return found;
+}
+
+static bool searchCluster( HPAMap* map, int cluster, int startTile, int targetTile, int** sbOutPath )
+{
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+	return searchRect( map, left, top, width, height, startTile, targetTile, sbOutPath );
+}
+
+static void truncatePath( int** sbPath, size_t count )
+{
+	while( sb_Count( *sbPath ) > count ) {
+		sb_Pop( *sbPath );
+	}
+}
+
+static int nodeTile( const HPAMap* map, int nodeID )
+{
+	return map->sbNodes[nodeID].x + ( map->sbNodes[nodeID].y * map->width );
+}
+
+static float tileDistance( const HPAMap* map, int fromTile, int toTile )
+{
+	return octileDistance( ( toTile % map->width ) - ( fromTile % map->width ), ( toTile / map->width ) - ( fromTile / map->width ) );
+}
+
+static int clusterDistance( const HPAMap* map, int cluster, int otherCluster )
+{
+	int dx = abs( ( cluster % map->clustersWide ) - ( otherCluster % map->clustersWide ) );
+	int dy = abs( ( cluster / map->clustersWide ) - ( otherCluster / map->clustersWide ) );
+	return SDL_max( dx, dy );
+}
+
+// cost to the tile from the start of the last search of the whole cluster, INFINITY if it's not in the cluster or
+//  wasn't reached
+static float searchedCost( HPAMap* map, int cluster, int tile )
+{
+	if( clusterAt( map, tile % map->width, tile / map->width ) != cluster ) {
+		return INFINITY;
+	}
+
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+	int local = ( ( tile % map->width ) - left ) + ( ( ( tile / map->width ) - top ) * width );
+	return aStar_GetNodeRecord( &( map->localContext ), local )->cost;
+}
+
+// pushes the path from the tile back to the tile after the start of the last search of the whole cluster, the tile has
+//  to have been reached
+static void pushSearchedPath( HPAMap* map, int cluster, int tile, int** sbOutPath )
+{
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+
+	AStarContext* context = &( map->localContext );
+	int local = ( ( tile % map->width ) - left ) + ( ( ( tile / map->width ) - top ) * width );
+	while( local != context->startNodeID ) {
+		sb_Push( ( *sbOutPath ), ( left + ( local % width ) ) + ( ( top + ( local / width ) ) * map->width ) );
+		local = context->sbNodes[local].from;
+	}
+}
+
+static int createNode( HPAMap* map, int x, int y, int cluster, int border )
+{
+	int nodeID;
+	if( sb_Count( map->sbFreeNodes ) > 0 ) {
+		nodeID = sb_Pop( map->sbFreeNodes );
+	} else {
+		nodeID = (int)sb_Count( map->sbNodes );
+		HPANode* newNode = sb_Add( map->sbNodes, 1 );
+		newNode->sbEdges = NULL;
+	}
+
+	HPANode* node = &( map->sbNodes[nodeID] );
+	node->x = x;
+	node->y = y;
+	node->cluster = cluster;
+	node->border = border;
+	node->pairNodeID = -1;
+	sb_Clear( node->sbEdges );
+
+	sb_Push( map->clusters[cluster].sbNodes, nodeID );
+
+	return nodeID;
+}
+
+static void removeBorderNodesFromCluster( HPAMap* map, int cluster, int border )
+{
+	HPACluster* c = &( map->clusters[cluster] );
+	for( size_t i = 0; i < sb_Count( c->sbNodes ); ) {
+		HPANode* node = &( map->sbNodes[c->sbNodes[i]] );
+		if( node->border == border ) {
+			node->pairNodeID = -1;
+			sb_Clear( node->sbEdges );
+			sb_Push( map->sbFreeNodes, c->sbNodes[i] );
+			sb_Remove( c->sbNodes, i );
+		} else {
+			++i;
+		}
+	}
+}
+
+static void addEntrance( HPAMap* map, int cluster, int otherCluster, int border, int x, int y, int otherX, int otherY )
+{
+	int nodeID = createNode( map, x, y, cluster, border );
+	int otherNodeID = createNode( map, otherX, otherY, otherCluster, border );
+	map->sbNodes[nodeID].pairNodeID = otherNodeID;
+	map->sbNodes[otherNodeID].pairNodeID = nodeID;
+}
+
+// finds the open spans along the right or bottom border of the cluster and creates the entrances for them
+static void rebuildBorder( HPAMap* map, int cluster, int side )
+{
+	int otherCluster = ( side == BORDER_RIGHT ) ? ( cluster + 1 ) : ( cluster + map->clustersWide );
+	int border = ( cluster * 2 ) + side;
+
+	removeBorderNodesFromCluster( map, cluster, border );
+	removeBorderNodesFromCluster( map, otherCluster, border );
+
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+
+	// the border is walked along with i, the tiles in this cluster are at ( x, y ) and the other cluster at
+	//  ( x + stepX, y + stepY )
+	int length = ( side == BORDER_RIGHT ) ? height : width;
+	int stepX = ( side == BORDER_RIGHT ) ? 1 : 0;
+	int stepY = ( side == BORDER_RIGHT ) ? 0 : 1;
+	int spanStart = -1;
+	for( int i = 0; i <= length; ++i ) {
+		bool open = false;
+		if( i < length ) {
+			int x = ( side == BORDER_RIGHT ) ? ( left + width - 1 ) : ( left + i );
+			int y = ( side == BORDER_RIGHT ) ? ( top + i ) : ( top + height - 1 );
+			open = hpa_IsWalkable( map, x, y ) && hpa_IsWalkable( map, x + stepX, y + stepY );
+		}
+
+		if( open && ( spanStart < 0 ) ) {
+			spanStart = i;
+		} else if( !open && ( spanStart >= 0 ) ) {
+			int spanEnd = i - 1;
+			int transitions[2];
+			int numTransitions = 0;
+			if( ( spanEnd - spanStart + 1 ) >= LARGE_ENTRANCE_LENGTH ) {
+				transitions[numTransitions++] = spanStart;
+				transitions[numTransitions++] = spanEnd;
+			} else {
+				transitions[numTransitions++] = ( spanStart + spanEnd ) / 2;
+			}
+
+			for( int t = 0; t < numTransitions; ++t ) {
+				int x = ( side == BORDER_RIGHT ) ? ( left + width - 1 ) : ( left + transitions[t] );
+				int y = ( side == BORDER_RIGHT ) ? ( top + transitions[t] ) : ( top + height - 1 );
+				addEntrance( map, cluster, otherCluster, border, x, y, x + stepX, y + stepY );
+			}
+
+			spanStart = -1;
+		}
+	}
+
+	map->clusters[cluster].edgesDirty = true;
+	map->clusters[otherCluster].edgesDirty = true;
+}
+
+// finds the cost between every pair of entrances in the cluster
+static void rebuildEdges( HPAMap* map, int cluster )
+{
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+
+	HPACluster* c = &( map->clusters[cluster] );
+	for( size_t i = 0; i < sb_Count( c->sbNodes ); ++i ) {
+		int nodeID = c->sbNodes[i];
+		sb_Clear( map->sbNodes[nodeID].sbEdges );
+
+		searchCluster( map, cluster, nodeTile( map, nodeID ), -1, NULL );
+
+		for( size_t j = 0; j < sb_Count( c->sbNodes ); ++j ) {
+			if( i == j ) continue;
+
+			HPANode* other = &( map->sbNodes[c->sbNodes[j]] );
+			int otherLocal = ( other->x - left ) + ( ( other->y - top ) * width );
+			float cost = aStar_GetNodeRecord( &( map->localContext ), otherLocal )->cost;
+			if( cost < INFINITY ) {
+				HPAEdge edge = { c->sbNodes[j], cost };
+				sb_Push( map->sbNodes[nodeID].sbEdges, edge );
+			}
+		}
+	}
+}
+
+static void clearCacheEntry( HPAPathCacheEntry* entry )
+{
+	entry->startCluster = -1;
+	entry->targetCluster = -1;
+	sb_Clear( entry->sbPath );
+	sb_Clear( entry->sbClusters );
+}
+
+static HPAPathCacheEntry* getCacheEntry( HPAMap* map, int startCluster, int targetCluster )
+{
+	uint32_t hash = ( (uint32_t)startCluster * 73856093u ) ^ ( (uint32_t)targetCluster * 19349663u );
+	return &( map->pathCache[hash % HPA_PATH_CACHE_SIZE] );
+}
+
+bool hpa_CreateMap( HPAMap* map, int width, int height, int clusterSize )
+{
+	ASSERT( map != NULL );
+
+	SDL_memset( map, 0, sizeof( *map ) );
+
+	if( ( width <= 0 ) || ( height <= 0 ) || ( clusterSize < 2 ) ) {
+		llog( LOG_ERROR, "Invalid hierarchical path map size: %i x %i with clusters of %i", width, height, clusterSize );
+		return false;
+	}
+
+	map->width = width;
+	map->height = height;
+	map->clusterSize = clusterSize;
+	map->clustersWide = ( width + clusterSize - 1 ) / clusterSize;
+	map->clustersHigh = ( height + clusterSize - 1 ) / clusterSize;
+
+	int numClusters = map->clustersWide * map->clustersHigh;
+	map->walkable = mem_Allocate( (size_t)width * (size_t)height );
+	map->clusters = mem_Allocate( sizeof( map->clusters[0] ) * (size_t)numClusters );
+	if( ( map->walkable == NULL ) || ( map->clusters == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate hierarchical path map of %i x %i", width, height );
+		mem_Release( map->walkable );
+		mem_Release( map->clusters );
+		SDL_memset( map, 0, sizeof( *map ) );
+		return false;
+	}
+
+	SDL_memset( map->clusters, 0, sizeof( map->clusters[0] ) * (size_t)numClusters );
+
+	aStar_InitContext( &( map->localContext ) );
+	aStar_InitContext( &( map->abstractContext ) );
+
+	for( int i = 0; i < HPA_PATH_CACHE_SIZE; ++i ) {
+		clearCacheEntry( &( map->pathCache[i] ) );
+	}
+
+	SDL_memset( map->walkable, 1, (size_t)width * (size_t)height );
+	hpa_SetAllWalkable( map, map->walkable );
+
+	return true;
+}
+
+void hpa_DestroyMap( HPAMap* map )
+{
+	ASSERT( map != NULL );
+
+	for( size_t i = 0; i < sb_Count( map->sbNodes ); ++i ) {
+		sb_Release( map->sbNodes[i].sbEdges );
+	}
+	sb_Release( map->sbNodes );
+	sb_Release( map->sbFreeNodes );
+
+	if( map->clusters != NULL ) {
+		for( int i = 0; i < ( map->clustersWide * map->clustersHigh ); ++i ) {
+			sb_Release( map->clusters[i].sbNodes );
+		}
+	}
+
+	for( int i = 0; i < HPA_PATH_CACHE_SIZE; ++i ) {
+		sb_Release( map->pathCache[i].sbPath );
+		sb_Release( map->pathCache[i].sbClusters );
+	}
+
+	sb_Release( map->sbAbstractPath );
+	sb_Release( map->sbScratchPath );
+	sb_Release( map->sbStartCosts );
+	sb_Release( map->sbTargetCosts );
+
+	aStar_CleanUpContext( &( map->localContext ) );
+	aStar_CleanUpContext( &( map->abstractContext ) );
+
+	mem_Release( map->walkable );
+	mem_Release( map->clusters );
+
+	SDL_memset( map, 0, sizeof( *map ) );
+}
+
+// marks the cluster the tile is in as needing to be rebuilt, and the neighboring clusters if the tile is on a border
+void hpa_SetWalkable( HPAMap* map, int x, int y, bool walkable )
+{
+	ASSERT( map != NULL );
+
+	if( ( x < 0 ) || ( y < 0 ) || ( x >= map->width ) || ( y >= map->height ) ) {
+		return;
+	}
+
+	if( hpa_IsWalkable( map, x, y ) == walkable ) {
+		return;
+	}
+
+	map->walkable[x + ( y * map->width )] = walkable ? 1 : 0;
+
+	int cluster = clusterAt( map, x, y );
+	int clusterX = x / map->clusterSize;
+	int clusterY = y / map->clusterSize;
+	int localX = x % map->clusterSize;
+	int localY = y % map->clusterSize;
+
+	map->clusters[cluster].edgesDirty = true;
+
+	// entrances only depend on the tiles right next to the border
+	if( ( localX == 0 ) && ( clusterX > 0 ) ) {
+		map->clusters[cluster - 1].rightBorderDirty = true;
+	}
+	if( ( localX == map->clusterSize - 1 ) && ( clusterX < map->clustersWide - 1 ) ) {
+		map->clusters[cluster].rightBorderDirty = true;
+	}
+	if( ( localY == 0 ) && ( clusterY > 0 ) ) {
+		map->clusters[cluster - map->clustersWide].bottomBorderDirty = true;
+	}
+	if( ( localY == map->clusterSize - 1 ) && ( clusterY < map->clustersHigh - 1 ) ) {
+		map->clusters[cluster].bottomBorderDirty = true;
+	}
+
+	map->dirty = true;
+}
+
+// sets every tile from width * height bytes, anything that isn't zero is walkable, everything gets rebuilt
+void hpa_SetAllWalkable( HPAMap* map, const uint8_t* walkable )
+{
+	ASSERT( map != NULL );
+	ASSERT( walkable != NULL );
+
+	for( int i = 0; i < ( map->width * map->height ); ++i ) {
+		map->walkable[i] = ( walkable[i] != 0 ) ? 1 : 0;
+	}
+
+	for( int y = 0; y < map->clustersHigh; ++y ) {
+		for( int x = 0; x < map->clustersWide; ++x ) {
+			HPACluster* cluster = &( map->clusters[x + ( y * map->clustersWide )] );
+			cluster->edgesDirty = true;
+			cluster->rightBorderDirty = ( x < map->clustersWide - 1 );
+			cluster->bottomBorderDirty = ( y < map->clustersHigh - 1 );
+		}
+	}
+
+	map->dirty = true;
+	hpa_Update( map );
+}
+
+// rebuilds any dirty clusters, called by hpa_FindPath( ) so it only needs to be called to control when it happens
+void hpa_Update( HPAMap* map )
+{
+	ASSERT( map != NULL );
+
+	if( !map->dirty ) {
+		return;
+	}
+
+	int numClusters = map->clustersWide * map->clustersHigh;
+
+	// rebuilding the borders marks the clusters on both sides as needing new edges
+	for( int i = 0; i < numClusters; ++i ) {
+		if( map->clusters[i].rightBorderDirty ) {
+			rebuildBorder( map, i, BORDER_RIGHT );
+			map->clusters[i].rightBorderDirty = false;
+		}
+		if( map->clusters[i].bottomBorderDirty ) {
+			rebuildBorder( map, i, BORDER_BOTTOM );
+			map->clusters[i].bottomBorderDirty = false;
+		}
+	}
+
+	for( int i = 0; i < HPA_PATH_CACHE_SIZE; ++i ) {
+		HPAPathCacheEntry* entry = &( map->pathCache[i] );
+		for( size_t c = 0; c < sb_Count( entry->sbClusters ); ++c ) {
+			if( map->clusters[entry->sbClusters[c]].edgesDirty ) {
+				clearCacheEntry( entry );
+				break;
+			}
+		}
+	}
+
+	for( int i = 0; i < numClusters; ++i ) {
+		if( map->clusters[i].edgesDirty ) {
+			rebuildEdges( map, i );
+			map->clusters[i].edgesDirty = false;
+			++map->numClustersRebuilt;
+		}
+	}
+
+	map->dirty = false;
+}
+
+// throws away all the cached paths
+void hpa_ClearPathCache( HPAMap* map )
+{
+	ASSERT( map != NULL );
+
+	for( int i = 0; i < HPA_PATH_CACHE_SIZE; ++i ) {
+		clearCacheEntry( &( map->pathCache[i] ) );
+	}
+}
+
+// tiles along the cached path from the first node, 0 is the first node and the last is the last node
+static int cachedPathTile( const HPAMap* map, const HPAPathCacheEntry* entry, int idx )
+{
+	return ( idx == 0 ) ? nodeTile( map, entry->firstNodeID ) : entry->sbPath[sb_Count( entry->sbPath ) - (size_t)idx];
+}
+
+// connects the start and target to the cached path, only the two ends need searching. Rather than going to the cached
+//  entrances, which can be behind the start or past the target, each end joins the path wherever gives the shortest
+//  total inside its cluster
+static bool findPathFromCache( HPAMap* map, HPAPathCacheEntry* entry, int startTile, int targetTile, int** sbOutPath )
+{
+	int numTiles = (int)sb_Count( entry->sbPath ) + 1;
+
+	searchCluster( map, entry->startCluster, startTile, -1, NULL );
+	int joinStart = -1;
+	float bestCost = INFINITY;
+	float along = 0.0f;
+	for( int i = 0; i < numTiles; ++i ) {
+		int tile = cachedPathTile( map, entry, i );
+		if( i > 0 ) {
+			along += tileDistance( map, cachedPathTile( map, entry, i - 1 ), tile );
+		}
+		float cost = searchedCost( map, entry->startCluster, tile ) - along;
+		if( cost < bestCost ) {
+			bestCost = cost;
+			joinStart = i;
+		}
+	}
+	if( joinStart < 0 ) {
+		return false;
+	}
+
+	// the target's search will replace this one
+	sb_Clear( map->sbScratchPath );
+	pushSearchedPath( map, entry->startCluster, cachedPathTile( map, entry, joinStart ), &( map->sbScratchPath ) );
+
+	// the moves are the same both ways, so searching from the target gives the costs to it
+	searchCluster( map, entry->targetCluster, targetTile, -1, NULL );
+	int joinTarget = -1;
+	bestCost = INFINITY;
+	along = 0.0f;
+	for( int i = joinStart; i < numTiles; ++i ) {
+		int tile = cachedPathTile( map, entry, i );
+		if( i > joinStart ) {
+			along += tileDistance( map, cachedPathTile( map, entry, i - 1 ), tile );
+		}
+		float cost = searchedCost( map, entry->targetCluster, tile ) + along;
+		if( cost < bestCost ) {
+			bestCost = cost;
+			joinTarget = i;
+		}
+	}
+	if( joinTarget < 0 ) {
+		return false;
+	}
+
+	// this goes from where it joins towards the target, swap it around so it's in the same order as the rest
+	size_t targetStart = sb_Count( *sbOutPath );
+	pushSearchedPath( map, entry->targetCluster, cachedPathTile( map, entry, joinTarget ), sbOutPath );
+	size_t targetEnd = sb_Count( *sbOutPath );
+	if( targetEnd > targetStart ) {
+		( *sbOutPath )[targetStart] = targetTile;
+		for( size_t a = targetStart + 1, b = targetEnd - 1; a < b; ++a, --b ) {
+			int temp = ( *sbOutPath )[a];
+			( *sbOutPath )[a] = ( *sbOutPath )[b];
+			( *sbOutPath )[b] = temp;
+		}
+	}
+
+	for( int i = joinTarget; i > joinStart; --i ) {
+		sb_Push( ( *sbOutPath ), cachedPathTile( map, entry, i ) );
+	}
+	for( size_t i = 0; i < sb_Count( map->sbScratchPath ); ++i ) {
+		sb_Push( ( *sbOutPath ), map->sbScratchPath[i] );
+	}
+
+	map->queryRefinedSegments = 2;
+	map->queryUsedCache = true;
+	return true;
+}
+
+// gets the costs from the tile to every entrance of the cluster, in the same order as the cluster's nodes
+static void findEntranceCosts( HPAMap* map, int cluster, int tile, float** sbOutCosts )
+{
+	int left, top, width, height;
+	getClusterBounds( map, cluster, &left, &top, &width, &height );
+
+	searchCluster( map, cluster, tile, -1, NULL );
+
+	HPACluster* c = &( map->clusters[cluster] );
+	sb_Clear( *sbOutCosts );
+	for( size_t i = 0; i < sb_Count( c->sbNodes ); ++i ) {
+		HPANode* node = &( map->sbNodes[c->sbNodes[i]] );
+		int local = ( node->x - left ) + ( ( node->y - top ) * width );
+		sb_Push( ( *sbOutCosts ), aStar_GetNodeRecord( &( map->localContext ), local )->cost );
+	}
+}
+
+// searches the graph of entrances, puts the entrances the path goes through into sbAbstractPath going from the
+//  target back to the start, directCost is the cost of a path found without using the entrances, INFINITY if there
+//  isn't one, sbAbstractPath will be empty if that's the best path
+static bool searchAbstract( HPAMap* map, int startCluster, int targetCluster, int startTile, int targetTile, float directCost )
+{
+	findEntranceCosts( map, startCluster, startTile, &( map->sbStartCosts ) );
+	findEntranceCosts( map, targetCluster, targetTile, &( map->sbTargetCosts ) );
+
+	int targetX = targetTile % map->width;
+	int targetY = targetTile / map->width;
+
+	int numNodes = (int)sb_Count( map->sbNodes );
+	int startID = numNodes;
+	int targetID = numNodes + 1;
+
+	AStarContext* context = &( map->abstractContext );
+	aStar_ResetContext( context, (size_t)( numNodes + 2 ) );
+	aStar_OpenNode( context, startID, startID, 0.0f, octileDistance( targetX - ( startTile % map->width ), targetY - ( startTile / map->width ) ) );
+
+	HPACluster* start = &( map->clusters[startCluster] );
+	HPACluster* target = &( map->clusters[targetCluster] );
+
+	bool found = false;
+	int currentID;
+	while( ( currentID = aStar_PopOpenNode( context ) ) != -1 ) {
+		if( currentID == targetID ) {
+			found = true;
+			break;
+		}
+
+		float currentCost = aStar_GetNodeRecord( context, currentID )->cost;
+
+		if( currentID == startID ) {
+			if( directCost < INFINITY ) {
+				aStar_OpenNode( context, targetID, startID, directCost, 0.0f );
+			}
+			for( size_t i = 0; i < sb_Count( start->sbNodes ); ++i ) {
+				if( map->sbStartCosts[i] < INFINITY ) {
+					HPANode* node = &( map->sbNodes[start->sbNodes[i]] );
+					aStar_OpenNode( context, start->sbNodes[i], startID, map->sbStartCosts[i], octileDistance( targetX - node->x, targetY - node->y ) );
+				}
+			}
+			continue;
+		}
+
+		HPANode* current = &( map->sbNodes[currentID] );
+		for( size_t i = 0; i < sb_Count( current->sbEdges ); ++i ) {
+			HPANode* node = &( map->sbNodes[current->sbEdges[i].nodeID] );
+			aStar_OpenNode( context, current->sbEdges[i].nodeID, currentID, currentCost + current->sbEdges[i].cost,
+				octileDistance( targetX - node->x, targetY - node->y ) );
+		}
+
+		// crossing the border is always a single straight step
+		HPANode* pair = &( map->sbNodes[current->pairNodeID] );
+		aStar_OpenNode( context, current->pairNodeID, currentID, currentCost + 1.0f, octileDistance( targetX - pair->x, targetY - pair->y ) );
+
+		if( current->cluster == targetCluster ) {
+			for( size_t i = 0; i < sb_Count( target->sbNodes ); ++i ) {
+				if( ( target->sbNodes[i] == currentID ) && ( map->sbTargetCosts[i] < INFINITY ) ) {
+					aStar_OpenNode( context, targetID, currentID, currentCost + map->sbTargetCosts[i], 0.0f );
+					break;
+				}
+			}
+		}
+	}
+
+	map->queryAbstractExpansions = context->numExpansions;
+	if( !found ) {
+		return false;
+	}
+
+	sb_Clear( map->sbAbstractPath );
+	int current = context->sbNodes[targetID].from;
+	while( current != startID ) {
+		sb_Push( map->sbAbstractPath, current );
+		current = context->sbNodes[current].from;
+	}
+
+	return true;
+}
+
+// returns whether a path was found and pushes it onto sbOutPath
+bool hpa_FindPath( HPAMap* map, int startX, int startY, int targetX, int targetY, int** sbOutPath )
+{
+	ASSERT( map != NULL );
+	ASSERT( sbOutPath != NULL );
+
+	hpa_Update( map );
+
+	map->queryAbstractExpansions = 0;
+	map->queryRefinedSegments = 0;
+	map->queryUsedCache = false;
+
+	if( !hpa_IsWalkable( map, startX, startY ) || !hpa_IsWalkable( map, targetX, targetY ) ) {
+		return false;
+	}
+
+	int startTile = startX + ( startY * map->width );
+	int targetTile = targetX + ( targetY * map->width );
+	int startCluster = clusterAt( map, startX, startY );
+	int targetCluster = clusterAt( map, targetX, targetY );
+
+	size_t originalCount = sb_Count( *sbOutPath );
+
+	// entrances can be a long way apart, so when the start and target are close search the area around them directly,
+	//  if that's as good as a straight line there's no need to look any further, otherwise the path through the
+	//  entrances might still be shorter
+	float directCost = INFINITY;
+	int windowLeft = SDL_max( SDL_min( startX, targetX ) - ( map->clusterSize / 2 ), 0 );
+	int windowTop = SDL_max( SDL_min( startY, targetY ) - ( map->clusterSize / 2 ), 0 );
+	int windowRight = SDL_min( SDL_max( startX, targetX ) + ( map->clusterSize / 2 ), map->width - 1 );
+	int windowBottom = SDL_min( SDL_max( startY, targetY ) + ( map->clusterSize / 2 ), map->height - 1 );
+	int directSize = map->clusterSize * DIRECT_SEARCH_CLUSTERS;
+	if( ( ( windowRight - windowLeft ) < directSize ) && ( ( windowBottom - windowTop ) < directSize ) ) {
+		map->queryRefinedSegments = 1;
+		if( searchRect( map, windowLeft, windowTop, windowRight - windowLeft + 1, windowBottom - windowTop + 1, startTile, targetTile, sbOutPath ) ) {
+			directCost = aStar_GetNodeRecord( &( map->localContext ), map->localContext.targetNodeID )->cost;
+			if( directCost <= ( octileDistance( targetX - startX, targetY - startY ) + 0.001f ) ) {
+				return true;
+			}
+		}
+	}
+
+	HPAPathCacheEntry* entry = getCacheEntry( map, startCluster, targetCluster );
+	if( ( directCost == INFINITY ) && ( entry->startCluster == startCluster ) && ( entry->targetCluster == targetCluster ) &&
+		( clusterDistance( map, startCluster, targetCluster ) >= MIN_CACHED_CLUSTER_DISTANCE ) ) {
+		if( findPathFromCache( map, entry, startTile, targetTile, sbOutPath ) ) {
+			return true;
+		}
+		truncatePath( sbOutPath, originalCount );
+	}
+
+	if( !searchAbstract( map, startCluster, targetCluster, startTile, targetTile, directCost ) ) {
+		return false;
+	}
+
+	if( sb_Count( map->sbAbstractPath ) == 0 ) {
+		// the direct path was the best
+		return true;
+	}
+	truncatePath( sbOutPath, originalCount );
+
+	// refine each step between entrances, going backwards so the tiles are pushed from the target to the start
+	int numAbstract = (int)sb_Count( map->sbAbstractPath );
+	int lastNodeID = map->sbAbstractPath[0];
+	int firstNodeID = map->sbAbstractPath[numAbstract - 1];
+
+	bool refined = searchCluster( map, targetCluster, nodeTile( map, lastNodeID ), targetTile, sbOutPath );
+	size_t middleStart = sb_Count( *sbOutPath );
+	for( int i = 0; refined && ( i < numAbstract - 1 ); ++i ) {
+		int toID = map->sbAbstractPath[i];
+		int fromID = map->sbAbstractPath[i + 1];
+		if( map->sbNodes[fromID].cluster == map->sbNodes[toID].cluster ) {
+			refined = searchCluster( map, map->sbNodes[toID].cluster, nodeTile( map, fromID ), nodeTile( map, toID ), sbOutPath );
+		} else {
+			sb_Push( ( *sbOutPath ), nodeTile( map, toID ) );
+		}
+	}
+	size_t middleEnd = sb_Count( *sbOutPath );
+	refined = refined && searchCluster( map, startCluster, startTile, nodeTile( map, firstNodeID ), sbOutPath );
+	map->queryRefinedSegments += (uint32_t)( numAbstract + 1 );
+
+	if( !refined ) {
+		// shouldn't happen, the costs in the graph came from the same searches
+		llog( LOG_WARN, "Unable to refine hierarchical path from (%i, %i) to (%i, %i)", startX, startY, targetX, targetY );
+		truncatePath( sbOutPath, originalCount );
+		return false;
+	}
+
+	// cache the middle for the next query between these clusters
+	clearCacheEntry( entry );
+	entry->startCluster = startCluster;
+	entry->targetCluster = targetCluster;
+	entry->firstNodeID = firstNodeID;
+	entry->lastNodeID = lastNodeID;
+	for( size_t i = middleStart; i < middleEnd; ++i ) {
+		sb_Push( entry->sbPath, ( *sbOutPath )[i] );
+	}
+	for( int i = 0; i < numAbstract; ++i ) {
+		int cluster = map->sbNodes[map->sbAbstractPath[i]].cluster;
+		if( ( sb_Count( entry->sbClusters ) == 0 ) || ( sb_Last( entry->sbClusters ) != cluster ) ) {
+			sb_Push( entry->sbClusters, cluster );
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,110 @@
+#ifndef HPA_STAR_H
+#define HPA_STAR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Utils/aStar.h"
+
+// Hierarchical pathfinding (HPA*) for large tile grids. The grid is split into square clusters, the open spans along
+//  the borders between clusters become entrances, and the costs between every pair of entrances in a cluster are
+//  cached. Queries search that much smaller graph of entrances and then only run A* inside the clusters the path
+//  goes through. Paths aren't guaranteed to be the best, every border has to be crossed at an entrance. Compared to A*
+//  on random maps with 4 to 17 tile clusters and up to 45% of the tiles blocked they average 1.7% longer and the worst
+//  was 1.46x, with or without the path cache. The worst are short paths across long open borders, which is why a start
+//  and target less than 4 clusters apart are also searched for directly.
+//
+// Movement is the same as jump point search: eight directions, straight moves cost 1, diagonal moves cost sqrt(2),
+//  no cutting corners. Node ids are x + ( y * width ) and paths are in the same order as aStar_GetPath( ).
+//
+// The middle of each path is cached by the pair of clusters it starts and ends in, a later query between the same
+//  clusters only has to join the cached path inside the start and target clusters. It's only used for clusters at
+//  least 3 apart so the joins don't add much.
+// Changing tiles marks their clusters as dirty, the dirty clusters, and any cached paths going through them, are
+//  rebuilt in hpa_Update( ).
+
+typedef struct {
+	int nodeID;
+	float cost;
+} HPAEdge;
+
+typedef struct {
+	int x;
+	int y;
+	int cluster;
+	int border;
+	int pairNodeID; // entrance on the other side of the border, -1 if the node isn't in use
+	HPAEdge* sbEdges; // to the other entrances in the same cluster
+} HPANode;
+
+typedef struct {
+	int* sbNodes;
+	bool edgesDirty;
+	bool rightBorderDirty;
+	bool bottomBorderDirty;
+} HPACluster;
+
+typedef struct {
+	int startCluster; // -1 if the entry isn't used
+	int targetCluster;
+	int firstNodeID;
+	int lastNodeID;
+	int* sbPath; // tiles from the last node back to the tile after the first node
+	int* sbClusters; // every cluster the path goes through
+} HPAPathCacheEntry;
+
+#define HPA_PATH_CACHE_SIZE 1024
+
+typedef struct {
+	int width;
+	int height;
+	uint8_t* walkable;
+
+	int clusterSize;
+	int clustersWide;
+	int clustersHigh;
+	HPACluster* clusters;
+
+	HPANode* sbNodes;
+	int* sbFreeNodes;
+
+	bool dirty;
+
+	AStarContext localContext;
+	AStarContext abstractContext;
+	int* sbAbstractPath;
+	int* sbScratchPath;
+	float* sbStartCosts;
+	float* sbTargetCosts;
+
+	HPAPathCacheEntry pathCache[HPA_PATH_CACHE_SIZE];
+
+	// stats, the query ones are for the last query
+	uint32_t numClustersRebuilt;
+	uint32_t queryAbstractExpansions;
+	uint32_t queryRefinedSegments;
+	bool queryUsedCache;
+} HPAMap;
+
+// creates a map with every tile walkable, clusterSize is the width and height of the clusters in tiles
+bool hpa_CreateMap( HPAMap* map, int width, int height, int clusterSize );
+void hpa_DestroyMap( HPAMap* map );
+
+bool hpa_IsWalkable( const HPAMap* map, int x, int y );
+
+// marks the cluster the tile is in as needing to be rebuilt, and the neighboring clusters if the tile is on a border
+void hpa_SetWalkable( HPAMap* map, int x, int y, bool walkable );
+
+// sets every tile from width * height bytes, anything that isn't zero is walkable, everything gets rebuilt
+void hpa_SetAllWalkable( HPAMap* map, const uint8_t* walkable );
+
+// rebuilds any dirty clusters, called by hpa_FindPath( ) so it only needs to be called to control when it happens
+void hpa_Update( HPAMap* map );
+
+// throws away all the cached paths
+void hpa_ClearPathCache( HPAMap* map );
+
+// returns whether a path was found and pushes it onto sbOutPath
+bool hpa_FindPath( HPAMap* map, int startX, int startY, int targetX, int targetY, int** sbOutPath );
+
+#endif // inclusion guard
@@ -45,6 +45,24 @@ void idSet_Destroy( IDSet* set )
 	set->sbIDData = NULL;
 }
 
+static EntityID claimIndex( IDSet* set, uint16_t idx )
+{
+	// mark it as in use, advance the generation, and generate the id
+	set->sbIDData[idx].flags |= IS_IN_USE;
+
+	if( set->sbIDData[idx].generation == UINT16_MAX ) {
+		set->sbIDData[idx].generation = 1;
+	} else {
+		++( set->sbIDData[idx].generation );
+	}
+
+	if( idx > set->currMaxCount ) {
+		set->currMaxCount = idx;
+	}
+
+	return createID( idx, set->sbIDData[idx].generation );
+}
+
 // Claims an id and returns it, returns a value of 0 if there were none available.
 EntityID idSet_ClaimID( IDSet* set )
 {
@@ -61,20 +79,32 @@ EntityID idSet_ClaimID( IDSet* set )
 		return 0;
 	}
 
-	// found valid id, mark it as in use, advance the generation, and generate the id
-	set->sbIDData[idx].flags |= IS_IN_USE;
+	return claimIndex( set, idx );
+}
 
-	if( set->sbIDData[idx].generation == UINT16_MAX ) {
-		set->sbIDData[idx].generation = 1;
-	} else {
-		++( set->sbIDData[idx].generation );
+// Claims numIDs ids in one pass over the set, writing them to outIDs.
+bool idSet_ClaimIDs( IDSet* set, size_t numIDs, EntityID* outIDs )
+{
+	ASSERT( set != NULL );
+	ASSERT( ( outIDs != NULL ) || ( numIDs == 0 ) );
+
+	size_t count = sb_Count( set->sbIDData );
+	size_t numClaimed = 0;
+	for( size_t idx = 0; ( idx < count ) && ( numClaimed < numIDs ); ++idx ) {
+		if( ( set->sbIDData[idx].flags & IS_IN_USE ) == 0 ) {
+			outIDs[numClaimed] = claimIndex( set, (uint16_t)idx );
+			++numClaimed;
+		}
 	}
 
-	if( idx > set->currMaxCount ) {
-		set->currMaxCount = idx;
+	if( numClaimed < numIDs ) {
+		for( size_t i = 0; i < numClaimed; ++i ) {
+			idSet_ReleaseID( set, outIDs[i] );
+		}
+		return false;
 	}
 
-	return createID( idx, set->sbIDData[idx].generation );
+	return true;
 }
 
 // Releases an id from use, allowing it to be used by something else.
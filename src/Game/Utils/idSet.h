@@ -32,6 +32,10 @@ void idSet_Destroy( IDSet* set );
 // Claims an id and returns it, returns a value of 0 if there were none available.
 EntityID idSet_ClaimID( IDSet* set );
 
+// Claims numIDs ids at once, which is much faster than claiming them one at a time.
+//  Returns false and claims nothing if there aren't enough available.
+bool idSet_ClaimIDs( IDSet* set, size_t numIDs, EntityID* outIDs );
+
 // Releases an id from use, allowing it to be used by something else.
 void idSet_ReleaseID( IDSet* set, EntityID id );
 
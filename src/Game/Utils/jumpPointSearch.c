@@ -0,0 +1,403 @@
+#include "jumpPointSearch.h"
+
+#include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_stdinc.h>
+#include <stdlib.h>
+
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "Utils/stretchyBuffer.h"
+
+#define SQRT_2 1.41421356f
+
+// directions go clockwise starting from east, with y going down, straight directions are even and diagonals are odd
+#define NUM_DIRECTIONS 8
+static const int dirX[NUM_DIRECTIONS] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int dirY[NUM_DIRECTIONS] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+#define IS_STRAIGHT( d ) ( ( ( d ) & 1 ) == 0 )
+#define TURN( d, amt ) ( ( ( d ) + ( amt ) + NUM_DIRECTIONS ) % NUM_DIRECTIONS )
+#define ALL_DIRECTIONS 0xFF
+
+static int sign( int i )
+{
+	return ( i > 0 ) - ( i < 0 );
+}
+
+static int directionFromDelta( int dx, int dy )
+{
+	dx = sign( dx );
+	dy = sign( dy );
+	for( int d = 0; d < NUM_DIRECTIONS; ++d ) {
+		if( ( dirX[d] == dx ) && ( dirY[d] == dy ) ) {
+			return d;
+		}
+	}
+	return -1;
+}
+
+// after moving straight we can keep going, turn 90 degrees at a jump point, or go diagonally to either side
+//  after moving diagonally we can keep going or split into the two straight directions that make it up
+static uint8_t validDirections( int travelDir )
+{
+	int spread = IS_STRAIGHT( travelDir ) ? 2 : 1;
+	uint8_t mask = 0;
+	for( int i = -spread; i <= spread; ++i ) {
+		mask |= (uint8_t)( 1 << TURN( travelDir, i ) );
+	}
+	return mask;
+}
+
+static float octileDistance( int dx, int dy )
+{
+	dx = abs( dx );
+	dy = abs( dy );
+	return (float)( dx + dy ) + ( ( SQRT_2 - 2.0f ) * (float)SDL_min( dx, dy ) );
+}
+
+static int16_t* getJumpDistances( const JPSGrid* grid, int x, int y )
+{
+	return &( grid->jumpDistances[( x + ( y * grid->width ) ) * NUM_DIRECTIONS] );
+}
+
+bool jps_IsWalkable( const JPSGrid* grid, int x, int y )
+{
+	if( ( x < 0 ) || ( y < 0 ) || ( x >= grid->width ) || ( y >= grid->height ) ) {
+		return false;
+	}
+
+	uint64_t word = grid->walkable[( y * grid->wordsPerRow ) + ( x >> 6 )];
+	return ( ( word >> ( x & 63 ) ) & 1 ) != 0;
+}
+
+static void setWalkableBit( JPSGrid* grid, int x, int y, bool walkable )
+{
+	uint64_t* word = &( grid->walkable[( y * grid->wordsPerRow ) + ( x >> 6 )] );
+	uint64_t bit = (uint64_t)1 << ( x & 63 );
+	if( walkable ) {
+		( *word ) |= bit;
+	} else {
+		( *word ) &= ~bit;
+	}
+}
+
+// moving straight onto the tile in dir, it's a jump point if one of the sides opens up when it was blocked next to the
+//  tile we came from, that's the only place an optimal path could turn
+static bool isStraightJumpPoint( const JPSGrid* grid, int x, int y, int dir )
+{
+	int prevX = x - dirX[dir];
+	int prevY = y - dirY[dir];
+	for( int turn = -2; turn <= 2; turn += 4 ) {
+		int side = TURN( dir, turn );
+		if( jps_IsWalkable( grid, x + dirX[side], y + dirY[side] ) &&
+			!jps_IsWalkable( grid, prevX + dirX[side], prevY + dirY[side] ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// uses the jump distances of the next tile in dir, so that has to be up to date
+//  positive is the number of steps to a jump point, otherwise it's the negative of the number of steps before a wall
+static int16_t calculateJumpDistance( const JPSGrid* grid, int x, int y, int dir )
+{
+	if( !jps_IsWalkable( grid, x, y ) ) {
+		return 0;
+	}
+
+	int nextX = x + dirX[dir];
+	int nextY = y + dirY[dir];
+	if( !jps_IsWalkable( grid, nextX, nextY ) ) {
+		return 0;
+	}
+
+	int16_t* nextDistances = getJumpDistances( grid, nextX, nextY );
+	if( IS_STRAIGHT( dir ) ) {
+		if( isStraightJumpPoint( grid, nextX, nextY, dir ) ) {
+			return 1;
+		}
+	} else {
+		// no cutting corners
+		if( !jps_IsWalkable( grid, nextX, y ) || !jps_IsWalkable( grid, x, nextY ) ) {
+			return 0;
+		}
+
+		// diagonals stop anywhere one of their straight parts would reach a jump point
+		if( ( nextDistances[TURN( dir, -1 )] > 0 ) || ( nextDistances[TURN( dir, 1 )] > 0 ) ) {
+			return 1;
+		}
+	}
+
+	int16_t next = nextDistances[dir];
+	return ( next > 0 ) ? ( next + 1 ) : ( next - 1 );
+}
+
+// goes through every tile in an order where the next tile in dir is always done first
+static void rebuildDirection( JPSGrid* grid, int dir )
+{
+	int startX = ( dirX[dir] > 0 ) ? ( grid->width - 1 ) : 0;
+	int stepX = ( dirX[dir] > 0 ) ? -1 : 1;
+	int startY = ( dirY[dir] > 0 ) ? ( grid->height - 1 ) : 0;
+	int stepY = ( dirY[dir] > 0 ) ? -1 : 1;
+
+	for( int y = startY; ( y >= 0 ) && ( y < grid->height ); y += stepY ) {
+		for( int x = startX; ( x >= 0 ) && ( x < grid->width ); x += stepX ) {
+			getJumpDistances( grid, x, y )[dir] = calculateJumpDistance( grid, x, y, dir );
+		}
+	}
+}
+
+static void rebuildAll( JPSGrid* grid )
+{
+	// diagonals use the straight distances
+	for( int dir = 0; dir < NUM_DIRECTIONS; dir += 2 ) {
+		rebuildDirection( grid, dir );
+	}
+	for( int dir = 1; dir < NUM_DIRECTIONS; dir += 2 ) {
+		rebuildDirection( grid, dir );
+	}
+}
+
+// recomputes a row for a horizontal direction or a column for a vertical one, x or y is ignored depending on which
+static void rebuildLine( JPSGrid* grid, int x, int y, int dir )
+{
+	int length = ( dirX[dir] != 0 ) ? grid->width : grid->height;
+	for( int i = 0; i < length; ++i ) {
+		int pos = ( ( dirX[dir] + dirY[dir] ) > 0 ) ? ( length - 1 - i ) : i;
+		int lineX = ( dirX[dir] != 0 ) ? pos : x;
+		int lineY = ( dirX[dir] != 0 ) ? y : pos;
+		getJumpDistances( grid, lineX, lineY )[dir] = calculateJumpDistance( grid, lineX, lineY, dir );
+	}
+}
+
+// recomputes the diagonal distance of the tile, and keeps going backwards along the diagonal as long as the distances
+//  keep changing
+static void updateDiagonal( JPSGrid* grid, int x, int y, int dir )
+{
+	while( ( x >= 0 ) && ( y >= 0 ) && ( x < grid->width ) && ( y < grid->height ) ) {
+		int16_t* distance = &( getJumpDistances( grid, x, y )[dir] );
+		int16_t newDistance = calculateJumpDistance( grid, x, y, dir );
+		if( newDistance == ( *distance ) ) {
+			return;
+		}
+		( *distance ) = newDistance;
+
+		x -= dirX[dir];
+		y -= dirY[dir];
+	}
+}
+
+bool jps_CreateGrid( JPSGrid* grid, int width, int height )
+{
+	ASSERT( grid != NULL );
+
+	SDL_memset( grid, 0, sizeof( *grid ) );
+
+	if( ( width <= 0 ) || ( height <= 0 ) || ( width > INT16_MAX ) || ( height > INT16_MAX ) ) {
+		llog( LOG_ERROR, "Invalid jump point search grid size: %i x %i", width, height );
+		return false;
+	}
+
+	grid->width = width;
+	grid->height = height;
+	grid->wordsPerRow = ( width + 63 ) / 64;
+
+	size_t numWords = (size_t)grid->wordsPerRow * (size_t)height;
+	size_t numDistances = (size_t)width * (size_t)height * NUM_DIRECTIONS;
+	grid->walkable = mem_Allocate( sizeof( grid->walkable[0] ) * numWords );
+	grid->jumpDistances = mem_Allocate( sizeof( grid->jumpDistances[0] ) * numDistances );
+	if( ( grid->walkable == NULL ) || ( grid->jumpDistances == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate jump point search grid of %i x %i", width, height );
+		jps_DestroyGrid( grid );
+		return false;
+	}
+
+	SDL_memset( grid->walkable, 0xFF, sizeof( grid->walkable[0] ) * numWords );
+	rebuildAll( grid );
+
+	return true;
+}
+
+void jps_DestroyGrid( JPSGrid* grid )
+{
+	ASSERT( grid != NULL );
+
+	mem_Release( grid->walkable );
+	mem_Release( grid->jumpDistances );
+	SDL_memset( grid, 0, sizeof( *grid ) );
+}
+
+// sets a single tile and updates the jump distances that it affects
+void jps_SetWalkable( JPSGrid* grid, int x, int y, bool walkable )
+{
+	ASSERT( grid != NULL );
+
+	if( ( x < 0 ) || ( y < 0 ) || ( x >= grid->width ) || ( y >= grid->height ) ) {
+		return;
+	}
+
+	if( jps_IsWalkable( grid, x, y ) == walkable ) {
+		return;
+	}
+
+	setWalkableBit( grid, x, y, walkable );
+
+	// jump points for straight movement depend on the tiles to either side, so the rows and columns next to the tile
+	//  can change as well
+	for( int row = y - 1; row <= y + 1; ++row ) {
+		if( ( row < 0 ) || ( row >= grid->height ) ) continue;
+		rebuildLine( grid, 0, row, 0 );
+		rebuildLine( grid, 0, row, 4 );
+	}
+
+	for( int column = x - 1; column <= x + 1; ++column ) {
+		if( ( column < 0 ) || ( column >= grid->width ) ) continue;
+		rebuildLine( grid, column, 0, 2 );
+		rebuildLine( grid, column, 0, 6 );
+	}
+
+	// diagonals depend on the straight distances of the next tile, so anything that steps onto the rows and columns
+	//  that were rebuilt has to be checked, along with the tiles that can't cut the corner of this tile
+	for( int dir = 1; dir < NUM_DIRECTIONS; dir += 2 ) {
+		int dx = dirX[dir];
+		int dy = dirY[dir];
+
+		for( int row = y - 1; row <= y + 1; ++row ) {
+			for( int i = 0; i < grid->width; ++i ) {
+				updateDiagonal( grid, i - dx, row - dy, dir );
+			}
+		}
+
+		for( int column = x - 1; column <= x + 1; ++column ) {
+			for( int i = 0; i < grid->height; ++i ) {
+				updateDiagonal( grid, column - dx, i - dy, dir );
+			}
+		}
+
+		updateDiagonal( grid, x, y, dir );
+		updateDiagonal( grid, x - dx, y, dir );
+		updateDiagonal( grid, x, y - dy, dir );
+	}
+}
+
+// sets every tile from width * height bytes, anything that isn't zero is walkable, and rebuilds all the jump distances
+void jps_SetAllWalkable( JPSGrid* grid, const uint8_t* walkable )
+{
+	ASSERT( grid != NULL );
+	ASSERT( walkable != NULL );
+
+	for( int y = 0; y < grid->height; ++y ) {
+		for( int x = 0; x < grid->width; ++x ) {
+			setWalkableBit( grid, x, y, walkable[x + ( y * grid->width )] != 0 );
+		}
+	}
+
+	rebuildAll( grid );
+}
+
+// finds a path using the context for the node records and open heap, so it can be shared with the A* searches
+//  the path is every tile from the target back to the tile after the start, the same as aStar_GetPath( )
+//  returns whether a path was found, context->numExpansions has the number of jump points expanded
+bool jps_FindPath( const JPSGrid* grid, AStarContext* context, int startX, int startY, int targetX, int targetY,
+	int** sbOutPath )
+{
+	ASSERT( grid != NULL );
+	ASSERT( context != NULL );
+
+	aStar_ResetContext( context, (size_t)grid->width * (size_t)grid->height );
+
+	if( !jps_IsWalkable( grid, startX, startY ) || !jps_IsWalkable( grid, targetX, targetY ) ) {
+		return false;
+	}
+
+	int startID = startX + ( startY * grid->width );
+	int targetID = targetX + ( targetY * grid->width );
+	context->startNodeID = startID;
+	context->targetNodeID = targetID;
+
+	aStar_OpenNode( context, startID, startID, 0.0f, octileDistance( targetX - startX, targetY - startY ) );
+
+	int currentID;
+	while( ( currentID = aStar_PopOpenNode( context ) ) != -1 ) {
+		if( currentID == targetID ) {
+			context->found = true;
+			break;
+		}
+
+		int x = currentID % grid->width;
+		int y = currentID / grid->width;
+		AStarNodeRecord* current = aStar_GetNodeRecord( context, currentID );
+		float currentCost = current->cost;
+
+		uint8_t directions = ALL_DIRECTIONS;
+		if( current->from != currentID ) {
+			directions = validDirections( directionFromDelta( x - ( current->from % grid->width ), y - ( current->from / grid->width ) ) );
+		}
+
+		const int16_t* distances = getJumpDistances( grid, x, y );
+		int toTargetX = targetX - x;
+		int toTargetY = targetY - y;
+
+		for( int dir = 0; dir < NUM_DIRECTIONS; ++dir ) {
+			if( !( directions & ( 1 << dir ) ) ) continue;
+
+			int distance = distances[dir];
+			int reach = abs( distance );
+			int steps = 0;
+
+			// the target isn't a jump point, so stop on it or on the row or column it's in if we can get there
+			if( IS_STRAIGHT( dir ) ) {
+				bool inLine = ( dirX[dir] != 0 ) ?
+					( ( toTargetY == 0 ) && ( sign( toTargetX ) == dirX[dir] ) ) :
+					( ( toTargetX == 0 ) && ( sign( toTargetY ) == dirY[dir] ) );
+				int toTarget = abs( toTargetX ) + abs( toTargetY );
+				if( inLine && ( toTarget <= reach ) ) {
+					steps = toTarget;
+				}
+			} else if( ( sign( toTargetX ) == dirX[dir] ) && ( sign( toTargetY ) == dirY[dir] ) ) {
+				int toTargetLine = SDL_min( abs( toTargetX ), abs( toTargetY ) );
+				if( toTargetLine <= reach ) {
+					steps = toTargetLine;
+				}
+			}
+
+			if( ( steps == 0 ) && ( distance > 0 ) ) {
+				steps = distance;
+			}
+
+			if( steps == 0 ) continue;
+
+			int nextX = x + ( dirX[dir] * steps );
+			int nextY = y + ( dirY[dir] * steps );
+			float cost = currentCost + ( (float)steps * ( IS_STRAIGHT( dir ) ? 1.0f : SQRT_2 ) );
+			aStar_OpenNode( context, nextX + ( nextY * grid->width ), currentID, cost,
+				octileDistance( targetX - nextX, targetY - nextY ) );
+		}
+	}
+
+	if( !context->found ) {
+		return false;
+	}
+
+	if( sbOutPath != NULL ) {
+		// fill in the tiles between the jump points
+		int current = targetID;
+		while( current != startID ) {
+			int from = context->sbNodes[current].from;
+			int x = current % grid->width;
+			int y = current / grid->width;
+			int fromX = from % grid->width;
+			int fromY = from / grid->width;
+			int stepX = sign( fromX - x );
+			int stepY = sign( fromY - y );
+			while( ( x != fromX ) || ( y != fromY ) ) {
+				sb_Push( ( *sbOutPath ), x + ( y * grid->width ) );
+				x += stepX;
+				y += stepY;
+			}
+			current = from;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,46 @@
+#ifndef JUMP_POINT_SEARCH_H
+#define JUMP_POINT_SEARCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Utils/aStar.h"
+
+// Jump point search over a uniform cost tile grid, using precomputed jump distances (JPS+). Movement is in eight
+//  directions, straight moves cost 1 and diagonal moves cost sqrt(2), diagonal moves can't cut the corners of blocked
+//  tiles. Finds paths with the same cost A* would on the same grid but only expands the tiles where the path could
+//  turn, so on open maps it expands a tiny fraction of what A* does.
+//
+// Each tile stores the distance it can travel in each direction before hitting a jump point (positive) or a wall
+//  (zero or negative), changing a tile only recomputes the rows, columns, and diagonals that can see it.
+//
+// Node ids are x + ( y * width ), the same as what the A* callbacks would use for the grid.
+typedef struct {
+	int width;
+	int height;
+
+	int wordsPerRow;
+	uint64_t* walkable; // packed, one bit per tile
+
+	int16_t* jumpDistances; // eight per tile
+} JPSGrid;
+
+// creates a grid with every tile walkable, width and height have to be less than 32768
+bool jps_CreateGrid( JPSGrid* grid, int width, int height );
+void jps_DestroyGrid( JPSGrid* grid );
+
+bool jps_IsWalkable( const JPSGrid* grid, int x, int y );
+
+// sets a single tile and updates the jump distances that it affects
+void jps_SetWalkable( JPSGrid* grid, int x, int y, bool walkable );
+
+// sets every tile from width * height bytes, anything that isn't zero is walkable, and rebuilds all the jump distances
+void jps_SetAllWalkable( JPSGrid* grid, const uint8_t* walkable );
+
+// finds a path using the context for the node records and open heap, so it can be shared with the A* searches
+//  the path is every tile from the target back to the tile after the start, the same as aStar_GetPath( )
+//  returns whether a path was found, context->numExpansions has the number of jump points expanded
+bool jps_FindPath( const JPSGrid* grid, AStarContext* context, int startX, int startY, int targetX, int targetY,
+	int** sbOutPath );
+
+#endif // inclusion guard
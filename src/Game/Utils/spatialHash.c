@@ -0,0 +1,182 @@
+#include "spatialHash.h"
+
+#include <math.h>
+#include <string.h>
+#include <SDL3/SDL.h>
+
+#include "helpers.h"
+#include "Math/mathUtil.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+
+static int32_t toCell( const SpatialHash* hash, float v )
+{
+	return (int32_t)floorf( v * hash->invCellSize );
+}
+
+static uint64_t cellKey( int32_t x, int32_t y )
+{
+	return ( (uint64_t)(uint32_t)x << 32 ) | (uint64_t)(uint32_t)y;
+}
+
+static uint32_t cellBucket( const SpatialHash* hash, int32_t x, int32_t y )
+{
+	return ( ( (uint32_t)x * 73856093u ) ^ ( (uint32_t)y * 19349663u ) ) & hash->bucketMask;
+}
+
+bool spatialHash_Init( SpatialHash* hash, float cellSize, uint32_t numBuckets )
+{
+	ASSERT( hash != NULL );
+	ASSERT( cellSize > 0.0f );
+
+	memset( hash, 0, sizeof( SpatialHash ) );
+
+	uint32_t size = 1;
+	while( ( size < numBuckets ) && ( size < 0x80000000u ) ) {
+		size *= 2;
+	}
+
+	hash->cellSize = cellSize;
+	hash->invCellSize = 1.0f / cellSize;
+	hash->bucketMask = size - 1;
+	hash->bucketStarts = mem_Allocate( sizeof( uint32_t ) * ( (size_t)size + 1 ) );
+	if( hash->bucketStarts == NULL ) {
+		llog( LOG_ERROR, "Unable to allocate buckets for spatial hash." );
+		return false;
+	}
+	memset( hash->bucketStarts, 0, sizeof( uint32_t ) * ( (size_t)size + 1 ) );
+
+	return true;
+}
+
+static void releasePoints( SpatialHash* hash )
+{
+	mem_Release( hash->indices );
+	mem_Release( hash->cells );
+	mem_Release( hash->xs );
+	mem_Release( hash->ys );
+	mem_Release( hash->scratchBuckets );
+
+	hash->indices = NULL;
+	hash->cells = NULL;
+	hash->xs = NULL;
+	hash->ys = NULL;
+	hash->scratchBuckets = NULL;
+	hash->capacity = 0;
+}
+
+void spatialHash_Destroy( SpatialHash* hash )
+{
+	ASSERT( hash != NULL );
+
+	releasePoints( hash );
+	mem_Release( hash->bucketStarts );
+	memset( hash, 0, sizeof( SpatialHash ) );
+}
+
+static bool reservePoints( SpatialHash* hash, size_t count )
+{
+	if( count <= hash->capacity ) return true;
+
+	size_t capacity = MAX( count, hash->capacity * 2 );
+	releasePoints( hash );
+
+	hash->indices = mem_Allocate( sizeof( uint32_t ) * capacity );
+	hash->cells = mem_Allocate( sizeof( uint64_t ) * capacity );
+	hash->xs = mem_Allocate( sizeof( float ) * capacity );
+	hash->ys = mem_Allocate( sizeof( float ) * capacity );
+	hash->scratchBuckets = mem_Allocate( sizeof( uint32_t ) * capacity );
+	if( ( hash->indices == NULL ) || ( hash->cells == NULL ) || ( hash->xs == NULL ) || ( hash->ys == NULL ) || ( hash->scratchBuckets == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate points for spatial hash." );
+		releasePoints( hash );
+		return false;
+	}
+	hash->capacity = capacity;
+
+	return true;
+}
+
+bool spatialHash_Build( SpatialHash* hash, const float* xs, const float* ys, size_t count )
+{
+	ASSERT( hash != NULL );
+	ASSERT( ( xs != NULL ) || ( count == 0 ) );
+	ASSERT( ( ys != NULL ) || ( count == 0 ) );
+	ASSERT( count < UINT32_MAX );
+
+	hash->count = 0;
+	size_t numBuckets = (size_t)hash->bucketMask + 1;
+	memset( hash->bucketStarts, 0, sizeof( uint32_t ) * ( numBuckets + 1 ) );
+
+	if( !reservePoints( hash, count ) ) {
+		return false;
+	}
+
+	// count how many points are in each bucket
+	for( size_t i = 0; i < count; ++i ) {
+		uint32_t bucket = cellBucket( hash, toCell( hash, xs[i] ), toCell( hash, ys[i] ) );
+		hash->scratchBuckets[i] = bucket;
+		++hash->bucketStarts[bucket];
+	}
+
+	// turn the counts into where each bucket ends
+	uint32_t total = 0;
+	for( size_t b = 0; b < numBuckets; ++b ) {
+		total += hash->bucketStarts[b];
+		hash->bucketStarts[b] = total;
+	}
+	hash->bucketStarts[numBuckets] = total;
+
+	// fill in from the back so each bucket ends up at its start and the points stay in the order they were passed in
+	for( size_t i = count; i > 0; --i ) {
+		size_t src = i - 1;
+		uint32_t dest = --hash->bucketStarts[hash->scratchBuckets[src]];
+		hash->indices[dest] = (uint32_t)src;
+		hash->cells[dest] = cellKey( toCell( hash, xs[src] ), toCell( hash, ys[src] ) );
+		hash->xs[dest] = xs[src];
+		hash->ys[dest] = ys[src];
+	}
+
+	hash->count = count;
+	return true;
+}
+
+size_t spatialHash_Query( const SpatialHash* hash, Vector2 center, float radius, uint32_t* outIndices, float* outDistSqrd, size_t maxResults )
+{
+	ASSERT( hash != NULL );
+	ASSERT( outIndices != NULL );
+	ASSERT( radius >= 0.0f );
+
+	if( ( hash->count == 0 ) || ( maxResults == 0 ) ) return 0;
+
+	float radiusSqrd = radius * radius;
+	int32_t minX = toCell( hash, center.x - radius );
+	int32_t maxX = toCell( hash, center.x + radius );
+	int32_t minY = toCell( hash, center.y - radius );
+	int32_t maxY = toCell( hash, center.y + radius );
+
+	size_t found = 0;
+	for( int32_t y = minY; y <= maxY; ++y ) {
+		for( int32_t x = minX; x <= maxX; ++x ) {
+			uint32_t bucket = cellBucket( hash, x, y );
+			uint64_t key = cellKey( x, y );
+			uint32_t end = hash->bucketStarts[bucket + 1];
+			for( uint32_t i = hash->bucketStarts[bucket]; i < end; ++i ) {
+				if( hash->cells[i] != key ) continue;
+
+				float dx = hash->xs[i] - center.x;
+				float dy = hash->ys[i] - center.y;
+				float distSqrd = ( dx * dx ) + ( dy * dy );
+				if( distSqrd > radiusSqrd ) continue;
+
+				outIndices[found] = hash->indices[i];
+				if( outDistSqrd != NULL ) {
+					outDistSqrd[found] = distSqrd;
+				}
+				++found;
+				if( found >= maxResults ) return found;
+			}
+		}
+	}
+
+	return found;
+}
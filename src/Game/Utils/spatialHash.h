@@ -0,0 +1,51 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Math/vector2.h"
+
+// Uniform grid for finding points near each other, meant to be rebuilt from scratch every tick. Space is split into
+//  square cells that are hashed into a fixed number of buckets, so there are no bounds on where the points can be.
+//  Building counts the points in each bucket and then sorts them into one array with the points in the same bucket
+//  next to each other, no allocating once it's big enough.
+//
+// Queries check every bucket the circle touches and return the points inside it. Cells that hash into the same
+//  bucket are told apart by the cell stored with each point. For the fewest checks the cell size should be about the
+//  radius used for queries.
+//
+// The positions are copied when built, queries don't need the arrays passed into spatialHash_Build( ).
+
+typedef struct {
+	float cellSize;
+	float invCellSize;
+
+	uint32_t bucketMask;
+	uint32_t* bucketStarts; // bucketMask + 2 entries, the points in bucket b are from bucketStarts[b] to bucketStarts[b+1]
+
+	size_t count;
+	size_t capacity;
+
+	// sorted by bucket
+	uint32_t* indices; // index of the point passed into spatialHash_Build( )
+	uint64_t* cells;
+	float* xs;
+	float* ys;
+
+	uint32_t* scratchBuckets;
+} SpatialHash;
+
+// numBuckets is rounded up to a power of two, about the number of points expected is a good default
+bool spatialHash_Init( SpatialHash* hash, float cellSize, uint32_t numBuckets );
+void spatialHash_Destroy( SpatialHash* hash );
+
+// replaces everything in the hash with the points, the index of each point is its index in the arrays
+bool spatialHash_Build( SpatialHash* hash, const float* xs, const float* ys, size_t count );
+
+// finds the points within radius of center, writing up to maxResults of their indices to outIndices and the squared
+//  distances to outDistSqrd if it isn't NULL, returns how many were written
+size_t spatialHash_Query( const SpatialHash* hash, Vector2 center, float radius, uint32_t* outIndices, float* outDistSqrd, size_t maxResults );
+
+#endif // inclusion guard
@@ -0,0 +1,501 @@
+#include "steering.h"
+
+#include <math.h>
+#include <string.h>
+#include <SDL3/SDL.h>
+
+#include "helpers.h"
+#include "Math/mathUtil.h"
+#include "System/jobQueue.h"
+#include "System/memory.h"
+#include "System/platformLog.h"
+#include "System/random.h"
+
+// how many agents each flocking job handles at a time
+#define FLOCK_CHUNK_SIZE 256
+
+// starting room for the neighbors of an agent in each flocking job, grows if more are found
+#define FLOCK_START_SCRATCH_SIZE ( STEERING_MAX_NEIGHBORS * 4 )
+
+//************************************
+// Basic Steering Behaviors
+//  For these we just return the desired velocity, the magnitude represents how much of their max speed they will want to use
+void steering_Seek( Vector2* pos, Vector2* target, Vector2* out )
+{
+	ASSERT( pos != NULL );
+	ASSERT( target != NULL );
+	ASSERT( out != NULL );
+
+	vec2_Subtract( target, pos, out );
+	vec2_Normalize( out );
+}
+
+void steering_Flee( Vector2* pos, Vector2* target, Vector2* out )
+{
+	ASSERT( pos != NULL );
+	ASSERT( target != NULL );
+	ASSERT( out != NULL );
+
+	vec2_Subtract( pos, target, out );
+	vec2_Normalize( out );
+}
+
+void steering_Arrive( Vector2* pos, Vector2* target, float innerRadius, float outerRadius, Vector2* out )
+{
+	ASSERT( pos != NULL );
+	ASSERT( target != NULL );
+	ASSERT( out != NULL );
+	ASSERT( innerRadius <= outerRadius );
+
+	vec2_Subtract( target, pos, out );
+	float dist = vec2_Normalize( out );
+
+	float speed = inverseLerp( innerRadius, outerRadius, dist );
+	vec2_Scale( out, speed, out );
+}
+
+void steering_Wandering( Vector2* pos, Vector2* vel, Vector2* currWanderTarget, float radius, float offset, float displacement, Vector2* newWanderTargetOut, Vector2* desiredVelocityOut )
+{
+	ASSERT( pos != NULL );
+	ASSERT( vel != NULL );
+	ASSERT( desiredVelocityOut != NULL );
+	ASSERT( currWanderTarget != NULL );
+	ASSERT( newWanderTargetOut != NULL );
+	ASSERT( radius > 0.0f );
+
+	// we'll use the circle method, we'll need a target that is stored as an offset from the current position
+
+	// find circle center
+	Vector2 circleCenter = ( *vel );
+	vec2_Normalize( &circleCenter );
+	vec2_Scale( &circleCenter, offset, &circleCenter );
+
+	// create displaced target
+	(*newWanderTargetOut) = vec2( rand_GetToleranceFloat( NULL, 0.0f, displacement ), rand_GetToleranceFloat( NULL, 0.0f, displacement ) );
+	vec2_Add( currWanderTarget, newWanderTargetOut, newWanderTargetOut );
+
+	// project displaced target onto circle
+	Vector2 diff;
+	vec2_Subtract( newWanderTargetOut, &circleCenter, &diff );
+	vec2_Normalize( &diff );
+	vec2_AddScaled( &circleCenter, &diff, radius, newWanderTargetOut );
+
+	( *desiredVelocityOut ) = ( *newWanderTargetOut );
+	vec2_Normalize( desiredVelocityOut );
+}
+
+bool steering_FollowFlowField( Vector2* pos, FlowFieldMap* map, FlowField* field, Vector2* target, float innerRadius, float outerRadius, Vector2* out )
+{
+	ASSERT( pos != NULL );
+	ASSERT( map != NULL );
+	ASSERT( field != NULL );
+	ASSERT( target != NULL );
+	ASSERT( out != NULL );
+
+	if( flow_GetDirection( map, field, *pos, out ) ) {
+		return true;
+	}
+
+	if( flow_PositionToCell( map, *pos ) == field->goal ) {
+		steering_Arrive( pos, target, innerRadius, outerRadius, out );
+		return true;
+	}
+
+	( *out ) = VEC2_ZERO;
+	return false;
+}
+
+//************************************
+// Batches
+
+static void releaseAgentArrays( SteeringAgents* agents )
+{
+	mem_Release( agents->posX );
+	mem_Release( agents->posY );
+	mem_Release( agents->velX );
+	mem_Release( agents->velY );
+	mem_Release( agents->desiredX );
+	mem_Release( agents->desiredY );
+	memset( agents, 0, sizeof( SteeringAgents ) );
+}
+
+bool steering_CreateAgents( SteeringAgents* agents, size_t capacity )
+{
+	ASSERT( agents != NULL );
+	ASSERT( capacity > 0 );
+
+	memset( agents, 0, sizeof( SteeringAgents ) );
+
+	agents->posX = mem_Allocate( sizeof( float ) * capacity );
+	agents->posY = mem_Allocate( sizeof( float ) * capacity );
+	agents->velX = mem_Allocate( sizeof( float ) * capacity );
+	agents->velY = mem_Allocate( sizeof( float ) * capacity );
+	agents->desiredX = mem_Allocate( sizeof( float ) * capacity );
+	agents->desiredY = mem_Allocate( sizeof( float ) * capacity );
+	if( ( agents->posX == NULL ) || ( agents->posY == NULL ) || ( agents->velX == NULL ) || ( agents->velY == NULL ) ||
+		( agents->desiredX == NULL ) || ( agents->desiredY == NULL ) ) {
+		llog( LOG_ERROR, "Unable to allocate steering agents." );
+		releaseAgentArrays( agents );
+		return false;
+	}
+	agents->capacity = capacity;
+
+	return true;
+}
+
+void steering_DestroyAgents( SteeringAgents* agents )
+{
+	ASSERT( agents != NULL );
+
+	releaseAgentArrays( agents );
+}
+
+int steering_AddAgent( SteeringAgents* agents, Vector2 pos, Vector2 vel )
+{
+	ASSERT( agents != NULL );
+
+	if( agents->count >= agents->capacity ) {
+		return -1;
+	}
+
+	size_t idx = agents->count;
+	agents->posX[idx] = pos.x;
+	agents->posY[idx] = pos.y;
+	agents->velX[idx] = vel.x;
+	agents->velY[idx] = vel.y;
+	agents->desiredX[idx] = 0.0f;
+	agents->desiredY[idx] = 0.0f;
+	++agents->count;
+
+	return (int)idx;
+}
+
+void steering_ClearDesired( SteeringAgents* agents )
+{
+	ASSERT( agents != NULL );
+
+	memset( agents->desiredX, 0, sizeof( float ) * agents->count );
+	memset( agents->desiredY, 0, sizeof( float ) * agents->count );
+}
+
+void steering_BatchSeek( SteeringAgents* agents, Vector2 target, float weight )
+{
+	ASSERT( agents != NULL );
+
+	for( size_t i = 0; i < agents->count; ++i ) {
+		float dx = target.x - agents->posX[i];
+		float dy = target.y - agents->posY[i];
+		float dist = sqrtf( ( dx * dx ) + ( dy * dy ) );
+		if( dist > 0.0f ) {
+			float scale = weight / dist;
+			agents->desiredX[i] += dx * scale;
+			agents->desiredY[i] += dy * scale;
+		}
+	}
+}
+
+void steering_BatchFlee( SteeringAgents* agents, Vector2 target, float weight )
+{
+	steering_BatchSeek( agents, target, -weight );
+}
+
+void steering_BatchArrive( SteeringAgents* agents, Vector2 target, float innerRadius, float outerRadius, float weight )
+{
+	ASSERT( agents != NULL );
+	ASSERT( innerRadius <= outerRadius );
+
+	for( size_t i = 0; i < agents->count; ++i ) {
+		float dx = target.x - agents->posX[i];
+		float dy = target.y - agents->posY[i];
+		float dist = sqrtf( ( dx * dx ) + ( dy * dy ) );
+		if( dist > 0.0f ) {
+			float scale = weight * inverseLerp( innerRadius, outerRadius, dist ) / dist;
+			agents->desiredX[i] += dx * scale;
+			agents->desiredY[i] += dy * scale;
+		}
+	}
+}
+
+typedef struct {
+	SteeringAgents* agents;
+	const SpatialHash* hash;
+	const FlockSettings* settings;
+	int numChunks;
+	SDL_AtomicInt nextChunk;
+	SDL_AtomicInt lanesDone;
+} FlockTask;
+
+// everything found by a query, so the nearest can be picked out of it
+typedef struct {
+	size_t capacity;
+	uint32_t* neighbors;
+	float* distsSqrd;
+} FlockScratch;
+
+static bool growFlockScratch( FlockScratch* scratch, size_t capacity )
+{
+	uint32_t* neighbors = mem_Resize( scratch->neighbors, sizeof( uint32_t ) * capacity );
+	if( neighbors == NULL ) return false;
+	scratch->neighbors = neighbors;
+
+	float* distsSqrd = mem_Resize( scratch->distsSqrd, sizeof( float ) * capacity );
+	if( distsSqrd == NULL ) return false;
+	scratch->distsSqrd = distsSqrd;
+
+	scratch->capacity = capacity;
+	return true;
+}
+
+// the query stops when it runs out of room, and it always goes through the cells in the same order, so if it filled up
+//  there could be closer agents it never got to
+static size_t queryAllNeighbors( const SpatialHash* hash, Vector2 pos, float radius, FlockScratch* scratch )
+{
+	for( ;; ) {
+		size_t numFound = spatialHash_Query( hash, pos, radius, scratch->neighbors, scratch->distsSqrd, scratch->capacity );
+		if( numFound < scratch->capacity ) return numFound;
+		if( !growFlockScratch( scratch, MAX( scratch->capacity * 2, (size_t)FLOCK_START_SCRATCH_SIZE ) ) ) return numFound;
+	}
+}
+
+static void swapNeighbors( FlockScratch* scratch, size_t a, size_t b )
+{
+	uint32_t neighbor = scratch->neighbors[a];
+	scratch->neighbors[a] = scratch->neighbors[b];
+	scratch->neighbors[b] = neighbor;
+
+	float distSqrd = scratch->distsSqrd[a];
+	scratch->distsSqrd[a] = scratch->distsSqrd[b];
+	scratch->distsSqrd[b] = distSqrd;
+}
+
+// partially sorts the neighbors so the nearest numKeep are at the start, in no particular order, numKeep has to be
+//  less than count
+static void keepNearestNeighbors( FlockScratch* scratch, size_t count, size_t numKeep )
+{
+	size_t low = 0;
+	size_t high = count - 1;
+	while( low < high ) {
+		size_t mid = low + ( ( high - low ) / 2 );
+		float pivot = scratch->distsSqrd[mid];
+		swapNeighbors( scratch, mid, high );
+
+		size_t store = low;
+		for( size_t i = low; i < high; ++i ) {
+			if( scratch->distsSqrd[i] < pivot ) {
+				swapNeighbors( scratch, i, store );
+				++store;
+			}
+		}
+		swapNeighbors( scratch, store, high );
+
+		if( store == numKeep ) return;
+		if( store < numKeep ) {
+			low = store + 1;
+		} else {
+			high = store - 1;
+		}
+	}
+}
+
+static void flockAgent( FlockTask* task, size_t idx, FlockScratch* scratch )
+{
+	SteeringAgents* agents = task->agents;
+	const FlockSettings* settings = task->settings;
+
+	Vector2 pos = vec2( agents->posX[idx], agents->posY[idx] );
+
+	size_t numFound = queryAllNeighbors( task->hash, pos, settings->neighborRadius, scratch );
+	for( size_t n = 0; n < numFound; ++n ) {
+		if( scratch->neighbors[n] == idx ) {
+			--numFound;
+			swapNeighbors( scratch, n, numFound );
+			break;
+		}
+	}
+
+	size_t maxNeighbors = (size_t)MIN( MAX( settings->maxNeighbors, 0 ), STEERING_MAX_NEIGHBORS );
+	if( numFound > maxNeighbors ) {
+		if( maxNeighbors > 0 ) {
+			keepNearestNeighbors( scratch, numFound, maxNeighbors );
+		}
+		numFound = maxNeighbors;
+	}
+
+	const uint32_t* neighbors = scratch->neighbors;
+	const float* distsSqrd = scratch->distsSqrd;
+
+	float sepRadiusSqrd = settings->separationRadius * settings->separationRadius;
+	float sepX = 0.0f;
+	float sepY = 0.0f;
+	float velX = 0.0f;
+	float velY = 0.0f;
+	float centerX = 0.0f;
+	float centerY = 0.0f;
+	int count = 0;
+
+	for( size_t n = 0; n < numFound; ++n ) {
+		uint32_t other = neighbors[n];
+
+		float dx = pos.x - agents->posX[other];
+		float dy = pos.y - agents->posY[other];
+
+		// push away harder the closer they are
+		if( ( distsSqrd[n] < sepRadiusSqrd ) && ( distsSqrd[n] > 0.0f ) ) {
+			float dist = sqrtf( distsSqrd[n] );
+			float push = ( 1.0f - ( dist / settings->separationRadius ) ) / dist;
+			sepX += dx * push;
+			sepY += dy * push;
+		}
+
+		velX += agents->velX[other];
+		velY += agents->velY[other];
+		centerX += agents->posX[other];
+		centerY += agents->posY[other];
+		++count;
+	}
+
+	if( count == 0 ) return;
+
+	float desiredX = sepX * settings->separationWeight;
+	float desiredY = sepY * settings->separationWeight;
+
+	// line up with the direction the neighbors are heading
+	float velMag = sqrtf( ( velX * velX ) + ( velY * velY ) );
+	if( velMag > 0.0f ) {
+		desiredX += velX * ( settings->alignmentWeight / velMag );
+		desiredY += velY * ( settings->alignmentWeight / velMag );
+	}
+
+	// move toward the center of the neighbors, slower the closer it is
+	float invCount = 1.0f / (float)count;
+	float cohesion = settings->cohesionWeight / settings->neighborRadius;
+	desiredX += ( ( centerX * invCount ) - pos.x ) * cohesion;
+	desiredY += ( ( centerY * invCount ) - pos.y ) * cohesion;
+
+	agents->desiredX[idx] += desiredX;
+	agents->desiredY[idx] += desiredY;
+}
+
+static void flockLane( void* data )
+{
+	FlockTask* task = (FlockTask*)data;
+
+	FlockScratch scratch;
+	SDL_zero( scratch );
+	if( !growFlockScratch( &scratch, FLOCK_START_SCRATCH_SIZE ) ) {
+		llog( LOG_ERROR, "Unable to allocate room for flocking neighbors." );
+	}
+
+	int chunk = SDL_AddAtomicInt( &( task->nextChunk ), 1 );
+	while( chunk < task->numChunks ) {
+		size_t start = (size_t)chunk * FLOCK_CHUNK_SIZE;
+		size_t end = MIN( start + FLOCK_CHUNK_SIZE, task->agents->count );
+		for( size_t i = start; i < end; ++i ) {
+			flockAgent( task, i, &scratch );
+		}
+		chunk = SDL_AddAtomicInt( &( task->nextChunk ), 1 );
+	}
+
+	mem_Release( scratch.neighbors );
+	mem_Release( scratch.distsSqrd );
+
+	SDL_AddAtomicInt( &( task->lanesDone ), 1 );
+}
+
+void steering_Flock( SteeringAgents* agents, const SpatialHash* hash, const FlockSettings* settings )
+{
+	ASSERT( agents != NULL );
+	ASSERT( hash != NULL );
+	ASSERT( settings != NULL );
+	ASSERT( hash->count == agents->count );
+	ASSERT( settings->neighborRadius > 0.0f );
+
+	if( agents->count == 0 ) return;
+
+	// each agent only writes to its own desired velocity so the chunks can be done in any order
+	FlockTask task;
+	task.agents = agents;
+	task.hash = hash;
+	task.settings = settings;
+	task.numChunks = (int)( ( agents->count + FLOCK_CHUNK_SIZE - 1 ) / FLOCK_CHUNK_SIZE );
+	SDL_SetAtomicInt( &( task.nextChunk ), 0 );
+	SDL_SetAtomicInt( &( task.lanesDone ), 0 );
+
+	// not worth the overhead of a job
+	if( task.numChunks == 1 ) {
+		flockLane( &task );
+		return;
+	}
+
+	int numLanes = MIN( MAX( jq_GetNumThreads( ), 1 ), task.numChunks );
+	int lanesQueued = 0;
+	for( int i = 0; i < numLanes; ++i ) {
+		if( jq_AddJob( flockLane, &task ) ) {
+			++lanesQueued;
+		}
+	}
+
+	if( lanesQueued == 0 ) {
+		flockLane( &task );
+		return;
+	}
+
+	// help out while waiting so this still finishes if there are no worker threads
+	while( SDL_GetAtomicInt( &( task.lanesDone ) ) < lanesQueued ) {
+		if( !jq_ProcessNextJob( ) ) {
+			SDL_Delay( 0 );
+		}
+	}
+}
+
+void steering_Integrate( SteeringAgents* agents, float maxSpeed, float maxAccel, float dt, const Vector2* min, const Vector2* max )
+{
+	ASSERT( agents != NULL );
+	ASSERT( ( min == NULL ) == ( max == NULL ) );
+
+	float maxChange = maxAccel * dt;
+	for( size_t i = 0; i < agents->count; ++i ) {
+		// desired velocities can't go over the max speed
+		float desiredX = agents->desiredX[i];
+		float desiredY = agents->desiredY[i];
+		float desiredMagSqrd = ( desiredX * desiredX ) + ( desiredY * desiredY );
+		if( desiredMagSqrd > 1.0f ) {
+			float invMag = 1.0f / sqrtf( desiredMagSqrd );
+			desiredX *= invMag;
+			desiredY *= invMag;
+		}
+
+		float changeX = ( desiredX * maxSpeed ) - agents->velX[i];
+		float changeY = ( desiredY * maxSpeed ) - agents->velY[i];
+		float changeMagSqrd = ( changeX * changeX ) + ( changeY * changeY );
+		if( changeMagSqrd > ( maxChange * maxChange ) ) {
+			float scale = maxChange / sqrtf( changeMagSqrd );
+			changeX *= scale;
+			changeY *= scale;
+		}
+
+		agents->velX[i] += changeX;
+		agents->velY[i] += changeY;
+		agents->posX[i] += agents->velX[i] * dt;
+		agents->posY[i] += agents->velY[i] * dt;
+
+		if( min != NULL ) {
+			// stop going into the edges
+			if( agents->posX[i] < min->x ) {
+				agents->posX[i] = min->x;
+				agents->velX[i] = MAX( agents->velX[i], 0.0f );
+			} else if( agents->posX[i] > max->x ) {
+				agents->posX[i] = max->x;
+				agents->velX[i] = MIN( agents->velX[i], 0.0f );
+			}
+
+			if( agents->posY[i] < min->y ) {
+				agents->posY[i] = min->y;
+				agents->velY[i] = MAX( agents->velY[i], 0.0f );
+			} else if( agents->posY[i] > max->y ) {
+				agents->posY[i] = max->y;
+				agents->velY[i] = MIN( agents->velY[i], 0.0f );
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#ifndef STEERING_H
+#define STEERING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Math/vector2.h"
+#include "Utils/flowField.h"
+#include "Utils/spatialHash.h"
+
+// Steering behaviors, these all work out the velocity the agent wants to have, the magnitude represents how much of
+//  its max speed it will want to use.
+
+void steering_Seek( Vector2* pos, Vector2* target, Vector2* out );
+void steering_Flee( Vector2* pos, Vector2* target, Vector2* out );
+void steering_Arrive( Vector2* pos, Vector2* target, float innerRadius, float outerRadius, Vector2* out );
+void steering_Wandering( Vector2* pos, Vector2* vel, Vector2* currWanderTarget, float radius, float offset, float displacement, Vector2* newWanderTargetOut, Vector2* desiredVelocityOut );
+
+// follows a flow field to its goal, the direction is just looked up so any number of vehicles can share the field,
+//  once in the goal cell it arrives at the target, returns false if the position can't reach the goal
+bool steering_FollowFlowField( Vector2* pos, FlowFieldMap* map, FlowField* field, Vector2* target, float innerRadius, float outerRadius, Vector2* out );
+
+//************************************
+// Batches
+//  For large numbers of agents the data is stored as separate arrays for each value. Each tick the desired velocities
+//  are cleared, the behaviors add their weighted results to them, and steering_Integrate( ) moves everything.
+
+#define STEERING_MAX_NEIGHBORS 32
+
+typedef struct {
+	size_t count;
+	size_t capacity;
+
+	float* posX;
+	float* posY;
+	float* velX;
+	float* velY;
+	float* desiredX;
+	float* desiredY;
+} SteeringAgents;
+
+typedef struct {
+	float neighborRadius; // how far away other agents are seen for alignment and cohesion
+	float separationRadius; // how close agents can get before they start pushing away from each other
+	float separationWeight;
+	float alignmentWeight;
+	float cohesionWeight;
+	int maxNeighbors; // only the nearest ones are used, at most STEERING_MAX_NEIGHBORS
+} FlockSettings;
+
+bool steering_CreateAgents( SteeringAgents* agents, size_t capacity );
+void steering_DestroyAgents( SteeringAgents* agents );
+
+// returns the index of the new agent, -1 if there's no room
+int steering_AddAgent( SteeringAgents* agents, Vector2 pos, Vector2 vel );
+
+void steering_ClearDesired( SteeringAgents* agents );
+void steering_BatchSeek( SteeringAgents* agents, Vector2 target, float weight );
+void steering_BatchFlee( SteeringAgents* agents, Vector2 target, float weight );
+void steering_BatchArrive( SteeringAgents* agents, Vector2 target, float innerRadius, float outerRadius, float weight );
+
+// separation, alignment, and cohesion, the hash has to have been built from the current positions with a cell size
+//  around the neighbor radius, the agents are split up across the job queue
+void steering_Flock( SteeringAgents* agents, const SpatialHash* hash, const FlockSettings* settings );
+
+// turns the velocities toward the desired ones, accelerating at most maxAccel, and moves the agents, if min and max
+//  aren't NULL the agents are kept inside them
+void steering_Integrate( SteeringAgents* agents, float maxSpeed, float maxAccel, float dt, const Vector2* min, const Vector2* max );
+
+#endif // inclusion guard
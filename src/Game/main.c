@@ -46,16 +46,20 @@
 #include "Game/testGamePadState.h"
 #include "Game/initialChoiceState.h"
 #include "Game/testScriptingState.h"
+#include "Game/benchmarks.h"
 
 #include "System/memory.h"
 #include "System/systems.h"
 #include "System/platformLog.h"
 #include "System/random.h"
 #include "System/luaInterface.h"
+#include "System/luaBytecodeCache.h"
+#include "System/pathService.h"
 
 #include "Graphics/debugRendering.h"
 #include "Graphics/Platform/OpenGL/glPlatform.h"
 #include "Graphics/gfxUtil.h"
+#include "Graphics/imageSheets.h"
 
 #include "System/jobQueue.h"
 #include "Utils/helpers.h"
@@ -150,6 +154,10 @@ float getWindowRefreshRate( SDL_Window* w )
 void cleanUp( void )
 {
 	xLua_ShutDown( );
+#if SCRIPTING_ENABLED
+	xLua_ClearBytecodeCache( );
+#endif
+	pathSvc_ShutDown( );
 	jq_ShutDown( );
 	gfx_ShutDown( );
 	snd_CleanUp( );
@@ -429,10 +437,17 @@ int initEverything( void )
 
 	jq_Initialize( 2 );
 
+	if( !pathSvc_Init( MAX( jq_GetNumThreads( ) - 1, 1 ) ) ) {
+		llog( LOG_ERROR, "Unable to initialize path service" );
+		return -1;
+	}
+
 	if( !xLua_Init( ) ) {
 		llog( LOG_ERROR, "Unable to intialize Lua" );
 		return -1;
 	}
+	// collect between frames instead of whenever a script happens to allocate
+	xLua_SetGCMode( XLUA_GC_FRAME_BUDGET );
 	llog( LOG_INFO, "Lua initialized" );
 
 	defaultECPS_Setup( );
@@ -663,6 +678,8 @@ void mainLoop( void* v )
 	float physicsTimerSec = 0.0f;
 	float drawTimerSec = 0.0f;
 	float mainJobsTimerSec = 0.0f;
+	float pathsTimerSec = 0.0f;
+	float luaGCTimerSec = 0.0f;
 	float renderTimerSec = 0.0f;
 	float flipTimerSec = 0.0f;
 #endif
@@ -772,6 +789,28 @@ void mainLoop( void* v )
 		mainJobsTimerSec = gt_StopTimer( mainJobsTimer );
 #endif
 
+#if defined( PROFILING_ENABLED )
+		Uint64 pathsTimer = gt_StartTimer( );
+#endif
+		{
+			// hand back any finished path requests, and run the searches here if there aren't any worker threads
+			pathSvc_Process( );
+		}
+#if defined( PROFILING_ENABLED )
+		pathsTimerSec = gt_StopTimer( pathsTimer );
+#endif
+
+#if defined( PROFILING_ENABLED )
+		Uint64 luaGCTimer = gt_StartTimer( );
+#endif
+		{
+			// everything that runs scripts is done for the frame
+			xLua_GCFrameStep( );
+		}
+#if defined( PROFILING_ENABLED )
+		luaGCTimerSec = gt_StopTimer( luaGCTimer );
+#endif
+
 		float dt = 0.0f;
 #if defined( PROFILING_ENABLED )
 		Uint64 renderTimer = gt_StartTimer( );
@@ -781,6 +820,7 @@ void mainLoop( void* v )
 			dt = (float)tickDelta / (float)SDL_GetPerformanceFrequency( );
 			gt_SetRenderTimeDelta( dt );
 			cam_Update( dt );
+			txt_FlushGlyphAtlas( );
 			gfx_Render( dt );
 		}
 #if defined( PROFILING_ENABLED )
@@ -804,9 +844,128 @@ void mainLoop( void* v )
 	if( mainTimerSec >= 0.04f ) {
 		priority = LOG_WARN;
 	}
-	llog( priority, "%sframeTime: %f - proc: %f, physics: %f, draw: %f, mainJobs: %f, render: %f, flip: %f",
+	XLuaGCFrameStats gcStats;
+	xLua_GetGCFrameStats( &gcStats );
+	llog( priority, "%sframeTime: %f - proc: %f, physics: %f, draw: %f, mainJobs: %f, paths: %f, luaGC: %f, render: %f, flip: %f",
 		priority == LOG_WARN ? "!!! " : "",
-		mainTimerSec, procTimerSec, physicsTimerSec, drawTimerSec, mainJobsTimerSec, renderTimerSec, flipTimerSec );
+		mainTimerSec, procTimerSec, physicsTimerSec, drawTimerSec, mainJobsTimerSec, pathsTimerSec, luaGCTimerSec, renderTimerSec, flipTimerSec );
+	llog( LOG_DEBUG, "  luaHeap: %u bytes, allocated: %u bytes in %u allocations, frees: %u, gcSteps: %u",
+		(uint32_t)gcStats.heapBytes, (uint32_t)gcStats.bytesAllocated, gcStats.numAllocations, gcStats.numFrees, gcStats.numSteps );
+#endif
+}
+
+// runs a benchmark without creating a window or setting up rendering, input, or audio, the benchmark is responsible
+//  for setting up anything else it needs
+static int runHeadlessBenchmark( int argc, char** argv )
+{
+	if( !mem_Init( 512 * 1024 * 1024 ) ) {
+		return 1;
+	}
+
+	SDL_SetLogPriorities( SDL_LOG_PRIORITY_INFO );
+
+	SDL_SetMainReady( );
+	if( !SDL_Init( 0 ) ) {
+		llog( LOG_ERROR, "Init Error: %s", SDL_GetError( ) );
+		return 1;
+	}
+
+	rand_Seed( NULL, 0 ); // want the same results every run
+	// a thread per core so the benchmarks that use the job queue can see how they scale
+	jq_Initialize( (uint8_t)SDL_clamp( SDL_GetNumLogicalCPUCores( ), 2, 64 ) );
+
+	int result = 0;
+	if( argc < 1 ) {
+		bench_LogAvailable( );
+		result = -1;
+	} else {
+		result = bench_Run( argv[0], argc - 1, argv + 1 );
+	}
+
+	jq_ShutDown( );
+	SDL_Quit( );
+	mem_CleanUp( );
+
+	return ( result == 0 ) ? 0 : 1;
+}
+
+// runs a benchmark that needs textures and the renderer, sets up everything like normal but never enters the main loop
+static int runRenderingBenchmark( int argc, char** argv )
+{
+	startWindowed = true;
+	if( initEverything( ) < 0 ) {
+		return 1;
+	}
+
+	// we want the results to show up with the rest of the output
+	SDL_SetLogOutputFunction( SDL_GetDefaultLogOutputFunction( ), NULL );
+	SDL_SetLogPriorities( SDL_LOG_PRIORITY_INFO );
+
+	int result = bench_Run( argv[0], argc - 1, argv + 1 );
+
+	// cleanUp( ) is handled by atexit
+	return ( result == 0 ) ? 0 : 1;
+}
+
+// converts a sprite sheet to the binary format without creating a window, the output defaults to replacing the input
+static int runSpriteSheetConversion( int argc, char** argv )
+{
+	if( argc < 1 ) {
+		llog( LOG_ERROR, "Usage: -convertSpriteSheet input [output]" );
+		return 1;
+	}
+
+	if( !mem_Init( 512 * 1024 * 1024 ) ) {
+		return 1;
+	}
+
+	SDL_SetLogPriorities( SDL_LOG_PRIORITY_INFO );
+
+	SDL_SetMainReady( );
+	if( !SDL_Init( 0 ) ) {
+		llog( LOG_ERROR, "Init Error: %s", SDL_GetError( ) );
+		return 1;
+	}
+
+	bool success = img_ConvertSpriteSheetToBinary( argv[0], ( argc > 1 ) ? argv[1] : argv[0] );
+
+	SDL_Quit( );
+	mem_CleanUp( );
+
+	return success ? 0 : 1;
+}
+
+// compiles every script in the directory to bytecode that can be shipped alongside or instead of the source
+static int runScriptPrecompile( int argc, char** argv )
+{
+#if SCRIPTING_ENABLED
+	if( argc < 1 ) {
+		llog( LOG_ERROR, "Usage: -precompileScripts directory [strip]" );
+		return 1;
+	}
+
+	if( !mem_Init( 512 * 1024 * 1024 ) ) {
+		return 1;
+	}
+
+	SDL_SetLogPriorities( SDL_LOG_PRIORITY_INFO );
+
+	SDL_SetMainReady( );
+	if( !SDL_Init( 0 ) ) {
+		llog( LOG_ERROR, "Init Error: %s", SDL_GetError( ) );
+		return 1;
+	}
+
+	bool strip = ( argc > 1 ) && ( SDL_strcmp( argv[1], "strip" ) == 0 );
+	int numFailed = xLua_PrecompileDirectory( argv[0], strip );
+
+	SDL_Quit( );
+	mem_CleanUp( );
+
+	return ( numFailed == 0 ) ? 0 : 1;
+#else
+	llog( LOG_ERROR, "Scripting isn't enabled." );
+	return 1;
 #endif
 }
 
@@ -824,6 +983,15 @@ int main( int argc, char** argv )
 			isEditorMode = true;
 			canResize = true;
 			startWindowed = true;
+		} else if( SDL_strcmp( argv[i], "-bench" ) == 0 ) {
+			if( ( ( i + 1 ) < argc ) && bench_NeedsRendering( argv[i + 1] ) ) {
+				return runRenderingBenchmark( argc - ( i + 1 ), argv + ( i + 1 ) );
+			}
+			return runHeadlessBenchmark( argc - ( i + 1 ), argv + ( i + 1 ) );
+		} else if( SDL_strcmp( argv[i], "-convertSpriteSheet" ) == 0 ) {
+			return runSpriteSheetConversion( argc - ( i + 1 ), argv + ( i + 1 ) );
+		} else if( SDL_strcmp( argv[i], "-precompileScripts" ) == 0 ) {
+			return runScriptPrecompile( argc - ( i + 1 ), argv + ( i + 1 ) );
 		}
 	}
 
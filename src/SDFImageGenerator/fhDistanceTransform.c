@@ -0,0 +1,242 @@
+/*
+ * Exact Euclidean distance transform using the separable algorithm from
+ *  Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions", Theory of Computing 2012.
+ *
+ * A 1D squared distance transform is done down every column and then along every row, each pass is linear in the
+ *  number of pixels. The columns in the first pass and the rows in the second don't depend on each other so they're
+ *  split up between threads. Everything is done in floats.
+ *
+ * Anti-aliased edges are handled by seeding edge pixels with their approximate distance to the edge, based on their
+ *  coverage, instead of treating them as fully in or out.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#if defined( _WIN32 )
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+#define FHDT_INF 1e20f
+
+// 1D squared distance transform of f, d[q] = min over p of ( ( q - p )^2 + f[p] )
+//  v needs n entries and z needs n + 1, they're scratch used to store the lower envelope of the parabolas
+static void fhdt1D( const float* f, int n, float* d, int* v, float* z )
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -FHDT_INF;
+	z[1] = FHDT_INF;
+
+	for( int q = 1; q < n; ++q ) {
+		// z[0] is -infinity so this will always stop at the first parabola
+		float fq = f[q] + (float)q * (float)q;
+		float s = ( fq - ( f[v[k]] + (float)v[k] * (float)v[k] ) ) / (float)( 2 * ( q - v[k] ) );
+		while( s <= z[k] ) {
+			--k;
+			s = ( fq - ( f[v[k]] + (float)v[k] * (float)v[k] ) ) / (float)( 2 * ( q - v[k] ) );
+		}
+
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = FHDT_INF;
+	}
+
+	k = 0;
+	for( int q = 0; q < n; ++q ) {
+		while( z[k + 1] < (float)q ) {
+			++k;
+		}
+		float dq = (float)( q - v[k] );
+		d[q] = ( dq * dq ) + f[v[k]];
+	}
+}
+
+typedef struct {
+	float* grid;
+	int width;
+	int height;
+	bool columns;
+	int first;
+	int last;
+	bool failed;
+} FHDTSlice;
+
+// transforms the columns or rows from first up to last, each slice has it's own scratch buffers
+static void fhdtRunSlice( FHDTSlice* slice )
+{
+	int n = slice->columns ? slice->height : slice->width;
+	float* f = malloc( sizeof( float ) * n );
+	float* d = malloc( sizeof( float ) * n );
+	float* z = malloc( sizeof( float ) * ( n + 1 ) );
+	int* v = malloc( sizeof( int ) * n );
+
+	if( ( f == NULL ) || ( d == NULL ) || ( z == NULL ) || ( v == NULL ) ) {
+		slice->failed = true;
+		goto clean_up;
+	}
+
+	int w = slice->width;
+	for( int line = slice->first; line < slice->last; ++line ) {
+		if( slice->columns ) {
+			for( int i = 0; i < n; ++i ) {
+				f[i] = slice->grid[line + ( i * w )];
+			}
+			fhdt1D( f, n, d, v, z );
+			for( int i = 0; i < n; ++i ) {
+				slice->grid[line + ( i * w )] = d[i];
+			}
+		} else {
+			float* row = slice->grid + ( line * w );
+			for( int i = 0; i < n; ++i ) {
+				f[i] = row[i];
+			}
+			fhdt1D( f, n, row, v, z );
+		}
+	}
+
+clean_up:
+	free( f );
+	free( d );
+	free( z );
+	free( v );
+}
+
+#if defined( _WIN32 )
+static DWORD WINAPI fhdtThreadProc( LPVOID data )
+{
+	fhdtRunSlice( (FHDTSlice*)data );
+	return 0;
+}
+#else
+static void* fhdtThreadProc( void* data )
+{
+	fhdtRunSlice( (FHDTSlice*)data );
+	return NULL;
+}
+#endif
+
+// splits the lines of the pass up between threads, the calling thread does the first slice
+static bool fhdtPass( float* grid, int w, int h, bool columns, int numThreads )
+{
+	int numLines = columns ? w : h;
+	if( numThreads > numLines ) numThreads = numLines;
+	if( numThreads < 1 ) numThreads = 1;
+
+	FHDTSlice* slices = malloc( sizeof( FHDTSlice ) * numThreads );
+	if( slices == NULL ) {
+		return false;
+	}
+
+#if defined( _WIN32 )
+	HANDLE* threads = malloc( sizeof( HANDLE ) * numThreads );
+#else
+	pthread_t* threads = malloc( sizeof( pthread_t ) * numThreads );
+#endif
+	bool* started = malloc( sizeof( bool ) * numThreads );
+	if( ( threads == NULL ) || ( started == NULL ) ) {
+		free( slices );
+		free( threads );
+		free( started );
+		return false;
+	}
+
+	for( int i = 0; i < numThreads; ++i ) {
+		slices[i].grid = grid;
+		slices[i].width = w;
+		slices[i].height = h;
+		slices[i].columns = columns;
+		slices[i].first = (int)( ( (long long)numLines * i ) / numThreads );
+		slices[i].last = (int)( ( (long long)numLines * ( i + 1 ) ) / numThreads );
+		slices[i].failed = false;
+		started[i] = false;
+	}
+
+	for( int i = 1; i < numThreads; ++i ) {
+#if defined( _WIN32 )
+		threads[i] = CreateThread( NULL, 0, fhdtThreadProc, &( slices[i] ), 0, NULL );
+		started[i] = ( threads[i] != NULL );
+#else
+		started[i] = ( pthread_create( &( threads[i] ), NULL, fhdtThreadProc, &( slices[i] ) ) == 0 );
+#endif
+	}
+
+	fhdtRunSlice( &( slices[0] ) );
+
+	bool success = true;
+	for( int i = 1; i < numThreads; ++i ) {
+		if( started[i] ) {
+#if defined( _WIN32 )
+			WaitForSingleObject( threads[i], INFINITE );
+			CloseHandle( threads[i] );
+#else
+			pthread_join( threads[i], NULL );
+#endif
+		} else {
+			// couldn't start the thread, just do it here
+			fhdtRunSlice( &( slices[i] ) );
+		}
+		success = success && !slices[i].failed;
+	}
+	success = success && !slices[0].failed;
+
+	free( slices );
+	free( threads );
+	free( started );
+
+	return success;
+}
+
+// Squared euclidean distance transform of grid in place, grid should be 0 at the seed pixels and FHDT_INF everywhere else.
+//  Values in between are treated as an extra squared distance to add for that seed.
+bool fhdt( float* grid, int w, int h, int numThreads )
+{
+	if( !fhdtPass( grid, w, h, true, numThreads ) ) return false;
+	if( !fhdtPass( grid, w, h, false, numThreads ) ) return false;
+	return true;
+}
+
+// Computes the distance from every pixel to the edge of the shape, where coverage is in the range [0,1]. The result is
+//  positive outside the shape and negative inside, same as subtracting the inside edtaa3 distance from the outside one.
+//  scratch needs to be the same size as the image.
+bool fhSignedDistance( const float* coverage, int w, int h, int numThreads, float* outDist, float* scratch )
+{
+	int count = w * h;
+
+	// outside, every pixel with any coverage is a seed, partially covered pixels are about ( 0.5 - coverage ) away
+	//  from the edge
+	for( int i = 0; i < count; ++i ) {
+		float a = coverage[i];
+		if( a <= 0.0f ) {
+			outDist[i] = FHDT_INF;
+		} else {
+			float df = ( a < 0.5f ) ? ( 0.5f - a ) : 0.0f;
+			outDist[i] = df * df;
+		}
+	}
+
+	// inside is the same with the coverage flipped
+	for( int i = 0; i < count; ++i ) {
+		float a = coverage[i];
+		if( a >= 1.0f ) {
+			scratch[i] = FHDT_INF;
+		} else {
+			float df = ( a > 0.5f ) ? ( a - 0.5f ) : 0.0f;
+			scratch[i] = df * df;
+		}
+	}
+
+	if( !fhdt( outDist, w, h, numThreads ) ) return false;
+	if( !fhdt( scratch, w, h, numThreads ) ) return false;
+
+	for( int i = 0; i < count; ++i ) {
+		outDist[i] = sqrtf( outDist[i] ) - sqrtf( scratch[i] );
+	}
+
+	return true;
+}
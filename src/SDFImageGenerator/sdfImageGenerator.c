@@ -1,6 +1,9 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_FAILURE_USERMSG
@@ -10,6 +13,15 @@
 #include <stb_image_write.h>
 
 #include "edtaa3func.c"
+#include "fhDistanceTransform.c"
+
+#if defined( _WIN32 )
+	// windows.h is included by fhDistanceTransform.c
+#else
+	#include <dirent.h>
+	#include <time.h>
+	#include <unistd.h>
+#endif
 
 #define MIN( a, b ) ( ( a ) < ( b ) ? ( a ) : ( b ) )
 #define MAX( a, b ) ( ( a ) > ( b ) ? ( a ) : ( b ) )
@@ -22,6 +34,21 @@
 //  - More sizing options
 //  - Single channel mask image to better handle transparent images
 
+typedef enum {
+	METHOD_EDTAA3,
+	METHOD_FH
+} DistanceMethod;
+
+typedef struct {
+	int addX;
+	int addY;
+	DistanceMethod method;
+	int numThreads;
+} Options;
+
+#define CACHE_FILE_NAME "sdfcache.txt"
+#define MAX_PATH_LENGTH 1024
+
 // returns if strToTest ends with strValue
 bool endsWith( const char* strToTest, const char* strValue )
 {
@@ -41,6 +68,602 @@ bool endsWith( const char* strToTest, const char* strValue )
 	return true;
 }
 
+static int getNumCores( void )
+{
+#if defined( _WIN32 )
+	SYSTEM_INFO sysInfo;
+	GetSystemInfo( &sysInfo );
+	return (int)sysInfo.dwNumberOfProcessors;
+#else
+	long count = sysconf( _SC_NPROCESSORS_ONLN );
+	return ( count > 0 ) ? (int)count : 1;
+#endif
+}
+
+// wall clock time in seconds
+static double getTime( void )
+{
+#if defined( _WIN32 )
+	LARGE_INTEGER freq, counter;
+	QueryPerformanceFrequency( &freq );
+	QueryPerformanceCounter( &counter );
+	return (double)counter.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec + ( (double)ts.tv_nsec / 1e9 );
+#endif
+}
+
+// same as fnv1aHash( ) in Game/Utils/helpers.c, this is built on its own without SDL so it can't use that one
+#define FNV1A_START 0xcbf29ce484222325ull
+static uint64_t fnv1aHash( uint64_t hash, const void* data, size_t size )
+{
+	const uint8_t* bytes = (const uint8_t*)data;
+	for( size_t i = 0; i < size; ++i ) {
+		hash = ( hash ^ bytes[i] ) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+// computes the signed distance from each pixel to the edge, positive outside and negative inside, coverage is in the range [0,1]
+static bool computeSignedDistance( DistanceMethod method, const double* coverage, int w, int h, int numThreads, double* outDist )
+{
+	bool success = false;
+	int count = w * h;
+
+	double* dblImg = NULL;
+	double* inside = NULL;
+	double* xGradients = NULL;
+	double* yGradients = NULL;
+	short* xDists = NULL;
+	short* yDists = NULL;
+	float* fltCoverage = NULL;
+	float* fltDist = NULL;
+	float* fltScratch = NULL;
+
+	if( method == METHOD_EDTAA3 ) {
+		dblImg = malloc( sizeof( double ) * count );
+		inside = malloc( sizeof( double ) * count );
+		xGradients = malloc( sizeof( double ) * count );
+		yGradients = malloc( sizeof( double ) * count );
+		xDists = malloc( sizeof( short ) * count );
+		yDists = malloc( sizeof( short ) * count );
+		if( ( dblImg == NULL ) || ( inside == NULL ) || ( xGradients == NULL ) || ( yGradients == NULL ) || ( xDists == NULL ) || ( yDists == NULL ) ) {
+			goto clean_up;
+		}
+
+		memcpy( dblImg, coverage, sizeof( double ) * count );
+
+		//  compute outside
+		computegradient( dblImg, w, h, xGradients, yGradients );
+		edtaa3( dblImg, xGradients, yGradients, w, h, xDists, yDists, outDist );
+		for( int i = 0; i < count; ++i ) {
+			outDist[i] = MAX( outDist[i], 0.0 );
+		}
+
+		//  compute inside
+		for( int i = 0; i < count; ++i ) {
+			dblImg[i] = 1.0 - dblImg[i];
+		}
+		computegradient( dblImg, w, h, xGradients, yGradients );
+		edtaa3( dblImg, xGradients, yGradients, w, h, xDists, yDists, inside );
+		for( int i = 0; i < count; ++i ) {
+			inside[i] = MAX( inside[i], 0.0 );
+		}
+
+		for( int i = 0; i < count; ++i ) {
+			outDist[i] -= inside[i];
+		}
+	} else {
+		fltCoverage = malloc( sizeof( float ) * count );
+		fltDist = malloc( sizeof( float ) * count );
+		fltScratch = malloc( sizeof( float ) * count );
+		if( ( fltCoverage == NULL ) || ( fltDist == NULL ) || ( fltScratch == NULL ) ) {
+			goto clean_up;
+		}
+
+		for( int i = 0; i < count; ++i ) {
+			fltCoverage[i] = (float)coverage[i];
+		}
+
+		if( !fhSignedDistance( fltCoverage, w, h, numThreads, fltDist, fltScratch ) ) {
+			goto clean_up;
+		}
+
+		for( int i = 0; i < count; ++i ) {
+			outDist[i] = fltDist[i];
+		}
+	}
+
+	success = true;
+
+clean_up:
+	free( dblImg );
+	free( inside );
+	free( xGradients );
+	free( yGradients );
+	free( xDists );
+	free( yDists );
+	free( fltCoverage );
+	free( fltDist );
+	free( fltScratch );
+
+	return success;
+}
+
+// maps the distance into the alpha of the image, 128 is on the edge
+static void distanceToImage( const double* dist, int count, unsigned char* outImage )
+{
+	for( int i = 0; i < count; ++i ) {
+		int imgIdx = i * 4;
+		outImage[imgIdx + 0] = 255;
+		outImage[imgIdx + 1] = 255;
+		outImage[imgIdx + 2] = 255;
+
+		double d = 128 + ( dist[i] * 16 );
+		d = MAX( d, 0.0 );
+		d = MIN( d, 255.0 );
+
+		outImage[imgIdx + 3] = 255 - (unsigned char)d;
+	}
+}
+
+// expands the image by the amount in the options and returns the alpha mapped into the range [0,1]
+static double* createCoverage( const unsigned char* rgba, int w, int h, const Options* options, int* outWidth, int* outHeight )
+{
+	int ew = w + ( 2 * options->addX );
+	int eh = h + ( 2 * options->addY );
+
+	double* coverage = malloc( sizeof( double ) * ew * eh );
+	if( coverage == NULL ) {
+		return NULL;
+	}
+
+	for( int i = 0; i < ( ew * eh ); ++i ) {
+		coverage[i] = 0.0;
+	}
+
+	for( int y = 0; y < h; ++y ) {
+		for( int x = 0; x < w; ++x ) {
+			coverage[( x + options->addX ) + ( ( y + options->addY ) * ew )] = rgba[IDX( x, y, w, 3, 4 )] / 255.0;
+		}
+	}
+
+	(*outWidth) = ew;
+	(*outHeight) = eh;
+	return coverage;
+}
+
+// creates the sdf image for the rgba image, returns NULL if there was an issue
+static unsigned char* generateSDF( const unsigned char* rgba, int w, int h, const Options* options, int* outWidth, int* outHeight )
+{
+	int ew, eh;
+	unsigned char* outImage = NULL;
+	double* dist = NULL;
+
+	double* coverage = createCoverage( rgba, w, h, options, &ew, &eh );
+	if( coverage == NULL ) {
+		goto clean_up;
+	}
+
+	dist = malloc( sizeof( double ) * ew * eh );
+	outImage = malloc( sizeof( unsigned char ) * 4 * ew * eh );
+	if( ( dist == NULL ) || ( outImage == NULL ) ) {
+		free( outImage );
+		outImage = NULL;
+		goto clean_up;
+	}
+
+	if( !computeSignedDistance( options->method, coverage, ew, eh, options->numThreads, dist ) ) {
+		free( outImage );
+		outImage = NULL;
+		goto clean_up;
+	}
+
+	distanceToImage( dist, ew * eh, outImage );
+	(*outWidth) = ew;
+	(*outHeight) = eh;
+
+clean_up:
+	free( coverage );
+	free( dist );
+
+	return outImage;
+}
+
+// anti-aliased rings and dots, used to compare the methods at any size without needing an image
+static unsigned char* createSyntheticImage( int size )
+{
+	unsigned char* rgba = malloc( sizeof( unsigned char ) * 4 * size * size );
+	if( rgba == NULL ) {
+		return NULL;
+	}
+
+	float cell = (float)size / 8.0f;
+	for( int y = 0; y < size; ++y ) {
+		for( int x = 0; x < size; ++x ) {
+			// distance to the center of this cell, alternate between rings and dots
+			int cx = (int)( x / cell );
+			int cy = (int)( y / cell );
+			float dx = ( (float)x + 0.5f ) - ( ( (float)cx + 0.5f ) * cell );
+			float dy = ( (float)y + 0.5f ) - ( ( (float)cy + 0.5f ) * cell );
+			float d = sqrtf( ( dx * dx ) + ( dy * dy ) );
+
+			float edgeDist;
+			if( ( ( cx + cy ) % 2 ) == 0 ) {
+				edgeDist = d - ( cell * 0.35f );
+			} else {
+				edgeDist = fabsf( d - ( cell * 0.3f ) ) - ( cell * 0.08f );
+			}
+
+			float a = 0.5f - edgeDist;
+			a = MAX( a, 0.0f );
+			a = MIN( a, 1.0f );
+
+			int idx = ( x + ( y * size ) ) * 4;
+			rgba[idx + 0] = 255;
+			rgba[idx + 1] = 255;
+			rgba[idx + 2] = 255;
+			rgba[idx + 3] = (unsigned char)( ( a * 255.0f ) + 0.5f );
+		}
+	}
+
+	return rgba;
+}
+
+// runs both methods on the image and reports how long they took and how far apart they are
+static int compareMethods( const unsigned char* rgba, int w, int h, const Options* options )
+{
+	int ret = 0;
+	int ew, eh;
+	double* edtDist = NULL;
+	double* fhDist = NULL;
+	unsigned char* edtImage = NULL;
+	unsigned char* fhImage = NULL;
+
+	double* coverage = createCoverage( rgba, w, h, options, &ew, &eh );
+	int count = ew * eh;
+	edtDist = malloc( sizeof( double ) * count );
+	fhDist = malloc( sizeof( double ) * count );
+	edtImage = malloc( sizeof( unsigned char ) * 4 * count );
+	fhImage = malloc( sizeof( unsigned char ) * 4 * count );
+	if( ( coverage == NULL ) || ( edtDist == NULL ) || ( fhDist == NULL ) || ( edtImage == NULL ) || ( fhImage == NULL ) ) {
+		fprintf( stderr, "Unable to allocate memory for comparison.\n" );
+		ret = 5;
+		goto clean_up;
+	}
+
+	double megaPixels = (double)count / 1e6;
+	fprintf( stdout, "Comparing on %ix%i (%.1f megapixels)\n", ew, eh, megaPixels );
+
+	double start = getTime( );
+	if( !computeSignedDistance( METHOD_EDTAA3, coverage, ew, eh, 1, edtDist ) ) {
+		fprintf( stderr, "edtaa3 failed.\n" );
+		ret = 5;
+		goto clean_up;
+	}
+	double edtTime = getTime( ) - start;
+	fprintf( stdout, "  edtaa3:          %8.3f s  %8.2f MP/s\n", edtTime, megaPixels / edtTime );
+
+	// powers of two up to the thread count, and the thread count itself
+	for( int threads = 1; ; threads = MIN( threads * 2, options->numThreads ) ) {
+		start = getTime( );
+		if( !computeSignedDistance( METHOD_FH, coverage, ew, eh, threads, fhDist ) ) {
+			fprintf( stderr, "Felzenszwalb-Huttenlocher failed.\n" );
+			ret = 5;
+			goto clean_up;
+		}
+		double fhTime = getTime( ) - start;
+		fprintf( stdout, "  fh %3i threads:  %8.3f s  %8.2f MP/s  %6.1fx edtaa3\n", threads, fhTime, megaPixels / fhTime, edtTime / fhTime );
+
+		if( threads >= options->numThreads ) {
+			break;
+		}
+	}
+
+	// distances, the band is the part that doesn't get clamped when written out
+	double sumError = 0.0;
+	double maxError = 0.0;
+	double sumBandError = 0.0;
+	double maxBandError = 0.0;
+	int bandCount = 0;
+	for( int i = 0; i < count; ++i ) {
+		double err = fabs( fhDist[i] - edtDist[i] );
+		sumError += err;
+		maxError = MAX( maxError, err );
+		if( fabs( edtDist[i] ) < 8.0 ) {
+			sumBandError += err;
+			maxBandError = MAX( maxBandError, err );
+			++bandCount;
+		}
+	}
+
+	// final output
+	distanceToImage( edtDist, count, edtImage );
+	distanceToImage( fhDist, count, fhImage );
+	int numDifferent = 0;
+	int maxByteDiff = 0;
+	for( int i = 0; i < count; ++i ) {
+		int diff = abs( (int)edtImage[( i * 4 ) + 3] - (int)fhImage[( i * 4 ) + 3] );
+		if( diff != 0 ) ++numDifferent;
+		maxByteDiff = MAX( maxByteDiff, diff );
+	}
+
+	fprintf( stdout, "Distance difference (pixels), all: mean %.4f  max %.4f\n", sumError / count, maxError );
+	fprintf( stdout, "Distance difference (pixels), within 8 of an edge: mean %.4f  max %.4f\n",
+		( bandCount > 0 ) ? ( sumBandError / bandCount ) : 0.0, maxBandError );
+	fprintf( stdout, "Output alpha: %.2f%% of pixels differ, max difference %i\n", ( 100.0 * numDifferent ) / count, maxByteDiff );
+
+clean_up:
+	free( coverage );
+	free( edtDist );
+	free( fhDist );
+	free( edtImage );
+	free( fhImage );
+
+	return ret;
+}
+
+// reads the whole file into memory, returns NULL if it couldn't be read
+static unsigned char* readFile( const char* path, size_t* outSize )
+{
+	FILE* file = fopen( path, "rb" );
+	if( file == NULL ) {
+		return NULL;
+	}
+
+	unsigned char* data = NULL;
+	if( fseek( file, 0, SEEK_END ) == 0 ) {
+		long size = ftell( file );
+		if( ( size > 0 ) && ( fseek( file, 0, SEEK_SET ) == 0 ) ) {
+			data = malloc( (size_t)size );
+			if( ( data != NULL ) && ( fread( data, 1, (size_t)size, file ) != (size_t)size ) ) {
+				free( data );
+				data = NULL;
+			}
+			(*outSize) = (size_t)size;
+		}
+	}
+
+	fclose( file );
+	return data;
+}
+
+static bool fileExists( const char* path )
+{
+	FILE* file = fopen( path, "rb" );
+	if( file == NULL ) {
+		return false;
+	}
+	fclose( file );
+	return true;
+}
+
+typedef struct {
+	char name[MAX_PATH_LENGTH];
+	uint64_t hash;
+} CacheEntry;
+
+typedef struct {
+	CacheEntry* entries;
+	int count;
+	int capacity;
+} Cache;
+
+static CacheEntry* findCacheEntry( Cache* cache, const char* name )
+{
+	for( int i = 0; i < cache->count; ++i ) {
+		if( strcmp( cache->entries[i].name, name ) == 0 ) {
+			return &( cache->entries[i] );
+		}
+	}
+	return NULL;
+}
+
+static void setCacheEntry( Cache* cache, const char* name, uint64_t hash )
+{
+	CacheEntry* entry = findCacheEntry( cache, name );
+	if( entry == NULL ) {
+		if( cache->count >= cache->capacity ) {
+			int newCapacity = MAX( 16, cache->capacity * 2 );
+			CacheEntry* newEntries = realloc( cache->entries, sizeof( CacheEntry ) * newCapacity );
+			if( newEntries == NULL ) {
+				return;
+			}
+			cache->entries = newEntries;
+			cache->capacity = newCapacity;
+		}
+		entry = &( cache->entries[cache->count] );
+		++cache->count;
+		strncpy( entry->name, name, MAX_PATH_LENGTH - 1 );
+		entry->name[MAX_PATH_LENGTH - 1] = 0;
+	}
+	entry->hash = hash;
+}
+
+// each line is the hash of the source and options followed by the name of the source file
+static void loadCache( const char* path, Cache* cache )
+{
+	FILE* file = fopen( path, "r" );
+	if( file == NULL ) {
+		return;
+	}
+
+	char line[MAX_PATH_LENGTH + 32];
+	while( fgets( line, sizeof( line ), file ) != NULL ) {
+		char* end = NULL;
+		uint64_t hash = strtoull( line, &end, 16 );
+		if( ( end == line ) || ( *end != ' ' ) ) continue;
+
+		char* name = end + 1;
+		name[strcspn( name, "\r\n" )] = 0;
+		setCacheEntry( cache, name, hash );
+	}
+
+	fclose( file );
+}
+
+static bool saveCache( const char* path, Cache* cache )
+{
+	FILE* file = fopen( path, "w" );
+	if( file == NULL ) {
+		return false;
+	}
+
+	for( int i = 0; i < cache->count; ++i ) {
+		fprintf( file, "%016llx %s\n", (unsigned long long)cache->entries[i].hash, cache->entries[i].name );
+	}
+
+	fclose( file );
+	return true;
+}
+
+// gets the names of all the png files in the directory, returns the number found, names should be freed with freeFileList( )
+static int listPNGFiles( const char* directory, char*** outNames )
+{
+	int count = 0;
+	int capacity = 0;
+	char** names = NULL;
+
+#define ADD_NAME( n ) \
+	if( endsWith( (n), ".png" ) ) { \
+		if( count >= capacity ) { \
+			capacity = MAX( 16, capacity * 2 ); \
+			char** newNames = realloc( names, sizeof( char* ) * capacity ); \
+			if( newNames == NULL ) break; \
+			names = newNames; \
+		} \
+		names[count] = malloc( strlen( (n) ) + 1 ); \
+		if( names[count] == NULL ) break; \
+		strcpy( names[count], (n) ); \
+		++count; \
+	}
+
+#if defined( _WIN32 )
+	char search[MAX_PATH_LENGTH];
+	snprintf( search, sizeof( search ), "%s\\*.png", directory );
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA( search, &findData );
+	if( find != INVALID_HANDLE_VALUE ) {
+		do {
+			if( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) continue;
+			ADD_NAME( findData.cFileName );
+		} while( FindNextFileA( find, &findData ) );
+		FindClose( find );
+	}
+#else
+	DIR* dir = opendir( directory );
+	if( dir != NULL ) {
+		struct dirent* entry;
+		while( ( entry = readdir( dir ) ) != NULL ) {
+			if( entry->d_name[0] == '.' ) continue;
+			ADD_NAME( entry->d_name );
+		}
+		closedir( dir );
+	}
+#endif
+
+#undef ADD_NAME
+
+	(*outNames) = names;
+	return count;
+}
+
+static void freeFileList( char** names, int count )
+{
+	for( int i = 0; i < count; ++i ) {
+		free( names[i] );
+	}
+	free( names );
+}
+
+// generates an sdf for every png in inputDir and puts it in outputDir with the same name, anything where the contents
+//  of the source and the options used haven't changed since the last run is skipped
+static int processDirectory( const char* inputDir, const char* outputDir, const Options* options )
+{
+	char cachePath[MAX_PATH_LENGTH];
+	snprintf( cachePath, sizeof( cachePath ), "%s/%s", outputDir, CACHE_FILE_NAME );
+
+	Cache cache = { NULL, 0, 0 };
+	loadCache( cachePath, &cache );
+
+	char** names = NULL;
+	int numFiles = listPNGFiles( inputDir, &names );
+
+	int numGenerated = 0;
+	int numSkipped = 0;
+	int numFailed = 0;
+	double start = getTime( );
+
+	for( int i = 0; i < numFiles; ++i ) {
+		char inputPath[MAX_PATH_LENGTH];
+		char outputPath[MAX_PATH_LENGTH];
+		snprintf( inputPath, sizeof( inputPath ), "%s/%s", inputDir, names[i] );
+		snprintf( outputPath, sizeof( outputPath ), "%s/%s", outputDir, names[i] );
+
+		size_t fileSize = 0;
+		unsigned char* fileData = readFile( inputPath, &fileSize );
+		if( fileData == NULL ) {
+			fprintf( stderr, "Unable to read %s\n", inputPath );
+			++numFailed;
+			continue;
+		}
+
+		// anything that changes the output goes into the hash, the thread count doesn't
+		uint64_t hash = fnv1aHash( FNV1A_START, fileData, fileSize );
+		hash = fnv1aHash( hash, &( options->addX ), sizeof( options->addX ) );
+		hash = fnv1aHash( hash, &( options->addY ), sizeof( options->addY ) );
+		hash = fnv1aHash( hash, &( options->method ), sizeof( options->method ) );
+
+		CacheEntry* entry = findCacheEntry( &cache, names[i] );
+		if( ( entry != NULL ) && ( entry->hash == hash ) && fileExists( outputPath ) ) {
+			free( fileData );
+			++numSkipped;
+			continue;
+		}
+
+		int w, h, comp;
+		unsigned char* rgba = stbi_load_from_memory( fileData, (int)fileSize, &w, &h, &comp, 4 );
+		free( fileData );
+		if( rgba == NULL ) {
+			fprintf( stderr, "Unable to load image file %s: %s\n", inputPath, stbi_failure_reason( ) );
+			++numFailed;
+			continue;
+		}
+
+		int ew, eh;
+		unsigned char* sdf = generateSDF( rgba, w, h, options, &ew, &eh );
+		stbi_image_free( rgba );
+		if( sdf == NULL ) {
+			fprintf( stderr, "Unable to generate sdf for %s\n", inputPath );
+			++numFailed;
+			continue;
+		}
+
+		if( stbi_write_png( outputPath, ew, eh, 4, sdf, 0 ) == 0 ) {
+			fprintf( stderr, "Unable to save image file %s\n", outputPath );
+			++numFailed;
+		} else {
+			setCacheEntry( &cache, names[i], hash );
+			++numGenerated;
+		}
+		free( sdf );
+	}
+
+	if( !saveCache( cachePath, &cache ) ) {
+		fprintf( stderr, "Unable to save cache file %s\n", cachePath );
+	}
+
+	fprintf( stdout, "Processed %i files in %.3f s: %i generated, %i unchanged, %i failed.\n",
+		numFiles, getTime( ) - start, numGenerated, numSkipped, numFailed );
+
+	freeFileList( names, numFiles );
+	free( cache.entries );
+
+	return ( numFailed > 0 ) ? 6 : 0;
+}
+
 int main( int argc, char** argv )
 {
 	// check to see if the output path is a .png file, if it isn't then append .png to the end
@@ -48,25 +671,36 @@ int main( int argc, char** argv )
 
 	char* inputFilePath = NULL;
 	char* outputFilePath = NULL;
+	char* batchInputDir = NULL;
+	char* batchOutputDir = NULL;
+	bool compare = false;
+	int syntheticSize = 0;
 	int ret = 0;
-	int addX = 0;
-	int addY = 0;
+
+	Options options;
+	options.addX = 0;
+	options.addY = 0;
+	options.method = METHOD_EDTAA3;
+	options.numThreads = getNumCores( );
 
 	unsigned char* loadedImage = NULL;
-	double* dblImg = NULL;
-	double* outside = NULL;
-	double* inside = NULL;
-	double* xGradients = NULL;
-	double* yGradients = NULL;
-	short* xDists = NULL;
-	short* yDists = NULL;
-	unsigned char* expandedImage = NULL;
+	unsigned char* sdfImage = NULL;
 
 	for( int i = 1; i < argc; ++i ) {
 		if( strcmp( "-h", argv[i] ) == 0 ) {
 			fprintf( stdout, "Used to generate a monochrome signed distance field from an image.\n" );
 			fprintf( stdout, "Will create a four channel PNG with the alpha set to the distance, where 128 is on the edge.\n" );
-			fprintf( stdout, "Useage: SDFImageGenerator -xa x -ya y source_file output_file\n" );
+			fprintf( stdout, "Useage: SDFImageGenerator [options] source_file output_file\n" );
+			fprintf( stdout, "        SDFImageGenerator [options] -batch source_directory output_directory\n" );
+			fprintf( stdout, "        SDFImageGenerator [options] -compare (source_file | -synthetic size)\n" );
+			fprintf( stdout, "Options:\n" );
+			fprintf( stdout, "  -xa x          Add x pixels to each side horizontally.\n" );
+			fprintf( stdout, "  -ya y          Add y pixels to each side vertically.\n" );
+			fprintf( stdout, "  -method m      edtaa3 (default) or fh, fh is an exact transform that is much faster on large images.\n" );
+			fprintf( stdout, "  -threads n     Number of threads fh uses, defaults to the number of cores.\n" );
+			fprintf( stdout, "  -batch         Process every png in the source directory, unchanged files are skipped.\n" );
+			fprintf( stdout, "  -compare       Compare the speed and output of edtaa3 and fh.\n" );
+			fprintf( stdout, "  -synthetic n   Compare using a generated n x n image instead of a file.\n" );
 		} else if( strcmp( "-xa", argv[i] ) == 0 ) {
 			// add to x size
 			++i;
@@ -75,7 +709,7 @@ int main( int argc, char** argv )
 				ret = 3;
 				goto clean_up;
 			} else {
-				addX = strtol( argv[i], NULL, 10 );
+				options.addX = strtol( argv[i], NULL, 10 );
 			}
 		} else if( strcmp( "-ya", argv[i] ) == 0 ) {
 			// add to y size
@@ -85,7 +719,51 @@ int main( int argc, char** argv )
 				ret = 4;
 				goto clean_up;
 			} else {
-				addY = strtol( argv[i], NULL, 10 );
+				options.addY = strtol( argv[i], NULL, 10 );
+			}
+		} else if( strcmp( "-method", argv[i] ) == 0 ) {
+			++i;
+			if( i >= argc ) {
+				fprintf( stderr, "No parameter after -method." );
+				ret = 3;
+				goto clean_up;
+			} else if( strcmp( "fh", argv[i] ) == 0 ) {
+				options.method = METHOD_FH;
+			} else if( strcmp( "edtaa3", argv[i] ) == 0 ) {
+				options.method = METHOD_EDTAA3;
+			} else {
+				fprintf( stderr, "Unknown method %s.", argv[i] );
+				ret = 3;
+				goto clean_up;
+			}
+		} else if( strcmp( "-threads", argv[i] ) == 0 ) {
+			++i;
+			if( i >= argc ) {
+				fprintf( stderr, "No parameter after -threads." );
+				ret = 3;
+				goto clean_up;
+			} else {
+				options.numThreads = MAX( 1, strtol( argv[i], NULL, 10 ) );
+			}
+		} else if( strcmp( "-batch", argv[i] ) == 0 ) {
+			if( ( i + 2 ) >= argc ) {
+				fprintf( stderr, "-batch needs a source and output directory." );
+				ret = 3;
+				goto clean_up;
+			}
+			batchInputDir = argv[i + 1];
+			batchOutputDir = argv[i + 2];
+			i += 2;
+		} else if( strcmp( "-compare", argv[i] ) == 0 ) {
+			compare = true;
+		} else if( strcmp( "-synthetic", argv[i] ) == 0 ) {
+			++i;
+			if( i >= argc ) {
+				fprintf( stderr, "No parameter after -synthetic." );
+				ret = 3;
+				goto clean_up;
+			} else {
+				syntheticSize = MAX( 1, strtol( argv[i], NULL, 10 ) );
 			}
 		} else {
 			// one of the files to use
@@ -110,89 +788,61 @@ int main( int argc, char** argv )
 		}
 	}
 
-	if( inputFilePath == NULL ) {
-		fprintf( stderr, "No input file specified." );
-		return 1;
+	if( batchInputDir != NULL ) {
+		ret = processDirectory( batchInputDir, batchOutputDir, &options );
+		goto clean_up;
 	}
 
 	// load the image
 	int w;
 	int h;
 	int comp;
-	loadedImage = stbi_load( inputFilePath, &w, &h, &comp, 4 );
-	if( loadedImage == NULL ) {
-		fprintf( stderr, "Unable to load image file: %s\n", stbi_failure_reason( ) );
-		ret = 3;
+	if( compare && ( syntheticSize > 0 ) ) {
+		w = h = syntheticSize;
+		sdfImage = createSyntheticImage( syntheticSize );
+		if( sdfImage == NULL ) {
+			fprintf( stderr, "Unable to create synthetic image.\n" );
+			ret = 3;
+			goto clean_up;
+		}
+		ret = compareMethods( sdfImage, w, h, &options );
 		goto clean_up;
 	}
 
-	// expand the image by the desired amount
-	int ew = w + ( 2 * addX );
-	int eh = h + ( 2 * addY );
-	expandedImage = malloc( sizeof( unsigned char ) * 4 * ew * eh );
-	memset( expandedImage, 0, sizeof( unsigned char ) * 4 * ew * eh );
-
-	for( int y = 0; y < h; ++y ) {
-		for( int x = 0; x < w; ++x ) {
-			for( int e = 0; e < 4; ++e ) {
-				expandedImage[IDX( x + addX, y + addY, ew, e, 4 )] = loadedImage[IDX( x, y, w, e, 4 )];
-			}
-		}
+	if( inputFilePath == NULL ) {
+		fprintf( stderr, "No input file specified." );
+		return 1;
 	}
 
-	// unload the image
-	stbi_image_free( loadedImage );
-	loadedImage = NULL;
-
-	// create the sdf
-	//  first make it the image doubles
-	dblImg = malloc( sizeof( double ) * ew * eh );
-	outside = malloc( sizeof( double ) * ew * eh );
-	inside = malloc( sizeof( double ) * ew * eh );
-	xGradients = malloc( sizeof( double ) * ew * eh );
-	yGradients = malloc( sizeof( double ) * ew * eh );
-	xDists = malloc( sizeof( short ) * ew * eh );
-	yDists = malloc( sizeof( short ) * ew * eh );
-
-	//  map it into the range [0, 1]
-	for( int i = 0; i < ( ew * eh ); ++i ) {
-		dblImg[i] = expandedImage[( i * 4 ) + 3] / 255.0;
+	loadedImage = stbi_load( inputFilePath, &w, &h, &comp, 4 );
+	if( loadedImage == NULL ) {
+		fprintf( stderr, "Unable to load image file: %s\n", stbi_failure_reason( ) );
+		ret = 3;
+		goto clean_up;
 	}
 
-	//  compute outside
-	computegradient( dblImg, ew, eh, xGradients, yGradients );
-	edtaa3( dblImg, xGradients, yGradients, ew, eh, xDists, yDists, outside );
-	for( int i = 0; i < ( ew * eh ); ++i ) {
-		outside[i] = MAX( outside[i], 0.0 );
+	if( compare ) {
+		ret = compareMethods( loadedImage, w, h, &options );
+		goto clean_up;
 	}
 
-	//  compute inside
-	for( int i = 0; i < ( ew * eh ); ++i ) {
-		dblImg[i] = 1.0 - dblImg[i];
-	}
-	computegradient( dblImg, ew, eh, xGradients, yGradients );
-	edtaa3( dblImg, xGradients, yGradients, ew, eh, xDists, yDists, inside );
-	for( int i = 0; i < ( ew * eh ); ++i ) {
-		inside[i] = MAX( inside[i], 0.0 );
+	if( outputFilePath == NULL ) {
+		fprintf( stderr, "No output file specified." );
+		ret = 1;
+		goto clean_up;
 	}
 
-	//  merge inside and outside and convert to an image, we'll resuse the loadedImage data
-	for( int i = 0; i < ( ew * eh ); ++i ) {
-		int imgIdx = i * 4;
-		expandedImage[imgIdx + 0] = 255;
-		expandedImage[imgIdx + 1] = 255;
-		expandedImage[imgIdx + 2] = 255;
-
-		outside[i] -= inside[i];
-		outside[i] = 128 + ( outside[i] * 16 );
-		outside[i] = MAX( outside[i], 0.0 );
-		outside[i] = MIN( outside[i], 255.0 );
-
-		expandedImage[imgIdx + 3] = 255 - (unsigned char)outside[i];
+	// create the sdf
+	int ew, eh;
+	sdfImage = generateSDF( loadedImage, w, h, &options, &ew, &eh );
+	if( sdfImage == NULL ) {
+		fprintf( stderr, "Unable to generate the sdf.\n" );
+		ret = 5;
+		goto clean_up;
 	}
 
 	// save out image
-	if( stbi_write_png( outputFilePath, ew, eh, 4, expandedImage, 0 ) == 0 ) {
+	if( stbi_write_png( outputFilePath, ew, eh, 4, sdfImage, 0 ) == 0 ) {
 		fprintf( stderr, "Unable to save image file.\n" );
 		ret = 4;
 		goto clean_up;
@@ -202,16 +852,9 @@ int main( int argc, char** argv )
 
 clean_up:
 
-	free( dblImg );
-	free( outside );
-	free( inside );
-	free( xGradients );
-	free( yGradients );
-	free( xDists );
-	free( yDists );
 	free( outputFilePath );
-	free( expandedImage );
+	free( sdfImage );
 	stbi_image_free( loadedImage );
 
 	return ret;
-}
\ No newline at end of file
+}